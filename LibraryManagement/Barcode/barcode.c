@@ -0,0 +1,486 @@
+/**
+ * \file            barcode.c
+ * \brief           Triển khai mã ISBN/mã vạch bản sao và chỉ mục tra cứu
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include "barcode.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * \brief           Lấy các chữ số của một mã, bỏ qua dấu cách và dấu gạch
+ * \param[in]       text: Chuỗi đọc từ máy quét hoặc bàn phím
+ * \param[out]      digits: Mảng nhận giá trị các chữ số ('X' cuối chuỗi được đọc là 10)
+ * \param[in]       capacity: Số chữ số tối đa
+ * \return          Số chữ số, 0 nếu chuỗi có ký tự lạ hoặc quá dài
+ */
+static size_t
+barcode_digits(const char* text, uint8_t* digits, size_t capacity) {
+    size_t count;
+
+    count = 0;
+    for (; *text != '\0'; text++) {
+        if (*text == ' ' || *text == '-' || *text == '\t' || *text == '\r' || *text == '\n') {
+            continue;
+        }
+        if (count == capacity) {
+            return 0;
+        }
+        if (*text >= '0' && *text <= '9') {
+            digits[count++] = (uint8_t)(*text - '0');
+        } else if ((*text == 'X' || *text == 'x') && text[1] == '\0') {
+            digits[count++] = 10;
+        } else {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * \brief           Tính chữ số kiểm tra EAN-13 của 12 chữ số đầu
+ * \param[in]       digits: 12 chữ số đầu
+ * \return          Chữ số kiểm tra (0..9)
+ */
+static uint8_t
+barcode_ean13_check(const uint8_t* digits) {
+    uint32_t sum;
+    size_t i;
+
+    sum = 0;
+    for (i = 0; i < 12; i++) {
+        sum += digits[i] * ((i & 1) ? 3U : 1U);
+    }
+
+    return (uint8_t)((10 - sum % 10) % 10);
+}
+
+/**
+ * \brief           Gộp các chữ số thành giá trị số
+ * \param[in]       digits: Các chữ số
+ * \param[in]       count: Số chữ số
+ * \return          Giá trị số
+ */
+static uint64_t
+barcode_value(const uint8_t* digits, size_t count) {
+    uint64_t value;
+    size_t i;
+
+    value = 0;
+    for (i = 0; i < count; i++) {
+        value = value * 10 + digits[i];
+    }
+
+    return value;
+}
+
+/**
+ * \brief           Đọc ISBN-13 hoặc ISBN-10 (đổi sang ISBN-13) thành khóa
+ * \param[in]       text: Chuỗi ISBN, cho phép dấu gạch
+ * \param[out]      key: Khóa loại \ref BARCODE_KIND_ISBN
+ * \return          \ref BARCODE_OK nếu thành công, \ref BARCODE_BAD_CHECKSUM nếu sai chữ số kiểm tra,
+ *                  \ref BARCODE_INVALID_INPUT nếu không phải ISBN
+ */
+barcode_status_t
+barcode_parse_isbn(const char* text, uint64_t* key) {
+    uint8_t digits[BARCODE_MAX_ITEM_DIGITS];
+    uint32_t sum;
+    size_t count;
+    size_t i;
+
+    if (text == NULL || key == NULL) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    count = barcode_digits(text, digits, BARCODE_MAX_ITEM_DIGITS);
+    if (count == 10) {
+        /* ISBN-10: tổng có trọng số 10..1 chia hết cho 11, chỉ chữ số cuối được là X */
+        sum = 0;
+        for (i = 0; i < 10; i++) {
+            if (digits[i] == 10 && i != 9) {
+                return BARCODE_INVALID_INPUT;
+            }
+            sum += digits[i] * (uint32_t)(10 - i);
+        }
+        if (sum % 11 != 0) {
+            return BARCODE_BAD_CHECKSUM;
+        }
+
+        /* Đổi sang ISBN-13: thêm tiền tố 978, tính lại chữ số kiểm tra */
+        memmove(&digits[3], digits, 9);
+        digits[0] = 9;
+        digits[1] = 7;
+        digits[2] = 8;
+        digits[12] = barcode_ean13_check(digits);
+        count = 13;
+    }
+
+    if (count != 13 || digits[0] != 9 || digits[1] != 7 || (digits[2] != 8 && digits[2] != 9)) {
+        return BARCODE_INVALID_INPUT;
+    }
+    if (digits[12] != barcode_ean13_check(digits)) {
+        return BARCODE_BAD_CHECKSUM;
+    }
+
+    *key = BARCODE_KEY(BARCODE_KIND_ISBN, barcode_value(digits, 13));
+    return BARCODE_OK;
+}
+
+/**
+ * \brief           Đọc một lượt quét thành khóa
+ *
+ * Mã EAN-13 bắt đầu bằng 978/979 là ISBN của đầu sách; mọi chuỗi số khác
+ * (tối đa \ref BARCODE_MAX_ITEM_DIGITS chữ số) là mã vạch bản sao.
+ *
+ * \param[in]       text: Chuỗi đọc từ máy quét
+ * \param[out]      key: Khóa đóng gói
+ * \return          \ref BARCODE_OK nếu thành công, \ref barcode_status_t nếu lỗi
+ */
+barcode_status_t
+barcode_parse(const char* text, uint64_t* key) {
+    uint8_t digits[BARCODE_MAX_ITEM_DIGITS];
+    uint64_t value;
+    size_t count;
+    size_t i;
+
+    if (text == NULL || key == NULL) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    count = barcode_digits(text, digits, BARCODE_MAX_ITEM_DIGITS);
+    if (count == 0) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    if (count == 13 && digits[0] == 9 && digits[1] == 7 && (digits[2] == 8 || digits[2] == 9)) {
+        return barcode_parse_isbn(text, key);
+    }
+
+    for (i = 0; i < count; i++) {
+        if (digits[i] > 9) {
+            return BARCODE_INVALID_INPUT;
+        }
+    }
+    value = barcode_value(digits, count);
+    if (value == 0) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    *key = BARCODE_KEY(BARCODE_KIND_ITEM, value);
+    return BARCODE_OK;
+}
+
+/**
+ * \brief           In khóa thành chuỗi để hiển thị
+ * \param[in]       key: Khóa đóng gói
+ * \param[out]      buffer: Bộ đệm nhận chuỗi
+ * \param[in]       size: Kích thước bộ đệm (nên là \ref BARCODE_TEXT_LENGTH)
+ */
+void
+barcode_format(uint64_t key, char* buffer, size_t size) {
+    if (buffer == NULL || size == 0) {
+        return;
+    }
+
+    switch (BARCODE_KEY_KIND(key)) {
+        case BARCODE_KIND_ISBN:
+            snprintf(buffer, size, "%013llu", (unsigned long long)BARCODE_KEY_VALUE(key));
+            break;
+        case BARCODE_KIND_ITEM:
+            snprintf(buffer, size, "%llu", (unsigned long long)BARCODE_KEY_VALUE(key));
+            break;
+        default:
+            snprintf(buffer, size, "-");
+            break;
+    }
+}
+
+/**
+ * \brief           Ô đầu tiên dò cho một khóa
+ * \param[in]       key: Khóa đóng gói
+ * \return          Chỉ số ô
+ */
+static size_t
+barcode_home(uint64_t key) {
+    return (size_t)(((hash_u64(key) >> 32) * (uint64_t)BARCODE_INDEX_SLOTS) >> 32);
+}
+
+/**
+ * \brief           Ô kế tiếp khi dò tuyến tính
+ * \param[in]       slot: Ô hiện tại
+ * \return          Ô kế tiếp (vòng về đầu bảng)
+ */
+static size_t
+barcode_next(size_t slot) {
+    return (slot + 1 == BARCODE_INDEX_SLOTS) ? 0 : slot + 1;
+}
+
+/**
+ * \brief           Tìm ô chứa khóa
+ * \param[in]       index: Con trỏ tới chỉ mục
+ * \param[in]       key: Khóa cần tìm
+ * \param[out]      slot: Ô chứa khóa
+ * \return          1 nếu tìm thấy, 0 nếu không
+ */
+static uint8_t
+barcode_lookup(const barcode_index_t* index, uint64_t key, size_t* slot) {
+    size_t i;
+
+    /* Mã chưa từng gán (quét nhầm, nhập sai) bị loại mà không chạm bảng băm */
+    if (!key_filter_may_contain(index->filter, BARCODE_FILTER_WORDS, key)) {
+        return 0;
+    }
+
+    for (i = barcode_home(key); index->slots[i].key != 0; i = barcode_next(i)) {
+        if (index->slots[i].key == key) {
+            *slot = i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \brief           Khởi tạo chỉ mục rỗng
+ * \param[out]      index: Con trỏ tới chỉ mục
+ */
+void
+barcode_index_init(barcode_index_t* index) {
+    if (index != NULL) {
+        memset(index, 0, sizeof(*index));
+    }
+}
+
+/**
+ * \brief           Gán một mã cho bản sao (hoặc ISBN cho đầu sách)
+ *
+ * Khi bộ lọc khẳng định mã chưa có (trường hợp thường gặp lúc nhập kho), bỏ qua
+ * bước so khóa và đặt thẳng vào ô trống đầu tiên.
+ *
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ * \param[in]       key: Khóa đóng gói
+ * \param[in]       item_key: \ref BOOK_ITEM_KEY của bản sao
+ * \return          \ref BARCODE_OK nếu thành công, \ref barcode_status_t nếu lỗi
+ */
+barcode_status_t
+barcode_index_add(barcode_index_t* index, uint64_t key, uint32_t item_key) {
+    size_t i;
+
+    if (index == NULL || BARCODE_KEY_KIND(key) == BARCODE_KIND_NONE
+        || BARCODE_KEY_VALUE(key) == 0) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    if (barcode_lookup(index, key, &i)) {
+        return BARCODE_ALREADY_EXISTS;
+    }
+    if (index->count >= BARCODE_MAX_KEYS) {
+        return BARCODE_FULL;
+    }
+
+    for (i = barcode_home(key); index->slots[i].key != 0; i = barcode_next(i)) {
+    }
+    index->slots[i].key = key;
+    index->slots[i].item_key = item_key;
+    index->slots[i].position = 0;
+    index->count++;
+    key_filter_add(index->filter, BARCODE_FILTER_WORDS, key);
+
+    return BARCODE_OK;
+}
+
+/**
+ * \brief           Dựng lại bộ lọc từ các khóa còn trong bảng
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ */
+static void
+barcode_rebuild_filter(barcode_index_t* index) {
+    size_t i;
+
+    memset(index->filter, 0, sizeof(index->filter));
+    for (i = 0; i < BARCODE_INDEX_SLOTS; i++) {
+        if (index->slots[i].key != 0) {
+            key_filter_add(index->filter, BARCODE_FILTER_WORDS, index->slots[i].key);
+        }
+    }
+    index->filter_stale = 0;
+}
+
+/**
+ * \brief           Bỏ gán một mã
+ *
+ * Xóa kiểu dịch lùi: các khóa phía sau trong cùng chuỗi dò được kéo về, nên
+ * bảng không cần đánh dấu ô đã xóa và lần dò sau không dài thêm.
+ *
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ * \param[in]       key: Khóa cần bỏ
+ * \return          \ref BARCODE_OK nếu thành công, \ref BARCODE_NOT_FOUND nếu mã chưa được gán
+ */
+barcode_status_t
+barcode_index_remove(barcode_index_t* index, uint64_t key) {
+    size_t hole;
+    size_t i;
+    size_t home;
+
+    if (index == NULL) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    if (!barcode_lookup(index, key, &hole)) {
+        return BARCODE_NOT_FOUND;
+    }
+
+    for (i = barcode_next(hole); index->slots[i].key != 0; i = barcode_next(i)) {
+        home = barcode_home(index->slots[i].key);
+
+        /* Khóa ở ô i chỉ được kéo về lỗ khi ô gốc của nó không nằm giữa lỗ và i */
+        if ((hole < i) ? (home <= hole || home > i) : (home <= hole && home > i)) {
+            index->slots[hole] = index->slots[i];
+            hole = i;
+        }
+    }
+    memset(&index->slots[hole], 0, sizeof(index->slots[hole]));
+    index->count--;
+
+    if (++index->filter_stale > index->count) {
+        barcode_rebuild_filter(index);
+    }
+
+    return BARCODE_OK;
+}
+
+/**
+ * \brief           Tra khóa bản sao của một mã
+ * \param[in]       index: Con trỏ tới chỉ mục
+ * \param[in]       key: Khóa đóng gói
+ * \param[out]      item_key: \ref BOOK_ITEM_KEY của bản sao
+ * \return          \ref BARCODE_OK nếu thành công, \ref BARCODE_NOT_FOUND nếu mã chưa được gán
+ */
+barcode_status_t
+barcode_index_find(const barcode_index_t* index, uint64_t key, uint32_t* item_key) {
+    size_t slot;
+
+    if (index == NULL || item_key == NULL) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    if (!barcode_lookup(index, key, &slot)) {
+        return BARCODE_NOT_FOUND;
+    }
+
+    *item_key = index->slots[slot].item_key;
+    return BARCODE_OK;
+}
+
+/**
+ * \brief           Tra một lượt quét tới bản ghi sách
+ *
+ * Ô của bảng giữ vị trí sách lần tra trước; vị trí chỉ đổi khi có sách bị xóa
+ * phía trước, nên lượt quét thường chỉ chạm một ô bảng băm và một bản ghi
+ * sách thay vì quét danh sách theo ID.
+ *
+ * \param[in,out]   index: Con trỏ tới chỉ mục (vị trí gợi ý được cập nhật)
+ * \param[in]       list: Con trỏ tới danh sách sách
+ * \param[in]       key: Khóa đóng gói
+ * \param[out]      book: Sách của mã
+ * \param[out]      item_key: \ref BOOK_ITEM_KEY của bản sao
+ * \return          \ref BARCODE_OK nếu thành công, \ref BARCODE_NOT_FOUND nếu mã chưa được gán
+ *                  hoặc trỏ tới sách/bản sao không còn tồn tại
+ */
+barcode_status_t
+barcode_index_resolve(barcode_index_t* index, book_list_t* list, uint64_t key,
+                      book_t** book, uint32_t* item_key) {
+    barcode_entry_t* entry;
+    book_t* found;
+    uint32_t book_id;
+    size_t slot;
+
+    if (index == NULL || list == NULL || book == NULL || item_key == NULL) {
+        return BARCODE_INVALID_INPUT;
+    }
+
+    if (!barcode_lookup(index, key, &slot)) {
+        return BARCODE_NOT_FOUND;
+    }
+
+    entry = &index->slots[slot];
+    book_id = BOOK_ITEM_BOOK_ID(entry->item_key);
+    if (entry->position < list->count && list->books[entry->position].book_id == book_id) {
+        found = &list->books[entry->position];
+    } else {
+        found = book_find_by_id(list, book_id);
+        if (found == NULL) {
+            return BARCODE_NOT_FOUND;
+        }
+        entry->position = (uint32_t)(found - list->books);
+    }
+
+    if (BARCODE_KEY_KIND(key) == BARCODE_KIND_ITEM
+        && BOOK_ITEM_COPY(entry->item_key) >= found->copy_count) {
+        return BARCODE_NOT_FOUND;
+    }
+
+    *book = found;
+    *item_key = entry->item_key;
+    return BARCODE_OK;
+}
+
+/**
+ * \brief           Bỏ mọi mã của một đầu sách (khi xóa sách)
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ * \param[in]       book_id: ID của sách
+ * \return          Số mã đã bỏ
+ */
+size_t
+barcode_index_remove_book(barcode_index_t* index, uint32_t book_id) {
+    size_t removed;
+    size_t i;
+
+    if (index == NULL) {
+        return 0;
+    }
+
+    removed = 0;
+    i = 0;
+    while (i < BARCODE_INDEX_SLOTS) {
+        /* Không tăng i sau khi xóa: dịch lùi có thể kéo một khóa chưa xét vào ô i */
+        if (index->slots[i].key != 0 && BOOK_ITEM_BOOK_ID(index->slots[i].item_key) == book_id) {
+            barcode_index_remove(index, index->slots[i].key);
+            removed++;
+        } else {
+            i++;
+        }
+    }
+
+    return removed;
+}
@@ -0,0 +1,129 @@
+/**
+ * \file            barcode.h
+ * \brief           Mã ISBN/mã vạch bản sao và chỉ mục tra cứu khi quét
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef BARCODE_HDR_H
+#define BARCODE_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../Book/book.h"
+#include "../Ultils/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#ifndef BARCODE_MAX_KEYS
+#define BARCODE_MAX_KEYS            (MAX_BOOKS * 4) /*!< Số mã tối đa (ISBN và mã vạch bản sao) */
+#endif /* BARCODE_MAX_KEYS */
+#define BARCODE_INDEX_SLOTS         (BARCODE_MAX_KEYS * 2)  /*!< Hệ số tải không quá 1/2 */
+#define BARCODE_FILTER_WORDS        KEY_FILTER_WORDS(BARCODE_MAX_KEYS)
+#define BARCODE_MAX_ITEM_DIGITS     18          /*!< Số chữ số tối đa của mã vạch bản sao */
+#define BARCODE_TEXT_LENGTH         24          /*!< Độ dài chuỗi đủ chứa một mã khi in */
+
+/**
+ * \brief           Đóng gói mã thành khóa 64 bit: 4 bit cao là loại mã, 60 bit thấp là giá trị số
+ *
+ * ISBN-13 (13 chữ số) và mã vạch bản sao (tối đa 18 chữ số) đều vừa 60 bit,
+ * nên hai loại dùng chung một bảng mà không bao giờ trùng khóa.
+ */
+#define BARCODE_KIND_SHIFT          60
+#define BARCODE_VALUE_MASK          (((uint64_t)1 << BARCODE_KIND_SHIFT) - 1)
+#define BARCODE_KEY(kind, value)    (((uint64_t)(kind) << BARCODE_KIND_SHIFT) | ((uint64_t)(value) & BARCODE_VALUE_MASK))
+#define BARCODE_KEY_KIND(key)       ((barcode_kind_t)((uint64_t)(key) >> BARCODE_KIND_SHIFT))
+#define BARCODE_KEY_VALUE(key)      ((uint64_t)(key) & BARCODE_VALUE_MASK)
+
+/**
+ * \brief           Trạng thái trả về của các hàm mã vạch
+ */
+typedef enum {
+    BARCODE_OK = 0,                             /*!< Thành công */
+    BARCODE_ERROR,                              /*!< Lỗi chung */
+    BARCODE_INVALID_INPUT,                      /*!< Dữ liệu đầu vào không hợp lệ */
+    BARCODE_BAD_CHECKSUM,                       /*!< Chữ số kiểm tra ISBN không đúng */
+    BARCODE_NOT_FOUND,                          /*!< Mã chưa được gán */
+    BARCODE_ALREADY_EXISTS,                     /*!< Mã đã được gán */
+    BARCODE_FULL,                               /*!< Chỉ mục đã đầy */
+} barcode_status_t;
+
+/**
+ * \brief           Loại mã
+ */
+typedef enum {
+    BARCODE_KIND_NONE = 0,                      /*!< Không phải mã hợp lệ */
+    BARCODE_KIND_ISBN,                          /*!< ISBN-13 của đầu sách */
+    BARCODE_KIND_ITEM,                          /*!< Mã vạch dán trên một bản sao */
+} barcode_kind_t;
+
+/**
+ * \brief           Một ô của bảng băm (16 byte, bốn ô trên một cache line)
+ */
+typedef struct {
+    uint64_t key;                               /*!< Khóa đóng gói, 0 = ô trống */
+    uint32_t item_key;                          /*!< \ref BOOK_ITEM_KEY của bản sao (với ISBN: bản sao 0) */
+    uint32_t position;                          /*!< Vị trí sách trong danh sách lần tra gần nhất (chỉ là gợi ý) */
+} barcode_entry_t;
+
+/**
+ * \brief           Chỉ mục mã: bảng băm địa chỉ mở dò tuyến tính và bộ lọc Bloom đứng trước
+ *
+ * Mã vạch bản sao chỉ nằm trong chỉ mục (không thêm 64 trường vào \ref book_t);
+ * ISBN nằm cả trong \ref book_t::isbn để hiển thị.
+ */
+typedef struct {
+    barcode_entry_t slots[BARCODE_INDEX_SLOTS]; /*!< Bảng băm */
+    uint64_t filter[BARCODE_FILTER_WORDS];      /*!< Bộ lọc Bloom các khóa đã gán */
+    size_t count;                               /*!< Số khóa đang có */
+    size_t filter_stale;                        /*!< Số khóa đã xóa nhưng còn bit trong bộ lọc */
+} barcode_index_t;
+
+/* Khai báo các hàm đọc mã */
+barcode_status_t barcode_parse(const char* text, uint64_t* key);
+barcode_status_t barcode_parse_isbn(const char* text, uint64_t* key);
+void            barcode_format(uint64_t key, char* buffer, size_t size);
+
+/* Khai báo các hàm chỉ mục */
+void            barcode_index_init(barcode_index_t* index);
+barcode_status_t barcode_index_add(barcode_index_t* index, uint64_t key, uint32_t item_key);
+barcode_status_t barcode_index_remove(barcode_index_t* index, uint64_t key);
+barcode_status_t barcode_index_find(const barcode_index_t* index, uint64_t key, uint32_t* item_key);
+barcode_status_t barcode_index_resolve(barcode_index_t* index, book_list_t* list, uint64_t key,
+                                       book_t** book, uint32_t* item_key);
+size_t          barcode_index_remove_book(barcode_index_t* index, uint32_t book_id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BARCODE_HDR_H */
@@ -35,6 +35,227 @@
 #include <stdio.h>
 #include <string.h>
 
+/**
+ * \brief           Tạo bitmap với \p count bit thấp được bật
+ * \param[in]       count: Số bản sao (0..MAX_COPIES_PER_BOOK)
+ * \return          Bitmap tương ứng
+ */
+static uint64_t
+book_copy_mask(uint8_t count) {
+    if (count >= MAX_COPIES_PER_BOOK) {
+        return ~(uint64_t)0;
+    }
+    return ((uint64_t)1 << count) - 1;
+}
+
+/**
+ * \brief           Cập nhật các trường cache sau khi bitmap thay đổi
+ * \param[in,out]   book: Con trỏ tới sách
+ */
+static void
+book_sync_availability(book_t* book) {
+    book->available_count = (uint8_t)__builtin_popcountll(book->available_mask);
+    book->is_borrowed = (book->available_count == 0) ? 1 : 0;
+}
+
+/**
+ * \brief           Ghi thông tin cho một bản ghi sách mới (một bản sao, có sẵn)
+ *
+ * Các hàm \c book_record_* làm việc trên một bản ghi, không phụ thuộc nơi chứa
+ * nó, để danh sách trong bộ nhớ và kho trang trên đĩa dùng chung quy tắc.
+ *
+ * \param[out]      book: Bản ghi cần khởi tạo
+ * \param[in]       book_id: ID của sách
+ * \param[in]       title: Tiêu đề sách
+ * \param[in]       author: Tác giả
+ * \return          \ref BOOK_OK nếu thành công, \ref BOOK_INVALID_INPUT nếu chuỗi rỗng
+ */
+book_status_t
+book_record_init(book_t* book, uint32_t book_id, const char* title, const char* author) {
+    if (book == NULL || title == NULL || author == NULL
+        || is_string_empty(title) || is_string_empty(author)) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    memset(book, 0, sizeof(*book));
+    book->book_id = book_id;
+    strncpy(book->title, title, MAX_TITLE_LENGTH - 1);
+    strncpy(book->author, author, MAX_AUTHOR_LENGTH - 1);
+    book->copy_count = 1;
+    book->available_mask = book_copy_mask(1);
+    book_sync_availability(book);
+    hold_queue_init(&book->holds);
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Đổi tiêu đề và tác giả của một bản ghi sách
+ * \param[in,out]   book: Bản ghi sách
+ * \param[in]       title: Tiêu đề mới
+ * \param[in]       author: Tác giả mới
+ * \return          \ref BOOK_OK nếu thành công, \ref BOOK_INVALID_INPUT nếu chuỗi rỗng
+ */
+book_status_t
+book_record_update(book_t* book, const char* title, const char* author) {
+    if (book == NULL || title == NULL || author == NULL
+        || is_string_empty(title) || is_string_empty(author)) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    strncpy(book->title, title, MAX_TITLE_LENGTH - 1);
+    book->title[MAX_TITLE_LENGTH - 1] = '\0';
+    strncpy(book->author, author, MAX_AUTHOR_LENGTH - 1);
+    book->author[MAX_AUTHOR_LENGTH - 1] = '\0';
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Kiểm tra bản ghi sách có thể xóa
+ * \param[in]       book: Bản ghi sách
+ * \return          \ref BOOK_OK nếu xóa được, \ref BOOK_IS_BORROWED hoặc \ref BOOK_HAS_HOLDS nếu không
+ */
+book_status_t
+book_record_check_delete(const book_t* book) {
+    /* Kiểm tra sách có bản sao nào đang được mượn */
+    if (book->available_count != book->copy_count) {
+        return BOOK_IS_BORROWED;
+    }
+
+    /* Không xóa sách khi còn người đặt giữ */
+    if (hold_queue_length(&book->holds) > 0) {
+        return BOOK_HAS_HOLDS;
+    }
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Thêm bản sao vào một bản ghi sách
+ * \param[in,out]   book: Bản ghi sách
+ * \param[in]       count: Số bản sao cần thêm
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+book_record_add_copies(book_t* book, uint8_t count) {
+    uint64_t new_copies;
+
+    if (book == NULL || count == 0) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    /* Kiểm tra giới hạn số bản sao */
+    if ((size_t)book->copy_count + count > MAX_COPIES_PER_BOOK) {
+        return BOOK_COPY_LIMIT_REACHED;
+    }
+
+    /* Các bản sao mới chiếm các bit ngay sau bản sao cuối cùng và đều có sẵn */
+    new_copies = book_copy_mask((uint8_t)(book->copy_count + count)) & ~book_copy_mask(book->copy_count);
+    book->copy_count = (uint8_t)(book->copy_count + count);
+    book->available_mask |= new_copies;
+    book_sync_availability(book);
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Lấy bản sao có sẵn có chỉ số nhỏ nhất của một bản ghi sách
+ * \param[in,out]   book: Bản ghi sách
+ * \param[out]      copy: Chỉ số bản sao đã được lấy
+ * \return          \ref BOOK_OK nếu thành công, \ref BOOK_IS_BORROWED nếu không còn bản sao nào
+ */
+book_status_t
+book_record_checkout(book_t* book, uint8_t* copy) {
+    if (book == NULL || copy == NULL) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    if (book->available_mask == 0) {
+        return BOOK_IS_BORROWED;
+    }
+
+    /* Bản sao có sẵn có chỉ số nhỏ nhất: O(1) với find-first-set */
+    *copy = (uint8_t)__builtin_ctzll(book->available_mask);
+    book->available_mask &= book->available_mask - 1;
+    book_sync_availability(book);
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Lấy một bản sao cụ thể của một bản ghi sách (khi quét mã vạch bản sao)
+ * \param[in,out]   book: Bản ghi sách
+ * \param[in]       copy: Chỉ số bản sao cần lấy
+ * \return          \ref BOOK_OK nếu thành công, \ref BOOK_IS_BORROWED nếu bản sao đang được mượn
+ */
+book_status_t
+book_record_checkout_copy(book_t* book, uint8_t copy) {
+    uint64_t bit;
+
+    if (book == NULL || copy >= book->copy_count) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    bit = (uint64_t)1 << copy;
+    if ((book->available_mask & bit) == 0) {
+        return BOOK_IS_BORROWED;
+    }
+
+    book->available_mask &= ~bit;
+    book_sync_availability(book);
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Nhận lại một bản sao cụ thể của một bản ghi sách
+ * \param[in,out]   book: Bản ghi sách
+ * \param[in]       copy: Chỉ số bản sao được trả
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+book_record_return(book_t* book, uint8_t copy) {
+    uint64_t bit;
+
+    if (book == NULL || copy >= book->copy_count) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    bit = (uint64_t)1 << copy;
+    if (book->available_mask & bit) {
+        return BOOK_NOT_BORROWED;
+    }
+
+    book->available_mask |= bit;
+    book_sync_availability(book);
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Kiểm tra bản ghi sách có khớp bộ lọc
+ * \param[in]       book: Bản ghi sách
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       needle_lower: Chuỗi truy vấn đã chuyển chữ thường (với bộ lọc tiêu đề/tác giả)
+ * \return          1 nếu khớp, 0 nếu không
+ */
+uint8_t
+book_record_matches(const book_t* book, book_filter_t filter, const char* needle_lower) {
+    switch (filter) {
+        case BOOK_FILTER_ALL:
+            return 1;
+        case BOOK_FILTER_AVAILABLE:
+            return !book->is_borrowed;
+        case BOOK_FILTER_TITLE:
+            return (uint8_t)string_contains_lower(book->title, needle_lower);
+        case BOOK_FILTER_AUTHOR:
+            return (uint8_t)string_contains_lower(book->author, needle_lower);
+        default:
+            return 0;
+    }
+}
+
 /**
  * \brief           Khởi tạo danh sách sách
  * \param[in,out]   list: Con trỏ tới danh sách sách
@@ -44,8 +265,33 @@ book_init(book_list_t* list) {
     if (list != NULL) {
         list->count = 0;
         list->next_id = 1;
+        list->generation = 0;
+        list->catalog_generation = 0;
+        list->observer = NULL;
+        list->observer_ctx = NULL;
         memset(list->books, 0, sizeof(list->books));
+        memset(list->id_filter, 0, sizeof(list->id_filter));
+        list->id_filter_stale = 0;
+    }
+}
+
+/**
+ * \brief           Dựng lại bộ lọc ID từ các sách còn trong danh sách
+ *
+ * Bộ lọc Bloom không xóa được bit, nên sau nhiều lần xóa sách tỷ lệ báo nhầm
+ * tăng dần; dựng lại khi số ID đã xóa vượt số sách còn lại (chi phí trải đều).
+ *
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ */
+static void
+book_rebuild_id_filter(book_list_t* list) {
+    size_t i;
+
+    memset(list->id_filter, 0, sizeof(list->id_filter));
+    for (i = 0; i < list->count; i++) {
+        key_filter_add(list->id_filter, BOOK_ID_FILTER_WORDS, list->books[i].book_id);
     }
+    list->id_filter_stale = 0;
 }
 
 /**
@@ -79,15 +325,12 @@ book_add(book_list_t* list, const char* title, const char* author, uint32_t* ass
 
     /* Thêm sách mới */
     book_t* new_book = &list->books[list->count];
-    new_book->book_id = new_id;
-    strncpy(new_book->title, title, MAX_TITLE_LENGTH - 1);
-    new_book->title[MAX_TITLE_LENGTH - 1] = '\0';
-    strncpy(new_book->author, author, MAX_AUTHOR_LENGTH - 1);
-    new_book->author[MAX_AUTHOR_LENGTH - 1] = '\0';
-    new_book->is_borrowed = 0;
+    book_record_init(new_book, new_id, title, author);
 
     list->count++;
     list->next_id++;
+    key_filter_add(list->id_filter, BOOK_ID_FILTER_WORDS, new_id);
+    book_notify(list, BOOK_EVENT_ADDED, new_book);
 
     /* Trả về ID đã được gán nếu có yêu cầu */
     if (assigned_id != NULL) {
@@ -126,21 +369,18 @@ book_add_with_id(book_list_t* list, uint32_t book_id, const char* title, const c
         return BOOK_FULL;
     }
 
-    /* Kiểm tra ID đã tồn tại */
+    /* Kiểm tra ID đã tồn tại: ID mới thường bị bộ lọc loại ngay, không phải quét danh sách */
     if (book_find_by_id(list, book_id) != NULL) {
         return BOOK_ALREADY_EXISTS;
     }
 
     /* Thêm sách mới */
     book_t* new_book = &list->books[list->count];
-    new_book->book_id = book_id;
-    strncpy(new_book->title, title, MAX_TITLE_LENGTH - 1);
-    new_book->title[MAX_TITLE_LENGTH - 1] = '\0';
-    strncpy(new_book->author, author, MAX_AUTHOR_LENGTH - 1);
-    new_book->author[MAX_AUTHOR_LENGTH - 1] = '\0';
-    new_book->is_borrowed = 0;
+    book_record_init(new_book, book_id, title, author);
 
     list->count++;
+    key_filter_add(list->id_filter, BOOK_ID_FILTER_WORDS, book_id);
+    book_notify(list, BOOK_EVENT_ADDED, new_book);
 
     /* Cập nhật next_id nếu cần */
     if (book_id >= list->next_id) {
@@ -178,10 +418,8 @@ book_update(book_list_t* list, uint32_t book_id, const char* title, const char*
     }
 
     /* Cập nhật thông tin */
-    strncpy(book->title, title, MAX_TITLE_LENGTH - 1);
-    book->title[MAX_TITLE_LENGTH - 1] = '\0';
-    strncpy(book->author, author, MAX_AUTHOR_LENGTH - 1);
-    book->author[MAX_AUTHOR_LENGTH - 1] = '\0';
+    book_record_update(book, title, author);
+    book_notify(list, BOOK_EVENT_UPDATED, book);
 
     return BOOK_OK;
 }
@@ -194,6 +432,7 @@ book_update(book_list_t* list, uint32_t book_id, const char* title, const char*
  */
 book_status_t
 book_delete(book_list_t* list, uint32_t book_id) {
+    book_status_t status;
     size_t i;
 
     if (list == NULL) {
@@ -203,11 +442,13 @@ book_delete(book_list_t* list, uint32_t book_id) {
     /* Tìm vị trí sách */
     for (i = 0; i < list->count; i++) {
         if (list->books[i].book_id == book_id) {
-            /* Kiểm tra sách có đang được mượn */
-            if (list->books[i].is_borrowed) {
-                return BOOK_IS_BORROWED;
+            status = book_record_check_delete(&list->books[i]);
+            if (status != BOOK_OK) {
+                return status;
             }
 
+            book_notify(list, BOOK_EVENT_DELETED, &list->books[i]);
+
             /* Dịch chuyển các phần tử phía sau lên */
             if (i < list->count - 1) {
                 memmove(&list->books[i], &list->books[i + 1],
@@ -215,6 +456,9 @@ book_delete(book_list_t* list, uint32_t book_id) {
             }
 
             list->count--;
+            if (++list->id_filter_stale > list->count) {
+                book_rebuild_id_filter(list);
+            }
             return BOOK_OK;
         }
     }
@@ -236,6 +480,11 @@ book_find_by_id(book_list_t* list, uint32_t book_id) {
         return NULL;
     }
 
+    /* ID chưa từng được thêm: trả lời ngay không cần quét */
+    if (!key_filter_may_contain(list->id_filter, BOOK_ID_FILTER_WORDS, book_id)) {
+        return NULL;
+    }
+
     for (i = 0; i < list->count; i++) {
         if (list->books[i].book_id == book_id) {
             return &list->books[i];
@@ -247,34 +496,225 @@ book_find_by_id(book_list_t* list, uint32_t book_id) {
 
 /**
  * \brief           Đặt trạng thái mượn cho sách
+ *
+ * Hàm giữ lại cho mã cũ làm việc theo từng đầu sách: mượn lấy một bản sao
+ * có sẵn bất kỳ, trả thì trả bản sao đang mượn có chỉ số nhỏ nhất. Mã mới nên
+ * dùng \ref book_checkout_copy và \ref book_return_copy để biết chính xác bản sao.
+ *
  * \param[in,out]   list: Con trỏ tới danh sách sách
  * \param[in]       book_id: ID của sách
- * \param[in]       is_borrowed: Trạng thái mượn (1 = đã mượn, 0 = có sẵn)
+ * \param[in]       is_borrowed: Trạng thái mượn (1 = mượn một bản, 0 = trả một bản)
  * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
  */
 book_status_t
 book_set_borrowed(book_list_t* list, uint32_t book_id, uint8_t is_borrowed) {
     book_t* book;
+    uint64_t on_loan;
+    uint8_t copy;
 
     if (list == NULL) {
         return BOOK_INVALID_INPUT;
     }
 
+    if (is_borrowed) {
+        return book_checkout_copy(list, book_id, &copy);
+    }
+
     book = book_find_by_id(list, book_id);
     if (book == NULL) {
         return BOOK_NOT_FOUND;
     }
 
-    /* Kiểm tra trạng thái hiện tại */
-    if (is_borrowed && book->is_borrowed) {
-        return BOOK_IS_BORROWED;
+    /* Tìm bản sao đang được mượn đầu tiên */
+    on_loan = ~book->available_mask & book_copy_mask(book->copy_count);
+    if (on_loan == 0) {
+        return BOOK_NOT_BORROWED;
     }
 
-    if (!is_borrowed && !book->is_borrowed) {
-        return BOOK_NOT_BORROWED;
+    return book_return_copy(list, book_id, (uint8_t)__builtin_ctzll(on_loan));
+}
+
+/**
+ * \brief           Gán ISBN-13 cho sách
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       book_id: ID của sách
+ * \param[in]       isbn: ISBN-13 dạng số (0 = xóa ISBN)
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+book_set_isbn(book_list_t* list, uint32_t book_id, uint64_t isbn) {
+    book_t* book;
+
+    if (list == NULL || isbn > 9999999999999ULL) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(list, book_id);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+
+    book->isbn = isbn;
+    book_notify(list, BOOK_EVENT_UPDATED, book);
+
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Đăng ký observer nhận thông báo sau mỗi thay đổi danh sách
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       observer: Hàm nhận thông báo (NULL = hủy đăng ký)
+ * \param[in]       ctx: Ngữ cảnh truyền cho observer
+ */
+void
+book_set_observer(book_list_t* list, book_observer_fn observer, void* ctx) {
+    if (list != NULL) {
+        list->observer = observer;
+        list->observer_ctx = ctx;
+    }
+}
+
+/**
+ * \brief           Ghi nhận một thay đổi: tăng generation và báo cho observer
+ *
+ * Các hàm trong module tự gọi hàm này; mã sửa trực tiếp một \ref book_t
+ * (ví dụ khi commit giao dịch) phải gọi lại để cache và observer thấy thay đổi.
+ * Mượn/trả và thêm bản sao không đổi ID, vị trí hay chuỗi của sách nên không
+ * làm các chỉ mục theo nội dung (\ref catalog_generation) phải dựng lại.
+ *
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       book: Sách bị thay đổi
+ */
+void
+book_notify(book_list_t* list, book_event_t event, const book_t* book) {
+    list->generation++;
+    if (event != BOOK_EVENT_AVAILABILITY && event != BOOK_EVENT_COPIES_ADDED) {
+        list->catalog_generation++;
+    }
+    if (list->observer != NULL) {
+        list->observer(event, book, list->observer_ctx);
+    }
+}
+
+/**
+ * \brief           Thêm bản sao vật lý cho một đầu sách
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       book_id: ID của sách
+ * \param[in]       count: Số bản sao cần thêm
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+book_add_copies(book_list_t* list, uint32_t book_id, uint8_t count) {
+    book_t* book;
+    book_status_t status;
+
+    if (list == NULL || count == 0) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(list, book_id);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+
+    status = book_record_add_copies(book, count);
+    if (status == BOOK_OK) {
+        book_notify(list, BOOK_EVENT_COPIES_ADDED, book);
+    }
+
+    return status;
+}
+
+/**
+ * \brief           Cho mượn một bản sao có sẵn bất kỳ của đầu sách
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       book_id: ID của sách
+ * \param[out]      copy: Chỉ số bản sao đã được lấy
+ * \return          \ref BOOK_OK nếu thành công, \ref BOOK_IS_BORROWED nếu không còn bản sao nào
+ */
+book_status_t
+book_checkout_copy(book_list_t* list, uint32_t book_id, uint8_t* copy) {
+    book_t* book;
+    book_status_t status;
+
+    if (list == NULL || copy == NULL) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(list, book_id);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+
+    status = book_record_checkout(book, copy);
+    if (status == BOOK_OK) {
+        book_notify(list, BOOK_EVENT_AVAILABILITY, book);
+    }
+
+    return status;
+}
+
+/**
+ * \brief           Nhận lại một bản sao cụ thể của đầu sách
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       book_id: ID của sách
+ * \param[in]       copy: Chỉ số bản sao được trả
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+book_return_copy(book_list_t* list, uint32_t book_id, uint8_t copy) {
+    book_t* book;
+    book_status_t status;
+
+    if (list == NULL) {
+        return BOOK_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(list, book_id);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+
+    status = book_record_return(book, copy);
+    if (status == BOOK_OK) {
+        book_notify(list, BOOK_EVENT_AVAILABILITY, book);
+    }
+
+    return status;
+}
+
+/**
+ * \brief           Đặt trực tiếp số bản sao và bitmap bản sao có sẵn
+ *
+ * Dùng khi phát lại nhật ký thay đổi: trạng thái đã được kiểm tra ở nơi ghi
+ * nhật ký nên chỉ cần bitmap nằm trong số bản sao.
+ *
+ * \param[in,out]   list: Con trỏ tới danh sách sách
+ * \param[in]       book_id: ID của sách
+ * \param[in]       copy_count: Số bản sao
+ * \param[in]       available_mask: Bitmap bản sao có sẵn
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+book_restore_copies(book_list_t* list, uint32_t book_id, uint8_t copy_count, uint64_t available_mask) {
+    book_t* book;
+
+    if (list == NULL || copy_count == 0 || copy_count > MAX_COPIES_PER_BOOK
+        || (available_mask & ~book_copy_mask(copy_count)) != 0) {
+        return BOOK_INVALID_INPUT;
     }
 
-    book->is_borrowed = is_borrowed;
+    book = book_find_by_id(list, book_id);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+
+    book->copy_count = copy_count;
+    book->available_mask = available_mask;
+    book_sync_availability(book);
+    book_notify(list, BOOK_EVENT_AVAILABILITY, book);
+
     return BOOK_OK;
 }
 
@@ -284,38 +724,281 @@ book_set_borrowed(book_list_t* list, uint32_t book_id, uint8_t is_borrowed) {
  */
 void
 book_display_one(const book_t* book) {
+    char status[32];
+
     if (book == NULL) {
         return;
     }
 
+    if (book->is_borrowed) {
+        snprintf(status, sizeof(status), "Đang được mượn");
+    } else if (book->copy_count == 1) {
+        snprintf(status, sizeof(status), "Có sẵn");
+    } else {
+        snprintf(status, sizeof(status), "Có sẵn %u/%u",
+                 (unsigned)book->available_count, (unsigned)book->copy_count);
+    }
+
     printf("  %-10u | %-40s | %-30s | %-15s\n",
            book->book_id,
            book->title,
            book->author,
-           book->is_borrowed ? "Đang được mượn" : "Có sẵn");
+           status);
 }
 
 /**
- * \brief           Hiển thị tất cả sách trong danh sách
+ * \brief           Ngữ cảnh thu thập kết quả vào bộ đệm của người gọi
+ */
+typedef struct {
+    uint32_t* ids;                              /*!< Bộ đệm ID (có thể NULL) */
+    const book_t** books;                       /*!< Bộ đệm con trỏ sách (có thể NULL) */
+    size_t capacity;                            /*!< Dung lượng bộ đệm */
+    size_t written;                             /*!< Số phần tử đã ghi */
+} book_collect_ctx_t;
+
+/**
+ * \brief           Hàm duyệt ghi sách vào bộ đệm, bỏ qua phần vượt dung lượng
+ * \param[in]       book: Sách khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref book_collect_ctx_t
+ * \return          Luôn 1 để tiếp tục đếm tổng số kết quả
+ */
+static uint8_t
+book_collect_visit(const book_t* book, void* ctx) {
+    book_collect_ctx_t* collect;
+
+    collect = ctx;
+    if (collect->written < collect->capacity) {
+        if (collect->ids != NULL) {
+            collect->ids[collect->written] = book->book_id;
+        }
+        if (collect->books != NULL) {
+            collect->books[collect->written] = book;
+        }
+        collect->written++;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Hàm duyệt in một dòng sách
+ * \param[in]       book: Sách khớp
+ * \param[in]       ctx: Không dùng
+ * \return          Luôn 1
+ */
+static uint8_t
+book_print_visit(const book_t* book, void* ctx) {
+    (void)ctx;
+    book_display_one(book);
+    return 1;
+}
+
+/**
+ * \brief           Duyệt các sách khớp bộ lọc theo thứ tự trong danh sách
  * \param[in]       list: Con trỏ tới danh sách sách
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       text: Chuỗi truy vấn cho \ref BOOK_FILTER_TITLE và \ref BOOK_FILTER_AUTHOR
+ * \param[in]       visit: Hàm nhận từng sách khớp (NULL = chỉ đếm)
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p visit
+ * \return          Số sách khớp đã duyệt (kể cả sách mà \p visit yêu cầu dừng)
  */
-void
-book_display_all(const book_list_t* list) {
+size_t
+book_query(const book_list_t* list, book_filter_t filter, const char* text,
+           book_visit_fn visit, void* ctx) {
+    char needle[MAX_STRING_LENGTH];
+    const book_t* book;
+    size_t matched;
     size_t i;
 
-    if (list == NULL || list->count == 0) {
-        printf("\n  Danh sách sách trống!\n");
-        return;
+    if (list == NULL || filter > BOOK_FILTER_AUTHOR) {
+        return 0;
+    }
+    if (filter == BOOK_FILTER_TITLE || filter == BOOK_FILTER_AUTHOR) {
+        if (text == NULL) {
+            return 0;
+        }
+        strncpy(needle, text, MAX_STRING_LENGTH - 1);
+        needle[MAX_STRING_LENGTH - 1] = '\0';
+        to_lowercase(needle);
     }
 
+    matched = 0;
+    for (i = 0; i < list->count; i++) {
+        book = &list->books[i];
+        if (!book_record_matches(book, filter, needle)) {
+            continue;
+        }
+
+        matched++;
+        if (visit != NULL && !visit(book, ctx)) {
+            break;
+        }
+    }
+
+    return matched;
+}
+
+/**
+ * \brief           Lấy ID các sách khớp bộ lọc vào bộ đệm của người gọi
+ * \param[in]       list: Con trỏ tới danh sách sách
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       text: Chuỗi truy vấn (nếu bộ lọc cần)
+ * \param[out]      ids: Bộ đệm nhận ID
+ * \param[in]       capacity: Số phần tử tối đa của \p ids
+ * \param[out]      total: Tổng số sách khớp, có thể lớn hơn \p capacity (có thể NULL)
+ * \return          Số ID đã ghi
+ */
+size_t
+book_query_ids(const book_list_t* list, book_filter_t filter, const char* text,
+               uint32_t* ids, size_t capacity, size_t* total) {
+    book_collect_ctx_t collect;
+    size_t matched;
+
+    collect.ids = ids;
+    collect.books = NULL;
+    collect.capacity = (ids != NULL) ? capacity : 0;
+    collect.written = 0;
+    matched = book_query(list, filter, text, book_collect_visit, &collect);
+    if (total != NULL) {
+        *total = matched;
+    }
+    return collect.written;
+}
+
+/**
+ * \brief           Lấy con trỏ tới các sách khớp bộ lọc vào bộ đệm của người gọi
+ * \param[in]       list: Con trỏ tới danh sách sách
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       text: Chuỗi truy vấn (nếu bộ lọc cần)
+ * \param[out]      books: Bộ đệm nhận con trỏ (hợp lệ khi danh sách chưa bị sửa)
+ * \param[in]       capacity: Số phần tử tối đa của \p books
+ * \param[out]      total: Tổng số sách khớp, có thể lớn hơn \p capacity (có thể NULL)
+ * \return          Số con trỏ đã ghi
+ */
+size_t
+book_query_handles(const book_list_t* list, book_filter_t filter, const char* text,
+                   const book_t** books, size_t capacity, size_t* total) {
+    book_collect_ctx_t collect;
+    size_t matched;
+
+    collect.ids = NULL;
+    collect.books = books;
+    collect.capacity = (books != NULL) ? capacity : 0;
+    collect.written = 0;
+    matched = book_query(list, filter, text, book_collect_visit, &collect);
+    if (total != NULL) {
+        *total = matched;
+    }
+    return collect.written;
+}
+
+/**
+ * \brief           Ngữ cảnh lấy một trang kết quả
+ */
+typedef struct {
+    size_t skip;                                /*!< Số kết quả còn phải bỏ qua */
+    book_collect_ctx_t collect;                 /*!< Bộ đệm nhận trang */
+    uint8_t more;                               /*!< 1 khi gặp kết quả sau trang */
+} book_page_ctx_t;
+
+/**
+ * \brief           Hàm duyệt bỏ qua \ref book_page_ctx_t.skip kết quả rồi ghi một trang
+ * \param[in]       book: Sách khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref book_page_ctx_t
+ * \return          0 khi đã thấy kết quả đầu tiên sau trang
+ */
+static uint8_t
+book_page_visit(const book_t* book, void* ctx) {
+    book_page_ctx_t* page;
+
+    page = ctx;
+    if (page->skip > 0) {
+        page->skip--;
+        return 1;
+    }
+    if (page->collect.written == page->collect.capacity) {
+        page->more = 1;
+        return 0;
+    }
+    page->collect.books[page->collect.written++] = book;
+    return 1;
+}
+
+/**
+ * \brief           Lấy một trang sách khớp bộ lọc
+ *
+ * Chỉ duyệt tới kết quả đầu tiên sau trang nên chi phí tỉ lệ với vị trí trang
+ * chứ không với cả danh sách; \ref BOOK_FILTER_ALL lấy thẳng một lát của mảng.
+ *
+ * \param[in]       list: Con trỏ tới danh sách sách
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       text: Chuỗi truy vấn (nếu bộ lọc cần)
+ * \param[in]       offset: Số sách khớp bỏ qua
+ * \param[out]      books: Bộ đệm nhận con trỏ (hợp lệ khi danh sách chưa bị sửa)
+ * \param[in]       capacity: Số phần tử tối đa của \p books
+ * \param[out]      more: 1 nếu còn sách khớp sau trang (có thể NULL)
+ * \return          Số con trỏ đã ghi
+ */
+size_t
+book_query_page(const book_list_t* list, book_filter_t filter, const char* text, size_t offset,
+                const book_t** books, size_t capacity, uint8_t* more) {
+    book_page_ctx_t page;
+    size_t i;
+
+    if (more != NULL) {
+        *more = 0;
+    }
+    if (list == NULL || books == NULL || capacity == 0) {
+        return 0;
+    }
+
+    if (filter == BOOK_FILTER_ALL) {
+        for (i = 0; i < capacity && offset + i < list->count; i++) {
+            books[i] = &list->books[offset + i];
+        }
+        if (more != NULL) {
+            *more = (offset < list->count && list->count - offset > capacity);
+        }
+        return i;
+    }
+
+    page.skip = offset;
+    page.collect.ids = NULL;
+    page.collect.books = books;
+    page.collect.capacity = capacity;
+    page.collect.written = 0;
+    page.more = 0;
+    book_query(list, filter, text, book_page_visit, &page);
+    if (more != NULL) {
+        *more = page.more;
+    }
+    return page.collect.written;
+}
+
+/**
+ * \brief           In tiêu đề bảng danh sách sách (cột khớp với \ref book_display_one)
+ */
+void
+book_display_header(void) {
     printf("\n  %-10s | %-40s | %-30s | %-15s\n", "ID", "Tiêu đề", "Tác giả", "Trạng thái");
     print_separator();
+}
 
-    for (i = 0; i < list->count; i++) {
-        book_display_one(&list->books[i]);
+/**
+ * \brief           Hiển thị tất cả sách trong danh sách
+ * \param[in]       list: Con trỏ tới danh sách sách
+ */
+void
+book_display_all(const book_list_t* list) {
+    size_t count;
+
+    if (list == NULL || list->count == 0) {
+        printf("\n  Danh sách sách trống!\n");
+        return;
     }
 
-    printf("\n  Tổng số sách: %zu\n", list->count);
+    book_display_header();
+    count = book_query(list, BOOK_FILTER_ALL, NULL, book_print_visit, NULL);
+    printf("\n  Tổng số sách: %zu\n", count);
 }
 
 /**
@@ -324,23 +1007,14 @@ book_display_all(const book_list_t* list) {
  */
 void
 book_display_available(const book_list_t* list) {
-    size_t i;
     size_t count;
 
     if (list == NULL) {
         return;
     }
 
-    count = 0;
-    printf("\n  %-10s | %-40s | %-30s | %-15s\n", "ID", "Tiêu đề", "Tác giả", "Trạng thái");
-    print_separator();
-
-    for (i = 0; i < list->count; i++) {
-        if (!list->books[i].is_borrowed) {
-            book_display_one(&list->books[i]);
-            count++;
-        }
-    }
+    book_display_header();
+    count = book_query(list, BOOK_FILTER_AVAILABLE, NULL, book_print_visit, NULL);
 
     if (count == 0) {
         printf("\n  Không có sách nào có sẵn!\n");
@@ -356,23 +1030,14 @@ book_display_available(const book_list_t* list) {
  */
 void
 book_search_by_title(const book_list_t* list, const char* title) {
-    size_t i;
     size_t count;
 
     if (list == NULL || title == NULL) {
         return;
     }
 
-    count = 0;
-    printf("\n  %-10s | %-40s | %-30s | %-15s\n", "ID", "Tiêu đề", "Tác giả", "Trạng thái");
-    print_separator();
-
-    for (i = 0; i < list->count; i++) {
-        if (string_contains(list->books[i].title, title)) {
-            book_display_one(&list->books[i]);
-            count++;
-        }
-    }
+    book_display_header();
+    count = book_query(list, BOOK_FILTER_TITLE, title, book_print_visit, NULL);
 
     if (count == 0) {
         printf("\n  Không tìm thấy sách nào với tiêu đề: %s\n", title);
@@ -388,23 +1053,14 @@ book_search_by_title(const book_list_t* list, const char* title) {
  */
 void
 book_search_by_author(const book_list_t* list, const char* author) {
-    size_t i;
     size_t count;
 
     if (list == NULL || author == NULL) {
         return;
     }
 
-    count = 0;
-    printf("\n  %-10s | %-40s | %-30s | %-15s\n", "ID", "Tiêu đề", "Tác giả", "Trạng thái");
-    print_separator();
-
-    for (i = 0; i < list->count; i++) {
-        if (string_contains(list->books[i].author, author)) {
-            book_display_one(&list->books[i]);
-            count++;
-        }
-    }
+    book_display_header();
+    count = book_query(list, BOOK_FILTER_AUTHOR, author, book_print_visit, NULL);
 
     if (count == 0) {
         printf("\n  Không tìm thấy sách nào của tác giả: %s\n", author);
@@ -427,9 +1083,31 @@ book_count_total(const book_list_t* list) {
 }
 
 /**
- * \brief           Đếm số sách đang được mượn
+ * \brief           Đếm tổng số bản sao vật lý
+ * \param[in]       list: Con trỏ tới danh sách sách
+ * \return          Tổng số bản sao của mọi đầu sách
+ */
+size_t
+book_count_copies(const book_list_t* list) {
+    size_t i;
+    size_t count;
+
+    if (list == NULL) {
+        return 0;
+    }
+
+    count = 0;
+    for (i = 0; i < list->count; i++) {
+        count += list->books[i].copy_count;
+    }
+
+    return count;
+}
+
+/**
+ * \brief           Đếm số bản sao đang được mượn
  * \param[in]       list: Con trỏ tới danh sách sách
- * \return          Số sách đang được mượn
+ * \return          Số bản sao đang được mượn
  */
 size_t
 book_count_borrowed(const book_list_t* list) {
@@ -442,18 +1120,16 @@ book_count_borrowed(const book_list_t* list) {
 
     count = 0;
     for (i = 0; i < list->count; i++) {
-        if (list->books[i].is_borrowed) {
-            count++;
-        }
+        count += (size_t)(list->books[i].copy_count - list->books[i].available_count);
     }
 
     return count;
 }
 
 /**
- * \brief           Đếm số sách có sẵn
+ * \brief           Đếm số bản sao có sẵn
  * \param[in]       list: Con trỏ tới danh sách sách
- * \return          Số sách có sẵn
+ * \return          Số bản sao có sẵn
  */
 size_t
 book_count_available(const book_list_t* list) {
@@ -466,11 +1142,8 @@ book_count_available(const book_list_t* list) {
 
     count = 0;
     for (i = 0; i < list->count; i++) {
-        if (!list->books[i].is_borrowed) {
-            count++;
-        }
+        count += list->books[i].available_count;
     }
 
     return count;
 }
-
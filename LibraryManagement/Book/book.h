@@ -37,6 +37,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "../Ultils/utils.h"
+#include "../Hold/hold.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,7 +46,22 @@ extern "C" {
 /* Định nghĩa các hằng số */
 #define MAX_TITLE_LENGTH            256
 #define MAX_AUTHOR_LENGTH           256
-#define MAX_BOOKS                   1000
+#ifndef MAX_BOOKS
+#define MAX_BOOKS                   1000        /*!< Có thể đặt lại khi build, ví dụ -DMAX_BOOKS=1000000 */
+#endif /* MAX_BOOKS */
+#define MAX_COPIES_PER_BOOK         64          /*!< Số bản sao tối đa của một đầu sách (= số bit của bitmap) */
+#define BOOK_COPY_BITS              6           /*!< Số bit dành cho chỉ số bản sao trong khóa item */
+#define BOOK_ID_FILTER_WORDS        KEY_FILTER_WORDS(MAX_BOOKS) /*!< Kích thước bộ lọc Bloom theo ID sách */
+
+/**
+ * \brief           Tạo khóa item (bản sao vật lý) từ ID sách và chỉ số bản sao
+ *
+ * Khóa item được lưu trong danh sách mượn của người dùng. Khóa giữ ID sách ở
+ * các bit cao nên sắp xếp theo khóa cũng là sắp xếp theo ID sách.
+ */
+#define BOOK_ITEM_KEY(book_id, copy)    (((uint32_t)(book_id) << BOOK_COPY_BITS) | (uint32_t)(copy))
+#define BOOK_ITEM_BOOK_ID(item_key)     ((uint32_t)(item_key) >> BOOK_COPY_BITS)
+#define BOOK_ITEM_COPY(item_key)        ((uint8_t)((item_key) & (MAX_COPIES_PER_BOOK - 1)))
 
 /**
  * \brief           Trạng thái trả về của các hàm quản lý sách
@@ -59,18 +75,48 @@ typedef enum {
     BOOK_FULL,                                  /*!< Danh sách sách đã đầy */
     BOOK_IS_BORROWED,                           /*!< Sách đang được mượn */
     BOOK_NOT_BORROWED,                          /*!< Sách chưa được mượn */
+    BOOK_COPY_LIMIT_REACHED,                    /*!< Đã đạt số bản sao tối đa */
+    BOOK_HAS_HOLDS,                             /*!< Sách đang có người đặt giữ */
 } book_status_t;
 
 /**
- * \brief           Cấu trúc dữ liệu của một cuốn sách
+ * \brief           Cấu trúc dữ liệu của một đầu sách (bản ghi thư mục)
+ *
+ * Một đầu sách giữ nhiều bản sao vật lý. Bit thứ i của \ref available_mask
+ * bằng 1 khi bản sao i đang có sẵn, nhờ đó lấy một bản sao bất kỳ chỉ cần
+ * một lệnh find-first-set.
  */
 typedef struct {
     uint32_t book_id;                           /*!< ID duy nhất của sách */
     char title[MAX_TITLE_LENGTH];               /*!< Tiêu đề sách */
     char author[MAX_AUTHOR_LENGTH];             /*!< Tác giả */
-    uint8_t is_borrowed;                        /*!< Trạng thái mượn: 1 = đã mượn, 0 = có sẵn */
+    uint8_t is_borrowed;                        /*!< Trạng thái mượn: 1 = mọi bản sao đã được mượn, 0 = còn bản có sẵn */
+    uint8_t copy_count;                         /*!< Số bản sao vật lý */
+    uint8_t available_count;                    /*!< Số bản sao có sẵn (cache của popcount(available_mask)) */
+    uint64_t available_mask;                    /*!< Bitmap bản sao có sẵn */
+    uint64_t isbn;                              /*!< ISBN-13 dạng số (0 = chưa gán) */
+    hold_queue_t holds;                         /*!< Hàng đợi đặt giữ (node nằm trong pool của thư viện) */
 } book_t;
 
+/**
+ * \brief           Loại thay đổi được báo cho observer của danh sách sách
+ */
+typedef enum {
+    BOOK_EVENT_ADDED = 0,                       /*!< Thêm sách mới */
+    BOOK_EVENT_UPDATED,                         /*!< Đổi thông tin sách */
+    BOOK_EVENT_DELETED,                         /*!< Xóa sách (bản ghi ngay trước khi xóa) */
+    BOOK_EVENT_COPIES_ADDED,                    /*!< Thêm bản sao */
+    BOOK_EVENT_AVAILABILITY,                    /*!< Một bản sao được mượn hoặc trả */
+} book_event_t;
+
+/**
+ * \brief           Hàm nhận thông báo sau mỗi thay đổi danh sách sách
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       book: Sách bị thay đổi
+ * \param[in,out]   ctx: Ngữ cảnh đăng ký cùng observer
+ */
+typedef void (*book_observer_fn)(book_event_t event, const book_t* book, void* ctx);
+
 /**
  * \brief           Cấu trúc quản lý danh sách sách
  */
@@ -78,8 +124,42 @@ typedef struct {
     book_t books[MAX_BOOKS];                    /*!< Mảng chứa các sách */
     size_t count;                               /*!< Số lượng sách hiện tại */
     uint32_t next_id;                           /*!< ID tiếp theo sẽ được gán */
+    uint64_t generation;                        /*!< Tăng sau mỗi thay đổi danh sách (dùng để vô hiệu hóa cache) */
+    uint64_t catalog_generation;                /*!< Chỉ tăng khi ID, vị trí, tiêu đề hoặc tác giả thay đổi (không tăng khi mượn/trả) */
+    book_observer_fn observer;                  /*!< Nhận thông báo thay đổi (NULL = không có) */
+    void* observer_ctx;                         /*!< Ngữ cảnh truyền cho observer */
+    uint64_t id_filter[BOOK_ID_FILTER_WORDS];   /*!< Bộ lọc Bloom các ID đang dùng (tra ID mới không cần quét) */
+    size_t id_filter_stale;                     /*!< Số ID đã xóa nhưng còn bit trong bộ lọc */
 } book_list_t;
 
+/**
+ * \brief           Bộ lọc cho các hàm truy vấn sách
+ */
+typedef enum {
+    BOOK_FILTER_ALL = 0,                        /*!< Mọi sách */
+    BOOK_FILTER_AVAILABLE,                      /*!< Sách còn ít nhất một bản có sẵn */
+    BOOK_FILTER_TITLE,                          /*!< Tiêu đề chứa chuỗi truy vấn (không phân biệt hoa thường) */
+    BOOK_FILTER_AUTHOR,                         /*!< Tác giả chứa chuỗi truy vấn (không phân biệt hoa thường) */
+} book_filter_t;
+
+/**
+ * \brief           Hàm nhận từng sách khớp bộ lọc
+ * \param[in]       book: Sách khớp (chỉ hợp lệ khi danh sách chưa bị sửa)
+ * \param[in,out]   ctx: Ngữ cảnh do người gọi truyền vào
+ * \return          1 để tiếp tục duyệt, 0 để dừng
+ */
+typedef uint8_t (*book_visit_fn)(const book_t* book, void* ctx);
+
+/* Khai báo các hàm thao tác trên một bản ghi sách */
+book_status_t   book_record_init(book_t* book, uint32_t book_id, const char* title, const char* author);
+book_status_t   book_record_update(book_t* book, const char* title, const char* author);
+book_status_t   book_record_check_delete(const book_t* book);
+book_status_t   book_record_add_copies(book_t* book, uint8_t count);
+book_status_t   book_record_checkout(book_t* book, uint8_t* copy);
+book_status_t   book_record_checkout_copy(book_t* book, uint8_t copy);
+book_status_t   book_record_return(book_t* book, uint8_t copy);
+uint8_t         book_record_matches(const book_t* book, book_filter_t filter, const char* needle_lower);
+
 /* Khai báo các hàm quản lý sách */
 void            book_init(book_list_t* list);
 book_status_t   book_add(book_list_t* list, const char* title, const char* author, uint32_t* assigned_id);
@@ -88,7 +168,26 @@ book_status_t   book_update(book_list_t* list, uint32_t book_id, const char* tit
 book_status_t   book_delete(book_list_t* list, uint32_t book_id);
 book_t*         book_find_by_id(book_list_t* list, uint32_t book_id);
 book_status_t   book_set_borrowed(book_list_t* list, uint32_t book_id, uint8_t is_borrowed);
+book_status_t   book_set_isbn(book_list_t* list, uint32_t book_id, uint64_t isbn);
+void            book_set_observer(book_list_t* list, book_observer_fn observer, void* ctx);
+void            book_notify(book_list_t* list, book_event_t event, const book_t* book);
+
+book_status_t   book_add_copies(book_list_t* list, uint32_t book_id, uint8_t count);
+book_status_t   book_checkout_copy(book_list_t* list, uint32_t book_id, uint8_t* copy);
+book_status_t   book_return_copy(book_list_t* list, uint32_t book_id, uint8_t copy);
+book_status_t   book_restore_copies(book_list_t* list, uint32_t book_id, uint8_t copy_count,
+                                    uint64_t available_mask);
+
+size_t          book_query(const book_list_t* list, book_filter_t filter, const char* text,
+                           book_visit_fn visit, void* ctx);
+size_t          book_query_ids(const book_list_t* list, book_filter_t filter, const char* text,
+                               uint32_t* ids, size_t capacity, size_t* total);
+size_t          book_query_handles(const book_list_t* list, book_filter_t filter, const char* text,
+                                   const book_t** books, size_t capacity, size_t* total);
+size_t          book_query_page(const book_list_t* list, book_filter_t filter, const char* text, size_t offset,
+                                const book_t** books, size_t capacity, uint8_t* more);
 
+void            book_display_header(void);
 void            book_display_all(const book_list_t* list);
 void            book_display_available(const book_list_t* list);
 void            book_display_one(const book_t* book);
@@ -96,6 +195,7 @@ void            book_search_by_title(const book_list_t* list, const char* title)
 void            book_search_by_author(const book_list_t* list, const char* author);
 
 size_t          book_count_total(const book_list_t* list);
+size_t          book_count_copies(const book_list_t* list);
 size_t          book_count_borrowed(const book_list_t* list);
 size_t          book_count_available(const book_list_t* list);
 
@@ -0,0 +1,349 @@
+/**
+ * \file            cache.c
+ * \brief           Triển khai cache LRU cho kết quả tìm kiếm sách
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <ctype.h>
+#include <string.h>
+#include "cache.h"
+
+/**
+ * \brief           Tính hash FNV-1a của khóa
+ * \param[in]       key: Khóa
+ * \return          Giá trị hash
+ */
+static uint32_t
+query_cache_hash(const char* key) {
+    uint32_t hash;
+
+    hash = 2166136261u;
+    while (*key != '\0') {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * \brief           Ngữ cảnh khi quét tuần tự để điền một entry
+ */
+typedef struct {
+    const book_list_t* list;                    /*!< Danh sách được quét */
+    query_cache_entry_t* entry;                 /*!< Entry nhận kết quả */
+} query_cache_fill_ctx_t;
+
+/**
+ * \brief           Hàm duyệt ghi vị trí sách khớp vào entry
+ * \param[in]       book: Sách khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref query_cache_fill_ctx_t
+ * \return          Luôn 1 để tiếp tục đếm tổng số kết quả
+ */
+static uint8_t
+query_cache_fill_visit(const book_t* book, void* ctx) {
+    query_cache_fill_ctx_t* fill;
+
+    fill = ctx;
+    if (fill->entry->count < QUERY_CACHE_MAX_RESULTS) {
+        fill->entry->indices[fill->entry->count++] = (uint32_t)(book - fill->list->books);
+    }
+    return 1;
+}
+
+/**
+ * \brief           Gỡ entry khỏi danh sách LRU
+ * \param[in,out]   cache: Con trỏ tới cache
+ * \param[in]       index: Chỉ số entry
+ */
+static void
+query_cache_lru_unlink(query_cache_t* cache, uint16_t index) {
+    query_cache_entry_t* entry;
+
+    entry = &cache->entries[index];
+    if (entry->prev != QUERY_CACHE_NIL) {
+        cache->entries[entry->prev].next = entry->next;
+    } else {
+        cache->lru_head = entry->next;
+    }
+    if (entry->next != QUERY_CACHE_NIL) {
+        cache->entries[entry->next].prev = entry->prev;
+    } else {
+        cache->lru_tail = entry->prev;
+    }
+    entry->prev = QUERY_CACHE_NIL;
+    entry->next = QUERY_CACHE_NIL;
+}
+
+/**
+ * \brief           Đưa entry lên đầu danh sách LRU
+ * \param[in,out]   cache: Con trỏ tới cache
+ * \param[in]       index: Chỉ số entry (chưa nằm trong danh sách LRU)
+ */
+static void
+query_cache_lru_push_front(query_cache_t* cache, uint16_t index) {
+    query_cache_entry_t* entry;
+
+    entry = &cache->entries[index];
+    entry->prev = QUERY_CACHE_NIL;
+    entry->next = cache->lru_head;
+    if (cache->lru_head != QUERY_CACHE_NIL) {
+        cache->entries[cache->lru_head].prev = index;
+    } else {
+        cache->lru_tail = index;
+    }
+    cache->lru_head = index;
+}
+
+/**
+ * \brief           Gỡ entry khỏi bảng băm, danh sách LRU và trả về danh sách trống
+ * \param[in,out]   cache: Con trỏ tới cache
+ * \param[in]       index: Chỉ số entry
+ */
+static void
+query_cache_release(query_cache_t* cache, uint16_t index) {
+    uint16_t* link;
+
+    link = &cache->buckets[cache->entries[index].hash & (QUERY_CACHE_BUCKETS - 1)];
+    while (*link != QUERY_CACHE_NIL && *link != index) {
+        link = &cache->entries[*link].chain;
+    }
+    if (*link == index) {
+        *link = cache->entries[index].chain;
+    }
+
+    query_cache_lru_unlink(cache, index);
+    cache->entries[index].key[0] = '\0';
+    cache->entries[index].list = NULL;
+    cache->entries[index].chain = cache->free_head;
+    cache->free_head = index;
+}
+
+/**
+ * \brief           Khởi tạo cache rỗng
+ * \param[out]      cache: Con trỏ tới cache
+ */
+void
+query_cache_init(query_cache_t* cache) {
+    size_t i;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    for (i = 0; i < QUERY_CACHE_BUCKETS; i++) {
+        cache->buckets[i] = QUERY_CACHE_NIL;
+    }
+    for (i = 0; i < QUERY_CACHE_CAPACITY; i++) {
+        cache->entries[i].key[0] = '\0';
+        cache->entries[i].list = NULL;
+        cache->entries[i].prev = QUERY_CACHE_NIL;
+        cache->entries[i].next = QUERY_CACHE_NIL;
+        cache->entries[i].chain = (i + 1 < QUERY_CACHE_CAPACITY) ? (uint16_t)(i + 1) : QUERY_CACHE_NIL;
+    }
+    cache->free_head = 0;
+    cache->lru_head = QUERY_CACHE_NIL;
+    cache->lru_tail = QUERY_CACHE_NIL;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->stale = 0;
+    cache->scan = NULL;
+}
+
+/**
+ * \brief           Xóa mọi entry (giữ nguyên bộ đếm thống kê và pool quét)
+ * \param[in,out]   cache: Con trỏ tới cache
+ */
+void
+query_cache_clear(query_cache_t* cache) {
+    scan_pool_t* scan;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stale;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    scan = cache->scan;
+    hits = cache->hits;
+    misses = cache->misses;
+    stale = cache->stale;
+    query_cache_init(cache);
+    cache->scan = scan;
+    cache->hits = hits;
+    cache->misses = misses;
+    cache->stale = stale;
+}
+
+/**
+ * \brief           Chuẩn hóa truy vấn thành khóa cache
+ *
+ * Khóa gồm một ký tự chỉ trường ('t' hoặc 'a') theo sau là truy vấn đã bỏ khoảng
+ * trắng hai đầu và chuyển sang chữ thường, nên "  Lập Trình C " và "lập trình c"
+ * dùng chung một entry.
+ *
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       query: Truy vấn gốc
+ * \param[out]      key: Bộ đệm nhận khóa
+ * \param[in]       key_size: Kích thước bộ đệm
+ * \return          Độ dài khóa, 0 nếu truy vấn rỗng hoặc không hợp lệ
+ */
+size_t
+query_cache_normalize(query_field_t field, const char* query, char* key, size_t key_size) {
+    const char* start;
+    const char* end;
+    size_t len;
+    size_t i;
+
+    if (query == NULL || key == NULL || key_size < 2 || field > QUERY_FIELD_AUTHOR) {
+        return 0;
+    }
+
+    start = query;
+    while (isspace((unsigned char)*start)) {
+        start++;
+    }
+    end = start + strlen(start);
+    while (end > start && isspace((unsigned char)end[-1])) {
+        end--;
+    }
+
+    len = (size_t)(end - start);
+    if (len == 0) {
+        return 0;
+    }
+    if (len > key_size - 2) {
+        len = key_size - 2;
+    }
+
+    key[0] = (field == QUERY_FIELD_TITLE) ? 't' : 'a';
+    for (i = 0; i < len; i++) {
+        key[i + 1] = (char)tolower((unsigned char)start[i]);
+    }
+    key[len + 1] = '\0';
+    return len + 1;
+}
+
+/**
+ * \brief           Tìm kiếm sách qua cache
+ *
+ * Trúng cache khi có entry cùng khóa, cùng danh sách và cùng generation. Entry
+ * có generation cũ được bỏ ngay khi gặp, không cần duyệt toàn bộ cache khi
+ * danh sách thay đổi. Khi trượt, danh sách được quét một lần và kết quả thay
+ * thế entry dùng lâu nhất. Khi cache có pool quét, lần quét chạy song song
+ * và kết quả theo thứ tự ID; nếu không, kết quả theo thứ tự trong danh sách.
+ *
+ * \param[in,out]   cache: Con trỏ tới cache
+ * \param[in]       list: Danh sách sách
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       query: Truy vấn (tìm kiếm một phần, không phân biệt hoa thường)
+ * \param[out]      result: Kết quả tìm kiếm
+ * \return          \ref QUERY_CACHE_OK nếu thành công, \ref query_cache_status_t nếu lỗi
+ */
+query_cache_status_t
+query_cache_search(query_cache_t* cache, const book_list_t* list, query_field_t field,
+                   const char* query, query_result_t* result) {
+    char key[QUERY_CACHE_KEY_LENGTH];
+    query_cache_entry_t* entry;
+    query_cache_fill_ctx_t fill;
+    scan_result_t scanned;
+    uint32_t hash;
+    uint16_t index;
+    uint16_t* bucket;
+
+    if (cache == NULL || list == NULL || result == NULL
+        || query_cache_normalize(field, query, key, sizeof(key)) == 0) {
+        return QUERY_CACHE_INVALID_INPUT;
+    }
+
+    hash = query_cache_hash(key);
+    bucket = &cache->buckets[hash & (QUERY_CACHE_BUCKETS - 1)];
+
+    /* Tra bảng băm */
+    for (index = *bucket; index != QUERY_CACHE_NIL; index = cache->entries[index].chain) {
+        entry = &cache->entries[index];
+        if (entry->hash == hash && entry->list == list && strcmp(entry->key, key) == 0) {
+            break;
+        }
+    }
+
+    if (index != QUERY_CACHE_NIL) {
+        entry = &cache->entries[index];
+        if (entry->generation == list->generation) {
+            cache->hits++;
+            query_cache_lru_unlink(cache, index);
+            query_cache_lru_push_front(cache, index);
+            result->indices = entry->indices;
+            result->count = entry->count;
+            result->total = entry->total;
+            result->from_cache = 1;
+            return QUERY_CACHE_OK;
+        }
+        cache->stale++;
+        query_cache_release(cache, index);
+    }
+
+    /* Trượt: lấy entry trống hoặc thay thế entry dùng lâu nhất */
+    cache->misses++;
+    if (cache->free_head == QUERY_CACHE_NIL) {
+        query_cache_release(cache, cache->lru_tail);
+    }
+    index = cache->free_head;
+    entry = &cache->entries[index];
+    cache->free_head = entry->chain;
+
+    strcpy(entry->key, key);
+    entry->hash = hash;
+    entry->list = list;
+    entry->generation = list->generation;
+    entry->total = 0;
+    entry->count = 0;
+    if (cache->scan != NULL
+        && scan_books_match(cache->scan, list, field, &key[1], &scanned) == SCAN_OK) {
+        entry->total = (uint32_t)scanned.count;
+        entry->count = (entry->total < QUERY_CACHE_MAX_RESULTS) ? entry->total : QUERY_CACHE_MAX_RESULTS;
+        memcpy(entry->indices, scanned.positions, entry->count * sizeof(entry->indices[0]));
+    } else {
+        fill.list = list;
+        fill.entry = entry;
+        entry->total = (uint32_t)book_query(list, (field == QUERY_FIELD_TITLE) ? BOOK_FILTER_TITLE : BOOK_FILTER_AUTHOR,
+                                            &key[1], query_cache_fill_visit, &fill);
+    }
+
+    entry->chain = *bucket;
+    *bucket = index;
+    query_cache_lru_push_front(cache, index);
+
+    result->indices = entry->indices;
+    result->count = entry->count;
+    result->total = entry->total;
+    result->from_cache = 0;
+    return QUERY_CACHE_OK;
+}
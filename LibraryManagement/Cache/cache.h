@@ -0,0 +1,119 @@
+/**
+ * \file            cache.h
+ * \brief           Cache LRU cho kết quả tìm kiếm sách, vô hiệu hóa theo generation
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef CACHE_HDR_H
+#define CACHE_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../Book/book.h"
+#include "../Scan/scan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define QUERY_CACHE_CAPACITY        64          /*!< Số truy vấn được cache */
+#define QUERY_CACHE_BUCKETS         128         /*!< Số bucket bảng băm (lũy thừa của 2) */
+#define QUERY_CACHE_MAX_RESULTS     256         /*!< Số kết quả tối đa lưu cho một truy vấn */
+#define QUERY_CACHE_KEY_LENGTH      (MAX_STRING_LENGTH + 1) /*!< Tiền tố trường + truy vấn đã chuẩn hóa */
+#define QUERY_CACHE_NIL             UINT16_MAX  /*!< Chỉ số entry rỗng */
+
+/**
+ * \brief           Trạng thái trả về của các hàm cache
+ */
+typedef enum {
+    QUERY_CACHE_OK = 0,                         /*!< Thành công */
+    QUERY_CACHE_ERROR,                          /*!< Lỗi chung */
+    QUERY_CACHE_INVALID_INPUT,                  /*!< Dữ liệu đầu vào không hợp lệ */
+} query_cache_status_t;
+
+/**
+ * \brief           Một truy vấn đã cache
+ *
+ * Kết quả lưu dưới dạng vị trí trong \ref book_list_t::books. Vị trí chỉ thay đổi
+ * khi danh sách bị sửa, và mọi thay đổi đều tăng generation nên entry có
+ * generation khác danh sách sẽ bị bỏ khi tra cứu.
+ */
+typedef struct {
+    char key[QUERY_CACHE_KEY_LENGTH];           /*!< Khóa đã chuẩn hóa */
+    uint32_t hash;                              /*!< Hash của khóa */
+    const book_list_t* list;                    /*!< Danh sách đã được quét */
+    uint64_t generation;                        /*!< Generation của danh sách khi quét */
+    uint32_t total;                             /*!< Tổng số sách khớp */
+    uint32_t count;                             /*!< Số vị trí được lưu (tối đa \ref QUERY_CACHE_MAX_RESULTS) */
+    uint32_t indices[QUERY_CACHE_MAX_RESULTS];  /*!< Vị trí các sách khớp */
+    uint16_t chain;                             /*!< Entry kế tiếp trong cùng bucket */
+    uint16_t prev;                              /*!< Entry dùng gần hơn (LRU) */
+    uint16_t next;                              /*!< Entry dùng lâu hơn (LRU) */
+} query_cache_entry_t;
+
+/**
+ * \brief           Cache truy vấn: bảng băm + danh sách LRU trên mảng tĩnh
+ */
+typedef struct {
+    query_cache_entry_t entries[QUERY_CACHE_CAPACITY]; /*!< Các entry */
+    uint16_t buckets[QUERY_CACHE_BUCKETS];      /*!< Đầu chuỗi của từng bucket */
+    uint16_t lru_head;                          /*!< Entry dùng gần nhất */
+    uint16_t lru_tail;                          /*!< Entry dùng lâu nhất */
+    uint16_t free_head;                         /*!< Danh sách entry trống (nối qua chain) */
+    uint64_t hits;                              /*!< Số lần trúng cache */
+    uint64_t misses;                            /*!< Số lần phải quét */
+    uint64_t stale;                             /*!< Số entry bị bỏ vì generation cũ */
+    scan_pool_t* scan;                          /*!< Pool quét song song khi trượt cache (NULL = quét tuần tự) */
+} query_cache_t;
+
+/**
+ * \brief           Kết quả tìm kiếm; con trỏ chỉ hợp lệ tới lần gọi cache kế tiếp
+ *                  và khi danh sách chưa bị sửa
+ */
+typedef struct {
+    const uint32_t* indices;                    /*!< Vị trí các sách khớp */
+    size_t count;                               /*!< Số vị trí trong indices */
+    size_t total;                               /*!< Tổng số sách khớp (> count nếu bị cắt) */
+    uint8_t from_cache;                         /*!< 1 nếu trúng cache */
+} query_result_t;
+
+/* Khai báo các hàm cache truy vấn */
+void            query_cache_init(query_cache_t* cache);
+void            query_cache_clear(query_cache_t* cache);
+query_cache_status_t query_cache_search(query_cache_t* cache, const book_list_t* list, query_field_t field,
+                                        const char* query, query_result_t* result);
+size_t          query_cache_normalize(query_field_t field, const char* query, char* key, size_t key_size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CACHE_HDR_H */
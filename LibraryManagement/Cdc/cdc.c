@@ -0,0 +1,723 @@
+/**
+ * \file            cdc.c
+ * \brief           Triển khai nhật ký thay đổi dạng vòng đệm và các định dạng xuất
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include "cdc.h"
+
+/**
+ * \brief           Bộ đệm ghi dùng khi mã hóa một bản ghi
+ */
+typedef struct {
+    uint8_t* data;                              /*!< Vùng nhớ của người gọi */
+    size_t capacity;                            /*!< Dung lượng vùng nhớ */
+    size_t length;                              /*!< Số byte đã ghi */
+    uint8_t overflow;                           /*!< 1 nếu dữ liệu vượt dung lượng */
+} cdc_writer_t;
+
+/**
+ * \brief           Bộ đọc tuần tự khi giải mã bản ghi nhị phân
+ */
+typedef struct {
+    const uint8_t* data;                        /*!< Dữ liệu của bản ghi */
+    size_t length;                              /*!< Độ dài bản ghi */
+    size_t pos;                                 /*!< Vị trí đọc */
+    uint8_t error;                              /*!< 1 nếu đọc quá biên hoặc dữ liệu sai */
+} cdc_reader_t;
+
+/* Tên thao tác trong JSON, theo thứ tự của \ref cdc_op_t */
+static const char* const cdc_op_names[] = {
+    "snapshot", "book_upsert", "book_delete", "book_availability",
+    "user_upsert", "user_delete", "loan", "return",
+};
+
+/**
+ * \brief           Cấp ô cho bản ghi kế tiếp (ghi đè bản ghi cũ nhất khi đầy)
+ * \param[in,out]   log: Con trỏ tới nhật ký
+ * \param[in]       op: Loại thay đổi
+ * \param[in]       id: ID bản ghi bị thay đổi
+ * \return          Bản ghi mới, phần dữ liệu do người gọi điền
+ */
+static cdc_record_t*
+cdc_append(cdc_log_t* log, cdc_op_t op, uint32_t id) {
+    cdc_record_t* record;
+
+    record = &log->ring[log->head & (CDC_RING_CAPACITY - 1)];
+    log->head++;
+    record->seq = log->head;
+    record->op = op;
+    record->id = id;
+    return record;
+}
+
+/**
+ * \brief           Điền bản ghi sách đầy đủ
+ * \param[out]      record: Bản ghi cần điền
+ * \param[in]       book: Sách nguồn
+ */
+static void
+cdc_fill_book(cdc_record_t* record, const book_t* book) {
+    memcpy(record->data.book.title, book->title, sizeof(record->data.book.title));
+    memcpy(record->data.book.author, book->author, sizeof(record->data.book.author));
+    record->data.book.copy_count = book->copy_count;
+    record->data.book.available_mask = book->available_mask;
+}
+
+/**
+ * \brief           Điền bản ghi người dùng
+ * \param[out]      record: Bản ghi cần điền
+ * \param[in]       user: Người dùng nguồn
+ */
+static void
+cdc_fill_user(cdc_record_t* record, const user_t* user) {
+    memcpy(record->data.user.name, user->name, sizeof(record->data.user.name));
+    record->data.user.tier = user->tier;
+}
+
+/**
+ * \brief           Observer của danh sách sách
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       book: Sách bị thay đổi
+ * \param[in,out]   ctx: Nhật ký nhận bản ghi
+ */
+static void
+cdc_book_observer(book_event_t event, const book_t* book, void* ctx) {
+    cdc_log_t* log;
+    cdc_record_t* record;
+
+    log = (cdc_log_t*)ctx;
+    switch (event) {
+        case BOOK_EVENT_DELETED:
+            cdc_append(log, CDC_OP_BOOK_DELETE, book->book_id);
+            break;
+        case BOOK_EVENT_AVAILABILITY:
+            /* Mượn/trả là thay đổi thường gặp nhất: không chép tiêu đề và tác giả */
+            record = cdc_append(log, CDC_OP_BOOK_AVAILABILITY, book->book_id);
+            record->data.book.copy_count = book->copy_count;
+            record->data.book.available_mask = book->available_mask;
+            break;
+        default:
+            cdc_fill_book(cdc_append(log, CDC_OP_BOOK_UPSERT, book->book_id), book);
+            break;
+    }
+}
+
+/**
+ * \brief           Observer của danh sách người dùng
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       user: Người dùng bị thay đổi
+ * \param[in,out]   ctx: Nhật ký nhận bản ghi
+ */
+static void
+cdc_user_observer(user_event_t event, const user_t* user, void* ctx) {
+    cdc_log_t* log;
+
+    log = (cdc_log_t*)ctx;
+    if (event == USER_EVENT_DELETED) {
+        cdc_append(log, CDC_OP_USER_DELETE, user->user_id);
+    } else {
+        cdc_fill_user(cdc_append(log, CDC_OP_USER_UPSERT, user->user_id), user);
+    }
+}
+
+/**
+ * \brief           Khởi tạo nhật ký rỗng
+ * \param[out]      log: Con trỏ tới nhật ký
+ */
+void
+cdc_init(cdc_log_t* log) {
+    if (log != NULL) {
+        log->head = 0;
+    }
+}
+
+/**
+ * \brief           Ghi nhận mọi thay đổi của hai danh sách vào nhật ký
+ *
+ * Mượn/trả được ghi bởi tầng quản lý qua \ref cdc_record_loan khi
+ * \ref library_t::cdc trỏ tới nhật ký này.
+ *
+ * \param[in,out]   log: Con trỏ tới nhật ký
+ * \param[in,out]   books: Danh sách sách (có thể NULL)
+ * \param[in,out]   users: Danh sách người dùng (có thể NULL)
+ */
+void
+cdc_attach(cdc_log_t* log, book_list_t* books, user_list_t* users) {
+    if (log == NULL) {
+        return;
+    }
+    book_set_observer(books, cdc_book_observer, log);
+    user_set_observer(users, cdc_user_observer, log);
+}
+
+/**
+ * \brief           Ghi nhận một lượt mượn hoặc trả bản sao
+ * \param[in,out]   log: Con trỏ tới nhật ký (NULL = bỏ qua)
+ * \param[in]       op: \ref CDC_OP_LOAN hoặc \ref CDC_OP_RETURN
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       item_key: Khóa item của bản sao
+ */
+void
+cdc_record_loan(cdc_log_t* log, cdc_op_t op, uint32_t user_id, uint32_t item_key) {
+    cdc_record_t* record;
+
+    if (log == NULL || (op != CDC_OP_LOAN && op != CDC_OP_RETURN)) {
+        return;
+    }
+
+    record = cdc_append(log, op, user_id);
+    record->data.loan.book_id = BOOK_ITEM_BOOK_ID(item_key);
+    record->data.loan.copy = BOOK_ITEM_COPY(item_key);
+}
+
+/**
+ * \brief           Số thứ tự của bản ghi mới nhất
+ * \param[in]       log: Con trỏ tới nhật ký
+ * \return          Số thứ tự, 0 nếu nhật ký rỗng
+ */
+uint64_t
+cdc_head(const cdc_log_t* log) {
+    return (log != NULL) ? log->head : 0;
+}
+
+/**
+ * \brief           Số thứ tự của bản ghi cũ nhất còn trong vòng đệm
+ * \param[in]       log: Con trỏ tới nhật ký
+ * \return          Số thứ tự (lớn hơn \ref cdc_head khi nhật ký rỗng)
+ */
+uint64_t
+cdc_oldest(const cdc_log_t* log) {
+    if (log == NULL || log->head <= CDC_RING_CAPACITY) {
+        return 1;
+    }
+    return log->head - CDC_RING_CAPACITY + 1;
+}
+
+/**
+ * \brief           Đọc các bản ghi sau con trỏ
+ * \param[in]       log: Con trỏ tới nhật ký
+ * \param[in]       cursor: Số thứ tự cuối cùng người nhận đã có
+ * \param[out]      records: Mảng nhận bản ghi
+ * \param[in]       capacity: Số phần tử của \p records
+ * \param[out]      count: Số bản ghi đã chép
+ * \return          \ref CDC_OK nếu thành công, \ref CDC_LAGGING nếu cần snapshot,
+ *                  \ref cdc_status_t nếu lỗi khác
+ */
+cdc_status_t
+cdc_read(const cdc_log_t* log, uint64_t cursor, cdc_record_t* records,
+         size_t capacity, size_t* count) {
+    uint64_t seq;
+    size_t n;
+
+    if (log == NULL || count == NULL || (records == NULL && capacity > 0)) {
+        return CDC_INVALID_INPUT;
+    }
+    *count = 0;
+    if (cursor > log->head) {
+        return CDC_INVALID_INPUT;
+    }
+    if (cursor + 1 < cdc_oldest(log)) {
+        return CDC_LAGGING;
+    }
+
+    n = 0;
+    for (seq = cursor + 1; seq <= log->head && n < capacity; seq++) {
+        records[n++] = log->ring[(seq - 1) & (CDC_RING_CAPACITY - 1)];
+    }
+    *count = n;
+    return CDC_OK;
+}
+
+/**
+ * \brief           Ghi chuỗi byte vào bộ đệm
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       bytes: Dữ liệu
+ * \param[in]       length: Số byte
+ */
+static void
+cdc_put_bytes(cdc_writer_t* writer, const void* bytes, size_t length) {
+    if (writer->overflow || writer->capacity - writer->length < length) {
+        writer->overflow = 1;
+        return;
+    }
+    memcpy(&writer->data[writer->length], bytes, length);
+    writer->length += length;
+}
+
+/**
+ * \brief           Ghi số nguyên không dấu little-endian
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       value: Giá trị
+ * \param[in]       size: Số byte (1, 2, 4 hoặc 8)
+ */
+static void
+cdc_put_uint(cdc_writer_t* writer, uint64_t value, size_t size) {
+    uint8_t bytes[8];
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+    cdc_put_bytes(writer, bytes, size);
+}
+
+/**
+ * \brief           Ghi chuỗi kèm tiền tố độ dài 16 bit
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       text: Chuỗi
+ */
+static void
+cdc_put_string(cdc_writer_t* writer, const char* text) {
+    size_t length;
+
+    length = strlen(text);
+    cdc_put_uint(writer, length, 2);
+    cdc_put_bytes(writer, text, length);
+}
+
+/**
+ * \brief           Ghi văn bản có định dạng
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       format: Chuỗi định dạng printf
+ */
+static void
+cdc_printf(cdc_writer_t* writer, const char* format, ...) {
+    va_list args;
+    int written;
+
+    if (writer->overflow) {
+        return;
+    }
+
+    va_start(args, format);
+    written = vsnprintf((char*)&writer->data[writer->length], writer->capacity - writer->length, format, args);
+    va_end(args);
+
+    if (written < 0 || (size_t)written >= writer->capacity - writer->length) {
+        writer->overflow = 1;
+        return;
+    }
+    writer->length += (size_t)written;
+}
+
+/**
+ * \brief           Ghi chuỗi JSON (đã thoát ký tự đặc biệt, giữ nguyên UTF-8)
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       text: Chuỗi
+ */
+static void
+cdc_put_json_string(cdc_writer_t* writer, const char* text) {
+    const unsigned char* p;
+    const unsigned char* run;
+
+    cdc_put_bytes(writer, "\"", 1);
+    run = (const unsigned char*)text;
+    for (p = run; *p != '\0'; p++) {
+        if (*p != '"' && *p != '\\' && *p >= 0x20) {
+            continue;
+        }
+        cdc_put_bytes(writer, run, (size_t)(p - run));
+        if (*p == '"' || *p == '\\') {
+            cdc_printf(writer, "\\%c", *p);
+        } else {
+            cdc_printf(writer, "\\u%04x", *p);
+        }
+        run = p + 1;
+    }
+    cdc_put_bytes(writer, run, (size_t)(p - run));
+    cdc_put_bytes(writer, "\"", 1);
+}
+
+/**
+ * \brief           Mã hóa nhị phân: u32 độ dài | u64 seq | u8 op | u32 id | dữ liệu
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       record: Bản ghi
+ */
+static void
+cdc_encode_binary(cdc_writer_t* writer, const cdc_record_t* record) {
+    size_t length;
+
+    cdc_put_uint(writer, 0, 4);
+    cdc_put_uint(writer, record->seq, 8);
+    cdc_put_uint(writer, (uint64_t)record->op, 1);
+    cdc_put_uint(writer, record->id, 4);
+
+    switch (record->op) {
+        case CDC_OP_BOOK_UPSERT:
+            cdc_put_uint(writer, record->data.book.copy_count, 1);
+            cdc_put_uint(writer, record->data.book.available_mask, 8);
+            cdc_put_string(writer, record->data.book.title);
+            cdc_put_string(writer, record->data.book.author);
+            break;
+        case CDC_OP_BOOK_AVAILABILITY:
+            cdc_put_uint(writer, record->data.book.copy_count, 1);
+            cdc_put_uint(writer, record->data.book.available_mask, 8);
+            break;
+        case CDC_OP_USER_UPSERT:
+            cdc_put_uint(writer, (uint64_t)record->data.user.tier, 1);
+            cdc_put_string(writer, record->data.user.name);
+            break;
+        case CDC_OP_LOAN:
+        case CDC_OP_RETURN:
+            cdc_put_uint(writer, record->data.loan.book_id, 4);
+            cdc_put_uint(writer, record->data.loan.copy, 1);
+            break;
+        default:
+            break;
+    }
+
+    /* Điền độ dài vào tiền tố */
+    if (!writer->overflow) {
+        length = writer->length;
+        writer->length = 0;
+        cdc_put_uint(writer, length, 4);
+        writer->length = length;
+    }
+}
+
+/**
+ * \brief           Mã hóa một dòng JSON
+ * \param[in,out]   writer: Bộ đệm ghi
+ * \param[in]       record: Bản ghi
+ */
+static void
+cdc_encode_json(cdc_writer_t* writer, const cdc_record_t* record) {
+    cdc_printf(writer, "{\"seq\":%llu,\"op\":\"%s\",\"id\":%u",
+               (unsigned long long)record->seq, cdc_op_names[record->op], record->id);
+
+    switch (record->op) {
+        case CDC_OP_BOOK_UPSERT:
+            cdc_printf(writer, ",\"title\":");
+            cdc_put_json_string(writer, record->data.book.title);
+            cdc_printf(writer, ",\"author\":");
+            cdc_put_json_string(writer, record->data.book.author);
+            /* fall through */
+        case CDC_OP_BOOK_AVAILABILITY:
+            cdc_printf(writer, ",\"copies\":%u,\"available\":%d,\"available_mask\":%llu",
+                       record->data.book.copy_count, __builtin_popcountll(record->data.book.available_mask),
+                       (unsigned long long)record->data.book.available_mask);
+            break;
+        case CDC_OP_USER_UPSERT:
+            cdc_printf(writer, ",\"name\":");
+            cdc_put_json_string(writer, record->data.user.name);
+            cdc_printf(writer, ",\"tier\":%d", (int)record->data.user.tier);
+            break;
+        case CDC_OP_LOAN:
+        case CDC_OP_RETURN:
+            cdc_printf(writer, ",\"book_id\":%u,\"copy\":%u", record->data.loan.book_id, record->data.loan.copy);
+            break;
+        default:
+            break;
+    }
+    cdc_printf(writer, "}\n");
+}
+
+/**
+ * \brief           Mã hóa một bản ghi
+ * \param[in]       record: Bản ghi
+ * \param[in]       format: Định dạng
+ * \param[out]      buffer: Vùng nhớ nhận dữ liệu (nên có \ref CDC_MAX_ENCODED byte)
+ * \param[in]       capacity: Dung lượng \p buffer
+ * \return          Số byte đã ghi, 0 nếu lỗi hoặc không đủ chỗ
+ */
+size_t
+cdc_encode(const cdc_record_t* record, cdc_format_t format, uint8_t* buffer, size_t capacity) {
+    cdc_writer_t writer;
+
+    if (record == NULL || buffer == NULL || (size_t)record->op >= sizeof(cdc_op_names) / sizeof(cdc_op_names[0])) {
+        return 0;
+    }
+
+    writer.data = buffer;
+    writer.capacity = capacity;
+    writer.length = 0;
+    writer.overflow = 0;
+    if (format == CDC_FORMAT_BINARY) {
+        cdc_encode_binary(&writer, record);
+    } else {
+        cdc_encode_json(&writer, record);
+    }
+    return writer.overflow ? 0 : writer.length;
+}
+
+/**
+ * \brief           Đọc số nguyên không dấu little-endian
+ * \param[in,out]   reader: Bộ đọc
+ * \param[in]       size: Số byte (1, 2, 4 hoặc 8)
+ * \return          Giá trị, 0 nếu hết dữ liệu
+ */
+static uint64_t
+cdc_get_uint(cdc_reader_t* reader, size_t size) {
+    uint64_t value;
+    size_t i;
+
+    if (reader->error || reader->length - reader->pos < size) {
+        reader->error = 1;
+        return 0;
+    }
+    value = 0;
+    for (i = 0; i < size; i++) {
+        value |= (uint64_t)reader->data[reader->pos + i] << (8 * i);
+    }
+    reader->pos += size;
+    return value;
+}
+
+/**
+ * \brief           Đọc chuỗi có tiền tố độ dài 16 bit
+ * \param[in,out]   reader: Bộ đọc
+ * \param[out]      text: Bộ đệm nhận chuỗi (kết thúc bằng '\0')
+ * \param[in]       capacity: Dung lượng \p text
+ */
+static void
+cdc_get_string(cdc_reader_t* reader, char* text, size_t capacity) {
+    size_t length;
+
+    length = (size_t)cdc_get_uint(reader, 2);
+    if (reader->error || length >= capacity || reader->length - reader->pos < length) {
+        reader->error = 1;
+        text[0] = '\0';
+        return;
+    }
+    memcpy(text, &reader->data[reader->pos], length);
+    text[length] = '\0';
+    reader->pos += length;
+}
+
+/**
+ * \brief           Giải mã một bản ghi nhị phân ở đầu bộ đệm
+ * \param[in]       buffer: Dữ liệu (có thể chứa nhiều bản ghi hoặc một phần bản ghi)
+ * \param[in]       length: Số byte trong \p buffer
+ * \param[out]      record: Bản ghi đã giải mã
+ * \param[out]      consumed: Số byte của bản ghi
+ * \return          \ref CDC_OK nếu thành công, \ref CDC_INCOMPLETE nếu cần thêm dữ liệu,
+ *                  \ref CDC_ERROR nếu dữ liệu sai định dạng
+ */
+cdc_status_t
+cdc_decode(const uint8_t* buffer, size_t length, cdc_record_t* record, size_t* consumed) {
+    cdc_reader_t reader;
+    size_t record_length;
+
+    if (buffer == NULL || record == NULL || consumed == NULL) {
+        return CDC_INVALID_INPUT;
+    }
+    if (length < 4) {
+        return CDC_INCOMPLETE;
+    }
+
+    reader.data = buffer;
+    reader.length = 4;
+    reader.pos = 0;
+    reader.error = 0;
+    record_length = (size_t)cdc_get_uint(&reader, 4);
+    if (record_length < 17 || record_length > CDC_MAX_ENCODED) {
+        return CDC_ERROR;
+    }
+    if (length < record_length) {
+        return CDC_INCOMPLETE;
+    }
+
+    reader.length = record_length;
+    record->seq = cdc_get_uint(&reader, 8);
+    record->op = (cdc_op_t)cdc_get_uint(&reader, 1);
+    record->id = (uint32_t)cdc_get_uint(&reader, 4);
+    switch (record->op) {
+        case CDC_OP_BOOK_UPSERT:
+            record->data.book.copy_count = (uint8_t)cdc_get_uint(&reader, 1);
+            record->data.book.available_mask = cdc_get_uint(&reader, 8);
+            cdc_get_string(&reader, record->data.book.title, sizeof(record->data.book.title));
+            cdc_get_string(&reader, record->data.book.author, sizeof(record->data.book.author));
+            break;
+        case CDC_OP_BOOK_AVAILABILITY:
+            record->data.book.copy_count = (uint8_t)cdc_get_uint(&reader, 1);
+            record->data.book.available_mask = cdc_get_uint(&reader, 8);
+            break;
+        case CDC_OP_USER_UPSERT:
+            record->data.user.tier = (user_tier_t)cdc_get_uint(&reader, 1);
+            cdc_get_string(&reader, record->data.user.name, sizeof(record->data.user.name));
+            break;
+        case CDC_OP_LOAN:
+        case CDC_OP_RETURN:
+            record->data.loan.book_id = (uint32_t)cdc_get_uint(&reader, 4);
+            record->data.loan.copy = (uint8_t)cdc_get_uint(&reader, 1);
+            break;
+        case CDC_OP_SNAPSHOT:
+        case CDC_OP_BOOK_DELETE:
+        case CDC_OP_USER_DELETE:
+            break;
+        default:
+            return CDC_ERROR;
+    }
+
+    if (reader.error || reader.pos != record_length) {
+        return CDC_ERROR;
+    }
+    *consumed = record_length;
+    return CDC_OK;
+}
+
+/**
+ * \brief           Mã hóa và ghi một bản ghi ra luồng
+ * \param[in]       record: Bản ghi
+ * \param[in]       format: Định dạng
+ * \param[in,out]   out: Luồng ghi
+ * \return          \ref CDC_OK nếu thành công, \ref cdc_status_t nếu lỗi
+ */
+static cdc_status_t
+cdc_write_record(const cdc_record_t* record, cdc_format_t format, FILE* out) {
+    uint8_t buffer[CDC_MAX_ENCODED];
+    size_t length;
+
+    length = cdc_encode(record, format, buffer, sizeof(buffer));
+    if (length == 0) {
+        return CDC_ERROR;
+    }
+    return (fwrite(buffer, 1, length, out) == length) ? CDC_OK : CDC_IO_ERROR;
+}
+
+/**
+ * \brief           Xuất mọi thay đổi sau con trỏ
+ * \param[in]       log: Con trỏ tới nhật ký
+ * \param[in,out]   cursor: Số thứ tự cuối cùng đã nhận, được cập nhật sau mỗi bản ghi đã ghi
+ * \param[in]       format: Định dạng
+ * \param[in,out]   out: Luồng ghi
+ * \return          \ref CDC_OK nếu thành công, \ref CDC_LAGGING nếu cần snapshot,
+ *                  \ref cdc_status_t nếu lỗi khác
+ */
+cdc_status_t
+cdc_export(const cdc_log_t* log, uint64_t* cursor, cdc_format_t format, FILE* out) {
+    cdc_status_t status;
+    uint64_t seq;
+
+    if (log == NULL || cursor == NULL || out == NULL || *cursor > log->head) {
+        return CDC_INVALID_INPUT;
+    }
+    if (*cursor + 1 < cdc_oldest(log)) {
+        return CDC_LAGGING;
+    }
+
+    for (seq = *cursor + 1; seq <= log->head; seq++) {
+        status = cdc_write_record(&log->ring[(seq - 1) & (CDC_RING_CAPACITY - 1)], format, out);
+        if (status != CDC_OK) {
+            return status;
+        }
+        *cursor = seq;
+    }
+    return CDC_OK;
+}
+
+/**
+ * \brief           Xuất toàn bộ trạng thái hiện tại
+ *
+ * Gồm một bản ghi \ref CDC_OP_SNAPSHOT, mọi sách, mọi người dùng và mọi lượt
+ * mượn đang mở; tất cả mang số thứ tự \ref cdc_head, là con trỏ người nhận
+ * dùng để tiếp tục bằng \ref cdc_export.
+ *
+ * \param[in]       log: Con trỏ tới nhật ký
+ * \param[in]       books: Danh sách sách
+ * \param[in]       users: Danh sách người dùng
+ * \param[in]       format: Định dạng
+ * \param[in,out]   out: Luồng ghi
+ * \param[out]      cursor: Con trỏ mới
+ * \return          \ref CDC_OK nếu thành công, \ref cdc_status_t nếu lỗi
+ */
+cdc_status_t
+cdc_export_snapshot(const cdc_log_t* log, const book_list_t* books, const user_list_t* users,
+                    cdc_format_t format, FILE* out, uint64_t* cursor) {
+    cdc_record_t record;
+    cdc_status_t status;
+    const uint32_t* items;
+    size_t i;
+    size_t j;
+
+    if (log == NULL || books == NULL || users == NULL || out == NULL || cursor == NULL) {
+        return CDC_INVALID_INPUT;
+    }
+
+    record.seq = log->head;
+    record.op = CDC_OP_SNAPSHOT;
+    record.id = 0;
+    status = cdc_write_record(&record, format, out);
+
+    record.op = CDC_OP_BOOK_UPSERT;
+    for (i = 0; i < books->count && status == CDC_OK; i++) {
+        record.id = books->books[i].book_id;
+        cdc_fill_book(&record, &books->books[i]);
+        status = cdc_write_record(&record, format, out);
+    }
+
+    for (i = 0; i < users->count && status == CDC_OK; i++) {
+        record.op = CDC_OP_USER_UPSERT;
+        record.id = users->users[i].user_id;
+        cdc_fill_user(&record, &users->users[i]);
+        status = cdc_write_record(&record, format, out);
+
+        record.op = CDC_OP_LOAN;
+        items = user_borrowed_items(users, &users->users[i]);
+        for (j = 0; j < users->users[i].borrowed_count && status == CDC_OK; j++) {
+            record.data.loan.book_id = BOOK_ITEM_BOOK_ID(items[j]);
+            record.data.loan.copy = BOOK_ITEM_COPY(items[j]);
+            status = cdc_write_record(&record, format, out);
+        }
+    }
+
+    if (status == CDC_OK) {
+        *cursor = log->head;
+    }
+    return status;
+}
+
+/**
+ * \brief           Đồng bộ người nhận: gửi các thay đổi, hoặc snapshot nếu con trỏ đã quá cũ
+ * \param[in]       log: Con trỏ tới nhật ký
+ * \param[in]       books: Danh sách sách
+ * \param[in]       users: Danh sách người dùng
+ * \param[in]       format: Định dạng
+ * \param[in,out]   out: Luồng ghi
+ * \param[in,out]   cursor: Con trỏ của người nhận
+ * \return          \ref CDC_OK nếu đã gửi thay đổi, \ref CDC_SNAPSHOT nếu đã gửi snapshot,
+ *                  \ref cdc_status_t nếu lỗi
+ */
+cdc_status_t
+cdc_sync(const cdc_log_t* log, const book_list_t* books, const user_list_t* users,
+         cdc_format_t format, FILE* out, uint64_t* cursor) {
+    cdc_status_t status;
+
+    status = cdc_export(log, cursor, format, out);
+    if (status != CDC_LAGGING) {
+        return status;
+    }
+
+    status = cdc_export_snapshot(log, books, users, format, out, cursor);
+    return (status == CDC_OK) ? CDC_SNAPSHOT : status;
+}
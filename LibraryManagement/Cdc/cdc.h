@@ -0,0 +1,150 @@
+/**
+ * \file            cdc.h
+ * \brief           Nhật ký thay đổi (change data capture) của thư viện
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef CDC_HDR_H
+#define CDC_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "../Book/book.h"
+#include "../User/user.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#ifndef CDC_RING_CAPACITY
+#define CDC_RING_CAPACITY           4096        /*!< Số bản ghi giữ lại (lũy thừa của 2) */
+#endif /* CDC_RING_CAPACITY */
+#define CDC_MAX_ENCODED             4096        /*!< Độ dài tối đa của một bản ghi đã mã hóa */
+
+/**
+ * \brief           Trạng thái trả về của các hàm CDC
+ */
+typedef enum {
+    CDC_OK = 0,                                 /*!< Thành công */
+    CDC_ERROR,                                  /*!< Lỗi chung */
+    CDC_INVALID_INPUT,                          /*!< Dữ liệu đầu vào không hợp lệ */
+    CDC_LAGGING,                                /*!< Con trỏ đã rơi khỏi vòng đệm, cần snapshot */
+    CDC_SNAPSHOT,                               /*!< Đã gửi snapshot thay cho các thay đổi */
+    CDC_IO_ERROR,                               /*!< Lỗi ghi dữ liệu ra */
+    CDC_INCOMPLETE,                             /*!< Bộ đệm chưa chứa trọn một bản ghi */
+} cdc_status_t;
+
+/**
+ * \brief           Loại bản ghi thay đổi
+ */
+typedef enum {
+    CDC_OP_SNAPSHOT = 0,                        /*!< Bắt đầu snapshot: người nhận xóa trạng thái cũ */
+    CDC_OP_BOOK_UPSERT,                         /*!< Thêm hoặc sửa sách (toàn bộ bản ghi) */
+    CDC_OP_BOOK_DELETE,                         /*!< Xóa sách */
+    CDC_OP_BOOK_AVAILABILITY,                   /*!< Đổi bitmap bản sao có sẵn */
+    CDC_OP_USER_UPSERT,                         /*!< Thêm hoặc sửa người dùng */
+    CDC_OP_USER_DELETE,                         /*!< Xóa người dùng */
+    CDC_OP_LOAN,                                /*!< Người dùng mượn một bản sao */
+    CDC_OP_RETURN,                              /*!< Người dùng trả một bản sao */
+} cdc_op_t;
+
+/**
+ * \brief           Định dạng dữ liệu xuất
+ */
+typedef enum {
+    CDC_FORMAT_BINARY = 0,                      /*!< Nhị phân little-endian, mỗi bản ghi có tiền tố độ dài */
+    CDC_FORMAT_JSON,                            /*!< JSON Lines, mỗi bản ghi một dòng */
+} cdc_format_t;
+
+/**
+ * \brief           Một bản ghi thay đổi
+ *
+ * \ref id là ID sách với các thao tác sách và ID người dùng với các thao tác
+ * người dùng, mượn và trả.
+ */
+typedef struct {
+    uint64_t seq;                               /*!< Số thứ tự, tăng dần từ 1 */
+    cdc_op_t op;                                /*!< Loại thay đổi */
+    uint32_t id;                                /*!< ID bản ghi bị thay đổi */
+    union {
+        struct {
+            char title[MAX_TITLE_LENGTH];       /*!< Tiêu đề (chỉ với \ref CDC_OP_BOOK_UPSERT) */
+            char author[MAX_AUTHOR_LENGTH];     /*!< Tác giả (chỉ với \ref CDC_OP_BOOK_UPSERT) */
+            uint8_t copy_count;                 /*!< Số bản sao */
+            uint64_t available_mask;            /*!< Bitmap bản sao có sẵn */
+        } book;
+        struct {
+            char name[MAX_NAME_LENGTH];         /*!< Tên người dùng */
+            user_tier_t tier;                   /*!< Hạng người dùng */
+        } user;
+        struct {
+            uint32_t book_id;                   /*!< ID sách */
+            uint8_t copy;                       /*!< Chỉ số bản sao */
+        } loan;
+    } data;
+} cdc_record_t;
+
+/**
+ * \brief           Nhật ký thay đổi dạng vòng đệm
+ *
+ * Bản ghi có số thứ tự s nằm ở ô (s - 1) mod \ref CDC_RING_CAPACITY; khi đầy,
+ * bản ghi mới ghi đè bản ghi cũ nhất. Người nhận giữ con trỏ là số thứ tự cuối
+ * cùng đã nhận (0 = chưa nhận gì).
+ */
+typedef struct {
+    cdc_record_t ring[CDC_RING_CAPACITY];       /*!< Vòng đệm bản ghi */
+    uint64_t head;                              /*!< Số thứ tự của bản ghi mới nhất (0 = rỗng) */
+} cdc_log_t;
+
+/* Khai báo các hàm ghi nhận thay đổi */
+void            cdc_init(cdc_log_t* log);
+void            cdc_attach(cdc_log_t* log, book_list_t* books, user_list_t* users);
+void            cdc_record_loan(cdc_log_t* log, cdc_op_t op, uint32_t user_id, uint32_t item_key);
+uint64_t        cdc_head(const cdc_log_t* log);
+uint64_t        cdc_oldest(const cdc_log_t* log);
+
+/* Khai báo các hàm đọc và xuất thay đổi */
+cdc_status_t    cdc_read(const cdc_log_t* log, uint64_t cursor, cdc_record_t* records,
+                         size_t capacity, size_t* count);
+size_t          cdc_encode(const cdc_record_t* record, cdc_format_t format, uint8_t* buffer, size_t capacity);
+cdc_status_t    cdc_decode(const uint8_t* buffer, size_t length, cdc_record_t* record, size_t* consumed);
+cdc_status_t    cdc_export(const cdc_log_t* log, uint64_t* cursor, cdc_format_t format, FILE* out);
+cdc_status_t    cdc_export_snapshot(const cdc_log_t* log, const book_list_t* books, const user_list_t* users,
+                                    cdc_format_t format, FILE* out, uint64_t* cursor);
+cdc_status_t    cdc_sync(const cdc_log_t* log, const book_list_t* books, const user_list_t* users,
+                         cdc_format_t format, FILE* out, uint64_t* cursor);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CDC_HDR_H */
@@ -0,0 +1,953 @@
+/**
+ * \file            column.c
+ * \brief           Triển khai snapshot dạng cột có nén của danh sách sách
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include "column.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Hằng số nội bộ */
+#define COLUMN_DICT_SLOTS           ((size_t)MAX_BOOKS * 2 + 1) /*!< Số ô của bảng băm từ điển khi ghi */
+#define COLUMN_CODE_PADDING         8           /*!< Byte 0 thêm sau mã tác giả để kernel luôn đọc đủ 8 byte */
+
+/**
+ * \brief           Bộ ghi tuần tự ra file, đếm số byte đã ghi
+ */
+typedef struct {
+    FILE* out;                                  /*!< File đích */
+    size_t length;                              /*!< Số byte đã ghi */
+    uint8_t error;                              /*!< 1 nếu đã có lỗi ghi */
+} column_writer_t;
+
+/*
+ * Vùng làm việc của bộ ghi. Đặt ở vùng tĩnh để không phụ thuộc kích thước stack
+ * khi MAX_BOOKS lớn, vì vậy \ref column_save và \ref column_restore không được
+ * gọi đồng thời.
+ */
+static uint32_t column_dict_slots[COLUMN_DICT_SLOTS];                       /*!< Chỉ số sách đại diện + 1, 0 = ô trống */
+static uint32_t column_dict_books[MAX_BOOKS];                               /*!< Mã tác giả -> chỉ số sách đại diện */
+static uint32_t column_codes[MAX_BOOKS];                                    /*!< Mã tác giả của từng sách */
+static uint32_t column_ids[MAX_BOOKS];                                      /*!< ID giải mã khi khôi phục */
+static uint32_t column_restarts[MAX_BOOKS / COLUMN_TITLE_RESTART + 1];      /*!< Offset các điểm khởi động tiêu đề */
+
+/**
+ * \brief           Ghi chuỗi byte
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       bytes: Dữ liệu
+ * \param[in]       length: Số byte
+ */
+static void
+column_put_bytes(column_writer_t* writer, const void* bytes, size_t length) {
+    if (writer->error || length == 0) {
+        return;
+    }
+    if (fwrite(bytes, 1, length, writer->out) != length) {
+        writer->error = 1;
+        return;
+    }
+    writer->length += length;
+}
+
+/**
+ * \brief           Ghi số nguyên không dấu little-endian
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       value: Giá trị
+ * \param[in]       size: Số byte (1, 2, 4 hoặc 8)
+ */
+static void
+column_put_uint(column_writer_t* writer, uint64_t value, size_t size) {
+    uint8_t bytes[8];
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+    column_put_bytes(writer, bytes, size);
+}
+
+/**
+ * \brief           Ghi số nguyên không dấu dạng varint (7 bit mỗi byte)
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       value: Giá trị
+ */
+static void
+column_put_varint(column_writer_t* writer, uint64_t value) {
+    uint8_t bytes[10];
+    size_t length;
+
+    length = 0;
+    while (value >= 0x80) {
+        bytes[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t)value;
+    column_put_bytes(writer, bytes, length);
+}
+
+/**
+ * \brief           Đọc số nguyên 32 bit little-endian
+ * \param[in]       bytes: Dữ liệu (ít nhất 4 byte)
+ * \return          Giá trị
+ */
+static uint32_t
+column_get_u32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+/**
+ * \brief           Đọc số nguyên 64 bit little-endian
+ * \param[in]       bytes: Dữ liệu (ít nhất 8 byte)
+ * \return          Giá trị
+ */
+static uint64_t
+column_get_u64(const uint8_t* bytes) {
+    return (uint64_t)column_get_u32(bytes) | ((uint64_t)column_get_u32(bytes + 4) << 32);
+}
+
+/**
+ * \brief           Đọc một varint
+ * \param[in,out]   pos: Vị trí đọc, được dời qua varint
+ * \param[in]       end: Cuối vùng dữ liệu
+ * \param[out]      value: Giá trị
+ * \return          1 nếu thành công, 0 nếu varint bị cắt cụt hoặc quá dài
+ */
+static uint8_t
+column_get_varint(const uint8_t** pos, const uint8_t* end, uint64_t* value) {
+    const uint8_t* p;
+    uint64_t result;
+    uint32_t shift;
+
+    p = *pos;
+    result = 0;
+    for (shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            return 0;
+        }
+        result |= (uint64_t)(*p & 0x7F) << shift;
+        if ((*p++ & 0x80) == 0) {
+            *pos = p;
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Băm chuỗi tác giả (FNV-1a)
+ * \param[in]       text: Chuỗi
+ * \return          Giá trị băm
+ */
+static uint32_t
+column_hash(const char* text) {
+    uint32_t hash;
+
+    hash = 2166136261U;
+    while (*text != '\0') {
+        hash = (hash ^ (uint8_t)*text++) * 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * \brief           Gán mã tác giả cho mọi sách theo thứ tự xuất hiện lần đầu
+ * \param[in]       list: Danh sách sách
+ * \return          Số tác giả khác nhau
+ */
+static uint32_t
+column_build_dict(const book_list_t* list) {
+    uint32_t author_count;
+    size_t i;
+    size_t slot;
+    uint32_t first;
+
+    memset(column_dict_slots, 0, sizeof(column_dict_slots));
+    author_count = 0;
+    for (i = 0; i < list->count; i++) {
+        slot = column_hash(list->books[i].author) % COLUMN_DICT_SLOTS;
+        while ((first = column_dict_slots[slot]) != 0
+               && strcmp(list->books[first - 1].author, list->books[i].author) != 0) {
+            slot = slot + 1 < COLUMN_DICT_SLOTS ? slot + 1 : 0;
+        }
+        if (first == 0) {
+            column_dict_slots[slot] = (uint32_t)i + 1;
+            column_dict_books[author_count] = (uint32_t)i;
+            column_codes[i] = author_count++;
+        } else {
+            column_codes[i] = column_codes[first - 1];
+        }
+    }
+    return author_count;
+}
+
+/**
+ * \brief           Ghi cột ID: hiệu với ID trước đó, mã hóa zigzag rồi varint
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       list: Danh sách sách
+ */
+static void
+column_write_ids(column_writer_t* writer, const book_list_t* list) {
+    int64_t delta;
+    uint32_t prev;
+    size_t i;
+
+    prev = 0;
+    for (i = 0; i < list->count; i++) {
+        delta = (int64_t)list->books[i].book_id - (int64_t)prev;
+        column_put_varint(writer, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        prev = list->books[i].book_id;
+    }
+}
+
+/**
+ * \brief           Ghi từ điển tác giả
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       list: Danh sách sách
+ * \param[in]       author_count: Số tác giả khác nhau
+ */
+static void
+column_write_dict(column_writer_t* writer, const book_list_t* list, uint32_t author_count) {
+    uint32_t offset;
+    uint32_t code;
+    const char* author;
+
+    column_put_uint(writer, author_count, 4);
+    offset = 0;
+    for (code = 0; code < author_count; code++) {
+        column_put_uint(writer, offset, 4);
+        offset += (uint32_t)strlen(list->books[column_dict_books[code]].author);
+    }
+    column_put_uint(writer, offset, 4);
+    for (code = 0; code < author_count; code++) {
+        author = list->books[column_dict_books[code]].author;
+        column_put_bytes(writer, author, strlen(author));
+    }
+}
+
+/**
+ * \brief           Ghi cột mã tác giả, mỗi mã chiếm \p width bit
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       count: Số sách
+ * \param[in]       width: Số bit của một mã
+ */
+static void
+column_write_codes(column_writer_t* writer, size_t count, uint8_t width) {
+    static const uint8_t padding[COLUMN_CODE_PADDING] = {0};
+    uint64_t pending;
+    uint32_t bits;
+    uint8_t byte;
+    size_t i;
+
+    column_put_uint(writer, width, 1);
+    pending = 0;
+    bits = 0;
+    for (i = 0; i < count; i++) {
+        pending |= (uint64_t)column_codes[i] << bits;
+        bits += width;
+        while (bits >= 8) {
+            byte = (uint8_t)pending;
+            column_put_bytes(writer, &byte, 1);
+            pending >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) {
+        byte = (uint8_t)pending;
+        column_put_bytes(writer, &byte, 1);
+    }
+    column_put_bytes(writer, padding, sizeof(padding));
+}
+
+/**
+ * \brief           Ghi cột tiêu đề theo mã hóa tiền tố (front coding)
+ *
+ * Mỗi mục gồm độ dài phần đầu trùng với tiêu đề trước, độ dài phần còn lại và
+ * phần còn lại. Mục đầu của mỗi khối \ref COLUMN_TITLE_RESTART tiêu đề được
+ * lưu đầy đủ và có offset trong bảng ở cuối cột để giải mã ngẫu nhiên.
+ *
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       list: Danh sách sách
+ */
+static void
+column_write_titles(column_writer_t* writer, const book_list_t* list) {
+    const char* prev;
+    const char* title;
+    size_t start;
+    size_t shared;
+    size_t length;
+    size_t restart_count;
+    size_t i;
+
+    start = writer->length;
+    restart_count = 0;
+    prev = "";
+    for (i = 0; i < list->count; i++) {
+        title = list->books[i].title;
+        shared = 0;
+        if (i % COLUMN_TITLE_RESTART == 0) {
+            column_restarts[restart_count++] = (uint32_t)(writer->length - start);
+        } else {
+            while (prev[shared] != '\0' && prev[shared] == title[shared]) {
+                shared++;
+            }
+        }
+        length = strlen(title + shared);
+        column_put_varint(writer, shared);
+        column_put_varint(writer, length);
+        column_put_bytes(writer, title + shared, length);
+        prev = title;
+    }
+    for (i = 0; i < restart_count; i++) {
+        column_put_uint(writer, column_restarts[i], 4);
+    }
+}
+
+/**
+ * \brief           Ghi cột cờ mượn dạng bitmap 64 bit
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       list: Danh sách sách
+ */
+static void
+column_write_borrowed(column_writer_t* writer, const book_list_t* list) {
+    uint64_t word;
+    size_t i;
+
+    word = 0;
+    for (i = 0; i < list->count; i++) {
+        word |= (uint64_t)(list->books[i].is_borrowed != 0) << (i & 63);
+        if ((i & 63) == 63) {
+            column_put_uint(writer, word, 8);
+            word = 0;
+        }
+    }
+    if ((list->count & 63) != 0) {
+        column_put_uint(writer, word, 8);
+    }
+}
+
+/**
+ * \brief           Ghi cột bản sao: số bản sao (1 byte mỗi sách) rồi bitmap có sẵn dạng varint
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       list: Danh sách sách
+ */
+static void
+column_write_copies(column_writer_t* writer, const book_list_t* list) {
+    size_t i;
+
+    for (i = 0; i < list->count; i++) {
+        column_put_uint(writer, list->books[i].copy_count, 1);
+    }
+    for (i = 0; i < list->count; i++) {
+        column_put_varint(writer, list->books[i].available_mask);
+    }
+}
+
+/**
+ * \brief           Ghi danh sách sách ra file dưới dạng snapshot cột
+ *
+ * File gồm phần đầu cố định \ref COLUMN_HEADER_SIZE byte (magic, phiên bản,
+ * số sách, next_id và bảng offset/độ dài của từng cột) rồi lần lượt các cột
+ * theo thứ tự \ref column_id_t. Hàm dùng vùng làm việc tĩnh nên không được
+ * gọi đồng thời.
+ *
+ * \param[in]       list: Danh sách sách
+ * \param[in]       path: Đường dẫn file
+ * \param[out]      written: Số byte đã ghi (có thể NULL)
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_save(const book_list_t* list, const char* path, size_t* written) {
+    column_writer_t writer;
+    uint32_t offsets[COLUMN_COUNT];
+    uint32_t lengths[COLUMN_COUNT];
+    uint8_t header[COLUMN_HEADER_SIZE];
+    uint32_t author_count;
+    uint8_t width;
+    size_t start;
+    int column;
+
+    if (list == NULL || path == NULL) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    author_count = column_build_dict(list);
+    width = 1;
+    while (width < 32 && author_count > 1 && ((author_count - 1) >> width) != 0) {
+        width++;
+    }
+
+    writer.out = fopen(path, "wb");
+    if (writer.out == NULL) {
+        return COLUMN_IO_ERROR;
+    }
+    writer.length = 0;
+    writer.error = 0;
+
+    /* Phần đầu được ghi lại sau khi biết vị trí các cột */
+    memset(header, 0, sizeof(header));
+    column_put_bytes(&writer, header, sizeof(header));
+
+    for (column = 0; column < COLUMN_COUNT; column++) {
+        start = writer.length;
+        switch ((column_id_t)column) {
+            case COLUMN_ID:
+                column_write_ids(&writer, list);
+                break;
+            case COLUMN_AUTHOR_DICT:
+                column_write_dict(&writer, list, author_count);
+                break;
+            case COLUMN_AUTHOR_CODE:
+                column_write_codes(&writer, list->count, width);
+                break;
+            case COLUMN_TITLE:
+                column_write_titles(&writer, list);
+                break;
+            case COLUMN_BORROWED:
+                column_write_borrowed(&writer, list);
+                break;
+            default:
+                column_write_copies(&writer, list);
+                break;
+        }
+        offsets[column] = (uint32_t)start;
+        lengths[column] = (uint32_t)(writer.length - start);
+    }
+
+    if (!writer.error && fseek(writer.out, 0, SEEK_SET) != 0) {
+        writer.error = 1;
+    }
+    start = writer.length;
+    column_put_uint(&writer, COLUMN_MAGIC, 4);
+    column_put_uint(&writer, COLUMN_VERSION, 2);
+    column_put_uint(&writer, COLUMN_COUNT, 2);
+    column_put_uint(&writer, list->count, 4);
+    column_put_uint(&writer, list->next_id, 4);
+    for (column = 0; column < COLUMN_COUNT; column++) {
+        column_put_uint(&writer, offsets[column], 4);
+        column_put_uint(&writer, lengths[column], 4);
+    }
+
+    if (fclose(writer.out) != 0 || writer.error) {
+        return COLUMN_IO_ERROR;
+    }
+    if (written != NULL) {
+        *written = start;
+    }
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Mở snapshot nằm sẵn trong bộ nhớ và kiểm tra cấu trúc các cột
+ *
+ * Snapshot không được sao chép: \p data phải còn tồn tại khi dùng \p snap.
+ *
+ * \param[out]      snap: Snapshot đã mở
+ * \param[in]       data: Dữ liệu snapshot
+ * \param[in]       length: Số byte của \p data
+ * \return          \ref COLUMN_OK nếu hợp lệ, \ref COLUMN_CORRUPT nếu sai định dạng
+ */
+column_status_t
+column_open(column_snapshot_t* snap, const uint8_t* data, size_t length) {
+    const uint8_t* dict;
+    uint32_t offset;
+    uint32_t column_length;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t code;
+    size_t words;
+    int column;
+
+    if (snap == NULL || data == NULL) {
+        return COLUMN_INVALID_INPUT;
+    }
+    if (length < COLUMN_HEADER_SIZE || column_get_u32(data) != COLUMN_MAGIC
+        || (data[4] | (data[5] << 8)) != COLUMN_VERSION || (data[6] | (data[7] << 8)) != COLUMN_COUNT) {
+        return COLUMN_CORRUPT;
+    }
+
+    memset(snap, 0, sizeof(*snap));
+    snap->data = data;
+    snap->length = length;
+    snap->book_count = column_get_u32(data + 8);
+    snap->next_id = column_get_u32(data + 12);
+    if (snap->book_count > MAX_BOOKS) {
+        return COLUMN_CORRUPT;
+    }
+    for (column = 0; column < COLUMN_COUNT; column++) {
+        offset = column_get_u32(data + 16 + 8 * column);
+        column_length = column_get_u32(data + 20 + 8 * column);
+        if (offset < COLUMN_HEADER_SIZE || offset > length || column_length > length - offset) {
+            return COLUMN_CORRUPT;
+        }
+        snap->columns[column] = data + offset;
+        snap->column_length[column] = column_length;
+    }
+
+    /* Từ điển: offset tăng dần và nằm trong vùng chuỗi */
+    dict = snap->columns[COLUMN_AUTHOR_DICT];
+    if (snap->column_length[COLUMN_AUTHOR_DICT] < 8) {
+        return COLUMN_CORRUPT;
+    }
+    snap->author_count = column_get_u32(dict);
+    if (snap->author_count > snap->book_count
+        || (snap->author_count == 0 && snap->book_count != 0)
+        || (snap->column_length[COLUMN_AUTHOR_DICT] - 8) / 4 < snap->author_count) {
+        return COLUMN_CORRUPT;
+    }
+    prev = 0;
+    for (code = 0; code <= snap->author_count; code++) {
+        next = column_get_u32(dict + 4 + 4 * code);
+        if (next < prev || (code > 0 && next - prev >= MAX_AUTHOR_LENGTH)) {
+            return COLUMN_CORRUPT;
+        }
+        prev = next;
+    }
+    if (prev > snap->column_length[COLUMN_AUTHOR_DICT] - 8 - 4 * snap->author_count) {
+        return COLUMN_CORRUPT;
+    }
+
+    /* Mã tác giả: đủ số bit cho mọi sách và phần đệm */
+    if (snap->column_length[COLUMN_AUTHOR_CODE] < 1 + COLUMN_CODE_PADDING) {
+        return COLUMN_CORRUPT;
+    }
+    snap->code_width = snap->columns[COLUMN_AUTHOR_CODE][0];
+    if (snap->code_width == 0 || snap->code_width > 32
+        || snap->column_length[COLUMN_AUTHOR_CODE] - 1 - COLUMN_CODE_PADDING
+           < ((uint64_t)snap->book_count * snap->code_width + 7) / 8) {
+        return COLUMN_CORRUPT;
+    }
+
+    /* Tiêu đề, cờ mượn và bản sao */
+    words = ((size_t)snap->book_count + 63) / 64;
+    if (snap->column_length[COLUMN_TITLE] / 4 < (snap->book_count + COLUMN_TITLE_RESTART - 1) / COLUMN_TITLE_RESTART
+        || snap->column_length[COLUMN_BORROWED] / 8 < words
+        || snap->column_length[COLUMN_COPIES] < snap->book_count) {
+        return COLUMN_CORRUPT;
+    }
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Đọc file snapshot vào bộ đệm của người gọi rồi mở
+ * \param[out]      snap: Snapshot đã mở
+ * \param[in]       path: Đường dẫn file
+ * \param[out]      buffer: Bộ đệm nhận dữ liệu (phải tồn tại khi dùng \p snap)
+ * \param[in]       capacity: Dung lượng \p buffer
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_load_file(column_snapshot_t* snap, const char* path, uint8_t* buffer, size_t capacity) {
+    FILE* in;
+    size_t length;
+    int extra;
+
+    if (snap == NULL || path == NULL || buffer == NULL) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    in = fopen(path, "rb");
+    if (in == NULL) {
+        return COLUMN_IO_ERROR;
+    }
+    length = fread(buffer, 1, capacity, in);
+    extra = fgetc(in);
+    if (ferror(in)) {
+        fclose(in);
+        return COLUMN_IO_ERROR;
+    }
+    fclose(in);
+    if (extra != EOF) {
+        return COLUMN_TOO_LARGE;
+    }
+    return column_open(snap, buffer, length);
+}
+
+/**
+ * \brief           Giải mã tiêu đề kế tiếp trong cột tiêu đề
+ * \param[in,out]   pos: Vị trí đọc, được dời qua mục vừa giải mã
+ * \param[in]       end: Cuối vùng mục (đầu bảng điểm khởi động)
+ * \param[in,out]   title: Tiêu đề trước đó, được thay bằng tiêu đề mới (kết thúc bằng '\0')
+ * \param[in,out]   length: Độ dài tiêu đề trước đó, được thay bằng độ dài mới
+ * \return          1 nếu thành công, 0 nếu dữ liệu sai định dạng
+ */
+static uint8_t
+column_next_title(const uint8_t** pos, const uint8_t* end, char* title, size_t* length) {
+    uint64_t shared;
+    uint64_t suffix;
+
+    if (!column_get_varint(pos, end, &shared) || !column_get_varint(pos, end, &suffix)
+        || shared > *length || suffix >= MAX_TITLE_LENGTH - shared || suffix > (uint64_t)(end - *pos)) {
+        return 0;
+    }
+    memcpy(title + shared, *pos, (size_t)suffix);
+    *pos += suffix;
+    *length = (size_t)(shared + suffix);
+    title[*length] = '\0';
+    return 1;
+}
+
+/**
+ * \brief           Lấy tiêu đề của sách thứ \p index
+ *
+ * Chỉ giải mã từ điểm khởi động gần nhất, tối đa \ref COLUMN_TITLE_RESTART mục.
+ *
+ * \param[in]       snap: Snapshot
+ * \param[in]       index: Vị trí sách trong snapshot
+ * \param[out]      title: Bộ đệm nhận tiêu đề
+ * \param[in]       capacity: Dung lượng \p title
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_title(const column_snapshot_t* snap, uint32_t index, char* title, size_t capacity) {
+    char current[MAX_TITLE_LENGTH];
+    const uint8_t* pos;
+    const uint8_t* end;
+    size_t restart_count;
+    size_t length;
+    uint32_t restart;
+    uint32_t i;
+
+    if (snap == NULL || title == NULL || index >= snap->book_count) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    restart_count = (snap->book_count + COLUMN_TITLE_RESTART - 1) / COLUMN_TITLE_RESTART;
+    end = snap->columns[COLUMN_TITLE] + snap->column_length[COLUMN_TITLE] - 4 * restart_count;
+    restart = column_get_u32(end + 4 * (index / COLUMN_TITLE_RESTART));
+    if (restart > (size_t)(end - snap->columns[COLUMN_TITLE])) {
+        return COLUMN_CORRUPT;
+    }
+
+    pos = snap->columns[COLUMN_TITLE] + restart;
+    length = 0;
+    current[0] = '\0';
+    for (i = index - index % COLUMN_TITLE_RESTART; i <= index; i++) {
+        if (!column_next_title(&pos, end, current, &length)) {
+            return COLUMN_CORRUPT;
+        }
+    }
+    if (length >= capacity) {
+        return COLUMN_INVALID_INPUT;
+    }
+    memcpy(title, current, length + 1);
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Lấy tên tác giả theo mã trong từ điển
+ * \param[in]       snap: Snapshot
+ * \param[in]       code: Mã tác giả
+ * \param[out]      author: Bộ đệm nhận tên tác giả
+ * \param[in]       capacity: Dung lượng \p author
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_author(const column_snapshot_t* snap, uint32_t code, char* author, size_t capacity) {
+    const uint8_t* dict;
+    uint32_t start;
+    uint32_t end;
+
+    if (snap == NULL || author == NULL || code >= snap->author_count) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    dict = snap->columns[COLUMN_AUTHOR_DICT];
+    start = column_get_u32(dict + 4 + 4 * code);
+    end = column_get_u32(dict + 8 + 4 * code);
+    if (end - start >= capacity) {
+        return COLUMN_INVALID_INPUT;
+    }
+    memcpy(author, dict + 8 + 4 * (size_t)snap->author_count + start, end - start);
+    author[end - start] = '\0';
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Giải mã toàn bộ cột ID
+ * \param[in]       snap: Snapshot
+ * \param[out]      ids: Mảng nhận ID theo thứ tự trong snapshot
+ * \param[in]       capacity: Số phần tử của \p ids (ít nhất bằng số sách)
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_decode_ids(const column_snapshot_t* snap, uint32_t* ids, size_t capacity) {
+    const uint8_t* pos;
+    const uint8_t* end;
+    uint64_t zigzag;
+    int64_t value;
+    uint32_t i;
+
+    if (snap == NULL || ids == NULL || capacity < snap->book_count) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    pos = snap->columns[COLUMN_ID];
+    end = pos + snap->column_length[COLUMN_ID];
+    value = 0;
+    for (i = 0; i < snap->book_count; i++) {
+        if (!column_get_varint(&pos, end, &zigzag)) {
+            return COLUMN_CORRUPT;
+        }
+        value += (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+        if (value < 0 || value > UINT32_MAX) {
+            return COLUMN_CORRUPT;
+        }
+        ids[i] = (uint32_t)value;
+    }
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Kernel giải nén một loạt mã tác giả
+ *
+ * Mỗi mã được lấy bằng một lần đọc 8 byte, một phép dịch và một phép AND,
+ * không rẽ nhánh nên trình biên dịch có thể vector hóa vòng lặp.
+ *
+ * \param[in]       snap: Snapshot
+ * \param[in]       first: Vị trí sách đầu tiên
+ * \param[in]       count: Số mã cần giải nén
+ * \param[out]      codes: Mảng nhận mã
+ */
+static void
+column_unpack_codes(const column_snapshot_t* snap, size_t first, size_t count, uint32_t* codes) {
+    const uint8_t* packed;
+    uint64_t mask;
+    uint8_t width;
+    size_t bit;
+    size_t i;
+
+    packed = snap->columns[COLUMN_AUTHOR_CODE] + 1;
+    width = snap->code_width;
+    mask = ((uint64_t)1 << width) - 1;
+    for (i = 0; i < count; i++) {
+        bit = (first + i) * width;
+        codes[i] = (uint32_t)((column_get_u64(packed + (bit >> 3)) >> (bit & 7)) & mask);
+    }
+}
+
+/**
+ * \brief           Khôi phục danh sách sách từ snapshot
+ *
+ * Hàm dùng vùng làm việc tĩnh nên không được gọi đồng thời.
+ *
+ * \param[in]       snap: Snapshot
+ * \param[in,out]   list: Danh sách sách rỗng nhận dữ liệu
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_restore(const column_snapshot_t* snap, book_list_t* list) {
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    const uint8_t* title_pos;
+    const uint8_t* title_end;
+    const uint8_t* mask_pos;
+    const uint8_t* mask_end;
+    const uint8_t* copy_counts;
+    size_t title_length;
+    uint64_t mask;
+    uint32_t code;
+    uint32_t i;
+    column_status_t status;
+
+    if (snap == NULL || list == NULL || list->count != 0) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    status = column_decode_ids(snap, column_ids, MAX_BOOKS);
+    if (status != COLUMN_OK) {
+        return status;
+    }
+
+    title_pos = snap->columns[COLUMN_TITLE];
+    title_end = title_pos + snap->column_length[COLUMN_TITLE]
+                - 4 * ((snap->book_count + COLUMN_TITLE_RESTART - 1) / COLUMN_TITLE_RESTART);
+    copy_counts = snap->columns[COLUMN_COPIES];
+    mask_pos = copy_counts + snap->book_count;
+    mask_end = copy_counts + snap->column_length[COLUMN_COPIES];
+    title_length = 0;
+    title[0] = '\0';
+    for (i = 0; i < snap->book_count; i++) {
+        if (i % COLUMN_TITLE_RESTART == 0) {
+            title_length = 0;
+        }
+        if (!column_next_title(&title_pos, title_end, title, &title_length)
+            || !column_get_varint(&mask_pos, mask_end, &mask)) {
+            return COLUMN_CORRUPT;
+        }
+        column_unpack_codes(snap, i, 1, &code);
+        if (column_author(snap, code, author, sizeof(author)) != COLUMN_OK
+            || book_add_with_id(list, column_ids[i], title, author) != BOOK_OK
+            || book_restore_copies(list, column_ids[i], copy_counts[i], mask) != BOOK_OK) {
+            return COLUMN_CORRUPT;
+        }
+    }
+    if (snap->next_id > list->next_id) {
+        list->next_id = snap->next_id;
+    }
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Đếm số sách đã hết bản có sẵn bằng popcount trên cột cờ mượn
+ * \param[in]       snap: Snapshot
+ * \return          Số sách có cờ mượn
+ */
+size_t
+column_count_borrowed(const column_snapshot_t* snap) {
+    const uint8_t* bitmap;
+    size_t words;
+    size_t total;
+    size_t i;
+    uint64_t last;
+
+    if (snap == NULL || snap->book_count == 0) {
+        return 0;
+    }
+
+    bitmap = snap->columns[COLUMN_BORROWED];
+    words = ((size_t)snap->book_count + 63) / 64;
+    total = 0;
+    for (i = 0; i + 1 < words; i++) {
+        total += (size_t)__builtin_popcountll(column_get_u64(bitmap + 8 * i));
+    }
+
+    /* Bỏ các bit thừa sau sách cuối cùng */
+    last = column_get_u64(bitmap + 8 * (words - 1));
+    if ((snap->book_count & 63) != 0) {
+        last &= ((uint64_t)1 << (snap->book_count & 63)) - 1;
+    }
+    return total + (size_t)__builtin_popcountll(last);
+}
+
+/**
+ * \brief           Đếm tổng số bản sao và số bản sao có sẵn từ cột bản sao
+ * \param[in]       snap: Snapshot
+ * \param[out]      total: Tổng số bản sao
+ * \param[out]      available: Số bản sao có sẵn
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_count_copies(const column_snapshot_t* snap, uint64_t* total, uint64_t* available) {
+    const uint8_t* copy_counts;
+    const uint8_t* pos;
+    const uint8_t* end;
+    uint64_t sum;
+    uint64_t mask;
+    uint32_t i;
+
+    if (snap == NULL || total == NULL || available == NULL) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    /* Phần số bản sao có độ rộng cố định: cộng dồn liên tục, vector hóa được */
+    copy_counts = snap->columns[COLUMN_COPIES];
+    sum = 0;
+    for (i = 0; i < snap->book_count; i++) {
+        sum += copy_counts[i];
+    }
+    *total = sum;
+
+    sum = 0;
+    pos = copy_counts + snap->book_count;
+    end = copy_counts + snap->column_length[COLUMN_COPIES];
+    for (i = 0; i < snap->book_count; i++) {
+        if (!column_get_varint(&pos, end, &mask)) {
+            return COLUMN_CORRUPT;
+        }
+        sum += (uint64_t)__builtin_popcountll(mask);
+    }
+    *available = sum;
+    return COLUMN_OK;
+}
+
+/**
+ * \brief           Đếm số sách theo tác giả, chỉ đọc cột mã tác giả (và cột cờ mượn)
+ *
+ * Mã được giải nén theo từng lượt \ref COLUMN_BATCH giá trị; trọng số của mỗi
+ * sách lấy từ bitmap cờ mượn nên cộng dồn không cần rẽ nhánh.
+ *
+ * \param[in]       snap: Snapshot
+ * \param[in]       available_only: 1 = chỉ đếm sách còn bản có sẵn
+ * \param[out]      counts: counts[code] nhận số sách của tác giả có mã code
+ * \param[in]       capacity: Số phần tử của \p counts (ít nhất bằng số tác giả)
+ * \return          \ref COLUMN_OK nếu thành công, \ref column_status_t nếu lỗi
+ */
+column_status_t
+column_count_by_author(const column_snapshot_t* snap, uint8_t available_only,
+                       uint32_t* counts, size_t capacity) {
+    uint32_t codes[COLUMN_BATCH];
+    uint32_t weights[COLUMN_BATCH];
+    const uint8_t* bitmap;
+    uint32_t invalid;
+    uint64_t word;
+    size_t first;
+    size_t count;
+    size_t i;
+    size_t j;
+
+    if (snap == NULL || counts == NULL || capacity < snap->author_count) {
+        return COLUMN_INVALID_INPUT;
+    }
+
+    memset(counts, 0, sizeof(*counts) * snap->author_count);
+    bitmap = snap->columns[COLUMN_BORROWED];
+    for (first = 0; first < snap->book_count; first += COLUMN_BATCH) {
+        count = snap->book_count - first < COLUMN_BATCH ? snap->book_count - first : COLUMN_BATCH;
+        column_unpack_codes(snap, first, count, codes);
+
+        invalid = 0;
+        for (i = 0; i < count; i++) {
+            invalid |= codes[i] >= snap->author_count;
+        }
+        if (invalid) {
+            return COLUMN_CORRUPT;
+        }
+
+        /* first là bội của 64 nên mỗi từ bitmap ứng với đúng 64 trọng số */
+        for (i = 0; i < count; i++) {
+            weights[i] = 1;
+        }
+        if (available_only) {
+            for (i = 0; i < count; i += 64) {
+                word = column_get_u64(bitmap + (first + i) / 8);
+                for (j = 0; j < 64 && i + j < count; j++) {
+                    weights[i + j] = 1 - (uint32_t)((word >> j) & 1);
+                }
+            }
+        }
+
+        for (i = 0; i < count; i++) {
+            counts[codes[i]] += weights[i];
+        }
+    }
+    return COLUMN_OK;
+}
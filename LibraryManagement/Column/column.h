@@ -0,0 +1,124 @@
+/**
+ * \file            column.h
+ * \brief           Snapshot dạng cột có nén của danh sách sách
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef COLUMN_HDR_H
+#define COLUMN_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../Book/book.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define COLUMN_MAGIC                0x4C4F434CU /*!< "LCOL" theo thứ tự little-endian */
+#define COLUMN_VERSION              1
+#define COLUMN_HEADER_SIZE          64          /*!< 16 byte thông tin chung + bảng 6 cột */
+#define COLUMN_TITLE_RESTART        16          /*!< Cứ 16 tiêu đề lại lưu một tiêu đề đầy đủ */
+#define COLUMN_BATCH                256         /*!< Số giá trị giải mã mỗi lượt trong các kernel phân tích */
+
+/**
+ * \brief           Dung lượng tối đa của một snapshot với \ref MAX_BOOKS sách
+ *
+ * Mỗi sách tốn tối đa 5 byte ID, 4 + 255 byte từ điển tác giả, 4 byte mã tác giả,
+ * 4 + 255 byte tiêu đề, 11 byte bản sao, một bit cờ mượn và phần bảng điểm
+ * khởi động của tiêu đề.
+ */
+#define COLUMN_MAX_SNAPSHOT         (COLUMN_HEADER_SIZE + 64 + (size_t)MAX_BOOKS * 548)
+
+/**
+ * \brief           Trạng thái trả về của các hàm snapshot cột
+ */
+typedef enum {
+    COLUMN_OK = 0,                              /*!< Thành công */
+    COLUMN_ERROR,                               /*!< Lỗi chung */
+    COLUMN_INVALID_INPUT,                       /*!< Dữ liệu đầu vào không hợp lệ */
+    COLUMN_IO_ERROR,                            /*!< Lỗi đọc/ghi file */
+    COLUMN_CORRUPT,                             /*!< Snapshot sai định dạng */
+    COLUMN_TOO_LARGE,                           /*!< Bộ đệm không đủ chứa snapshot */
+} column_status_t;
+
+/**
+ * \brief           Các cột trong snapshot (theo thứ tự trong bảng cột)
+ */
+typedef enum {
+    COLUMN_ID = 0,                              /*!< ID sách: hiệu hai ID liên tiếp, zigzag varint */
+    COLUMN_AUTHOR_DICT,                         /*!< Từ điển tác giả: u32 số mục, u32 offset[n + 1], chuỗi */
+    COLUMN_AUTHOR_CODE,                         /*!< Mã tác giả: u8 độ rộng bit, các mã đóng gói bit */
+    COLUMN_TITLE,                               /*!< Tiêu đề mã hóa tiền tố, bảng điểm khởi động ở cuối */
+    COLUMN_BORROWED,                            /*!< Cờ mượn: bitmap u64, bit i = 1 khi sách i hết bản có sẵn */
+    COLUMN_COPIES,                              /*!< u8 số bản sao của mọi sách, sau đó bitmap có sẵn dạng varint */
+    COLUMN_COUNT,
+} column_id_t;
+
+/**
+ * \brief           Snapshot đã mở, đọc trực tiếp trên bộ đệm của người gọi
+ *
+ * Không có con trỏ nào được lưu trong file: mỗi cột nằm ở một offset trong bảng
+ * cột. Các hàm phân tích chỉ giải mã những cột cần thiết.
+ */
+typedef struct {
+    const uint8_t* data;                        /*!< Toàn bộ snapshot */
+    size_t length;                              /*!< Số byte của snapshot */
+    uint32_t book_count;                        /*!< Số sách */
+    uint32_t next_id;                           /*!< ID tiếp theo của danh sách gốc */
+    uint32_t author_count;                      /*!< Số tác giả khác nhau */
+    uint8_t code_width;                         /*!< Số bit của một mã tác giả */
+    const uint8_t* columns[COLUMN_COUNT];       /*!< Đầu mỗi cột */
+    uint32_t column_length[COLUMN_COUNT];       /*!< Số byte của mỗi cột */
+} column_snapshot_t;
+
+/* Khai báo các hàm ghi và mở snapshot */
+column_status_t column_save(const book_list_t* list, const char* path, size_t* written);
+column_status_t column_open(column_snapshot_t* snap, const uint8_t* data, size_t length);
+column_status_t column_load_file(column_snapshot_t* snap, const char* path, uint8_t* buffer, size_t capacity);
+column_status_t column_restore(const column_snapshot_t* snap, book_list_t* list);
+
+/* Khai báo các hàm giải mã từng cột */
+column_status_t column_decode_ids(const column_snapshot_t* snap, uint32_t* ids, size_t capacity);
+column_status_t column_author(const column_snapshot_t* snap, uint32_t code, char* author, size_t capacity);
+column_status_t column_title(const column_snapshot_t* snap, uint32_t index, char* title, size_t capacity);
+
+/* Khai báo các hàm phân tích theo cột */
+size_t          column_count_borrowed(const column_snapshot_t* snap);
+column_status_t column_count_copies(const column_snapshot_t* snap, uint64_t* total, uint64_t* available);
+column_status_t column_count_by_author(const column_snapshot_t* snap, uint8_t available_only,
+                                       uint32_t* counts, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* COLUMN_HDR_H */
@@ -0,0 +1,902 @@
+/**
+ * \file            dedup.c
+ * \brief           Dò trùng: chuẩn hóa tiếng Việt, shingle, MinHash song song, chia dải LSH, gom cụm
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "dedup.h"
+#include "../Ultils/utils.h"
+
+#define DEDUP_FIELD_TITLE           0x7469746C65000000ull /* Hạt giống băm shingle tiêu đề */
+#define DEDUP_FIELD_AUTHOR          0x617574686F720000ull /* Hạt giống băm shingle tác giả */
+#define DEDUP_RADIX_BITS            16          /* Số bit mỗi lượt sắp xếp cơ số */
+#define DEDUP_RADIX_SIZE            (1u << DEDUP_RADIX_BITS)
+#define DEDUP_INITIAL_RECORDS       1024
+#define DEDUP_INITIAL_TEXT          (64u * 1024u)
+#define DEDUP_INITIAL_EDGES         1024
+
+#if DEDUP_BANDS * DEDUP_ROWS != DEDUP_HASHES
+#error "DEDUP_BANDS * DEDUP_ROWS phải bằng DEDUP_HASHES"
+#endif
+#if DEDUP_ROWS != 4
+#error "Khóa dải LSH được đọc thành một số 32 bit, cần DEDUP_ROWS = 4"
+#endif
+
+typedef struct dedup_worker dedup_worker_t;
+typedef void (*dedup_job_fn)(dedup_worker_t* worker);
+
+/**
+ * \brief           Tham số và kết quả riêng của một luồng
+ */
+struct dedup_worker {
+    dedup_job_fn job;                           /*!< Công việc đang chạy */
+    dedup_t* dedup;                             /*!< Bộ dò trùng */
+    uint32_t index;                             /*!< Chỉ số luồng */
+    uint32_t workers;                           /*!< Tổng số luồng */
+    uint64_t shingles;                          /*!< Số shingle đã băm (pha chữ ký) */
+    uint64_t candidates;                        /*!< Số cặp ứng viên (pha LSH) */
+    uint64_t* edges;                            /*!< Cặp đạt ngưỡng, (a << 32) | b (pha LSH) */
+    size_t edge_count;                          /*!< Số cặp */
+    size_t edge_capacity;                       /*!< Dung lượng mảng \ref edges */
+    dedup_status_t status;                      /*!< Lỗi của luồng */
+};
+
+/**
+ * \brief           Thời gian hiện tại (giây, đơn điệu)
+ * \return          Số giây
+ */
+static double
+dedup_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Bỏ dấu một ký tự Unicode ngoài ASCII
+ *
+ * Bao gồm Latin-1, các chữ riêng của tiếng Việt (ă, đ, ĩ, ũ, ơ, ư) và khối
+ * Latin Extended Additional (ạ..ỹ) nên cả chữ dựng sẵn lẫn chữ tổ hợp đều về
+ * cùng một dạng ASCII.
+ *
+ * \param[in]       cp: Mã ký tự
+ * \return          Chữ ASCII thường, ' ' nếu là dấu câu, 0 nếu là dấu tổ hợp cần bỏ,
+ *                  -1 nếu không bỏ dấu được (giữ nguyên)
+ */
+static int
+dedup_fold(uint32_t cp) {
+    static const char latin1[] = "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+                                 "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+    if (cp >= 0x0300 && cp <= 0x036F) {
+        return 0;
+    }
+    if (cp >= 0x00C0 && cp <= 0x00FF) {
+        return latin1[cp - 0x00C0];
+    }
+    if (cp >= 0x0080 && cp < 0x00C0) {
+        return ' ';
+    }
+    if (cp >= 0x1EA0 && cp <= 0x1EF9) {
+        if (cp <= 0x1EB7) {
+            return 'a';
+        } else if (cp <= 0x1EC7) {
+            return 'e';
+        } else if (cp <= 0x1ECB) {
+            return 'i';
+        } else if (cp <= 0x1EE3) {
+            return 'o';
+        } else if (cp <= 0x1EF1) {
+            return 'u';
+        }
+        return 'y';
+    }
+    switch (cp) {
+        case 0x0102: case 0x0103:
+            return 'a';
+        case 0x0110: case 0x0111:
+            return 'd';
+        case 0x0128: case 0x0129:
+            return 'i';
+        case 0x0168: case 0x0169: case 0x01AF: case 0x01B0:
+            return 'u';
+        case 0x01A0: case 0x01A1:
+            return 'o';
+        case 0x2010: case 0x2013: case 0x2014: case 0x2018:
+        case 0x2019: case 0x201C: case 0x201D: case 0x2026:
+            return ' ';
+        default:
+            return -1;
+    }
+}
+
+/**
+ * \brief           Chuẩn hóa một trường để so khớp gần đúng
+ *
+ * Bỏ dấu tiếng Việt, chuyển chữ thường, thay dấu câu bằng khoảng trắng và gộp
+ * khoảng trắng liên tiếp: "Lập trình C - tái bản" thành "lap trinh c tai ban".
+ * Ký tự không bỏ dấu được giữ nguyên dạng UTF-8; byte UTF-8 hỏng coi như dấu câu.
+ *
+ * \param[in]       text: Chuỗi UTF-8
+ * \param[out]      out: Bộ đệm kết quả
+ * \param[in]       out_size: Kích thước bộ đệm (kể cả ký tự kết thúc)
+ * \return          Độ dài chuỗi kết quả (bị cắt nếu bộ đệm không đủ)
+ */
+size_t
+dedup_normalize(const char* text, char* out, size_t out_size) {
+    const unsigned char* p;
+    const unsigned char* start;
+    uint32_t cp;
+    size_t extra;
+    size_t len;
+    size_t i;
+    uint8_t pending_space;
+    int folded;
+
+    if (out == NULL || out_size == 0) {
+        return 0;
+    }
+    len = 0;
+    pending_space = 0;
+    p = (const unsigned char*)((text != NULL) ? text : "");
+    while (*p != '\0') {
+        start = p;
+        if (*p < 0x80) {
+            cp = *p++;
+            if (cp >= 'A' && cp <= 'Z') {
+                folded = (int)(cp - 'A' + 'a');
+            } else if ((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9')) {
+                folded = (int)cp;
+            } else {
+                folded = ' ';
+            }
+        } else {
+            if ((*p & 0xE0) == 0xC0) {
+                cp = *p & 0x1F;
+                extra = 1;
+            } else if ((*p & 0xF0) == 0xE0) {
+                cp = *p & 0x0F;
+                extra = 2;
+            } else if ((*p & 0xF8) == 0xF0) {
+                cp = *p & 0x07;
+                extra = 3;
+            } else {
+                cp = 0;
+                extra = 0;
+            }
+            p++;
+            for (i = 0; i < extra && (*p & 0xC0) == 0x80; i++, p++) {
+                cp = (cp << 6) | (*p & 0x3F);
+            }
+            folded = (extra == 0 || i < extra) ? ' ' : dedup_fold(cp);
+        }
+
+        if (folded == 0) {
+            continue;
+        }
+        if (folded == ' ') {
+            pending_space = (len > 0);
+            continue;
+        }
+        extra = (folded > 0) ? 1 : (size_t)(p - start);
+        if (len + pending_space + extra >= out_size) {
+            break;
+        }
+        if (pending_space) {
+            out[len++] = ' ';
+            pending_space = 0;
+        }
+        if (folded > 0) {
+            out[len++] = (char)folded;
+        } else {
+            memcpy(&out[len], start, extra);
+            len += extra;
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+/**
+ * \brief           Cập nhật chữ ký MinHash bằng các shingle của một trường
+ *
+ * Trường được đệm một khoảng trắng ở hai đầu để shingle đầu và cuối từ khác
+ * shingle giữa từ. Các hàm băm có dạng ((a * x + b) mod 2^64) >> 32 với x là
+ * 32 bit cao của giá trị băm shingle; vòng lặp trong được trình biên dịch vector hóa.
+ *
+ * \param[in]       field: Trường đã chuẩn hóa (đã đệm)
+ * \param[in]       len: Độ dài trường
+ * \param[in]       seed: Hạt giống phân biệt tiêu đề với tác giả
+ * \param[in]       a: Hệ số nhân của các hàm băm
+ * \param[in]       b: Hệ số cộng của các hàm băm
+ * \param[in,out]   mins: Giá trị nhỏ nhất hiện tại của từng hàm băm
+ * \return          Số shingle đã băm
+ */
+static uint64_t
+dedup_shingle_field(const char* field, size_t len, uint64_t seed, const uint64_t* a, const uint64_t* b,
+                    uint32_t* mins) {
+    uint64_t packed;
+    uint64_t x;
+    uint32_t value;
+    size_t width;
+    size_t count;
+    size_t pos;
+    size_t i;
+
+    width = (len < DEDUP_SHINGLE) ? len : DEDUP_SHINGLE;
+    count = len - width + 1;
+    for (pos = 0; pos < count; pos++) {
+        packed = 0;
+        for (i = 0; i < width; i++) {
+            packed |= (uint64_t)(unsigned char)field[pos + i] << (8 * i);
+        }
+        x = hash_u64(packed ^ seed) >> 32;
+        for (i = 0; i < DEDUP_HASHES; i++) {
+            value = (uint32_t)((a[i] * x + b[i]) >> 32);
+            mins[i] = (value < mins[i]) ? value : mins[i];
+        }
+    }
+    return count;
+}
+
+/**
+ * \brief           Tính chữ ký cho một lát bản ghi (pha chữ ký)
+ * \param[in,out]   worker: Luồng; lát là [index * n / workers, (index + 1) * n / workers)
+ */
+static void
+dedup_signature_job(dedup_worker_t* worker) {
+    char field[DEDUP_TEXT_LENGTH + 2];
+    uint64_t a[DEDUP_HASHES];
+    uint64_t b[DEDUP_HASHES];
+    uint32_t mins[DEDUP_HASHES];
+    const dedup_record_t* record;
+    uint8_t* signature;
+    dedup_t* dedup;
+    size_t begin;
+    size_t end;
+    size_t len;
+    size_t r;
+    size_t i;
+
+    dedup = worker->dedup;
+    for (i = 0; i < DEDUP_HASHES; i++) {
+        a[i] = hash_u64(2 * i + 1) | 1u;
+        b[i] = hash_u64(2 * i + 2);
+    }
+    begin = dedup->count * worker->index / worker->workers;
+    end = dedup->count * (worker->index + 1) / worker->workers;
+    for (r = begin; r < end; r++) {
+        record = &dedup->records[r];
+        for (i = 0; i < DEDUP_HASHES; i++) {
+            mins[i] = UINT32_MAX;
+        }
+
+        field[0] = ' ';
+        len = dedup_normalize(&dedup->text[record->title], &field[1], DEDUP_TEXT_LENGTH) + 1;
+        field[len++] = ' ';
+        worker->shingles += dedup_shingle_field(field, len, DEDUP_FIELD_TITLE, a, b, mins);
+        len = dedup_normalize(&dedup->text[record->author], &field[1], DEDUP_TEXT_LENGTH) + 1;
+        field[len++] = ' ';
+        worker->shingles += dedup_shingle_field(field, len, DEDUP_FIELD_AUTHOR, a, b, mins);
+
+        /* b-bit MinHash: chỉ giữ 8 bit thấp của mỗi giá trị nhỏ nhất */
+        signature = &dedup->signatures[r * DEDUP_HASHES];
+        for (i = 0; i < DEDUP_HASHES; i++) {
+            signature[i] = (uint8_t)mins[i];
+        }
+    }
+}
+
+/**
+ * \brief           Ước lượng độ tương đồng Jaccard của hai bản ghi từ chữ ký
+ *
+ * Với chữ ký 8 bit, hai giá trị khác nhau vẫn trùng với xác suất 1/256 nên tỷ lệ
+ * trùng được hiệu chỉnh: J = (m - 1/256) / (1 - 1/256).
+ *
+ * \param[in]       dedup: Bộ dò trùng đã chạy \ref dedup_run
+ * \param[in]       a: Chỉ số bản ghi thứ nhất (theo thứ tự thêm)
+ * \param[in]       b: Chỉ số bản ghi thứ hai
+ * \return          Độ tương đồng ước lượng trong [0, 1], 0 nếu tham số không hợp lệ
+ */
+double
+dedup_similarity(const dedup_t* dedup, size_t a, size_t b) {
+    const uint8_t* sa;
+    const uint8_t* sb;
+    uint32_t equal;
+    double ratio;
+    size_t i;
+
+    if (dedup == NULL || !dedup->ready || a >= dedup->count || b >= dedup->count) {
+        return 0.0;
+    }
+    sa = &dedup->signatures[a * DEDUP_HASHES];
+    sb = &dedup->signatures[b * DEDUP_HASHES];
+    equal = 0;
+    for (i = 0; i < DEDUP_HASHES; i++) {
+        equal += (sa[i] == sb[i]);
+    }
+    ratio = ((double)equal / DEDUP_HASHES - 1.0 / 256.0) / (1.0 - 1.0 / 256.0);
+    return (ratio < 0.0) ? 0.0 : ratio;
+}
+
+/**
+ * \brief           Ghi nhận một cặp đạt ngưỡng vào danh sách của luồng
+ * \param[in,out]   worker: Luồng
+ * \param[in]       a: Bản ghi thứ nhất
+ * \param[in]       b: Bản ghi thứ hai
+ * \return          \ref DEDUP_OK nếu thành công
+ */
+static dedup_status_t
+dedup_push_edge(dedup_worker_t* worker, uint32_t a, uint32_t b) {
+    uint64_t* grown;
+    size_t capacity;
+
+    if (worker->edge_count == worker->edge_capacity) {
+        capacity = (worker->edge_capacity == 0) ? DEDUP_INITIAL_EDGES : worker->edge_capacity * 2;
+        grown = realloc(worker->edges, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return DEDUP_NO_MEMORY;
+        }
+        worker->edges = grown;
+        worker->edge_capacity = capacity;
+    }
+    worker->edges[worker->edge_count++] = ((uint64_t)a << 32) | b;
+    return DEDUP_OK;
+}
+
+/**
+ * \brief           Đọc khóa 32 bit của một dải trong chữ ký
+ * \param[in]       dedup: Bộ dò trùng
+ * \param[in]       record: Chỉ số bản ghi
+ * \param[in]       band: Chỉ số dải
+ * \return          Khóa dải
+ */
+static uint32_t
+dedup_band_key(const dedup_t* dedup, size_t record, uint32_t band) {
+    uint32_t key;
+
+    memcpy(&key, &dedup->signatures[record * DEDUP_HASHES + band * DEDUP_ROWS], sizeof(key));
+    return key;
+}
+
+/**
+ * \brief           Chia dải LSH và kiểm tra ứng viên cho các dải của một luồng
+ *
+ * Với mỗi dải, bản ghi được sắp xếp cơ số theo (khóa dải, khóa dải kế tiếp): bản
+ * ghi cùng xô nằm liền nhau, và trong xô các bản ghi còn trùng cả dải kế tiếp
+ * (thường là bản gần trùng thật) cũng nằm cạnh nhau. Mỗi bản ghi chỉ được so với
+ * bản ghi đầu xô và bản ghi liền trước nên xô lớn (do từ phổ biến như "giáo trình")
+ * vẫn tốn thời gian tuyến tính; cặp bị bỏ qua ở đây thường gặp lại ở dải khác.
+ *
+ * \param[in,out]   worker: Luồng; xử lý các dải index, index + workers, ...
+ */
+static void
+dedup_band_job(dedup_worker_t* worker) {
+    static const uint32_t zero_counts[DEDUP_RADIX_SIZE];
+    uint32_t* counts;
+    uint64_t* keys;
+    uint64_t* sorted_keys;
+    uint32_t* ids;
+    uint32_t* sorted_ids;
+    uint64_t* swap_keys;
+    uint32_t* swap_ids;
+    dedup_t* dedup;
+    uint32_t leader;
+    uint32_t previous;
+    uint32_t current;
+    uint32_t digit;
+    uint32_t slot;
+    uint32_t sum;
+    uint32_t pass;
+    uint32_t band;
+    size_t group;
+    size_t r;
+    size_t i;
+
+    dedup = worker->dedup;
+    keys = malloc(dedup->count * sizeof(*keys));
+    sorted_keys = malloc(dedup->count * sizeof(*sorted_keys));
+    ids = malloc(dedup->count * sizeof(*ids));
+    sorted_ids = malloc(dedup->count * sizeof(*sorted_ids));
+    counts = malloc(DEDUP_RADIX_SIZE * sizeof(*counts));
+    if (keys == NULL || sorted_keys == NULL || ids == NULL || sorted_ids == NULL || counts == NULL) {
+        worker->status = DEDUP_NO_MEMORY;
+        free(keys);
+        free(sorted_keys);
+        free(ids);
+        free(sorted_ids);
+        free(counts);
+        return;
+    }
+
+    for (band = worker->index; band < DEDUP_BANDS && worker->status == DEDUP_OK; band += worker->workers) {
+        for (r = 0; r < dedup->count; r++) {
+            keys[r] = ((uint64_t)dedup_band_key(dedup, r, band) << 32)
+                      | dedup_band_key(dedup, r, (band + 1) % DEDUP_BANDS);
+            ids[r] = (uint32_t)r;
+        }
+        /* Sắp xếp cơ số LSD ổn định: chỉ số tăng dần trong mỗi nhóm khóa bằng nhau */
+        for (pass = 0; pass < 64 / DEDUP_RADIX_BITS; pass++) {
+            memcpy(counts, zero_counts, sizeof(zero_counts));
+            for (r = 0; r < dedup->count; r++) {
+                counts[(keys[r] >> (pass * DEDUP_RADIX_BITS)) & (DEDUP_RADIX_SIZE - 1)]++;
+            }
+            sum = 0;
+            for (i = 0; i < DEDUP_RADIX_SIZE; i++) {
+                digit = counts[i];
+                counts[i] = sum;
+                sum += digit;
+            }
+            for (r = 0; r < dedup->count; r++) {
+                slot = counts[(keys[r] >> (pass * DEDUP_RADIX_BITS)) & (DEDUP_RADIX_SIZE - 1)]++;
+                sorted_keys[slot] = keys[r];
+                sorted_ids[slot] = ids[r];
+            }
+            swap_keys = keys;
+            keys = sorted_keys;
+            sorted_keys = swap_keys;
+            swap_ids = ids;
+            ids = sorted_ids;
+            sorted_ids = swap_ids;
+        }
+
+        for (group = 0; group < dedup->count; group = r) {
+            leader = ids[group];
+            previous = leader;
+            for (r = group + 1; r < dedup->count && (keys[r] >> 32) == (keys[group] >> 32); r++) {
+                current = ids[r];
+                worker->candidates++;
+                if (dedup_similarity(dedup, previous, current) >= dedup->config.threshold) {
+                    worker->status = dedup_push_edge(worker, previous, current);
+                } else if (previous != leader) {
+                    worker->candidates++;
+                    if (dedup_similarity(dedup, leader, current) >= dedup->config.threshold) {
+                        worker->status = dedup_push_edge(worker, leader, current);
+                    }
+                }
+                if (worker->status != DEDUP_OK) {
+                    break;
+                }
+                previous = current;
+            }
+            if (worker->status != DEDUP_OK) {
+                break;
+            }
+        }
+    }
+    free(keys);
+    free(sorted_keys);
+    free(ids);
+    free(sorted_ids);
+    free(counts);
+}
+
+/**
+ * \brief           Hàm chính của luồng phụ
+ * \param[in,out]   arg: Con trỏ tới \ref dedup_worker_t
+ * \return          NULL
+ */
+static void*
+dedup_thread_main(void* arg) {
+    dedup_worker_t* worker;
+
+    worker = arg;
+    worker->job(worker);
+    return NULL;
+}
+
+/**
+ * \brief           Chạy một công việc trên mọi luồng (luồng gọi làm phần của luồng 0)
+ *
+ * Nếu không tạo được luồng, phần của luồng đó được chạy ngay trên luồng gọi.
+ *
+ * \param[in,out]   workers: Tham số của các luồng
+ * \param[in]       count: Số luồng
+ * \param[in]       job: Công việc
+ */
+static void
+dedup_parallel(dedup_worker_t* workers, uint32_t count, dedup_job_fn job) {
+    pthread_t threads[DEDUP_MAX_THREADS];
+    uint8_t started[DEDUP_MAX_THREADS];
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        workers[i].job = job;
+    }
+    for (i = 1; i < count; i++) {
+        started[i] = (pthread_create(&threads[i], NULL, dedup_thread_main, &workers[i]) == 0);
+        if (!started[i]) {
+            job(&workers[i]);
+        }
+    }
+    job(&workers[0]);
+    for (i = 1; i < count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+/**
+ * \brief           Tìm gốc cụm của một bản ghi (nén đường đi kiểu chia đôi)
+ * \param[in,out]   parent: Rừng hợp nhất
+ * \param[in]       x: Bản ghi
+ * \return          Gốc cụm (bản ghi thêm sớm nhất trong cụm)
+ */
+static uint32_t
+dedup_find(uint32_t* parent, uint32_t x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/**
+ * \brief           Khởi tạo bộ dò trùng
+ * \param[out]      dedup: Bộ dò trùng
+ * \param[in]       config: Cấu hình (NULL = mặc định)
+ * \return          \ref DEDUP_OK nếu thành công
+ */
+dedup_status_t
+dedup_init(dedup_t* dedup, const dedup_config_t* config) {
+    long cpus;
+
+    if (dedup == NULL) {
+        return DEDUP_INVALID_INPUT;
+    }
+    memset(dedup, 0, sizeof(*dedup));
+    if (config != NULL) {
+        dedup->config = *config;
+    }
+    if (dedup->config.threshold < 0.0 || dedup->config.threshold > 1.0) {
+        return DEDUP_INVALID_INPUT;
+    }
+    if (dedup->config.threshold == 0.0) {
+        dedup->config.threshold = DEDUP_DEFAULT_THRESHOLD;
+    }
+    if (dedup->config.threads == 0) {
+        cpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif /* _SC_NPROCESSORS_ONLN */
+        dedup->config.threads = (cpus > 0) ? (uint32_t)cpus : 1;
+    }
+    if (dedup->config.threads > DEDUP_MAX_THREADS) {
+        dedup->config.threads = DEDUP_MAX_THREADS;
+    }
+    return DEDUP_OK;
+}
+
+/**
+ * \brief           Giải phóng bộ dò trùng
+ * \param[in,out]   dedup: Bộ dò trùng
+ */
+void
+dedup_destroy(dedup_t* dedup) {
+    if (dedup == NULL) {
+        return;
+    }
+    free(dedup->records);
+    free(dedup->text);
+    free(dedup->signatures);
+    free(dedup->parent);
+    memset(dedup, 0, sizeof(*dedup));
+}
+
+/**
+ * \brief           Thêm một bản ghi (sao chép tiêu đề và tác giả gốc)
+ * \param[in,out]   dedup: Bộ dò trùng
+ * \param[in]       book_id: ID sách
+ * \param[in]       title: Tiêu đề
+ * \param[in]       author: Tác giả (NULL = rỗng)
+ * \return          \ref DEDUP_OK nếu thành công
+ */
+dedup_status_t
+dedup_add(dedup_t* dedup, uint32_t book_id, const char* title, const char* author) {
+    dedup_record_t* records;
+    dedup_record_t* record;
+    size_t title_len;
+    size_t author_len;
+    size_t capacity;
+    char* text;
+
+    if (dedup == NULL || title == NULL || dedup->count >= UINT32_MAX) {
+        return DEDUP_INVALID_INPUT;
+    }
+    if (author == NULL) {
+        author = "";
+    }
+    title_len = strlen(title) + 1;
+    author_len = strlen(author) + 1;
+
+    if (dedup->count == dedup->capacity) {
+        capacity = (dedup->capacity == 0) ? DEDUP_INITIAL_RECORDS : dedup->capacity * 2;
+        records = realloc(dedup->records, capacity * sizeof(*records));
+        if (records == NULL) {
+            return DEDUP_NO_MEMORY;
+        }
+        dedup->records = records;
+        dedup->capacity = capacity;
+    }
+    if (dedup->text_used + title_len + author_len > dedup->text_capacity) {
+        capacity = (dedup->text_capacity == 0) ? DEDUP_INITIAL_TEXT : dedup->text_capacity;
+        while (capacity < dedup->text_used + title_len + author_len) {
+            capacity *= 2;
+        }
+        if (capacity > UINT32_MAX) {
+            return DEDUP_NO_MEMORY;
+        }
+        text = realloc(dedup->text, capacity);
+        if (text == NULL) {
+            return DEDUP_NO_MEMORY;
+        }
+        dedup->text = text;
+        dedup->text_capacity = capacity;
+    }
+
+    record = &dedup->records[dedup->count++];
+    record->book_id = book_id;
+    record->title = (uint32_t)dedup->text_used;
+    memcpy(&dedup->text[dedup->text_used], title, title_len);
+    dedup->text_used += title_len;
+    record->author = (uint32_t)dedup->text_used;
+    memcpy(&dedup->text[dedup->text_used], author, author_len);
+    dedup->text_used += author_len;
+    dedup->ready = 0;
+    return DEDUP_OK;
+}
+
+/**
+ * \brief           Tính chữ ký, chia dải LSH và gom các bản ghi gần trùng thành cụm
+ *
+ * Hai pha đầu chạy song song trên \ref dedup_config_t::threads luồng; thời gian
+ * gần tuyến tính theo số bản ghi vì không có phép so sánh từng cặp.
+ *
+ * \param[in,out]   dedup: Bộ dò trùng
+ * \return          \ref DEDUP_OK nếu thành công
+ */
+dedup_status_t
+dedup_run(dedup_t* dedup) {
+    dedup_worker_t workers[DEDUP_MAX_THREADS];
+    dedup_status_t status;
+    uint8_t* signatures;
+    uint8_t* seen;
+    uint32_t* parent;
+    uint32_t count;
+    uint32_t ra;
+    uint32_t rb;
+    uint32_t i;
+    size_t e;
+    size_t r;
+    double started;
+
+    if (dedup == NULL) {
+        return DEDUP_INVALID_INPUT;
+    }
+    memset(&dedup->stats, 0, sizeof(dedup->stats));
+    dedup->stats.records = dedup->count;
+    dedup->ready = 0;
+    if (dedup->count == 0) {
+        dedup->ready = 1;
+        return DEDUP_OK;
+    }
+
+    signatures = realloc(dedup->signatures, dedup->count * DEDUP_HASHES);
+    if (signatures == NULL) {
+        return DEDUP_NO_MEMORY;
+    }
+    dedup->signatures = signatures;
+    parent = realloc(dedup->parent, dedup->count * sizeof(*parent));
+    if (parent == NULL) {
+        return DEDUP_NO_MEMORY;
+    }
+    dedup->parent = parent;
+
+    count = dedup->config.threads;
+    if (count > dedup->count) {
+        count = (uint32_t)dedup->count;
+    }
+    memset(workers, 0, sizeof(workers));
+    for (i = 0; i < count; i++) {
+        workers[i].dedup = dedup;
+        workers[i].index = i;
+        workers[i].workers = count;
+        workers[i].status = DEDUP_OK;
+    }
+
+    started = dedup_now();
+    dedup_parallel(workers, count, dedup_signature_job);
+    for (i = 0; i < count; i++) {
+        dedup->stats.shingles += workers[i].shingles;
+    }
+    dedup->ready = 1;
+    dedup->stats.signature_seconds = dedup_now() - started;
+
+    /* Mỗi luồng xử lý trọn một số dải nên không cần khóa khi sinh cặp */
+    started = dedup_now();
+    if (count > DEDUP_BANDS) {
+        count = DEDUP_BANDS;
+    }
+    for (i = 0; i < count; i++) {
+        workers[i].workers = count;
+    }
+    dedup_parallel(workers, count, dedup_band_job);
+    dedup->stats.lsh_seconds = dedup_now() - started;
+
+    started = dedup_now();
+    status = DEDUP_OK;
+    for (r = 0; r < dedup->count; r++) {
+        parent[r] = (uint32_t)r;
+    }
+    for (i = 0; i < count; i++) {
+        if (workers[i].status != DEDUP_OK) {
+            status = workers[i].status;
+        }
+        dedup->stats.candidates += workers[i].candidates;
+        dedup->stats.verified += workers[i].edge_count;
+        for (e = 0; e < workers[i].edge_count; e++) {
+            /* Gốc là bản ghi thêm sớm nhất để đại diện cụm không phụ thuộc số luồng */
+            ra = dedup_find(parent, (uint32_t)(workers[i].edges[e] >> 32));
+            rb = dedup_find(parent, (uint32_t)workers[i].edges[e]);
+            if (ra < rb) {
+                parent[rb] = ra;
+            } else if (rb < ra) {
+                parent[ra] = rb;
+            }
+        }
+        free(workers[i].edges);
+    }
+    if (status != DEDUP_OK) {
+        dedup->ready = 0;
+        return status;
+    }
+    /* Thành viên luôn đứng sau gốc nên một lượt tiến là đủ để mọi phần tử trỏ thẳng tới gốc */
+    seen = calloc(dedup->count, 1);
+    if (seen == NULL) {
+        dedup->ready = 0;
+        return DEDUP_NO_MEMORY;
+    }
+    for (r = 0; r < dedup->count; r++) {
+        parent[r] = parent[parent[r]];
+        if (parent[r] != r) {
+            if (!seen[parent[r]]) {
+                seen[parent[r]] = 1;
+                dedup->stats.clusters++;
+                dedup->stats.clustered++;
+            }
+            dedup->stats.clustered++;
+        }
+    }
+    free(seen);
+    dedup->stats.cluster_seconds = dedup_now() - started;
+    return DEDUP_OK;
+}
+
+/**
+ * \brief           Duyệt các cụm gần trùng theo thứ tự bản ghi đại diện
+ *
+ * Trong mỗi cụm, thành viên theo thứ tự thêm; điểm của mỗi thành viên là độ
+ * tương đồng ước lượng với bản ghi đại diện (có thể thấp hơn ngưỡng khi thành
+ * viên chỉ giống đại diện qua một bản ghi trung gian).
+ *
+ * \param[in,out]   dedup: Bộ dò trùng đã chạy \ref dedup_run
+ * \param[in]       visit: Hàm nhận từng cụm
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p visit
+ * \return          \ref DEDUP_OK nếu thành công
+ */
+dedup_status_t
+dedup_clusters(dedup_t* dedup, dedup_cluster_fn visit, void* ctx) {
+    const dedup_record_t* record;
+    dedup_member_t* members;
+    uint32_t* offsets;
+    uint32_t* order;
+    uint32_t largest;
+    uint32_t root;
+    uint32_t pos;
+    size_t end;
+    size_t i;
+    size_t m;
+    size_t r;
+
+    if (dedup == NULL || visit == NULL) {
+        return DEDUP_INVALID_INPUT;
+    }
+    if (!dedup->ready) {
+        return DEDUP_NOT_READY;
+    }
+    if (dedup->stats.clusters == 0) {
+        return DEDUP_OK;
+    }
+
+    offsets = calloc(dedup->count, sizeof(*offsets));
+    order = malloc(dedup->stats.clustered * sizeof(*order));
+    if (offsets == NULL || order == NULL) {
+        free(offsets);
+        free(order);
+        return DEDUP_NO_MEMORY;
+    }
+
+    /* Sắp xếp đếm theo gốc: gốc đứng trước thành viên nên mỗi cụm bắt đầu bằng đại diện */
+    for (r = 0; r < dedup->count; r++) {
+        offsets[dedup->parent[r]]++;
+    }
+    pos = 0;
+    largest = 0;
+    for (r = 0; r < dedup->count; r++) {
+        if (dedup->parent[r] == r) {
+            if (offsets[r] < 2) {
+                offsets[r] = UINT32_MAX;
+            } else {
+                largest = (offsets[r] > largest) ? offsets[r] : largest;
+                pos += offsets[r];
+                offsets[r] = pos - offsets[r];
+            }
+        }
+    }
+    for (r = 0; r < dedup->count; r++) {
+        root = dedup->parent[r];
+        if (offsets[root] != UINT32_MAX) {
+            order[offsets[root]++] = (uint32_t)r;
+        }
+    }
+
+    members = malloc(largest * sizeof(*members));
+    if (members == NULL) {
+        free(offsets);
+        free(order);
+        return DEDUP_NO_MEMORY;
+    }
+    for (i = 0; i < dedup->stats.clustered; i = end) {
+        root = order[i];
+        end = offsets[root];
+        for (m = 0; m < end - i; m++) {
+            record = &dedup->records[order[i + m]];
+            members[m].book_id = record->book_id;
+            members[m].similarity = (m == 0) ? 1.0 : dedup_similarity(dedup, root, order[i + m]);
+            members[m].title = &dedup->text[record->title];
+            members[m].author = &dedup->text[record->author];
+        }
+        if (!visit(members, end - i, ctx)) {
+            break;
+        }
+    }
+    free(members);
+    free(offsets);
+    free(order);
+    return DEDUP_OK;
+}
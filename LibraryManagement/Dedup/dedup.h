@@ -0,0 +1,149 @@
+/**
+ * \file            dedup.h
+ * \brief           Phát hiện bản ghi thư mục gần trùng bằng MinHash và LSH
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef DEDUP_HDR_H
+#define DEDUP_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define DEDUP_HASHES                64          /*!< Số hàm băm MinHash (độ dài chữ ký) */
+#define DEDUP_BANDS                 16          /*!< Số dải LSH */
+#define DEDUP_ROWS                  4           /*!< Số hàng mỗi dải (DEDUP_BANDS * DEDUP_ROWS = DEDUP_HASHES) */
+#define DEDUP_SHINGLE               3           /*!< Độ dài shingle (ký tự, sau khi chuẩn hóa) */
+#define DEDUP_DEFAULT_THRESHOLD     0.6         /*!< Độ tương đồng Jaccard ước lượng tối thiểu để ghép cụm */
+#define DEDUP_MAX_THREADS           64          /*!< Số luồng tính chữ ký/dải tối đa */
+#define DEDUP_TEXT_LENGTH           512         /*!< Độ dài tối đa chuỗi đã chuẩn hóa của một trường */
+
+/**
+ * \brief           Trạng thái trả về của các hàm dò trùng
+ */
+typedef enum {
+    DEDUP_OK = 0,                               /*!< Thành công */
+    DEDUP_ERROR,                                /*!< Lỗi chung (không tạo được luồng) */
+    DEDUP_INVALID_INPUT,                        /*!< Dữ liệu đầu vào không hợp lệ */
+    DEDUP_NO_MEMORY,                            /*!< Không đủ bộ nhớ */
+    DEDUP_NOT_READY,                            /*!< Chưa gọi \ref dedup_run */
+} dedup_status_t;
+
+/**
+ * \brief           Cấu hình dò trùng
+ */
+typedef struct {
+    uint32_t threads;                           /*!< Số luồng, 0 = theo số CPU đang online */
+    double threshold;                           /*!< Ngưỡng tương đồng (0..1), 0 = \ref DEDUP_DEFAULT_THRESHOLD */
+} dedup_config_t;
+
+/**
+ * \brief           Một bản ghi đưa vào dò trùng
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách */
+    uint32_t title;                             /*!< Vị trí tiêu đề gốc trong vùng chuỗi */
+    uint32_t author;                            /*!< Vị trí tác giả gốc trong vùng chuỗi */
+} dedup_record_t;
+
+/**
+ * \brief           Một thành viên của cụm gần trùng
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách */
+    double similarity;                          /*!< Tương đồng ước lượng với bản ghi đại diện (đại diện = 1) */
+    const char* title;                          /*!< Tiêu đề gốc */
+    const char* author;                         /*!< Tác giả gốc */
+} dedup_member_t;
+
+/**
+ * \brief           Hàm nhận từng cụm gần trùng
+ * \param[in]       members: Các thành viên, phần tử đầu là bản ghi đại diện (thêm vào sớm nhất)
+ * \param[in]       count: Số thành viên (ít nhất 2)
+ * \param[in,out]   ctx: Ngữ cảnh do người gọi truyền vào
+ * \return          1 để tiếp tục, 0 để dừng
+ */
+typedef uint8_t (*dedup_cluster_fn)(const dedup_member_t* members, size_t count, void* ctx);
+
+/**
+ * \brief           Số liệu của một lần dò trùng
+ */
+typedef struct {
+    uint64_t records;                           /*!< Số bản ghi */
+    uint64_t shingles;                          /*!< Tổng số shingle đã băm */
+    uint64_t candidates;                        /*!< Số cặp ứng viên do LSH sinh ra */
+    uint64_t verified;                          /*!< Số cặp ứng viên đạt ngưỡng */
+    uint64_t clusters;                          /*!< Số cụm có từ 2 bản ghi */
+    uint64_t clustered;                         /*!< Số bản ghi nằm trong các cụm đó */
+    double signature_seconds;                   /*!< Thời gian chuẩn hóa và tính chữ ký */
+    double lsh_seconds;                         /*!< Thời gian chia dải và kiểm tra ứng viên */
+    double cluster_seconds;                     /*!< Thời gian gom cụm */
+} dedup_stats_t;
+
+/**
+ * \brief           Bộ dò bản ghi gần trùng
+ *
+ * Chữ ký của mỗi bản ghi giữ 8 bit thấp của từng giá trị MinHash (b-bit MinHash)
+ * nên chỉ tốn \ref DEDUP_HASHES byte; \ref DEDUP_ROWS byte liên tiếp của chữ ký
+ * cũng chính là khóa dải LSH 32 bit.
+ */
+typedef struct {
+    dedup_config_t config;                      /*!< Cấu hình (đã chuẩn hóa) */
+    dedup_record_t* records;                    /*!< Các bản ghi theo thứ tự thêm */
+    size_t count;                               /*!< Số bản ghi */
+    size_t capacity;                            /*!< Dung lượng mảng \ref records */
+    char* text;                                 /*!< Vùng chuỗi gốc (tiêu đề, tác giả kèm ký tự kết thúc) */
+    size_t text_used;                           /*!< Số byte đã dùng của \ref text */
+    size_t text_capacity;                       /*!< Dung lượng \ref text */
+    uint8_t* signatures;                        /*!< Chữ ký, \ref DEDUP_HASHES byte mỗi bản ghi */
+    uint32_t* parent;                           /*!< Rừng hợp nhất các bản ghi cùng cụm */
+    uint8_t ready;                              /*!< 1 sau khi \ref dedup_run thành công */
+    dedup_stats_t stats;                        /*!< Số liệu */
+} dedup_t;
+
+/* Khai báo các hàm dò trùng */
+dedup_status_t  dedup_init(dedup_t* dedup, const dedup_config_t* config);
+void            dedup_destroy(dedup_t* dedup);
+dedup_status_t  dedup_add(dedup_t* dedup, uint32_t book_id, const char* title, const char* author);
+dedup_status_t  dedup_run(dedup_t* dedup);
+dedup_status_t  dedup_clusters(dedup_t* dedup, dedup_cluster_fn visit, void* ctx);
+double          dedup_similarity(const dedup_t* dedup, size_t a, size_t b);
+size_t          dedup_normalize(const char* text, char* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* DEDUP_HDR_H */
@@ -0,0 +1,374 @@
+/**
+ * \file            deduptool.c
+ * \brief           Công cụ library_dedup: tìm bản ghi thư mục gần trùng trong kho trang
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "dedup.h"
+#include "../Page/page.h"
+
+#define DEDUPTOOL_VARIANT_PERCENT   10          /* Tỷ lệ bản ghi mẫu là biến thể của bản ghi trước đó */
+
+/**
+ * \brief           Ngữ cảnh đưa sách từ kho trang vào bộ dò trùng
+ */
+typedef struct {
+    dedup_t* dedup;                             /*!< Bộ dò trùng */
+    dedup_status_t status;                      /*!< Lỗi đầu tiên */
+} deduptool_feed_ctx_t;
+
+/**
+ * \brief           Ngữ cảnh ghi cụm ra file kết quả
+ */
+typedef struct {
+    FILE* out;                                  /*!< File kết quả */
+    uint64_t cluster;                           /*!< Số thứ tự cụm */
+    uint64_t limit;                             /*!< Số cụm tối đa cần ghi (0 = tất cả) */
+} deduptool_print_ctx_t;
+
+/* Âm tiết của dữ liệu mẫu = phụ âm đầu + vần (21 x 32 âm tiết) */
+static const char* const deduptool_onsets[] = {
+    "b", "c", "ch", "d", "đ", "g", "h", "kh", "l", "m", "n", "ng", "nh", "ph", "qu", "s", "t", "th",
+    "tr", "v", "x",
+};
+static const char* const deduptool_rhymes[] = {
+    "a", "à", "á", "ạ", "an", "ăn", "âm", "anh", "ao", "ay", "ên", "ết", "iếu", "inh", "ình", "oa",
+    "oà", "ong", "ông", "ơn", "ư", "ương", "ưởng", "ục", "ung", "uyên", "ất", "ọc", "ịch", "ế", "ô",
+    "ại",
+};
+static const char* const deduptool_family[] = {
+    "Nguyễn", "Trần", "Lê", "Phạm", "Hoàng", "Huỳnh", "Phan", "Vũ", "Võ", "Đặng", "Bùi", "Đỗ",
+    "Hồ", "Ngô", "Dương", "Lý",
+};
+static const char* const deduptool_middle[] = {
+    "Văn", "Thị", "Hữu", "Đức", "Minh", "Quang", "Thanh", "Ngọc",
+};
+static const char* const deduptool_given[] = {
+    "An", "Bình", "Cường", "Dũng", "Đông", "Giang", "Hà", "Hải", "Hạnh", "Hiếu", "Hùng", "Hương",
+    "Khánh", "Lan", "Linh", "Long", "Mai", "Nam", "Nga", "Phong", "Phương", "Quân", "Sơn", "Tâm",
+    "Thảo", "Trang", "Tuấn", "Việt", "Yến",
+};
+
+#define DEDUPTOOL_COUNT(array)      (sizeof(array) / sizeof((array)[0]))
+
+/**
+ * \brief           Thời gian hiện tại (giây, đơn điệu)
+ * \return          Số giây
+ */
+static double
+deduptool_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Số ngẫu nhiên xorshift64 (lặp lại được giữa các lần chạy)
+ * \param[in,out]   state: Trạng thái
+ * \return          Số ngẫu nhiên
+ */
+static uint64_t
+deduptool_next(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * \brief           Hàm duyệt đưa từng sách vào bộ dò trùng
+ * \param[in]       book: Sách
+ * \param[in,out]   ctx: Con trỏ tới \ref deduptool_feed_ctx_t
+ * \return          0 để dừng khi có lỗi
+ */
+static uint8_t
+deduptool_feed_visit(const book_t* book, void* ctx) {
+    deduptool_feed_ctx_t* feed;
+
+    feed = ctx;
+    feed->status = dedup_add(feed->dedup, book->book_id, book->title, book->author);
+    return feed->status == DEDUP_OK;
+}
+
+/**
+ * \brief           Sinh \p rows bản ghi mẫu, khoảng 10% là biến thể của một bản ghi trước đó
+ *
+ * Biến thể mô phỏng lỗi nhập tay: bỏ dấu, thêm "- tái bản", thêm dấu câu.
+ *
+ * \param[in,out]   dedup: Bộ dò trùng
+ * \param[in]       rows: Số bản ghi
+ * \param[out]      bases: Với bản ghi i là biến thể, bases[i] là chỉ số bản ghi gốc; ngược lại bằng i
+ * \return          \ref DEDUP_OK nếu thành công
+ */
+static dedup_status_t
+deduptool_generate(dedup_t* dedup, uint32_t rows, uint32_t* bases) {
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    char folded[MAX_TITLE_LENGTH];
+    dedup_status_t status;
+    const char* base_title;
+    const char* base_author;
+    uint64_t state;
+    uint64_t rnd;
+    uint32_t words;
+    uint32_t base;
+    uint32_t i;
+    uint32_t w;
+    size_t len;
+
+    state = 0x2545F4914F6CDD1Dull;
+    for (i = 0; i < rows; i++) {
+        rnd = deduptool_next(&state);
+        if (i > 0 && rnd % 100 < DEDUPTOOL_VARIANT_PERCENT) {
+            base = (uint32_t)((rnd >> 8) % i);
+            base = bases[base];
+            bases[i] = base;
+            base_title = &dedup->text[dedup->records[base].title];
+            base_author = &dedup->text[dedup->records[base].author];
+            switch ((rnd >> 40) % 3) {
+                case 0:
+                    dedup_normalize(base_title, folded, sizeof(folded));
+                    snprintf(title, sizeof(title), "%s", folded);
+                    dedup_normalize(base_author, folded, sizeof(folded));
+                    snprintf(author, sizeof(author), "%s", folded);
+                    break;
+                case 1:
+                    snprintf(title, sizeof(title), "%s - tái bản", base_title);
+                    snprintf(author, sizeof(author), "%s", base_author);
+                    break;
+                default:
+                    snprintf(title, sizeof(title), "%s (%u).", base_title, (unsigned)((rnd >> 48) % 3 + 2));
+                    snprintf(author, sizeof(author), "%s", base_author);
+                    break;
+            }
+        } else {
+            bases[i] = i;
+            words = (uint32_t)(rnd % 4) + 3;
+            len = 0;
+            for (w = 0; w < words && len < sizeof(title); w++) {
+                rnd = deduptool_next(&state);
+                len += (size_t)snprintf(&title[len], sizeof(title) - len, "%s%s%s", (w == 0) ? "" : " ",
+                                        deduptool_onsets[rnd % DEDUPTOOL_COUNT(deduptool_onsets)],
+                                        deduptool_rhymes[(rnd >> 8) % DEDUPTOOL_COUNT(deduptool_rhymes)]);
+            }
+            if (title[0] >= 'a' && title[0] <= 'z') {
+                title[0] = (char)(title[0] - 'a' + 'A');
+            }
+            rnd = deduptool_next(&state);
+            snprintf(author, sizeof(author), "%s %s %s %s",
+                     deduptool_family[rnd % DEDUPTOOL_COUNT(deduptool_family)],
+                     deduptool_middle[(rnd >> 8) % DEDUPTOOL_COUNT(deduptool_middle)],
+                     deduptool_given[(rnd >> 16) % DEDUPTOOL_COUNT(deduptool_given)],
+                     deduptool_given[(rnd >> 24) % DEDUPTOOL_COUNT(deduptool_given)]);
+        }
+        status = dedup_add(dedup, i + 1, title, author);
+        if (status != DEDUP_OK) {
+            return status;
+        }
+    }
+    return DEDUP_OK;
+}
+
+/**
+ * \brief           Ghi một cụm ra file kết quả (TSV: cụm, ID, điểm, tiêu đề, tác giả)
+ * \param[in]       members: Thành viên cụm
+ * \param[in]       count: Số thành viên
+ * \param[in,out]   ctx: Con trỏ tới \ref deduptool_print_ctx_t
+ * \return          0 khi đã ghi đủ số cụm yêu cầu
+ */
+static uint8_t
+deduptool_print_cluster(const dedup_member_t* members, size_t count, void* ctx) {
+    deduptool_print_ctx_t* print;
+    size_t i;
+
+    print = ctx;
+    print->cluster++;
+    for (i = 0; i < count; i++) {
+        fprintf(print->out, "%llu\t%u\t%.2f\t%s\t%s\n", (unsigned long long)print->cluster,
+                (unsigned)members[i].book_id, members[i].similarity, members[i].title, members[i].author);
+    }
+    return print->limit == 0 || print->cluster < print->limit;
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+deduptool_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-j luồng] [-t ngưỡng] [-n số_cụm] [-p số_trang_pool] kho.pg kết_quả.tsv\n"
+                    "       %s [-j luồng] [-t ngưỡng] [-n số_cụm] -g số_dòng kết_quả.tsv\n"
+                    "  -j  số luồng (mặc định theo số CPU)\n"
+                    "  -t  độ tương đồng tối thiểu 0..1 (mặc định %.2f)\n"
+                    "  -n  chỉ ghi số cụm đầu tiên (mặc định tất cả)\n"
+                    "  -g  sinh số dòng mẫu (có cài sẵn biến thể) thay vì đọc kho trang\n"
+                    "  kết_quả.tsv = - để ghi ra stdout\n", prog, prog, DEDUP_DEFAULT_THRESHOLD);
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_dedup
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Các tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    deduptool_print_ctx_t print;
+    deduptool_feed_ctx_t feed;
+    dedup_config_t config;
+    dedup_status_t status;
+    page_store_t store;
+    dedup_t dedup;
+    const char* output;
+    const char* source;
+    uint32_t* bases;
+    uint32_t generate;
+    uint64_t variants;
+    uint64_t found;
+    size_t pool_pages;
+    double started;
+    double loaded;
+    uint32_t i;
+    int opt;
+
+    memset(&config, 0, sizeof(config));
+    memset(&print, 0, sizeof(print));
+    generate = 0;
+    pool_pages = 0;
+    bases = NULL;
+    while ((opt = getopt(argc, argv, "j:t:n:p:g:h")) != -1) {
+        switch (opt) {
+            case 'j':
+                config.threads = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                config.threshold = strtod(optarg, NULL);
+                break;
+            case 'n':
+                print.limit = strtoull(optarg, NULL, 10);
+                break;
+            case 'p':
+                pool_pages = strtoul(optarg, NULL, 10);
+                break;
+            case 'g':
+                generate = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                deduptool_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind + (generate > 0 ? 0 : 1) >= argc) {
+        deduptool_usage(argv[0]);
+        return 1;
+    }
+    source = (generate > 0) ? NULL : argv[optind];
+    output = argv[argc - 1];
+
+    status = dedup_init(&dedup, &config);
+    if (status != DEDUP_OK) {
+        fprintf(stderr, "Cấu hình không hợp lệ (mã lỗi %d)\n", (int)status);
+        return 1;
+    }
+
+    started = deduptool_now();
+    if (source == NULL) {
+        bases = malloc((size_t)generate * sizeof(*bases));
+        status = (bases == NULL) ? DEDUP_NO_MEMORY : deduptool_generate(&dedup, generate, bases);
+    } else if (page_store_open(&store, source, pool_pages) != PAGE_OK) {
+        fprintf(stderr, "Không mở được kho %s\n", source);
+        dedup_destroy(&dedup);
+        return 1;
+    } else {
+        feed.dedup = &dedup;
+        feed.status = DEDUP_OK;
+        page_book_query(&store, BOOK_FILTER_ALL, NULL, deduptool_feed_visit, &feed);
+        status = feed.status;
+        page_store_close(&store);
+    }
+    loaded = deduptool_now();
+
+    if (status == DEDUP_OK) {
+        status = dedup_run(&dedup);
+    }
+    if (status == DEDUP_OK) {
+        print.out = (strcmp(output, "-") == 0) ? stdout : fopen(output, "w");
+        if (print.out == NULL) {
+            perror(output);
+            free(bases);
+            dedup_destroy(&dedup);
+            return 1;
+        }
+        fprintf(print.out, "cluster\tbook_id\tsimilarity\ttitle\tauthor\n");
+        status = dedup_clusters(&dedup, deduptool_print_cluster, &print);
+        if (print.out != stdout && fclose(print.out) != 0) {
+            status = DEDUP_ERROR;
+        }
+    }
+
+    if (status == DEDUP_OK) {
+        fprintf(stderr, "Bản ghi: %llu; shingle: %llu; luồng: %u; ngưỡng %.2f\n",
+                (unsigned long long)dedup.stats.records, (unsigned long long)dedup.stats.shingles,
+                (unsigned)dedup.config.threads, dedup.config.threshold);
+        fprintf(stderr, "Cặp ứng viên: %llu; đạt ngưỡng: %llu; cụm: %llu (%llu bản ghi)\n",
+                (unsigned long long)dedup.stats.candidates, (unsigned long long)dedup.stats.verified,
+                (unsigned long long)dedup.stats.clusters, (unsigned long long)dedup.stats.clustered);
+        fprintf(stderr, "Thời gian: nạp %.2f s, chữ ký %.2f s, LSH %.2f s, gom cụm %.2f s\n", loaded - started,
+                dedup.stats.signature_seconds, dedup.stats.lsh_seconds, dedup.stats.cluster_seconds);
+        if (bases != NULL) {
+            /* Dữ liệu mẫu biết trước biến thể nào thuộc bản ghi nào: đo tỷ lệ tìm lại được */
+            variants = 0;
+            found = 0;
+            for (i = 0; i < generate; i++) {
+                if (bases[i] != i) {
+                    variants++;
+                    found += (dedup.parent[i] == dedup.parent[bases[i]]);
+                }
+            }
+            fprintf(stderr, "Biến thể cài sẵn tìm lại được: %llu/%llu\n", (unsigned long long)found,
+                    (unsigned long long)variants);
+        }
+    }
+    free(bases);
+    dedup_destroy(&dedup);
+
+    if (status != DEDUP_OK) {
+        fprintf(stderr, "Lỗi dò trùng (mã lỗi %d)\n", (int)status);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,586 @@
+/**
+ * \file            federation.c
+ * \brief           Triển khai liên kết chi nhánh: định tuyến theo ID, phát tán song song, trộn top-K
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include "federation.h"
+#include <string.h>
+
+/**
+ * \brief           Ngữ cảnh tìm kiếm chung cho mọi chi nhánh
+ */
+typedef struct {
+    query_field_t field;                        /*!< Trường tìm kiếm */
+    const char* query;                          /*!< Chuỗi cần tìm */
+    size_t limit;                               /*!< Số kết quả giữ lại mỗi chi nhánh */
+} fed_search_ctx_t;
+
+/**
+ * \brief           Ngữ cảnh duyệt khi chi nhánh không có pool quét
+ */
+typedef struct {
+    fed_shard_t* shard;                         /*!< Chi nhánh đang tìm */
+    size_t limit;                               /*!< Số kết quả giữ lại */
+} fed_visit_ctx_t;
+
+/**
+ * \brief           Vòng lặp của luồng chi nhánh
+ * \param[in]       arg: Con trỏ tới \ref fed_thread_arg_t
+ * \return          NULL
+ */
+static void*
+fed_thread_main(void* arg) {
+    fed_thread_arg_t* thread_arg;
+    fed_t* fed;
+    uint64_t seen;
+
+    thread_arg = arg;
+    fed = thread_arg->fed;
+    seen = 0;
+
+    while (1) {
+        pthread_mutex_lock(&fed->lock);
+        while (!fed->shutdown && fed->job_seq == seen) {
+            pthread_cond_wait(&fed->start_cond, &fed->lock);
+        }
+        if (fed->shutdown) {
+            pthread_mutex_unlock(&fed->lock);
+            return NULL;
+        }
+        seen = fed->job_seq;
+        pthread_mutex_unlock(&fed->lock);
+
+        /* Chi nhánh thêm sau khi truy vấn bắt đầu không thuộc truy vấn này */
+        if (thread_arg->index < fed->shard_count) {
+            fed->fn(&fed->shards[thread_arg->index], fed->ctx);
+        }
+
+        pthread_mutex_lock(&fed->lock);
+        if (--fed->pending == 0) {
+            pthread_cond_signal(&fed->done_cond);
+        }
+        pthread_mutex_unlock(&fed->lock);
+    }
+}
+
+/**
+ * \brief           Khởi tạo liên kết rỗng
+ * \param[out]      fed: Con trỏ tới liên kết
+ * \return          \ref FED_OK nếu thành công, \ref fed_status_t nếu lỗi
+ */
+fed_status_t
+fed_init(fed_t* fed) {
+    if (fed == NULL) {
+        return FED_INVALID_INPUT;
+    }
+
+    memset(fed, 0, sizeof(*fed));
+    pthread_mutex_init(&fed->lock, NULL);
+    pthread_cond_init(&fed->start_cond, NULL);
+    pthread_cond_init(&fed->done_cond, NULL);
+
+    return FED_OK;
+}
+
+/**
+ * \brief           Dừng các luồng chi nhánh (thư viện của chi nhánh không bị hủy)
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ */
+void
+fed_destroy(fed_t* fed) {
+    uint32_t i;
+
+    if (fed == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&fed->lock);
+    fed->shutdown = 1;
+    pthread_cond_broadcast(&fed->start_cond);
+    pthread_mutex_unlock(&fed->lock);
+
+    for (i = 1; i <= fed->thread_count; i++) {
+        pthread_join(fed->threads[i], NULL);
+    }
+    fed->thread_count = 0;
+    fed->shard_count = 0;
+
+    pthread_mutex_destroy(&fed->lock);
+    pthread_cond_destroy(&fed->start_cond);
+    pthread_cond_destroy(&fed->done_cond);
+}
+
+/**
+ * \brief           Thêm một chi nhánh sở hữu dải ID [first_id, last_id]
+ *
+ * Sách mới của chi nhánh được cấp ID từ đầu dải, nên ID là duy nhất trên mọi
+ * chi nhánh mà không cần dịch ID. Sách đã có phải nằm trong dải.
+ *
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       name: Tên chi nhánh
+ * \param[in,out]   library: Thư viện của chi nhánh (không dùng chung với chi nhánh khác)
+ * \param[in]       first_id: ID sách nhỏ nhất
+ * \param[in]       last_id: ID sách lớn nhất
+ * \return          \ref FED_OK nếu thành công, \ref fed_status_t nếu lỗi
+ */
+fed_status_t
+fed_add_shard(fed_t* fed, const char* name, library_t* library, uint32_t first_id, uint32_t last_id) {
+    fed_shard_t* shard;
+    uint32_t position;
+    uint32_t i;
+    size_t j;
+
+    if (fed == NULL || name == NULL || library == NULL || library->books == NULL
+        || library->users == NULL || !is_valid_id(first_id) || !is_valid_id(last_id)
+        || first_id > last_id) {
+        return FED_INVALID_INPUT;
+    }
+    if (fed->shard_count >= FED_MAX_SHARDS) {
+        return FED_FULL;
+    }
+
+    /* Giữ các chi nhánh theo thứ tự dải ID, không cho hai dải giao nhau */
+    position = 0;
+    for (i = 0; i < fed->shard_count; i++) {
+        if (fed->shards[i].library == library
+            || (first_id <= fed->shards[i].last_id && fed->shards[i].first_id <= last_id)) {
+            return FED_OVERLAP;
+        }
+        if (fed->shards[i].first_id < first_id) {
+            position = i + 1;
+        }
+    }
+    for (j = 0; j < library->books->count; j++) {
+        if (library->books->books[j].book_id < first_id || library->books->books[j].book_id > last_id) {
+            return FED_INVALID_INPUT;
+        }
+    }
+
+    /* Mỗi chi nhánh từ thứ hai trở đi cần thêm một luồng nền */
+    if (fed->shard_count > 0) {
+        i = fed->thread_count + 1;
+        fed->args[i].fed = fed;
+        fed->args[i].index = i;
+        if (pthread_create(&fed->threads[i], NULL, fed_thread_main, &fed->args[i]) != 0) {
+            return FED_ERROR;
+        }
+        fed->thread_count = i;
+    }
+
+    memmove(&fed->shards[position + 1], &fed->shards[position],
+            (fed->shard_count - position) * sizeof(fed->shards[0]));
+    shard = &fed->shards[position];
+    memset(shard, 0, sizeof(*shard));
+    shard->library = library;
+    strncpy(shard->name, name, FED_NAME_LENGTH - 1);
+    shard->first_id = first_id;
+    shard->last_id = last_id;
+    if (library->books->next_id < first_id) {
+        library->books->next_id = first_id;
+    }
+    fed->shard_count++;
+
+    return FED_OK;
+}
+
+/**
+ * \brief           Tìm chi nhánh sở hữu một ID sách
+ * \param[in]       fed: Con trỏ tới liên kết
+ * \param[in]       book_id: ID sách
+ * \return          Chi nhánh sở hữu, NULL nếu ID nằm ngoài mọi dải
+ */
+fed_shard_t*
+fed_route(fed_t* fed, uint32_t book_id) {
+    uint32_t low;
+    uint32_t high;
+    uint32_t mid;
+
+    if (fed == NULL) {
+        return NULL;
+    }
+
+    /* Tìm nhị phân chi nhánh cuối cùng có first_id <= book_id */
+    low = 0;
+    high = fed->shard_count;
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (fed->shards[mid].first_id <= book_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == 0 || book_id > fed->shards[low - 1].last_id) {
+        return NULL;
+    }
+    return &fed->shards[low - 1];
+}
+
+/**
+ * \brief           Chạy \p fn trên mọi chi nhánh cùng lúc và chờ xong
+ *
+ * Thời gian một truy vấn xấp xỉ thời gian của chi nhánh chậm nhất thay vì tổng
+ * của mọi chi nhánh.
+ *
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       fn: Hàm chạy trên từng chi nhánh
+ * \param[in]       ctx: Ngữ cảnh truyền cho \p fn
+ */
+void
+fed_run(fed_t* fed, fed_shard_fn fn, const void* ctx) {
+    if (fed == NULL || fn == NULL || fed->shard_count == 0) {
+        return;
+    }
+
+    if (fed->thread_count == 0) {
+        fn(&fed->shards[0], ctx);
+        return;
+    }
+
+    pthread_mutex_lock(&fed->lock);
+    fed->fn = fn;
+    fed->ctx = ctx;
+    fed->pending = fed->thread_count;
+    fed->job_seq++;
+    pthread_cond_broadcast(&fed->start_cond);
+    pthread_mutex_unlock(&fed->lock);
+
+    fn(&fed->shards[0], ctx);
+
+    pthread_mutex_lock(&fed->lock);
+    while (fed->pending > 0) {
+        pthread_cond_wait(&fed->done_cond, &fed->lock);
+    }
+    pthread_mutex_unlock(&fed->lock);
+}
+
+/**
+ * \brief           Thêm sách mới vào một chi nhánh
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       shard: Chỉ số chi nhánh
+ * \param[in]       title: Tiêu đề sách
+ * \param[in]       author: Tác giả
+ * \param[out]      assigned_id: ID đã được gán (có thể NULL)
+ * \return          \ref FED_OK nếu thành công, \ref FED_FULL nếu dải ID hoặc danh sách của chi nhánh đã hết
+ */
+fed_status_t
+fed_add_book(fed_t* fed, uint32_t shard, const char* title, const char* author, uint32_t* assigned_id) {
+    book_list_t* books;
+    book_status_t status;
+
+    if (fed == NULL || shard >= fed->shard_count) {
+        return FED_INVALID_INPUT;
+    }
+
+    books = fed->shards[shard].library->books;
+    if (books->next_id > fed->shards[shard].last_id) {
+        return FED_FULL;
+    }
+
+    status = book_add(books, title, author, assigned_id);
+    if (status == BOOK_FULL) {
+        return FED_FULL;
+    }
+    return (status == BOOK_OK) ? FED_OK : FED_INVALID_INPUT;
+}
+
+/**
+ * \brief           Tìm sách theo ID trên chi nhánh sở hữu
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       book_id: ID sách
+ * \param[out]      shard: Chỉ số chi nhánh sở hữu (có thể NULL)
+ * \return          Con trỏ tới sách, NULL nếu không tìm thấy
+ */
+book_t*
+fed_find_book(fed_t* fed, uint32_t book_id, uint32_t* shard) {
+    fed_shard_t* owner;
+
+    owner = fed_route(fed, book_id);
+    if (owner == NULL) {
+        return NULL;
+    }
+
+    if (shard != NULL) {
+        *shard = (uint32_t)(owner - fed->shards);
+    }
+    return book_find_by_id(owner->library->books, book_id);
+}
+
+/**
+ * \brief           Mượn sách tại chi nhánh sở hữu sách
+ *
+ * Chi nhánh là thư viện độc lập nên người dùng phải có thẻ tại chi nhánh đó.
+ *
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       user_id: ID người dùng (tại chi nhánh sở hữu sách)
+ * \param[in]       book_id: ID sách
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+fed_borrow_book(fed_t* fed, uint32_t user_id, uint32_t book_id) {
+    fed_shard_t* owner;
+
+    owner = fed_route(fed, book_id);
+    if (owner == NULL) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+
+    return mgmt_borrow_book(owner->library, user_id, book_id);
+}
+
+/**
+ * \brief           Trả sách tại chi nhánh sở hữu sách
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       user_id: ID người dùng (tại chi nhánh sở hữu sách)
+ * \param[in]       book_id: ID sách
+ * \param[out]      handed_to: ID người đặt giữ nhận sách, 0 nếu không có (có thể NULL)
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+fed_return_book(fed_t* fed, uint32_t user_id, uint32_t book_id, uint32_t* handed_to) {
+    fed_shard_t* owner;
+
+    owner = fed_route(fed, book_id);
+    if (owner == NULL) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+
+    return mgmt_return_book_handoff(owner->library, user_id, book_id, handed_to);
+}
+
+/**
+ * \brief           Đẩy phần tử ở vị trí \p i xuống đúng chỗ trong max-heap theo ID
+ * \param[in,out]   heap: Mảng heap
+ * \param[in]       count: Số phần tử của heap
+ * \param[in]       i: Vị trí cần đẩy xuống
+ */
+static void
+fed_sift_down(const book_t** heap, size_t count, size_t i) {
+    const book_t* book;
+    size_t child;
+
+    book = heap[i];
+    while ((child = 2 * i + 1) < count) {
+        if (child + 1 < count && heap[child + 1]->book_id > heap[child]->book_id) {
+            child++;
+        }
+        if (heap[child]->book_id <= book->book_id) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = book;
+}
+
+/**
+ * \brief           Giữ \p limit sách có ID nhỏ nhất trong một max-heap theo ID
+ *
+ * Bộ nhớ và chi phí mỗi sách khớp bị chặn theo \p limit, không theo số sách khớp.
+ *
+ * \param[in]       book: Sách khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref fed_visit_ctx_t
+ * \return          1 để tiếp tục duyệt
+ */
+static uint8_t
+fed_keep_smallest(const book_t* book, void* ctx) {
+    fed_visit_ctx_t* visit;
+    const book_t** heap;
+    size_t i;
+
+    visit = ctx;
+    heap = visit->shard->top;
+
+    if (visit->shard->top_count < visit->limit) {
+        /* Còn chỗ: thêm vào cuối rồi đẩy lên */
+        i = visit->shard->top_count++;
+        while (i > 0 && heap[(i - 1) / 2]->book_id < book->book_id) {
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heap[i] = book;
+    } else if (visit->limit > 0 && book->book_id < heap[0]->book_id) {
+        /* Thay gốc (ID lớn nhất đang giữ) rồi đẩy xuống */
+        heap[0] = book;
+        fed_sift_down(heap, visit->shard->top_count, 0);
+    }
+
+    return 1;
+}
+
+/**
+ * \brief           Tìm kiếm trên một chi nhánh, giữ tối đa \p limit kết quả theo ID tăng dần
+ * \param[in,out]   shard: Chi nhánh
+ * \param[in]       ctx: Con trỏ tới \ref fed_search_ctx_t
+ */
+static void
+fed_search_shard(fed_shard_t* shard, const void* ctx) {
+    const fed_search_ctx_t* search;
+    const book_list_t* books;
+    fed_visit_ctx_t visit;
+    scan_result_t result;
+    const book_t* largest;
+    size_t end;
+    size_t i;
+
+    search = ctx;
+    books = shard->library->books;
+    shard->top_count = 0;
+    shard->total = 0;
+
+    /* Chi nhánh có pool quét riêng: quét song song bên trong, kết quả đã theo thứ tự ID */
+    if (shard->library->scan != NULL
+        && scan_books_match(shard->library->scan, books, search->field, search->query, &result) == SCAN_OK) {
+        shard->total = result.count;
+        for (i = 0; i < result.count && i < search->limit; i++) {
+            shard->top[i] = &books->books[result.positions[i]];
+        }
+        shard->top_count = i;
+        return;
+    }
+
+    visit.shard = shard;
+    visit.limit = search->limit;
+    shard->total = book_query(books, (search->field == QUERY_FIELD_TITLE) ? BOOK_FILTER_TITLE : BOOK_FILTER_AUTHOR,
+                              search->query, fed_keep_smallest, &visit);
+
+    /* Sắp heap tại chỗ thành thứ tự ID tăng dần */
+    for (end = shard->top_count; end > 1; end--) {
+        largest = shard->top[0];
+        shard->top[0] = shard->top[end - 1];
+        shard->top[end - 1] = largest;
+        fed_sift_down(shard->top, end - 1, 0);
+    }
+}
+
+/**
+ * \brief           Tìm kiếm trên mọi chi nhánh cùng lúc
+ *
+ * Mỗi chi nhánh chỉ giữ \p limit kết quả có ID nhỏ nhất; các danh sách đã sắp
+ * được trộn thành \p limit kết quả chung. Bộ nhớ và công trộn chỉ phụ thuộc
+ * \p limit và số chi nhánh, không phụ thuộc số sách khớp.
+ *
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       query: Chuỗi cần tìm (không phân biệt hoa thường)
+ * \param[in]       limit: Số kết quả tối đa (0 hoặc lớn hơn \ref FED_MAX_RESULTS = \ref FED_MAX_RESULTS)
+ * \param[out]      result: Kết quả đã trộn
+ * \return          \ref FED_OK nếu thành công, \ref fed_status_t nếu lỗi
+ */
+fed_status_t
+fed_search(fed_t* fed, query_field_t field, const char* query, size_t limit, fed_result_t* result) {
+    fed_search_ctx_t ctx;
+    size_t heads[FED_MAX_SHARDS];
+    const book_t* candidate;
+    uint32_t best;
+    uint32_t i;
+
+    if (fed == NULL || query == NULL || result == NULL || field > QUERY_FIELD_AUTHOR) {
+        return FED_INVALID_INPUT;
+    }
+    if (limit == 0 || limit > FED_MAX_RESULTS) {
+        limit = FED_MAX_RESULTS;
+    }
+
+    ctx.field = field;
+    ctx.query = query;
+    ctx.limit = limit;
+    fed_run(fed, fed_search_shard, &ctx);
+
+    /* Trộn các danh sách đã sắp: mỗi bước lấy đầu danh sách có ID nhỏ nhất */
+    result->count = 0;
+    result->total = 0;
+    for (i = 0; i < fed->shard_count; i++) {
+        heads[i] = 0;
+        result->total += fed->shards[i].total;
+    }
+    while (result->count < limit) {
+        best = FED_MAX_SHARDS;
+        for (i = 0; i < fed->shard_count; i++) {
+            if (heads[i] < fed->shards[i].top_count
+                && (best == FED_MAX_SHARDS
+                    || fed->shards[i].top[heads[i]]->book_id < fed->shards[best].top[heads[best]]->book_id)) {
+                best = i;
+            }
+        }
+        if (best == FED_MAX_SHARDS) {
+            break;
+        }
+        candidate = fed->shards[best].top[heads[best]++];
+        result->hits[result->count].book = candidate;
+        result->hits[result->count].shard = best;
+        result->count++;
+    }
+
+    return FED_OK;
+}
+
+/**
+ * \brief           Đếm sách và người dùng của một chi nhánh
+ * \param[in,out]   shard: Chi nhánh
+ * \param[in]       ctx: Không dùng
+ */
+static void
+fed_count_shard(fed_shard_t* shard, const void* ctx) {
+    (void)ctx;
+    scan_books_count(shard->library->scan, shard->library->books, &shard->counts);
+    shard->users = user_count_total(shard->library->users);
+}
+
+/**
+ * \brief           Thống kê gộp của mọi chi nhánh (đếm song song theo chi nhánh)
+ *
+ * Số liệu riêng của từng chi nhánh nằm lại trong \ref fed_shard_t::counts và
+ * \ref fed_shard_t::users sau khi hàm trả về.
+ *
+ * \param[in,out]   fed: Con trỏ tới liên kết
+ * \param[out]      stats: Thống kê gộp
+ */
+void
+fed_statistics(fed_t* fed, fed_stats_t* stats) {
+    uint32_t i;
+
+    if (fed == NULL || stats == NULL) {
+        return;
+    }
+
+    fed_run(fed, fed_count_shard, NULL);
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < fed->shard_count; i++) {
+        stats->books.titles += fed->shards[i].counts.titles;
+        stats->books.copies += fed->shards[i].counts.copies;
+        stats->books.borrowed += fed->shards[i].counts.borrowed;
+        stats->books.available += fed->shards[i].counts.available;
+        stats->users += fed->shards[i].users;
+    }
+}
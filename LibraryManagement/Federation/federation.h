@@ -0,0 +1,170 @@
+/**
+ * \file            federation.h
+ * \brief           Liên kết nhiều thư viện chi nhánh thành một catalog chung
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef FEDERATION_HDR_H
+#define FEDERATION_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "../Management/management.h"
+#include "../Scan/scan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define FED_MAX_SHARDS              16          /*!< Số chi nhánh tối đa */
+#define FED_MAX_RESULTS             64          /*!< Số kết quả tối đa của một lần tìm kiếm (top-K) */
+#define FED_NAME_LENGTH             32          /*!< Độ dài tên chi nhánh */
+
+/**
+ * \brief           Trạng thái trả về của các hàm liên kết
+ */
+typedef enum {
+    FED_OK = 0,                                 /*!< Thành công */
+    FED_ERROR,                                  /*!< Lỗi chung (không tạo được luồng, ...) */
+    FED_INVALID_INPUT,                          /*!< Dữ liệu đầu vào không hợp lệ */
+    FED_FULL,                                   /*!< Đã đủ số chi nhánh hoặc dải ID của chi nhánh đã hết */
+    FED_OVERLAP,                                /*!< Dải ID trùng với chi nhánh khác */
+    FED_NO_SHARD,                               /*!< Không chi nhánh nào sở hữu ID */
+} fed_status_t;
+
+/**
+ * \brief           Một chi nhánh: thư viện độc lập sở hữu một dải ID sách
+ *
+ * Phần kết quả của lần truy vấn gần nhất nằm cùng chi nhánh và chiếm trọn
+ * cache line riêng, nên các luồng ghi song song không tranh nhau một dòng cache.
+ */
+typedef struct {
+    _Alignas(SCAN_CACHE_LINE) library_t* library; /*!< Thư viện của chi nhánh */
+    char name[FED_NAME_LENGTH];                 /*!< Tên chi nhánh */
+    uint32_t first_id;                          /*!< ID sách nhỏ nhất chi nhánh sở hữu */
+    uint32_t last_id;                           /*!< ID sách lớn nhất chi nhánh sở hữu */
+    const book_t* top[FED_MAX_RESULTS];         /*!< Kết quả tìm kiếm gần nhất, theo ID tăng dần */
+    size_t top_count;                           /*!< Số phần tử của \ref top */
+    size_t total;                               /*!< Số sách khớp của chi nhánh */
+    scan_counts_t counts;                       /*!< Thống kê gần nhất của chi nhánh */
+    size_t users;                               /*!< Số người dùng của chi nhánh */
+} fed_shard_t;
+
+/**
+ * \brief           Một kết quả tìm kiếm đã trộn
+ */
+typedef struct {
+    const book_t* book;                         /*!< Sách khớp (hợp lệ tới lần sửa kế tiếp của chi nhánh) */
+    uint32_t shard;                             /*!< Chỉ số chi nhánh sở hữu sách */
+} fed_hit_t;
+
+/**
+ * \brief           Kết quả tìm kiếm trên mọi chi nhánh: K sách có ID nhỏ nhất và tổng số khớp
+ */
+typedef struct {
+    fed_hit_t hits[FED_MAX_RESULTS];            /*!< Các sách khớp theo ID tăng dần */
+    size_t count;                               /*!< Số phần tử của \ref hits */
+    size_t total;                               /*!< Tổng số sách khớp trên mọi chi nhánh */
+} fed_result_t;
+
+/**
+ * \brief           Thống kê gộp của mọi chi nhánh
+ */
+typedef struct {
+    scan_counts_t books;                        /*!< Tổng đầu sách, bản sao, bản mượn, bản có sẵn */
+    size_t users;                               /*!< Tổng số người dùng */
+} fed_stats_t;
+
+/**
+ * \brief           Hàm chạy trên một chi nhánh trong lần phát tán
+ * \param[in,out]   shard: Chi nhánh
+ * \param[in]       ctx: Ngữ cảnh do người gọi truyền vào
+ */
+typedef void (*fed_shard_fn)(fed_shard_t* shard, const void* ctx);
+
+/**
+ * \brief           Tham số khởi động của một luồng chi nhánh
+ */
+typedef struct {
+    void* fed;                                  /*!< Liên kết sở hữu luồng */
+    uint32_t index;                             /*!< Chỉ số chi nhánh luồng phục vụ */
+} fed_thread_arg_t;
+
+/**
+ * \brief           Liên kết các chi nhánh
+ *
+ * Chi nhánh được giữ theo thứ tự \ref fed_shard_t::first_id nên định tuyến
+ * theo ID là một lần tìm nhị phân. Mỗi chi nhánh từ thứ hai trở đi có một
+ * luồng nền riêng; luồng gọi tự chạy chi nhánh đầu tiên. Liên kết chỉ phục vụ
+ * một truy vấn tại một thời điểm.
+ */
+typedef struct {
+    fed_shard_t shards[FED_MAX_SHARDS];         /*!< Các chi nhánh */
+    uint32_t shard_count;                       /*!< Số chi nhánh */
+    pthread_t threads[FED_MAX_SHARDS];          /*!< Luồng nền (chỉ số 0 không dùng) */
+    fed_thread_arg_t args[FED_MAX_SHARDS];      /*!< Tham số của từng luồng */
+    uint32_t thread_count;                      /*!< Số luồng nền đã tạo */
+    pthread_mutex_t lock;                       /*!< Khóa điều phối */
+    pthread_cond_t start_cond;                  /*!< Báo có truy vấn mới */
+    pthread_cond_t done_cond;                   /*!< Báo các luồng nền đã xong */
+    uint64_t job_seq;                           /*!< Số thứ tự truy vấn */
+    uint32_t pending;                           /*!< Số luồng nền chưa xong truy vấn hiện tại */
+    uint8_t shutdown;                           /*!< 1 khi liên kết đang dừng */
+    fed_shard_fn fn;                            /*!< Hàm của truy vấn hiện tại */
+    const void* ctx;                            /*!< Ngữ cảnh của truy vấn hiện tại */
+} fed_t;
+
+/* Khai báo các hàm quản lý liên kết */
+fed_status_t    fed_init(fed_t* fed);
+void            fed_destroy(fed_t* fed);
+fed_status_t    fed_add_shard(fed_t* fed, const char* name, library_t* library,
+                              uint32_t first_id, uint32_t last_id);
+fed_shard_t*    fed_route(fed_t* fed, uint32_t book_id);
+void            fed_run(fed_t* fed, fed_shard_fn fn, const void* ctx);
+
+/* Khai báo các hàm thao tác định tuyến tới một chi nhánh */
+fed_status_t    fed_add_book(fed_t* fed, uint32_t shard, const char* title, const char* author,
+                             uint32_t* assigned_id);
+book_t*         fed_find_book(fed_t* fed, uint32_t book_id, uint32_t* shard);
+mgmt_status_t   fed_borrow_book(fed_t* fed, uint32_t user_id, uint32_t book_id);
+mgmt_status_t   fed_return_book(fed_t* fed, uint32_t user_id, uint32_t book_id, uint32_t* handed_to);
+
+/* Khai báo các hàm phát tán tới mọi chi nhánh */
+fed_status_t    fed_search(fed_t* fed, query_field_t field, const char* query, size_t limit,
+                           fed_result_t* result);
+void            fed_statistics(fed_t* fed, fed_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FEDERATION_HDR_H */
@@ -0,0 +1,300 @@
+/**
+ * \file            fedtool.c
+ * \brief           Công cụ dòng lệnh thử liên kết nhiều chi nhánh (library_federation)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "federation.h"
+
+#define FEDTOOL_ID_RANGE            (MAX_ID_VALUE / FED_MAX_SHARDS) /* Dải ID của mỗi chi nhánh */
+#define FEDTOOL_USERS               50          /* Số người dùng mẫu mỗi chi nhánh */
+
+/* Thư viện của các chi nhánh nằm ở vùng tĩnh vì kích thước phụ thuộc MAX_BOOKS */
+static book_list_t fedtool_books[FED_MAX_SHARDS];
+static user_list_t fedtool_users[FED_MAX_SHARDS];
+static hold_pool_t fedtool_holds[FED_MAX_SHARDS];
+static scan_pool_t fedtool_scans[FED_MAX_SHARDS];
+static library_t fedtool_libraries[FED_MAX_SHARDS];
+static fed_t fedtool_fed;
+
+/**
+ * \brief           Thời gian hiện tại (giây, đơn điệu)
+ * \return          Số giây
+ */
+static double
+fedtool_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Tạo các chi nhánh với sách và người dùng mẫu
+ * \param[in]       shards: Số chi nhánh
+ * \param[in]       books: Số sách mỗi chi nhánh
+ * \param[in]       workers: Số luồng quét riêng của mỗi chi nhánh (0 = không dùng pool quét)
+ * \return          0 nếu thành công
+ */
+static int
+fedtool_setup(uint32_t shards, uint32_t books, uint32_t workers) {
+    char name[FED_NAME_LENGTH];
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    library_t* library;
+    uint32_t id;
+    uint32_t s;
+    uint32_t i;
+
+    if (fed_init(&fedtool_fed) != FED_OK) {
+        return 1;
+    }
+
+    for (s = 0; s < shards; s++) {
+        library = &fedtool_libraries[s];
+        book_init(&fedtool_books[s]);
+        user_init(&fedtool_users[s]);
+        hold_pool_init(&fedtool_holds[s]);
+        memset(library, 0, sizeof(*library));
+        library->books = &fedtool_books[s];
+        library->users = &fedtool_users[s];
+        library->holds = &fedtool_holds[s];
+        if (workers > 0) {
+            if (scan_pool_init(&fedtool_scans[s], workers) != SCAN_OK) {
+                return 1;
+            }
+            library->scan = &fedtool_scans[s];
+        }
+
+        snprintf(name, sizeof(name), "Chi nhánh %u", s + 1);
+        if (fed_add_shard(&fedtool_fed, name, library, s * FEDTOOL_ID_RANGE + 1,
+                          (s + 1) * FEDTOOL_ID_RANGE) != FED_OK) {
+            fprintf(stderr, "Không thêm được %s\n", name);
+            return 1;
+        }
+
+        for (i = 0; i < books; i++) {
+            snprintf(title, sizeof(title), "Lập trình C tập %u (CN%u-%u)", i % 17 + 1, s + 1,
+                     i + 1);
+            snprintf(author, sizeof(author), "Tác giả %u", (i * 7 + s) % 997 + 1);
+            if (fed_add_book(&fedtool_fed, s, title, author, &id) != FED_OK) {
+                fprintf(stderr, "%s: không thêm được sách thứ %u\n", name, i + 1);
+                return 1;
+            }
+            if (i % 3 != 0) {
+                book_add_copies(library->books, id, (uint8_t)(i % 3));
+            }
+        }
+        for (i = 0; i < FEDTOOL_USERS; i++) {
+            snprintf(name, sizeof(name), "Bạn đọc %u-%u", s + 1, i + 1);
+            user_add(library->users, name, &id);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \brief           In một kết quả
+ * \param[in]       book: Sách
+ * \param[in]       shard: Chỉ số chi nhánh
+ */
+static void
+fedtool_print_book(const book_t* book, uint32_t shard) {
+    printf("%-8u %-14.14s %-45.45s %-14.14s %u/%u bản có sẵn\n", book->book_id,
+           fedtool_fed.shards[shard].name, book->title, book->author, book->available_count, book->copy_count);
+}
+
+/**
+ * \brief           In thống kê gộp và của từng chi nhánh
+ */
+static void
+fedtool_print_stats(void) {
+    fed_stats_t stats;
+    const fed_shard_t* shard;
+    uint32_t i;
+
+    fed_statistics(&fedtool_fed, &stats);
+    for (i = 0; i < fedtool_fed.shard_count; i++) {
+        shard = &fedtool_fed.shards[i];
+        printf("%-14s ID %7u..%-7u %6zu đầu sách %7zu bản (%zu đang mượn) %4zu người dùng\n", shard->name,
+               shard->first_id, shard->last_id, shard->counts.titles, shard->counts.copies,
+               shard->counts.borrowed, shard->users);
+    }
+    printf("Tổng: %zu đầu sách, %zu bản sao, %zu đang mượn, %zu có sẵn, %zu người dùng\n",
+           stats.books.titles, stats.books.copies, stats.books.borrowed, stats.books.available, stats.users);
+}
+
+/**
+ * \brief           Lệnh bench: so sánh tìm kiếm phát tán song song với quét lần lượt từng chi nhánh
+ * \param[in]       queries: Số lượt tìm kiếm
+ * \return          0 nếu thành công
+ */
+static int
+fedtool_bench(uint32_t queries) {
+    fed_result_t result;
+    char query[32];
+    size_t matched;
+    double start;
+    double parallel;
+    double sequential;
+    uint32_t i;
+    uint32_t s;
+
+    start = fedtool_now();
+    matched = 0;
+    for (i = 0; i < queries; i++) {
+        snprintf(query, sizeof(query), "tập %u", i % 17 + 1);
+        fed_search(&fedtool_fed, QUERY_FIELD_TITLE, query, FED_MAX_RESULTS, &result);
+        matched += result.total;
+    }
+    parallel = (fedtool_now() - start) / queries;
+
+    start = fedtool_now();
+    for (i = 0; i < queries; i++) {
+        snprintf(query, sizeof(query), "tập %u", i % 17 + 1);
+        for (s = 0; s < fedtool_fed.shard_count; s++) {
+            matched -= book_query(fedtool_fed.shards[s].library->books, BOOK_FILTER_TITLE, query, NULL, NULL);
+        }
+    }
+    sequential = (fedtool_now() - start) / queries;
+
+    printf("%u chi nhánh, %u lượt tìm: phát tán %.1f us/lượt, lần lượt %.1f us/lượt (x%.2f)%s\n",
+           fedtool_fed.shard_count, queries, parallel * 1e6, sequential * 1e6, sequential / parallel,
+           (matched == 0) ? "" : " - KẾT QUẢ LỆCH");
+    return (matched == 0) ? 0 : 1;
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+fedtool_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-s số_chi_nhánh] [-n sách_mỗi_chi_nhánh] [-w luồng_quét] lệnh\n"
+                    "  stats                        thống kê gộp và từng chi nhánh\n"
+                    "  lookup <id_sách>             tra cứu tại chi nhánh sở hữu\n"
+                    "  search title|author <từ> [k] tìm trên mọi chi nhánh, in k kết quả ID nhỏ nhất\n"
+                    "  borrow <id_người_dùng> <id_sách> mượn tại chi nhánh sở hữu sách\n"
+                    "  bench <số_lượt>              so sánh phát tán song song với quét lần lượt\n", prog);
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_federation
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Mảng tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    fed_result_t result;
+    const book_t* book;
+    const char* command;
+    mgmt_status_t mgmt_status;
+    uint32_t shards;
+    uint32_t books;
+    uint32_t workers;
+    uint32_t shard;
+    size_t i;
+    int result_code;
+    int opt;
+
+    shards = 4;
+    books = 500;
+    workers = 0;
+    while ((opt = getopt(argc, argv, "s:n:w:h")) != -1) {
+        switch (opt) {
+            case 's':
+                shards = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                books = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                workers = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fedtool_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc || shards == 0 || shards > FED_MAX_SHARDS || books > MAX_BOOKS) {
+        fedtool_usage(argv[0]);
+        return 1;
+    }
+    command = argv[optind];
+
+    if (fedtool_setup(shards, books, workers) != 0) {
+        return 1;
+    }
+
+    result_code = 0;
+    if (strcmp(command, "stats") == 0) {
+        fedtool_print_stats();
+    } else if (strcmp(command, "lookup") == 0 && optind + 1 < argc) {
+        book = fed_find_book(&fedtool_fed, (uint32_t)strtoul(argv[optind + 1], NULL, 10), &shard);
+        if (book != NULL) {
+            fedtool_print_book(book, shard);
+        } else {
+            printf("Không tìm thấy sách ID %s\n", argv[optind + 1]);
+            result_code = 1;
+        }
+    } else if (strcmp(command, "search") == 0 && optind + 2 < argc) {
+        fed_search(&fedtool_fed, (strcmp(argv[optind + 1], "author") == 0) ? QUERY_FIELD_AUTHOR : QUERY_FIELD_TITLE,
+                   argv[optind + 2], (optind + 3 < argc) ? strtoul(argv[optind + 3], NULL, 10) : 20, &result);
+        for (i = 0; i < result.count; i++) {
+            fedtool_print_book(result.hits[i].book, result.hits[i].shard);
+        }
+        printf("Tìm thấy %zu sách trên %u chi nhánh (in %zu)\n", result.total, fedtool_fed.shard_count,
+               result.count);
+    } else if (strcmp(command, "borrow") == 0 && optind + 2 < argc) {
+        mgmt_status = fed_borrow_book(&fedtool_fed, (uint32_t)strtoul(argv[optind + 1], NULL, 10),
+                                      (uint32_t)strtoul(argv[optind + 2], NULL, 10));
+        printf((mgmt_status == MGMT_OK) ? "Đã cho mượn\n" : "Không cho mượn được (mã lỗi %d)\n", (int)mgmt_status);
+        result_code = (mgmt_status == MGMT_OK) ? 0 : 1;
+    } else if (strcmp(command, "bench") == 0 && optind + 1 < argc) {
+        result_code = fedtool_bench((uint32_t)strtoul(argv[optind + 1], NULL, 10));
+    } else {
+        fedtool_usage(argv[0]);
+        result_code = 1;
+    }
+
+    fed_destroy(&fedtool_fed);
+    for (i = 0; i < shards && workers > 0; i++) {
+        scan_pool_destroy(&fedtool_scans[i]);
+    }
+    return result_code;
+}
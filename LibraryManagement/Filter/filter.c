@@ -0,0 +1,1760 @@
+/**
+ * \file            filter.c
+ * \brief           Ngôn ngữ biểu thức lọc sách, bộ lập kế hoạch theo chi phí và EXPLAIN
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <time.h>
+#include "filter.h"
+
+/**
+ * \brief           Loại token của biểu thức
+ */
+typedef enum {
+    FILTER_TOKEN_END = 0,                       /*!< Hết biểu thức */
+    FILTER_TOKEN_WORD,                          /*!< Từ khóa hoặc tên trường */
+    FILTER_TOKEN_NUMBER,                        /*!< Số nguyên không âm */
+    FILTER_TOKEN_STRING,                        /*!< Chuỗi trong dấu nháy đơn hoặc kép */
+    FILTER_TOKEN_LPAREN,                        /*!< ( */
+    FILTER_TOKEN_RPAREN,                        /*!< ) */
+    FILTER_TOKEN_EQ,                            /*!< = */
+    FILTER_TOKEN_LT,                            /*!< < */
+    FILTER_TOKEN_LE,                            /*!< <= */
+    FILTER_TOKEN_GT,                            /*!< > */
+    FILTER_TOKEN_GE,                            /*!< >= */
+    FILTER_TOKEN_INVALID,                       /*!< Ký tự không hợp lệ hoặc chuỗi thiếu dấu nháy đóng */
+} filter_token_t;
+
+/**
+ * \brief           Trạng thái của bộ phân tích cú pháp
+ */
+typedef struct {
+    const char* input;                          /*!< Biểu thức */
+    size_t pos;                                 /*!< Vị trí ngay sau token hiện tại */
+    size_t start;                               /*!< Vị trí đầu token hiện tại */
+    uint8_t token;                              /*!< \ref filter_token_t hiện tại */
+    const char* value;                          /*!< Nội dung token (chuỗi: không gồm dấu nháy) */
+    size_t length;                              /*!< Độ dài nội dung token */
+    uint32_t number;                            /*!< Giá trị của token số */
+    filter_query_t* query;                      /*!< Truy vấn đang dựng */
+    filter_status_t status;                     /*!< Lỗi đầu tiên gặp phải */
+} filter_parser_t;
+
+/**
+ * \brief           Ngữ cảnh quét song song
+ */
+typedef struct {
+    const filter_query_t* query;                /*!< Truy vấn */
+    const book_list_t* list;                    /*!< Danh sách sách */
+    filter_index_t* index;                      /*!< Chỉ mục giữ vùng kết quả */
+} filter_scan_ctx_t;
+
+/**
+ * \brief           Thời điểm hiện tại tính bằng nano giây
+ * \return          Số nano giây
+ */
+static uint64_t
+filter_clock_ns(void) {
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief           Log cơ số 2 làm tròn lên (dùng cho ước lượng chi phí)
+ * \param[in]       value: Giá trị
+ * \return          Số bit cần để biểu diễn \p value
+ */
+static double
+filter_log2(size_t value) {
+    double bits;
+
+    bits = 0.0;
+    while (value > 0) {
+        bits += 1.0;
+        value >>= 1;
+    }
+    return bits;
+}
+
+/**
+ * \brief           Đọc token kế tiếp
+ * \param[in,out]   parser: Bộ phân tích
+ */
+static void
+filter_next(filter_parser_t* parser) {
+    const char* input;
+    uint64_t number;
+    size_t pos;
+    char quote;
+
+    input = parser->input;
+    pos = parser->pos;
+    while (isspace((unsigned char)input[pos])) {
+        pos++;
+    }
+
+    parser->start = pos;
+    parser->value = &input[pos];
+    parser->length = 1;
+    switch (input[pos]) {
+        case '\0':
+            parser->token = FILTER_TOKEN_END;
+            parser->length = 0;
+            break;
+        case '(':
+            parser->token = FILTER_TOKEN_LPAREN;
+            break;
+        case ')':
+            parser->token = FILTER_TOKEN_RPAREN;
+            break;
+        case '=':
+            parser->token = FILTER_TOKEN_EQ;
+            break;
+        case '<':
+        case '>':
+            if (input[pos + 1] == '=') {
+                parser->token = (input[pos] == '<') ? FILTER_TOKEN_LE : FILTER_TOKEN_GE;
+                parser->length = 2;
+            } else {
+                parser->token = (input[pos] == '<') ? FILTER_TOKEN_LT : FILTER_TOKEN_GT;
+            }
+            break;
+        case '\'':
+        case '"':
+            /* Chuỗi kéo dài tới dấu nháy cùng loại, không có ký tự thoát */
+            quote = input[pos];
+            parser->value = &input[pos + 1];
+            parser->length = 0;
+            while (input[pos + 1 + parser->length] != '\0' && input[pos + 1 + parser->length] != quote) {
+                parser->length++;
+            }
+            if (input[pos + 1 + parser->length] != quote) {
+                parser->token = FILTER_TOKEN_INVALID;
+                parser->pos = pos;
+                return;
+            }
+            parser->token = FILTER_TOKEN_STRING;
+            parser->pos = pos + parser->length + 2;
+            return;
+        default:
+            if (isdigit((unsigned char)input[pos])) {
+                number = 0;
+                parser->length = 0;
+                while (isdigit((unsigned char)input[pos + parser->length])) {
+                    number = number * 10 + (uint64_t)(input[pos + parser->length] - '0');
+                    if (number > UINT32_MAX) {
+                        parser->token = FILTER_TOKEN_INVALID;
+                        parser->pos = pos;
+                        return;
+                    }
+                    parser->length++;
+                }
+                parser->token = FILTER_TOKEN_NUMBER;
+                parser->number = (uint32_t)number;
+            } else if (isalpha((unsigned char)input[pos]) || input[pos] == '_') {
+                parser->length = 0;
+                while (isalnum((unsigned char)input[pos + parser->length]) || input[pos + parser->length] == '_') {
+                    parser->length++;
+                }
+                parser->token = FILTER_TOKEN_WORD;
+            } else {
+                parser->token = FILTER_TOKEN_INVALID;
+                parser->pos = pos;
+                return;
+            }
+            break;
+    }
+    parser->pos = pos + parser->length;
+}
+
+/**
+ * \brief           Kiểm tra token hiện tại có phải từ khóa (không phân biệt hoa thường)
+ * \param[in]       parser: Bộ phân tích
+ * \param[in]       keyword: Từ khóa viết thường
+ * \return          1 nếu đúng, 0 nếu không
+ */
+static uint8_t
+filter_is_keyword(const filter_parser_t* parser, const char* keyword) {
+    size_t i;
+
+    if (parser->token != FILTER_TOKEN_WORD || strlen(keyword) != parser->length) {
+        return 0;
+    }
+    for (i = 0; i < parser->length; i++) {
+        if (tolower((unsigned char)parser->value[i]) != keyword[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Ghi nhận lỗi cú pháp tại token hiện tại (chỉ giữ lỗi đầu tiên)
+ * \param[in,out]   parser: Bộ phân tích
+ * \param[in]       status: Mã lỗi
+ * \return          \ref FILTER_NIL để trả thẳng từ hàm phân tích
+ */
+static uint16_t
+filter_fail(filter_parser_t* parser, filter_status_t status) {
+    if (parser->status == FILTER_OK) {
+        parser->status = status;
+    }
+    return FILTER_NIL;
+}
+
+/**
+ * \brief           Cấp một nút mới
+ * \param[in,out]   parser: Bộ phân tích
+ * \param[in]       kind: Loại nút
+ * \param[in]       left: Nút con trái
+ * \param[in]       right: Nút con phải
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu hết chỗ
+ */
+static uint16_t
+filter_new_node(filter_parser_t* parser, filter_node_kind_t kind, uint16_t left, uint16_t right) {
+    filter_node_t* node;
+
+    if (parser->query->node_count >= FILTER_MAX_NODES) {
+        return filter_fail(parser, FILTER_TOO_COMPLEX);
+    }
+
+    node = &parser->query->nodes[parser->query->node_count];
+    memset(node, 0, sizeof(*node));
+    node->kind = (uint8_t)kind;
+    node->left = left;
+    node->right = right;
+    return parser->query->node_count++;
+}
+
+static uint16_t filter_parse_or(filter_parser_t* parser);
+
+/**
+ * \brief           Phân tích điều kiện trên ID: = n, < n, <= n, > n, >= n, BETWEEN a AND b
+ * \param[in,out]   parser: Bộ phân tích (token hiện tại nằm sau từ khóa ID)
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu lỗi
+ */
+static uint16_t
+filter_parse_id(filter_parser_t* parser) {
+    filter_node_t* node;
+    uint16_t index;
+    uint8_t op;
+    uint32_t low;
+    uint32_t high;
+
+    if (filter_is_keyword(parser, "between")) {
+        filter_next(parser);
+        if (parser->token != FILTER_TOKEN_NUMBER) {
+            return filter_fail(parser, FILTER_SYNTAX_ERROR);
+        }
+        low = parser->number;
+        filter_next(parser);
+        if (!filter_is_keyword(parser, "and")) {
+            return filter_fail(parser, FILTER_SYNTAX_ERROR);
+        }
+        filter_next(parser);
+        if (parser->token != FILTER_TOKEN_NUMBER) {
+            return filter_fail(parser, FILTER_SYNTAX_ERROR);
+        }
+        high = parser->number;
+    } else {
+        op = parser->token;
+        if (op < FILTER_TOKEN_EQ || op > FILTER_TOKEN_GE) {
+            return filter_fail(parser, FILTER_SYNTAX_ERROR);
+        }
+        filter_next(parser);
+        if (parser->token != FILTER_TOKEN_NUMBER) {
+            return filter_fail(parser, FILTER_SYNTAX_ERROR);
+        }
+
+        /* Dải rỗng được biểu diễn bằng low > high */
+        low = 0;
+        high = UINT32_MAX;
+        switch (op) {
+            case FILTER_TOKEN_EQ:
+                low = parser->number;
+                high = parser->number;
+                break;
+            case FILTER_TOKEN_LT:
+                if (parser->number == 0) {
+                    low = 1;
+                    high = 0;
+                } else {
+                    high = parser->number - 1;
+                }
+                break;
+            case FILTER_TOKEN_LE:
+                high = parser->number;
+                break;
+            case FILTER_TOKEN_GT:
+                if (parser->number == UINT32_MAX) {
+                    low = 1;
+                    high = 0;
+                } else {
+                    low = parser->number + 1;
+                }
+                break;
+            default:
+                low = parser->number;
+                break;
+        }
+    }
+    filter_next(parser);
+
+    index = filter_new_node(parser, FILTER_NODE_ID_RANGE, FILTER_NIL, FILTER_NIL);
+    if (index != FILTER_NIL) {
+        node = &parser->query->nodes[index];
+        node->low = low;
+        node->high = high;
+    }
+    return index;
+}
+
+/**
+ * \brief           Phân tích điều kiện trên chuỗi: CONTAINS 'x' hoặc = 'x'
+ * \param[in,out]   parser: Bộ phân tích (token hiện tại nằm sau tên trường)
+ * \param[in]       field: Trường được so sánh
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu lỗi
+ */
+static uint16_t
+filter_parse_text(filter_parser_t* parser, query_field_t field) {
+    filter_query_t* query;
+    filter_node_t* node;
+    filter_node_kind_t kind;
+    uint16_t index;
+    size_t i;
+
+    if (filter_is_keyword(parser, "contains")) {
+        kind = FILTER_NODE_CONTAINS;
+    } else if (parser->token == FILTER_TOKEN_EQ) {
+        kind = FILTER_NODE_EQUALS;
+    } else {
+        return filter_fail(parser, FILTER_SYNTAX_ERROR);
+    }
+    filter_next(parser);
+    if (parser->token != FILTER_TOKEN_STRING || parser->length == 0) {
+        return filter_fail(parser, FILTER_SYNTAX_ERROR);
+    }
+
+    query = parser->query;
+    if (parser->length >= MAX_STRING_LENGTH || query->text_used + parser->length + 1 > FILTER_TEXT_LENGTH) {
+        return filter_fail(parser, FILTER_TOO_COMPLEX);
+    }
+    index = filter_new_node(parser, kind, FILTER_NIL, FILTER_NIL);
+    if (index == FILTER_NIL) {
+        return FILTER_NIL;
+    }
+
+    /* Lưu chuỗi ở dạng chữ thường giống string_contains_lower */
+    node = &query->nodes[index];
+    node->field = (uint8_t)field;
+    node->text = (uint16_t)query->text_used;
+    node->text_length = (uint16_t)parser->length;
+    for (i = 0; i < parser->length; i++) {
+        query->text[query->text_used++] = (char)tolower((unsigned char)parser->value[i]);
+    }
+    query->text[query->text_used++] = '\0';
+
+    filter_next(parser);
+    return index;
+}
+
+/**
+ * \brief           Phân tích một điều kiện hoặc biểu thức trong ngoặc
+ * \param[in,out]   parser: Bộ phân tích
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu lỗi
+ */
+static uint16_t
+filter_parse_primary(filter_parser_t* parser) {
+    uint16_t index;
+
+    if (parser->token == FILTER_TOKEN_LPAREN) {
+        filter_next(parser);
+        index = filter_parse_or(parser);
+        if (index == FILTER_NIL) {
+            return FILTER_NIL;
+        }
+        if (parser->token != FILTER_TOKEN_RPAREN) {
+            return filter_fail(parser, FILTER_SYNTAX_ERROR);
+        }
+        filter_next(parser);
+        return index;
+    }
+
+    if (filter_is_keyword(parser, "available")) {
+        filter_next(parser);
+        return filter_new_node(parser, FILTER_NODE_AVAILABLE, FILTER_NIL, FILTER_NIL);
+    }
+    if (filter_is_keyword(parser, "title")) {
+        filter_next(parser);
+        return filter_parse_text(parser, QUERY_FIELD_TITLE);
+    }
+    if (filter_is_keyword(parser, "author")) {
+        filter_next(parser);
+        return filter_parse_text(parser, QUERY_FIELD_AUTHOR);
+    }
+    if (filter_is_keyword(parser, "id")) {
+        filter_next(parser);
+        return filter_parse_id(parser);
+    }
+
+    return filter_fail(parser, FILTER_SYNTAX_ERROR);
+}
+
+/**
+ * \brief           Phân tích NOT (ưu tiên cao nhất)
+ * \param[in,out]   parser: Bộ phân tích
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu lỗi
+ */
+static uint16_t
+filter_parse_not(filter_parser_t* parser) {
+    uint16_t child;
+
+    if (filter_is_keyword(parser, "not")) {
+        filter_next(parser);
+        child = filter_parse_not(parser);
+        if (child == FILTER_NIL) {
+            return FILTER_NIL;
+        }
+        return filter_new_node(parser, FILTER_NODE_NOT, child, FILTER_NIL);
+    }
+    return filter_parse_primary(parser);
+}
+
+/**
+ * \brief           Phân tích chuỗi AND
+ * \param[in,out]   parser: Bộ phân tích
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu lỗi
+ */
+static uint16_t
+filter_parse_and(filter_parser_t* parser) {
+    uint16_t left;
+    uint16_t right;
+
+    left = filter_parse_not(parser);
+    while (left != FILTER_NIL && filter_is_keyword(parser, "and")) {
+        filter_next(parser);
+        right = filter_parse_not(parser);
+        if (right == FILTER_NIL) {
+            return FILTER_NIL;
+        }
+        left = filter_new_node(parser, FILTER_NODE_AND, left, right);
+    }
+    return left;
+}
+
+/**
+ * \brief           Phân tích chuỗi OR (ưu tiên thấp nhất)
+ * \param[in,out]   parser: Bộ phân tích
+ * \return          Chỉ số nút, \ref FILTER_NIL nếu lỗi
+ */
+static uint16_t
+filter_parse_or(filter_parser_t* parser) {
+    uint16_t left;
+    uint16_t right;
+
+    left = filter_parse_and(parser);
+    while (left != FILTER_NIL && filter_is_keyword(parser, "or")) {
+        filter_next(parser);
+        right = filter_parse_and(parser);
+        if (right == FILTER_NIL) {
+            return FILTER_NIL;
+        }
+        left = filter_new_node(parser, FILTER_NODE_OR, left, right);
+    }
+    return left;
+}
+
+/**
+ * \brief           Phân tích một biểu thức lọc
+ *
+ * Cú pháp (từ khóa không phân biệt hoa thường):
+ *
+ *     [EXPLAIN] [biểu_thức] [ORDER BY id|title|author [ASC|DESC]] [LIMIT n]
+ *     biểu_thức := điều_kiện | NOT biểu_thức | biểu_thức AND biểu_thức
+ *                | biểu_thức OR biểu_thức | ( biểu_thức )
+ *     điều_kiện := title|author CONTAINS 'chuỗi' | title|author = 'chuỗi' | available
+ *                | id = n | id < n | id <= n | id > n | id >= n | id BETWEEN a AND b
+ *
+ * NOT ưu tiên hơn AND, AND ưu tiên hơn OR. Biểu thức rỗng khớp mọi sách.
+ *
+ * \param[in]       input: Biểu thức
+ * \param[out]      query: Truy vấn đã phân tích
+ * \param[out]      error_offset: Vị trí token gây lỗi (có thể NULL)
+ * \return          \ref FILTER_OK nếu thành công, \ref filter_status_t nếu lỗi
+ */
+filter_status_t
+filter_parse(const char* input, filter_query_t* query, size_t* error_offset) {
+    filter_parser_t parser;
+
+    if (input == NULL || query == NULL) {
+        return FILTER_INVALID_INPUT;
+    }
+
+    memset(query, 0, sizeof(*query));
+    query->root = FILTER_NIL;
+    query->limit = FILTER_NO_LIMIT;
+    query->order = FILTER_ORDER_ID;
+
+    memset(&parser, 0, sizeof(parser));
+    parser.input = input;
+    parser.query = query;
+    parser.status = FILTER_OK;
+    filter_next(&parser);
+
+    if (filter_is_keyword(&parser, "explain")) {
+        query->explain = 1;
+        filter_next(&parser);
+    }
+
+    if (parser.token == FILTER_TOKEN_END || filter_is_keyword(&parser, "order")
+        || filter_is_keyword(&parser, "limit")) {
+        query->root = filter_new_node(&parser, FILTER_NODE_ALL, FILTER_NIL, FILTER_NIL);
+    } else {
+        query->root = filter_parse_or(&parser);
+    }
+
+    if (query->root != FILTER_NIL && filter_is_keyword(&parser, "order")) {
+        filter_next(&parser);
+        if (!filter_is_keyword(&parser, "by")) {
+            filter_fail(&parser, FILTER_SYNTAX_ERROR);
+        } else {
+            filter_next(&parser);
+            if (filter_is_keyword(&parser, "id")) {
+                query->order = FILTER_ORDER_ID;
+            } else if (filter_is_keyword(&parser, "title")) {
+                query->order = FILTER_ORDER_TITLE;
+            } else if (filter_is_keyword(&parser, "author")) {
+                query->order = FILTER_ORDER_AUTHOR;
+            } else {
+                filter_fail(&parser, FILTER_SYNTAX_ERROR);
+            }
+            if (parser.status == FILTER_OK) {
+                filter_next(&parser);
+                if (filter_is_keyword(&parser, "desc")) {
+                    query->descending = 1;
+                    filter_next(&parser);
+                } else if (filter_is_keyword(&parser, "asc")) {
+                    filter_next(&parser);
+                }
+            }
+        }
+    }
+
+    if (query->root != FILTER_NIL && parser.status == FILTER_OK && filter_is_keyword(&parser, "limit")) {
+        filter_next(&parser);
+        if (parser.token != FILTER_TOKEN_NUMBER) {
+            filter_fail(&parser, FILTER_SYNTAX_ERROR);
+        } else {
+            query->limit = parser.number;
+            filter_next(&parser);
+        }
+    }
+
+    if (parser.status == FILTER_OK && (query->root == FILTER_NIL || parser.token != FILTER_TOKEN_END)) {
+        filter_fail(&parser, FILTER_SYNTAX_ERROR);
+    }
+    if (parser.status != FILTER_OK && error_offset != NULL) {
+        *error_offset = parser.start;
+    }
+    return parser.status;
+}
+
+/**
+ * \brief           So sánh bằng không phân biệt hoa thường
+ * \param[in]       haystack: Chuỗi của sách
+ * \param[in]       needle_lower: Chuỗi đã chuyển chữ thường
+ * \return          1 nếu bằng, 0 nếu khác
+ */
+static uint8_t
+filter_equals_lower(const char* haystack, const char* needle_lower) {
+    while (*haystack != '\0' && tolower((unsigned char)*haystack) == (unsigned char)*needle_lower) {
+        haystack++;
+        needle_lower++;
+    }
+    return *haystack == '\0' && *needle_lower == '\0';
+}
+
+/**
+ * \brief           Đánh giá một nút trên một sách
+ * \param[in]       query: Truy vấn
+ * \param[in]       index: Chỉ số nút
+ * \param[in]       book: Sách
+ * \return          1 nếu khớp, 0 nếu không
+ */
+static uint8_t
+filter_eval(const filter_query_t* query, uint16_t index, const book_t* book) {
+    const filter_node_t* node;
+    const char* field;
+
+    node = &query->nodes[index];
+    field = (node->field == QUERY_FIELD_TITLE) ? book->title : book->author;
+    switch (node->kind) {
+        case FILTER_NODE_ALL:
+            return 1;
+        case FILTER_NODE_CONTAINS:
+            return (uint8_t)string_contains_lower(field, &query->text[node->text]);
+        case FILTER_NODE_EQUALS:
+            return filter_equals_lower(field, &query->text[node->text]);
+        case FILTER_NODE_AVAILABLE:
+            return !book->is_borrowed;
+        case FILTER_NODE_ID_RANGE:
+            return book->book_id >= node->low && book->book_id <= node->high;
+        case FILTER_NODE_AND:
+            return filter_eval(query, node->left, book) && filter_eval(query, node->right, book);
+        case FILTER_NODE_OR:
+            return filter_eval(query, node->left, book) || filter_eval(query, node->right, book);
+        case FILTER_NODE_NOT:
+            return !filter_eval(query, node->left, book);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \brief           Kiểm tra một sách có khớp biểu thức
+ * \param[in]       query: Truy vấn đã phân tích
+ * \param[in]       book: Sách
+ * \return          1 nếu khớp, 0 nếu không
+ */
+uint8_t
+filter_matches(const filter_query_t* query, const book_t* book) {
+    if (query == NULL || book == NULL || query->root == FILTER_NIL) {
+        return 0;
+    }
+    return filter_eval(query, query->root, book);
+}
+
+/**
+ * \brief           Khởi tạo chỉ mục rỗng (bộ nhớ chỉ được cấp ở lần dựng đầu tiên)
+ * \param[out]      index: Con trỏ tới chỉ mục
+ * \param[in]       scan: Pool quét song song (NULL = chỉ quét tuần tự)
+ */
+void
+filter_index_init(filter_index_t* index, scan_pool_t* scan) {
+    if (index != NULL) {
+        memset(index, 0, sizeof(*index));
+        index->scan = scan;
+    }
+}
+
+/**
+ * \brief           Giải phóng bộ nhớ của chỉ mục
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ */
+void
+filter_index_destroy(filter_index_t* index) {
+    if (index == NULL) {
+        return;
+    }
+
+    free(index->ids);
+    free(index->offsets);
+    free(index->cursors);
+    free(index->postings);
+    free(index->available);
+    free(index->matches);
+    free(index->sort_keys);
+    filter_index_init(index, index->scan);
+}
+
+/**
+ * \brief           Bucket của một trigram trong một trường
+ * \param[in]       field: Trường
+ * \param[in]       gram: Ba byte đã chuyển chữ thường
+ * \return          Chỉ số bucket
+ */
+static uint32_t
+filter_gram_bucket(query_field_t field, const char* gram) {
+    uint64_t key;
+
+    key = ((uint64_t)field << 24) | ((uint64_t)(unsigned char)gram[0] << 16)
+          | ((uint64_t)(unsigned char)gram[1] << 8) | (uint64_t)(unsigned char)gram[2];
+    return (uint32_t)(hash_u64(key) & (FILTER_GRAM_BUCKETS - 1));
+}
+
+/**
+ * \brief           Duyệt các trigram của một trường, ghi nhận vị trí sách vào từng bucket
+ *
+ * Lượt đếm (\p postings = NULL) tăng offsets; lượt ghi đặt vị trí vào cursor
+ * của bucket. Vị trí tăng dần nên một bucket đã có sách này khi phần tử cuối
+ * của nó bằng \p position; \p last giữ vị trí cuối + 1 của mỗi bucket ở lượt đếm.
+ *
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ * \param[in]       field: Trường
+ * \param[in]       text: Chuỗi của sách
+ * \param[in]       position: Vị trí sách
+ * \param[in]       fill: 0 = lượt đếm, 1 = lượt ghi
+ */
+static void
+filter_index_grams(filter_index_t* index, query_field_t field, const char* text, uint32_t position, uint8_t fill) {
+    char lower[MAX_STRING_LENGTH];
+    uint32_t bucket;
+    size_t length;
+    size_t i;
+
+    for (length = 0; length < MAX_STRING_LENGTH - 1 && text[length] != '\0'; length++) {
+        lower[length] = (char)tolower((unsigned char)text[length]);
+    }
+
+    for (i = 0; i + 3 <= length; i++) {
+        bucket = filter_gram_bucket(field, &lower[i]);
+        if (!fill) {
+            if (index->cursors[bucket] != position + 1) {
+                index->cursors[bucket] = position + 1;
+                index->offsets[bucket + 1]++;
+            }
+        } else if (index->cursors[bucket] == index->offsets[bucket]
+                   || index->postings[index->cursors[bucket] - 1] != position) {
+            index->postings[index->cursors[bucket]++] = position;
+        }
+    }
+}
+
+/**
+ * \brief           Hàm so sánh phần tử chỉ mục ID cho qsort
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+filter_compare_ids(const void* a, const void* b) {
+    const filter_id_entry_t* x;
+    const filter_id_entry_t* y;
+
+    x = a;
+    y = b;
+    return (x->book_id > y->book_id) - (x->book_id < y->book_id);
+}
+
+/**
+ * \brief           Dựng lại chỉ mục ID và trigram nếu ID, vị trí hoặc chuỗi của sách đã đổi
+ * \param[in,out]   index: Con trỏ tới chỉ mục
+ * \param[in]       list: Danh sách sách
+ * \param[out]      rebuilt: 1 nếu đã dựng lại (có thể NULL)
+ * \return          \ref FILTER_OK nếu thành công, \ref filter_status_t nếu lỗi
+ */
+filter_status_t
+filter_index_refresh(filter_index_t* index, const book_list_t* list, uint8_t* rebuilt) {
+    uint32_t* postings;
+    size_t total;
+    size_t i;
+    uint32_t b;
+
+    if (index == NULL || list == NULL) {
+        return FILTER_INVALID_INPUT;
+    }
+    if (rebuilt != NULL) {
+        *rebuilt = 0;
+    }
+    if ((index->built & 1) && index->list == list && index->catalog_generation == list->catalog_generation
+        && index->count == list->count) {
+        return FILTER_OK;
+    }
+
+    /* Các mảng theo sách cấp một lần cho MAX_BOOKS, chỉ danh sách trigram tăng theo nội dung */
+    if (index->ids == NULL) {
+        index->capacity = MAX_BOOKS;
+        index->ids = malloc(MAX_BOOKS * sizeof(index->ids[0]));
+        index->offsets = malloc((FILTER_GRAM_BUCKETS + 1) * sizeof(index->offsets[0]));
+        index->cursors = malloc(FILTER_GRAM_BUCKETS * sizeof(index->cursors[0]));
+        index->available = malloc(((MAX_BOOKS + 63) / 64) * sizeof(index->available[0]));
+        index->matches = malloc(MAX_BOOKS * sizeof(index->matches[0]));
+        index->sort_keys = malloc(MAX_BOOKS * sizeof(index->sort_keys[0]));
+        if (index->ids == NULL || index->offsets == NULL || index->cursors == NULL || index->available == NULL
+            || index->matches == NULL || index->sort_keys == NULL) {
+            filter_index_destroy(index);
+            return FILTER_NO_MEMORY;
+        }
+    }
+    index->built = 0;
+
+    for (i = 0; i < list->count; i++) {
+        index->ids[i].book_id = list->books[i].book_id;
+        index->ids[i].position = (uint32_t)i;
+    }
+    qsort(index->ids, list->count, sizeof(index->ids[0]), filter_compare_ids);
+
+    /* Lượt 1: đếm số sách của mỗi bucket */
+    memset(index->offsets, 0, (FILTER_GRAM_BUCKETS + 1) * sizeof(index->offsets[0]));
+    memset(index->cursors, 0, FILTER_GRAM_BUCKETS * sizeof(index->cursors[0]));
+    for (i = 0; i < list->count; i++) {
+        filter_index_grams(index, QUERY_FIELD_TITLE, list->books[i].title, (uint32_t)i, 0);
+        filter_index_grams(index, QUERY_FIELD_AUTHOR, list->books[i].author, (uint32_t)i, 0);
+    }
+    for (b = 0; b < FILTER_GRAM_BUCKETS; b++) {
+        index->offsets[b + 1] += index->offsets[b];
+    }
+
+    total = index->offsets[FILTER_GRAM_BUCKETS];
+    if (total > index->posting_capacity) {
+        postings = realloc(index->postings, total * sizeof(postings[0]));
+        if (postings == NULL) {
+            return FILTER_NO_MEMORY;
+        }
+        index->postings = postings;
+        index->posting_capacity = total;
+    }
+
+    /* Lượt 2: ghi vị trí sách vào bucket */
+    memcpy(index->cursors, index->offsets, FILTER_GRAM_BUCKETS * sizeof(index->cursors[0]));
+    for (i = 0; i < list->count; i++) {
+        filter_index_grams(index, QUERY_FIELD_TITLE, list->books[i].title, (uint32_t)i, 1);
+        filter_index_grams(index, QUERY_FIELD_AUTHOR, list->books[i].author, (uint32_t)i, 1);
+    }
+
+    index->list = list;
+    index->count = list->count;
+    index->catalog_generation = list->catalog_generation;
+    index->built = 1;
+    index->builds++;
+    if (rebuilt != NULL) {
+        *rebuilt = 1;
+    }
+    return FILTER_OK;
+}
+
+/**
+ * \brief           Dựng lại tập sách có sẵn nếu có lượt mượn/trả sau lần dựng trước
+ * \param[in,out]   index: Con trỏ tới chỉ mục (chỉ mục nội dung đã hợp lệ)
+ * \param[in]       list: Danh sách sách
+ * \return          1 nếu đã dựng lại, 0 nếu tập còn hợp lệ
+ */
+static uint8_t
+filter_refresh_available(filter_index_t* index, const book_list_t* list) {
+    size_t words;
+    size_t i;
+
+    if ((index->built & 2) && index->generation == list->generation) {
+        return 0;
+    }
+
+    words = (list->count + 63) / 64;
+    memset(index->available, 0, words * sizeof(index->available[0]));
+    index->available_count = 0;
+    for (i = 0; i < list->count; i++) {
+        if (!list->books[i].is_borrowed) {
+            index->available[i / 64] |= (uint64_t)1 << (i % 64);
+            index->available_count++;
+        }
+    }
+
+    index->generation = list->generation;
+    index->built |= 2;
+    return 1;
+}
+
+/**
+ * \brief           Hàm so sánh số nguyên 64 bit cho qsort
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+filter_compare_u64(const void* a, const void* b) {
+    uint64_t x;
+    uint64_t y;
+
+    x = *(const uint64_t*)a;
+    y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           Chọn các bucket trigram dùng để lấy ứng viên cho một chuỗi
+ *
+ * Bucket được sắp theo số sách tăng dần và bỏ trùng; chỉ giữ \ref FILTER_MAX_GRAMS
+ * bucket nhỏ nhất vì giao thêm danh sách dài hầu như không loại thêm ứng viên.
+ *
+ * \param[in]       index: Chỉ mục
+ * \param[in]       query: Truy vấn
+ * \param[in]       node: Nút chuỗi (độ dài ít nhất 3)
+ * \param[out]      buckets: Các bucket được chọn
+ * \return          Số bucket
+ */
+static size_t
+filter_pick_grams(const filter_index_t* index, const filter_query_t* query, const filter_node_t* node,
+                  uint32_t* buckets) {
+    uint64_t keys[MAX_STRING_LENGTH];
+    const char* text;
+    uint32_t bucket;
+    size_t count;
+    size_t picked;
+    size_t i;
+
+    text = &query->text[node->text];
+    count = 0;
+    for (i = 0; i + 3 <= node->text_length; i++) {
+        bucket = filter_gram_bucket((query_field_t)node->field, &text[i]);
+        keys[count++] = ((uint64_t)(index->offsets[bucket + 1] - index->offsets[bucket]) << 32) | bucket;
+    }
+    qsort(keys, count, sizeof(keys[0]), filter_compare_u64);
+
+    picked = 0;
+    for (i = 0; i < count && picked < FILTER_MAX_GRAMS; i++) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            buckets[picked++] = (uint32_t)keys[i];
+        }
+    }
+    return picked;
+}
+
+/**
+ * \brief           Vị trí đầu tiên trong chỉ mục ID có ID >= \p book_id
+ * \param[in]       index: Chỉ mục
+ * \param[in]       book_id: ID cần tìm
+ * \return          Vị trí trong index->ids
+ */
+static size_t
+filter_lower_bound(const filter_index_t* index, uint64_t book_id) {
+    size_t low;
+    size_t high;
+    size_t mid;
+
+    low = 0;
+    high = index->count;
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (index->ids[mid].book_id < book_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * \brief           Ước lượng số sách khớp và chi phí lấy ứng viên qua chỉ mục của một nút
+ *
+ * Với AND, nút con có tổng chi phí lấy và kiểm tra ứng viên thấp hơn được đưa
+ * sang bên trái để làm nút dẫn; nút con còn lại chỉ được kiểm tra trên ứng viên.
+ *
+ * \param[in,out]   query: Truy vấn
+ * \param[in]       index: Chỉ mục đã dựng
+ * \param[in]       available_count: Số sách có sẵn (theo lần dựng tập gần nhất)
+ * \param[in]       rebuild_cost: Chi phí dựng lại tập có sẵn (0 nếu còn hợp lệ)
+ * \param[in]       id: Chỉ số nút
+ */
+static void
+filter_estimate(filter_query_t* query, const filter_index_t* index, double available_count, double rebuild_cost,
+                uint16_t id) {
+    uint32_t buckets[FILTER_MAX_GRAMS];
+    filter_node_t* node;
+    filter_node_t* left;
+    filter_node_t* right;
+    double books;
+    double left_total;
+    double right_total;
+    size_t picked;
+    size_t first;
+    size_t i;
+    uint32_t size;
+    uint16_t swap;
+
+    node = &query->nodes[id];
+    books = (double)index->count;
+    node->access = FILTER_ACCESS_NONE;
+    node->cost = -1.0;
+    node->candidates = books;
+
+    switch (node->kind) {
+        case FILTER_NODE_ALL:
+            node->rows = books;
+            break;
+        case FILTER_NODE_CONTAINS:
+        case FILTER_NODE_EQUALS:
+            if (node->text_length < 3) {
+                node->rows = books * FILTER_TEXT_SELECTIVITY;
+                break;
+            }
+            /* Sách khớp phải chứa mọi trigram: danh sách ngắn nhất là cận trên */
+            picked = filter_pick_grams(index, query, node, buckets);
+            node->grams = (uint32_t)picked;
+            node->candidates = books;
+            node->cost = 0.0;
+            for (i = 0; i < picked; i++) {
+                size = index->offsets[buckets[i] + 1] - index->offsets[buckets[i]];
+                if ((double)size < node->candidates) {
+                    node->candidates = (double)size;
+                }
+                node->cost += (double)size * FILTER_COST_POSTING;
+            }
+            node->rows = node->candidates;
+            node->access = FILTER_ACCESS_TRIGRAM;
+            break;
+        case FILTER_NODE_AVAILABLE:
+            node->rows = available_count;
+            node->candidates = available_count;
+            node->cost = rebuild_cost + books / 64.0 * FILTER_COST_POSTING;
+            node->access = FILTER_ACCESS_AVAILABLE;
+            break;
+        case FILTER_NODE_ID_RANGE:
+            /* Số ID trong dải được đếm chính xác bằng hai lần tìm nhị phân */
+            first = filter_lower_bound(index, node->low);
+            node->rows = (node->low > node->high)
+                             ? 0.0
+                             : (double)(filter_lower_bound(index, (uint64_t)node->high + 1) - first);
+            node->candidates = node->rows;
+            node->cost = 2.0 * filter_log2(index->count) * FILTER_COST_POSTING
+                         + node->rows * filter_log2((size_t)node->rows) * FILTER_COST_POSTING;
+            node->access = FILTER_ACCESS_ID_RANGE;
+            break;
+        case FILTER_NODE_NOT:
+            filter_estimate(query, index, available_count, rebuild_cost, node->left);
+            node->rows = books - query->nodes[node->left].rows;
+            break;
+        case FILTER_NODE_AND:
+        case FILTER_NODE_OR:
+            filter_estimate(query, index, available_count, rebuild_cost, node->left);
+            filter_estimate(query, index, available_count, rebuild_cost, node->right);
+            left = &query->nodes[node->left];
+            right = &query->nodes[node->right];
+            if (node->kind == FILTER_NODE_OR) {
+                /* Giả định hai điều kiện độc lập */
+                node->rows = left->rows + right->rows - ((books > 0.0) ? left->rows * right->rows / books : 0.0);
+                if (left->cost >= 0.0 && right->cost >= 0.0) {
+                    node->candidates = left->candidates + right->candidates;
+                    node->cost = left->cost + right->cost + node->candidates * FILTER_COST_POSTING;
+                    node->access = FILTER_ACCESS_UNION;
+                }
+                break;
+            }
+
+            node->rows = (books > 0.0) ? left->rows * right->rows / books : 0.0;
+            left_total = (left->cost >= 0.0) ? left->cost + left->candidates * FILTER_COST_FETCH : -1.0;
+            right_total = (right->cost >= 0.0) ? right->cost + right->candidates * FILTER_COST_FETCH : -1.0;
+            if (right_total >= 0.0 && (left_total < 0.0 || right_total < left_total)) {
+                swap = node->left;
+                node->left = node->right;
+                node->right = swap;
+                left = right;
+            }
+            if (left->cost >= 0.0) {
+                node->candidates = left->candidates;
+                node->cost = left->cost;
+                node->access = FILTER_ACCESS_DRIVER;
+            }
+            break;
+        default:
+            node->rows = books;
+            break;
+    }
+
+    if (node->rows > books) {
+        node->rows = books;
+    }
+    if (node->rows < 0.0) {
+        node->rows = 0.0;
+    }
+}
+
+/**
+ * \brief           Lập kế hoạch cho một truy vấn đã phân tích
+ *
+ * So sánh chi phí quét (tuần tự hoặc song song), lấy ứng viên qua chỉ mục rồi
+ * kiểm tra, và (khi sắp theo ID có LIMIT) duyệt chỉ mục ID theo thứ tự cho tới
+ * khi đủ kết quả; chọn phương án rẻ nhất. Chỉ mục được dựng lại trước nếu cần.
+ *
+ * \param[in,out]   query: Truy vấn (nhận kế hoạch và các ước lượng)
+ * \param[in,out]   index: Chỉ mục
+ * \param[in]       list: Danh sách sách
+ * \return          \ref FILTER_OK nếu thành công, \ref filter_status_t nếu lỗi
+ */
+filter_status_t
+filter_plan(filter_query_t* query, filter_index_t* index, const book_list_t* list) {
+    filter_node_t* root;
+    filter_status_t status;
+    double books;
+    double available_count;
+    double rebuild_cost;
+    double sort_cost;
+    double examined;
+    double parallel;
+    uint32_t chunks;
+    uint8_t rebuilt;
+
+    if (query == NULL || index == NULL || list == NULL || query->root == FILTER_NIL) {
+        return FILTER_INVALID_INPUT;
+    }
+
+    status = filter_index_refresh(index, list, &rebuilt);
+    if (status != FILTER_OK) {
+        return status;
+    }
+    query->rebuilt = rebuilt;
+    query->books = list->count;
+    books = (double)list->count;
+
+    /* Tập có sẵn chỉ dựng lại khi kế hoạch thật sự dùng nó; trước lần dựng đầu giả định một nửa */
+    if ((index->built & 2) && index->generation == list->generation) {
+        available_count = (double)index->available_count;
+        rebuild_cost = 0.0;
+    } else {
+        available_count = ((index->built & 2) && index->count > 0)
+                              ? (double)index->available_count * books / (double)index->count
+                              : books / 2.0;
+        rebuild_cost = books * FILTER_COST_REBUILD;
+    }
+    filter_estimate(query, index, available_count, rebuild_cost, query->root);
+    root = &query->nodes[query->root];
+    query->rows = root->rows;
+
+    /* Mọi phương án trừ duyệt theo ID đều phải sắp kết quả */
+    sort_cost = root->rows * filter_log2((size_t)root->rows) * FILTER_COST_POSTING;
+
+    query->scan_cost = books * FILTER_COST_ROW + sort_cost;
+    query->access = FILTER_ACCESS_SCAN;
+    chunks = (uint32_t)((list->count + SCAN_CHUNK_ITEMS - 1) / SCAN_CHUNK_ITEMS);
+    if (index->scan != NULL && index->scan->worker_count > 1 && chunks >= SCAN_PARALLEL_MIN_CHUNKS) {
+        parallel = books * FILTER_COST_ROW / index->scan->worker_count + FILTER_COST_PARALLEL + sort_cost;
+        if (parallel < query->scan_cost) {
+            query->scan_cost = parallel;
+            query->access = FILTER_ACCESS_PARALLEL_SCAN;
+        }
+    }
+    query->cost = query->scan_cost;
+
+    query->index_cost = -1.0;
+    if (root->cost >= 0.0) {
+        query->index_cost = root->cost + root->candidates * FILTER_COST_FETCH + sort_cost;
+        if (query->index_cost < query->cost) {
+            query->cost = query->index_cost;
+            query->access = FILTER_ACCESS_INDEX;
+        }
+    }
+
+    /* Duyệt theo ID dừng sau khoảng limit / tỷ lệ khớp sách */
+    query->order_cost = -1.0;
+    if (query->order == FILTER_ORDER_ID && query->limit != FILTER_NO_LIMIT) {
+        examined = books;
+        if (root->rows > 0.0 && (double)query->limit * books / root->rows < books) {
+            examined = (double)query->limit * books / root->rows;
+        }
+        query->order_cost = examined * FILTER_COST_FETCH;
+        if (query->order_cost < query->cost) {
+            query->cost = query->order_cost;
+            query->access = FILTER_ACCESS_ID_ORDER;
+        }
+    }
+
+    return FILTER_OK;
+}
+
+/**
+ * \brief           Hàm so sánh vị trí cho qsort
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+filter_compare_u32(const void* a, const void* b) {
+    uint32_t x;
+    uint32_t y;
+
+    x = *(const uint32_t*)a;
+    y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           Giao danh sách tăng dần \p current với \p list tại chỗ
+ *
+ * Mỗi phần tử của \p current được tìm trong \p list bằng tìm kiếm mũ từ vị trí
+ * trước đó, nên chi phí tỷ lệ với danh sách ngắn hơn khi hai độ dài chênh lệch.
+ *
+ * \param[in,out]   current: Danh sách hiện tại
+ * \param[in]       count: Số phần tử của \p current
+ * \param[in]       list: Danh sách cần giao
+ * \param[in]       length: Số phần tử của \p list
+ * \return          Số phần tử còn lại
+ */
+static size_t
+filter_intersect(uint32_t* current, size_t count, const uint32_t* list, size_t length) {
+    size_t kept;
+    size_t low;
+    size_t high;
+    size_t step;
+    size_t mid;
+    size_t i;
+
+    kept = 0;
+    low = 0;
+    for (i = 0; i < count && low < length; i++) {
+        /* Mở rộng bước gấp đôi cho tới khi vượt giá trị cần tìm, rồi tìm nhị phân */
+        step = 1;
+        high = low;
+        while (high < length && list[high] < current[i]) {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        if (high > length) {
+            high = length;
+        }
+        while (low < high) {
+            mid = low + (high - low) / 2;
+            if (list[mid] < current[i]) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low < length && list[low] == current[i]) {
+            current[kept++] = current[i];
+            low++;
+        }
+    }
+    return kept;
+}
+
+/**
+ * \brief           Lấy ứng viên (vị trí tăng dần, không trùng) của một nút qua chỉ mục
+ * \param[in,out]   query: Truy vấn
+ * \param[in,out]   index: Chỉ mục
+ * \param[in]       list: Danh sách sách
+ * \param[in]       id: Chỉ số nút (có access khác \ref FILTER_ACCESS_NONE)
+ * \param[out]      out: Mảng ứng viên cấp phát bằng malloc (người gọi giải phóng)
+ * \param[out]      count: Số ứng viên
+ * \return          \ref FILTER_OK nếu thành công, \ref filter_status_t nếu lỗi
+ */
+static filter_status_t
+filter_candidates(filter_query_t* query, filter_index_t* index, const book_list_t* list, uint16_t id,
+                  uint32_t** out, size_t* count) {
+    uint32_t buckets[FILTER_MAX_GRAMS];
+    const filter_node_t* node;
+    filter_status_t status;
+    uint32_t* left;
+    uint32_t* right;
+    uint32_t* merged;
+    uint64_t word;
+    size_t left_count;
+    size_t right_count;
+    size_t picked;
+    size_t first;
+    size_t last;
+    size_t i;
+    size_t j;
+    size_t n;
+
+    node = &query->nodes[id];
+    *out = NULL;
+    *count = 0;
+    n = 0;
+
+    switch (node->access) {
+        case FILTER_ACCESS_ID_RANGE:
+            first = filter_lower_bound(index, node->low);
+            last = (node->low > node->high) ? first : filter_lower_bound(index, (uint64_t)node->high + 1);
+            *out = malloc((last - first + 1) * sizeof(uint32_t));
+            if (*out == NULL) {
+                return FILTER_NO_MEMORY;
+            }
+            for (i = first; i < last; i++) {
+                (*out)[n++] = index->ids[i].position;
+            }
+            qsort(*out, n, sizeof(uint32_t), filter_compare_u32);
+            break;
+        case FILTER_ACCESS_TRIGRAM:
+            /* Bắt đầu từ danh sách ngắn nhất rồi giao dần với các danh sách dài hơn */
+            picked = filter_pick_grams(index, query, node, buckets);
+            first = index->offsets[buckets[0]];
+            n = index->offsets[buckets[0] + 1] - first;
+            *out = malloc((n + 1) * sizeof(uint32_t));
+            if (*out == NULL) {
+                return FILTER_NO_MEMORY;
+            }
+            memcpy(*out, &index->postings[first], n * sizeof(uint32_t));
+            for (i = 1; i < picked && n > 0; i++) {
+                n = filter_intersect(*out, n, &index->postings[index->offsets[buckets[i]]],
+                                     index->offsets[buckets[i] + 1] - index->offsets[buckets[i]]);
+            }
+            break;
+        case FILTER_ACCESS_AVAILABLE:
+            if (filter_refresh_available(index, list)) {
+                query->rebuilt |= 2;
+            }
+            *out = malloc((index->available_count + 1) * sizeof(uint32_t));
+            if (*out == NULL) {
+                return FILTER_NO_MEMORY;
+            }
+            for (i = 0; i < (list->count + 63) / 64; i++) {
+                word = index->available[i];
+                while (word != 0) {
+                    (*out)[n++] = (uint32_t)(i * 64 + (size_t)__builtin_ctzll(word));
+                    word &= word - 1;
+                }
+            }
+            break;
+        case FILTER_ACCESS_DRIVER:
+            return filter_candidates(query, index, list, node->left, out, count);
+        case FILTER_ACCESS_UNION:
+            status = filter_candidates(query, index, list, node->left, &left, &left_count);
+            if (status != FILTER_OK) {
+                return status;
+            }
+            status = filter_candidates(query, index, list, node->right, &right, &right_count);
+            if (status != FILTER_OK) {
+                free(left);
+                return status;
+            }
+            merged = malloc((left_count + right_count + 1) * sizeof(uint32_t));
+            if (merged == NULL) {
+                free(left);
+                free(right);
+                return FILTER_NO_MEMORY;
+            }
+            /* Trộn hai danh sách tăng dần, bỏ phần tử trùng */
+            i = 0;
+            j = 0;
+            while (i < left_count || j < right_count) {
+                if (j >= right_count || (i < left_count && left[i] < right[j])) {
+                    merged[n++] = left[i++];
+                } else if (i >= left_count || right[j] < left[i]) {
+                    merged[n++] = right[j++];
+                } else {
+                    merged[n++] = left[i++];
+                    j++;
+                }
+            }
+            free(left);
+            free(right);
+            *out = merged;
+            break;
+        default:
+            return FILTER_ERROR;
+    }
+
+    *count = n;
+    return FILTER_OK;
+}
+
+/**
+ * \brief           Lọc một phân đoạn khi quét song song
+ * \param[in,out]   ctx: Con trỏ tới \ref filter_scan_ctx_t
+ * \param[in]       worker: Chỉ số worker
+ * \param[in]       chunk: Chỉ số phân đoạn
+ */
+static void
+filter_scan_chunk(void* ctx, uint32_t worker, uint32_t chunk) {
+    filter_scan_ctx_t* scan;
+    uint32_t* out;
+    size_t begin;
+    size_t end;
+    size_t i;
+    uint32_t found;
+
+    (void)worker;
+    scan = ctx;
+    begin = (size_t)chunk * SCAN_CHUNK_ITEMS;
+    end = begin + SCAN_CHUNK_ITEMS;
+    if (end > scan->list->count) {
+        end = scan->list->count;
+    }
+
+    /* Số kết quả không vượt quá số sách của phân đoạn nên dùng chung dải vị trí */
+    out = &scan->index->matches[begin];
+    found = 0;
+    for (i = begin; i < end; i++) {
+        if (filter_eval(scan->query, scan->query->root, &scan->list->books[i])) {
+            out[found++] = (uint32_t)i;
+        }
+    }
+    scan->index->chunk_counts[chunk] = found;
+}
+
+/**
+ * \brief           So sánh chuỗi không phân biệt hoa thường
+ * \param[in]       a: Chuỗi thứ nhất
+ * \param[in]       b: Chuỗi thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+filter_compare_text(const char* a, const char* b) {
+    while (*a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return tolower((unsigned char)*a) - tolower((unsigned char)*b);
+}
+
+/**
+ * \brief           So sánh hai sách theo tiêu đề rồi theo ID (qsort)
+ * \param[in]       a: Con trỏ tới con trỏ sách thứ nhất
+ * \param[in]       b: Con trỏ tới con trỏ sách thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+filter_compare_titles(const void* a, const void* b) {
+    const book_t* x;
+    const book_t* y;
+    int result;
+
+    x = *(const book_t* const*)a;
+    y = *(const book_t* const*)b;
+    result = filter_compare_text(x->title, y->title);
+    return (result != 0) ? result : (x->book_id > y->book_id) - (x->book_id < y->book_id);
+}
+
+/**
+ * \brief           So sánh hai sách theo tác giả rồi theo ID (qsort)
+ * \param[in]       a: Con trỏ tới con trỏ sách thứ nhất
+ * \param[in]       b: Con trỏ tới con trỏ sách thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+filter_compare_authors(const void* a, const void* b) {
+    const book_t* x;
+    const book_t* y;
+    int result;
+
+    x = *(const book_t* const*)a;
+    y = *(const book_t* const*)b;
+    result = filter_compare_text(x->author, y->author);
+    return (result != 0) ? result : (x->book_id > y->book_id) - (x->book_id < y->book_id);
+}
+
+/**
+ * \brief           Sắp các vị trí khớp theo ORDER BY
+ * \param[in]       query: Truy vấn
+ * \param[in,out]   index: Chỉ mục (giữ vùng kết quả)
+ * \param[in]       list: Danh sách sách
+ * \param[in]       count: Số kết quả
+ */
+static void
+filter_sort(const filter_query_t* query, filter_index_t* index, const book_list_t* list, size_t count) {
+    const book_t** books;
+    uint32_t swap;
+    size_t i;
+
+    if (query->order == FILTER_ORDER_ID) {
+        /* Khóa (ID << 32 | vị trí) như scan_books_match */
+        for (i = 0; i < count; i++) {
+            index->sort_keys[i] = ((uint64_t)list->books[index->matches[i]].book_id << 32) | index->matches[i];
+        }
+        qsort(index->sort_keys, count, sizeof(index->sort_keys[0]), filter_compare_u64);
+        for (i = 0; i < count; i++) {
+            index->matches[i] = (uint32_t)index->sort_keys[i];
+        }
+    } else {
+        /* Vùng sort_keys đủ chỗ cho một con trỏ mỗi kết quả */
+        books = (const book_t**)(void*)index->sort_keys;
+        for (i = 0; i < count; i++) {
+            books[i] = &list->books[index->matches[i]];
+        }
+        qsort(books, count, sizeof(books[0]),
+              (query->order == FILTER_ORDER_TITLE) ? filter_compare_titles : filter_compare_authors);
+        for (i = 0; i < count; i++) {
+            index->matches[i] = (uint32_t)(books[i] - list->books);
+        }
+    }
+
+    if (query->descending) {
+        for (i = 0; i < count / 2; i++) {
+            swap = index->matches[i];
+            index->matches[i] = index->matches[count - 1 - i];
+            index->matches[count - 1 - i] = swap;
+        }
+    }
+}
+
+/**
+ * \brief           Chạy truy vấn theo kế hoạch của \ref filter_plan
+ * \param[in,out]   query: Truy vấn đã lập kế hoạch (nhận số liệu thực tế)
+ * \param[in,out]   index: Chỉ mục
+ * \param[in]       list: Danh sách sách (không đổi kể từ \ref filter_plan)
+ * \param[out]      result: Kết quả
+ * \return          \ref FILTER_OK nếu thành công, \ref filter_status_t nếu lỗi
+ */
+filter_status_t
+filter_execute(filter_query_t* query, filter_index_t* index, const book_list_t* list, filter_result_t* result) {
+    filter_scan_ctx_t ctx;
+    filter_status_t status;
+    uint32_t* candidates;
+    uint64_t started;
+    size_t candidate_count;
+    size_t count;
+    size_t found;
+    size_t i;
+    uint32_t chunk_count;
+    uint32_t chunk;
+    uint32_t position;
+    uint8_t rebuilt;
+
+    if (query == NULL || index == NULL || list == NULL || result == NULL || query->root == FILTER_NIL) {
+        return FILTER_INVALID_INPUT;
+    }
+
+    /* Vị trí trong chỉ mục phải khớp danh sách hiện tại */
+    status = filter_index_refresh(index, list, &rebuilt);
+    if (status != FILTER_OK) {
+        return status;
+    }
+    query->rebuilt |= rebuilt;
+
+    started = filter_clock_ns();
+    count = 0;
+    query->examined = 0;
+    switch (query->access) {
+        case FILTER_ACCESS_PARALLEL_SCAN:
+            ctx.query = query;
+            ctx.list = list;
+            ctx.index = index;
+            chunk_count = (uint32_t)((list->count + SCAN_CHUNK_ITEMS - 1) / SCAN_CHUNK_ITEMS);
+            scan_pool_run(index->scan, chunk_count, filter_scan_chunk, &ctx);
+
+            /* Nối kết quả các phân đoạn về đầu mảng */
+            for (chunk = 0; chunk < chunk_count; chunk++) {
+                found = index->chunk_counts[chunk];
+                if (found > 0 && count != (size_t)chunk * SCAN_CHUNK_ITEMS) {
+                    memmove(&index->matches[count], &index->matches[(size_t)chunk * SCAN_CHUNK_ITEMS],
+                            found * sizeof(index->matches[0]));
+                }
+                count += found;
+            }
+            query->examined = list->count;
+            break;
+        case FILTER_ACCESS_ID_ORDER:
+            /* Đã theo thứ tự ID nên dừng ngay khi đủ LIMIT */
+            for (i = 0; i < index->count && count < query->limit; i++) {
+                position = index->ids[query->descending ? index->count - 1 - i : i].position;
+                if (filter_eval(query, query->root, &list->books[position])) {
+                    index->matches[count++] = position;
+                }
+            }
+            query->examined = i;
+            break;
+        case FILTER_ACCESS_INDEX:
+            status = filter_candidates(query, index, list, query->root, &candidates, &candidate_count);
+            if (status != FILTER_OK) {
+                return status;
+            }
+            for (i = 0; i < candidate_count; i++) {
+                if (filter_eval(query, query->root, &list->books[candidates[i]])) {
+                    index->matches[count++] = candidates[i];
+                }
+            }
+            free(candidates);
+            query->examined = candidate_count;
+            break;
+        default:
+            for (i = 0; i < list->count; i++) {
+                if (filter_eval(query, query->root, &list->books[i])) {
+                    index->matches[count++] = (uint32_t)i;
+                }
+            }
+            query->examined = list->count;
+            break;
+    }
+
+    if (query->access != FILTER_ACCESS_ID_ORDER) {
+        filter_sort(query, index, list, count);
+    }
+    query->matched = count;
+    query->elapsed_ns = filter_clock_ns() - started;
+
+    result->positions = index->matches;
+    result->total = count;
+    result->count = (count < query->limit) ? count : query->limit;
+    return FILTER_OK;
+}
+
+/**
+ * \brief           Ghi thêm vào vùng đệm EXPLAIN (cắt bớt khi đầy)
+ * \param[in,out]   buffer: Vùng đệm
+ * \param[in]       size: Kích thước vùng đệm
+ * \param[in,out]   used: Số byte đã ghi
+ * \param[in]       format: Chuỗi định dạng printf
+ */
+static void
+filter_append(char* buffer, size_t size, size_t* used, const char* format, ...) {
+    va_list args;
+    int written;
+
+    if (*used + 1 >= size) {
+        return;
+    }
+
+    va_start(args, format);
+    written = vsnprintf(&buffer[*used], size - *used, format, args);
+    va_end(args);
+    if (written > 0) {
+        *used += ((size_t)written < size - *used) ? (size_t)written : size - *used - 1;
+    }
+}
+
+/**
+ * \brief           Mô tả một cách truy cập
+ * \param[in]       access: \ref filter_access_t
+ * \return          Chuỗi mô tả
+ */
+static const char*
+filter_access_name(uint8_t access) {
+    switch (access) {
+        case FILTER_ACCESS_SCAN:
+            return "quét tuần tự";
+        case FILTER_ACCESS_PARALLEL_SCAN:
+            return "quét song song";
+        case FILTER_ACCESS_ID_ORDER:
+            return "duyệt chỉ mục ID theo thứ tự";
+        case FILTER_ACCESS_ID_RANGE:
+            return "chỉ mục ID";
+        case FILTER_ACCESS_TRIGRAM:
+            return "chỉ mục trigram";
+        case FILTER_ACCESS_AVAILABLE:
+            return "tập sách có sẵn";
+        case FILTER_ACCESS_DRIVER:
+            return "ứng viên từ nút con đầu";
+        case FILTER_ACCESS_UNION:
+            return "hợp ứng viên";
+        case FILTER_ACCESS_INDEX:
+            return "qua chỉ mục";
+        default:
+            return "không dùng chỉ mục";
+    }
+}
+
+/**
+ * \brief           Ghi cây kế hoạch của một nút
+ * \param[in]       query: Truy vấn
+ * \param[in]       id: Chỉ số nút
+ * \param[in]       depth: Độ sâu (thụt lề)
+ * \param[in,out]   buffer: Vùng đệm
+ * \param[in]       size: Kích thước vùng đệm
+ * \param[in,out]   used: Số byte đã ghi
+ */
+static void
+filter_explain_node(const filter_query_t* query, uint16_t id, size_t depth, char* buffer, size_t size,
+                    size_t* used) {
+    const filter_node_t* node;
+    const char* field;
+
+    node = &query->nodes[id];
+    field = (node->field == QUERY_FIELD_TITLE) ? "title" : "author";
+    filter_append(buffer, size, used, "%*s-> ", (int)(depth * 3), "");
+    switch (node->kind) {
+        case FILTER_NODE_ALL:
+            filter_append(buffer, size, used, "mọi sách");
+            break;
+        case FILTER_NODE_CONTAINS:
+        case FILTER_NODE_EQUALS:
+            filter_append(buffer, size, used, "%s %s \"%s\"", field,
+                          (node->kind == FILTER_NODE_CONTAINS) ? "CONTAINS" : "=", &query->text[node->text]);
+            break;
+        case FILTER_NODE_AVAILABLE:
+            filter_append(buffer, size, used, "available");
+            break;
+        case FILTER_NODE_ID_RANGE:
+            filter_append(buffer, size, used, "id BETWEEN %u AND %u", node->low, node->high);
+            break;
+        case FILTER_NODE_AND:
+            filter_append(buffer, size, used, "AND");
+            break;
+        case FILTER_NODE_OR:
+            filter_append(buffer, size, used, "OR");
+            break;
+        default:
+            filter_append(buffer, size, used, "NOT");
+            break;
+    }
+
+    filter_append(buffer, size, used, "  ~%.0f sách  [%s", node->rows, filter_access_name(node->access));
+    if (node->access == FILTER_ACCESS_TRIGRAM) {
+        filter_append(buffer, size, used, ", %u danh sách", node->grams);
+    } else if (node->kind == FILTER_NODE_CONTAINS || node->kind == FILTER_NODE_EQUALS) {
+        filter_append(buffer, size, used, ": chuỗi ngắn hơn 3 byte");
+    }
+    if (node->cost >= 0.0) {
+        filter_append(buffer, size, used, ", ~%.0f ứng viên, chi phí %.1f", node->candidates, node->cost);
+    }
+    filter_append(buffer, size, used, "]\n");
+
+    if (node->kind == FILTER_NODE_AND || node->kind == FILTER_NODE_OR || node->kind == FILTER_NODE_NOT) {
+        filter_explain_node(query, node->left, depth + 1, buffer, size, used);
+    }
+    if (node->kind == FILTER_NODE_AND || node->kind == FILTER_NODE_OR) {
+        filter_explain_node(query, node->right, depth + 1, buffer, size, used);
+    }
+}
+
+/**
+ * \brief           Mô tả kế hoạch đã chọn, các phương án bị loại và số liệu lần chạy gần nhất
+ * \param[in]       query: Truy vấn đã lập kế hoạch
+ * \param[out]      buffer: Vùng đệm (\ref FILTER_EXPLAIN_LENGTH là đủ)
+ * \param[in]       size: Kích thước vùng đệm
+ * \return          Số byte đã ghi (không tính '\0')
+ */
+size_t
+filter_explain(const filter_query_t* query, char* buffer, size_t size) {
+    static const char* const orders[] = {"id", "title", "author"};
+    size_t used;
+
+    if (query == NULL || buffer == NULL || size == 0 || query->root == FILTER_NIL) {
+        return 0;
+    }
+
+    used = 0;
+    buffer[0] = '\0';
+    filter_append(buffer, size, &used, "Kế hoạch: %s, ~%.0f/%zu sách, chi phí %.1f\n",
+                  filter_access_name(query->access), query->rows, query->books, query->cost);
+    filter_append(buffer, size, &used, "Phương án: quét %.1f | chỉ mục ", query->scan_cost);
+    if (query->index_cost >= 0.0) {
+        filter_append(buffer, size, &used, "%.1f", query->index_cost);
+    } else {
+        filter_append(buffer, size, &used, "-");
+    }
+    filter_append(buffer, size, &used, " | theo ID ");
+    if (query->order_cost >= 0.0) {
+        filter_append(buffer, size, &used, "%.1f\n", query->order_cost);
+    } else {
+        filter_append(buffer, size, &used, "-\n");
+    }
+    filter_explain_node(query, query->root, 0, buffer, size, &used);
+    filter_append(buffer, size, &used, "Sắp xếp: ORDER BY %s %s", orders[query->order],
+                  query->descending ? "DESC" : "ASC");
+    if (query->limit != FILTER_NO_LIMIT) {
+        filter_append(buffer, size, &used, " LIMIT %zu", query->limit);
+    }
+    filter_append(buffer, size, &used, "\n");
+    if (query->rebuilt != 0) {
+        filter_append(buffer, size, &used, "Dựng lại:%s%s\n", (query->rebuilt & 1) ? " chỉ mục ID/trigram" : "",
+                      (query->rebuilt & 2) ? " tập sách có sẵn" : "");
+    }
+    filter_append(buffer, size, &used, "Thực tế: kiểm tra %zu sách, khớp %zu, %.1f us\n", query->examined,
+                  query->matched, (double)query->elapsed_ns / 1000.0);
+
+    return used;
+}
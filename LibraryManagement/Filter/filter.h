@@ -0,0 +1,223 @@
+/**
+ * \file            filter.h
+ * \brief           Khai báo ngôn ngữ biểu thức lọc sách và bộ lập kế hoạch truy vấn
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef FILTER_HDR_H
+#define FILTER_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../Book/book.h"
+#include "../Scan/scan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define FILTER_MAX_NODES            32          /*!< Số nút tối đa của một biểu thức */
+#define FILTER_TEXT_LENGTH          512         /*!< Tổng độ dài các chuỗi trong một biểu thức */
+#define FILTER_GRAM_BITS            16
+#define FILTER_GRAM_BUCKETS         (1U << FILTER_GRAM_BITS) /*!< Số bucket của chỉ mục trigram */
+#define FILTER_MAX_GRAMS            16          /*!< Số trigram tối đa giao nhau cho một chuỗi (các trigram còn lại kiểm tra khi lọc) */
+#define FILTER_NIL                  UINT16_MAX  /*!< Không có nút */
+#define FILTER_NO_LIMIT             SIZE_MAX    /*!< Không có LIMIT */
+#define FILTER_EXPLAIN_LENGTH       4096        /*!< Kích thước vùng đệm đủ cho EXPLAIN của mọi biểu thức */
+
+/* Chi phí ước lượng, tính theo đơn vị "đánh giá biểu thức trên một sách khi quét tuần tự" */
+#define FILTER_COST_ROW             1.0         /*!< Đánh giá một sách khi quét */
+#define FILTER_COST_FETCH           1.5         /*!< Đọc ngẫu nhiên và kiểm tra một ứng viên */
+#define FILTER_COST_POSTING         0.05        /*!< Đọc một phần tử danh sách chỉ mục */
+#define FILTER_COST_REBUILD         0.25        /*!< Đọc trạng thái mượn của một sách khi dựng lại tập có sẵn */
+#define FILTER_COST_PARALLEL        200.0       /*!< Đánh thức và chờ các luồng quét */
+#define FILTER_TEXT_SELECTIVITY     0.25        /*!< Tỷ lệ khớp giả định của chuỗi quá ngắn để dùng trigram */
+
+/**
+ * \brief           Trạng thái trả về của các hàm lọc
+ */
+typedef enum {
+    FILTER_OK = 0,                              /*!< Thành công */
+    FILTER_ERROR,                               /*!< Lỗi chung */
+    FILTER_INVALID_INPUT,                       /*!< Dữ liệu đầu vào không hợp lệ */
+    FILTER_SYNTAX_ERROR,                        /*!< Biểu thức sai cú pháp */
+    FILTER_TOO_COMPLEX,                         /*!< Biểu thức vượt \ref FILTER_MAX_NODES hoặc \ref FILTER_TEXT_LENGTH */
+    FILTER_NO_MEMORY,                           /*!< Không cấp phát được bộ nhớ cho chỉ mục */
+} filter_status_t;
+
+/**
+ * \brief           Loại nút của biểu thức
+ */
+typedef enum {
+    FILTER_NODE_ALL = 0,                        /*!< Mọi sách (biểu thức rỗng) */
+    FILTER_NODE_CONTAINS,                       /*!< Trường chứa chuỗi (không phân biệt hoa thường) */
+    FILTER_NODE_EQUALS,                         /*!< Trường bằng chuỗi (không phân biệt hoa thường) */
+    FILTER_NODE_AVAILABLE,                      /*!< Còn ít nhất một bản có sẵn */
+    FILTER_NODE_ID_RANGE,                       /*!< ID nằm trong [low, high] */
+    FILTER_NODE_AND,                            /*!< Cả hai nút con đúng */
+    FILTER_NODE_OR,                             /*!< Một trong hai nút con đúng */
+    FILTER_NODE_NOT,                            /*!< Nút con sai */
+} filter_node_kind_t;
+
+/**
+ * \brief           Cách lấy sách của một nút hoặc của cả truy vấn
+ */
+typedef enum {
+    FILTER_ACCESS_NONE = 0,                     /*!< Nút không dùng được chỉ mục */
+    FILTER_ACCESS_SCAN,                         /*!< Quét tuần tự toàn bộ danh sách */
+    FILTER_ACCESS_PARALLEL_SCAN,                /*!< Quét song song bằng pool quét */
+    FILTER_ACCESS_ID_ORDER,                     /*!< Duyệt chỉ mục ID theo thứ tự, dừng khi đủ LIMIT */
+    FILTER_ACCESS_ID_RANGE,                     /*!< Tìm nhị phân trên chỉ mục ID */
+    FILTER_ACCESS_TRIGRAM,                      /*!< Giao các danh sách trigram */
+    FILTER_ACCESS_AVAILABLE,                    /*!< Tập sách có sẵn */
+    FILTER_ACCESS_DRIVER,                       /*!< AND: lấy ứng viên từ nút con rẻ hơn */
+    FILTER_ACCESS_UNION,                        /*!< OR: hợp ứng viên của hai nút con */
+    FILTER_ACCESS_INDEX,                        /*!< Truy vấn: lấy ứng viên qua chỉ mục rồi kiểm tra */
+} filter_access_t;
+
+/**
+ * \brief           Thứ tự kết quả
+ */
+typedef enum {
+    FILTER_ORDER_ID = 0,                        /*!< Theo ID (mặc định) */
+    FILTER_ORDER_TITLE,                         /*!< Theo tiêu đề */
+    FILTER_ORDER_AUTHOR,                        /*!< Theo tác giả */
+} filter_order_t;
+
+/**
+ * \brief           Một nút của biểu thức kèm ước lượng của bộ lập kế hoạch
+ */
+typedef struct {
+    uint8_t kind;                               /*!< \ref filter_node_kind_t */
+    uint8_t field;                              /*!< \ref query_field_t của nút chuỗi */
+    uint8_t access;                             /*!< \ref filter_access_t được chọn */
+    uint16_t left;                              /*!< Nút con trái (nút con duy nhất của NOT) */
+    uint16_t right;                             /*!< Nút con phải */
+    uint16_t text;                              /*!< Vị trí chuỗi (đã chuyển chữ thường) trong \ref filter_query_t::text */
+    uint16_t text_length;                       /*!< Độ dài chuỗi */
+    uint32_t low;                               /*!< Cận dưới ID */
+    uint32_t high;                              /*!< Cận trên ID */
+    uint32_t grams;                             /*!< Số trigram dùng để lấy ứng viên */
+    double rows;                                /*!< Ước lượng số sách khớp */
+    double candidates;                          /*!< Ước lượng số ứng viên lấy qua chỉ mục */
+    double cost;                                /*!< Chi phí lấy ứng viên qua chỉ mục (âm = không dùng được) */
+} filter_node_t;
+
+/**
+ * \brief           Một truy vấn đã phân tích, kế hoạch và số liệu thực tế của lần chạy gần nhất
+ */
+typedef struct {
+    filter_node_t nodes[FILTER_MAX_NODES];      /*!< Các nút */
+    uint16_t node_count;                        /*!< Số nút */
+    uint16_t root;                              /*!< Nút gốc */
+    char text[FILTER_TEXT_LENGTH];              /*!< Các chuỗi của biểu thức, mỗi chuỗi kết thúc bằng '\0' */
+    size_t text_used;                           /*!< Số byte đã dùng trong \ref text */
+    uint8_t order;                              /*!< \ref filter_order_t */
+    uint8_t descending;                         /*!< 1 nếu ORDER BY ... DESC */
+    uint8_t explain;                            /*!< 1 nếu biểu thức bắt đầu bằng EXPLAIN */
+    size_t limit;                               /*!< Số kết quả tối đa (\ref FILTER_NO_LIMIT = không giới hạn) */
+    uint8_t access;                             /*!< \ref filter_access_t của cả truy vấn */
+    size_t books;                               /*!< Số sách khi lập kế hoạch */
+    double rows;                                /*!< Ước lượng số sách khớp */
+    double cost;                                /*!< Chi phí của kế hoạch được chọn */
+    double scan_cost;                           /*!< Chi phí quét (tuần tự hoặc song song) */
+    double index_cost;                          /*!< Chi phí qua chỉ mục (âm = không dùng được) */
+    double order_cost;                          /*!< Chi phí duyệt theo chỉ mục ID (âm = không dùng được) */
+    uint8_t rebuilt;                            /*!< Bit 0: dựng lại chỉ mục nội dung, bit 1: dựng lại tập có sẵn */
+    size_t examined;                            /*!< Số sách đã kiểm tra ở lần chạy gần nhất */
+    size_t matched;                             /*!< Số sách khớp ở lần chạy gần nhất */
+    uint64_t elapsed_ns;                        /*!< Thời gian chạy gần nhất */
+} filter_query_t;
+
+/**
+ * \brief           Một phần tử chỉ mục ID
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách */
+    uint32_t position;                          /*!< Vị trí trong danh sách */
+} filter_id_entry_t;
+
+/**
+ * \brief           Chỉ mục phụ cho bộ lập kế hoạch, dựng lại khi danh sách đổi
+ *
+ * Chỉ mục ID và trigram chỉ phụ thuộc ID, vị trí và chuỗi của sách nên được
+ * giữ qua các lượt mượn/trả (\ref book_list_t::catalog_generation); tập sách
+ * có sẵn dựng lại sau mỗi thay đổi (\ref book_list_t::generation). Danh sách
+ * trigram lưu liên tiếp: bucket b chiếm postings[offsets[b]..offsets[b + 1]).
+ */
+typedef struct {
+    const book_list_t* list;                    /*!< Danh sách đã dựng chỉ mục */
+    uint64_t catalog_generation;                /*!< catalog_generation khi dựng chỉ mục nội dung */
+    uint64_t generation;                        /*!< generation khi dựng tập có sẵn */
+    uint8_t built;                              /*!< Bit 0: chỉ mục nội dung hợp lệ, bit 1: tập có sẵn hợp lệ */
+    size_t count;                               /*!< Số sách khi dựng */
+    size_t capacity;                            /*!< Số sách tối đa của các mảng theo sách */
+    filter_id_entry_t* ids;                     /*!< Chỉ mục ID, sắp theo ID */
+    uint32_t* offsets;                          /*!< Đầu danh sách của từng bucket trigram (\ref FILTER_GRAM_BUCKETS + 1) */
+    uint32_t* cursors;                          /*!< Vùng làm việc khi dựng trigram */
+    uint32_t* postings;                         /*!< Vị trí sách của mọi bucket, tăng dần trong từng bucket */
+    size_t posting_capacity;                    /*!< Số phần tử cấp phát cho postings */
+    uint64_t* available;                        /*!< Bitmap vị trí sách còn bản có sẵn */
+    size_t available_count;                     /*!< Số sách còn bản có sẵn */
+    uint32_t* matches;                          /*!< Kết quả của lần chạy gần nhất */
+    uint64_t* sort_keys;                        /*!< Vùng đệm sắp xếp */
+    uint32_t chunk_counts[SCAN_MAX_CHUNKS];     /*!< Số kết quả từng phân đoạn khi quét song song */
+    scan_pool_t* scan;                          /*!< Pool quét song song (NULL = chỉ quét tuần tự) */
+    uint64_t builds;                            /*!< Số lần dựng chỉ mục nội dung */
+} filter_index_t;
+
+/**
+ * \brief           Kết quả lọc; con trỏ trỏ vào chỉ mục và hợp lệ tới lần chạy kế tiếp
+ */
+typedef struct {
+    const uint32_t* positions;                  /*!< Vị trí các sách khớp theo thứ tự ORDER BY */
+    size_t count;                               /*!< Số vị trí (đã áp dụng LIMIT) */
+    size_t total;                               /*!< Số sách khớp (= count khi dừng sớm theo chỉ mục ID) */
+} filter_result_t;
+
+/* Khai báo các hàm chỉ mục */
+void            filter_index_init(filter_index_t* index, scan_pool_t* scan);
+void            filter_index_destroy(filter_index_t* index);
+filter_status_t filter_index_refresh(filter_index_t* index, const book_list_t* list, uint8_t* rebuilt);
+
+/* Khai báo các hàm biểu thức lọc */
+filter_status_t filter_parse(const char* input, filter_query_t* query, size_t* error_offset);
+uint8_t         filter_matches(const filter_query_t* query, const book_t* book);
+filter_status_t filter_plan(filter_query_t* query, filter_index_t* index, const book_list_t* list);
+filter_status_t filter_execute(filter_query_t* query, filter_index_t* index, const book_list_t* list,
+                               filter_result_t* result);
+size_t          filter_explain(const filter_query_t* query, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_HDR_H */
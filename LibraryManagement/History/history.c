@@ -0,0 +1,521 @@
+/**
+ * \file            history.c
+ * \brief           Triển khai lịch sử mượn/trả, tổng hợp theo thời gian và top-K sách phổ biến
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <string.h>
+#include <time.h>
+#include "history.h"
+#include "../Book/book.h"
+
+/* Hằng số nội bộ */
+#define HISTORY_COUNT_SLOTS         (HISTORY_CAPACITY * 2)  /*!< Số ô bảng đếm khi tổng hợp top-K theo khoảng */
+
+/* Hệ số nhân (lẻ) của hàm băm multiply-shift cho từng hàng sketch */
+static const uint32_t history_seeds[HISTORY_SKETCH_DEPTH] = {
+    0x9E3779B1U, 0x85EBCA77U, 0xC2B2AE3DU, 0x27D4EB2FU,
+};
+
+/*
+ * Bảng đếm dùng khi tổng hợp theo khoảng thời gian. Mỗi ô mang tem của lần
+ * truy vấn đã ghi nó nên không cần xóa bảng giữa hai truy vấn; vì vậy
+ * \ref history_range_top không được gọi đồng thời.
+ */
+static history_rank_t history_counts[HISTORY_COUNT_SLOTS];
+static uint32_t history_count_stamps[HISTORY_COUNT_SLOTS];
+static uint32_t history_touched[HISTORY_CAPACITY];
+static uint32_t history_stamp;
+
+/**
+ * \brief           So sánh hai phần tử heap
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          1 nếu \p a kém phổ biến hơn \p b (cùng số lượt thì ID lớn hơn kém hơn)
+ */
+static uint8_t
+history_rank_less(const history_rank_t* a, const history_rank_t* b) {
+    return a->count < b->count || (a->count == b->count && a->book_id > b->book_id);
+}
+
+/**
+ * \brief           Đẩy phần tử lên trong min-heap
+ * \param[in,out]   heap: Heap
+ * \param[in]       pos: Vị trí phần tử
+ */
+static void
+history_sift_up(history_rank_t* heap, size_t pos) {
+    history_rank_t item;
+    size_t parent;
+
+    item = heap[pos];
+    while (pos > 0) {
+        parent = (pos - 1) / 2;
+        if (!history_rank_less(&item, &heap[parent])) {
+            break;
+        }
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = item;
+}
+
+/**
+ * \brief           Đẩy phần tử xuống trong min-heap
+ * \param[in,out]   heap: Heap
+ * \param[in]       count: Số phần tử
+ * \param[in]       pos: Vị trí phần tử
+ */
+static void
+history_sift_down(history_rank_t* heap, size_t count, size_t pos) {
+    history_rank_t item;
+    size_t child;
+
+    item = heap[pos];
+    while ((child = 2 * pos + 1) < count) {
+        if (child + 1 < count && history_rank_less(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!history_rank_less(&heap[child], &item)) {
+            break;
+        }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = item;
+}
+
+/**
+ * \brief           Đưa một sách vào heap top-K nếu nó phổ biến hơn phần tử kém nhất
+ * \param[in,out]   heap: Heap
+ * \param[in,out]   count: Số phần tử
+ * \param[in]       capacity: Số phần tử tối đa
+ * \param[in]       rank: Sách và số lượt mượn (sách chưa có trong heap)
+ */
+static void
+history_heap_offer(history_rank_t* heap, size_t* count, size_t capacity, const history_rank_t* rank) {
+    if (*count < capacity) {
+        heap[*count] = *rank;
+        history_sift_up(heap, (*count)++);
+    } else if (capacity > 0 && history_rank_less(&heap[0], rank)) {
+        heap[0] = *rank;
+        history_sift_down(heap, *count, 0);
+    }
+}
+
+/**
+ * \brief           Sắp xếp giảm dần theo số lượt mượn (sắp xếp chèn, danh sách ngắn)
+ * \param[in,out]   ranks: Danh sách
+ * \param[in]       count: Số phần tử
+ */
+static void
+history_sort_ranks(history_rank_t* ranks, size_t count) {
+    history_rank_t item;
+    size_t i;
+    size_t j;
+
+    for (i = 1; i < count; i++) {
+        item = ranks[i];
+        for (j = i; j > 0 && history_rank_less(&ranks[j - 1], &item); j--) {
+            ranks[j] = ranks[j - 1];
+        }
+        ranks[j] = item;
+    }
+}
+
+/**
+ * \brief           Ô của sách trong một hàng sketch
+ * \param[in]       book_id: ID sách
+ * \param[in]       row: Hàng
+ * \return          Chỉ số ô
+ */
+static uint32_t
+history_sketch_slot(uint32_t book_id, size_t row) {
+    return (uint32_t)((book_id + 1) * history_seeds[row]) >> (32 - HISTORY_SKETCH_BITS);
+}
+
+/**
+ * \brief           Cập nhật sketch và heap top-K sau một lượt mượn
+ *
+ * Sketch dùng cập nhật bảo thủ: chỉ nâng các bộ đếm đang nhỏ hơn ước lượng
+ * mới, giảm sai số do va chạm băm.
+ *
+ * \param[in,out]   history: Lịch sử
+ * \param[in]       book_id: ID sách vừa được mượn
+ */
+static void
+history_track(history_t* history, uint32_t book_id) {
+    history_rank_t rank;
+    uint32_t* counter;
+    size_t row;
+    size_t i;
+
+    rank.book_id = book_id;
+    rank.count = history_estimate(history, book_id) + 1;
+    for (row = 0; row < HISTORY_SKETCH_DEPTH; row++) {
+        counter = &history->sketch[row][history_sketch_slot(book_id, row)];
+        if (*counter < rank.count) {
+            *counter = rank.count;
+        }
+    }
+
+    /* Sách đã có trong heap: số lượt chỉ tăng nên đẩy xuống */
+    for (i = 0; i < history->top_count; i++) {
+        if (history->top[i].book_id == book_id) {
+            history->top[i].count = rank.count;
+            history_sift_down(history->top, history->top_count, i);
+            return;
+        }
+    }
+    history_heap_offer(history->top, &history->top_count, HISTORY_TOP_K, &rank);
+}
+
+/**
+ * \brief           Bỏ sự kiện cũ nhất khỏi phân vùng cũ nhất
+ * \param[in,out]   history: Lịch sử
+ */
+static void
+history_drop_event(history_t* history) {
+    history_partition_t* partition;
+    const history_event_t* event;
+
+    partition = &history->partitions[history->partition_tail & (HISTORY_MAX_PARTITIONS - 1)];
+    event = &history->events[history->tail & (HISTORY_CAPACITY - 1)];
+    if (event->type == HISTORY_LOAN) {
+        partition->loans--;
+    } else {
+        partition->returns--;
+    }
+    partition->first++;
+    partition->count--;
+    history->tail++;
+    if (partition->count == 0) {
+        history->partition_tail++;
+    }
+}
+
+/**
+ * \brief           Khởi tạo lịch sử rỗng
+ * \param[out]      history: Lịch sử
+ */
+void
+history_init(history_t* history) {
+    if (history == NULL) {
+        return;
+    }
+    memset(history, 0, sizeof(*history));
+}
+
+/**
+ * \brief           Ghi thêm một sự kiện với thời điểm cho trước
+ *
+ * Sự kiện mở phân vùng mới khi thuộc khung thời gian sau khung hiện tại; nếu
+ * đồng hồ lùi, sự kiện vẫn nằm trong phân vùng hiện tại và hạ \ref min_time.
+ *
+ * \param[in,out]   history: Lịch sử (NULL = bỏ qua)
+ * \param[in]       type: Loại sự kiện
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       item_key: Khóa item của bản sao
+ * \param[in]       time: Thời điểm (giây kể từ epoch)
+ */
+void
+history_append(history_t* history, history_type_t type, uint32_t user_id,
+               uint32_t item_key, uint32_t time) {
+    history_partition_t* partition;
+    history_event_t* event;
+    uint32_t bucket;
+
+    if (history == NULL || (type != HISTORY_LOAN && type != HISTORY_RETURN)) {
+        return;
+    }
+
+    if (history->head - history->tail == HISTORY_CAPACITY) {
+        history_drop_event(history);
+    }
+
+    /* Mở phân vùng mới khi sang khung thời gian kế tiếp */
+    bucket = time / HISTORY_PARTITION_SECONDS;
+    partition = &history->partitions[(history->partition_head - 1) & (HISTORY_MAX_PARTITIONS - 1)];
+    if (history->partition_head == history->partition_tail || bucket > partition->bucket) {
+        if (history->partition_head - history->partition_tail == HISTORY_MAX_PARTITIONS) {
+            partition = &history->partitions[history->partition_tail & (HISTORY_MAX_PARTITIONS - 1)];
+            history->tail = partition->first + partition->count;
+            history->partition_tail++;
+        }
+        partition = &history->partitions[history->partition_head & (HISTORY_MAX_PARTITIONS - 1)];
+        memset(partition, 0, sizeof(*partition));
+        partition->bucket = bucket;
+        partition->min_time = time;
+        partition->max_time = time;
+        partition->first = history->head;
+        history->partition_head++;
+    }
+
+    if (time < partition->min_time) {
+        partition->min_time = time;
+    }
+    if (time > partition->max_time) {
+        partition->max_time = time;
+    }
+    partition->count++;
+    if (type == HISTORY_LOAN) {
+        partition->loans++;
+    } else {
+        partition->returns++;
+    }
+
+    event = &history->events[history->head & (HISTORY_CAPACITY - 1)];
+    event->time = time;
+    event->user_id = user_id;
+    event->item_key = item_key;
+    event->type = (uint8_t)type;
+    history->head++;
+
+    if (type == HISTORY_LOAN) {
+        history_track(history, BOOK_ITEM_BOOK_ID(item_key));
+    }
+}
+
+/**
+ * \brief           Ghi thêm một sự kiện tại thời điểm hiện tại
+ * \param[in,out]   history: Lịch sử (NULL = bỏ qua)
+ * \param[in]       type: Loại sự kiện
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       item_key: Khóa item của bản sao
+ */
+void
+history_record(history_t* history, history_type_t type, uint32_t user_id, uint32_t item_key) {
+    if (history == NULL) {
+        return;
+    }
+    history_append(history, type, user_id, item_key, (uint32_t)time(NULL));
+}
+
+/**
+ * \brief           Số sự kiện đang được giữ
+ * \param[in]       history: Lịch sử
+ * \return          Số sự kiện
+ */
+size_t
+history_count(const history_t* history) {
+    return (history != NULL) ? (size_t)(history->head - history->tail) : 0;
+}
+
+/**
+ * \brief           Kiểm tra khoảng thời gian có bắt đầu trước dữ liệu còn giữ không
+ * \param[in]       history: Lịch sử
+ * \param[in]       from: Đầu khoảng
+ * \return          \ref HISTORY_TRUNCATED nếu đã có sự kiện bị bỏ mà có thể thuộc khoảng
+ */
+static history_status_t
+history_range_status(const history_t* history, uint32_t from) {
+    if (history->tail > 0 && from < history->events[history->tail & (HISTORY_CAPACITY - 1)].time) {
+        return HISTORY_TRUNCATED;
+    }
+    return HISTORY_OK;
+}
+
+/**
+ * \brief           Đếm lượt mượn và trả trong khoảng thời gian [from, to]
+ *
+ * Chỉ đọc các phân vùng giao với khoảng; phân vùng nằm trọn trong khoảng dùng
+ * tổng có sẵn, chỉ phân vùng ở hai đầu khoảng phải đọc từng sự kiện.
+ *
+ * \param[in]       history: Lịch sử
+ * \param[in]       from: Đầu khoảng (giây kể từ epoch)
+ * \param[in]       to: Cuối khoảng (bao gồm)
+ * \param[out]      stats: Kết quả
+ * \return          \ref HISTORY_OK hoặc \ref HISTORY_TRUNCATED nếu thành công, \ref history_status_t nếu lỗi
+ */
+history_status_t
+history_range_stats(const history_t* history, uint32_t from, uint32_t to, history_stats_t* stats) {
+    const history_partition_t* partition;
+    const history_event_t* event;
+    uint64_t p;
+    uint64_t seq;
+
+    if (history == NULL || stats == NULL || from > to) {
+        return HISTORY_INVALID_INPUT;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    for (p = history->partition_tail; p < history->partition_head; p++) {
+        partition = &history->partitions[p & (HISTORY_MAX_PARTITIONS - 1)];
+        if (partition->count == 0 || partition->max_time < from || partition->min_time > to) {
+            continue;
+        }
+        if (from <= partition->min_time && partition->max_time <= to) {
+            stats->loans += partition->loans;
+            stats->returns += partition->returns;
+            stats->partitions_summarized++;
+            continue;
+        }
+        for (seq = partition->first; seq < partition->first + partition->count; seq++) {
+            event = &history->events[seq & (HISTORY_CAPACITY - 1)];
+            if (event->time >= from && event->time <= to) {
+                if (event->type == HISTORY_LOAN) {
+                    stats->loans++;
+                } else {
+                    stats->returns++;
+                }
+            }
+        }
+        stats->partitions_scanned++;
+    }
+    return history_range_status(history, from);
+}
+
+/**
+ * \brief           Tìm các sách được mượn nhiều nhất trong khoảng thời gian [from, to]
+ *
+ * Kết quả chính xác: đếm mọi lượt mượn của các phân vùng giao với khoảng rồi
+ * chọn \p capacity sách nhiều nhất bằng min-heap. Hàm dùng bảng đếm tĩnh nên
+ * không được gọi đồng thời.
+ *
+ * \param[in]       history: Lịch sử
+ * \param[in]       from: Đầu khoảng (giây kể từ epoch)
+ * \param[in]       to: Cuối khoảng (bao gồm)
+ * \param[out]      ranks: Mảng nhận kết quả, giảm dần theo số lượt mượn
+ * \param[in]       capacity: Số phần tử tối đa của \p ranks
+ * \param[out]      count: Số phần tử đã ghi
+ * \return          \ref HISTORY_OK hoặc \ref HISTORY_TRUNCATED nếu thành công, \ref history_status_t nếu lỗi
+ */
+history_status_t
+history_range_top(const history_t* history, uint32_t from, uint32_t to,
+                  history_rank_t* ranks, size_t capacity, size_t* count) {
+    const history_partition_t* partition;
+    const history_event_t* event;
+    history_rank_t* slot;
+    uint32_t book_id;
+    uint32_t index;
+    size_t touched;
+    size_t i;
+    uint64_t p;
+    uint64_t seq;
+
+    if (history == NULL || ranks == NULL || count == NULL || from > to) {
+        return HISTORY_INVALID_INPUT;
+    }
+
+    /* Tem mới cho lần truy vấn này; khi tem quay vòng thì xóa bảng một lần */
+    if (++history_stamp == 0) {
+        memset(history_count_stamps, 0, sizeof(history_count_stamps));
+        history_stamp = 1;
+    }
+
+    touched = 0;
+    for (p = history->partition_tail; p < history->partition_head; p++) {
+        partition = &history->partitions[p & (HISTORY_MAX_PARTITIONS - 1)];
+        if (partition->loans == 0 || partition->max_time < from || partition->min_time > to) {
+            continue;
+        }
+        for (seq = partition->first; seq < partition->first + partition->count; seq++) {
+            event = &history->events[seq & (HISTORY_CAPACITY - 1)];
+            if (event->type != HISTORY_LOAN || event->time < from || event->time > to) {
+                continue;
+            }
+            book_id = BOOK_ITEM_BOOK_ID(event->item_key);
+            index = (uint32_t)(book_id * 0x9E3779B1U) & (HISTORY_COUNT_SLOTS - 1);
+            while (history_count_stamps[index] == history_stamp && history_counts[index].book_id != book_id) {
+                index = (index + 1) & (HISTORY_COUNT_SLOTS - 1);
+            }
+            slot = &history_counts[index];
+            if (history_count_stamps[index] != history_stamp) {
+                history_count_stamps[index] = history_stamp;
+                slot->book_id = book_id;
+                slot->count = 0;
+                history_touched[touched++] = index;
+            }
+            slot->count++;
+        }
+    }
+
+    *count = 0;
+    for (i = 0; i < touched; i++) {
+        history_heap_offer(ranks, count, capacity, &history_counts[history_touched[i]]);
+    }
+    history_sort_ranks(ranks, *count);
+    return history_range_status(history, from);
+}
+
+/**
+ * \brief           Ước lượng số lượt mượn của một sách từ count-min sketch
+ *
+ * Ước lượng không bao giờ nhỏ hơn số thật; sai số chỉ đến từ va chạm băm.
+ *
+ * \param[in]       history: Lịch sử
+ * \param[in]       book_id: ID sách
+ * \return          Số lượt mượn ước lượng
+ */
+uint32_t
+history_estimate(const history_t* history, uint32_t book_id) {
+    uint32_t estimate;
+    uint32_t value;
+    size_t row;
+
+    if (history == NULL) {
+        return 0;
+    }
+
+    estimate = UINT32_MAX;
+    for (row = 0; row < HISTORY_SKETCH_DEPTH; row++) {
+        value = history->sketch[row][history_sketch_slot(book_id, row)];
+        if (value < estimate) {
+            estimate = value;
+        }
+    }
+    return estimate;
+}
+
+/**
+ * \brief           Các sách phổ biến nhất từ đầu, cập nhật liên tục sau mỗi lượt mượn
+ * \param[in]       history: Lịch sử
+ * \param[out]      ranks: Mảng nhận kết quả, giảm dần theo số lượt mượn ước lượng
+ * \param[in]       capacity: Số phần tử tối đa của \p ranks
+ * \return          Số phần tử đã ghi
+ */
+size_t
+history_popular(const history_t* history, history_rank_t* ranks, size_t capacity) {
+    history_rank_t sorted[HISTORY_TOP_K];
+    size_t count;
+
+    if (history == NULL || ranks == NULL) {
+        return 0;
+    }
+
+    count = history->top_count;
+    memcpy(sorted, history->top, count * sizeof(sorted[0]));
+    history_sort_ranks(sorted, count);
+    if (count > capacity) {
+        count = capacity;
+    }
+    memcpy(ranks, sorted, count * sizeof(sorted[0]));
+    return count;
+}
@@ -0,0 +1,157 @@
+/**
+ * \file            history.h
+ * \brief           Khai báo lịch sử mượn/trả phân vùng theo thời gian
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef HISTORY_HDR_H
+#define HISTORY_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#ifndef HISTORY_CAPACITY
+#define HISTORY_CAPACITY            65536       /*!< Số sự kiện giữ lại (lũy thừa của 2) */
+#endif /* HISTORY_CAPACITY */
+#ifndef HISTORY_PARTITION_SECONDS
+#define HISTORY_PARTITION_SECONDS   86400       /*!< Độ rộng một phân vùng thời gian (1 ngày) */
+#endif /* HISTORY_PARTITION_SECONDS */
+#define HISTORY_MAX_PARTITIONS      1024        /*!< Số phân vùng giữ lại (lũy thừa của 2) */
+#define HISTORY_SKETCH_DEPTH        4           /*!< Số hàng của count-min sketch */
+#define HISTORY_SKETCH_BITS         11          /*!< Mỗi hàng có 2^11 bộ đếm */
+#define HISTORY_SKETCH_WIDTH        (1U << HISTORY_SKETCH_BITS)
+#define HISTORY_TOP_K               16          /*!< Số sách phổ biến nhất được theo dõi liên tục */
+
+/**
+ * \brief           Trạng thái trả về của các hàm lịch sử
+ */
+typedef enum {
+    HISTORY_OK = 0,                             /*!< Thành công */
+    HISTORY_ERROR,                              /*!< Lỗi chung */
+    HISTORY_INVALID_INPUT,                      /*!< Dữ liệu đầu vào không hợp lệ */
+    HISTORY_TRUNCATED,                          /*!< Kết quả đúng nhưng khoảng thời gian bắt đầu trước sự kiện cũ nhất còn giữ */
+} history_status_t;
+
+/**
+ * \brief           Loại sự kiện lưu thông
+ */
+typedef enum {
+    HISTORY_LOAN = 0,                           /*!< Một bản sao được mượn */
+    HISTORY_RETURN,                             /*!< Một bản sao được trả */
+} history_type_t;
+
+/**
+ * \brief           Một sự kiện mượn hoặc trả
+ */
+typedef struct {
+    uint32_t time;                              /*!< Thời điểm (giây kể từ epoch) */
+    uint32_t user_id;                           /*!< ID người dùng */
+    uint32_t item_key;                          /*!< Khóa item của bản sao (\ref BOOK_ITEM_KEY) */
+    uint8_t type;                               /*!< \ref history_type_t */
+} history_event_t;
+
+/**
+ * \brief           Một phân vùng: dải sự kiện liên tiếp thuộc cùng một khung thời gian
+ *
+ * Tổng số lượt mượn/trả được giữ sẵn nên truy vấn phủ trọn phân vùng không
+ * cần đọc từng sự kiện.
+ */
+typedef struct {
+    uint32_t bucket;                            /*!< Chỉ số khung = thời điểm / \ref HISTORY_PARTITION_SECONDS */
+    uint32_t min_time;                          /*!< Thời điểm nhỏ nhất (cận dưới) */
+    uint32_t max_time;                          /*!< Thời điểm lớn nhất */
+    uint64_t first;                             /*!< Số thứ tự của sự kiện đầu tiên */
+    uint32_t count;                             /*!< Số sự kiện */
+    uint32_t loans;                             /*!< Số lượt mượn */
+    uint32_t returns;                           /*!< Số lượt trả */
+} history_partition_t;
+
+/**
+ * \brief           Số lượt mượn của một đầu sách
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách */
+    uint32_t count;                             /*!< Số lượt mượn (ước lượng với top-K liên tục) */
+} history_rank_t;
+
+/**
+ * \brief           Kết quả tổng hợp trong một khoảng thời gian
+ */
+typedef struct {
+    uint64_t loans;                             /*!< Số lượt mượn */
+    uint64_t returns;                           /*!< Số lượt trả */
+    uint32_t partitions_summarized;             /*!< Số phân vùng dùng tổng có sẵn */
+    uint32_t partitions_scanned;                /*!< Số phân vùng phải đọc từng sự kiện */
+} history_stats_t;
+
+/**
+ * \brief           Lịch sử lưu thông: nhật ký chỉ ghi thêm, phân vùng theo thời gian
+ *
+ * Sự kiện có số thứ tự s nằm ở ô s mod \ref HISTORY_CAPACITY; khi đầy, sự kiện
+ * cũ nhất bị bỏ khỏi phân vùng cũ nhất. Các lượt mượn đồng thời được đếm trong
+ * count-min sketch và một min-heap giữ \ref HISTORY_TOP_K sách phổ biến nhất.
+ */
+typedef struct {
+    history_event_t events[HISTORY_CAPACITY];   /*!< Vòng đệm sự kiện */
+    uint64_t head;                              /*!< Số thứ tự của sự kiện kế tiếp */
+    uint64_t tail;                              /*!< Số thứ tự của sự kiện cũ nhất còn giữ */
+    history_partition_t partitions[HISTORY_MAX_PARTITIONS]; /*!< Vòng đệm phân vùng */
+    uint64_t partition_head;                    /*!< Số thứ tự của phân vùng kế tiếp */
+    uint64_t partition_tail;                    /*!< Số thứ tự của phân vùng cũ nhất */
+    uint32_t sketch[HISTORY_SKETCH_DEPTH][HISTORY_SKETCH_WIDTH]; /*!< Count-min sketch lượt mượn theo ID sách */
+    history_rank_t top[HISTORY_TOP_K];          /*!< Min-heap theo số lượt mượn ước lượng */
+    size_t top_count;                           /*!< Số phần tử trong heap */
+} history_t;
+
+/* Khai báo các hàm ghi lịch sử */
+void            history_init(history_t* history);
+void            history_append(history_t* history, history_type_t type, uint32_t user_id,
+                               uint32_t item_key, uint32_t time);
+void            history_record(history_t* history, history_type_t type, uint32_t user_id, uint32_t item_key);
+size_t          history_count(const history_t* history);
+
+/* Khai báo các hàm truy vấn lịch sử */
+history_status_t history_range_stats(const history_t* history, uint32_t from, uint32_t to,
+                                     history_stats_t* stats);
+history_status_t history_range_top(const history_t* history, uint32_t from, uint32_t to,
+                                   history_rank_t* ranks, size_t capacity, size_t* count);
+size_t          history_popular(const history_t* history, history_rank_t* ranks, size_t capacity);
+uint32_t        history_estimate(const history_t* history, uint32_t book_id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* HISTORY_HDR_H */
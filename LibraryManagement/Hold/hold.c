@@ -0,0 +1,257 @@
+/**
+ * \file            hold.c
+ * \brief           Triển khai hàng đợi đặt giữ và pool node
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include "hold.h"
+#include <string.h>
+
+/**
+ * \brief           Khởi tạo pool node, nối mọi node vào danh sách trống
+ * \param[in,out]   pool: Con trỏ tới pool
+ */
+void
+hold_pool_init(hold_pool_t* pool) {
+    uint32_t i;
+
+    if (pool == NULL) {
+        return;
+    }
+
+    for (i = 0; i < MAX_HOLDS; i++) {
+        pool->nodes[i].user_id = 0;
+        pool->nodes[i].next = (i + 1 < MAX_HOLDS) ? i + 1 : HOLD_NIL;
+    }
+    pool->free_head = 0;
+    pool->used = 0;
+}
+
+/**
+ * \brief           Khởi tạo hàng đợi rỗng
+ * \param[out]      queue: Con trỏ tới hàng đợi
+ */
+void
+hold_queue_init(hold_queue_t* queue) {
+    if (queue != NULL) {
+        queue->head = HOLD_NIL;
+        queue->tail = HOLD_NIL;
+        queue->length = 0;
+    }
+}
+
+/**
+ * \brief           Thêm người dùng vào cuối hàng đợi trong O(1)
+ * \param[in,out]   pool: Con trỏ tới pool node
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \param[in]       user_id: ID người dùng đặt giữ
+ * \return          \ref HOLD_OK nếu thành công, \ref HOLD_FULL nếu pool đã hết node
+ */
+hold_status_t
+hold_enqueue(hold_pool_t* pool, hold_queue_t* queue, uint32_t user_id) {
+    uint32_t index;
+
+    if (pool == NULL || queue == NULL) {
+        return HOLD_INVALID_INPUT;
+    }
+
+    /* Lấy node từ danh sách trống */
+    index = pool->free_head;
+    if (index == HOLD_NIL) {
+        return HOLD_FULL;
+    }
+    pool->free_head = pool->nodes[index].next;
+    pool->used++;
+
+    pool->nodes[index].user_id = user_id;
+    pool->nodes[index].next = HOLD_NIL;
+
+    /* Nối vào cuối hàng đợi */
+    if (queue->length == 0) {
+        queue->head = index;
+    } else {
+        pool->nodes[queue->tail].next = index;
+    }
+    queue->tail = index;
+    queue->length++;
+
+    return HOLD_OK;
+}
+
+/**
+ * \brief           Lấy người dùng ở đầu hàng đợi trong O(1)
+ * \param[in,out]   pool: Con trỏ tới pool node
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \param[out]      user_id: ID người dùng được lấy ra
+ * \return          \ref HOLD_OK nếu thành công, \ref HOLD_EMPTY nếu hàng đợi rỗng
+ */
+hold_status_t
+hold_dequeue(hold_pool_t* pool, hold_queue_t* queue, uint32_t* user_id) {
+    uint32_t index;
+
+    if (pool == NULL || queue == NULL || user_id == NULL) {
+        return HOLD_INVALID_INPUT;
+    }
+
+    if (queue->length == 0) {
+        return HOLD_EMPTY;
+    }
+
+    index = queue->head;
+    *user_id = pool->nodes[index].user_id;
+
+    queue->head = pool->nodes[index].next;
+    queue->length--;
+    if (queue->length == 0) {
+        queue->tail = HOLD_NIL;
+    }
+
+    /* Trả node về danh sách trống */
+    pool->nodes[index].next = pool->free_head;
+    pool->free_head = index;
+    pool->used--;
+
+    return HOLD_OK;
+}
+
+/**
+ * \brief           Xem người đứng đầu hàng đợi mà không lấy ra
+ * \param[in]       pool: Con trỏ tới pool node
+ * \param[in]       queue: Con trỏ tới hàng đợi
+ * \param[out]      user_id: ID người dùng chờ lâu nhất
+ * \return          \ref HOLD_OK nếu thành công, \ref HOLD_EMPTY nếu hàng đợi rỗng
+ */
+hold_status_t
+hold_peek(const hold_pool_t* pool, const hold_queue_t* queue, uint32_t* user_id) {
+    if (pool == NULL || queue == NULL || user_id == NULL) {
+        return HOLD_INVALID_INPUT;
+    }
+
+    if (queue->length == 0) {
+        return HOLD_EMPTY;
+    }
+
+    *user_id = pool->nodes[queue->head].user_id;
+    return HOLD_OK;
+}
+
+/**
+ * \brief           Hủy lượt đặt giữ của một người dùng (duyệt hàng đợi của sách này)
+ * \param[in,out]   pool: Con trỏ tới pool node
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \param[in]       user_id: ID người dùng cần hủy
+ * \return          \ref HOLD_OK nếu thành công, \ref HOLD_NOT_FOUND nếu không có trong hàng đợi
+ */
+hold_status_t
+hold_remove(hold_pool_t* pool, hold_queue_t* queue, uint32_t user_id) {
+    uint32_t prev;
+    uint32_t index;
+
+    if (pool == NULL || queue == NULL) {
+        return HOLD_INVALID_INPUT;
+    }
+
+    prev = HOLD_NIL;
+    index = (queue->length > 0) ? queue->head : HOLD_NIL;
+    while (index != HOLD_NIL) {
+        if (pool->nodes[index].user_id == user_id) {
+            /* Gỡ node khỏi hàng đợi */
+            if (prev == HOLD_NIL) {
+                queue->head = pool->nodes[index].next;
+            } else {
+                pool->nodes[prev].next = pool->nodes[index].next;
+            }
+            if (queue->tail == index) {
+                queue->tail = prev;
+            }
+            queue->length--;
+
+            pool->nodes[index].next = pool->free_head;
+            pool->free_head = index;
+            pool->used--;
+            return HOLD_OK;
+        }
+        prev = index;
+        index = pool->nodes[index].next;
+    }
+
+    return HOLD_NOT_FOUND;
+}
+
+/**
+ * \brief           Giải phóng toàn bộ node của hàng đợi
+ * \param[in,out]   pool: Con trỏ tới pool node
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ */
+void
+hold_queue_clear(hold_pool_t* pool, hold_queue_t* queue) {
+    uint32_t user_id;
+
+    while (hold_dequeue(pool, queue, &user_id) == HOLD_OK) {}
+}
+
+/**
+ * \brief           Kiểm tra người dùng đã có trong hàng đợi hay chưa
+ * \param[in]       pool: Con trỏ tới pool node
+ * \param[in]       queue: Con trỏ tới hàng đợi
+ * \param[in]       user_id: ID người dùng cần kiểm tra
+ * \return          1 nếu có, 0 nếu không
+ */
+uint8_t
+hold_contains(const hold_pool_t* pool, const hold_queue_t* queue, uint32_t user_id) {
+    uint32_t index;
+
+    if (pool == NULL || queue == NULL) {
+        return 0;
+    }
+
+    index = (queue->length > 0) ? queue->head : HOLD_NIL;
+    while (index != HOLD_NIL) {
+        if (pool->nodes[index].user_id == user_id) {
+            return 1;
+        }
+        index = pool->nodes[index].next;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief           Số người đang chờ trong hàng đợi, O(1)
+ * \param[in]       queue: Con trỏ tới hàng đợi
+ * \return          Độ dài hàng đợi
+ */
+size_t
+hold_queue_length(const hold_queue_t* queue) {
+    if (queue == NULL) {
+        return 0;
+    }
+    return queue->length;
+}
@@ -0,0 +1,104 @@
+/**
+ * \file            hold.h
+ * \brief           Hàng đợi đặt giữ sách (hold queue) dùng chung một pool node
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef HOLD_HDR_H
+#define HOLD_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define MAX_HOLDS                   2000        /*!< Tổng số lượt đặt giữ cho toàn thư viện */
+#define HOLD_NIL                    UINT32_MAX  /*!< Chỉ số node rỗng */
+
+/**
+ * \brief           Trạng thái trả về của các hàm đặt giữ
+ */
+typedef enum {
+    HOLD_OK = 0,                                /*!< Thành công */
+    HOLD_ERROR,                                 /*!< Lỗi chung */
+    HOLD_INVALID_INPUT,                         /*!< Dữ liệu đầu vào không hợp lệ */
+    HOLD_FULL,                                  /*!< Pool node đã hết */
+    HOLD_EMPTY,                                 /*!< Hàng đợi rỗng */
+    HOLD_NOT_FOUND,                             /*!< Không tìm thấy lượt đặt giữ */
+} hold_status_t;
+
+/**
+ * \brief           Một node trong pool, liên kết bằng chỉ số thay vì con trỏ
+ */
+typedef struct {
+    uint32_t user_id;                           /*!< Người dùng đang chờ */
+    uint32_t next;                              /*!< Node kế tiếp hoặc \ref HOLD_NIL */
+} hold_node_t;
+
+/**
+ * \brief           Hàng đợi FIFO của một đầu sách (nằm trong \ref book_t)
+ *
+ * Chỉ lưu chỉ số head/tail và độ dài nên sao chép hoặc memmove bản ghi sách
+ * không làm hỏng hàng đợi.
+ */
+typedef struct {
+    uint32_t head;                              /*!< Node đầu (người chờ lâu nhất) */
+    uint32_t tail;                              /*!< Node cuối */
+    uint32_t length;                            /*!< Số người đang chờ, đọc trong O(1) */
+} hold_queue_t;
+
+/**
+ * \brief           Pool node dùng chung cho mọi hàng đợi
+ */
+typedef struct {
+    hold_node_t nodes[MAX_HOLDS];               /*!< Mảng node tĩnh */
+    uint32_t free_head;                         /*!< Đầu danh sách node trống */
+    size_t used;                                /*!< Số node đang được dùng */
+} hold_pool_t;
+
+/* Khai báo các hàm quản lý đặt giữ */
+void            hold_pool_init(hold_pool_t* pool);
+void            hold_queue_init(hold_queue_t* queue);
+hold_status_t   hold_enqueue(hold_pool_t* pool, hold_queue_t* queue, uint32_t user_id);
+hold_status_t   hold_dequeue(hold_pool_t* pool, hold_queue_t* queue, uint32_t* user_id);
+hold_status_t   hold_peek(const hold_pool_t* pool, const hold_queue_t* queue, uint32_t* user_id);
+hold_status_t   hold_remove(hold_pool_t* pool, hold_queue_t* queue, uint32_t user_id);
+void            hold_queue_clear(hold_pool_t* pool, hold_queue_t* queue);
+uint8_t         hold_contains(const hold_pool_t* pool, const hold_queue_t* queue, uint32_t user_id);
+size_t          hold_queue_length(const hold_queue_t* queue);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* HOLD_HDR_H */
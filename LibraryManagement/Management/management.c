@@ -31,23 +31,132 @@
  * Author:          Phạm Văn Long
  */
 
+#include <string.h>
 #include "management.h"
+#include "../Txn/txn.h"
 #include "../Ultils/utils.h"
 #include <stdio.h>
 
+/* Định nghĩa các hằng số */
+#define MGMT_TOP_BOOKS              10          /*!< Số sách phổ biến được hiển thị */
+#define MGMT_ANY_COPY               0xFF        /*!< Mượn bản sao có sẵn bất kỳ */
+
 /**
- * \brief           Cho phép người dùng mượn sách
+ * \brief           Kiểm tra người mượn có được lấy bản sao khi sách đang có người đặt giữ
+ *
+ * Bản sao có sẵn trong lúc hàng đợi khác rỗng (ví dụ vừa nhập thêm) thuộc về
+ * người chờ lâu nhất. Lượt đặt giữ cũ ở đầu hàng (người dùng đã bị xóa hoặc đã
+ * mượn sách này theo đường khác) bị bỏ để không chặn hàng đợi mãi.
+ *
  * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
- * \param[in]       user_id: ID của người dùng
- * \param[in]       book_id: ID của sách cần mượn
+ * \param[in]       user: Người mượn
+ * \param[in,out]   book: Sách cần mượn
+ * \param[out]      is_head: 1 nếu người mượn đứng đầu hàng đợi (cần lấy ra sau khi mượn xong)
+ * \return          \ref MGMT_OK nếu được mượn, \ref MGMT_BOOK_RESERVED nếu phải nhường người khác
+ */
+static mgmt_status_t
+mgmt_check_holds(library_t* library, const user_t* user, book_t* book, uint8_t* is_head) {
+    uint32_t head_id;
+    user_t* head;
+
+    *is_head = 0;
+    if (library->holds == NULL) {
+        return MGMT_OK;
+    }
+    while (hold_peek(library->holds, &book->holds, &head_id) == HOLD_OK) {
+        if (head_id == user->user_id) {
+            *is_head = 1;
+            return MGMT_OK;
+        }
+        head = user_find_by_id(library->users, head_id);
+        if (head != NULL && !user_has_borrowed_book(library->users, head, book->book_id)) {
+            return MGMT_BOOK_RESERVED;
+        }
+        hold_dequeue(library->holds, &book->holds, &head_id);
+    }
+
+    return MGMT_OK;
+}
+
+/**
+ * \brief           Cho người dùng mượn một bản sao của sách đã tìm thấy
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in,out]   user: Người mượn
+ * \param[in,out]   book: Sách cần mượn
+ * \param[in]       wanted: Chỉ số bản sao cần mượn, \ref MGMT_ANY_COPY nếu lấy bản bất kỳ
  * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
  */
-mgmt_status_t
-mgmt_borrow_book(library_t* library, uint32_t user_id, uint32_t book_id) {
+static mgmt_status_t
+mgmt_checkout(library_t* library, user_t* user, book_t* book, uint8_t wanted) {
+    uint32_t item_key;
+    uint32_t head_id;
+    uint8_t copy;
+    uint8_t is_head;
+    mgmt_status_t status;
+    book_status_t book_status;
+    user_status_t user_status;
+
+    /* Kiểm tra còn bản sao có sẵn (hoặc đúng bản sao được quét còn trên kệ) */
+    if (book->available_count == 0
+        || (wanted != MGMT_ANY_COPY && (book->available_mask & ((uint64_t)1 << wanted)) == 0)) {
+        return MGMT_BOOK_ALREADY_BORROWED;
+    }
+
+    /* Người đặt giữ được ưu tiên theo thứ tự FIFO */
+    status = mgmt_check_holds(library, user, book, &is_head);
+    if (status != MGMT_OK) {
+        return status;
+    }
+
+    /* Mỗi người dùng chỉ mượn một bản của cùng một đầu sách */
+    if (user_has_borrowed_book(library->users, user, book->book_id)) {
+        return MGMT_USER_ALREADY_HAS_BOOK;
+    }
+
+    /* Kiểm tra người dùng đã đạt giới hạn mượn sách chưa */
+    if (user->borrowed_count >= user_borrow_limit(user)) {
+        return MGMT_USER_LIMIT_REACHED;
+    }
+
+    /* Lấy bản sao trực tiếp trên bản ghi đã tìm thấy, không tra lại theo ID */
+    if (wanted == MGMT_ANY_COPY) {
+        book_status = book_record_checkout(book, &copy);
+    } else {
+        copy = wanted;
+        book_status = book_record_checkout_copy(book, copy);
+    }
+    if (book_status != BOOK_OK) {
+        return MGMT_ERROR;
+    }
+    book_notify(library->books, BOOK_EVENT_AVAILABILITY, book);
+
+    /* Thêm bản sao vào danh sách mượn của người dùng */
+    item_key = BOOK_ITEM_KEY(book->book_id, copy);
+    user_status = user_add_borrowed_book(library->users, user, item_key);
+    if (user_status != USER_OK) {
+        /* Rollback: trả lại bản sao vừa lấy */
+        book_record_return(book, copy);
+        book_notify(library->books, BOOK_EVENT_AVAILABILITY, book);
+        return (user_status == USER_POOL_FULL) ? MGMT_LOAN_POOL_FULL : MGMT_ERROR;
+    }
+    if (is_head) {
+        hold_dequeue(library->holds, &book->holds, &head_id);
+    }
+    cdc_record_loan(library->cdc, CDC_OP_LOAN, user->user_id, item_key);
+    txn_publish_user(library->txn, user->user_id);
+    history_record(library->history, HISTORY_LOAN, user->user_id, item_key);
+    notify_post(library->notify, NOTIFY_DUE_DATE, user->user_id, item_key);
+
+    return MGMT_OK;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_borrow_book (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_borrow_book_locked(library_t* library, uint32_t user_id, uint32_t book_id) {
     user_t* user;
     book_t* book;
-    user_status_t user_status;
-    book_status_t book_status;
 
     if (library == NULL || library->books == NULL || library->users == NULL) {
         return MGMT_INVALID_INPUT;
@@ -65,50 +174,504 @@ mgmt_borrow_book(library_t* library, uint32_t user_id, uint32_t book_id) {
         return MGMT_BOOK_NOT_FOUND;
     }
 
-    /* Kiểm tra sách đã được mượn chưa */
-    if (book->is_borrowed) {
-        return MGMT_BOOK_ALREADY_BORROWED;
+    return mgmt_checkout(library, user, book, MGMT_ANY_COPY);
+}
+
+/**
+ * \brief           Cho phép người dùng mượn một bản sao có sẵn bất kỳ của sách
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       book_id: ID của sách cần mượn
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_borrow_book(library_t* library, uint32_t user_id, uint32_t book_id) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
     }
 
-    /* Kiểm tra người dùng đã đạt giới hạn mượn sách chưa */
-    if (user->borrowed_count >= MAX_BORROWED_BOOKS) {
-        return MGMT_USER_LIMIT_REACHED;
+    txn_lock(library->txn);
+    status = mgmt_borrow_book_locked(library, user_id, book_id);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_borrow_by_barcode (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_borrow_by_barcode_locked(library_t* library, uint32_t user_id, uint64_t key, uint32_t* book_id) {
+    user_t* user;
+    book_t* book;
+    uint32_t item_key;
+
+    if (library == NULL || library->books == NULL || library->users == NULL
+        || library->barcodes == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    /* Tìm người dùng */
+    user = user_find_by_id(library->users, user_id);
+    if (user == NULL) {
+        return MGMT_USER_NOT_FOUND;
     }
 
-    /* Thêm sách vào danh sách mượn của người dùng */
-    user_status = user_add_borrowed_book(user, book_id);
+    /* Tra mã */
+    if (barcode_index_resolve(library->barcodes, library->books, key, &book, &item_key) != BARCODE_OK) {
+        return MGMT_BARCODE_NOT_FOUND;
+    }
+    if (book_id != NULL) {
+        *book_id = book->book_id;
+    }
+
+    return mgmt_checkout(library, user, book, (BARCODE_KEY_KIND(key) == BARCODE_KIND_ITEM)
+                                                  ? BOOK_ITEM_COPY(item_key) : MGMT_ANY_COPY);
+}
+
+/**
+ * \brief           Cho mượn theo một lượt quét mã
+ *
+ * Mã vạch bản sao cho mượn đúng bản sao đó; ISBN cho mượn một bản có sẵn bất
+ * kỳ của đầu sách. Mã được tra trong \ref library_t::barcodes một lần, không
+ * cần tìm sách theo tiêu đề hay quét danh sách theo ID.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       key: Khóa mã đã đọc bằng \ref barcode_parse
+ * \param[out]      book_id: ID sách của mã (có thể NULL)
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_borrow_by_barcode(library_t* library, uint32_t user_id, uint64_t key, uint32_t* book_id) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_borrow_by_barcode_locked(library, user_id, key, book_id);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Cho phép người dùng trả bản sao sách đang mượn
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       book_id: ID của sách cần trả
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_return_book(library_t* library, uint32_t user_id, uint32_t book_id) {
+    return mgmt_return_book_handoff(library, user_id, book_id, NULL);
+}
+
+/**
+ * \brief           Chuyển bản sao vừa được trả cho người đặt giữ kế tiếp
+ *
+ * Lấy lần lượt người ở đầu hàng đợi; lượt đặt giữ của người dùng đã bị xóa,
+ * đã mượn sách này hoặc đã đạt giới hạn sẽ bị bỏ qua.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in,out]   book: Con trỏ tới sách vừa được trả
+ * \return          ID người dùng nhận sách, 0 nếu không có ai
+ */
+static uint32_t
+mgmt_handoff_to_next_holder(library_t* library, book_t* book) {
+    uint32_t next_id;
+    uint8_t copy;
+    user_t* next;
+
+    while (hold_dequeue(library->holds, &book->holds, &next_id) == HOLD_OK) {
+        next = user_find_by_id(library->users, next_id);
+        if (next == NULL
+            || user_has_borrowed_book(library->users, next, book->book_id)
+            || next->borrowed_count >= user_borrow_limit(next)) {
+            continue;
+        }
+
+        if (book_checkout_copy(library->books, book->book_id, &copy) != BOOK_OK) {
+            return 0;
+        }
+        if (user_add_borrowed_book(library->users, next, BOOK_ITEM_KEY(book->book_id, copy)) != USER_OK) {
+            book_return_copy(library->books, book->book_id, copy);
+            continue;
+        }
+        cdc_record_loan(library->cdc, CDC_OP_LOAN, next_id, BOOK_ITEM_KEY(book->book_id, copy));
+        txn_publish_user(library->txn, next_id);
+        history_record(library->history, HISTORY_LOAN, next_id, BOOK_ITEM_KEY(book->book_id, copy));
+        notify_post(library->notify, NOTIFY_HOLD_READY, next_id, BOOK_ITEM_KEY(book->book_id, copy));
+        return next_id;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief           Nhận lại bản sao người dùng đang mượn và chuyển cho người đặt giữ (nếu có)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in,out]   user: Người trả
+ * \param[in,out]   book: Sách được trả
+ * \param[in]       item_key: Khóa item người dùng đang giữ
+ * \param[out]      handed_to: ID người dùng nhận sách, 0 nếu bản sao trở về kệ (có thể NULL)
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+static mgmt_status_t
+mgmt_checkin(library_t* library, user_t* user, book_t* book, uint32_t item_key, uint32_t* handed_to) {
+    user_status_t user_status;
+    book_status_t book_status;
+
+    /* Xóa bản sao khỏi danh sách mượn của người dùng */
+    user_status = user_remove_borrowed_book(library->users, user, item_key);
     if (user_status != USER_OK) {
         return MGMT_ERROR;
     }
 
-    /* Đánh dấu sách đã được mượn */
-    book_status = book_set_borrowed(library->books, book_id, 1);
+    /* Đánh dấu bản sao đã được trả */
+    book_status = book_record_return(book, BOOK_ITEM_COPY(item_key));
     if (book_status != BOOK_OK) {
-        /* Rollback: xóa sách khỏi danh sách mượn của người dùng */
-        user_remove_borrowed_book(user, book_id);
+        /* Rollback: thêm lại bản sao vào danh sách mượn của người dùng */
+        user_add_borrowed_book(library->users, user, item_key);
         return MGMT_ERROR;
     }
+    book_notify(library->books, BOOK_EVENT_AVAILABILITY, book);
+    cdc_record_loan(library->cdc, CDC_OP_RETURN, user->user_id, item_key);
+    txn_publish_user(library->txn, user->user_id);
+    history_record(library->history, HISTORY_RETURN, user->user_id, item_key);
+
+    if (handed_to != NULL) {
+        *handed_to = 0;
+    }
+
+    /* Chuyển thẳng cho người đặt giữ kế tiếp, không cần duyệt người dùng */
+    if (library->holds != NULL && hold_queue_length(&book->holds) > 0) {
+        uint32_t next_id = mgmt_handoff_to_next_holder(library, book);
+        if (handed_to != NULL) {
+            *handed_to = next_id;
+        }
+    }
 
     return MGMT_OK;
 }
 
 /**
- * \brief           Cho phép người dùng trả sách
+ * \brief           Phần thân của \ref mgmt_return_book_handoff (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_return_book_handoff_locked(library_t* library, uint32_t user_id, uint32_t book_id,
+                                uint32_t* handed_to) {
+    user_t* user;
+    book_t* book;
+    uint32_t item_key;
+
+    if (library == NULL || library->books == NULL || library->users == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    /* Tìm người dùng */
+    user = user_find_by_id(library->users, user_id);
+    if (user == NULL) {
+        return MGMT_USER_NOT_FOUND;
+    }
+
+    /* Tìm sách */
+    book = book_find_by_id(library->books, book_id);
+    if (book == NULL) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+
+    /* Tìm bản sao người dùng đang mượn */
+    if (user_find_borrowed_item(library->users, user, book_id, &item_key) != USER_OK) {
+        return MGMT_BOOK_NOT_BORROWED;
+    }
+
+    return mgmt_checkin(library, user, book, item_key, handed_to);
+}
+
+/**
+ * \brief           Trả sách và chuyển ngay bản sao cho người đặt giữ kế tiếp (nếu có)
  * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
  * \param[in]       user_id: ID của người dùng
  * \param[in]       book_id: ID của sách cần trả
+ * \param[out]      handed_to: ID người dùng nhận sách, 0 nếu bản sao trở về kệ (có thể NULL)
  * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
  */
 mgmt_status_t
-mgmt_return_book(library_t* library, uint32_t user_id, uint32_t book_id) {
+mgmt_return_book_handoff(library_t* library, uint32_t user_id, uint32_t book_id,
+                         uint32_t* handed_to) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_return_book_handoff_locked(library, user_id, book_id, handed_to);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_return_by_barcode (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_return_by_barcode_locked(library_t* library, uint32_t user_id, uint64_t key, uint32_t* handed_to) {
     user_t* user;
     book_t* book;
-    user_status_t user_status;
+    uint32_t scanned;
+    uint32_t item_key;
+
+    if (library == NULL || library->books == NULL || library->users == NULL
+        || library->barcodes == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    /* Tìm người dùng */
+    user = user_find_by_id(library->users, user_id);
+    if (user == NULL) {
+        return MGMT_USER_NOT_FOUND;
+    }
+
+    /* Tra mã */
+    if (barcode_index_resolve(library->barcodes, library->books, key, &book, &scanned) != BARCODE_OK) {
+        return MGMT_BARCODE_NOT_FOUND;
+    }
+
+    /* Tìm bản sao người dùng đang mượn (phải đúng bản sao được quét) */
+    if (user_find_borrowed_item(library->users, user, book->book_id, &item_key) != USER_OK
+        || (BARCODE_KEY_KIND(key) == BARCODE_KIND_ITEM && item_key != scanned)) {
+        return MGMT_BOOK_NOT_BORROWED;
+    }
+
+    return mgmt_checkin(library, user, book, item_key, handed_to);
+}
+
+/**
+ * \brief           Trả sách theo một lượt quét mã
+ *
+ * Với mã vạch bản sao, người dùng phải đang giữ đúng bản sao đó; với ISBN,
+ * trả bản sao của đầu sách mà người dùng đang mượn.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       key: Khóa mã đã đọc bằng \ref barcode_parse
+ * \param[out]      handed_to: ID người dùng nhận sách, 0 nếu bản sao trở về kệ (có thể NULL)
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_return_by_barcode(library_t* library, uint32_t user_id, uint64_t key, uint32_t* handed_to) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_return_by_barcode_locked(library, user_id, key, handed_to);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_assign_isbn (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_assign_isbn_locked(library_t* library, uint32_t book_id, uint64_t key) {
+    book_t* book;
+    barcode_status_t status;
+
+    if (library == NULL || library->books == NULL || library->barcodes == NULL
+        || BARCODE_KEY_KIND(key) != BARCODE_KIND_ISBN) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(library->books, book_id);
+    if (book == NULL) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+    if (book->isbn == BARCODE_KEY_VALUE(key)) {
+        return MGMT_OK;
+    }
+
+    status = barcode_index_add(library->barcodes, key, BOOK_ITEM_KEY(book_id, 0));
+    if (status == BARCODE_ALREADY_EXISTS) {
+        return MGMT_BARCODE_EXISTS;
+    }
+    if (status != BARCODE_OK) {
+        return MGMT_BARCODE_FULL;
+    }
+
+    if (book->isbn != 0) {
+        barcode_index_remove(library->barcodes, BARCODE_KEY(BARCODE_KIND_ISBN, book->isbn));
+    }
+    book_set_isbn(library->books, book_id, BARCODE_KEY_VALUE(key));
+
+    return MGMT_OK;
+}
+
+/**
+ * \brief           Gán ISBN cho đầu sách
+ *
+ * ISBN cũ (nếu có) được bỏ khỏi chỉ mục; một ISBN chỉ thuộc một đầu sách.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       book_id: ID của sách
+ * \param[in]       key: Khóa loại \ref BARCODE_KIND_ISBN
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_assign_isbn(library_t* library, uint32_t book_id, uint64_t key) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_assign_isbn_locked(library, book_id, key);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_assign_barcode (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_assign_barcode_locked(library_t* library, uint32_t book_id, uint8_t copy, uint64_t key) {
+    book_t* book;
+    barcode_status_t status;
+
+    if (library == NULL || library->books == NULL || library->barcodes == NULL
+        || BARCODE_KEY_KIND(key) != BARCODE_KIND_ITEM) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(library->books, book_id);
+    if (book == NULL) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+    if (copy >= book->copy_count) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    status = barcode_index_add(library->barcodes, key, BOOK_ITEM_KEY(book_id, copy));
+    if (status == BARCODE_ALREADY_EXISTS) {
+        return MGMT_BARCODE_EXISTS;
+    }
+    if (status != BARCODE_OK) {
+        return MGMT_BARCODE_FULL;
+    }
+
+    return MGMT_OK;
+}
+
+/**
+ * \brief           Gán mã vạch cho một bản sao
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       book_id: ID của sách
+ * \param[in]       copy: Chỉ số bản sao (0..copy_count - 1)
+ * \param[in]       key: Khóa loại \ref BARCODE_KIND_ITEM
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_assign_barcode(library_t* library, uint32_t book_id, uint8_t copy, uint64_t key) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_assign_barcode_locked(library, book_id, copy, key);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_add_copies (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_add_copies_locked(library_t* library, uint32_t book_id, uint8_t count, uint32_t* handed) {
+    book_t* book;
     book_status_t book_status;
+    uint32_t given;
 
     if (library == NULL || library->books == NULL || library->users == NULL) {
         return MGMT_INVALID_INPUT;
     }
+    if (handed != NULL) {
+        *handed = 0;
+    }
+
+    book_status = book_add_copies(library->books, book_id, count);
+    if (book_status == BOOK_NOT_FOUND) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+    if (book_status == BOOK_COPY_LIMIT_REACHED) {
+        return MGMT_COPY_LIMIT_REACHED;
+    }
+    if (book_status != BOOK_OK) {
+        return MGMT_ERROR;
+    }
+
+    book = book_find_by_id(library->books, book_id);
+    given = 0;
+    while (library->holds != NULL && book != NULL && book->available_count > 0
+           && hold_queue_length(&book->holds) > 0) {
+        if (mgmt_handoff_to_next_holder(library, book) == 0) {
+            break;
+        }
+        given++;
+    }
+    if (handed != NULL) {
+        *handed = given;
+    }
+
+    return MGMT_OK;
+}
+
+/**
+ * \brief           Nhập thêm bản sao và giao ngay cho những người đang đặt giữ
+ *
+ * Bản sao mới đi qua cùng đường chuyển giao như khi trả sách, nên hàng đợi
+ * FIFO được phục vụ trước khi bản sao lên kệ cho người mượn vãng lai.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       book_id: ID của sách
+ * \param[in]       count: Số bản sao thêm
+ * \param[out]      handed: Số bản sao đã giao cho người đặt giữ (có thể NULL)
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_add_copies(library_t* library, uint32_t book_id, uint8_t count, uint32_t* handed) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_add_copies_locked(library, book_id, count, handed);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_place_hold (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_place_hold_locked(library_t* library, uint32_t user_id, uint32_t book_id) {
+    user_t* user;
+    book_t* book;
+    hold_status_t hold_status;
+
+    if (library == NULL || library->books == NULL || library->users == NULL
+        || library->holds == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
 
     /* Tìm người dùng */
     user = user_find_by_id(library->users, user_id);
@@ -122,60 +685,405 @@ mgmt_return_book(library_t* library, uint32_t user_id, uint32_t book_id) {
         return MGMT_BOOK_NOT_FOUND;
     }
 
-    /* Kiểm tra sách có đang được mượn không */
-    if (!book->is_borrowed) {
-        return MGMT_BOOK_NOT_BORROWED;
+    /* Còn bản sao và không ai chờ thì mượn luôn */
+    if (book->available_count > 0 && hold_queue_length(&book->holds) == 0) {
+        return MGMT_BOOK_AVAILABLE;
     }
 
-    /* Kiểm tra người dùng có đang mượn sách này không */
-    if (!user_has_borrowed_book(user, book_id)) {
-        return MGMT_BOOK_NOT_BORROWED;
+    if (user_has_borrowed_book(library->users, user, book_id)) {
+        return MGMT_USER_ALREADY_HAS_BOOK;
     }
 
-    /* Xóa sách khỏi danh sách mượn của người dùng */
-    user_status = user_remove_borrowed_book(user, book_id);
-    if (user_status != USER_OK) {
-        return MGMT_ERROR;
+    /* Chỉ duyệt hàng đợi của sách này */
+    if (hold_contains(library->holds, &book->holds, user_id)) {
+        return MGMT_HOLD_EXISTS;
     }
 
-    /* Đánh dấu sách đã được trả */
-    book_status = book_set_borrowed(library->books, book_id, 0);
-    if (book_status != BOOK_OK) {
-        /* Rollback: thêm lại sách vào danh sách mượn của người dùng */
-        user_add_borrowed_book(user, book_id);
+    hold_status = hold_enqueue(library->holds, &book->holds, user_id);
+    if (hold_status == HOLD_FULL) {
+        return MGMT_HOLD_FULL;
+    }
+    if (hold_status != HOLD_OK) {
         return MGMT_ERROR;
     }
 
     return MGMT_OK;
 }
 
+/**
+ * \brief           Đặt giữ sách khi mọi bản sao đang được mượn
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       book_id: ID của sách cần đặt giữ
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_place_hold(library_t* library, uint32_t user_id, uint32_t book_id) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_place_hold_locked(library, user_id, book_id);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_cancel_hold (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_cancel_hold_locked(library_t* library, uint32_t user_id, uint32_t book_id) {
+    book_t* book;
+
+    if (library == NULL || library->books == NULL || library->holds == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    book = book_find_by_id(library->books, book_id);
+    if (book == NULL) {
+        return MGMT_BOOK_NOT_FOUND;
+    }
+
+    if (hold_remove(library->holds, &book->holds, user_id) != HOLD_OK) {
+        return MGMT_HOLD_NOT_FOUND;
+    }
+
+    return MGMT_OK;
+}
+
+/**
+ * \brief           Hủy lượt đặt giữ sách
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       book_id: ID của sách
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_cancel_hold(library_t* library, uint32_t user_id, uint32_t book_id) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_cancel_hold_locked(library, user_id, book_id);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Số người đang đặt giữ một đầu sách, O(1) sau khi tìm thấy sách
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       book_id: ID của sách
+ * \return          Độ dài hàng đợi đặt giữ, 0 nếu không tìm thấy sách
+ */
+size_t
+mgmt_hold_count(const library_t* library, uint32_t book_id) {
+    const book_t* book;
+
+    if (library == NULL || library->books == NULL) {
+        return 0;
+    }
+
+    book = book_find_by_id(library->books, book_id);
+    if (book == NULL) {
+        return 0;
+    }
+
+    return hold_queue_length(&book->holds);
+}
+
+/**
+ * \brief           Xóa toàn bộ dữ liệu thư viện trước khi nạp snapshot
+ *
+ * Observer được giữ lại và các generation của danh sách sách tiếp tục tăng để
+ * cache và chỉ mục không nhầm kết quả cũ với danh sách mới.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+mgmt_reset(library_t* library) {
+    book_observer_fn book_observer;
+    user_observer_fn user_observer;
+    void* book_ctx;
+    void* user_ctx;
+    uint64_t generation;
+    uint64_t catalog_generation;
+
+    /* Pool khối tràn thuộc về danh sách người dùng nên user_init giải phóng luôn */
+    book_observer = library->books->observer;
+    book_ctx = library->books->observer_ctx;
+    user_observer = library->users->observer;
+    user_ctx = library->users->observer_ctx;
+    generation = library->books->generation;
+    catalog_generation = library->books->catalog_generation;
+
+    book_init(library->books);
+    user_init(library->users);
+    if (library->holds != NULL) {
+        hold_pool_init(library->holds);
+    }
+
+    book_set_observer(library->books, book_observer, book_ctx);
+    user_set_observer(library->users, user_observer, user_ctx);
+    library->books->generation = generation + 1;
+    library->books->catalog_generation = catalog_generation + 1;
+
+    /* Danh sách được xóa không qua observer: kho phiên bản ghi nhận việc xóa tại đây */
+    txn_sync(library->txn);
+}
+
+/**
+ * \brief           Phần thân của \ref mgmt_apply_change (gọi khi giữ khóa ghi của kho phiên bản)
+ */
+static mgmt_status_t
+mgmt_apply_change_locked(library_t* library, const cdc_record_t* record) {
+    book_t* book;
+    user_t* user;
+    book_status_t book_status;
+    user_status_t user_status;
+    uint32_t item_key;
+
+    if (library == NULL || library->books == NULL || library->users == NULL || record == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    switch (record->op) {
+        case CDC_OP_SNAPSHOT:
+            mgmt_reset(library);
+            return MGMT_OK;
+
+        case CDC_OP_BOOK_UPSERT:
+            book = book_find_by_id(library->books, record->id);
+            if (book == NULL) {
+                book_status = book_add_with_id(library->books, record->id, record->data.book.title,
+                                               record->data.book.author);
+            } else if (strcmp(book->title, record->data.book.title) != 0
+                       || strcmp(book->author, record->data.book.author) != 0) {
+                book_status = book_update(library->books, record->id, record->data.book.title,
+                                          record->data.book.author);
+            } else {
+                book_status = BOOK_OK;
+            }
+            if (book_status != BOOK_OK) {
+                return MGMT_ERROR;
+            }
+            /* fall through */
+        case CDC_OP_BOOK_AVAILABILITY:
+            book_status = book_restore_copies(library->books, record->id, record->data.book.copy_count,
+                                              record->data.book.available_mask);
+            if (book_status == BOOK_NOT_FOUND) {
+                return MGMT_BOOK_NOT_FOUND;
+            }
+            return (book_status == BOOK_OK) ? MGMT_OK : MGMT_ERROR;
+
+        case CDC_OP_BOOK_DELETE:
+            book_status = book_delete(library->books, record->id);
+            if (book_status == BOOK_NOT_FOUND) {
+                return MGMT_BOOK_NOT_FOUND;
+            }
+            return (book_status == BOOK_OK) ? MGMT_OK : MGMT_ERROR;
+
+        case CDC_OP_USER_UPSERT:
+            user = user_find_by_id(library->users, record->id);
+            if (user == NULL) {
+                user_status = user_add_with_id(library->users, record->id, record->data.user.name);
+            } else if (strcmp(user->name, record->data.user.name) != 0) {
+                user_status = user_update(library->users, record->id, record->data.user.name);
+            } else {
+                user_status = USER_OK;
+            }
+            if (user_status == USER_OK) {
+                user_status = user_set_tier(library->users, record->id, record->data.user.tier);
+            }
+            return (user_status == USER_OK) ? MGMT_OK : MGMT_ERROR;
+
+        case CDC_OP_USER_DELETE:
+            user_status = user_delete(library->users, record->id);
+            if (user_status == USER_NOT_FOUND) {
+                return MGMT_USER_NOT_FOUND;
+            }
+            return (user_status == USER_OK) ? MGMT_OK : MGMT_ERROR;
+
+        case CDC_OP_LOAN:
+        case CDC_OP_RETURN:
+            user = user_find_by_id(library->users, record->id);
+            if (user == NULL) {
+                return MGMT_USER_NOT_FOUND;
+            }
+            item_key = BOOK_ITEM_KEY(record->data.loan.book_id, record->data.loan.copy);
+            if (record->op == CDC_OP_LOAN) {
+                user_status = user_add_borrowed_book(library->users, user, item_key);
+            } else {
+                user_status = user_remove_borrowed_book(library->users, user, item_key);
+            }
+            txn_publish_user(library->txn, record->id);
+            if (user_status == USER_POOL_FULL) {
+                return MGMT_LOAN_POOL_FULL;
+            }
+            return (user_status == USER_OK) ? MGMT_OK : MGMT_ERROR;
+
+        default:
+            return MGMT_INVALID_INPUT;
+    }
+}
+
+/**
+ * \brief           Áp dụng một bản ghi của nhật ký thay đổi (phát lại trên bản sao)
+ *
+ * Bản ghi đã được kiểm tra ở nơi ghi nhật ký nên chỉ lỗi khi bản sao lệch
+ * trạng thái với primary. Hàng đợi đặt giữ không có trong nhật ký.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       record: Bản ghi cần áp dụng
+ * \return          \ref MGMT_OK nếu thành công, \ref mgmt_status_t nếu lỗi
+ */
+mgmt_status_t
+mgmt_apply_change(library_t* library, const cdc_record_t* record) {
+    mgmt_status_t status;
+
+    if (library == NULL) {
+        return MGMT_INVALID_INPUT;
+    }
+
+    txn_lock(library->txn);
+    status = mgmt_apply_change_locked(library, record);
+    txn_unlock(library->txn);
+    return status;
+}
+
+/**
+ * \brief           Tìm kiếm và hiển thị sách theo tiêu đề hoặc tác giả
+ *
+ * Dùng cache của thư viện khi có. Nếu số kết quả vượt quá số vị trí cache
+ * lưu được thì quét lại toàn bộ danh sách (song song nếu có pool quét) để
+ * hiển thị đủ.
+ *
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       query: Chuỗi cần tìm (hỗ trợ tìm kiếm một phần)
+ */
+void
+mgmt_search_books(const library_t* library, query_field_t field, const char* query) {
+    query_result_t result;
+    scan_result_t scanned;
+    const uint32_t* positions;
+    size_t count;
+    size_t i;
+
+    if (library == NULL || library->books == NULL || query == NULL) {
+        return;
+    }
+
+    if (library->cache != NULL
+        && query_cache_search(library->cache, library->books, field, query, &result) == QUERY_CACHE_OK
+        && result.count == result.total) {
+        positions = result.indices;
+        count = result.count;
+    } else if (library->scan != NULL
+               && scan_books_match(library->scan, library->books, field, query, &scanned) == SCAN_OK) {
+        positions = scanned.positions;
+        count = scanned.count;
+    } else {
+        if (field == QUERY_FIELD_TITLE) {
+            book_search_by_title(library->books, query);
+        } else {
+            book_search_by_author(library->books, query);
+        }
+        return;
+    }
+
+    book_display_header();
+    for (i = 0; i < count; i++) {
+        book_display_one(&library->books->books[positions[i]]);
+    }
+
+    if (count == 0) {
+        printf("\n  Không tìm thấy sách nào với %s: %s\n",
+               (field == QUERY_FIELD_TITLE) ? "tiêu đề" : "tác giả", query);
+    } else {
+        printf("\n  Tìm thấy %zu sách\n", count);
+    }
+}
+
+/**
+ * \brief           In danh sách sách xếp theo số lượt mượn
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       ranks: Danh sách đã sắp xếp giảm dần
+ * \param[in]       count: Số phần tử
+ */
+static void
+mgmt_print_ranks(const library_t* library, const history_rank_t* ranks, size_t count) {
+    book_t* book;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        book = book_find_by_id(library->books, ranks[i].book_id);
+        printf("  %2zu. %-10u | %-40s | %u lượt\n", i + 1, ranks[i].book_id,
+               (book != NULL) ? book->title : "(đã xóa)", ranks[i].count);
+    }
+}
+
 /**
  * \brief           Hiển thị thống kê tổng quan của thư viện
  * \param[in]       library: Con trỏ tới cấu trúc thư viện
  */
 void
 mgmt_display_statistics(const library_t* library) {
-    size_t total_books;
-    size_t borrowed_books;
-    size_t available_books;
+    history_rank_t ranks[MGMT_TOP_BOOKS];
+    scan_counts_t counts;
+    notify_metrics_t notices;
     size_t total_users;
+    size_t count;
 
     if (library == NULL || library->books == NULL || library->users == NULL) {
         printf("\n  Lỗi: Dữ liệu thư viện không hợp lệ!\n");
         return;
     }
 
-    total_books = book_count_total(library->books);
-    borrowed_books = book_count_borrowed(library->books);
-    available_books = book_count_available(library->books);
-    total_users = user_count_total(library->users);
+    /* Đọc trên snapshot của kho phiên bản khi có: không chặn mượn/trả và các số khớp nhau */
+    if (library->txn == NULL || txn_read_counts(library->txn, &counts, &total_users) != TXN_OK) {
+        scan_books_count(library->scan, library->books, &counts);
+        total_users = user_count_total(library->users);
+    }
 
     print_header("THỐNG KÊ TỔNG QUAN THƯ VIỆN");
     printf("\n");
-    printf("  Tổng số sách:              %zu\n", total_books);
-    printf("  Số sách đang được mượn:    %zu\n", borrowed_books);
-    printf("  Số sách có sẵn:            %zu\n", available_books);
+    printf("  Tổng số đầu sách:          %zu\n", counts.titles);
+    printf("  Tổng số bản sao:           %zu\n", counts.copies);
+    printf("  Số bản đang được mượn:     %zu\n", counts.borrowed);
+    printf("  Số bản có sẵn:             %zu\n", counts.available);
     printf("  Tổng số người dùng:        %zu\n", total_users);
+
+    /* Sách phổ biến theo top-K cập nhật liên tục, không cần đọc lại lịch sử */
+    if (library->history != NULL) {
+        count = history_popular(library->history, ranks, MGMT_TOP_BOOKS);
+        printf("  Số lượt mượn/trả đã lưu:   %zu\n", history_count(library->history));
+        if (count > 0) {
+            printf("\n  Sách được mượn nhiều nhất (ước lượng):\n");
+            mgmt_print_ranks(library, ranks, count);
+        }
+    }
+
+    /* Số liệu áp lực ngược của hàng đợi thông báo */
+    if (library->notify != NULL) {
+        notify_get_metrics(library->notify, &notices);
+        printf("\n  Thông báo hạn trả/đặt giữ:\n");
+        printf("    Đã nhận / đã gửi:        %llu / %llu (%llu thư, %llu lô, %llu sự kiện được gộp)\n",
+               (unsigned long long)notices.posted, (unsigned long long)notices.delivered,
+               (unsigned long long)notices.messages, (unsigned long long)notices.batches,
+               (unsigned long long)notices.coalesced);
+        printf("    Bị bỏ / phải chờ:        %llu / %llu (hàng đợi sâu nhất %llu/%u)\n",
+               (unsigned long long)notices.dropped, (unsigned long long)notices.blocked,
+               (unsigned long long)notices.max_depth, (unsigned)NOTIFY_QUEUE_CAPACITY);
+        printf("    Lỗi gửi:                 %llu\n", (unsigned long long)notices.sink_errors);
+        printf("    Lâu nhất: đưa vào hàng %.1f µs, gửi một thư %.1f ms\n",
+               (double)notices.max_post_ns / 1000.0, (double)notices.max_sink_ns / 1000000.0);
+    }
     printf("\n");
 }
 
@@ -188,6 +1096,7 @@ void
 mgmt_display_user_books(const library_t* library, uint32_t user_id) {
     user_t* user;
     book_t* book;
+    const uint32_t* items;
     size_t i;
 
     if (library == NULL || library->books == NULL || library->users == NULL) {
@@ -205,21 +1114,24 @@ mgmt_display_user_books(const library_t* library, uint32_t user_id) {
     print_header("THÔNG TIN NGƯỜI DÙNG");
     printf("\n  ID người dùng: %u\n", user->user_id);
     printf("  Tên: %s\n", user->name);
-    printf("  Số sách đang mượn: %zu/%d\n", user->borrowed_count, MAX_BORROWED_BOOKS);
+    printf("  Hạng: %s\n", user_tier_name(user->tier));
+    printf("  Số sách đang mượn: %zu/%zu\n", user->borrowed_count, user_borrow_limit(user));
 
     if (user->borrowed_count > 0) {
         printf("\n  Danh sách sách đang mượn:\n");
         print_separator();
-        printf("  %-10s | %-40s | %-30s\n", "ID", "Tiêu đề", "Tác giả");
+        printf("  %-10s | %-40s | %-30s | %-6s\n", "ID", "Tiêu đề", "Tác giả", "Bản");
         print_separator();
 
+        items = user_borrowed_items(library->users, user);
         for (i = 0; i < user->borrowed_count; i++) {
-            book = book_find_by_id(library->books, user->borrowed_books[i]);
+            book = book_find_by_id(library->books, BOOK_ITEM_BOOK_ID(items[i]));
             if (book != NULL) {
-                printf("  %-10u | %-40s | %-30s\n",
+                printf("  %-10u | %-40s | %-30s | #%-5u\n",
                        book->book_id,
                        book->title,
-                       book->author);
+                       book->author,
+                       (unsigned)BOOK_ITEM_COPY(items[i]) + 1);
             }
         }
     } else {
@@ -228,3 +1140,44 @@ mgmt_display_user_books(const library_t* library, uint32_t user_id) {
     printf("\n");
 }
 
+/**
+ * \brief           Hiển thị số lượt mượn/trả và các sách được mượn nhiều nhất trong một khoảng thời gian
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ * \param[in]       from: Đầu khoảng (giây kể từ epoch)
+ * \param[in]       to: Cuối khoảng (bao gồm)
+ */
+void
+mgmt_display_circulation(const library_t* library, uint32_t from, uint32_t to) {
+    history_rank_t ranks[MGMT_TOP_BOOKS];
+    history_stats_t stats;
+    history_status_t status;
+    size_t count;
+
+    if (library == NULL || library->books == NULL || library->history == NULL) {
+        printf("\n  Lỗi: Lịch sử mượn/trả chưa được bật!\n");
+        return;
+    }
+
+    status = history_range_stats(library->history, from, to, &stats);
+    if (status != HISTORY_OK && status != HISTORY_TRUNCATED) {
+        printf("\n  Lỗi: Khoảng thời gian không hợp lệ!\n");
+        return;
+    }
+
+    print_header("LỊCH SỬ MƯỢN/TRẢ");
+    printf("\n");
+    printf("  Số lượt mượn:              %llu\n", (unsigned long long)stats.loans);
+    printf("  Số lượt trả:               %llu\n", (unsigned long long)stats.returns);
+    printf("  Phân vùng dùng tổng sẵn:   %u\n", stats.partitions_summarized);
+    printf("  Phân vùng đọc từng dòng:   %u\n", stats.partitions_scanned);
+    if (status == HISTORY_TRUNCATED) {
+        printf("  (Các sự kiện cũ hơn đã bị xóa khỏi lịch sử)\n");
+    }
+
+    history_range_top(library->history, from, to, ranks, MGMT_TOP_BOOKS, &count);
+    if (count > 0) {
+        printf("\n  Sách được mượn nhiều nhất:\n");
+        mgmt_print_ranks(library, ranks, count);
+    }
+    printf("\n");
+}
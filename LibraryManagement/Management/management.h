@@ -37,6 +37,13 @@
 #include <stdint.h>
 #include "../Book/book.h"
 #include "../User/user.h"
+#include "../Hold/hold.h"
+#include "../Cache/cache.h"
+#include "../Scan/scan.h"
+#include "../Cdc/cdc.h"
+#include "../History/history.h"
+#include "../Barcode/barcode.h"
+#include "../Notify/notify.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,23 +61,67 @@ typedef enum {
     MGMT_BOOK_ALREADY_BORROWED,                 /*!< Sách đã được mượn */
     MGMT_BOOK_NOT_BORROWED,                     /*!< Sách chưa được mượn */
     MGMT_USER_LIMIT_REACHED,                    /*!< Người dùng đã mượn đủ số sách cho phép */
+    MGMT_USER_ALREADY_HAS_BOOK,                 /*!< Người dùng đã mượn một bản của sách này */
+    MGMT_BOOK_AVAILABLE,                        /*!< Sách còn bản có sẵn, không cần đặt giữ */
+    MGMT_HOLD_EXISTS,                           /*!< Người dùng đã đặt giữ sách này */
+    MGMT_HOLD_NOT_FOUND,                        /*!< Không tìm thấy lượt đặt giữ */
+    MGMT_HOLD_FULL,                             /*!< Pool đặt giữ đã đầy */
+    MGMT_BARCODE_NOT_FOUND,                     /*!< Mã quét chưa được gán cho sách nào */
+    MGMT_BARCODE_EXISTS,                        /*!< Mã đã được gán cho sách hoặc bản sao khác */
+    MGMT_BARCODE_FULL,                          /*!< Chỉ mục mã đã đầy */
+    MGMT_BOOK_RESERVED,                         /*!< Bản sao có sẵn đang dành cho người đặt giữ trước */
+    MGMT_COPY_LIMIT_REACHED,                    /*!< Đầu sách đã đủ số bản sao tối đa */
+    MGMT_LOAN_POOL_FULL,                        /*!< Pool khối tràn của danh sách người dùng đã hết */
 } mgmt_status_t;
 
+/* Khai báo trước kho phiên bản (Txn/txn.h cần library_t nên không include ngược lại) */
+typedef struct txn_store txn_store_t;
+
 /**
  * \brief           Cấu trúc quản lý toàn bộ hệ thống thư viện
  */
 typedef struct {
     book_list_t* books;                         /*!< Con trỏ tới danh sách sách */
     user_list_t* users;                         /*!< Con trỏ tới danh sách người dùng */
+    hold_pool_t* holds;                         /*!< Pool node đặt giữ (NULL = tắt chức năng đặt giữ) */
+    query_cache_t* cache;                       /*!< Cache kết quả tìm kiếm (NULL = luôn quét danh sách) */
+    scan_pool_t* scan;                          /*!< Pool quét song song (NULL = quét tuần tự) */
+    cdc_log_t* cdc;                             /*!< Nhật ký thay đổi nhận các lượt mượn/trả (NULL = tắt) */
+    history_t* history;                         /*!< Lịch sử lưu thông nhận các lượt mượn/trả (NULL = tắt) */
+    barcode_index_t* barcodes;                  /*!< Chỉ mục ISBN/mã vạch (NULL = tắt mượn/trả theo mã) */
+    notify_queue_t* notify;                     /*!< Hàng đợi thông báo hạn trả/sách đặt giữ (NULL = tắt) */
+    txn_store_t* txn;                           /*!< Kho phiên bản nhận mọi thay đổi, khóa của nó tuần tự hóa việc ghi (NULL = tắt) */
 } library_t;
 
 /* Khai báo các hàm quản lý mượn/trả sách */
 mgmt_status_t   mgmt_borrow_book(library_t* library, uint32_t user_id, uint32_t book_id);
 mgmt_status_t   mgmt_return_book(library_t* library, uint32_t user_id, uint32_t book_id);
+mgmt_status_t   mgmt_return_book_handoff(library_t* library, uint32_t user_id, uint32_t book_id,
+                                         uint32_t* handed_to);
+
+/* Khai báo các hàm mượn/trả theo mã quét */
+mgmt_status_t   mgmt_assign_isbn(library_t* library, uint32_t book_id, uint64_t key);
+mgmt_status_t   mgmt_assign_barcode(library_t* library, uint32_t book_id, uint8_t copy, uint64_t key);
+mgmt_status_t   mgmt_borrow_by_barcode(library_t* library, uint32_t user_id, uint64_t key, uint32_t* book_id);
+mgmt_status_t   mgmt_return_by_barcode(library_t* library, uint32_t user_id, uint64_t key,
+                                       uint32_t* handed_to);
+
+/* Khai báo các hàm đặt giữ sách */
+mgmt_status_t   mgmt_add_copies(library_t* library, uint32_t book_id, uint8_t count, uint32_t* handed);
+mgmt_status_t   mgmt_place_hold(library_t* library, uint32_t user_id, uint32_t book_id);
+mgmt_status_t   mgmt_cancel_hold(library_t* library, uint32_t user_id, uint32_t book_id);
+size_t          mgmt_hold_count(const library_t* library, uint32_t book_id);
+
+/* Khai báo các hàm phát lại nhật ký thay đổi */
+mgmt_status_t   mgmt_apply_change(library_t* library, const cdc_record_t* record);
+
+/* Khai báo các hàm tìm kiếm */
+void            mgmt_search_books(const library_t* library, query_field_t field, const char* query);
 
 /* Khai báo các hàm hiển thị thống kê */
 void            mgmt_display_statistics(const library_t* library);
 void            mgmt_display_user_books(const library_t* library, uint32_t user_id);
+void            mgmt_display_circulation(const library_t* library, uint32_t from, uint32_t to);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,598 @@
+/**
+ * \file            notify.c
+ * \brief           Hàng đợi MPSC, dispatcher gom lô theo người dùng và các sink thông báo
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif /* _WIN32 */
+#include "notify.h"
+#include "../Book/book.h"
+
+#define NOTIFY_MASK                 (NOTIFY_QUEUE_CAPACITY - 1)
+#define NOTIFY_WAKE_DEPTH           (NOTIFY_QUEUE_CAPACITY / 2) /*!< Đánh thức dispatcher sớm khi hàng đợi đầy một nửa */
+#define NOTIFY_SECONDS_PER_DAY      86400u
+
+/**
+ * \brief           Thời điểm hiện tại (nano giây, đồng hồ thực)
+ * \return          Số nano giây kể từ epoch
+ */
+static uint64_t
+notify_now_ns(void) {
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief           Nâng giá trị lớn nhất được chia sẻ giữa các luồng
+ * \param[in,out]   max: Giá trị lớn nhất hiện tại
+ * \param[in]       value: Giá trị mới
+ */
+static void
+notify_raise_max(_Atomic uint64_t* max, uint64_t value) {
+    uint64_t current;
+
+    current = atomic_load_explicit(max, memory_order_relaxed);
+    while (value > current
+           && !atomic_compare_exchange_weak_explicit(max, &current, value, memory_order_relaxed,
+                                                     memory_order_relaxed)) {}
+}
+
+/**
+ * \brief           Thử ghi một sự kiện vào ô trống kế tiếp
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \param[in]       event: Sự kiện
+ * \param[out]      position: Vị trí đã ghi
+ * \return          1 nếu ghi được, 0 nếu hàng đợi đầy
+ */
+static uint8_t
+notify_try_enqueue(notify_queue_t* queue, const notify_event_t* event, uint64_t* position) {
+    notify_slot_t* slot;
+    uint64_t pos;
+    uint64_t sequence;
+
+    pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    while (1) {
+        slot = &queue->slots[pos & NOTIFY_MASK];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence == pos) {
+            /* Ô trống: giành vị trí, thất bại thì pos được nạp lại */
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < pos) {
+            /* Ô vẫn giữ sự kiện của vòng trước: hàng đợi đầy */
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->event = *event;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    *position = pos;
+    return 1;
+}
+
+/**
+ * \brief           Lấy tối đa \ref NOTIFY_BATCH_MAX sự kiện vào bộ đệm lô
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \return          Số sự kiện đã lấy
+ */
+static size_t
+notify_drain(notify_queue_t* queue) {
+    notify_slot_t* slot;
+    uint64_t head;
+    size_t count;
+
+    head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    for (count = 0; count < NOTIFY_BATCH_MAX; count++) {
+        slot = &queue->slots[head & NOTIFY_MASK];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != head + 1) {
+            break;
+        }
+        queue->batch[count] = slot->event;
+        atomic_store_explicit(&slot->sequence, head + NOTIFY_QUEUE_CAPACITY, memory_order_release);
+        head++;
+    }
+    atomic_store_explicit(&queue->head, head, memory_order_release);
+    return count;
+}
+
+/**
+ * \brief           So sánh hai sự kiện theo người dùng rồi theo thời gian
+ */
+static int
+notify_event_compare(const void* a, const void* b) {
+    const notify_event_t* left;
+    const notify_event_t* right;
+
+    left = a;
+    right = b;
+    if (left->user_id != right->user_id) {
+        return (left->user_id < right->user_id) ? -1 : 1;
+    }
+    if (left->time != right->time) {
+        return (left->time < right->time) ? -1 : 1;
+    }
+    if (left->item_key != right->item_key) {
+        return (left->item_key < right->item_key) ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * \brief           Gộp lô theo người dùng và gửi từng thông báo cho sink
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \param[in]       count: Số sự kiện trong lô
+ */
+static void
+notify_deliver(notify_queue_t* queue, size_t count) {
+    notify_message_t message;
+    notify_status_t status;
+    uint64_t started;
+    size_t first;
+    size_t last;
+
+    qsort(queue->batch, count, sizeof(queue->batch[0]), notify_event_compare);
+    for (first = 0; first < count; first = last) {
+        last = first + 1;
+        while (last < count && queue->batch[last].user_id == queue->batch[first].user_id) {
+            last++;
+        }
+
+        message.user_id = queue->batch[first].user_id;
+        message.events = &queue->batch[first];
+        message.count = last - first;
+        started = notify_now_ns();
+        status = queue->sink(&message, queue->sink_ctx);
+        notify_raise_max(&queue->max_sink_ns, notify_now_ns() - started);
+
+        if (status != NOTIFY_OK) {
+            atomic_fetch_add_explicit(&queue->sink_errors, 1, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&queue->messages, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&queue->delivered, message.count, memory_order_relaxed);
+        atomic_fetch_add_explicit(&queue->coalesced, message.count - 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&queue->batches, 1, memory_order_relaxed);
+}
+
+/**
+ * \brief           Vòng lặp của luồng dispatcher
+ *
+ * Mỗi vòng lấy một lô và gửi đi; khi lô chưa đầy thì ngủ một cửa sổ
+ * \ref NOTIFY_BATCH_MS để các sự kiện kế tiếp được gom chung. Khi được yêu
+ * cầu dừng, gửi nốt mọi sự kiện còn trong hàng đợi rồi thoát.
+ *
+ * \param[in,out]   arg: Con trỏ tới hàng đợi
+ * \return          Luôn NULL
+ */
+static void*
+notify_thread_main(void* arg) {
+    notify_queue_t* queue;
+    struct timespec deadline;
+    size_t count;
+
+    queue = arg;
+    while (1) {
+        count = notify_drain(queue);
+        if (count > 0) {
+            notify_deliver(queue, count);
+        }
+        if (count == NOTIFY_BATCH_MAX) {
+            continue;
+        }
+        if (atomic_load_explicit(&queue->stop, memory_order_acquire)) {
+            if (count == 0) {
+                break;
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&queue->lock);
+        if (!atomic_load_explicit(&queue->stop, memory_order_relaxed)) {
+            timespec_get(&deadline, TIME_UTC);
+            deadline.tv_nsec += (long)NOTIFY_BATCH_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+                deadline.tv_nsec %= 1000000000L;
+            }
+            pthread_cond_timedwait(&queue->wake, &queue->lock, &deadline);
+        }
+        pthread_mutex_unlock(&queue->lock);
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Khởi tạo hàng đợi và chạy luồng dispatcher
+ * \param[out]      queue: Con trỏ tới hàng đợi
+ * \param[in]       policy: Cách xử lý khi hàng đợi đầy
+ * \param[in]       sink: Nơi nhận thông báo
+ * \param[in]       sink_ctx: Ngữ cảnh của sink
+ * \return          \ref NOTIFY_OK nếu thành công
+ */
+notify_status_t
+notify_init(notify_queue_t* queue, notify_policy_t policy, notify_sink_fn sink, void* sink_ctx) {
+    size_t i;
+
+    if (queue == NULL || sink == NULL || policy > NOTIFY_POLICY_BLOCK) {
+        return NOTIFY_INVALID_INPUT;
+    }
+
+    for (i = 0; i < NOTIFY_QUEUE_CAPACITY; i++) {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->posted, 0);
+    atomic_init(&queue->dropped, 0);
+    atomic_init(&queue->blocked, 0);
+    atomic_init(&queue->max_depth, 0);
+    atomic_init(&queue->max_post_ns, 0);
+    atomic_init(&queue->batches, 0);
+    atomic_init(&queue->messages, 0);
+    atomic_init(&queue->delivered, 0);
+    atomic_init(&queue->coalesced, 0);
+    atomic_init(&queue->sink_errors, 0);
+    atomic_init(&queue->max_sink_ns, 0);
+    atomic_init(&queue->stop, 0);
+    queue->policy = policy;
+    queue->sink = sink;
+    queue->sink_ctx = sink_ctx;
+    queue->running = 0;
+
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->wake, NULL);
+    if (pthread_create(&queue->thread, NULL, notify_thread_main, queue) != 0) {
+        pthread_cond_destroy(&queue->wake);
+        pthread_mutex_destroy(&queue->lock);
+        return NOTIFY_ERROR;
+    }
+    queue->running = 1;
+    return NOTIFY_OK;
+}
+
+/**
+ * \brief           Gửi nốt các sự kiện còn lại và dừng dispatcher
+ *
+ * Chỉ gọi khi không còn luồng nào gọi \ref notify_post.
+ *
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ */
+void
+notify_destroy(notify_queue_t* queue) {
+    if (queue == NULL || !queue->running) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    atomic_store_explicit(&queue->stop, 1, memory_order_release);
+    pthread_cond_signal(&queue->wake);
+    pthread_mutex_unlock(&queue->lock);
+    pthread_join(queue->thread, NULL);
+
+    pthread_cond_destroy(&queue->wake);
+    pthread_mutex_destroy(&queue->lock);
+    queue->running = 0;
+}
+
+/**
+ * \brief           Đưa một sự kiện vào hàng đợi
+ *
+ * Không khóa và không gọi sink: chi phí trên luồng mượn/trả là một CAS và
+ * một lần chép sự kiện, bất kể sink chậm tới đâu. Khi hàng đợi đầy,
+ * \ref NOTIFY_POLICY_DROP bỏ sự kiện còn \ref NOTIFY_POLICY_BLOCK chờ
+ * dispatcher giải phóng ô.
+ *
+ * \param[in,out]   queue: Con trỏ tới hàng đợi
+ * \param[in]       event: Sự kiện
+ * \return          \ref NOTIFY_OK, \ref NOTIFY_DROPPED nếu bị bỏ
+ */
+notify_status_t
+notify_post_event(notify_queue_t* queue, const notify_event_t* event) {
+    struct timespec pause;
+    uint64_t started;
+    uint64_t position;
+    uint64_t depth;
+    uint8_t waited;
+
+    if (queue == NULL || event == NULL || !queue->running) {
+        return NOTIFY_INVALID_INPUT;
+    }
+
+    started = notify_now_ns();
+    waited = 0;
+    while (!notify_try_enqueue(queue, event, &position)) {
+        if (queue->policy == NOTIFY_POLICY_DROP || atomic_load_explicit(&queue->stop, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return NOTIFY_DROPPED;
+        }
+        if (!waited) {
+            atomic_fetch_add_explicit(&queue->blocked, 1, memory_order_relaxed);
+            pthread_cond_signal(&queue->wake);
+            waited = 1;
+        }
+        pause.tv_sec = 0;
+        pause.tv_nsec = NOTIFY_BLOCK_SLEEP_NS;
+        nanosleep(&pause, NULL);
+    }
+
+    atomic_fetch_add_explicit(&queue->posted, 1, memory_order_relaxed);
+    depth = position + 1 - atomic_load_explicit(&queue->head, memory_order_relaxed);
+    notify_raise_max(&queue->max_depth, depth);
+    if (depth == NOTIFY_WAKE_DEPTH) {
+        /* Không giữ khóa: nếu lỡ tín hiệu, dispatcher vẫn thức dậy sau cửa sổ gom lô */
+        pthread_cond_signal(&queue->wake);
+    }
+    notify_raise_max(&queue->max_post_ns, notify_now_ns() - started);
+    return NOTIFY_OK;
+}
+
+/**
+ * \brief           Tạo sự kiện cho một bản sao vừa được mượn và đưa vào hàng đợi
+ * \param[in,out]   queue: Con trỏ tới hàng đợi (NULL = tắt thông báo)
+ * \param[in]       kind: Loại thông báo
+ * \param[in]       user_id: Người nhận
+ * \param[in]       item_key: Khóa item của bản sao
+ * \return          \ref NOTIFY_OK, \ref NOTIFY_DROPPED nếu bị bỏ
+ */
+notify_status_t
+notify_post(notify_queue_t* queue, notify_kind_t kind, uint32_t user_id, uint32_t item_key) {
+    notify_event_t event;
+
+    if (queue == NULL || kind > NOTIFY_HOLD_READY) {
+        return NOTIFY_INVALID_INPUT;
+    }
+
+    event.time = (uint32_t)time(NULL);
+    event.due = event.time + NOTIFY_LOAN_DAYS * NOTIFY_SECONDS_PER_DAY;
+    event.user_id = user_id;
+    event.item_key = item_key;
+    event.kind = (uint8_t)kind;
+    return notify_post_event(queue, &event);
+}
+
+/**
+ * \brief           Đọc số liệu hiện tại của hàng đợi
+ * \param[in]       queue: Con trỏ tới hàng đợi
+ * \param[out]      metrics: Số liệu
+ */
+void
+notify_get_metrics(const notify_queue_t* queue, notify_metrics_t* metrics) {
+    notify_queue_t* shared;
+
+    if (metrics == NULL) {
+        return;
+    }
+    memset(metrics, 0, sizeof(*metrics));
+    if (queue == NULL) {
+        return;
+    }
+
+    /* Các bộ đếm là atomic nên đọc được khi dispatcher đang chạy */
+    shared = (notify_queue_t*)queue;
+    metrics->posted = atomic_load_explicit(&shared->posted, memory_order_relaxed);
+    metrics->dropped = atomic_load_explicit(&shared->dropped, memory_order_relaxed);
+    metrics->blocked = atomic_load_explicit(&shared->blocked, memory_order_relaxed);
+    metrics->max_depth = atomic_load_explicit(&shared->max_depth, memory_order_relaxed);
+    metrics->max_post_ns = atomic_load_explicit(&shared->max_post_ns, memory_order_relaxed);
+    metrics->batches = atomic_load_explicit(&shared->batches, memory_order_relaxed);
+    metrics->messages = atomic_load_explicit(&shared->messages, memory_order_relaxed);
+    metrics->delivered = atomic_load_explicit(&shared->delivered, memory_order_relaxed);
+    metrics->coalesced = atomic_load_explicit(&shared->coalesced, memory_order_relaxed);
+    metrics->sink_errors = atomic_load_explicit(&shared->sink_errors, memory_order_relaxed);
+    metrics->max_sink_ns = atomic_load_explicit(&shared->max_sink_ns, memory_order_relaxed);
+}
+
+/**
+ * \brief           Đổi số giây kể từ epoch thành ngày tháng năm (UTC)
+ *
+ * Tự tính thay vì gọi gmtime vì chạy trên luồng dispatcher.
+ *
+ * \param[in]       seconds: Số giây kể từ epoch
+ * \param[out]      year: Năm
+ * \param[out]      month: Tháng (1-12)
+ * \param[out]      day: Ngày (1-31)
+ */
+static void
+notify_civil_date(uint32_t seconds, uint32_t* year, uint32_t* month, uint32_t* day) {
+    uint32_t days;
+    uint32_t era;
+    uint32_t doe;
+    uint32_t yoe;
+    uint32_t doy;
+    uint32_t mp;
+
+    /* Lịch Gregory tính từ 0000-03-01 để năm nhuận rơi vào cuối năm */
+    days = seconds / NOTIFY_SECONDS_PER_DAY + 719468u;
+    era = days / 146097u;
+    doe = days - era * 146097u;
+    yoe = (doe - doe / 1460u + doe / 36524u - doe / 146096u) / 365u;
+    doy = doe - (365u * yoe + yoe / 4u - yoe / 100u);
+    mp = (5u * doy + 2u) / 153u;
+    *day = doy - (153u * mp + 2u) / 5u + 1u;
+    *month = (mp < 10u) ? mp + 3u : mp - 9u;
+    *year = yoe + era * 400u + ((*month <= 2u) ? 1u : 0u);
+}
+
+/**
+ * \brief           Định dạng thông báo thành văn bản gửi cho người dùng
+ * \param[in]       message: Thông báo
+ * \param[out]      buf: Bộ đệm nhận văn bản
+ * \param[in]       size: Kích thước bộ đệm
+ * \return          Độ dài văn bản (bị cắt nếu vượt \p size)
+ */
+size_t
+notify_format(const notify_message_t* message, char* buf, size_t size) {
+    const notify_event_t* event;
+    uint32_t year;
+    uint32_t month;
+    uint32_t day;
+    size_t length;
+    size_t i;
+    int written;
+
+    if (message == NULL || buf == NULL || size == 0) {
+        return 0;
+    }
+
+    written = snprintf(buf, size, "Người dùng #%u: %zu thông báo\n", message->user_id, message->count);
+    length = (written > 0) ? (size_t)written : 0;
+    for (i = 0; i < message->count && length < size; i++) {
+        event = &message->events[i];
+        notify_civil_date(event->due, &year, &month, &day);
+        written = snprintf(buf + length, size - length,
+                           (event->kind == NOTIFY_HOLD_READY)
+                               ? "  - Sách đặt giữ #%u (bản sao #%u) đã được chuyển cho bạn, hạn trả %04u-%02u-%02u\n"
+                               : "  - Đã mượn sách #%u (bản sao #%u), hạn trả %04u-%02u-%02u\n",
+                           BOOK_ITEM_BOOK_ID(event->item_key), (unsigned)BOOK_ITEM_COPY(event->item_key) + 1,
+                           year, month, day);
+        if (written < 0) {
+            break;
+        }
+        length += (size_t)written;
+    }
+    return (length < size) ? length : size - 1;
+}
+
+/**
+ * \brief           Sink ghi thông báo vào file (thay cho cổng gửi thư)
+ * \param[in]       message: Thông báo
+ * \param[in,out]   ctx: FILE* đang mở để ghi
+ * \return          \ref NOTIFY_OK nếu ghi được
+ */
+notify_status_t
+notify_file_sink(const notify_message_t* message, void* ctx) {
+    char text[NOTIFY_TEXT_LENGTH];
+    size_t length;
+    FILE* out;
+
+    out = ctx;
+    if (out == NULL) {
+        return NOTIFY_INVALID_INPUT;
+    }
+
+    length = notify_format(message, text, sizeof(text));
+    if (fwrite(text, 1, length, out) != length || fflush(out) != 0) {
+        return NOTIFY_ERROR;
+    }
+    return NOTIFY_OK;
+}
+
+/**
+ * \brief           Mở socket datagram gửi tới cổng gửi thư
+ * \param[out]      sock: Sink cần mở
+ * \param[in]       path: Đường dẫn UNIX socket của bên nhận
+ * \return          \ref NOTIFY_OK nếu thành công
+ */
+notify_status_t
+notify_socket_open(notify_socket_t* sock, const char* path) {
+    if (sock == NULL) {
+        return NOTIFY_INVALID_INPUT;
+    }
+    sock->fd = -1;
+    if (path == NULL || strlen(path) >= sizeof(sock->path)) {
+        return NOTIFY_INVALID_INPUT;
+    }
+    strcpy(sock->path, path);
+
+#ifdef _WIN32
+    return NOTIFY_ERROR;
+#else
+    sock->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    return (sock->fd >= 0) ? NOTIFY_OK : NOTIFY_ERROR;
+#endif /* _WIN32 */
+}
+
+/**
+ * \brief           Đóng socket của sink
+ * \param[in,out]   sock: Sink cần đóng
+ */
+void
+notify_socket_close(notify_socket_t* sock) {
+    if (sock == NULL || sock->fd < 0) {
+        return;
+    }
+#ifndef _WIN32
+    close(sock->fd);
+#endif /* _WIN32 */
+    sock->fd = -1;
+}
+
+/**
+ * \brief           Sink gửi mỗi thông báo thành một datagram
+ *
+ * Bên nhận chưa chạy hoặc đầy bộ đệm thì sendto báo lỗi ngay (không chặn),
+ * thông báo được đếm vào \ref notify_metrics_t::sink_errors.
+ *
+ * \param[in]       message: Thông báo
+ * \param[in,out]   ctx: Con trỏ tới \ref notify_socket_t đã mở
+ * \return          \ref NOTIFY_OK nếu gửi được
+ */
+notify_status_t
+notify_socket_sink(const notify_message_t* message, void* ctx) {
+    notify_socket_t* sock;
+    char text[NOTIFY_TEXT_LENGTH];
+    size_t length;
+#ifndef _WIN32
+    struct sockaddr_un address;
+#endif /* _WIN32 */
+
+    sock = ctx;
+    if (sock == NULL || sock->fd < 0) {
+        return NOTIFY_INVALID_INPUT;
+    }
+    length = notify_format(message, text, sizeof(text));
+
+#ifdef _WIN32
+    (void)length;
+    return NOTIFY_ERROR;
+#else
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, sock->path, strlen(sock->path));
+    if (sendto(sock->fd, text, length, MSG_DONTWAIT, (const struct sockaddr*)&address, sizeof(address)) < 0) {
+        return NOTIFY_ERROR;
+    }
+    return NOTIFY_OK;
+#endif /* _WIN32 */
+}
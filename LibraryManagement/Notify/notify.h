@@ -0,0 +1,200 @@
+/**
+ * \file            notify.h
+ * \brief           Khai báo hàng đợi thông báo bất đồng bộ (hạn trả, sách đặt giữ đã sẵn sàng)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef NOTIFY_HDR_H
+#define NOTIFY_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define NOTIFY_QUEUE_CAPACITY       4096        /*!< Số ô của hàng đợi (lũy thừa của 2) */
+#define NOTIFY_BATCH_MAX            256         /*!< Số sự kiện tối đa mỗi lô gửi */
+#define NOTIFY_BATCH_MS             50          /*!< Cửa sổ gom lô: dispatcher thức dậy sau mỗi khoảng này */
+#define NOTIFY_BLOCK_SLEEP_NS       100000      /*!< Thời gian chờ giữa hai lần thử khi hàng đợi đầy (\ref NOTIFY_POLICY_BLOCK) */
+#define NOTIFY_LOAN_DAYS            14          /*!< Thời hạn mượn dùng để tính ngày phải trả */
+#define NOTIFY_CACHE_LINE           64          /*!< Kích thước cache line */
+#define NOTIFY_PATH_LENGTH          108         /*!< Độ dài tối đa đường dẫn UNIX socket (sun_path) */
+#define NOTIFY_TEXT_LENGTH          4096        /*!< Kích thước tối đa một thông báo đã định dạng */
+#define NOTIFY_ENV                  "LIBRARY_NOTIFY" /*!< Biến môi trường chọn sink: đường dẫn file hoặc unix:<socket> */
+#define NOTIFY_SOCKET_PREFIX        "unix:"     /*!< Tiền tố chọn sink UNIX socket */
+
+/**
+ * \brief           Trạng thái trả về của các hàm thông báo
+ */
+typedef enum {
+    NOTIFY_OK = 0,                              /*!< Thành công */
+    NOTIFY_ERROR,                               /*!< Lỗi chung (không tạo được luồng, sink lỗi, ...) */
+    NOTIFY_INVALID_INPUT,                       /*!< Dữ liệu đầu vào không hợp lệ */
+    NOTIFY_DROPPED,                             /*!< Hàng đợi đầy, sự kiện bị bỏ (\ref NOTIFY_POLICY_DROP) */
+} notify_status_t;
+
+/**
+ * \brief           Loại thông báo
+ */
+typedef enum {
+    NOTIFY_DUE_DATE = 0,                        /*!< Xác nhận mượn kèm ngày phải trả */
+    NOTIFY_HOLD_READY,                          /*!< Sách đặt giữ đã được chuyển cho người dùng */
+} notify_kind_t;
+
+/**
+ * \brief           Cách xử lý khi hàng đợi đầy
+ */
+typedef enum {
+    NOTIFY_POLICY_DROP = 0,                     /*!< Bỏ sự kiện mới, đếm vào \ref notify_metrics_t::dropped (không bao giờ chặn mượn/trả) */
+    NOTIFY_POLICY_BLOCK,                        /*!< Chờ tới khi dispatcher giải phóng ô (áp lực ngược) */
+} notify_policy_t;
+
+/**
+ * \brief           Một sự kiện cần thông báo
+ */
+typedef struct {
+    uint32_t time;                              /*!< Thời điểm phát sinh (giây kể từ epoch) */
+    uint32_t due;                               /*!< Ngày phải trả (\ref NOTIFY_DUE_DATE), 0 nếu không có */
+    uint32_t user_id;                           /*!< Người nhận */
+    uint32_t item_key;                          /*!< Khóa item của bản sao (\ref BOOK_ITEM_KEY) */
+    uint8_t kind;                               /*!< \ref notify_kind_t */
+} notify_event_t;
+
+/**
+ * \brief           Một thông báo gửi cho sink: mọi sự kiện của cùng người dùng trong một lô
+ */
+typedef struct {
+    uint32_t user_id;                           /*!< Người nhận */
+    const notify_event_t* events;               /*!< Các sự kiện theo thứ tự thời gian */
+    size_t count;                               /*!< Số sự kiện */
+} notify_message_t;
+
+/**
+ * \brief           Hàm gửi một thông báo (chạy trên luồng dispatcher)
+ * \param[in]       message: Thông báo đã gộp
+ * \param[in,out]   ctx: Ngữ cảnh đăng ký cùng sink
+ * \return          \ref NOTIFY_OK nếu gửi được
+ */
+typedef notify_status_t (*notify_sink_fn)(const notify_message_t* message, void* ctx);
+
+/**
+ * \brief           Một ô của hàng đợi
+ *
+ * \ref sequence bằng vị trí ghi khi ô trống và bằng vị trí + 1 khi đã có dữ
+ * liệu, nên người ghi và dispatcher không cần khóa.
+ */
+typedef struct {
+    _Atomic uint64_t sequence;                  /*!< Số thứ tự trạng thái của ô */
+    notify_event_t event;                       /*!< Dữ liệu */
+} notify_slot_t;
+
+/**
+ * \brief           Số liệu của hàng đợi và dispatcher
+ */
+typedef struct {
+    uint64_t posted;                            /*!< Số sự kiện đã vào hàng đợi */
+    uint64_t dropped;                           /*!< Số sự kiện bị bỏ vì hàng đợi đầy */
+    uint64_t blocked;                           /*!< Số lần người ghi phải chờ vì hàng đợi đầy */
+    uint64_t max_depth;                         /*!< Số sự kiện chờ gửi lớn nhất từng thấy */
+    uint64_t max_post_ns;                       /*!< Thời gian \ref notify_post lâu nhất */
+    uint64_t batches;                           /*!< Số lô đã gửi */
+    uint64_t messages;                          /*!< Số thông báo đã gửi cho sink */
+    uint64_t delivered;                         /*!< Số sự kiện đã gửi */
+    uint64_t coalesced;                         /*!< Số sự kiện được gộp vào thông báo của sự kiện khác */
+    uint64_t sink_errors;                       /*!< Số thông báo sink báo lỗi */
+    uint64_t max_sink_ns;                       /*!< Thời gian sink xử lý một thông báo lâu nhất */
+} notify_metrics_t;
+
+/**
+ * \brief           Hàng đợi nhiều người ghi, một người đọc và luồng dispatcher
+ *
+ * \ref notify_post chỉ ghi vào một ô của vòng đệm nên mượn/trả không chờ sink.
+ * Dispatcher thức dậy sau mỗi \ref NOTIFY_BATCH_MS, lấy tối đa
+ * \ref NOTIFY_BATCH_MAX sự kiện, gộp theo người dùng rồi gửi cho sink.
+ */
+typedef struct {
+    notify_slot_t slots[NOTIFY_QUEUE_CAPACITY]; /*!< Vòng đệm */
+    _Alignas(NOTIFY_CACHE_LINE) _Atomic uint64_t tail; /*!< Vị trí ghi kế tiếp (người ghi) */
+    _Alignas(NOTIFY_CACHE_LINE) _Atomic uint64_t head; /*!< Vị trí đọc kế tiếp (chỉ dispatcher ghi) */
+    _Alignas(NOTIFY_CACHE_LINE) _Atomic uint64_t posted; /*!< \ref notify_metrics_t::posted */
+    _Atomic uint64_t dropped;                   /*!< \ref notify_metrics_t::dropped */
+    _Atomic uint64_t blocked;                   /*!< \ref notify_metrics_t::blocked */
+    _Atomic uint64_t max_depth;                 /*!< \ref notify_metrics_t::max_depth */
+    _Atomic uint64_t max_post_ns;               /*!< \ref notify_metrics_t::max_post_ns */
+    _Alignas(NOTIFY_CACHE_LINE) _Atomic uint64_t batches; /*!< \ref notify_metrics_t::batches */
+    _Atomic uint64_t messages;                  /*!< \ref notify_metrics_t::messages */
+    _Atomic uint64_t delivered;                 /*!< \ref notify_metrics_t::delivered */
+    _Atomic uint64_t coalesced;                 /*!< \ref notify_metrics_t::coalesced */
+    _Atomic uint64_t sink_errors;               /*!< \ref notify_metrics_t::sink_errors */
+    _Atomic uint64_t max_sink_ns;               /*!< \ref notify_metrics_t::max_sink_ns */
+    notify_policy_t policy;                     /*!< Cách xử lý khi đầy */
+    notify_sink_fn sink;                        /*!< Nơi nhận thông báo */
+    void* sink_ctx;                             /*!< Ngữ cảnh của sink */
+    notify_event_t batch[NOTIFY_BATCH_MAX];     /*!< Bộ đệm lô của dispatcher */
+    pthread_t thread;                           /*!< Luồng dispatcher */
+    pthread_mutex_t lock;                       /*!< Bảo vệ \ref wake khi dừng */
+    pthread_cond_t wake;                        /*!< Đánh thức dispatcher sớm khi dừng */
+    _Atomic uint8_t stop;                       /*!< 1 = dispatcher gửi nốt rồi thoát */
+    uint8_t running;                            /*!< 1 khi luồng dispatcher đang chạy */
+} notify_queue_t;
+
+/**
+ * \brief           Sink gửi mỗi thông báo thành một datagram tới UNIX socket
+ */
+typedef struct {
+    int fd;                                     /*!< Socket datagram (-1 = chưa mở) */
+    char path[NOTIFY_PATH_LENGTH];              /*!< Đường dẫn socket của cổng gửi thư */
+} notify_socket_t;
+
+/* Khai báo các hàm hàng đợi */
+notify_status_t notify_init(notify_queue_t* queue, notify_policy_t policy, notify_sink_fn sink, void* sink_ctx);
+void            notify_destroy(notify_queue_t* queue);
+notify_status_t notify_post(notify_queue_t* queue, notify_kind_t kind, uint32_t user_id, uint32_t item_key);
+notify_status_t notify_post_event(notify_queue_t* queue, const notify_event_t* event);
+void            notify_get_metrics(const notify_queue_t* queue, notify_metrics_t* metrics);
+
+/* Khai báo các sink có sẵn */
+size_t          notify_format(const notify_message_t* message, char* buf, size_t size);
+notify_status_t notify_file_sink(const notify_message_t* message, void* ctx);
+notify_status_t notify_socket_open(notify_socket_t* sock, const char* path);
+void            notify_socket_close(notify_socket_t* sock);
+notify_status_t notify_socket_sink(const notify_message_t* message, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* NOTIFY_HDR_H */
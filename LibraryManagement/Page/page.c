@@ -0,0 +1,1027 @@
+/**
+ * \file            page.c
+ * \brief           Kho sách dạng trang: buffer pool thay trang theo clock, ghim trang, đọc trước khi quét
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "page.h"
+#include "../Ultils/utils.h"
+
+/* Định nghĩa các hằng số */
+#define PAGE_HASH_MULTIPLIER        2654435761u /* Hệ số băm Fibonacci cho ID */
+#define PAGE_MIN_DIRECTORY          1024        /* Số ô thư mục ban đầu */
+
+_Static_assert(sizeof(page_data_t) <= PAGE_SIZE, "page_data_t phải vừa một trang");
+_Static_assert(sizeof(page_file_header_t) <= PAGE_SIZE, "Phần đầu file phải vừa một trang");
+
+/**
+ * \brief           Dữ liệu của một frame
+ * \param[in]       store: Kho trang
+ * \param[in]       frame: Chỉ số frame
+ * \return          Con trỏ tới trang dữ liệu trong pool
+ */
+static page_data_t*
+page_frame_data(const page_store_t* store, uint32_t frame) {
+    return (page_data_t*)&store->memory[(size_t)frame * PAGE_SIZE];
+}
+
+/**
+ * \brief           Ô bắt đầu dò của một ID trong thư mục
+ * \param[in]       store: Kho trang
+ * \param[in]       book_id: ID sách
+ * \return          Chỉ số ô
+ */
+static size_t
+page_dir_home(const page_store_t* store, uint32_t book_id) {
+    return (size_t)(book_id * PAGE_HASH_MULTIPLIER) & (store->dir_capacity - 1);
+}
+
+/**
+ * \brief           Tìm mục thư mục của một ID
+ * \param[in]       store: Kho trang
+ * \param[in]       book_id: ID sách
+ * \return          Con trỏ tới mục, NULL nếu không có
+ */
+static page_dir_entry_t*
+page_dir_find(const page_store_t* store, uint32_t book_id) {
+    size_t slot;
+
+    if (book_id == 0) {
+        return NULL;
+    }
+    slot = page_dir_home(store, book_id);
+    while (store->directory[slot].book_id != 0) {
+        if (store->directory[slot].book_id == book_id) {
+            return &store->directory[slot];
+        }
+        slot = (slot + 1) & (store->dir_capacity - 1);
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Ghi một mục vào thư mục (đã chắc chắn còn chỗ)
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID sách
+ * \param[in]       location: Vị trí bản ghi
+ */
+static void
+page_dir_put(page_store_t* store, uint32_t book_id, uint32_t location) {
+    size_t slot;
+
+    slot = page_dir_home(store, book_id);
+    while (store->directory[slot].book_id != 0) {
+        slot = (slot + 1) & (store->dir_capacity - 1);
+    }
+    store->directory[slot].book_id = book_id;
+    store->directory[slot].location = location;
+}
+
+/**
+ * \brief           Đảm bảo thư mục chứa thêm được một sách với hệ số tải <= 1/2
+ * \param[in,out]   store: Kho trang
+ * \param[in]       count: Số sách đang có trong thư mục
+ * \return          \ref PAGE_OK nếu thành công, \ref PAGE_NO_MEMORY nếu hết bộ nhớ
+ */
+static page_status_t
+page_dir_reserve(page_store_t* store, uint64_t count) {
+    page_dir_entry_t* old;
+    size_t old_capacity;
+    size_t i;
+
+    if ((count + 1) * 2 <= store->dir_capacity) {
+        return PAGE_OK;
+    }
+
+    old = store->directory;
+    old_capacity = store->dir_capacity;
+    store->directory = calloc(old_capacity * 2, sizeof(page_dir_entry_t));
+    if (store->directory == NULL) {
+        store->directory = old;
+        return PAGE_NO_MEMORY;
+    }
+    store->dir_capacity = old_capacity * 2;
+    for (i = 0; i < old_capacity; i++) {
+        if (old[i].book_id != 0) {
+            page_dir_put(store, old[i].book_id, old[i].location);
+        }
+    }
+    free(old);
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Xóa một mục khỏi thư mục, dời các mục phía sau để chuỗi dò không bị đứt
+ * \param[in,out]   store: Kho trang
+ * \param[in,out]   entry: Mục cần xóa
+ */
+static void
+page_dir_remove(page_store_t* store, page_dir_entry_t* entry) {
+    size_t mask;
+    size_t hole;
+    size_t next;
+    size_t home;
+
+    mask = store->dir_capacity - 1;
+    hole = (size_t)(entry - store->directory);
+    next = hole;
+    while (1) {
+        next = (next + 1) & mask;
+        if (store->directory[next].book_id == 0) {
+            break;
+        }
+        /* Chỉ dời mục về lỗ nếu vị trí gốc của nó không nằm giữa lỗ và chỗ hiện tại */
+        home = page_dir_home(store, store->directory[next].book_id);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            store->directory[hole] = store->directory[next];
+            hole = next;
+        }
+    }
+    store->directory[hole].book_id = 0;
+    store->directory[hole].location = 0;
+}
+
+/**
+ * \brief           Đảm bảo bảng trang -> frame đủ cho \p pages trang
+ * \param[in,out]   store: Kho trang
+ * \param[in]       pages: Số trang cần có
+ * \return          \ref PAGE_OK nếu thành công, \ref PAGE_NO_MEMORY nếu hết bộ nhớ
+ */
+static page_status_t
+page_reserve_pages(page_store_t* store, uint32_t pages) {
+    uint32_t* grown;
+    uint32_t capacity;
+
+    if (pages <= store->page_capacity) {
+        return PAGE_OK;
+    }
+    capacity = (store->page_capacity == 0) ? 64 : store->page_capacity;
+    while (capacity < pages) {
+        capacity *= 2;
+    }
+    grown = realloc(store->page_frames, (size_t)capacity * sizeof(uint32_t));
+    if (grown == NULL) {
+        return PAGE_NO_MEMORY;
+    }
+    memset(&grown[store->page_capacity], 0, (size_t)(capacity - store->page_capacity) * sizeof(uint32_t));
+    store->page_frames = grown;
+    store->page_capacity = capacity;
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Ghi trang của một frame xuống đĩa
+ * \param[in,out]   store: Kho trang
+ * \param[in]       frame: Chỉ số frame
+ * \return          \ref PAGE_OK nếu thành công, \ref PAGE_ERROR nếu lỗi ghi
+ */
+static page_status_t
+page_write_back(page_store_t* store, uint32_t frame) {
+    page_frame_t* entry;
+
+    entry = &store->frames[frame];
+    if (pwrite(store->fd, page_frame_data(store, frame), PAGE_SIZE,
+               (off_t)entry->page_no * PAGE_SIZE) != PAGE_SIZE) {
+        return PAGE_ERROR;
+    }
+    entry->dirty = 0;
+    store->writes++;
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Chọn frame để nạp trang mới theo thuật toán clock
+ *
+ * Kim quét vòng quanh pool: frame bị ghim được bỏ qua, frame có bit tham chiếu
+ * được cho thêm một vòng (xóa bit), frame đầu tiên không có bit bị thay.
+ *
+ * Khi nạp cho quét tuần tự, vòng đầu chỉ tìm frame không có bit và không xóa
+ * bit của ai: quét dài chỉ xoay vòng trong các frame quét, giữ nguyên các
+ * trang tra cứu thường xuyên. Chỉ khi không còn frame như vậy mới dùng clock.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       scan: 1 nếu nạp cho quét tuần tự
+ * \param[out]      frame: Frame đã được giải phóng
+ * \return          \ref PAGE_OK nếu thành công, \ref page_status_t nếu lỗi
+ */
+static page_status_t
+page_victim(page_store_t* store, uint8_t scan, uint32_t* frame) {
+    page_frame_t* entry;
+    size_t step;
+    size_t steps;
+    uint32_t index;
+
+    steps = (scan ? 3 : 2) * store->frame_count + 1;
+    for (step = 0; step < steps; step++) {
+        index = (uint32_t)store->clock_hand;
+        store->clock_hand = (store->clock_hand + 1) % store->frame_count;
+        entry = &store->frames[index];
+        if (entry->pin_count > 0) {
+            continue;
+        }
+        if (entry->page_no != PAGE_NONE && entry->referenced) {
+            if (!scan || step >= store->frame_count) {
+                entry->referenced = 0;
+            }
+            continue;
+        }
+
+        if (entry->page_no != PAGE_NONE) {
+            if (entry->dirty && page_write_back(store, index) != PAGE_OK) {
+                return PAGE_ERROR;
+            }
+            store->page_frames[entry->page_no] = 0;
+            entry->page_no = PAGE_NONE;
+            store->evictions++;
+        }
+        *frame = index;
+        return PAGE_OK;
+    }
+    return PAGE_POOL_EXHAUSTED;
+}
+
+/**
+ * \brief           Ghim một trang, nạp từ đĩa nếu chưa có trong pool
+ * \param[in,out]   store: Kho trang
+ * \param[in]       page_no: Số trang
+ * \param[in]       referenced: 1 nếu là truy cập ngẫu nhiên (đặt bit tham chiếu), 0 nếu là quét
+ * \param[in]       fresh: 1 nếu là trang mới cấp (không đọc đĩa, điền 0)
+ * \param[out]      frame: Frame đang giữ trang
+ * \return          \ref PAGE_OK nếu thành công, \ref page_status_t nếu lỗi
+ */
+static page_status_t
+page_fetch(page_store_t* store, uint32_t page_no, uint8_t referenced, uint8_t fresh, uint32_t* frame) {
+    page_frame_t* entry;
+    page_status_t status;
+    uint8_t* data;
+    ssize_t n;
+    uint32_t index;
+
+    if (store->page_frames[page_no] != 0) {
+        index = store->page_frames[page_no] - 1;
+        store->frames[index].pin_count++;
+        if (referenced) {
+            store->frames[index].referenced = 1;
+        }
+        store->hits++;
+        *frame = index;
+        return PAGE_OK;
+    }
+
+    status = page_victim(store, !referenced, &index);
+    if (status != PAGE_OK) {
+        return status;
+    }
+    data = (uint8_t*)page_frame_data(store, index);
+    if (fresh) {
+        memset(data, 0, PAGE_SIZE);
+    } else {
+        n = pread(store->fd, data, PAGE_SIZE, (off_t)page_no * PAGE_SIZE);
+        if (n < 0) {
+            return PAGE_ERROR;
+        }
+        memset(&data[n], 0, PAGE_SIZE - (size_t)n);
+        store->misses++;
+    }
+
+    entry = &store->frames[index];
+    entry->page_no = page_no;
+    entry->pin_count = 1;
+    entry->referenced = referenced;
+    entry->dirty = fresh;
+    store->page_frames[page_no] = index + 1;
+    *frame = index;
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Đọc trước một đoạn trang liên tiếp bằng một lần preadv
+ *
+ * Các trang chưa có trong pool của đoạn [first, first + count) được nạp vào
+ * frame trống mà không đặt bit tham chiếu. Đoạn kế tiếp được báo trước cho
+ * kernel (POSIX_FADV_WILLNEED) để đĩa làm việc song song với việc quét. Đây
+ * chỉ là tối ưu: lỗi ở đây bị bỏ qua, \ref page_fetch sẽ đọc lại nếu cần.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       first: Trang đầu tiên
+ * \param[in]       count: Số trang
+ */
+static void
+page_prefetch(page_store_t* store, uint32_t first, uint32_t count) {
+    struct iovec iov[PAGE_READ_AHEAD];
+    uint32_t frames[PAGE_READ_AHEAD];
+    uint32_t end;
+    uint32_t run;
+    uint32_t i;
+    ssize_t n;
+    size_t got;
+    size_t have;
+
+    end = first + count;
+    if (end > store->header.page_count) {
+        end = store->header.page_count;
+    }
+    if (end < store->header.page_count) {
+        posix_fadvise(store->fd, (off_t)end * PAGE_SIZE, (off_t)count * PAGE_SIZE, POSIX_FADV_WILLNEED);
+    }
+
+    while (first < end) {
+        if (store->page_frames[first] != 0) {
+            first++;
+            continue;
+        }
+
+        /* Gom đoạn trang liên tiếp chưa có trong pool; frame đã chọn được ghim tạm */
+        run = 0;
+        while (first + run < end && run < PAGE_READ_AHEAD && store->page_frames[first + run] == 0
+               && page_victim(store, 1, &frames[run]) == PAGE_OK) {
+            store->frames[frames[run]].pin_count = 1;
+            iov[run].iov_base = page_frame_data(store, frames[run]);
+            iov[run].iov_len = PAGE_SIZE;
+            run++;
+        }
+        if (run == 0) {
+            return;
+        }
+
+        n = preadv(store->fd, iov, (int)run, (off_t)first * PAGE_SIZE);
+        got = (n > 0) ? (size_t)n : 0;
+        for (i = 0; i < run; i++) {
+            store->frames[frames[i]].pin_count = 0;
+            if (n < 0) {
+                continue;
+            }
+            /* Phần vượt quá cuối file (trang chưa từng được ghi) điền 0 */
+            have = (got > (size_t)i * PAGE_SIZE) ? got - (size_t)i * PAGE_SIZE : 0;
+            if (have < PAGE_SIZE) {
+                memset((uint8_t*)iov[i].iov_base + have, 0, PAGE_SIZE - have);
+            }
+            store->frames[frames[i]].page_no = first + i;
+            store->frames[frames[i]].referenced = 0;
+            store->frames[frames[i]].dirty = 0;
+            store->page_frames[first + i] = frames[i] + 1;
+            store->read_ahead++;
+        }
+        if (n < 0) {
+            return;
+        }
+        first += run;
+    }
+}
+
+/**
+ * \brief           Số trang đọc trước mỗi lần, không quá nửa pool
+ * \param[in]       store: Kho trang
+ * \return          Số trang
+ */
+static uint32_t
+page_read_ahead_window(const page_store_t* store) {
+    size_t window;
+
+    window = store->frame_count / 2;
+    return (uint32_t)((window < PAGE_READ_AHEAD) ? window : PAGE_READ_AHEAD);
+}
+
+/**
+ * \brief           Bỏ ghim một trang
+ * \param[in,out]   store: Kho trang
+ * \param[in,out]   pin: Tham chiếu từ \ref page_book_find_by_id (được đặt lại)
+ * \param[in]       dirty: 1 nếu bản ghi đã bị sửa qua con trỏ
+ */
+void
+page_unpin(page_store_t* store, page_pin_t* pin, uint8_t dirty) {
+    if (store == NULL || pin == NULL || pin->frame == PAGE_NONE) {
+        return;
+    }
+    store->frames[pin->frame].pin_count--;
+    if (dirty) {
+        store->frames[pin->frame].dirty = 1;
+    }
+    pin->frame = PAGE_NONE;
+}
+
+/**
+ * \brief           Giải phóng bộ nhớ và đóng file (không ghi gì)
+ * \param[in,out]   store: Kho trang
+ */
+static void
+page_store_release(page_store_t* store) {
+    if (store->fd >= 0) {
+        close(store->fd);
+    }
+    free(store->memory);
+    free(store->frames);
+    free(store->page_frames);
+    free(store->directory);
+    memset(store, 0, sizeof(*store));
+    store->fd = -1;
+}
+
+/**
+ * \brief           Dựng lại thư mục ID bằng một lượt quét tuần tự toàn bộ file
+ * \param[in,out]   store: Kho trang
+ * \return          \ref PAGE_OK nếu thành công, \ref page_status_t nếu lỗi
+ */
+static page_status_t
+page_rebuild_directory(page_store_t* store) {
+    page_data_t* data;
+    page_status_t status;
+    uint32_t window;
+    uint32_t page_no;
+    uint32_t frame;
+    uint32_t slot;
+    uint64_t found;
+
+    window = page_read_ahead_window(store);
+    found = 0;
+    for (page_no = 1; page_no < store->header.page_count; page_no++) {
+        if ((page_no - 1) % window == 0) {
+            page_prefetch(store, page_no, window);
+        }
+        status = page_fetch(store, page_no, 0, 0, &frame);
+        if (status != PAGE_OK) {
+            return status;
+        }
+        data = page_frame_data(store, frame);
+        for (slot = 0; slot < data->count && slot < PAGE_BOOKS_PER_PAGE; slot++) {
+            if (page_dir_reserve(store, found) != PAGE_OK) {
+                store->frames[frame].pin_count--;
+                return PAGE_NO_MEMORY;
+            }
+            page_dir_put(store, data->books[slot].book_id, page_no * (uint32_t)PAGE_BOOKS_PER_PAGE + slot);
+            found++;
+        }
+        store->frames[frame].pin_count--;
+    }
+    store->header.book_count = found;
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Mở (hoặc tạo) kho trang
+ *
+ * Bộ nhớ dùng bị chặn bởi \p pool_pages frame cộng thư mục ID (8 byte mỗi
+ * sách); thư mục được dựng lại khi mở bằng một lượt quét có đọc trước.
+ *
+ * \param[out]      store: Kho trang
+ * \param[in]       path: Đường dẫn file
+ * \param[in]       pool_pages: Số frame của buffer pool (0 = \ref PAGE_DEFAULT_POOL_PAGES)
+ * \return          \ref PAGE_OK nếu thành công, \ref page_status_t nếu lỗi
+ */
+page_status_t
+page_store_open(page_store_t* store, const char* path, size_t pool_pages) {
+    uint8_t first[PAGE_SIZE];
+    page_status_t status;
+    struct stat st;
+    size_t i;
+
+    if (store == NULL || path == NULL) {
+        return PAGE_INVALID_INPUT;
+    }
+    if (pool_pages == 0) {
+        pool_pages = PAGE_DEFAULT_POOL_PAGES;
+    }
+    if (pool_pages < PAGE_MIN_POOL_PAGES) {
+        return PAGE_INVALID_INPUT;
+    }
+
+    memset(store, 0, sizeof(*store));
+    store->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store->fd < 0 || fstat(store->fd, &st) != 0) {
+        page_store_release(store);
+        return PAGE_ERROR;
+    }
+
+    if (st.st_size == 0) {
+        /* File mới: chỉ có trang 0 */
+        store->header.magic = PAGE_MAGIC;
+        store->header.version = PAGE_VERSION;
+        store->header.page_size = PAGE_SIZE;
+        store->header.record_size = (uint32_t)sizeof(book_t);
+        store->header.page_count = 1;
+        store->header.next_id = 1;
+    } else if (pread(store->fd, first, PAGE_SIZE, 0) != PAGE_SIZE) {
+        page_store_release(store);
+        return PAGE_INCOMPATIBLE;
+    } else {
+        memcpy(&store->header, first, sizeof(store->header));
+        if (store->header.magic != PAGE_MAGIC || store->header.version != PAGE_VERSION
+            || store->header.page_size != PAGE_SIZE || store->header.record_size != sizeof(book_t)
+            || store->header.page_count == 0) {
+            page_store_release(store);
+            return PAGE_INCOMPATIBLE;
+        }
+    }
+
+    store->frame_count = pool_pages;
+    store->memory = aligned_alloc(PAGE_SIZE, pool_pages * PAGE_SIZE);
+    store->frames = calloc(pool_pages, sizeof(page_frame_t));
+    store->dir_capacity = PAGE_MIN_DIRECTORY;
+    store->directory = calloc(store->dir_capacity, sizeof(page_dir_entry_t));
+    if (store->memory == NULL || store->frames == NULL || store->directory == NULL
+        || page_reserve_pages(store, store->header.page_count) != PAGE_OK) {
+        page_store_release(store);
+        return PAGE_NO_MEMORY;
+    }
+    for (i = 0; i < pool_pages; i++) {
+        store->frames[i].page_no = PAGE_NONE;
+    }
+
+    status = page_rebuild_directory(store);
+    if (status != PAGE_OK) {
+        page_store_release(store);
+        return status;
+    }
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Ghi mọi trang bẩn và phần đầu file xuống đĩa
+ * \param[in,out]   store: Kho trang
+ * \return          \ref PAGE_OK nếu thành công, \ref PAGE_ERROR nếu lỗi ghi
+ */
+page_status_t
+page_store_flush(page_store_t* store) {
+    uint8_t first[PAGE_SIZE];
+    size_t i;
+
+    if (store == NULL || store->fd < 0) {
+        return PAGE_INVALID_INPUT;
+    }
+
+    for (i = 0; i < store->frame_count; i++) {
+        if (store->frames[i].page_no != PAGE_NONE && store->frames[i].dirty
+            && page_write_back(store, (uint32_t)i) != PAGE_OK) {
+            return PAGE_ERROR;
+        }
+    }
+
+    memset(first, 0, sizeof(first));
+    memcpy(first, &store->header, sizeof(store->header));
+    if (pwrite(store->fd, first, PAGE_SIZE, 0) != PAGE_SIZE
+        || ftruncate(store->fd, (off_t)store->header.page_count * PAGE_SIZE) != 0
+        || fsync(store->fd) != 0) {
+        return PAGE_ERROR;
+    }
+    return PAGE_OK;
+}
+
+/**
+ * \brief           Ghi xuống đĩa rồi đóng kho trang
+ * \param[in,out]   store: Kho trang
+ * \return          \ref PAGE_OK nếu thành công, \ref PAGE_ERROR nếu lỗi ghi (kho vẫn được đóng)
+ */
+page_status_t
+page_store_close(page_store_t* store) {
+    page_status_t status;
+
+    if (store == NULL || store->fd < 0) {
+        return PAGE_INVALID_INPUT;
+    }
+    status = page_store_flush(store);
+    page_store_release(store);
+    return status;
+}
+
+/**
+ * \brief           Ghi một bản ghi đã chuẩn bị vào cuối trang dữ liệu cuối cùng
+ *
+ * Sách luôn được thêm vào trang cuối (cấp trang mới khi đầy) nên các trang
+ * dữ liệu luôn đầy, trừ trang cuối.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       record: Bản ghi cần ghi (ID chưa có trong kho)
+ * \return          \ref BOOK_OK nếu thành công, \ref BOOK_ERROR nếu lỗi bộ nhớ/đĩa
+ */
+static book_status_t
+page_insert_record(page_store_t* store, const book_t* record) {
+    page_data_t* data;
+    uint32_t page_no;
+    uint32_t frame;
+    uint8_t fresh;
+
+    if (page_dir_reserve(store, store->header.book_count) != PAGE_OK) {
+        return BOOK_ERROR;
+    }
+
+    page_no = store->header.page_count - 1;
+    fresh = 0;
+    if (page_no == 0) {
+        fresh = 1;
+    } else if (page_fetch(store, page_no, 1, 0, &frame) != PAGE_OK) {
+        return BOOK_ERROR;
+    } else if (page_frame_data(store, frame)->count >= PAGE_BOOKS_PER_PAGE) {
+        store->frames[frame].pin_count--;
+        fresh = 1;
+    }
+    if (fresh) {
+        page_no = store->header.page_count;
+        if (page_reserve_pages(store, page_no + 1) != PAGE_OK
+            || page_fetch(store, page_no, 1, 1, &frame) != PAGE_OK) {
+            return BOOK_ERROR;
+        }
+        store->header.page_count++;
+    }
+
+    data = page_frame_data(store, frame);
+    memcpy(&data->books[data->count], record, sizeof(*record));
+    hold_queue_init(&data->books[data->count].holds);
+    page_dir_put(store, record->book_id, page_no * (uint32_t)PAGE_BOOKS_PER_PAGE + data->count);
+    data->count++;
+    store->header.book_count++;
+    store->frames[frame].dirty = 1;
+    store->frames[frame].pin_count--;
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Thêm sách mới với ID tự động
+ * \param[in,out]   store: Kho trang
+ * \param[in]       title: Tiêu đề sách
+ * \param[in]       author: Tác giả
+ * \param[out]      assigned_id: Con trỏ để lưu ID đã được gán (có thể NULL)
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_add(page_store_t* store, const char* title, const char* author, uint32_t* assigned_id) {
+    book_t record;
+    book_status_t status;
+
+    if (store == NULL) {
+        return BOOK_INVALID_INPUT;
+    }
+    status = book_record_init(&record, store->header.next_id, title, author);
+    if (status != BOOK_OK) {
+        return status;
+    }
+
+    status = page_insert_record(store, &record);
+    if (status != BOOK_OK) {
+        return status;
+    }
+    if (assigned_id != NULL) {
+        *assigned_id = store->header.next_id;
+    }
+    store->header.next_id++;
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Thêm sách mới với ID chỉ định
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách
+ * \param[in]       title: Tiêu đề sách
+ * \param[in]       author: Tác giả
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_add_with_id(page_store_t* store, uint32_t book_id, const char* title, const char* author) {
+    book_t record;
+    book_status_t status;
+
+    if (store == NULL || !is_valid_id(book_id)) {
+        return BOOK_INVALID_INPUT;
+    }
+    status = book_record_init(&record, book_id, title, author);
+    if (status != BOOK_OK) {
+        return status;
+    }
+    if (page_dir_find(store, book_id) != NULL) {
+        return BOOK_ALREADY_EXISTS;
+    }
+
+    status = page_insert_record(store, &record);
+    if (status == BOOK_OK && book_id >= store->header.next_id) {
+        store->header.next_id = book_id + 1;
+    }
+    return status;
+}
+
+/**
+ * \brief           Tìm sách theo ID và ghim trang chứa nó
+ *
+ * Con trỏ trả về trỏ thẳng vào buffer pool và hợp lệ cho tới khi gọi
+ * \ref page_unpin (truyền dirty = 1 nếu đã sửa bản ghi). Khi trả về NULL thì
+ * không có trang nào bị ghim.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách
+ * \param[out]      pin: Tham chiếu để bỏ ghim
+ * \return          Con trỏ tới sách, NULL nếu không tìm thấy hoặc lỗi đọc
+ */
+book_t*
+page_book_find_by_id(page_store_t* store, uint32_t book_id, page_pin_t* pin) {
+    const page_dir_entry_t* entry;
+    uint32_t frame;
+
+    if (pin != NULL) {
+        pin->frame = PAGE_NONE;
+    }
+    if (store == NULL || pin == NULL) {
+        return NULL;
+    }
+
+    entry = page_dir_find(store, book_id);
+    if (entry == NULL
+        || page_fetch(store, entry->location / (uint32_t)PAGE_BOOKS_PER_PAGE, 1, 0, &frame) != PAGE_OK) {
+        return NULL;
+    }
+    pin->frame = frame;
+    return &page_frame_data(store, frame)->books[entry->location % PAGE_BOOKS_PER_PAGE];
+}
+
+/**
+ * \brief           Cập nhật thông tin sách
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách
+ * \param[in]       title: Tiêu đề mới
+ * \param[in]       author: Tác giả mới
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_update(page_store_t* store, uint32_t book_id, const char* title, const char* author) {
+    page_pin_t pin;
+    book_t* book;
+    book_status_t status;
+
+    if (title == NULL || author == NULL || is_string_empty(title) || is_string_empty(author)) {
+        return BOOK_INVALID_INPUT;
+    }
+    book = page_book_find_by_id(store, book_id, &pin);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+    status = book_record_update(book, title, author);
+    page_unpin(store, &pin, status == BOOK_OK);
+    return status;
+}
+
+/**
+ * \brief           Xóa sách
+ *
+ * Bản ghi cuối cùng của kho được chuyển vào chỗ trống để các trang luôn đầy,
+ * nên thứ tự duyệt của \ref page_book_query có thể thay đổi sau khi xóa.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách cần xóa
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_delete(page_store_t* store, uint32_t book_id) {
+    page_dir_entry_t* entry;
+    page_dir_entry_t* moved;
+    page_data_t* last;
+    page_pin_t pin;
+    page_pin_t last_pin;
+    book_t* book;
+    book_status_t status;
+    uint32_t last_page;
+    uint32_t last_location;
+    uint32_t frame;
+
+    book = page_book_find_by_id(store, book_id, &pin);
+    if (book == NULL) {
+        return (store == NULL) ? BOOK_INVALID_INPUT : BOOK_NOT_FOUND;
+    }
+    status = book_record_check_delete(book);
+    if (status != BOOK_OK) {
+        page_unpin(store, &pin, 0);
+        return status;
+    }
+
+    last_page = store->header.page_count - 1;
+    if (page_fetch(store, last_page, 1, 0, &frame) != PAGE_OK) {
+        page_unpin(store, &pin, 0);
+        return BOOK_ERROR;
+    }
+    last_pin.frame = frame;
+    last = page_frame_data(store, frame);
+    last_location = last_page * (uint32_t)PAGE_BOOKS_PER_PAGE + last->count - 1;
+
+    entry = page_dir_find(store, book_id);
+    if (entry->location != last_location) {
+        /* Lấp chỗ trống bằng bản ghi cuối cùng */
+        memcpy(book, &last->books[last->count - 1], sizeof(*book));
+        moved = page_dir_find(store, book->book_id);
+        moved->location = entry->location;
+    }
+    page_dir_remove(store, entry);
+    last->count--;
+    store->header.book_count--;
+    page_unpin(store, &pin, 1);
+    page_unpin(store, &last_pin, 1);
+
+    if (last->count == 0) {
+        /* Trang cuối đã rỗng: bỏ khỏi pool, file được cắt ngắn khi flush */
+        store->frames[frame].page_no = PAGE_NONE;
+        store->frames[frame].dirty = 0;
+        store->page_frames[last_page] = 0;
+        store->header.page_count--;
+    }
+    return BOOK_OK;
+}
+
+/**
+ * \brief           Thêm bản sao cho một đầu sách
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách
+ * \param[in]       count: Số bản sao cần thêm
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_add_copies(page_store_t* store, uint32_t book_id, uint8_t count) {
+    page_pin_t pin;
+    book_t* book;
+    book_status_t status;
+
+    book = page_book_find_by_id(store, book_id, &pin);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+    status = book_record_add_copies(book, count);
+    page_unpin(store, &pin, status == BOOK_OK);
+    return status;
+}
+
+/**
+ * \brief           Cho mượn một bản sao có sẵn bất kỳ của đầu sách
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách
+ * \param[out]      copy: Chỉ số bản sao đã được lấy
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_checkout_copy(page_store_t* store, uint32_t book_id, uint8_t* copy) {
+    page_pin_t pin;
+    book_t* book;
+    book_status_t status;
+
+    book = page_book_find_by_id(store, book_id, &pin);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+    status = book_record_checkout(book, copy);
+    page_unpin(store, &pin, status == BOOK_OK);
+    return status;
+}
+
+/**
+ * \brief           Nhận lại một bản sao cụ thể của đầu sách
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID của sách
+ * \param[in]       copy: Chỉ số bản sao được trả
+ * \return          \ref BOOK_OK nếu thành công, \ref book_status_t nếu lỗi
+ */
+book_status_t
+page_book_return_copy(page_store_t* store, uint32_t book_id, uint8_t copy) {
+    page_pin_t pin;
+    book_t* book;
+    book_status_t status;
+
+    book = page_book_find_by_id(store, book_id, &pin);
+    if (book == NULL) {
+        return BOOK_NOT_FOUND;
+    }
+    status = book_record_return(book, copy);
+    page_unpin(store, &pin, status == BOOK_OK);
+    return status;
+}
+
+/**
+ * \brief           Duyệt các sách khớp bộ lọc theo thứ tự trang
+ *
+ * Quét tuần tự có đọc trước; trang nạp bởi quét không giữ chỗ trong pool lâu
+ * hơn các trang tra cứu. \p visit không được thêm hoặc xóa sách.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       text: Chuỗi truy vấn cho bộ lọc tiêu đề/tác giả
+ * \param[in]       visit: Hàm nhận từng sách khớp (NULL = chỉ đếm)
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p visit
+ * \return          Số sách khớp đã duyệt
+ */
+size_t
+page_book_query(page_store_t* store, book_filter_t filter, const char* text,
+                book_visit_fn visit, void* ctx) {
+    char needle[MAX_STRING_LENGTH];
+    const page_data_t* data;
+    uint32_t window;
+    uint32_t page_no;
+    uint32_t frame;
+    uint32_t slot;
+    size_t matched;
+    uint8_t stop;
+
+    if (store == NULL || filter > BOOK_FILTER_AUTHOR) {
+        return 0;
+    }
+    needle[0] = '\0';
+    if (filter == BOOK_FILTER_TITLE || filter == BOOK_FILTER_AUTHOR) {
+        if (text == NULL) {
+            return 0;
+        }
+        strncpy(needle, text, MAX_STRING_LENGTH - 1);
+        needle[MAX_STRING_LENGTH - 1] = '\0';
+        to_lowercase(needle);
+    }
+
+    window = page_read_ahead_window(store);
+    matched = 0;
+    stop = 0;
+    for (page_no = 1; page_no < store->header.page_count && !stop; page_no++) {
+        if ((page_no - 1) % window == 0) {
+            page_prefetch(store, page_no, window);
+        }
+        if (page_fetch(store, page_no, 0, 0, &frame) != PAGE_OK) {
+            break;
+        }
+        data = page_frame_data(store, frame);
+        for (slot = 0; slot < data->count && !stop; slot++) {
+            if (!book_record_matches(&data->books[slot], filter, needle)) {
+                continue;
+            }
+            matched++;
+            if (visit != NULL && !visit(&data->books[slot], ctx)) {
+                stop = 1;
+            }
+        }
+        store->frames[frame].pin_count--;
+    }
+    return matched;
+}
+
+/**
+ * \brief           Số đầu sách trong kho
+ * \param[in]       store: Kho trang
+ * \return          Số sách
+ */
+size_t
+page_book_count_total(const page_store_t* store) {
+    return (store != NULL) ? (size_t)store->header.book_count : 0;
+}
+
+/**
+ * \brief           Chép toàn bộ danh sách sách trong bộ nhớ vào kho trang
+ *
+ * Số bản sao và bitmap có sẵn được giữ nguyên; hàng đợi đặt giữ không được
+ * chép (nó trỏ vào pool của thư viện đang chạy).
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       list: Danh sách sách
+ * \return          \ref PAGE_OK nếu thành công, \ref PAGE_INVALID_INPUT nếu trùng ID
+ */
+page_status_t
+page_store_import(page_store_t* store, const book_list_t* list) {
+    size_t i;
+
+    if (store == NULL || list == NULL) {
+        return PAGE_INVALID_INPUT;
+    }
+    for (i = 0; i < list->count; i++) {
+        if (page_dir_find(store, list->books[i].book_id) != NULL) {
+            return PAGE_INVALID_INPUT;
+        }
+        if (page_insert_record(store, &list->books[i]) != BOOK_OK) {
+            return PAGE_ERROR;
+        }
+        if (list->books[i].book_id >= store->header.next_id) {
+            store->header.next_id = list->books[i].book_id + 1;
+        }
+    }
+    return PAGE_OK;
+}
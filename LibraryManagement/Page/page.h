@@ -0,0 +1,164 @@
+/**
+ * \file            page.h
+ * \brief           Kho sách dạng trang trên đĩa với buffer pool (cho catalog lớn hơn RAM)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef PAGE_HDR_H
+#define PAGE_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../Book/book.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define PAGE_SIZE                   4096        /*!< Kích thước một trang trên đĩa và trong pool */
+#define PAGE_MAGIC                  0x4750494Cu /*!< "LIPG": đánh dấu file kho trang */
+#define PAGE_VERSION                1u          /*!< Phiên bản định dạng file */
+#define PAGE_DEFAULT_POOL_PAGES     256         /*!< Số frame mặc định của buffer pool (1 MB) */
+#define PAGE_MIN_POOL_PAGES         4           /*!< Số frame tối thiểu (xóa sách cần ghim hai trang) */
+#define PAGE_READ_AHEAD             16          /*!< Số trang đọc trước mỗi lần khi quét tuần tự */
+#define PAGE_NONE                   UINT32_MAX  /*!< Frame trống / không có trang */
+
+/* Số bản ghi sách trong một trang dữ liệu (trừ phần đầu trang) */
+#define PAGE_BOOKS_PER_PAGE         ((PAGE_SIZE - 8) / sizeof(book_t))
+
+/**
+ * \brief           Trạng thái trả về của các hàm kho trang
+ */
+typedef enum {
+    PAGE_OK = 0,                                /*!< Thành công */
+    PAGE_ERROR,                                 /*!< Lỗi đọc/ghi file (errno cho biết chi tiết) */
+    PAGE_INVALID_INPUT,                         /*!< Dữ liệu đầu vào không hợp lệ */
+    PAGE_INCOMPATIBLE,                          /*!< File không phải kho trang của bản build này */
+    PAGE_NO_MEMORY,                             /*!< Không cấp phát được pool hoặc thư mục ID */
+    PAGE_POOL_EXHAUSTED,                        /*!< Mọi frame đang bị ghim, không có trang để thay */
+} page_status_t;
+
+/**
+ * \brief           Trang dữ liệu: số bản ghi đang dùng và mảng \ref book_t liền nhau
+ */
+typedef struct {
+    uint32_t count;                             /*!< Số bản ghi đang dùng (ở đầu mảng) */
+    uint32_t reserved;                          /*!< Dự phòng, luôn 0 */
+    book_t books[PAGE_BOOKS_PER_PAGE];          /*!< Bản ghi sách */
+} page_data_t;
+
+/**
+ * \brief           Phần đầu file (trang 0)
+ */
+typedef struct {
+    uint32_t magic;                             /*!< \ref PAGE_MAGIC */
+    uint32_t version;                           /*!< \ref PAGE_VERSION */
+    uint32_t page_size;                         /*!< \ref PAGE_SIZE */
+    uint32_t record_size;                       /*!< sizeof(book_t) của bản build đã ghi file */
+    uint32_t page_count;                        /*!< Tổng số trang, kể cả trang 0 */
+    uint32_t next_id;                           /*!< ID tiếp theo sẽ được gán */
+    uint64_t book_count;                        /*!< Số sách */
+} page_file_header_t;
+
+/**
+ * \brief           Một frame của buffer pool
+ */
+typedef struct {
+    uint32_t page_no;                           /*!< Trang đang giữ, \ref PAGE_NONE nếu trống */
+    uint32_t pin_count;                         /*!< Số lần đang bị ghim; frame bị ghim không bị thay */
+    uint8_t referenced;                         /*!< Bit tham chiếu của thuật toán clock */
+    uint8_t dirty;                              /*!< 1 nếu phải ghi lại trước khi thay */
+} page_frame_t;
+
+/**
+ * \brief           Một mục của thư mục ID (bảng băm trong bộ nhớ, 8 byte mỗi sách)
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách, 0 = ô trống */
+    uint32_t location;                          /*!< Trang * \ref PAGE_BOOKS_PER_PAGE + vị trí trong trang */
+} page_dir_entry_t;
+
+/**
+ * \brief           Kho trang đang mở
+ *
+ * Bộ nhớ dùng gồm pool (số frame * \ref PAGE_SIZE), bảng frame và thư mục ID;
+ * bản ghi sách chỉ nằm trong pool khi trang của nó đang được dùng.
+ */
+typedef struct {
+    int fd;                                     /*!< File kho trang */
+    page_file_header_t header;                  /*!< Bản sao của trang 0 */
+    uint8_t* memory;                            /*!< Vùng nhớ của các frame */
+    page_frame_t* frames;                       /*!< Bảng frame */
+    size_t frame_count;                         /*!< Số frame */
+    size_t clock_hand;                          /*!< Kim đồng hồ của thuật toán clock */
+    uint32_t* page_frames;                      /*!< Trang -> frame + 1 (0 = không nằm trong pool) */
+    uint32_t page_capacity;                     /*!< Số phần tử của \ref page_frames */
+    page_dir_entry_t* directory;                /*!< Thư mục ID -> vị trí */
+    size_t dir_capacity;                        /*!< Số ô thư mục (lũy thừa của 2) */
+    uint64_t hits;                              /*!< Số lần trang đã có trong pool */
+    uint64_t misses;                            /*!< Số lần phải đọc trang từ đĩa */
+    uint64_t read_ahead;                        /*!< Số trang được đọc trước khi quét */
+    uint64_t evictions;                         /*!< Số trang bị thay ra */
+    uint64_t writes;                            /*!< Số trang đã ghi xuống đĩa */
+} page_store_t;
+
+/**
+ * \brief           Tham chiếu tới trang đang bị ghim
+ */
+typedef struct {
+    uint32_t frame;                             /*!< Frame đang ghim, \ref PAGE_NONE nếu không có */
+} page_pin_t;
+
+/* Khai báo các hàm quản lý kho trang */
+page_status_t   page_store_open(page_store_t* store, const char* path, size_t pool_pages);
+page_status_t   page_store_flush(page_store_t* store);
+page_status_t   page_store_close(page_store_t* store);
+page_status_t   page_store_import(page_store_t* store, const book_list_t* list);
+void            page_unpin(page_store_t* store, page_pin_t* pin, uint8_t dirty);
+
+/* Khai báo các hàm sách (cùng quy tắc và mã lỗi với \ref book_add, ...) */
+book_status_t   page_book_add(page_store_t* store, const char* title, const char* author, uint32_t* assigned_id);
+book_status_t   page_book_add_with_id(page_store_t* store, uint32_t book_id, const char* title, const char* author);
+book_status_t   page_book_update(page_store_t* store, uint32_t book_id, const char* title, const char* author);
+book_status_t   page_book_delete(page_store_t* store, uint32_t book_id);
+book_t*         page_book_find_by_id(page_store_t* store, uint32_t book_id, page_pin_t* pin);
+book_status_t   page_book_add_copies(page_store_t* store, uint32_t book_id, uint8_t count);
+book_status_t   page_book_checkout_copy(page_store_t* store, uint32_t book_id, uint8_t* copy);
+book_status_t   page_book_return_copy(page_store_t* store, uint32_t book_id, uint8_t copy);
+size_t          page_book_query(page_store_t* store, book_filter_t filter, const char* text,
+                                book_visit_fn visit, void* ctx);
+size_t          page_book_count_total(const page_store_t* store);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PAGE_HDR_H */
@@ -0,0 +1,312 @@
+/**
+ * \file            pagetool.c
+ * \brief           library_pages: tạo, tra cứu và đo kho sách dạng trang
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "page.h"
+
+#define PAGETOOL_MAX_PRINT          20          /* Số kết quả tìm kiếm in ra tối đa */
+
+/**
+ * \brief           Ngữ cảnh in kết quả tìm kiếm
+ */
+typedef struct {
+    size_t printed;                             /*!< Số sách đã in */
+} pagetool_print_ctx_t;
+
+/**
+ * \brief           Thời gian hiện tại (giây, đơn điệu)
+ * \return          Số giây
+ */
+static double
+pagetool_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           In một sách
+ * \param[in]       book: Sách cần in
+ */
+static void
+pagetool_print_book(const book_t* book) {
+    printf("%-8u %-45.45s %-22.22s %u/%u bản có sẵn\n", book->book_id, book->title, book->author,
+           book->available_count, book->copy_count);
+}
+
+/**
+ * \brief           Hàm duyệt in tối đa \ref PAGETOOL_MAX_PRINT sách
+ * \param[in]       book: Sách khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref pagetool_print_ctx_t
+ * \return          Luôn 1 để đếm đủ số kết quả
+ */
+static uint8_t
+pagetool_print_visit(const book_t* book, void* ctx) {
+    pagetool_print_ctx_t* print;
+
+    print = ctx;
+    if (print->printed < PAGETOOL_MAX_PRINT) {
+        pagetool_print_book(book);
+        print->printed++;
+    }
+    return 1;
+}
+
+/**
+ * \brief           In thống kê buffer pool
+ * \param[in]       store: Kho trang
+ */
+static void
+pagetool_print_stats(const page_store_t* store) {
+    printf("Kho: %zu sách, %u trang x %d byte; pool %zu trang (%zu KB)\n",
+           page_book_count_total(store), store->header.page_count, PAGE_SIZE, store->frame_count,
+           store->frame_count * PAGE_SIZE / 1024);
+    printf("Pool: %llu trúng, %llu đọc đĩa, %llu đọc trước, %llu thay ra, %llu ghi\n",
+           (unsigned long long)store->hits, (unsigned long long)store->misses,
+           (unsigned long long)store->read_ahead, (unsigned long long)store->evictions,
+           (unsigned long long)store->writes);
+}
+
+/**
+ * \brief           Lệnh create: thêm \p count sách mẫu
+ * \param[in,out]   store: Kho trang
+ * \param[in]       count: Số sách
+ * \return          0 nếu thành công
+ */
+static int
+pagetool_create(page_store_t* store, uint32_t count) {
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    uint32_t id;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        snprintf(title, sizeof(title), "Sách liên thư viện %u - Lập trình C tập %u", i + 1, i % 17 + 1);
+        snprintf(author, sizeof(author), "Tác giả %u", i % 997 + 1);
+        if (page_book_add(store, title, author, &id) != BOOK_OK) {
+            fprintf(stderr, "Không thêm được sách thứ %u\n", i + 1);
+            return 1;
+        }
+        if (i % 3 != 0) {
+            page_book_add_copies(store, id, (uint8_t)(i % 3));
+        }
+    }
+    printf("Đã thêm %u sách\n", count);
+    return 0;
+}
+
+/**
+ * \brief           Lệnh lookup: tra cứu một sách
+ * \param[in,out]   store: Kho trang
+ * \param[in]       book_id: ID sách
+ * \return          0 nếu tìm thấy
+ */
+static int
+pagetool_lookup(page_store_t* store, uint32_t book_id) {
+    page_pin_t pin;
+    const book_t* book;
+
+    book = page_book_find_by_id(store, book_id, &pin);
+    if (book == NULL) {
+        printf("Không tìm thấy sách ID %u\n", book_id);
+        return 1;
+    }
+    pagetool_print_book(book);
+    page_unpin(store, &pin, 0);
+    return 0;
+}
+
+/**
+ * \brief           Lệnh bench: tra cứu ngẫu nhiên trên tập nóng rồi quét toàn bộ
+ *
+ * Sau lượt quét, tập nóng được tra cứu lại: nhờ trang quét không được đặt bit
+ * tham chiếu, phần lớn tập nóng vẫn còn trong pool.
+ *
+ * \param[in,out]   store: Kho trang
+ * \param[in]       lookups: Số lượt tra cứu mỗi giai đoạn
+ * \return          0 nếu thành công
+ */
+static int
+pagetool_bench(page_store_t* store, uint32_t lookups) {
+    page_pin_t pin;
+    const book_t* book;
+    uint64_t misses;
+    uint32_t hot;
+    uint32_t seed;
+    uint32_t round;
+    uint32_t i;
+    size_t matched;
+    double start;
+
+    if (page_book_count_total(store) == 0) {
+        fprintf(stderr, "Kho rỗng\n");
+        return 1;
+    }
+    /* Tập nóng: số sách vừa một nửa pool */
+    hot = (uint32_t)(store->frame_count / 2 * PAGE_BOOKS_PER_PAGE);
+    if (hot == 0 || hot > store->header.next_id - 1) {
+        hot = store->header.next_id - 1;
+    }
+
+    seed = 2463534242u;
+    for (round = 0; round < 2; round++) {
+        misses = store->misses;
+        start = pagetool_now();
+        for (i = 0; i < lookups; i++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            book = page_book_find_by_id(store, seed % hot + 1, &pin);
+            if (book != NULL) {
+                page_unpin(store, &pin, 0);
+            }
+        }
+        printf("Tra cứu %s quét: %u lượt trên %u sách nóng, %.0f lượt/s, %llu đọc đĩa\n",
+               (round == 0) ? "trước" : "sau", lookups, hot, lookups / (pagetool_now() - start),
+               (unsigned long long)(store->misses - misses));
+
+        if (round == 0) {
+            start = pagetool_now();
+            matched = page_book_query(store, BOOK_FILTER_TITLE, "tập 7", NULL, NULL);
+            printf("Quét toàn bộ: %zu sách khớp trong %.3f s\n", matched, pagetool_now() - start);
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+pagetool_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-p số_trang_pool] file lệnh\n"
+                    "  create <số_sách>             thêm sách mẫu\n"
+                    "  lookup <id_sách>             tra cứu\n"
+                    "  search title|author <từ>     tìm kiếm (quét tuần tự)\n"
+                    "  borrow <id_sách>             cho mượn một bản sao\n"
+                    "  return <id_sách> <bản_sao>   nhận lại bản sao (đánh số từ 1)\n"
+                    "  delete <id_sách>             xóa sách\n"
+                    "  bench <số_lượt>              đo tra cứu và quét\n", prog);
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_pages
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Mảng tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    page_store_t store;
+    pagetool_print_ctx_t print;
+    page_status_t status;
+    book_status_t book_status;
+    const char* command;
+    size_t pool_pages;
+    size_t matched;
+    uint8_t copy;
+    int result;
+    int opt;
+
+    pool_pages = 0;
+    while ((opt = getopt(argc, argv, "p:h")) != -1) {
+        switch (opt) {
+            case 'p':
+                pool_pages = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                pagetool_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind + 1 >= argc) {
+        pagetool_usage(argv[0]);
+        return 1;
+    }
+    command = argv[optind + 1];
+
+    status = page_store_open(&store, argv[optind], pool_pages);
+    if (status != PAGE_OK) {
+        fprintf(stderr, "Không mở được kho %s (mã lỗi %d)\n", argv[optind], (int)status);
+        return 1;
+    }
+
+    result = 0;
+    if (strcmp(command, "create") == 0 && optind + 2 < argc) {
+        result = pagetool_create(&store, (uint32_t)strtoul(argv[optind + 2], NULL, 10));
+    } else if (strcmp(command, "lookup") == 0 && optind + 2 < argc) {
+        result = pagetool_lookup(&store, (uint32_t)strtoul(argv[optind + 2], NULL, 10));
+    } else if (strcmp(command, "search") == 0 && optind + 3 < argc) {
+        print.printed = 0;
+        matched = page_book_query(&store, (strcmp(argv[optind + 2], "author") == 0) ? BOOK_FILTER_AUTHOR
+                                                                                     : BOOK_FILTER_TITLE,
+                                  argv[optind + 3], pagetool_print_visit, &print);
+        printf("Tìm thấy %zu sách\n", matched);
+    } else if (strcmp(command, "borrow") == 0 && optind + 2 < argc) {
+        book_status = page_book_checkout_copy(&store, (uint32_t)strtoul(argv[optind + 2], NULL, 10), &copy);
+        if (book_status == BOOK_OK) {
+            printf("Đã cho mượn bản sao #%u\n", copy + 1);
+        } else {
+            printf("Không cho mượn được (mã lỗi %d)\n", (int)book_status);
+            result = 1;
+        }
+    } else if (strcmp(command, "return") == 0 && optind + 3 < argc) {
+        copy = (uint8_t)(strtoul(argv[optind + 3], NULL, 10) - 1);
+        book_status = page_book_return_copy(&store, (uint32_t)strtoul(argv[optind + 2], NULL, 10), copy);
+        printf((book_status == BOOK_OK) ? "Đã nhận lại\n" : "Không nhận lại được\n");
+        result = (book_status == BOOK_OK) ? 0 : 1;
+    } else if (strcmp(command, "delete") == 0 && optind + 2 < argc) {
+        book_status = page_book_delete(&store, (uint32_t)strtoul(argv[optind + 2], NULL, 10));
+        printf((book_status == BOOK_OK) ? "Đã xóa\n" : "Không xóa được\n");
+        result = (book_status == BOOK_OK) ? 0 : 1;
+    } else if (strcmp(command, "bench") == 0 && optind + 2 < argc) {
+        result = pagetool_bench(&store, (uint32_t)strtoul(argv[optind + 2], NULL, 10));
+    } else {
+        pagetool_usage(argv[0]);
+        result = 1;
+    }
+
+    pagetool_print_stats(&store);
+    if (page_store_close(&store) != PAGE_OK) {
+        perror(argv[optind]);
+        result = 1;
+    }
+    return result;
+}
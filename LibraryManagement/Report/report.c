@@ -0,0 +1,946 @@
+/**
+ * \file            report.c
+ * \brief           Sắp xếp ngoài: run giới hạn bộ nhớ, trộn k đường bằng cây loser, ghi CSV có đệm
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif /* _WIN32 */
+#include "report.h"
+
+#define REPORT_ALIGN(size)          (((size) + 7u) & ~(size_t)7u)
+#define REPORT_HEADER_SIZE          offsetof(report_row_t, text)
+#define REPORT_INSERTION_SORT       16          /* Đoạn ngắn hơn được sắp xếp chèn */
+#define REPORT_NUMBER_LENGTH        24          /* Đủ cho số 64 bit dạng thập phân */
+
+/**
+ * \brief           Bộ đệm ghi tuần tự (file run hoặc CSV)
+ */
+typedef struct {
+    FILE* out;                                  /*!< File đích */
+    char* buffer;                               /*!< Bộ đệm */
+    size_t used;                                /*!< Số byte đang chờ ghi */
+    size_t capacity;                            /*!< Kích thước bộ đệm */
+    uint64_t bytes;                             /*!< Tổng số byte đã nhận */
+    uint8_t failed;                             /*!< 1 nếu đã có lỗi ghi */
+} report_writer_t;
+
+/**
+ * \brief           Bộ đọc tuần tự một run với bộ đệm lấy từ vùng nhớ chung
+ */
+typedef struct {
+    FILE* file;                                 /*!< File run */
+    uint8_t* buffer;                            /*!< Bộ đệm đọc */
+    size_t capacity;                            /*!< Kích thước bộ đệm */
+    size_t position;                            /*!< Vị trí dòng kế tiếp trong bộ đệm */
+    size_t fill;                                /*!< Số byte hợp lệ trong bộ đệm */
+    const report_row_t* row;                    /*!< Dòng hiện tại (NULL = hết run) */
+    uint64_t prefix;                            /*!< Tiền tố khóa của \ref row */
+} report_reader_t;
+
+/* Tên khóa dùng cho tham số dòng lệnh */
+static const char* const report_key_names[] = {"author", "title", "id", "isbn", "available"};
+
+/**
+ * \brief           Thời gian hiện tại (giây)
+ * \return          Số giây
+ */
+static double
+report_now(void) {
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Tiêu đề của một dòng
+ */
+static const char*
+report_row_title(const report_row_t* row) {
+    return row->text;
+}
+
+/**
+ * \brief           Tác giả của một dòng
+ */
+static const char*
+report_row_author(const report_row_t* row) {
+    return row->text + row->title_length + 1;
+}
+
+/**
+ * \brief           8 byte đầu của chuỗi dạng big-endian (so sánh như strcmp)
+ * \param[in]       text: Chuỗi
+ * \return          Tiền tố
+ */
+static uint64_t
+report_string_prefix(const char* text) {
+    uint64_t prefix;
+    size_t i;
+
+    prefix = 0;
+    for (i = 0; i < sizeof(prefix); i++) {
+        prefix <<= 8;
+        if (*text != '\0') {
+            prefix |= (uint8_t)*text++;
+        }
+    }
+    return prefix;
+}
+
+/**
+ * \brief           Tiền tố khóa chính của một dòng
+ * \param[in]       report: Bộ tạo báo cáo
+ * \param[in]       row: Dòng
+ * \return          Tiền tố; hai dòng có tiền tố khác nhau thì thứ tự theo tiền tố
+ */
+static uint64_t
+report_row_prefix(const report_t* report, const report_row_t* row) {
+    switch (report->config.keys[0]) {
+        case REPORT_KEY_AUTHOR:
+            return report_string_prefix(report_row_author(row));
+        case REPORT_KEY_TITLE:
+            return report_string_prefix(report_row_title(row));
+        case REPORT_KEY_ID:
+            return row->book_id;
+        case REPORT_KEY_ISBN:
+            return row->isbn;
+        case REPORT_KEY_AVAILABLE:
+        default:
+            return row->available_count;
+    }
+}
+
+/**
+ * \brief           So sánh hai số không dấu
+ */
+static int
+report_compare_numbers(uint64_t left, uint64_t right) {
+    return (left < right) ? -1 : ((left > right) ? 1 : 0);
+}
+
+/**
+ * \brief           So sánh hai dòng theo các khóa đã cấu hình, cuối cùng theo ID sách
+ * \param[in]       report: Bộ tạo báo cáo
+ * \param[in]       left: Dòng thứ nhất
+ * \param[in]       right: Dòng thứ hai
+ * \return          Âm, 0 hoặc dương như strcmp
+ */
+static int
+report_compare_rows(const report_t* report, const report_row_t* left, const report_row_t* right) {
+    size_t i;
+    int result;
+
+    for (i = 0; i < report->config.key_count; i++) {
+        switch (report->config.keys[i]) {
+            case REPORT_KEY_AUTHOR:
+                result = strcmp(report_row_author(left), report_row_author(right));
+                break;
+            case REPORT_KEY_TITLE:
+                result = strcmp(report_row_title(left), report_row_title(right));
+                break;
+            case REPORT_KEY_ID:
+                result = report_compare_numbers(left->book_id, right->book_id);
+                break;
+            case REPORT_KEY_ISBN:
+                result = report_compare_numbers(left->isbn, right->isbn);
+                break;
+            case REPORT_KEY_AVAILABLE:
+            default:
+                result = report_compare_numbers(left->available_count, right->available_count);
+                break;
+        }
+        if (result != 0) {
+            return result;
+        }
+    }
+    return report_compare_numbers(left->book_id, right->book_id);
+}
+
+/**
+ * \brief           So sánh hai dòng, dùng tiền tố trước khi đọc chuỗi
+ */
+static int
+report_compare(const report_t* report, uint64_t left_prefix, const report_row_t* left,
+               uint64_t right_prefix, const report_row_t* right) {
+    if (left_prefix != right_prefix) {
+        return (left_prefix < right_prefix) ? -1 : 1;
+    }
+    return report_compare_rows(report, left, right);
+}
+
+/**
+ * \brief           Sắp xếp các phần tử của một run (quicksort trung vị ba, đoạn ngắn sắp xếp chèn)
+ * \param[in]       report: Bộ tạo báo cáo (cấu hình khóa)
+ * \param[in,out]   entries: Các phần tử
+ * \param[in]       count: Số phần tử
+ */
+static void
+report_sort(const report_t* report, report_entry_t* entries, size_t count) {
+    report_entry_t pivot;
+    report_entry_t swap;
+    ptrdiff_t i;
+    ptrdiff_t j;
+    size_t mid;
+    size_t left;
+
+#define REPORT_LESS(a, b)   (report_compare(report, (a).prefix, (a).row, (b).prefix, (b).row) < 0)
+#define REPORT_SWAP(a, b)   do { swap = (a); (a) = (b); (b) = swap; } while (0)
+    while (count > REPORT_INSERTION_SORT) {
+        /* Trung vị của đầu, giữa, cuối; hai đầu thành lính canh cho vòng quét */
+        mid = count / 2;
+        if (REPORT_LESS(entries[mid], entries[0])) {
+            REPORT_SWAP(entries[mid], entries[0]);
+        }
+        if (REPORT_LESS(entries[count - 1], entries[0])) {
+            REPORT_SWAP(entries[count - 1], entries[0]);
+        }
+        if (REPORT_LESS(entries[count - 1], entries[mid])) {
+            REPORT_SWAP(entries[count - 1], entries[mid]);
+        }
+        pivot = entries[mid];
+
+        /* Phân hoạch Hoare: [0, j] <= pivot <= [j + 1, count) */
+        i = -1;
+        j = (ptrdiff_t)count;
+        while (1) {
+            do {
+                i++;
+            } while (REPORT_LESS(entries[i], pivot));
+            do {
+                j--;
+            } while (REPORT_LESS(pivot, entries[j]));
+            if (i >= j) {
+                break;
+            }
+            REPORT_SWAP(entries[i], entries[j]);
+        }
+
+        /* Đệ quy phần nhỏ, lặp phần lớn: độ sâu ngăn xếp O(log n) */
+        left = (size_t)j + 1;
+        if (left < count - left) {
+            report_sort(report, entries, left);
+            entries += left;
+            count -= left;
+        } else {
+            report_sort(report, entries + left, count - left);
+            count = left;
+        }
+    }
+
+    for (mid = 1; mid < count; mid++) {
+        pivot = entries[mid];
+        for (left = mid; left > 0 && REPORT_LESS(pivot, entries[left - 1]); left--) {
+            entries[left] = entries[left - 1];
+        }
+        entries[left] = pivot;
+    }
+#undef REPORT_SWAP
+#undef REPORT_LESS
+}
+
+/**
+ * \brief           Ghi phần còn trong bộ đệm ra file
+ * \param[in,out]   writer: Bộ ghi
+ */
+static void
+report_writer_flush(report_writer_t* writer) {
+    if (writer->used > 0 && !writer->failed
+        && fwrite(writer->buffer, 1, writer->used, writer->out) != writer->used) {
+        writer->failed = 1;
+    }
+    writer->used = 0;
+}
+
+/**
+ * \brief           Ghi một đoạn byte qua bộ đệm
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       data: Dữ liệu
+ * \param[in]       length: Số byte
+ */
+static void
+report_writer_put(report_writer_t* writer, const void* data, size_t length) {
+    if (writer->used + length > writer->capacity) {
+        report_writer_flush(writer);
+    }
+    memcpy(writer->buffer + writer->used, data, length);
+    writer->used += length;
+    writer->bytes += length;
+}
+
+/**
+ * \brief           Ghi một số không dấu dạng thập phân
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       value: Giá trị
+ */
+static void
+report_csv_number(report_writer_t* writer, uint64_t value) {
+    char digits[REPORT_NUMBER_LENGTH];
+    size_t start;
+
+    start = sizeof(digits);
+    do {
+        digits[--start] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    report_writer_put(writer, digits + start, sizeof(digits) - start);
+}
+
+/**
+ * \brief           Ghi một trường chuỗi, thêm ngoặc kép khi cần (RFC 4180)
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       text: Chuỗi
+ * \param[in]       length: Độ dài
+ */
+static void
+report_csv_text(report_writer_t* writer, const char* text, size_t length) {
+    const char* quote;
+    size_t part;
+
+    if (strcspn(text, ",\"\r\n") == length) {
+        report_writer_put(writer, text, length);
+        return;
+    }
+
+    /* Bọc trong ngoặc kép, nhân đôi mọi ngoặc kép bên trong */
+    report_writer_put(writer, "\"", 1);
+    while ((quote = memchr(text, '"', length)) != NULL) {
+        part = (size_t)(quote - text) + 1;
+        report_writer_put(writer, text, part);
+        report_writer_put(writer, "\"", 1);
+        text += part;
+        length -= part;
+    }
+    report_writer_put(writer, text, length);
+    report_writer_put(writer, "\"", 1);
+}
+
+/**
+ * \brief           Ghi một dòng CSV: id,isbn,title,author,copies,available
+ * \param[in,out]   writer: Bộ ghi
+ * \param[in]       row: Dòng
+ */
+static void
+report_csv_row(report_writer_t* writer, const report_row_t* row) {
+    report_csv_number(writer, row->book_id);
+    report_writer_put(writer, ",", 1);
+    if (row->isbn != 0) {
+        report_csv_number(writer, row->isbn);
+    }
+    report_writer_put(writer, ",", 1);
+    report_csv_text(writer, report_row_title(row), row->title_length);
+    report_writer_put(writer, ",", 1);
+    report_csv_text(writer, report_row_author(row), row->author_length);
+    report_writer_put(writer, ",", 1);
+    report_csv_number(writer, row->copy_count);
+    report_writer_put(writer, ",", 1);
+    report_csv_number(writer, row->available_count);
+    report_writer_put(writer, "\n", 1);
+}
+
+/**
+ * \brief           Tạo một file tạm không đệm (bộ đệm do báo cáo tự quản lý)
+ * \param[in]       report: Bộ tạo báo cáo
+ * \return          File đã mở để đọc/ghi, NULL nếu lỗi
+ */
+static FILE*
+report_temp_file(const report_t* report) {
+    FILE* file;
+#ifndef _WIN32
+    char path[REPORT_PATH_LENGTH + 32];
+    int fd;
+
+    if (report->temp_dir[0] != '\0') {
+        snprintf(path, sizeof(path), "%s/library_report_XXXXXX", report->temp_dir);
+        fd = mkstemp(path);
+        if (fd < 0) {
+            return NULL;
+        }
+        /* Xóa tên ngay: file biến mất khi đóng, kể cả khi chương trình dừng giữa chừng */
+        unlink(path);
+        file = fdopen(fd, "w+b");
+        if (file == NULL) {
+            close(fd);
+            return NULL;
+        }
+    } else
+#endif /* _WIN32 */
+    {
+        (void)report;
+        file = tmpfile();
+        if (file == NULL) {
+            return NULL;
+        }
+    }
+    setvbuf(file, NULL, _IONBF, 0);
+    return file;
+}
+
+/**
+ * \brief           Thêm một file run vào danh sách
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \param[in]       run: File run
+ * \return          \ref REPORT_OK nếu thành công
+ */
+static report_status_t
+report_push_run(report_t* report, FILE* run) {
+    FILE** grown;
+    size_t capacity;
+
+    if (report->run_count == report->run_capacity) {
+        capacity = (report->run_capacity == 0) ? 16 : report->run_capacity * 2;
+        grown = realloc(report->runs, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return REPORT_NO_MEMORY;
+        }
+        report->runs = grown;
+        report->run_capacity = capacity;
+    }
+    report->runs[report->run_count++] = run;
+    return REPORT_OK;
+}
+
+/**
+ * \brief           Vị trí kết thúc của mảng phần tử (cuối vùng nhớ, căn theo phần tử)
+ */
+static report_entry_t*
+report_entries_end(const report_t* report) {
+    return (report_entry_t*)(report->arena + (report->arena_size / sizeof(report_entry_t)) * sizeof(report_entry_t));
+}
+
+/**
+ * \brief           Sắp xếp các dòng đang giữ trong vùng nhớ
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \return          Con trỏ tới phần tử đầu tiên
+ */
+static report_entry_t*
+report_sort_memory(report_t* report) {
+    report_entry_t* entries;
+
+    entries = report_entries_end(report) - report->entry_count;
+    report_sort(report, entries, report->entry_count);
+    return entries;
+}
+
+/**
+ * \brief           Sắp xếp các dòng trong vùng nhớ và ghi thành một run
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \return          \ref REPORT_OK nếu thành công
+ */
+static report_status_t
+report_spill(report_t* report) {
+    report_writer_t writer;
+    report_entry_t* entries;
+    double started;
+    size_t i;
+    FILE* run;
+
+    started = report_now();
+    entries = report_sort_memory(report);
+    run = report_temp_file(report);
+    if (run == NULL) {
+        return REPORT_IO_ERROR;
+    }
+
+    writer.out = run;
+    writer.buffer = report->io_buffer;
+    writer.used = 0;
+    writer.capacity = REPORT_IO_BUFFER;
+    writer.bytes = 0;
+    writer.failed = 0;
+    for (i = 0; i < report->entry_count; i++) {
+        report_writer_put(&writer, entries[i].row, entries[i].row->size);
+    }
+    report_writer_flush(&writer);
+    if (writer.failed || report_push_run(report, run) != REPORT_OK) {
+        fclose(run);
+        return writer.failed ? REPORT_IO_ERROR : REPORT_NO_MEMORY;
+    }
+
+    report->stats.runs++;
+    report->stats.spilled_bytes += writer.bytes;
+    report->stats.sort_seconds += report_now() - started;
+    report->used = 0;
+    report->entry_count = 0;
+    return REPORT_OK;
+}
+
+/**
+ * \brief           Khởi tạo bộ tạo báo cáo và cấp phát toàn bộ ngân sách bộ nhớ
+ * \param[out]      report: Bộ tạo báo cáo
+ * \param[in]       config: Cấu hình (NULL = mặc định)
+ * \return          \ref REPORT_OK nếu thành công
+ */
+report_status_t
+report_init(report_t* report, const report_config_t* config) {
+    size_t memory;
+    size_t i;
+
+    if (report == NULL) {
+        return REPORT_INVALID_INPUT;
+    }
+    memset(report, 0, sizeof(*report));
+    if (config != NULL) {
+        report->config = *config;
+    }
+
+    memory = (report->config.memory == 0) ? REPORT_DEFAULT_MEMORY : report->config.memory;
+    if (memory < REPORT_MIN_MEMORY || report->config.key_count > REPORT_MAX_KEYS) {
+        return REPORT_INVALID_INPUT;
+    }
+    report->config.memory = memory;
+    if (report->config.key_count == 0) {
+        /* Thứ tự xếp giá: tác giả, tiêu đề, rồi ID */
+        report->config.keys[0] = REPORT_KEY_AUTHOR;
+        report->config.keys[1] = REPORT_KEY_TITLE;
+        report->config.keys[2] = REPORT_KEY_ID;
+        report->config.key_count = 3;
+    }
+    for (i = 0; i < report->config.key_count; i++) {
+        if (report->config.keys[i] > REPORT_KEY_AVAILABLE) {
+            return REPORT_INVALID_INPUT;
+        }
+    }
+    if (report->config.temp_dir != NULL) {
+        if (strlen(report->config.temp_dir) >= sizeof(report->temp_dir)) {
+            return REPORT_INVALID_INPUT;
+        }
+        strcpy(report->temp_dir, report->config.temp_dir);
+    }
+    report->config.temp_dir = NULL;
+
+    report->io_buffer = malloc(REPORT_IO_BUFFER);
+    report->arena_size = memory - REPORT_IO_BUFFER;
+    report->arena = malloc(report->arena_size);
+    if (report->io_buffer == NULL || report->arena == NULL) {
+        report_destroy(report);
+        return REPORT_NO_MEMORY;
+    }
+    return REPORT_OK;
+}
+
+/**
+ * \brief           Đóng các file tạm và giải phóng bộ nhớ
+ * \param[in,out]   report: Bộ tạo báo cáo
+ */
+void
+report_destroy(report_t* report) {
+    size_t i;
+
+    if (report == NULL) {
+        return;
+    }
+    for (i = 0; i < report->run_count; i++) {
+        fclose(report->runs[i]);
+    }
+    free(report->runs);
+    free(report->arena);
+    free(report->io_buffer);
+    report->runs = NULL;
+    report->arena = NULL;
+    report->io_buffer = NULL;
+    report->run_count = 0;
+    report->run_capacity = 0;
+}
+
+/**
+ * \brief           Nhận một sách vào báo cáo
+ *
+ * Khi vùng nhớ đầy, các dòng đang giữ được sắp xếp và ghi thành một run.
+ *
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \param[in]       book: Sách
+ * \return          \ref REPORT_OK nếu thành công
+ */
+report_status_t
+report_add(report_t* report, const book_t* book) {
+    report_entry_t* entry;
+    report_row_t* row;
+    size_t title_length;
+    size_t author_length;
+    size_t size;
+
+    if (report == NULL || book == NULL || report->arena == NULL) {
+        return REPORT_INVALID_INPUT;
+    }
+    if (report->error != REPORT_OK) {
+        return report->error;
+    }
+
+    title_length = strnlen(book->title, MAX_TITLE_LENGTH - 1);
+    author_length = strnlen(book->author, MAX_AUTHOR_LENGTH - 1);
+    size = REPORT_ALIGN(REPORT_HEADER_SIZE + title_length + 1 + author_length + 1);
+    if (report->used + size > (size_t)((uint8_t*)(report_entries_end(report) - report->entry_count - 1)
+                                       - report->arena)) {
+        report->error = report_spill(report);
+        if (report->error != REPORT_OK) {
+            return report->error;
+        }
+    }
+
+    row = (report_row_t*)(report->arena + report->used);
+    row->isbn = book->isbn;
+    row->book_id = book->book_id;
+    row->size = (uint16_t)size;
+    row->title_length = (uint8_t)title_length;
+    row->author_length = (uint8_t)author_length;
+    row->copy_count = book->copy_count;
+    row->available_count = book->available_count;
+    memcpy(row->text, book->title, title_length);
+    row->text[title_length] = '\0';
+    memcpy(row->text + title_length + 1, book->author, author_length);
+    row->text[title_length + 1 + author_length] = '\0';
+    report->used += size;
+
+    report->entry_count++;
+    entry = report_entries_end(report) - report->entry_count;
+    entry->row = row;
+    entry->prefix = report_row_prefix(report, row);
+    report->stats.rows++;
+    return REPORT_OK;
+}
+
+/**
+ * \brief           Đọc dòng kế tiếp của một run
+ * \param[in]       report: Bộ tạo báo cáo
+ * \param[in,out]   reader: Bộ đọc
+ * \return          \ref REPORT_OK (kể cả khi hết run), \ref REPORT_IO_ERROR nếu file hỏng
+ */
+static report_status_t
+report_reader_next(const report_t* report, report_reader_t* reader) {
+    const report_row_t* row;
+    size_t remaining;
+    size_t got;
+
+    remaining = reader->fill - reader->position;
+    if (remaining < REPORT_HEADER_SIZE
+        || remaining < ((const report_row_t*)(reader->buffer + reader->position))->size) {
+        /* Chuyển phần dở dang về đầu bộ đệm rồi đọc tiếp cả khối */
+        memmove(reader->buffer, reader->buffer + reader->position, remaining);
+        got = fread(reader->buffer + remaining, 1, reader->capacity - remaining, reader->file);
+        if (got == 0 && ferror(reader->file)) {
+            return REPORT_IO_ERROR;
+        }
+        reader->position = 0;
+        reader->fill = remaining + got;
+        remaining = reader->fill;
+        if (remaining == 0) {
+            reader->row = NULL;
+            return REPORT_OK;
+        }
+        if (remaining < REPORT_HEADER_SIZE
+            || remaining < ((const report_row_t*)reader->buffer)->size) {
+            return REPORT_IO_ERROR;
+        }
+    }
+
+    row = (const report_row_t*)(reader->buffer + reader->position);
+    if (row->size < REPORT_HEADER_SIZE + 2) {
+        return REPORT_IO_ERROR;
+    }
+    reader->position += row->size;
+    reader->row = row;
+    reader->prefix = report_row_prefix(report, row);
+    return REPORT_OK;
+}
+
+/**
+ * \brief           Run \p left đứng trước run \p right (run đã hết đứng sau mọi run)
+ */
+static uint8_t
+report_reader_less(const report_t* report, const report_reader_t* readers, size_t left, size_t right) {
+    int result;
+
+    if (readers[left].row == NULL) {
+        return 0;
+    }
+    if (readers[right].row == NULL) {
+        return 1;
+    }
+    result = report_compare(report, readers[left].prefix, readers[left].row, readers[right].prefix,
+                            readers[right].row);
+    return (result != 0) ? (result < 0) : (left < right);
+}
+
+/**
+ * \brief           Dựng cây loser cho nút \p node, trả về run thắng của cây con
+ *
+ * Lá của run i là nút count + i; nút trong giữ run thua tại đó.
+ */
+static size_t
+report_tree_build(const report_t* report, const report_reader_t* readers, size_t* tree, size_t count,
+                  size_t node) {
+    size_t left;
+    size_t right;
+
+    if (node >= count) {
+        return node - count;
+    }
+    left = report_tree_build(report, readers, tree, count, 2 * node);
+    right = report_tree_build(report, readers, tree, count, 2 * node + 1);
+    if (report_reader_less(report, readers, right, left)) {
+        tree[node] = left;
+        return right;
+    }
+    tree[node] = right;
+    return left;
+}
+
+/**
+ * \brief           Trộn các run thành một dòng ra đã sắp xếp
+ *
+ * Cây loser giữ run thua ở mỗi nút, nên sau khi lấy dòng của run thắng chỉ
+ * cần so sánh lại đúng log2(k) lần dọc đường từ lá của run đó lên gốc.
+ *
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \param[in]       inputs: Các run
+ * \param[in]       count: Số run (1..\ref REPORT_MAX_FANIN)
+ * \param[in,out]   writer: Bộ ghi kết quả
+ * \param[in]       csv: 1 = ghi dạng CSV, 0 = ghi thành run mới
+ * \return          \ref REPORT_OK nếu thành công
+ */
+static report_status_t
+report_merge(report_t* report, FILE** inputs, size_t count, report_writer_t* writer, uint8_t csv) {
+    report_reader_t readers[REPORT_MAX_FANIN];
+    size_t tree[REPORT_MAX_FANIN];
+    report_status_t status;
+    size_t slice;
+    size_t winner;
+    size_t node;
+    size_t swap;
+    size_t i;
+
+    /* Chia vùng nhớ thành bộ đệm đọc cho từng run */
+    slice = (report->arena_size / count) & ~(size_t)7u;
+    for (i = 0; i < count; i++) {
+        readers[i].file = inputs[i];
+        readers[i].buffer = report->arena + i * slice;
+        readers[i].capacity = slice;
+        readers[i].position = 0;
+        readers[i].fill = 0;
+        readers[i].row = NULL;
+        rewind(inputs[i]);
+        status = report_reader_next(report, &readers[i]);
+        if (status != REPORT_OK) {
+            return status;
+        }
+    }
+
+    winner = report_tree_build(report, readers, tree, count, 1);
+    while (readers[winner].row != NULL) {
+        if (csv) {
+            report_csv_row(writer, readers[winner].row);
+        } else {
+            report_writer_put(writer, readers[winner].row, readers[winner].row->size);
+        }
+
+        status = report_reader_next(report, &readers[winner]);
+        if (status != REPORT_OK) {
+            return status;
+        }
+        /* Đấu lại từ lá lên gốc: bên thua ở lại nút, bên thắng đi tiếp */
+        for (node = (winner + count) / 2; node >= 1; node /= 2) {
+            if (report_reader_less(report, readers, tree[node], winner)) {
+                swap = tree[node];
+                tree[node] = winner;
+                winner = swap;
+            }
+        }
+    }
+    return writer->failed ? REPORT_IO_ERROR : REPORT_OK;
+}
+
+/**
+ * \brief           Trộn các run thành một run mới, thay thế chúng trong danh sách
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \param[in]       count: Số run đầu danh sách cần trộn
+ * \return          \ref REPORT_OK nếu thành công
+ */
+static report_status_t
+report_merge_runs(report_t* report, size_t count) {
+    report_writer_t writer;
+    report_status_t status;
+    size_t i;
+    FILE* run;
+
+    run = report_temp_file(report);
+    if (run == NULL) {
+        return REPORT_IO_ERROR;
+    }
+    writer.out = run;
+    writer.buffer = report->io_buffer;
+    writer.used = 0;
+    writer.capacity = REPORT_IO_BUFFER;
+    writer.bytes = 0;
+    writer.failed = 0;
+    status = report_merge(report, report->runs, count, &writer, 0);
+    report_writer_flush(&writer);
+    if (status == REPORT_OK && writer.failed) {
+        status = REPORT_IO_ERROR;
+    }
+    if (status != REPORT_OK) {
+        fclose(run);
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        fclose(report->runs[i]);
+    }
+    memmove(report->runs, report->runs + count, (report->run_count - count) * sizeof(report->runs[0]));
+    report->run_count -= count;
+    report->runs[report->run_count++] = run;
+    report->stats.spilled_bytes += writer.bytes;
+    report->stats.merge_passes++;
+    return REPORT_OK;
+}
+
+/**
+ * \brief           Sắp xếp toàn bộ các dòng đã nhận và ghi ra CSV
+ *
+ * Nếu mọi dòng còn vừa vùng nhớ thì ghi thẳng, không dùng file tạm. Ngược
+ * lại, khi số run vượt số run trộn được trong một lượt (giới hạn bởi
+ * \ref REPORT_MAX_FANIN và bộ đệm đọc tối thiểu), các nhóm run được trộn
+ * trước thành run lớn hơn.
+ *
+ * \param[in,out]   report: Bộ tạo báo cáo
+ * \param[in]       out: File kết quả
+ * \return          \ref REPORT_OK nếu thành công
+ */
+report_status_t
+report_write_csv(report_t* report, FILE* out) {
+    static const char header[] = "id,isbn,title,author,copies,available\n";
+    report_writer_t writer;
+    report_entry_t* entries;
+    report_status_t status;
+    double started;
+    size_t fanin;
+    size_t i;
+
+    if (report == NULL || out == NULL || report->arena == NULL) {
+        return REPORT_INVALID_INPUT;
+    }
+    if (report->error != REPORT_OK) {
+        return report->error;
+    }
+
+    started = report_now();
+    status = REPORT_OK;
+    if (report->run_count > 0) {
+        /* Ghi nốt run cuối và trộn trước các nhóm run (cùng dùng bộ đệm ghi) */
+        if (report->entry_count > 0) {
+            status = report_spill(report);
+        }
+        fanin = report->arena_size / REPORT_MIN_READ_BUFFER;
+        fanin = (fanin > REPORT_MAX_FANIN) ? REPORT_MAX_FANIN : fanin;
+        while (status == REPORT_OK && report->run_count > fanin) {
+            status = report_merge_runs(report, fanin);
+        }
+    }
+
+    writer.out = out;
+    writer.buffer = report->io_buffer;
+    writer.used = 0;
+    writer.capacity = REPORT_IO_BUFFER;
+    writer.bytes = 0;
+    writer.failed = 0;
+    if (status == REPORT_OK) {
+        report_writer_put(&writer, header, sizeof(header) - 1);
+        if (report->run_count == 0) {
+            entries = report_sort_memory(report);
+            for (i = 0; i < report->entry_count; i++) {
+                report_csv_row(&writer, entries[i].row);
+            }
+        } else {
+            status = report_merge(report, report->runs, report->run_count, &writer, 1);
+            report->stats.merge_passes++;
+        }
+    }
+
+    report_writer_flush(&writer);
+    if (status == REPORT_OK && (writer.failed || fflush(out) != 0)) {
+        status = REPORT_IO_ERROR;
+    }
+    report->stats.csv_bytes = writer.bytes;
+    report->stats.merge_seconds = report_now() - started;
+    report->error = status;
+    return status;
+}
+
+/**
+ * \brief           Đọc danh sách khóa dạng "author,title,id"
+ * \param[in]       text: Chuỗi khóa, cách nhau bởi dấu phẩy
+ * \param[out]      keys: Mảng nhận khóa (tối đa \ref REPORT_MAX_KEYS)
+ * \param[out]      count: Số khóa
+ * \return          \ref REPORT_OK, \ref REPORT_INVALID_INPUT nếu có tên khóa lạ
+ */
+report_status_t
+report_parse_keys(const char* text, report_key_t* keys, size_t* count) {
+    size_t length;
+    size_t key;
+
+    if (text == NULL || keys == NULL || count == NULL) {
+        return REPORT_INVALID_INPUT;
+    }
+
+    *count = 0;
+    while (*text != '\0') {
+        length = strcspn(text, ",");
+        for (key = 0; key < sizeof(report_key_names) / sizeof(report_key_names[0]); key++) {
+            if (strlen(report_key_names[key]) == length && strncmp(text, report_key_names[key], length) == 0) {
+                break;
+            }
+        }
+        if (key == sizeof(report_key_names) / sizeof(report_key_names[0]) || *count == REPORT_MAX_KEYS) {
+            return REPORT_INVALID_INPUT;
+        }
+        keys[(*count)++] = (report_key_t)key;
+        text += length;
+        if (*text == ',') {
+            text++;
+        }
+    }
+    return (*count > 0) ? REPORT_OK : REPORT_INVALID_INPUT;
+}
+
+/**
+ * \brief           Tên của một khóa sắp xếp
+ * \param[in]       key: Khóa
+ * \return          Tên khóa, "?" nếu không hợp lệ
+ */
+const char*
+report_key_name(report_key_t key) {
+    return (key <= REPORT_KEY_AVAILABLE) ? report_key_names[key] : "?";
+}
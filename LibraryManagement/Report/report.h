@@ -0,0 +1,160 @@
+/**
+ * \file            report.h
+ * \brief           Khai báo bộ tạo báo cáo sắp xếp ngoài (run có giới hạn bộ nhớ, trộn k đường, CSV)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef REPORT_HDR_H
+#define REPORT_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "../Book/book.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define REPORT_MAX_KEYS             5           /*!< Số khóa sắp xếp tối đa */
+#define REPORT_DEFAULT_MEMORY       (64u * 1024u * 1024u) /*!< Bộ nhớ mặc định (64 MB) */
+#define REPORT_MIN_MEMORY           (1u * 1024u * 1024u) /*!< Bộ nhớ tối thiểu */
+#define REPORT_IO_BUFFER            (256u * 1024u) /*!< Bộ đệm ghi CSV/run (nằm trong ngân sách bộ nhớ) */
+#define REPORT_MIN_READ_BUFFER      (64u * 1024u) /*!< Bộ đệm đọc tối thiểu của mỗi run khi trộn */
+#define REPORT_MAX_FANIN            128         /*!< Số run trộn tối đa trong một lượt */
+#define REPORT_PATH_LENGTH          512         /*!< Độ dài tối đa đường dẫn thư mục tạm */
+
+/**
+ * \brief           Trạng thái trả về của các hàm báo cáo
+ */
+typedef enum {
+    REPORT_OK = 0,                              /*!< Thành công */
+    REPORT_ERROR,                               /*!< Lỗi chung */
+    REPORT_INVALID_INPUT,                       /*!< Dữ liệu đầu vào không hợp lệ */
+    REPORT_NO_MEMORY,                           /*!< Không cấp phát được ngân sách bộ nhớ */
+    REPORT_IO_ERROR,                            /*!< Lỗi đọc/ghi file tạm hoặc file kết quả */
+} report_status_t;
+
+/**
+ * \brief           Khóa sắp xếp
+ */
+typedef enum {
+    REPORT_KEY_AUTHOR = 0,                      /*!< Tác giả (thứ tự byte UTF-8) */
+    REPORT_KEY_TITLE,                           /*!< Tiêu đề (thứ tự byte UTF-8) */
+    REPORT_KEY_ID,                              /*!< ID sách */
+    REPORT_KEY_ISBN,                            /*!< ISBN-13 (0 = chưa gán, đứng đầu) */
+    REPORT_KEY_AVAILABLE,                       /*!< Số bản sao có sẵn */
+} report_key_t;
+
+/**
+ * \brief           Một dòng báo cáo (dạng gói, dùng cả trong bộ nhớ lẫn trong file run)
+ *
+ * Tiêu đề và tác giả (kèm ký tự kết thúc) nằm ngay sau phần đầu; \ref size
+ * là tổng kích thước đã làm tròn lên bội của 8.
+ */
+typedef struct {
+    uint64_t isbn;                              /*!< ISBN-13 dạng số */
+    uint32_t book_id;                           /*!< ID sách */
+    uint16_t size;                              /*!< Kích thước cả dòng (byte) */
+    uint8_t title_length;                       /*!< Độ dài tiêu đề */
+    uint8_t author_length;                      /*!< Độ dài tác giả */
+    uint8_t copy_count;                         /*!< Số bản sao */
+    uint8_t available_count;                    /*!< Số bản sao có sẵn */
+    char text[];                                /*!< Tiêu đề '\0' tác giả '\0' */
+} report_row_t;
+
+/**
+ * \brief           Một phần tử sắp xếp: tiền tố khóa chính và dòng
+ */
+typedef struct {
+    uint64_t prefix;                            /*!< 8 byte đầu của khóa chính (so sánh nhanh) */
+    const report_row_t* row;                    /*!< Dòng trong vùng nhớ */
+} report_entry_t;
+
+/**
+ * \brief           Cấu hình báo cáo
+ */
+typedef struct {
+    size_t memory;                              /*!< Ngân sách bộ nhớ (byte), 0 = \ref REPORT_DEFAULT_MEMORY */
+    report_key_t keys[REPORT_MAX_KEYS];         /*!< Thứ tự khóa; ID sách luôn là khóa phụ cuối */
+    size_t key_count;                           /*!< Số khóa, 0 = tác giả, tiêu đề, ID */
+    const char* temp_dir;                       /*!< Thư mục file tạm (NULL = thư mục tạm của hệ thống) */
+} report_config_t;
+
+/**
+ * \brief           Số liệu của một lần tạo báo cáo
+ */
+typedef struct {
+    uint64_t rows;                              /*!< Số dòng đã nhận */
+    uint64_t runs;                              /*!< Số run đã ghi ra file tạm */
+    uint64_t merge_passes;                      /*!< Số lượt trộn (kể cả lượt cuối) */
+    uint64_t spilled_bytes;                     /*!< Tổng số byte ghi ra file tạm */
+    uint64_t csv_bytes;                         /*!< Số byte CSV đã ghi */
+    double sort_seconds;                        /*!< Thời gian tạo run (nhận dòng, sắp xếp, ghi) */
+    double merge_seconds;                       /*!< Thời gian trộn và ghi CSV */
+} report_stats_t;
+
+/**
+ * \brief           Bộ tạo báo cáo sắp xếp ngoài
+ *
+ * Toàn bộ bộ nhớ là một vùng cấp phát lúc khởi tạo: dòng được gói từ đầu
+ * vùng, phần tử sắp xếp xếp từ cuối vùng; khi hai phía gặp nhau, run được
+ * sắp xếp và ghi ra file tạm. Khi trộn, cùng vùng nhớ được chia làm bộ đệm
+ * đọc cho các run.
+ */
+typedef struct {
+    report_config_t config;                     /*!< Cấu hình (khóa đã chuẩn hóa) */
+    char temp_dir[REPORT_PATH_LENGTH];          /*!< Bản sao thư mục tạm */
+    uint8_t* arena;                             /*!< Vùng nhớ dòng/phần tử, sau này là bộ đệm đọc */
+    size_t arena_size;                          /*!< Kích thước vùng nhớ */
+    char* io_buffer;                            /*!< Bộ đệm ghi (\ref REPORT_IO_BUFFER) */
+    size_t used;                                /*!< Số byte dòng đã gói */
+    size_t entry_count;                         /*!< Số phần tử sắp xếp */
+    FILE** runs;                                /*!< Các file run đã ghi */
+    size_t run_count;                           /*!< Số run */
+    size_t run_capacity;                        /*!< Dung lượng mảng \ref runs */
+    report_stats_t stats;                       /*!< Số liệu */
+    report_status_t error;                      /*!< Lỗi đầu tiên gặp phải (giữ lại cho các lần gọi sau) */
+} report_t;
+
+/* Khai báo các hàm báo cáo */
+report_status_t report_init(report_t* report, const report_config_t* config);
+void            report_destroy(report_t* report);
+report_status_t report_add(report_t* report, const book_t* book);
+report_status_t report_write_csv(report_t* report, FILE* out);
+report_status_t report_parse_keys(const char* text, report_key_t* keys, size_t* count);
+const char*     report_key_name(report_key_t key);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* REPORT_HDR_H */
@@ -0,0 +1,240 @@
+/**
+ * \file            reporttool.c
+ * \brief           Công cụ library_report: xuất danh mục đã sắp xếp ra CSV với bộ nhớ giới hạn
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "report.h"
+#include "../Page/page.h"
+
+/**
+ * \brief           Ngữ cảnh đưa sách từ kho trang vào báo cáo
+ */
+typedef struct {
+    report_t* report;                           /*!< Báo cáo nhận sách */
+    report_status_t status;                     /*!< Lỗi đầu tiên */
+} reporttool_feed_ctx_t;
+
+/**
+ * \brief           Thời gian hiện tại (giây, đơn điệu)
+ * \return          Số giây
+ */
+static double
+reporttool_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief           Hàm duyệt đưa từng sách vào báo cáo
+ * \param[in]       book: Sách
+ * \param[in,out]   ctx: Con trỏ tới \ref reporttool_feed_ctx_t
+ * \return          0 để dừng khi báo cáo lỗi
+ */
+static uint8_t
+reporttool_feed_visit(const book_t* book, void* ctx) {
+    reporttool_feed_ctx_t* feed;
+
+    feed = ctx;
+    feed->status = report_add(feed->report, book);
+    return feed->status == REPORT_OK;
+}
+
+/**
+ * \brief           Sinh \p rows sách mẫu theo thứ tự ID (tác giả, tiêu đề ngẫu nhiên)
+ * \param[in,out]   report: Báo cáo nhận sách
+ * \param[in]       rows: Số sách
+ * \return          \ref REPORT_OK nếu thành công
+ */
+static report_status_t
+reporttool_generate(report_t* report, uint64_t rows) {
+    book_t book;
+    report_status_t status;
+    uint64_t state;
+    uint64_t i;
+
+    memset(&book, 0, sizeof(book));
+    state = 0x9E3779B97F4A7C15ull;
+    for (i = 0; i < rows; i++) {
+        /* xorshift64: dữ liệu lặp lại được giữa các lần chạy */
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        book.book_id = (uint32_t)(i + 1);
+        book.isbn = (i % 5 == 0) ? 0 : 9780000000000ull + state % 1000000000ull;
+        book.copy_count = (uint8_t)(state % 4 + 1);
+        book.available_count = (uint8_t)((state >> 8) % (book.copy_count + 1u));
+        snprintf(book.author, sizeof(book.author), "Tác giả %05u", (unsigned)((state >> 16) % 50000));
+        snprintf(book.title, sizeof(book.title), "Sách liên thư viện %08x, tập %u", (unsigned)(state >> 32),
+                 (unsigned)(state % 17 + 1));
+        status = report_add(report, &book);
+        if (status != REPORT_OK) {
+            return status;
+        }
+    }
+    return REPORT_OK;
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+reporttool_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-m MB] [-k khóa,...] [-T thư_mục_tạm] [-p số_trang_pool] kho.pg kết_quả.csv\n"
+                    "       %s [-m MB] [-k khóa,...] [-T thư_mục_tạm] -g số_dòng kết_quả.csv\n"
+                    "  -m  ngân sách bộ nhớ (mặc định %u MB)\n"
+                    "  -k  khóa sắp xếp: author, title, id, isbn, available (mặc định author,title,id)\n"
+                    "  -g  sinh số dòng mẫu thay vì đọc kho trang\n"
+                    "  kết_quả.csv = - để ghi ra stdout\n", prog, prog,
+            (unsigned)(REPORT_DEFAULT_MEMORY / (1024u * 1024u)));
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_report
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Các tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    report_config_t config;
+    reporttool_feed_ctx_t feed;
+    report_status_t status;
+    page_store_t store;
+    report_t report;
+    const char* output;
+    const char* source;
+    uint64_t generate;
+    size_t pool_pages;
+    double started;
+    double loaded;
+    size_t i;
+    FILE* out;
+    int opt;
+
+    memset(&config, 0, sizeof(config));
+    generate = 0;
+    pool_pages = 0;
+    while ((opt = getopt(argc, argv, "m:k:T:p:g:h")) != -1) {
+        switch (opt) {
+            case 'm':
+                config.memory = (size_t)strtoull(optarg, NULL, 10) * 1024u * 1024u;
+                break;
+            case 'k':
+                if (report_parse_keys(optarg, config.keys, &config.key_count) != REPORT_OK) {
+                    fprintf(stderr, "Khóa sắp xếp không hợp lệ: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'T':
+                config.temp_dir = optarg;
+                break;
+            case 'p':
+                pool_pages = strtoul(optarg, NULL, 10);
+                break;
+            case 'g':
+                generate = strtoull(optarg, NULL, 10);
+                break;
+            default:
+                reporttool_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind + (generate > 0 ? 0 : 1) >= argc) {
+        reporttool_usage(argv[0]);
+        return 1;
+    }
+    source = (generate > 0) ? NULL : argv[optind];
+    output = argv[argc - 1];
+
+    status = report_init(&report, &config);
+    if (status != REPORT_OK) {
+        fprintf(stderr, "Không khởi tạo được báo cáo (mã lỗi %d)\n", (int)status);
+        return 1;
+    }
+
+    /* Nhận dòng: mỗi khi đầy ngân sách bộ nhớ, một run được sắp xếp và ghi ra file tạm */
+    started = reporttool_now();
+    if (source == NULL) {
+        status = reporttool_generate(&report, generate);
+    } else if (page_store_open(&store, source, pool_pages) != PAGE_OK) {
+        fprintf(stderr, "Không mở được kho %s\n", source);
+        report_destroy(&report);
+        return 1;
+    } else {
+        feed.report = &report;
+        feed.status = REPORT_OK;
+        page_book_query(&store, BOOK_FILTER_ALL, NULL, reporttool_feed_visit, &feed);
+        status = feed.status;
+        page_store_close(&store);
+    }
+    loaded = reporttool_now();
+
+    if (status == REPORT_OK) {
+        out = (strcmp(output, "-") == 0) ? stdout : fopen(output, "wb");
+        if (out == NULL) {
+            perror(output);
+            report_destroy(&report);
+            return 1;
+        }
+        status = report_write_csv(&report, out);
+        if (out != stdout && fclose(out) != 0) {
+            status = REPORT_IO_ERROR;
+        }
+    }
+
+    fprintf(stderr, "Khóa:");
+    for (i = 0; i < report.config.key_count; i++) {
+        fprintf(stderr, "%s%s", (i == 0) ? " " : ",", report_key_name(report.config.keys[i]));
+    }
+    fprintf(stderr, "; bộ nhớ %zu MB\n", report.config.memory / (1024u * 1024u));
+    fprintf(stderr, "Dòng: %llu; run: %llu; lượt trộn: %llu; ghi tạm %.1f MB; CSV %.1f MB\n",
+            (unsigned long long)report.stats.rows, (unsigned long long)report.stats.runs,
+            (unsigned long long)report.stats.merge_passes, (double)report.stats.spilled_bytes / 1e6,
+            (double)report.stats.csv_bytes / 1e6);
+    fprintf(stderr, "Thời gian: nhận và tạo run %.2f s (sắp xếp/ghi run %.2f s), trộn và ghi CSV %.2f s\n",
+            loaded - started, report.stats.sort_seconds, report.stats.merge_seconds);
+    report_destroy(&report);
+
+    if (status != REPORT_OK) {
+        fprintf(stderr, "Lỗi tạo báo cáo (mã lỗi %d)\n", (int)status);
+        return 1;
+    }
+    return 0;
+}
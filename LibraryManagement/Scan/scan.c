@@ -0,0 +1,523 @@
+/**
+ * \file            scan.c
+ * \brief           Triển khai bộ quét song song theo phân đoạn
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "scan.h"
+
+/**
+ * \brief           Ngữ cảnh của một lần tìm kiếm
+ */
+typedef struct {
+    scan_pool_t* pool;                          /*!< Pool nhận kết quả */
+    const book_list_t* list;                    /*!< Danh sách được quét */
+    query_field_t field;                        /*!< Trường tìm kiếm */
+    char needle[MAX_STRING_LENGTH];             /*!< Truy vấn đã chuyển sang chữ thường */
+} scan_match_ctx_t;
+
+/**
+ * \brief           Ngữ cảnh của một lần đếm
+ */
+typedef struct {
+    scan_pool_t* pool;                          /*!< Pool chứa tổng cục bộ */
+    const book_list_t* list;                    /*!< Danh sách được quét */
+} scan_count_ctx_t;
+
+/**
+ * \brief           Đóng gói dải phân đoạn [next, end) vào một từ 64 bit
+ * \param[in]       next: Phân đoạn kế tiếp
+ * \param[in]       end: Phân đoạn cuối (không tính)
+ * \return          Giá trị đã đóng gói
+ */
+static uint64_t
+scan_pack_range(uint32_t next, uint32_t end) {
+    return ((uint64_t)end << 32) | next;
+}
+
+/**
+ * \brief           Lấy phân đoạn kế tiếp từ đầu dải của chính worker
+ * \param[in,out]   slot: Trạng thái worker
+ * \return          Chỉ số phân đoạn, \ref SCAN_NO_CHUNK nếu hết
+ */
+static uint32_t
+scan_take_own(scan_slot_t* slot) {
+    uint64_t range;
+    uint32_t next;
+    uint32_t end;
+
+    range = atomic_load_explicit(&slot->range, memory_order_relaxed);
+    do {
+        next = (uint32_t)range;
+        end = (uint32_t)(range >> 32);
+        if (next >= end) {
+            return SCAN_NO_CHUNK;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&slot->range, &range, scan_pack_range(next + 1, end),
+                                                    memory_order_relaxed, memory_order_relaxed));
+    return next;
+}
+
+/**
+ * \brief           Lấy trộm phân đoạn cuối cùng trong dải của worker khác
+ * \param[in,out]   slot: Trạng thái worker bị lấy trộm
+ * \return          Chỉ số phân đoạn, \ref SCAN_NO_CHUNK nếu hết
+ */
+static uint32_t
+scan_steal(scan_slot_t* slot) {
+    uint64_t range;
+    uint32_t next;
+    uint32_t end;
+
+    range = atomic_load_explicit(&slot->range, memory_order_relaxed);
+    do {
+        next = (uint32_t)range;
+        end = (uint32_t)(range >> 32);
+        if (next >= end) {
+            return SCAN_NO_CHUNK;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&slot->range, &range, scan_pack_range(next, end - 1),
+                                                    memory_order_relaxed, memory_order_relaxed));
+    return end - 1;
+}
+
+/**
+ * \brief           Phần việc của một worker trong một lần quét
+ * \param[in,out]   pool: Con trỏ tới pool
+ * \param[in]       worker: Chỉ số worker
+ */
+static void
+scan_pool_work(scan_pool_t* pool, uint32_t worker) {
+    uint32_t chunk;
+    uint32_t victim;
+    uint32_t i;
+
+    while ((chunk = scan_take_own(&pool->slots[worker])) != SCAN_NO_CHUNK) {
+        pool->fn(pool->ctx, worker, chunk);
+    }
+
+    /* Hết việc của mình: lấy trộm lần lượt từ các worker khác */
+    for (i = 1; i < pool->worker_count; i++) {
+        victim = (worker + i) % pool->worker_count;
+        while ((chunk = scan_steal(&pool->slots[victim])) != SCAN_NO_CHUNK) {
+            atomic_fetch_add_explicit(&pool->steals, 1, memory_order_relaxed);
+            pool->fn(pool->ctx, worker, chunk);
+        }
+    }
+}
+
+/**
+ * \brief           Vòng lặp của luồng nền
+ * \param[in]       arg: Con trỏ tới \ref scan_thread_arg_t
+ * \return          NULL
+ */
+static void*
+scan_thread_main(void* arg) {
+    scan_thread_arg_t* thread_arg;
+    scan_pool_t* pool;
+    uint64_t seen;
+
+    thread_arg = arg;
+    pool = thread_arg->pool;
+    seen = 0;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->job_seq == seen) {
+            pthread_cond_wait(&pool->start_cond, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->job_seq;
+        pthread_mutex_unlock(&pool->lock);
+
+        scan_pool_work(pool, thread_arg->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/**
+ * \brief           Khởi tạo pool và tạo các luồng nền
+ * \param[out]      pool: Con trỏ tới pool
+ * \param[in]       workers: Số worker, 0 = theo số CPU đang online (không vượt số phân đoạn tối đa)
+ * \return          \ref SCAN_OK nếu thành công, \ref scan_status_t nếu lỗi
+ */
+scan_status_t
+scan_pool_init(scan_pool_t* pool, uint32_t workers) {
+    long cpus;
+    uint32_t i;
+
+    if (pool == NULL) {
+        return SCAN_INVALID_INPUT;
+    }
+
+    if (workers == 0) {
+        cpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif /* _SC_NPROCESSORS_ONLN */
+        workers = (cpus > 0) ? (uint32_t)cpus : 1;
+    }
+    if (workers > SCAN_MAX_WORKERS) {
+        workers = SCAN_MAX_WORKERS;
+    }
+
+    /*
+     * Không tạo luồng nền mà scan_pool_run không bao giờ dùng tới: danh sách
+     * đầy vẫn dưới ngưỡng song song thì chỉ cần luồng gọi, và không cần nhiều
+     * worker hơn số phân đoạn
+     */
+    if (SCAN_MAX_CHUNKS < SCAN_PARALLEL_MIN_CHUNKS) {
+        workers = 1;
+    } else if (workers > SCAN_MAX_CHUNKS) {
+        workers = (uint32_t)SCAN_MAX_CHUNKS;
+    }
+
+    pool->worker_count = 1;
+    pool->job_seq = 0;
+    pool->pending = 0;
+    pool->shutdown = 0;
+    pool->fn = NULL;
+    pool->ctx = NULL;
+    atomic_init(&pool->steals, 0);
+    for (i = 0; i < SCAN_MAX_WORKERS; i++) {
+        atomic_init(&pool->slots[i].range, 0);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    /* Worker 0 là luồng gọi; chỉ tạo luồng nền cho các worker còn lại */
+    for (i = 1; i < workers; i++) {
+        pool->args[i].pool = pool;
+        pool->args[i].index = i;
+        if (pthread_create(&pool->threads[i], NULL, scan_thread_main, &pool->args[i]) != 0) {
+            break;
+        }
+        pool->worker_count++;
+    }
+
+    return (pool->worker_count == workers) ? SCAN_OK : SCAN_ERROR;
+}
+
+/**
+ * \brief           Dừng các luồng nền và giải phóng tài nguyên đồng bộ
+ * \param[in,out]   pool: Con trỏ tới pool
+ */
+void
+scan_pool_destroy(scan_pool_t* pool) {
+    uint32_t i;
+
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 1; i < pool->worker_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->worker_count = 1;
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/**
+ * \brief           Chạy \p fn trên mọi phân đoạn [0, chunk_count) và chờ xong
+ *
+ * Phân đoạn được chia đều thành các dải liên tiếp cho từng worker; worker
+ * xong sớm lấy trộm phân đoạn từ cuối dải của worker khác. Khi chỉ có một
+ * worker hoặc quá ít phân đoạn thì chạy ngay trên luồng gọi.
+ *
+ * \param[in,out]   pool: Con trỏ tới pool
+ * \param[in]       chunk_count: Số phân đoạn
+ * \param[in]       fn: Hàm xử lý phân đoạn
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p fn
+ */
+void
+scan_pool_run(scan_pool_t* pool, uint32_t chunk_count, scan_chunk_fn fn, void* ctx) {
+    uint32_t workers;
+    uint32_t i;
+
+    if (pool == NULL || fn == NULL || chunk_count == 0) {
+        return;
+    }
+
+    workers = pool->worker_count;
+    if (workers == 1 || chunk_count < SCAN_PARALLEL_MIN_CHUNKS) {
+        for (i = 0; i < chunk_count; i++) {
+            fn(ctx, 0, i);
+        }
+        return;
+    }
+
+    pool->fn = fn;
+    pool->ctx = ctx;
+    for (i = 0; i < workers; i++) {
+        atomic_store_explicit(&pool->slots[i].range,
+                              scan_pack_range((uint32_t)((uint64_t)chunk_count * i / workers),
+                                              (uint32_t)((uint64_t)chunk_count * (i + 1) / workers)),
+                              memory_order_relaxed);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->pending = workers - 1;
+    pool->job_seq++;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    scan_pool_work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * \brief           Tìm kiếm trong một phân đoạn; kết quả ghi vào đúng dải vị trí của phân đoạn
+ * \param[in,out]   ctx: Con trỏ tới \ref scan_match_ctx_t
+ * \param[in]       worker: Chỉ số worker (không dùng)
+ * \param[in]       chunk: Chỉ số phân đoạn
+ */
+static void
+scan_match_chunk(void* ctx, uint32_t worker, uint32_t chunk) {
+    scan_match_ctx_t* match;
+    const book_t* book;
+    uint32_t* out;
+    size_t begin;
+    size_t end;
+    size_t i;
+    uint32_t found;
+
+    (void)worker;
+    match = ctx;
+    begin = (size_t)chunk * SCAN_CHUNK_ITEMS;
+    end = begin + SCAN_CHUNK_ITEMS;
+    if (end > match->list->count) {
+        end = match->list->count;
+    }
+
+    /* Số kết quả không vượt quá số sách của phân đoạn nên dùng chung dải vị trí */
+    out = &match->pool->positions[begin];
+    found = 0;
+    for (i = begin; i < end; i++) {
+        book = &match->list->books[i];
+        if (string_contains_lower(match->field == QUERY_FIELD_TITLE ? book->title : book->author,
+                                  match->needle)) {
+            out[found++] = (uint32_t)i;
+        }
+    }
+    match->pool->chunk_counts[chunk] = found;
+}
+
+/**
+ * \brief           Hàm so sánh khóa (ID << 32 | vị trí) cho qsort
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+scan_compare_keys(const void* a, const void* b) {
+    uint64_t x;
+    uint64_t y;
+
+    x = *(const uint64_t*)a;
+    y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           Tìm sách theo tiêu đề hoặc tác giả bằng quét song song
+ *
+ * Kết quả của các phân đoạn được nối theo thứ tự phân đoạn, sau đó sắp xếp lại
+ * theo ID nếu danh sách không theo thứ tự ID (chỉ xảy ra khi thêm sách với ID
+ * chỉ định nhỏ hơn các ID hiện có).
+ *
+ * \param[in,out]   pool: Con trỏ tới pool
+ * \param[in]       list: Danh sách sách
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       query: Chuỗi cần tìm (không phân biệt hoa thường)
+ * \param[out]      result: Kết quả tìm kiếm
+ * \return          \ref SCAN_OK nếu thành công, \ref scan_status_t nếu lỗi
+ */
+scan_status_t
+scan_books_match(scan_pool_t* pool, const book_list_t* list, query_field_t field,
+                 const char* query, scan_result_t* result) {
+    scan_match_ctx_t ctx;
+    uint32_t chunk_count;
+    uint32_t chunk;
+    size_t count;
+    size_t found;
+    size_t i;
+    uint8_t sorted;
+
+    if (pool == NULL || list == NULL || query == NULL || result == NULL || field > QUERY_FIELD_AUTHOR) {
+        return SCAN_INVALID_INPUT;
+    }
+
+    ctx.pool = pool;
+    ctx.list = list;
+    ctx.field = field;
+    strncpy(ctx.needle, query, MAX_STRING_LENGTH - 1);
+    ctx.needle[MAX_STRING_LENGTH - 1] = '\0';
+    to_lowercase(ctx.needle);
+
+    chunk_count = (uint32_t)((list->count + SCAN_CHUNK_ITEMS - 1) / SCAN_CHUNK_ITEMS);
+    scan_pool_run(pool, chunk_count, scan_match_chunk, &ctx);
+
+    /* Nối kết quả các phân đoạn về đầu mảng */
+    count = 0;
+    for (chunk = 0; chunk < chunk_count; chunk++) {
+        found = pool->chunk_counts[chunk];
+        if (found > 0 && count != (size_t)chunk * SCAN_CHUNK_ITEMS) {
+            memmove(&pool->positions[count], &pool->positions[(size_t)chunk * SCAN_CHUNK_ITEMS],
+                    found * sizeof(pool->positions[0]));
+        }
+        count += found;
+    }
+
+    /* Đưa về thứ tự ID */
+    sorted = 1;
+    for (i = 1; i < count && sorted; i++) {
+        if (list->books[pool->positions[i]].book_id < list->books[pool->positions[i - 1]].book_id) {
+            sorted = 0;
+        }
+    }
+    if (!sorted) {
+        for (i = 0; i < count; i++) {
+            pool->sort_keys[i] = ((uint64_t)list->books[pool->positions[i]].book_id << 32) | pool->positions[i];
+        }
+        qsort(pool->sort_keys, count, sizeof(pool->sort_keys[0]), scan_compare_keys);
+        for (i = 0; i < count; i++) {
+            pool->positions[i] = (uint32_t)pool->sort_keys[i];
+        }
+    }
+
+    result->positions = pool->positions;
+    result->count = count;
+    return SCAN_OK;
+}
+
+/**
+ * \brief           Đếm trong một phân đoạn, cộng vào tổng cục bộ của worker
+ * \param[in,out]   ctx: Con trỏ tới \ref scan_count_ctx_t
+ * \param[in]       worker: Chỉ số worker
+ * \param[in]       chunk: Chỉ số phân đoạn
+ */
+static void
+scan_count_chunk(void* ctx, uint32_t worker, uint32_t chunk) {
+    scan_count_ctx_t* count;
+    const book_t* book;
+    uint64_t copies;
+    uint64_t available;
+    size_t begin;
+    size_t end;
+    size_t i;
+
+    count = ctx;
+    begin = (size_t)chunk * SCAN_CHUNK_ITEMS;
+    end = begin + SCAN_CHUNK_ITEMS;
+    if (end > count->list->count) {
+        end = count->list->count;
+    }
+
+    copies = 0;
+    available = 0;
+    for (i = begin; i < end; i++) {
+        book = &count->list->books[i];
+        copies += book->copy_count;
+        available += book->available_count;
+    }
+    count->pool->slots[worker].partial[0] += end - begin;
+    count->pool->slots[worker].partial[1] += copies;
+    count->pool->slots[worker].partial[2] += available;
+}
+
+/**
+ * \brief           Đếm đầu sách, bản sao, bản đang mượn và bản có sẵn trong một lần quét
+ * \param[in,out]   pool: Con trỏ tới pool (NULL = đếm tuần tự)
+ * \param[in]       list: Danh sách sách
+ * \param[out]      counts: Kết quả đếm
+ */
+void
+scan_books_count(scan_pool_t* pool, const book_list_t* list, scan_counts_t* counts) {
+    scan_count_ctx_t ctx;
+    uint32_t chunk_count;
+    uint32_t i;
+
+    if (list == NULL || counts == NULL) {
+        return;
+    }
+
+    if (pool == NULL) {
+        counts->titles = book_count_total(list);
+        counts->copies = book_count_copies(list);
+        counts->borrowed = book_count_borrowed(list);
+        counts->available = book_count_available(list);
+        return;
+    }
+
+    for (i = 0; i < pool->worker_count; i++) {
+        memset(pool->slots[i].partial, 0, sizeof(pool->slots[i].partial));
+    }
+
+    ctx.pool = pool;
+    ctx.list = list;
+    chunk_count = (uint32_t)((list->count + SCAN_CHUNK_ITEMS - 1) / SCAN_CHUNK_ITEMS);
+    scan_pool_run(pool, chunk_count, scan_count_chunk, &ctx);
+
+    counts->titles = 0;
+    counts->copies = 0;
+    counts->available = 0;
+    for (i = 0; i < pool->worker_count; i++) {
+        counts->titles += pool->slots[i].partial[0];
+        counts->copies += pool->slots[i].partial[1];
+        counts->available += pool->slots[i].partial[2];
+    }
+    counts->borrowed = counts->copies - counts->available;
+}
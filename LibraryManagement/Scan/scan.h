@@ -0,0 +1,156 @@
+/**
+ * \file            scan.h
+ * \brief           Bộ quét song song theo phân đoạn (thread pool + work stealing)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef SCAN_HDR_H
+#define SCAN_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../Book/book.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define SCAN_MAX_WORKERS            64          /*!< Số luồng quét tối đa (kể cả luồng gọi) */
+#define SCAN_CACHE_LINE             64          /*!< Kích thước cache line */
+#define SCAN_CHUNK_BYTES            (16u * 1024u) /*!< Kích thước dữ liệu mỗi phân đoạn (~30 sách, vừa L1/L2) */
+#define SCAN_CHUNK_ITEMS            ((SCAN_CHUNK_BYTES + sizeof(book_t) - 1) / sizeof(book_t)) /*!< Số sách mỗi phân đoạn */
+#define SCAN_PARALLEL_MIN_CHUNKS    16          /*!< Dưới ngưỡng này quét trên luồng gọi (rẻ hơn đánh thức luồng nền) */
+#define SCAN_MAX_CHUNKS             ((MAX_BOOKS + SCAN_CHUNK_ITEMS - 1) / SCAN_CHUNK_ITEMS)
+#define SCAN_NO_CHUNK               UINT32_MAX  /*!< Không còn phân đoạn để lấy */
+
+/**
+ * \brief           Trạng thái trả về của các hàm quét
+ */
+typedef enum {
+    SCAN_OK = 0,                                /*!< Thành công */
+    SCAN_ERROR,                                 /*!< Lỗi chung (không tạo được luồng, ...) */
+    SCAN_INVALID_INPUT,                         /*!< Dữ liệu đầu vào không hợp lệ */
+} scan_status_t;
+
+/**
+ * \brief           Trường được tìm kiếm
+ */
+typedef enum {
+    QUERY_FIELD_TITLE = 0,                      /*!< Tiêu đề */
+    QUERY_FIELD_AUTHOR,                         /*!< Tác giả */
+} query_field_t;
+
+/**
+ * \brief           Hàm xử lý một phân đoạn
+ * \param[in,out]   ctx: Ngữ cảnh do người gọi truyền vào
+ * \param[in]       worker: Chỉ số luồng đang chạy (0 = luồng gọi)
+ * \param[in]       chunk: Chỉ số phân đoạn
+ */
+typedef void (*scan_chunk_fn)(void* ctx, uint32_t worker, uint32_t chunk);
+
+/**
+ * \brief           Trạng thái riêng của một luồng, chiếm trọn cache line để tránh false sharing
+ */
+typedef struct {
+    _Alignas(SCAN_CACHE_LINE) _Atomic uint64_t range; /*!< Phân đoạn còn lại: 32 bit thấp = next, 32 bit cao = end */
+    uint64_t partial[4];                        /*!< Tổng cục bộ cho các phép đếm */
+} scan_slot_t;
+
+/**
+ * \brief           Tham số khởi động của một luồng
+ */
+typedef struct {
+    void* pool;                                 /*!< Pool sở hữu luồng */
+    uint32_t index;                             /*!< Chỉ số luồng */
+} scan_thread_arg_t;
+
+/**
+ * \brief           Pool luồng quét
+ *
+ * Luồng gọi \ref scan_pool_run là worker 0, các luồng nền là worker 1..n-1.
+ * Mỗi worker nhận một dải phân đoạn liên tiếp, lấy dần từ đầu dải của mình,
+ * hết việc thì lấy trộm từ cuối dải của worker khác. Pool chỉ phục vụ một
+ * lần quét tại một thời điểm.
+ */
+typedef struct {
+    pthread_t threads[SCAN_MAX_WORKERS];        /*!< Các luồng nền */
+    scan_thread_arg_t args[SCAN_MAX_WORKERS];   /*!< Tham số của từng luồng */
+    scan_slot_t slots[SCAN_MAX_WORKERS];        /*!< Trạng thái của từng worker */
+    uint32_t worker_count;                      /*!< Số worker (kể cả luồng gọi) */
+    pthread_mutex_t lock;                       /*!< Khóa điều phối */
+    pthread_cond_t start_cond;                  /*!< Báo có việc mới */
+    pthread_cond_t done_cond;                   /*!< Báo các luồng nền đã xong */
+    uint64_t job_seq;                           /*!< Số thứ tự lần quét */
+    uint32_t pending;                           /*!< Số luồng nền chưa xong lần quét hiện tại */
+    uint8_t shutdown;                           /*!< 1 khi pool đang dừng */
+    scan_chunk_fn fn;                           /*!< Hàm xử lý của lần quét hiện tại */
+    void* ctx;                                  /*!< Ngữ cảnh của lần quét hiện tại */
+    _Atomic uint64_t steals;                    /*!< Tổng số phân đoạn bị lấy trộm */
+    uint32_t positions[MAX_BOOKS];              /*!< Kết quả tìm kiếm (vị trí trong danh sách) */
+    uint32_t chunk_counts[SCAN_MAX_CHUNKS];     /*!< Số kết quả của từng phân đoạn */
+    uint64_t sort_keys[MAX_BOOKS];              /*!< Vùng đệm sắp xếp theo ID */
+} scan_pool_t;
+
+/**
+ * \brief           Kết quả tìm kiếm; con trỏ trỏ vào pool và hợp lệ tới lần quét kế tiếp
+ */
+typedef struct {
+    const uint32_t* positions;                  /*!< Vị trí các sách khớp, theo thứ tự ID tăng dần */
+    size_t count;                               /*!< Số sách khớp */
+} scan_result_t;
+
+/**
+ * \brief           Kết quả đếm
+ */
+typedef struct {
+    size_t titles;                              /*!< Số đầu sách */
+    size_t copies;                              /*!< Số bản sao */
+    size_t borrowed;                            /*!< Số bản đang được mượn */
+    size_t available;                           /*!< Số bản có sẵn */
+} scan_counts_t;
+
+/* Khai báo các hàm quản lý pool */
+scan_status_t   scan_pool_init(scan_pool_t* pool, uint32_t workers);
+void            scan_pool_destroy(scan_pool_t* pool);
+void            scan_pool_run(scan_pool_t* pool, uint32_t chunk_count, scan_chunk_fn fn, void* ctx);
+
+/* Khai báo các hàm quét danh sách sách */
+scan_status_t   scan_books_match(scan_pool_t* pool, const book_list_t* list, query_field_t field,
+                                 const char* query, scan_result_t* result);
+void            scan_books_count(scan_pool_t* pool, const book_list_t* list, scan_counts_t* counts);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SCAN_HDR_H */
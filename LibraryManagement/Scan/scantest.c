@@ -0,0 +1,219 @@
+/**
+ * \file            scantest.c
+ * \brief           library_scantest: kiểm tra pool quét song song (chia phân đoạn và lấy trộm việc)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "scan.h"
+
+#define SCANTEST_WORKERS            4           /* Số worker của pool song song */
+#define SCANTEST_SLOW_NS            2000000L    /* Thời gian xử lý một phân đoạn chậm (2 ms) */
+
+/**
+ * \brief           Ngữ cảnh của lần quét kiểm tra lấy trộm việc
+ */
+typedef struct {
+    _Atomic uint32_t hits[SCAN_MAX_CHUNKS];     /*!< Số lần mỗi phân đoạn được xử lý */
+    uint32_t ran_by[SCAN_MAX_CHUNKS];           /*!< Worker đã xử lý phân đoạn */
+    uint32_t slow_end;                          /*!< Các phân đoạn [0, slow_end) xử lý chậm */
+} scantest_steal_ctx_t;
+
+/* Dữ liệu nằm ở vùng tĩnh để không phụ thuộc kích thước stack */
+static book_list_t scantest_books;
+static scan_pool_t scantest_serial;
+static scan_pool_t scantest_parallel;
+static scantest_steal_ctx_t scantest_steal;
+static size_t scantest_failures;
+
+/**
+ * \brief           Ghi nhận kết quả một phép kiểm tra
+ * \param[in]       ok: Khác 0 nếu đạt
+ * \param[in]       what: Mô tả phép kiểm tra
+ */
+static void
+scantest_check(int ok, const char* what) {
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok) {
+        scantest_failures++;
+    }
+}
+
+/**
+ * \brief           Xử lý một phân đoạn; dải của worker 0 chạy chậm để các worker khác lấy trộm
+ * \param[in,out]   ctx: Con trỏ tới \ref scantest_steal_ctx_t
+ * \param[in]       worker: Chỉ số worker
+ * \param[in]       chunk: Chỉ số phân đoạn
+ */
+static void
+scantest_steal_chunk(void* ctx, uint32_t worker, uint32_t chunk) {
+    scantest_steal_ctx_t* steal;
+    struct timespec delay;
+
+    steal = ctx;
+    atomic_fetch_add_explicit(&steal->hits[chunk], 1, memory_order_relaxed);
+    steal->ran_by[chunk] = worker;
+    if (chunk < steal->slow_end) {
+        delay.tv_sec = 0;
+        delay.tv_nsec = SCANTEST_SLOW_NS;
+        nanosleep(&delay, NULL);
+    }
+}
+
+/**
+ * \brief           Kiểm tra mọi phân đoạn được xử lý đúng một lần và việc bị lấy trộm khỏi worker chậm
+ */
+static void
+scantest_run_steal(void) {
+    uint32_t chunks;
+    uint32_t i;
+    uint8_t once;
+    uint8_t moved;
+
+    chunks = (uint32_t)SCAN_MAX_CHUNKS;
+    scantest_steal.slow_end = chunks / scantest_parallel.worker_count;
+    for (i = 0; i < chunks; i++) {
+        atomic_init(&scantest_steal.hits[i], 0);
+        scantest_steal.ran_by[i] = 0;
+    }
+    atomic_store(&scantest_parallel.steals, 0);
+
+    scan_pool_run(&scantest_parallel, chunks, scantest_steal_chunk, &scantest_steal);
+
+    once = 1;
+    for (i = 0; i < chunks; i++) {
+        if (atomic_load(&scantest_steal.hits[i]) != 1) {
+            once = 0;
+        }
+    }
+    moved = 0;
+    for (i = 0; i < scantest_steal.slow_end; i++) {
+        if (scantest_steal.ran_by[i] != 0) {
+            moved = 1;
+        }
+    }
+    scantest_check(once, "mọi phân đoạn được xử lý đúng một lần");
+    scantest_check(atomic_load(&scantest_parallel.steals) > 0, "worker rảnh lấy trộm phân đoạn");
+    scantest_check(moved, "phân đoạn của worker chậm được worker khác xử lý");
+}
+
+/**
+ * \brief           Kiểm tra tìm kiếm và đếm song song cho kết quả giống quét tuần tự
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       query: Chuỗi cần tìm
+ */
+static void
+scantest_run_match(query_field_t field, const char* query) {
+    scan_result_t serial;
+    scan_result_t parallel;
+    size_t i;
+    uint8_t same;
+    char what[128];
+
+    scan_books_match(&scantest_serial, &scantest_books, field, query, &serial);
+    scan_books_match(&scantest_parallel, &scantest_books, field, query, &parallel);
+
+    same = (serial.count == parallel.count) ? 1 : 0;
+    for (i = 0; i < serial.count && same; i++) {
+        if (serial.positions[i] != parallel.positions[i]) {
+            same = 0;
+        }
+    }
+    snprintf(what, sizeof(what), "tìm \"%s\": %zu kết quả, song song khớp tuần tự", query, serial.count);
+    scantest_check(same && serial.count > 0, what);
+}
+
+/**
+ * \brief           Hàm chính
+ * \return          0 nếu mọi kiểm tra đạt, 1 nếu có lỗi
+ */
+int
+main(void) {
+    scan_counts_t serial;
+    scan_counts_t parallel;
+    uint32_t chunks;
+    uint32_t id;
+    uint32_t i;
+    uint8_t copy;
+    char title[MAX_STRING_LENGTH];
+    char author[MAX_STRING_LENGTH];
+
+    printf("library_scantest: %zu sách/phân đoạn, tối đa %zu phân đoạn, ngưỡng song song %u\n",
+           (size_t)SCAN_CHUNK_ITEMS, (size_t)SCAN_MAX_CHUNKS, (unsigned)SCAN_PARALLEL_MIN_CHUNKS);
+
+    scan_pool_init(&scantest_serial, 1);
+    scan_pool_init(&scantest_parallel, SCANTEST_WORKERS);
+    if (SCAN_MAX_CHUNKS < SCAN_PARALLEL_MIN_CHUNKS) {
+        /* Danh sách đầy vẫn quét tuần tự: pool không được giữ luồng nền chờ vô ích */
+        scantest_check(scantest_parallel.worker_count == 1, "không tạo luồng nền khi không đạt ngưỡng song song");
+    } else {
+        scantest_check(scantest_parallel.worker_count > 1, "pool song song có luồng nền");
+        scantest_run_steal();
+
+        /* Danh sách đầy phải đi qua nhánh song song của scan_pool_run */
+        book_init(&scantest_books);
+        for (i = 0; i < MAX_BOOKS; i++) {
+            snprintf(title, sizeof(title), "%s tap %u", (i % 7 == 0) ? "Lap trinh C" : "Tieu thuyet", i);
+            snprintf(author, sizeof(author), "Tac gia %u", i % 13);
+            if (book_add(&scantest_books, title, author, &id) != BOOK_OK) {
+                break;
+            }
+            book_add_copies(&scantest_books, id, (uint8_t)(i % 3));
+            if (i % 5 == 0) {
+                book_checkout_copy(&scantest_books, id, &copy);
+            }
+        }
+        chunks = (uint32_t)((scantest_books.count + SCAN_CHUNK_ITEMS - 1) / SCAN_CHUNK_ITEMS);
+        scantest_check(chunks >= SCAN_PARALLEL_MIN_CHUNKS, "danh sách đầy vượt ngưỡng song song");
+
+        scantest_run_match(QUERY_FIELD_TITLE, "lap trinh");
+        scantest_run_match(QUERY_FIELD_AUTHOR, "tac gia 7");
+
+        scan_books_count(&scantest_serial, &scantest_books, &serial);
+        scan_books_count(&scantest_parallel, &scantest_books, &parallel);
+        scantest_check(serial.titles == parallel.titles && serial.copies == parallel.copies
+                       && serial.borrowed == parallel.borrowed && serial.available == parallel.available
+                       && parallel.titles == scantest_books.count,
+                       "thống kê song song khớp tuần tự");
+    }
+
+    scan_pool_destroy(&scantest_parallel);
+    scan_pool_destroy(&scantest_serial);
+
+    if (scantest_failures > 0) {
+        printf("library_scantest: %zu kiểm tra không đạt\n", scantest_failures);
+        return 1;
+    }
+    printf("library_scantest: mọi kiểm tra đạt\n");
+    return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * \file            screen.c
+ * \brief           Màn hình đệm (một lần write mỗi màn hình) và bộ phân trang
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif /* _WIN32 */
+#include "screen.h"
+#include "../Ultils/utils.h"
+
+/* Bộ đệm của stdout; phải sống suốt chương trình */
+static char screen_buffer[SCREEN_BUFFER_SIZE];
+
+/**
+ * \brief           Chuyển stdout sang chế độ đệm toàn phần
+ *
+ * Mặc định stdout nối với terminal được đệm theo dòng nên mỗi dòng của một
+ * danh sách là một lần gọi write. Với bộ đệm toàn phần, cả màn hình (mã xóa
+ * màn hình, menu, bảng, lời nhắc) nằm trong bộ đệm cho tới khi các hàm đọc
+ * đầu vào ở utils gọi fflush, nên được ghi ra bằng một lần write. Phải gọi
+ * trước khi in bất cứ thứ gì.
+ */
+void
+screen_init(void) {
+#ifdef _WIN32
+    HANDLE console;
+    DWORD mode;
+
+    /* Bật xử lý mã ANSI cho console Windows 10 trở lên */
+    console = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (console != INVALID_HANDLE_VALUE && GetConsoleMode(console, &mode)) {
+        SetConsoleMode(console, mode | 0x0004 /* ENABLE_VIRTUAL_TERMINAL_PROCESSING */);
+    }
+#endif /* _WIN32 */
+
+    setvbuf(stdout, screen_buffer, _IOFBF, sizeof(screen_buffer));
+}
+
+/**
+ * \brief           Số dòng của terminal
+ * \return          Số dòng, \ref SCREEN_DEFAULT_ROWS nếu không xác định được
+ */
+size_t
+screen_rows(void) {
+    const char* lines;
+    long value;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        return (size_t)(info.srWindow.Bottom - info.srWindow.Top + 1);
+    }
+#else
+    struct winsize size;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0) {
+        return size.ws_row;
+    }
+#endif /* _WIN32 */
+
+    lines = getenv("LINES");
+    if (lines != NULL) {
+        value = strtol(lines, NULL, 10);
+        if (value > 0) {
+            return (size_t)value;
+        }
+    }
+    return SCREEN_DEFAULT_ROWS;
+}
+
+/**
+ * \brief           Số dòng dữ liệu mỗi trang của pager
+ * \return          Số dòng trong [\ref SCREEN_MIN_PAGE_ROWS, \ref SCREEN_MAX_PAGE_ROWS]
+ */
+size_t
+screen_page_rows(void) {
+    size_t rows;
+
+    rows = screen_rows();
+    rows = (rows > SCREEN_CHROME_ROWS) ? rows - SCREEN_CHROME_ROWS : 0;
+    if (rows < SCREEN_MIN_PAGE_ROWS) {
+        rows = SCREEN_MIN_PAGE_ROWS;
+    }
+    if (rows > SCREEN_MAX_PAGE_ROWS) {
+        rows = SCREEN_MAX_PAGE_ROWS;
+    }
+    return rows;
+}
+
+/**
+ * \brief           Hiển thị một danh sách theo từng trang vừa màn hình
+ *
+ * Mỗi lần vẽ chỉ lấy các dòng của trang đang xem qua \p page. Danh sách vừa
+ * một trang hiển thị như trước (Enter để quay lại). Điều khiển: Enter hoặc n
+ * = trang sau, p = trang trước, số = tới trang, q = thoát.
+ *
+ * \param[in]       title: Tiêu đề màn hình
+ * \param[in]       header: Hàm in tiêu đề bảng (có thể NULL)
+ * \param[in]       page: Hàm lấy và in một trang
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p page
+ * \param[in]       total: Tổng số dòng, \ref SCREEN_TOTAL_UNKNOWN nếu chưa biết
+ * \param[in]       empty: Thông báo khi danh sách rỗng
+ */
+void
+screen_pager(const char* title, screen_header_fn header, screen_page_fn page, void* ctx,
+             size_t total, const char* empty) {
+    char input[MAX_INPUT_LENGTH];
+    size_t rows;
+    size_t current;
+    size_t shown;
+    size_t pages;
+    long target;
+    uint8_t more;
+
+    if (title == NULL || page == NULL) {
+        return;
+    }
+
+    current = 0;
+    while (1) {
+        /* Kích thước đọc lại mỗi lần vẽ để theo kịp khi terminal đổi cỡ */
+        rows = screen_page_rows();
+        pages = (total != SCREEN_TOTAL_UNKNOWN) ? (total + rows - 1) / rows : 0;
+        if (pages > 0 && current >= pages) {
+            current = pages - 1;
+        }
+
+        clear_screen();
+        print_header(title);
+        if (header != NULL) {
+            header();
+        }
+        more = 0;
+        shown = page(ctx, current * rows, rows, &more);
+
+        if (shown == 0 && current == 0) {
+            printf("\n  %s\n", (empty != NULL) ? empty : "Danh sách trống!");
+        } else if (total != SCREEN_TOTAL_UNKNOWN) {
+            printf("\n  Trang %zu/%zu (%zu-%zu trên %zu)\n", current + 1, pages, current * rows + 1,
+                   current * rows + shown, total);
+        } else {
+            printf("\n  Trang %zu (%zu-%zu)\n", current + 1, current * rows + 1, current * rows + shown);
+        }
+
+        /* Vừa một trang: giữ cách dùng cũ */
+        if (!more && current == 0) {
+            pause_screen();
+            return;
+        }
+
+        if (read_string(input, sizeof(input), "  [Enter/n] trang sau  [p] trang trước  [số] tới trang  [q] thoát: ")
+            != UTILS_OK) {
+            input[0] = '\0';
+        }
+        if (input[0] == 'q' || input[0] == 'Q') {
+            return;
+        }
+        if (input[0] == 'p' || input[0] == 'P') {
+            if (current > 0) {
+                current--;
+            }
+        } else if (input[0] >= '0' && input[0] <= '9') {
+            target = strtol(input, NULL, 10);
+            if (target >= 1 && (pages == 0 || (size_t)target <= pages)) {
+                current = (size_t)target - 1;
+            }
+        } else if (more) {
+            current++;
+        } else {
+            return;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * \file            screen.h
+ * \brief           Khai báo màn hình đệm và bộ phân trang cho giao diện dòng lệnh
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef SCREEN_HDR_H
+#define SCREEN_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define SCREEN_BUFFER_SIZE          (64u * 1024u) /*!< Bộ đệm stdout: một màn hình được ghi bằng một lần write */
+#define SCREEN_DEFAULT_ROWS         24          /*!< Số dòng khi không đọc được kích thước terminal */
+#define SCREEN_CHROME_ROWS          11          /*!< Số dòng tiêu đề, tiêu đề bảng và chân trang của pager */
+#define SCREEN_MIN_PAGE_ROWS        5           /*!< Số dòng dữ liệu tối thiểu mỗi trang */
+#define SCREEN_MAX_PAGE_ROWS        128         /*!< Số dòng dữ liệu tối đa mỗi trang */
+#define SCREEN_TOTAL_UNKNOWN        SIZE_MAX    /*!< Tổng số dòng chưa biết (chỉ biết còn trang sau hay không) */
+
+/**
+ * \brief           Hàm in tiêu đề bảng của pager
+ */
+typedef void (*screen_header_fn)(void);
+
+/**
+ * \brief           Hàm lấy và in một trang
+ * \param[in]       ctx: Ngữ cảnh do người gọi truyền vào
+ * \param[in]       offset: Số dòng bỏ qua
+ * \param[in]       rows: Số dòng tối đa cần in
+ * \param[out]      more: 1 nếu còn dòng sau trang này
+ * \return          Số dòng đã in
+ */
+typedef size_t (*screen_page_fn)(void* ctx, size_t offset, size_t rows, uint8_t* more);
+
+/* Khai báo các hàm màn hình */
+void            screen_init(void);
+size_t          screen_rows(void);
+size_t          screen_page_rows(void);
+void            screen_pager(const char* title, screen_header_fn header, screen_page_fn page, void* ctx,
+                             size_t total, const char* empty);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SCREEN_HDR_H */
@@ -0,0 +1,479 @@
+/**
+ * \file            client.c
+ * \brief           Triển khai thư viện client cho library_server
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "client.h"
+
+#define CLIENT_INITIAL_BUFFER       8192        /* Bộ đệm ban đầu */
+
+/**
+ * \brief           Đảm bảo bộ đệm có ít nhất \p need byte
+ * \param[in,out]   buf: Con trỏ tới bộ đệm
+ * \param[in,out]   cap: Dung lượng hiện tại
+ * \param[in]       need: Dung lượng cần có
+ * \return          1 nếu thành công, 0 nếu hết bộ nhớ
+ */
+static uint8_t
+client_reserve(uint8_t** buf, size_t* cap, size_t need) {
+    size_t new_cap;
+    uint8_t* new_buf;
+
+    if (need <= *cap) {
+        return 1;
+    }
+    new_cap = (*cap == 0) ? CLIENT_INITIAL_BUFFER : *cap;
+    while (new_cap < need) {
+        new_cap *= 2;
+    }
+    new_buf = realloc(*buf, new_cap);
+    if (new_buf == NULL) {
+        return 0;
+    }
+    *buf = new_buf;
+    *cap = new_cap;
+    return 1;
+}
+
+/**
+ * \brief           Mở đầu một frame yêu cầu trong bộ đệm gửi
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       opcode: Opcode
+ * \param[in]       payload_len: Độ dài payload sẽ ghi tiếp
+ * \param[out]      request_id: ID của yêu cầu (có thể NULL)
+ * \return          Con trỏ tới vùng payload, NULL nếu lỗi
+ */
+static uint8_t*
+client_begin(client_t* client, uint8_t opcode, size_t payload_len, uint32_t* request_id) {
+    uint8_t* dst;
+    uint32_t id;
+
+    if (PROTO_HEADER_SIZE + payload_len > PROTO_MAX_FRAME
+        || !client_reserve(&client->wbuf, &client->wcap, client->wlen + PROTO_HEADER_SIZE + payload_len)) {
+        return NULL;
+    }
+
+    id = client->next_request_id++;
+    dst = &client->wbuf[client->wlen];
+    proto_put_u32(dst, (uint32_t)(PROTO_HEADER_SIZE - 4 + payload_len));
+    proto_put_u32(&dst[4], id);
+    dst[8] = opcode;
+    dst[9] = 0;
+    client->wlen += PROTO_HEADER_SIZE + payload_len;
+
+    if (request_id != NULL) {
+        *request_id = id;
+    }
+    return &dst[PROTO_HEADER_SIZE];
+}
+
+/**
+ * \brief           Kết nối tới server
+ * \param[out]      client: Con trỏ tới client
+ * \param[in]       path: Đường dẫn UNIX socket
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_connect(client_t* client, const char* path) {
+    struct sockaddr_un addr;
+
+    if (client == NULL || path == NULL || strlen(path) >= sizeof(addr.sun_path)) {
+        return CLIENT_INVALID_INPUT;
+    }
+
+    memset(client, 0, sizeof(*client));
+    client->next_request_id = 1;
+    client->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (client->fd < 0) {
+        return CLIENT_CONNECT_FAILED;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(client->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(client->fd);
+        client->fd = -1;
+        return CLIENT_CONNECT_FAILED;
+    }
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Đóng kết nối và giải phóng bộ đệm
+ * \param[in,out]   client: Con trỏ tới client
+ */
+void
+client_close(client_t* client) {
+    if (client == NULL) {
+        return;
+    }
+    if (client->fd >= 0) {
+        close(client->fd);
+    }
+    free(client->wbuf);
+    free(client->rbuf);
+    memset(client, 0, sizeof(*client));
+    client->fd = -1;
+}
+
+/**
+ * \brief           Xếp yêu cầu LOOKUP
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       book_id: ID sách
+ * \param[out]      request_id: ID yêu cầu (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_queue_lookup(client_t* client, uint32_t book_id, uint32_t* request_id) {
+    uint8_t* p;
+
+    p = client_begin(client, PROTO_OP_LOOKUP, 4, request_id);
+    if (p == NULL) {
+        return CLIENT_ERROR;
+    }
+    proto_put_u32(p, book_id);
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Xếp yêu cầu SEARCH
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       limit: Số bản ghi tối đa trả về
+ * \param[in]       query: Chuỗi cần tìm
+ * \param[out]      request_id: ID yêu cầu (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_queue_search(client_t* client, proto_field_t field, uint16_t limit,
+                    const char* query, uint32_t* request_id) {
+    size_t len;
+    uint8_t* p;
+
+    if (query == NULL) {
+        return CLIENT_INVALID_INPUT;
+    }
+    len = strlen(query);
+    if (len == 0 || len > UINT16_MAX) {
+        return CLIENT_INVALID_INPUT;
+    }
+
+    p = client_begin(client, PROTO_OP_SEARCH, 1 + 2 + 2 + len, request_id);
+    if (p == NULL) {
+        return CLIENT_ERROR;
+    }
+    p[0] = (uint8_t)field;
+    proto_put_u16(&p[1], limit);
+    proto_put_u16(&p[3], (uint16_t)len);
+    memcpy(&p[5], query, len);
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Xếp yêu cầu mượn/trả có payload (user_id, book_id)
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       opcode: \ref PROTO_OP_BORROW hoặc \ref PROTO_OP_RETURN
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \param[out]      request_id: ID yêu cầu (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+static client_status_t
+client_queue_circulation(client_t* client, uint8_t opcode, uint32_t user_id, uint32_t book_id,
+                         uint32_t* request_id) {
+    uint8_t* p;
+
+    p = client_begin(client, opcode, 8, request_id);
+    if (p == NULL) {
+        return CLIENT_ERROR;
+    }
+    proto_put_u32(p, user_id);
+    proto_put_u32(&p[4], book_id);
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Xếp yêu cầu BORROW
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \param[out]      request_id: ID yêu cầu (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_queue_borrow(client_t* client, uint32_t user_id, uint32_t book_id, uint32_t* request_id) {
+    return client_queue_circulation(client, PROTO_OP_BORROW, user_id, book_id, request_id);
+}
+
+/**
+ * \brief           Xếp yêu cầu RETURN
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \param[out]      request_id: ID yêu cầu (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_queue_return(client_t* client, uint32_t user_id, uint32_t book_id, uint32_t* request_id) {
+    return client_queue_circulation(client, PROTO_OP_RETURN, user_id, book_id, request_id);
+}
+
+/**
+ * \brief           Xếp yêu cầu STATS
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[out]      request_id: ID yêu cầu (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_queue_stats(client_t* client, uint32_t* request_id) {
+    return (client_begin(client, PROTO_OP_STATS, 0, request_id) != NULL) ? CLIENT_OK : CLIENT_ERROR;
+}
+
+/**
+ * \brief           Gửi toàn bộ yêu cầu đang chờ
+ * \param[in,out]   client: Con trỏ tới client
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_flush(client_t* client) {
+    size_t pos;
+    ssize_t n;
+
+    if (client == NULL || client->fd < 0) {
+        return CLIENT_INVALID_INPUT;
+    }
+
+    pos = 0;
+    while (pos < client->wlen) {
+        n = send(client->fd, &client->wbuf[pos], client->wlen - pos, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return CLIENT_IO_ERROR;
+        }
+        pos += (size_t)n;
+    }
+    client->wlen = 0;
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Chờ và đọc phản hồi kế tiếp (theo thứ tự yêu cầu)
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[out]      response: Phản hồi đọc được
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_read_response(client_t* client, client_response_t* response) {
+    uint32_t frame_len;
+    const uint8_t* frame;
+    ssize_t n;
+
+    if (client == NULL || response == NULL || client->fd < 0) {
+        return CLIENT_INVALID_INPUT;
+    }
+
+    while (1) {
+        /* Đã có đủ một frame trong bộ đệm */
+        if (client->rlen - client->rpos >= 4) {
+            frame_len = proto_get_u32(&client->rbuf[client->rpos]) + 4;
+            if (frame_len < PROTO_HEADER_SIZE || frame_len > PROTO_MAX_FRAME) {
+                return CLIENT_PROTOCOL_ERROR;
+            }
+            if (client->rlen - client->rpos >= frame_len) {
+                frame = &client->rbuf[client->rpos];
+                response->request_id = proto_get_u32(&frame[4]);
+                response->opcode = frame[8];
+                response->status = (proto_status_t)frame[9];
+                response->payload = &frame[PROTO_HEADER_SIZE];
+                response->payload_len = frame_len - PROTO_HEADER_SIZE;
+                client->rpos += frame_len;
+                return CLIENT_OK;
+            }
+        }
+
+        /* Dồn dữ liệu chưa đọc về đầu bộ đệm rồi nhận thêm */
+        if (client->rpos > 0) {
+            memmove(client->rbuf, &client->rbuf[client->rpos], client->rlen - client->rpos);
+            client->rlen -= client->rpos;
+            client->rpos = 0;
+        }
+        if (!client_reserve(&client->rbuf, &client->rcap, client->rlen + PROTO_MAX_FRAME)) {
+            return CLIENT_ERROR;
+        }
+        n = recv(client->fd, &client->rbuf[client->rlen], client->rcap - client->rlen, 0);
+        if (n == 0) {
+            return CLIENT_CLOSED;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return CLIENT_IO_ERROR;
+        }
+        client->rlen += (size_t)n;
+    }
+}
+
+/**
+ * \brief           Gửi các yêu cầu đang chờ và đọc một phản hồi
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[out]      response: Phản hồi đọc được
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+static client_status_t
+client_roundtrip(client_t* client, client_response_t* response) {
+    client_status_t status;
+
+    status = client_flush(client);
+    if (status != CLIENT_OK) {
+        return status;
+    }
+    return client_read_response(client, response);
+}
+
+/**
+ * \brief           Tra cứu sách theo ID (đồng bộ)
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       book_id: ID sách
+ * \param[out]      status: Trạng thái phản hồi
+ * \param[out]      book: Bản ghi sách (hợp lệ tới lần đọc kế tiếp)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_lookup(client_t* client, uint32_t book_id, proto_status_t* status, proto_book_t* book) {
+    client_response_t response;
+    proto_reader_t reader;
+    client_status_t result;
+
+    result = client_queue_lookup(client, book_id, NULL);
+    if (result == CLIENT_OK) {
+        result = client_roundtrip(client, &response);
+    }
+    if (result != CLIENT_OK) {
+        return result;
+    }
+
+    *status = response.status;
+    if (response.status == PROTO_OK) {
+        proto_reader_init(&reader, response.payload, response.payload_len);
+        if (!proto_decode_book(&reader, book)) {
+            return CLIENT_PROTOCOL_ERROR;
+        }
+    }
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Mượn sách (đồng bộ)
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \param[out]      status: Trạng thái phản hồi
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_borrow(client_t* client, uint32_t user_id, uint32_t book_id, proto_status_t* status) {
+    client_response_t response;
+    client_status_t result;
+
+    result = client_queue_borrow(client, user_id, book_id, NULL);
+    if (result == CLIENT_OK) {
+        result = client_roundtrip(client, &response);
+    }
+    if (result == CLIENT_OK) {
+        *status = response.status;
+    }
+    return result;
+}
+
+/**
+ * \brief           Trả sách (đồng bộ)
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \param[out]      status: Trạng thái phản hồi
+ * \param[out]      handed_to: Người đặt giữ nhận sách, 0 nếu không có (có thể NULL)
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_return(client_t* client, uint32_t user_id, uint32_t book_id, proto_status_t* status,
+              uint32_t* handed_to) {
+    client_response_t response;
+    client_status_t result;
+
+    result = client_queue_return(client, user_id, book_id, NULL);
+    if (result == CLIENT_OK) {
+        result = client_roundtrip(client, &response);
+    }
+    if (result != CLIENT_OK) {
+        return result;
+    }
+
+    *status = response.status;
+    if (handed_to != NULL) {
+        *handed_to = (response.payload_len >= 4) ? proto_get_u32(response.payload) : 0;
+    }
+    return CLIENT_OK;
+}
+
+/**
+ * \brief           Lấy thống kê (đồng bộ)
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[out]      stats: Thống kê
+ * \return          \ref CLIENT_OK nếu thành công, \ref client_status_t nếu lỗi
+ */
+client_status_t
+client_stats(client_t* client, proto_stats_t* stats) {
+    client_response_t response;
+    client_status_t result;
+
+    result = client_queue_stats(client, NULL);
+    if (result == CLIENT_OK) {
+        result = client_roundtrip(client, &response);
+    }
+    if (result != CLIENT_OK) {
+        return result;
+    }
+    if (response.status != PROTO_OK || !proto_decode_stats(response.payload, response.payload_len, stats)) {
+        return CLIENT_PROTOCOL_ERROR;
+    }
+    return CLIENT_OK;
+}
@@ -0,0 +1,116 @@
+/**
+ * \file            client.h
+ * \brief           Thư viện client cho library_server (hỗ trợ pipeline)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef CLIENT_HDR_H
+#define CLIENT_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \brief           Trạng thái trả về của các hàm client
+ */
+typedef enum {
+    CLIENT_OK = 0,                              /*!< Thành công */
+    CLIENT_ERROR,                               /*!< Lỗi chung (hết bộ nhớ, ...) */
+    CLIENT_INVALID_INPUT,                       /*!< Dữ liệu đầu vào không hợp lệ */
+    CLIENT_CONNECT_FAILED,                      /*!< Không kết nối được tới server */
+    CLIENT_IO_ERROR,                            /*!< Lỗi đọc/ghi socket */
+    CLIENT_CLOSED,                              /*!< Server đã đóng kết nối */
+    CLIENT_PROTOCOL_ERROR,                      /*!< Phản hồi sai định dạng */
+} client_status_t;
+
+/**
+ * \brief           Một kết nối tới server
+ */
+typedef struct {
+    int fd;                                     /*!< Socket */
+    uint32_t next_request_id;                   /*!< request_id cho yêu cầu kế tiếp */
+    uint8_t* wbuf;                              /*!< Yêu cầu đang chờ gửi */
+    size_t wlen;                                /*!< Số byte trong wbuf */
+    size_t wcap;                                /*!< Dung lượng wbuf */
+    uint8_t* rbuf;                              /*!< Dữ liệu đã nhận */
+    size_t rlen;                                /*!< Số byte trong rbuf */
+    size_t rpos;                                /*!< Vị trí frame chưa đọc đầu tiên */
+    size_t rcap;                                /*!< Dung lượng rbuf */
+} client_t;
+
+/**
+ * \brief           Một phản hồi; payload trỏ vào bộ đệm của client và chỉ hợp lệ
+ *                  tới lần gọi \ref client_read_response kế tiếp
+ */
+typedef struct {
+    uint32_t request_id;                        /*!< ID yêu cầu tương ứng */
+    uint8_t opcode;                             /*!< Opcode của yêu cầu */
+    proto_status_t status;                      /*!< Trạng thái */
+    const uint8_t* payload;                     /*!< Payload */
+    size_t payload_len;                         /*!< Độ dài payload */
+} client_response_t;
+
+/* Kết nối */
+client_status_t client_connect(client_t* client, const char* path);
+void            client_close(client_t* client);
+
+/* Xếp yêu cầu vào hàng đợi gửi (pipeline), chưa gửi ngay */
+client_status_t client_queue_lookup(client_t* client, uint32_t book_id, uint32_t* request_id);
+client_status_t client_queue_search(client_t* client, proto_field_t field, uint16_t limit,
+                                    const char* query, uint32_t* request_id);
+client_status_t client_queue_borrow(client_t* client, uint32_t user_id, uint32_t book_id,
+                                    uint32_t* request_id);
+client_status_t client_queue_return(client_t* client, uint32_t user_id, uint32_t book_id,
+                                    uint32_t* request_id);
+client_status_t client_queue_stats(client_t* client, uint32_t* request_id);
+
+/* Gửi/nhận */
+client_status_t client_flush(client_t* client);
+client_status_t client_read_response(client_t* client, client_response_t* response);
+
+/* Các hàm đồng bộ tiện dụng: gửi một yêu cầu và chờ phản hồi */
+client_status_t client_lookup(client_t* client, uint32_t book_id, proto_status_t* status,
+                              proto_book_t* book);
+client_status_t client_borrow(client_t* client, uint32_t user_id, uint32_t book_id,
+                              proto_status_t* status);
+client_status_t client_return(client_t* client, uint32_t user_id, uint32_t book_id,
+                              proto_status_t* status, uint32_t* handed_to);
+client_status_t client_stats(client_t* client, proto_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CLIENT_HDR_H */
@@ -0,0 +1,351 @@
+/**
+ * \file            loadgen.c
+ * \brief           Bộ sinh tải cho library_server
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "client.h"
+
+#define LOADGEN_MAX_SAMPLES         (1u << 20)  /* Số mẫu độ trễ tối đa mỗi luồng */
+
+/**
+ * \brief           Cấu hình chạy tải
+ */
+typedef struct {
+    const char* path;                           /*!< Đường dẫn socket */
+    uint32_t threads;                           /*!< Số luồng */
+    uint32_t connections;                       /*!< Số kết nối mỗi luồng */
+    uint32_t depth;                             /*!< Số yêu cầu pipeline mỗi kết nối mỗi vòng */
+    uint32_t seconds;                           /*!< Thời gian chạy */
+    uint32_t book_count;                        /*!< Số đầu sách trên server */
+    uint32_t user_count;                        /*!< Số người dùng trên server */
+} loadgen_config_t;
+
+/**
+ * \brief           Kết quả của một luồng
+ */
+typedef struct {
+    pthread_t thread;                           /*!< Luồng */
+    uint32_t index;                             /*!< Chỉ số luồng */
+    const loadgen_config_t* config;             /*!< Cấu hình dùng chung */
+    uint64_t requests;                          /*!< Số phản hồi đã nhận */
+    uint64_t errors;                            /*!< Số phản hồi lỗi nghiệp vụ */
+    uint32_t* samples;                          /*!< Độ trễ mỗi vòng (micro giây) */
+    size_t sample_count;                        /*!< Số mẫu */
+    uint8_t failed;                             /*!< 1 nếu lỗi kết nối */
+} loadgen_worker_t;
+
+/**
+ * \brief           Thời gian hiện tại (micro giây, đơn điệu)
+ * \return          Số micro giây
+ */
+static uint64_t
+loadgen_now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * \brief           Sinh số ngẫu nhiên (xorshift32)
+ * \param[in,out]   state: Trạng thái bộ sinh
+ * \return          Số ngẫu nhiên
+ */
+static uint32_t
+loadgen_rand(uint32_t* state) {
+    uint32_t x;
+
+    x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * \brief           Xếp một yêu cầu ngẫu nhiên theo tỉ lệ lookup 60%, search 10%,
+ *                  borrow 15%, return 15%
+ * \param[in,out]   client: Con trỏ tới client
+ * \param[in]       config: Cấu hình
+ * \param[in,out]   rng: Trạng thái bộ sinh số ngẫu nhiên
+ * \return          \ref CLIENT_OK nếu thành công
+ */
+static client_status_t
+loadgen_queue_one(client_t* client, const loadgen_config_t* config, uint32_t* rng) {
+    char query[32];
+    uint32_t roll;
+    uint32_t book_id;
+    uint32_t user_id;
+
+    roll = loadgen_rand(rng) % 100;
+    book_id = loadgen_rand(rng) % config->book_count + 1;
+    user_id = (config->user_count > 0) ? loadgen_rand(rng) % config->user_count + 1 : 1;
+
+    if (roll < 60) {
+        return client_queue_lookup(client, book_id, NULL);
+    }
+    if (roll < 70) {
+        snprintf(query, sizeof(query), "tập %u", loadgen_rand(rng) % 17 + 1);
+        return client_queue_search(client, PROTO_FIELD_TITLE, 16, query, NULL);
+    }
+    if (roll < 85) {
+        return client_queue_borrow(client, user_id, book_id, NULL);
+    }
+    return client_queue_return(client, user_id, book_id, NULL);
+}
+
+/**
+ * \brief           Thân luồng sinh tải
+ * \param[in,out]   arg: Con trỏ tới \ref loadgen_worker_t
+ * \return          NULL
+ */
+static void*
+loadgen_worker(void* arg) {
+    loadgen_worker_t* worker;
+    const loadgen_config_t* config;
+    client_t* clients;
+    client_response_t response;
+    uint64_t deadline;
+    uint64_t start;
+    uint32_t rng;
+    uint32_t c;
+    uint32_t d;
+    uint8_t running;
+
+    worker = arg;
+    config = worker->config;
+    rng = 2463534242u ^ (worker->index * 2654435761u);
+
+    clients = calloc(config->connections, sizeof(*clients));
+    worker->samples = malloc(LOADGEN_MAX_SAMPLES * sizeof(*worker->samples));
+    if (clients == NULL || worker->samples == NULL) {
+        free(clients);
+        worker->failed = 1;
+        return NULL;
+    }
+    running = 1;
+    for (c = 0; c < config->connections; c++) {
+        clients[c].fd = -1;
+    }
+    for (c = 0; c < config->connections && running; c++) {
+        if (client_connect(&clients[c], config->path) != CLIENT_OK) {
+            running = 0;
+        }
+    }
+
+    deadline = loadgen_now_us() + (uint64_t)config->seconds * 1000000u;
+    while (running && loadgen_now_us() < deadline) {
+        /* Mỗi vòng: mọi kết nối gửi một lô pipeline rồi chờ đủ phản hồi */
+        start = loadgen_now_us();
+        for (c = 0; c < config->connections && running; c++) {
+            for (d = 0; d < config->depth; d++) {
+                loadgen_queue_one(&clients[c], config, &rng);
+            }
+            if (client_flush(&clients[c]) != CLIENT_OK) {
+                running = 0;
+            }
+        }
+        for (c = 0; c < config->connections && running; c++) {
+            for (d = 0; d < config->depth; d++) {
+                if (client_read_response(&clients[c], &response) != CLIENT_OK) {
+                    running = 0;
+                    break;
+                }
+                worker->requests++;
+                if (response.status != PROTO_OK) {
+                    worker->errors++;
+                }
+            }
+        }
+        if (worker->sample_count < LOADGEN_MAX_SAMPLES) {
+            worker->samples[worker->sample_count++] = (uint32_t)(loadgen_now_us() - start);
+        }
+    }
+
+    worker->failed = !running;
+    for (c = 0; c < config->connections; c++) {
+        client_close(&clients[c]);
+    }
+    free(clients);
+    return NULL;
+}
+
+/**
+ * \brief           Hàm so sánh cho qsort
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+loadgen_compare_u32(const void* a, const void* b) {
+    uint32_t x;
+    uint32_t y;
+
+    x = *(const uint32_t*)a;
+    y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+loadgen_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-s socket] [-t luồng] [-c kết_nối/luồng] [-d độ_sâu_pipeline] [-n giây]\n",
+            prog);
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_loadgen
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Mảng tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    loadgen_config_t config;
+    loadgen_worker_t* workers;
+    client_t probe;
+    proto_stats_t stats;
+    uint32_t* all;
+    uint64_t requests;
+    uint64_t errors;
+    uint64_t started;
+    double elapsed;
+    size_t total;
+    size_t i;
+    int opt;
+
+    config.path = PROTO_DEFAULT_SOCKET;
+    config.threads = 2;
+    config.connections = 16;
+    config.depth = 32;
+    config.seconds = 5;
+    while ((opt = getopt(argc, argv, "s:t:c:d:n:h")) != -1) {
+        switch (opt) {
+            case 's':
+                config.path = optarg;
+                break;
+            case 't':
+                config.threads = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                config.connections = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                config.depth = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                config.seconds = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                loadgen_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (config.threads == 0 || config.connections == 0 || config.depth == 0) {
+        loadgen_usage(argv[0]);
+        return 1;
+    }
+
+    /* Hỏi server số sách/người dùng để sinh ID hợp lệ */
+    if (client_connect(&probe, config.path) != CLIENT_OK) {
+        fprintf(stderr, "Không kết nối được tới %s\n", config.path);
+        return 1;
+    }
+    if (client_stats(&probe, &stats) != CLIENT_OK || stats.titles == 0) {
+        fprintf(stderr, "Server chưa có sách (hãy chạy library_server với -b)\n");
+        client_close(&probe);
+        return 1;
+    }
+    client_close(&probe);
+    config.book_count = stats.titles;
+    config.user_count = stats.users;
+
+    workers = calloc(config.threads, sizeof(*workers));
+    if (workers == NULL) {
+        return 1;
+    }
+    started = loadgen_now_us();
+    for (i = 0; i < config.threads; i++) {
+        workers[i].index = (uint32_t)i;
+        workers[i].config = &config;
+        pthread_create(&workers[i].thread, NULL, loadgen_worker, &workers[i]);
+    }
+
+    requests = 0;
+    errors = 0;
+    total = 0;
+    for (i = 0; i < config.threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        requests += workers[i].requests;
+        errors += workers[i].errors;
+        total += workers[i].sample_count;
+        if (workers[i].failed) {
+            fprintf(stderr, "Luồng %zu gặp lỗi kết nối\n", i);
+        }
+    }
+    elapsed = (double)(loadgen_now_us() - started) / 1e6;
+
+    /* Gộp và sắp xếp mẫu độ trễ */
+    all = malloc((total > 0 ? total : 1) * sizeof(*all));
+    total = 0;
+    for (i = 0; i < config.threads; i++) {
+        if (all != NULL && workers[i].sample_count > 0) {
+            memcpy(&all[total], workers[i].samples, workers[i].sample_count * sizeof(*all));
+            total += workers[i].sample_count;
+        }
+        free(workers[i].samples);
+    }
+    free(workers);
+
+    printf("Kết nối: %u x %u, pipeline: %u, thời gian: %.2f s\n",
+           config.threads, config.connections, config.depth, elapsed);
+    printf("Yêu cầu: %llu (%llu phản hồi lỗi nghiệp vụ), thông lượng: %.0f yêu cầu/s\n",
+           (unsigned long long)requests, (unsigned long long)errors,
+           elapsed > 0 ? (double)requests / elapsed : 0.0);
+    if (all != NULL && total > 0) {
+        qsort(all, total, sizeof(*all), loadgen_compare_u32);
+        printf("Độ trễ mỗi vòng (us): p50 %u, p90 %u, p99 %u, max %u\n",
+               all[total * 50 / 100], all[total * 90 / 100], all[total * 99 / 100], all[total - 1]);
+    }
+    free(all);
+    return 0;
+}
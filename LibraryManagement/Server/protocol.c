@@ -0,0 +1,312 @@
+/**
+ * \file            protocol.c
+ * \brief           Mã hóa/giải mã frame của giao thức library_server
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include "protocol.h"
+#include <string.h>
+
+/**
+ * \brief           Ghi số 16 bit little-endian
+ * \param[out]      dst: Bộ đệm đích (ít nhất 2 byte)
+ * \param[in]       value: Giá trị cần ghi
+ */
+void
+proto_put_u16(uint8_t* dst, uint16_t value) {
+    dst[0] = (uint8_t)(value & 0xFF);
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * \brief           Ghi số 32 bit little-endian
+ * \param[out]      dst: Bộ đệm đích (ít nhất 4 byte)
+ * \param[in]       value: Giá trị cần ghi
+ */
+void
+proto_put_u32(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)(value & 0xFF);
+    dst[1] = (uint8_t)((value >> 8) & 0xFF);
+    dst[2] = (uint8_t)((value >> 16) & 0xFF);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * \brief           Ghi số 64 bit little-endian
+ * \param[out]      dst: Bộ đệm đích (ít nhất 8 byte)
+ * \param[in]       value: Giá trị cần ghi
+ */
+void
+proto_put_u64(uint8_t* dst, uint64_t value) {
+    proto_put_u32(dst, (uint32_t)value);
+    proto_put_u32(&dst[4], (uint32_t)(value >> 32));
+}
+
+/**
+ * \brief           Đọc số 16 bit little-endian
+ * \param[in]       src: Bộ đệm nguồn
+ * \return          Giá trị đọc được
+ */
+uint16_t
+proto_get_u16(const uint8_t* src) {
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+/**
+ * \brief           Đọc số 32 bit little-endian
+ * \param[in]       src: Bộ đệm nguồn
+ * \return          Giá trị đọc được
+ */
+uint32_t
+proto_get_u32(const uint8_t* src) {
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8)
+           | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+/**
+ * \brief           Khởi tạo bộ đọc payload
+ * \param[out]      reader: Bộ đọc
+ * \param[in]       data: Con trỏ tới payload
+ * \param[in]       len: Độ dài payload
+ */
+void
+proto_reader_init(proto_reader_t* reader, const uint8_t* data, size_t len) {
+    reader->data = data;
+    reader->len = len;
+    reader->pos = 0;
+    reader->error = 0;
+}
+
+/**
+ * \brief           Kiểm tra còn đủ \p n byte để đọc, đánh dấu lỗi nếu không
+ * \param[in,out]   reader: Bộ đọc
+ * \param[in]       n: Số byte cần đọc
+ * \return          1 nếu đủ, 0 nếu không
+ */
+static uint8_t
+proto_reader_need(proto_reader_t* reader, size_t n) {
+    if (reader->error || reader->len - reader->pos < n) {
+        reader->error = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Đọc một byte
+ * \param[in,out]   reader: Bộ đọc
+ * \return          Giá trị đọc được, 0 nếu lỗi
+ */
+uint8_t
+proto_read_u8(proto_reader_t* reader) {
+    if (!proto_reader_need(reader, 1)) {
+        return 0;
+    }
+    return reader->data[reader->pos++];
+}
+
+/**
+ * \brief           Đọc số 16 bit
+ * \param[in,out]   reader: Bộ đọc
+ * \return          Giá trị đọc được, 0 nếu lỗi
+ */
+uint16_t
+proto_read_u16(proto_reader_t* reader) {
+    uint16_t value;
+
+    if (!proto_reader_need(reader, 2)) {
+        return 0;
+    }
+    value = proto_get_u16(&reader->data[reader->pos]);
+    reader->pos += 2;
+    return value;
+}
+
+/**
+ * \brief           Đọc số 32 bit
+ * \param[in,out]   reader: Bộ đọc
+ * \return          Giá trị đọc được, 0 nếu lỗi
+ */
+uint32_t
+proto_read_u32(proto_reader_t* reader) {
+    uint32_t value;
+
+    if (!proto_reader_need(reader, 4)) {
+        return 0;
+    }
+    value = proto_get_u32(&reader->data[reader->pos]);
+    reader->pos += 4;
+    return value;
+}
+
+/**
+ * \brief           Đọc số 64 bit
+ * \param[in,out]   reader: Bộ đọc
+ * \return          Giá trị đọc được, 0 nếu hết dữ liệu
+ */
+uint64_t
+proto_read_u64(proto_reader_t* reader) {
+    uint64_t value;
+
+    if (!proto_reader_need(reader, 8)) {
+        return 0;
+    }
+    value = proto_get_u32(&reader->data[reader->pos]);
+    value |= (uint64_t)proto_get_u32(&reader->data[reader->pos + 4]) << 32;
+    reader->pos += 8;
+    return value;
+}
+
+/**
+ * \brief           Đọc chuỗi dạng u16 độ dài + dữ liệu
+ * \param[in,out]   reader: Bộ đọc
+ * \param[out]      len: Độ dài chuỗi
+ * \return          Con trỏ tới dữ liệu chuỗi trong payload, NULL nếu lỗi
+ */
+const char*
+proto_read_str(proto_reader_t* reader, uint16_t* len) {
+    const char* str;
+
+    *len = proto_read_u16(reader);
+    if (!proto_reader_need(reader, *len)) {
+        *len = 0;
+        return NULL;
+    }
+    str = (const char*)&reader->data[reader->pos];
+    reader->pos += *len;
+    return str;
+}
+
+/**
+ * \brief           Mã hóa một bản ghi sách
+ * \param[out]      dst: Bộ đệm đích
+ * \param[in]       cap: Dung lượng còn lại của bộ đệm
+ * \param[in]       book_id: ID sách
+ * \param[in]       copy_count: Số bản sao
+ * \param[in]       available_count: Số bản có sẵn
+ * \param[in]       title: Tiêu đề
+ * \param[in]       author: Tác giả
+ * \return          Số byte đã ghi, 0 nếu không đủ chỗ
+ */
+size_t
+proto_encode_book(uint8_t* dst, size_t cap, uint32_t book_id, uint8_t copy_count,
+                  uint8_t available_count, const char* title, const char* author) {
+    size_t title_len;
+    size_t author_len;
+    size_t need;
+
+    title_len = strlen(title);
+    author_len = strlen(author);
+    need = 4 + 1 + 1 + 2 + title_len + 2 + author_len;
+    if (need > cap) {
+        return 0;
+    }
+
+    proto_put_u32(dst, book_id);
+    dst[4] = copy_count;
+    dst[5] = available_count;
+    proto_put_u16(&dst[6], (uint16_t)title_len);
+    memcpy(&dst[8], title, title_len);
+    proto_put_u16(&dst[8 + title_len], (uint16_t)author_len);
+    memcpy(&dst[10 + title_len], author, author_len);
+
+    return need;
+}
+
+/**
+ * \brief           Giải mã một bản ghi sách
+ * \param[in,out]   reader: Bộ đọc đặt tại đầu bản ghi
+ * \param[out]      book: Bản ghi đã giải mã
+ * \return          1 nếu thành công, 0 nếu payload sai định dạng
+ */
+uint8_t
+proto_decode_book(proto_reader_t* reader, proto_book_t* book) {
+    book->book_id = proto_read_u32(reader);
+    book->copy_count = proto_read_u8(reader);
+    book->available_count = proto_read_u8(reader);
+    book->title = proto_read_str(reader, &book->title_len);
+    book->author = proto_read_str(reader, &book->author_len);
+    return reader->error ? 0 : 1;
+}
+
+/**
+ * \brief           Giải mã payload thống kê
+ * \param[in]       payload: Con trỏ tới payload
+ * \param[in]       len: Độ dài payload
+ * \param[out]      stats: Thống kê đã giải mã
+ * \return          1 nếu thành công, 0 nếu payload sai định dạng
+ */
+uint8_t
+proto_decode_stats(const uint8_t* payload, size_t len, proto_stats_t* stats) {
+    proto_reader_t reader;
+
+    proto_reader_init(&reader, payload, len);
+    stats->titles = proto_read_u32(&reader);
+    stats->copies = proto_read_u32(&reader);
+    stats->borrowed = proto_read_u32(&reader);
+    stats->available = proto_read_u32(&reader);
+    stats->users = proto_read_u32(&reader);
+    if (reader.error) {
+        return 0;
+    }
+
+    /* Trạng thái nhân bản (server cũ không gửi phần này) */
+    stats->role = PROTO_ROLE_PRIMARY;
+    stats->log_seq = 0;
+    stats->lag_ms = 0;
+    if (reader.pos < reader.len) {
+        stats->role = proto_read_u8(&reader);
+        stats->log_seq = proto_read_u64(&reader);
+        stats->lag_ms = proto_read_u32(&reader);
+    }
+    return reader.error ? 0 : 1;
+}
+
+/**
+ * \brief           Tên của trạng thái phản hồi
+ * \param[in]       status: Trạng thái
+ * \return          Chuỗi mô tả
+ */
+const char*
+proto_status_name(proto_status_t status) {
+    switch (status) {
+        case PROTO_OK:                  return "OK";
+        case PROTO_BAD_REQUEST:         return "BAD_REQUEST";
+        case PROTO_UNKNOWN_OP:          return "UNKNOWN_OP";
+        case PROTO_BOOK_NOT_FOUND:      return "BOOK_NOT_FOUND";
+        case PROTO_USER_NOT_FOUND:      return "USER_NOT_FOUND";
+        case PROTO_UNAVAILABLE:         return "UNAVAILABLE";
+        case PROTO_NOT_BORROWED:        return "NOT_BORROWED";
+        case PROTO_LIMIT_REACHED:       return "LIMIT_REACHED";
+        case PROTO_ALREADY_HAS_BOOK:    return "ALREADY_HAS_BOOK";
+        case PROTO_READ_ONLY:           return "READ_ONLY";
+        default:                        return "ERROR";
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * \file            protocol.h
+ * \brief           Giao thức nhị phân giữa library_server và client
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef PROTOCOL_HDR_H
+#define PROTOCOL_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Mọi frame (cả yêu cầu lẫn phản hồi) có dạng little-endian:
+ *
+ *   u32 length      Số byte phía sau trường length
+ *   u32 request_id  Do client chọn, server trả lại nguyên vẹn
+ *   u8  opcode      \ref proto_opcode_t
+ *   u8  status      Yêu cầu: 0; phản hồi: \ref proto_status_t
+ *   ... payload
+ *
+ * Client có thể gửi liên tiếp nhiều yêu cầu (pipeline) mà không chờ phản
+ * hồi; server trả phản hồi đúng theo thứ tự yêu cầu trên mỗi kết nối.
+ */
+
+/* Định nghĩa các hằng số */
+#define PROTO_HEADER_SIZE           10          /*!< length + request_id + opcode + status */
+#define PROTO_MAX_FRAME             65536       /*!< Kích thước frame tối đa (kể cả header) */
+#define PROTO_MAX_SEARCH_RESULTS    256         /*!< Số kết quả tối đa trong một phản hồi tìm kiếm */
+#define PROTO_DEFAULT_SOCKET        "/tmp/library.sock"
+
+/**
+ * \brief           Mã thao tác
+ */
+typedef enum {
+    PROTO_OP_LOOKUP = 1,                        /*!< u32 book_id -> bản ghi sách */
+    PROTO_OP_SEARCH = 2,                        /*!< u8 field, u16 limit, str query -> danh sách kết quả */
+    PROTO_OP_BORROW = 3,                        /*!< u32 user_id, u32 book_id -> trạng thái */
+    PROTO_OP_RETURN = 4,                        /*!< u32 user_id, u32 book_id -> u32 handed_to */
+    PROTO_OP_STATS = 5,                         /*!< (rỗng) -> thống kê và trạng thái nhân bản */
+} proto_opcode_t;
+
+/**
+ * \brief           Trường tìm kiếm của \ref PROTO_OP_SEARCH
+ */
+typedef enum {
+    PROTO_FIELD_TITLE = 0,                      /*!< Tìm theo tiêu đề */
+    PROTO_FIELD_AUTHOR = 1,                     /*!< Tìm theo tác giả */
+} proto_field_t;
+
+/**
+ * \brief           Trạng thái trong phản hồi
+ */
+typedef enum {
+    PROTO_OK = 0,                               /*!< Thành công */
+    PROTO_BAD_REQUEST,                          /*!< Frame hoặc payload sai định dạng */
+    PROTO_UNKNOWN_OP,                           /*!< Opcode không hỗ trợ */
+    PROTO_BOOK_NOT_FOUND,                       /*!< Không tìm thấy sách */
+    PROTO_USER_NOT_FOUND,                       /*!< Không tìm thấy người dùng */
+    PROTO_UNAVAILABLE,                          /*!< Mọi bản sao đã được mượn */
+    PROTO_NOT_BORROWED,                         /*!< Người dùng không mượn sách này */
+    PROTO_LIMIT_REACHED,                        /*!< Người dùng đã đạt giới hạn mượn */
+    PROTO_ALREADY_HAS_BOOK,                     /*!< Người dùng đã mượn một bản của sách */
+    PROTO_ERROR,                                /*!< Lỗi khác phía server */
+    PROTO_READ_ONLY,                            /*!< Server là bản sao chỉ đọc, gửi thao tác ghi tới primary */
+} proto_status_t;
+
+/**
+ * \brief           Vai trò của server trong cặp primary/bản sao
+ */
+typedef enum {
+    PROTO_ROLE_PRIMARY = 0,                     /*!< Nhận mọi thao tác, ghi nhật ký cho bản sao */
+    PROTO_ROLE_REPLICA = 1,                     /*!< Phát lại nhật ký của primary, chỉ phục vụ đọc */
+} proto_role_t;
+
+/**
+ * \brief           Bản ghi sách đã giải mã (chuỗi trỏ vào payload, không kết thúc bằng '\0')
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách */
+    uint8_t copy_count;                         /*!< Số bản sao */
+    uint8_t available_count;                    /*!< Số bản có sẵn */
+    const char* title;                          /*!< Tiêu đề */
+    uint16_t title_len;                         /*!< Độ dài tiêu đề */
+    const char* author;                         /*!< Tác giả */
+    uint16_t author_len;                        /*!< Độ dài tác giả */
+} proto_book_t;
+
+/**
+ * \brief           Thống kê trả về bởi \ref PROTO_OP_STATS
+ */
+typedef struct {
+    uint32_t titles;                            /*!< Số đầu sách */
+    uint32_t copies;                            /*!< Số bản sao */
+    uint32_t borrowed;                          /*!< Số bản đang được mượn */
+    uint32_t available;                         /*!< Số bản có sẵn */
+    uint32_t users;                             /*!< Số người dùng */
+    uint8_t role;                               /*!< \ref proto_role_t */
+    uint64_t log_seq;                           /*!< Primary: số thứ tự đã ghi ra nhật ký; bản sao: đã áp dụng */
+    uint32_t lag_ms;                            /*!< Bản sao: độ trễ của lần áp dụng gần nhất (ms) */
+} proto_stats_t;
+
+/**
+ * \brief           Bộ đọc tuần tự trên một vùng payload, tự đánh dấu lỗi khi đọc quá biên
+ */
+typedef struct {
+    const uint8_t* data;                        /*!< Con trỏ tới payload */
+    size_t len;                                 /*!< Độ dài payload */
+    size_t pos;                                 /*!< Vị trí đọc hiện tại */
+    uint8_t error;                              /*!< 1 nếu đã đọc quá biên */
+} proto_reader_t;
+
+/* Ghi số nguyên little-endian vào bộ đệm */
+void            proto_put_u16(uint8_t* dst, uint16_t value);
+void            proto_put_u32(uint8_t* dst, uint32_t value);
+void            proto_put_u64(uint8_t* dst, uint64_t value);
+uint16_t        proto_get_u16(const uint8_t* src);
+uint32_t        proto_get_u32(const uint8_t* src);
+
+/* Đọc payload */
+void            proto_reader_init(proto_reader_t* reader, const uint8_t* data, size_t len);
+uint8_t         proto_read_u8(proto_reader_t* reader);
+uint16_t        proto_read_u16(proto_reader_t* reader);
+uint32_t        proto_read_u32(proto_reader_t* reader);
+uint64_t        proto_read_u64(proto_reader_t* reader);
+const char*     proto_read_str(proto_reader_t* reader, uint16_t* len);
+
+/* Giải mã phản hồi */
+size_t          proto_encode_book(uint8_t* dst, size_t cap, uint32_t book_id, uint8_t copy_count,
+                                  uint8_t available_count, const char* title, const char* author);
+uint8_t         proto_decode_book(proto_reader_t* reader, proto_book_t* book);
+uint8_t         proto_decode_stats(const uint8_t* payload, size_t len, proto_stats_t* stats);
+const char*     proto_status_name(proto_status_t status);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PROTOCOL_HDR_H */
@@ -0,0 +1,1227 @@
+/**
+ * \file            server.c
+ * \brief           Tiến trình library_server: phục vụ catalog qua UNIX socket bằng epoll
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "protocol.h"
+#include "../Management/management.h"
+#include "../Shm/shm.h"
+#include "../Verify/verify.h"
+
+/* Định nghĩa các hằng số */
+#define SERVER_MAX_EVENTS           256         /* Số sự kiện tối đa mỗi lần epoll_wait */
+#define SERVER_READ_CHUNK           16384       /* Số byte đọc mỗi lần read */
+#define SERVER_READ_BUDGET          (4 * SERVER_READ_CHUNK) /* Số byte đọc tối đa của một kết nối mỗi lượt epoll */
+#define SERVER_INITIAL_BUFFER       4096        /* Bộ đệm ban đầu của mỗi kết nối */
+#define SERVER_WRITE_HIGH_WATER     (1u << 20)  /* Quá ngưỡng này thì tạm ngừng đọc (backpressure) */
+
+/**
+ * \brief           Trạng thái của một kết nối client
+ */
+typedef struct {
+    int fd;                                     /*!< File descriptor */
+    uint8_t* rbuf;                              /*!< Bộ đệm đọc (chứa frame chưa hoàn chỉnh) */
+    size_t rlen;                                /*!< Số byte đang có trong rbuf */
+    size_t rcap;                                /*!< Dung lượng rbuf */
+    uint8_t* wbuf;                              /*!< Bộ đệm ghi (gom phản hồi thành lô) */
+    size_t wlen;                                /*!< Số byte đang có trong wbuf */
+    size_t wpos;                                /*!< Số byte đã gửi */
+    size_t wcap;                                /*!< Dung lượng wbuf */
+    uint32_t events;                            /*!< Tập sự kiện đang đăng ký với epoll */
+    uint8_t peer_closed;                        /*!< Client đã đóng chiều gửi: gửi nốt phản hồi rồi đóng */
+} server_conn_t;
+
+/**
+ * \brief           Trạng thái toàn cục của server
+ */
+typedef struct {
+    library_t library;                          /*!< Thư viện do server sở hữu */
+    int listen_fd;                              /*!< Socket lắng nghe */
+    int epoll_fd;                               /*!< epoll instance */
+    size_t conn_count;                          /*!< Số kết nối đang mở */
+    uint64_t requests;                          /*!< Tổng số yêu cầu đã xử lý */
+    uint64_t batches;                           /*!< Tổng số lần gửi lô phản hồi */
+    proto_role_t role;                          /*!< Vai trò: primary hoặc bản sao chỉ đọc */
+    const char* ship_path;                      /*!< Primary: file nhật ký gửi cho bản sao (NULL = không gửi) */
+    FILE* ship_log;                             /*!< Primary: file nhật ký đang ghi */
+    uint64_t shipped;                           /*!< Primary: con trỏ CDC đã ghi ra file */
+    int tail_fd;                                /*!< Bản sao: file nhật ký đang đọc theo */
+    int notify_fd;                              /*!< Bản sao: inotify báo file nhật ký thay đổi */
+    off_t tail_offset;                          /*!< Bản sao: vị trí đã đọc trong file */
+    uint8_t* tail_buf;                          /*!< Bản sao: byte đã đọc nhưng chưa đủ một bản ghi */
+    size_t tail_len;                            /*!< Bản sao: số byte trong tail_buf */
+    size_t tail_cap;                            /*!< Bản sao: dung lượng tail_buf */
+    uint64_t applied_seq;                       /*!< Bản sao: số thứ tự của bản ghi áp dụng gần nhất */
+    uint64_t applied;                           /*!< Bản sao: tổng số bản ghi đã áp dụng */
+    uint64_t apply_errors;                      /*!< Bản sao: số bản ghi áp dụng lỗi (lệch trạng thái) */
+    uint32_t lag_ms;                            /*!< Bản sao: độ trễ của lần áp dụng gần nhất */
+    shm_catalog_t shm;                          /*!< Segment catalog cho kiosk (base = NULL nếu tắt) */
+    uint64_t shm_published;                     /*!< Số thay đổi đã có trong bản công bố gần nhất */
+    uint64_t shm_publishes;                     /*!< Tổng số lần công bố */
+    uint32_t verify_interval;                   /*!< Chu kỳ kiểm tra nhất quán (giây, 0 = tắt) */
+    time_t verify_due;                          /*!< Thời điểm của lần kiểm tra kế tiếp */
+} server_t;
+
+/* Dữ liệu thư viện nằm ở vùng tĩnh để không phụ thuộc kích thước stack */
+static book_list_t server_books;
+static user_list_t server_users;
+static hold_pool_t server_holds;
+static query_cache_t server_cache;
+static scan_pool_t server_scan;
+static cdc_log_t server_cdc;
+static history_t server_history;
+static verify_t server_verify;
+static volatile sig_atomic_t server_stop;
+static volatile sig_atomic_t server_promote_requested;
+static int server_notify_tag;                   /* Địa chỉ dùng làm data.ptr của inotify trong epoll */
+
+/**
+ * \brief           Bộ xử lý tín hiệu dừng
+ * \param[in]       sig: Số hiệu tín hiệu
+ */
+static void
+server_on_signal(int sig) {
+    (void)sig;
+    server_stop = 1;
+}
+
+/**
+ * \brief           Bộ xử lý SIGUSR1: yêu cầu bản sao trở thành primary
+ * \param[in]       sig: Số hiệu tín hiệu
+ */
+static void
+server_on_promote(int sig) {
+    (void)sig;
+    server_promote_requested = 1;
+}
+
+/**
+ * \brief           Đảm bảo bộ đệm có ít nhất \p need byte
+ * \param[in,out]   buf: Con trỏ tới bộ đệm
+ * \param[in,out]   cap: Dung lượng hiện tại
+ * \param[in]       need: Dung lượng cần có
+ * \return          1 nếu thành công, 0 nếu hết bộ nhớ
+ */
+static uint8_t
+server_reserve(uint8_t** buf, size_t* cap, size_t need) {
+    size_t new_cap;
+    uint8_t* new_buf;
+
+    if (need <= *cap) {
+        return 1;
+    }
+    new_cap = (*cap == 0) ? SERVER_INITIAL_BUFFER : *cap;
+    while (new_cap < need) {
+        new_cap *= 2;
+    }
+    new_buf = realloc(*buf, new_cap);
+    if (new_buf == NULL) {
+        return 0;
+    }
+    *buf = new_buf;
+    *cap = new_cap;
+    return 1;
+}
+
+/**
+ * \brief           Chuyển mã lỗi quản lý sang mã trạng thái giao thức
+ * \param[in]       status: Mã lỗi của module quản lý
+ * \return          Mã trạng thái giao thức
+ */
+static proto_status_t
+server_map_status(mgmt_status_t status) {
+    switch (status) {
+        case MGMT_OK:                       return PROTO_OK;
+        case MGMT_INVALID_INPUT:            return PROTO_BAD_REQUEST;
+        case MGMT_BOOK_NOT_FOUND:           return PROTO_BOOK_NOT_FOUND;
+        case MGMT_USER_NOT_FOUND:           return PROTO_USER_NOT_FOUND;
+        case MGMT_BOOK_ALREADY_BORROWED:    return PROTO_UNAVAILABLE;
+        case MGMT_BOOK_RESERVED:            return PROTO_UNAVAILABLE;
+        case MGMT_BOOK_NOT_BORROWED:        return PROTO_NOT_BORROWED;
+        case MGMT_USER_LIMIT_REACHED:       return PROTO_LIMIT_REACHED;
+        case MGMT_USER_ALREADY_HAS_BOOK:    return PROTO_ALREADY_HAS_BOOK;
+        default:                            return PROTO_ERROR;
+    }
+}
+
+/**
+ * \brief           Xử lý LOOKUP: trả về bản ghi sách theo ID
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   req: Bộ đọc payload yêu cầu
+ * \param[out]      out: Bộ đệm payload phản hồi
+ * \param[out]      out_len: Độ dài payload phản hồi
+ * \return          Trạng thái phản hồi
+ */
+static proto_status_t
+server_handle_lookup(server_t* server, proto_reader_t* req, uint8_t* out, size_t* out_len) {
+    uint32_t book_id;
+    const book_t* book;
+
+    book_id = proto_read_u32(req);
+    if (req->error) {
+        return PROTO_BAD_REQUEST;
+    }
+
+    book = book_find_by_id(server->library.books, book_id);
+    if (book == NULL) {
+        return PROTO_BOOK_NOT_FOUND;
+    }
+
+    *out_len = proto_encode_book(out, PROTO_MAX_FRAME - PROTO_HEADER_SIZE, book->book_id,
+                                 book->copy_count, book->available_count, book->title, book->author);
+    return PROTO_OK;
+}
+
+/**
+ * \brief           Ghi một bản ghi sách vào payload SEARCH nếu còn chỗ
+ * \param[out]      out: Bộ đệm payload phản hồi
+ * \param[in,out]   pos: Vị trí ghi hiện tại
+ * \param[in]       book: Sách cần ghi
+ * \return          1 nếu đã ghi, 0 nếu frame đã đầy
+ */
+static uint8_t
+server_append_book(uint8_t* out, size_t* pos, const book_t* book) {
+    size_t written;
+
+    written = proto_encode_book(&out[*pos], PROTO_MAX_FRAME - PROTO_HEADER_SIZE - *pos,
+                                book->book_id, book->copy_count, book->available_count,
+                                book->title, book->author);
+    *pos += written;
+    return (written > 0) ? 1 : 0;
+}
+
+/**
+ * \brief           Ngữ cảnh ghi kết quả SEARCH khi quét trực tiếp danh sách
+ */
+typedef struct {
+    uint8_t* out;                               /*!< Bộ đệm payload phản hồi */
+    size_t pos;                                 /*!< Vị trí ghi hiện tại */
+    uint16_t limit;                             /*!< Số bản ghi tối đa */
+    uint16_t returned;                          /*!< Số bản ghi đã ghi */
+} server_search_ctx_t;
+
+/**
+ * \brief           Hàm duyệt ghi sách khớp vào payload SEARCH
+ * \param[in]       book: Sách khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref server_search_ctx_t
+ * \return          Luôn 1 để tiếp tục đếm tổng số kết quả
+ */
+static uint8_t
+server_search_visit(const book_t* book, void* ctx) {
+    server_search_ctx_t* search;
+
+    search = ctx;
+    if (search->returned < search->limit) {
+        if (server_append_book(search->out, &search->pos, book)) {
+            search->returned++;
+        } else {
+            search->limit = search->returned;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           Xử lý SEARCH: tìm theo tiêu đề hoặc tác giả
+ *
+ * Payload phản hồi: u32 tổng số kết quả, u16 số bản ghi kèm theo, rồi các
+ * bản ghi sách. Số bản ghi bị giới hạn bởi limit và kích thước frame. Kết quả
+ * lấy từ cache truy vấn khi cache giữ đủ số bản ghi cần trả.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   req: Bộ đọc payload yêu cầu
+ * \param[out]      out: Bộ đệm payload phản hồi
+ * \param[out]      out_len: Độ dài payload phản hồi
+ * \return          Trạng thái phản hồi
+ */
+static proto_status_t
+server_handle_search(server_t* server, proto_reader_t* req, uint8_t* out, size_t* out_len) {
+    char query[MAX_STRING_LENGTH];
+    query_result_t result;
+    server_search_ctx_t search;
+    const char* raw;
+    const book_list_t* list;
+    uint8_t field;
+    uint16_t limit;
+    uint16_t raw_len;
+    uint16_t returned;
+    uint32_t total;
+    size_t pos;
+    size_t i;
+
+    field = proto_read_u8(req);
+    limit = proto_read_u16(req);
+    raw = proto_read_str(req, &raw_len);
+    if (req->error || raw_len == 0 || raw_len >= sizeof(query) || field > PROTO_FIELD_AUTHOR) {
+        return PROTO_BAD_REQUEST;
+    }
+    memcpy(query, raw, raw_len);
+    query[raw_len] = '\0';
+    if (limit > PROTO_MAX_SEARCH_RESULTS) {
+        limit = PROTO_MAX_SEARCH_RESULTS;
+    }
+
+    list = server->library.books;
+    total = 0;
+    returned = 0;
+    pos = 6;
+    if (query_cache_search(server->library.cache, list, (query_field_t)field, query, &result) == QUERY_CACHE_OK
+        && (result.count == result.total || result.count >= limit)) {
+        /* Trúng cache (hoặc vừa quét xong): dùng trực tiếp vị trí đã lưu */
+        total = (uint32_t)result.total;
+        for (i = 0; i < result.count && returned < limit; i++) {
+            if (!server_append_book(out, &pos, &list->books[result.indices[i]])) {
+                break;
+            }
+            returned++;
+        }
+    } else {
+        search.out = out;
+        search.pos = pos;
+        search.limit = limit;
+        search.returned = 0;
+        total = (uint32_t)book_query(list, (field == PROTO_FIELD_TITLE) ? BOOK_FILTER_TITLE : BOOK_FILTER_AUTHOR,
+                                     query, server_search_visit, &search);
+        pos = search.pos;
+        returned = search.returned;
+    }
+
+    proto_put_u32(out, total);
+    proto_put_u16(&out[4], returned);
+    *out_len = pos;
+    return PROTO_OK;
+}
+
+/**
+ * \brief           Xử lý BORROW và RETURN
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in]       opcode: \ref PROTO_OP_BORROW hoặc \ref PROTO_OP_RETURN
+ * \param[in,out]   req: Bộ đọc payload yêu cầu
+ * \param[out]      out: Bộ đệm payload phản hồi
+ * \param[out]      out_len: Độ dài payload phản hồi
+ * \return          Trạng thái phản hồi
+ */
+static proto_status_t
+server_handle_circulation(server_t* server, uint8_t opcode, proto_reader_t* req,
+                          uint8_t* out, size_t* out_len) {
+    uint32_t user_id;
+    uint32_t book_id;
+    uint32_t handed_to;
+    mgmt_status_t status;
+
+    user_id = proto_read_u32(req);
+    book_id = proto_read_u32(req);
+    if (req->error) {
+        return PROTO_BAD_REQUEST;
+    }
+    if (server->role == PROTO_ROLE_REPLICA) {
+        return PROTO_READ_ONLY;
+    }
+
+    if (opcode == PROTO_OP_BORROW) {
+        status = mgmt_borrow_book(&server->library, user_id, book_id);
+        return server_map_status(status);
+    }
+
+    handed_to = 0;
+    status = mgmt_return_book_handoff(&server->library, user_id, book_id, &handed_to);
+    proto_put_u32(out, handed_to);
+    *out_len = 4;
+    return server_map_status(status);
+}
+
+/**
+ * \brief           Ghi các thay đổi mới của primary ra file nhật ký cho bản sao
+ *
+ * Gọi trước khi gửi phản hồi để mọi thao tác ghi đã báo thành công cho client
+ * đều đã nằm trong nhật ký. Nếu con trỏ rơi khỏi vòng đệm, \ref cdc_sync ghi
+ * snapshot toàn bộ thư viện.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_ship(server_t* server) {
+    if (server->ship_log == NULL || server->shipped == cdc_head(server->library.cdc)) {
+        return;
+    }
+    if (cdc_sync(server->library.cdc, server->library.books, server->library.users,
+                 CDC_FORMAT_BINARY, server->ship_log, &server->shipped) == CDC_IO_ERROR
+        || fflush(server->ship_log) != 0) {
+        perror("ship log");
+    }
+}
+
+/**
+ * \brief           Xử lý STATS
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[out]      out: Bộ đệm payload phản hồi
+ * \param[out]      out_len: Độ dài payload phản hồi
+ * \return          Trạng thái phản hồi
+ */
+static proto_status_t
+server_handle_stats(server_t* server, uint8_t* out, size_t* out_len) {
+    scan_counts_t counts;
+
+    scan_books_count(server->library.scan, server->library.books, &counts);
+    proto_put_u32(&out[0], (uint32_t)counts.titles);
+    proto_put_u32(&out[4], (uint32_t)counts.copies);
+    proto_put_u32(&out[8], (uint32_t)counts.borrowed);
+    proto_put_u32(&out[12], (uint32_t)counts.available);
+    proto_put_u32(&out[16], (uint32_t)user_count_total(server->library.users));
+    out[20] = (uint8_t)server->role;
+    if (server->role == PROTO_ROLE_REPLICA) {
+        proto_put_u64(&out[21], server->applied_seq);
+        proto_put_u32(&out[29], server->lag_ms);
+    } else {
+        proto_put_u64(&out[21], (server->library.cdc != NULL) ? cdc_head(server->library.cdc) : 0);
+        proto_put_u32(&out[29], 0);
+    }
+    *out_len = 33;
+    return PROTO_OK;
+}
+
+/**
+ * \brief           Xử lý một frame yêu cầu và nối phản hồi vào bộ đệm ghi
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   conn: Kết nối gửi yêu cầu
+ * \param[in]       frame: Frame yêu cầu (bắt đầu từ trường length)
+ * \param[in]       frame_len: Độ dài frame
+ * \return          1 nếu thành công, 0 nếu hết bộ nhớ
+ */
+static uint8_t
+server_dispatch(server_t* server, server_conn_t* conn, const uint8_t* frame, size_t frame_len) {
+    static uint8_t payload[PROTO_MAX_FRAME];
+    proto_reader_t req;
+    proto_status_t status;
+    uint32_t request_id;
+    uint8_t opcode;
+    size_t payload_len;
+    uint8_t* dst;
+
+    request_id = proto_get_u32(&frame[4]);
+    opcode = frame[8];
+    proto_reader_init(&req, &frame[PROTO_HEADER_SIZE], frame_len - PROTO_HEADER_SIZE);
+    payload_len = 0;
+
+    switch (opcode) {
+        case PROTO_OP_LOOKUP:
+            status = server_handle_lookup(server, &req, payload, &payload_len);
+            break;
+        case PROTO_OP_SEARCH:
+            status = server_handle_search(server, &req, payload, &payload_len);
+            break;
+        case PROTO_OP_BORROW:
+        case PROTO_OP_RETURN:
+            status = server_handle_circulation(server, opcode, &req, payload, &payload_len);
+            break;
+        case PROTO_OP_STATS:
+            status = server_handle_stats(server, payload, &payload_len);
+            break;
+        default:
+            status = PROTO_UNKNOWN_OP;
+            break;
+    }
+    if (status != PROTO_OK && opcode != PROTO_OP_RETURN) {
+        payload_len = 0;
+    }
+
+    /* Nối phản hồi vào bộ đệm ghi, chưa gửi ngay để gom thành lô */
+    if (!server_reserve(&conn->wbuf, &conn->wcap, conn->wlen + PROTO_HEADER_SIZE + payload_len)) {
+        return 0;
+    }
+    dst = &conn->wbuf[conn->wlen];
+    proto_put_u32(dst, (uint32_t)(PROTO_HEADER_SIZE - 4 + payload_len));
+    proto_put_u32(&dst[4], request_id);
+    dst[8] = opcode;
+    dst[9] = (uint8_t)status;
+    memcpy(&dst[PROTO_HEADER_SIZE], payload, payload_len);
+    conn->wlen += PROTO_HEADER_SIZE + payload_len;
+
+    server->requests++;
+    return 1;
+}
+
+/**
+ * \brief           Đăng ký lại tập sự kiện epoll nếu thay đổi
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   conn: Kết nối
+ * \param[in]       events: Tập sự kiện mới
+ */
+static void
+server_watch(server_t* server, server_conn_t* conn, uint32_t events) {
+    struct epoll_event ev;
+
+    if (conn->events == events) {
+        return;
+    }
+    ev.events = events;
+    ev.data.ptr = conn;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev) == 0) {
+        conn->events = events;
+    }
+}
+
+/**
+ * \brief           Đóng kết nối và giải phóng tài nguyên
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in]       conn: Kết nối cần đóng
+ */
+static void
+server_close(server_t* server, server_conn_t* conn) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->rbuf);
+    free(conn->wbuf);
+    free(conn);
+    server->conn_count--;
+}
+
+/**
+ * \brief           Gửi bộ đệm ghi bằng càng ít syscall càng tốt
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   conn: Kết nối
+ * \return          1 nếu kết nối còn dùng được, 0 nếu phải đóng
+ */
+static uint8_t
+server_flush(server_t* server, server_conn_t* conn) {
+    ssize_t n;
+
+    if (conn->wpos < conn->wlen) {
+        server->batches++;
+    }
+    while (conn->wpos < conn->wlen) {
+        n = send(conn->fd, &conn->wbuf[conn->wpos], conn->wlen - conn->wpos, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return 0;
+        }
+        conn->wpos += (size_t)n;
+    }
+
+    if (conn->wpos == conn->wlen) {
+        conn->wpos = 0;
+        conn->wlen = 0;
+        if (conn->peer_closed) {
+            return 0;
+        }
+        server_watch(server, conn, EPOLLIN | EPOLLRDHUP);
+    } else if (conn->peer_closed || conn->wlen - conn->wpos > SERVER_WRITE_HIGH_WATER) {
+        /* Client đọc chậm: ngừng đọc yêu cầu mới cho tới khi gửi bớt */
+        server_watch(server, conn, EPOLLOUT);
+    } else {
+        server_watch(server, conn, EPOLLIN | EPOLLOUT | EPOLLRDHUP);
+    }
+    return 1;
+}
+
+/**
+ * \brief           Xử lý mọi frame hoàn chỉnh trong bộ đệm đọc (pipeline)
+ *
+ * Phần frame còn dở được dời về đầu bộ đệm, nên rbuf không bao giờ giữ quá
+ * một frame chưa hoàn chỉnh cộng một lần đọc.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   conn: Kết nối
+ * \return          1 nếu thành công, 0 nếu frame sai và phải đóng kết nối
+ */
+static uint8_t
+server_consume_frames(server_t* server, server_conn_t* conn) {
+    size_t off;
+    uint32_t frame_len;
+
+    off = 0;
+    while (conn->rlen - off >= 4) {
+        frame_len = proto_get_u32(&conn->rbuf[off]) + 4;
+        if (frame_len < PROTO_HEADER_SIZE || frame_len > PROTO_MAX_FRAME) {
+            return 0;
+        }
+        if (conn->rlen - off < frame_len) {
+            break;
+        }
+        if (!server_dispatch(server, conn, &conn->rbuf[off], frame_len)) {
+            return 0;
+        }
+        off += frame_len;
+    }
+    if (off > 0) {
+        memmove(conn->rbuf, &conn->rbuf[off], conn->rlen - off);
+        conn->rlen -= off;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Đọc dữ liệu sẵn có, xử lý từng frame hoàn chỉnh rồi gửi một lô
+ *
+ * Mỗi lượt chỉ đọc tối đa \ref SERVER_READ_BUDGET byte để một client gửi dồn
+ * không chiếm vòng lặp (epoll level-triggered sẽ báo lại phần còn lại), và
+ * ngừng đọc khi bộ đệm ghi vượt \ref SERVER_WRITE_HIGH_WATER. Khi client đóng
+ * chiều gửi, các phản hồi đã xếp hàng vẫn được gửi hết trước khi đóng.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in,out]   conn: Kết nối
+ * \return          1 nếu kết nối còn dùng được, 0 nếu phải đóng
+ */
+static uint8_t
+server_on_readable(server_t* server, server_conn_t* conn) {
+    ssize_t n;
+    size_t budget;
+
+    budget = SERVER_READ_BUDGET;
+    while (budget > 0 && !conn->peer_closed && conn->wlen - conn->wpos <= SERVER_WRITE_HIGH_WATER) {
+        if (!server_reserve(&conn->rbuf, &conn->rcap, conn->rlen + SERVER_READ_CHUNK)) {
+            return 0;
+        }
+        n = read(conn->fd, &conn->rbuf[conn->rlen], SERVER_READ_CHUNK);
+        if (n > 0) {
+            conn->rlen += (size_t)n;
+            budget = ((size_t)n < budget) ? budget - (size_t)n : 0;
+            if (!server_consume_frames(server, conn)) {
+                return 0;
+            }
+            continue;
+        }
+        if (n == 0) {
+            conn->peer_closed = 1;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        return 0;
+    }
+
+    server_ship(server);
+    return server_flush(server, conn);
+}
+
+/**
+ * \brief           Chấp nhận mọi kết nối đang chờ
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_accept(server_t* server) {
+    struct epoll_event ev;
+    server_conn_t* conn;
+    int fd;
+
+    while (1) {
+        fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("accept4");
+            }
+            return;
+        }
+
+        conn = calloc(1, sizeof(*conn));
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN | EPOLLRDHUP;
+        ev.events = conn->events;
+        ev.data.ptr = conn;
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            free(conn);
+            continue;
+        }
+        server->conn_count++;
+    }
+}
+
+/**
+ * \brief           Tạo socket lắng nghe và epoll instance
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in]       path: Đường dẫn UNIX socket
+ * \return          1 nếu thành công, 0 nếu lỗi
+ */
+static uint8_t
+server_listen(server_t* server, const char* path) {
+    struct sockaddr_un addr;
+    struct epoll_event ev;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Đường dẫn socket quá dài: %s\n", path);
+        return 0;
+    }
+
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        perror("socket");
+        return 0;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(server->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0
+        || listen(server->listen_fd, SOMAXCONN) != 0) {
+        perror("bind/listen");
+        return 0;
+    }
+
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (server->epoll_fd < 0) {
+        perror("epoll_create1");
+        return 0;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &ev) != 0) {
+        perror("epoll_ctl");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Bật ghi nhật ký thay đổi và mở file nhật ký gửi cho bản sao
+ *
+ * File bắt đầu bằng snapshot của trạng thái hiện tại, sau đó là các thay đổi
+ * theo thứ tự. Ghi đè file cũ: bản sao thấy file bị cắt ngắn sẽ đọc lại từ đầu.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ * \return          1 nếu thành công, 0 nếu lỗi
+ */
+static uint8_t
+server_start_primary(server_t* server) {
+    cdc_init(&server_cdc);
+    cdc_attach(&server_cdc, server->library.books, server->library.users);
+    server->library.cdc = &server_cdc;
+    server->role = PROTO_ROLE_PRIMARY;
+    server->shipped = 0;
+    if (server->ship_path == NULL) {
+        return 1;
+    }
+
+    server->ship_log = fopen(server->ship_path, "wb");
+    if (server->ship_log == NULL) {
+        perror(server->ship_path);
+        return 0;
+    }
+    if (cdc_export_snapshot(&server_cdc, server->library.books, server->library.users,
+                            CDC_FORMAT_BINARY, server->ship_log, &server->shipped) != CDC_OK
+        || fflush(server->ship_log) != 0) {
+        perror("ship log");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Mở file nhật ký của primary để đọc theo (chế độ bản sao)
+ * \param[in,out]   server: Con trỏ tới server
+ * \param[in]       path: Đường dẫn file nhật ký
+ * \return          1 nếu thành công, 0 nếu lỗi
+ */
+static uint8_t
+server_start_replica(server_t* server, const char* path) {
+    struct epoll_event ev;
+
+    server->role = PROTO_ROLE_REPLICA;
+    server->tail_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (server->tail_fd < 0) {
+        perror(path);
+        return 0;
+    }
+    server->notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (server->notify_fd < 0 || inotify_add_watch(server->notify_fd, path, IN_MODIFY) < 0) {
+        perror("inotify");
+        return 0;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = &server_notify_tag;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->notify_fd, &ev) != 0) {
+        perror("epoll_ctl");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Đọc phần mới của file nhật ký và áp dụng mọi bản ghi hoàn chỉnh
+ *
+ * Được gọi khi inotify báo thay đổi và sau mỗi lần epoll_wait hết hạn (phòng
+ * khi sự kiện bị gộp hoặc mất). Phần cuối chưa đủ một bản ghi được giữ lại
+ * cho lần đọc sau. Độ trễ tính từ lần sửa file cuối cùng tới lúc áp dụng xong.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_replica_poll(server_t* server) {
+    uint8_t drain[4096];
+    struct stat st;
+    struct timespec now;
+    cdc_record_t record;
+    cdc_status_t status;
+    size_t off;
+    size_t used;
+    ssize_t n;
+    int64_t lag;
+
+    while (read(server->notify_fd, drain, sizeof(drain)) > 0) {
+        /* Chỉ cần biết có thay đổi, nội dung sự kiện không quan trọng */
+    }
+    if (fstat(server->tail_fd, &st) != 0) {
+        return;
+    }
+    if (st.st_size < server->tail_offset) {
+        /* Primary khởi động lại và ghi đè file: đọc lại từ snapshot đầu file */
+        server->tail_offset = 0;
+        server->tail_len = 0;
+    }
+
+    off = 0;
+    while (1) {
+        if (!server_reserve(&server->tail_buf, &server->tail_cap, server->tail_len + SERVER_READ_CHUNK)) {
+            return;
+        }
+        n = pread(server->tail_fd, &server->tail_buf[server->tail_len],
+                  server->tail_cap - server->tail_len, server->tail_offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        server->tail_len += (size_t)n;
+        server->tail_offset += n;
+
+        while (off < server->tail_len) {
+            status = cdc_decode(&server->tail_buf[off], server->tail_len - off, &record, &used);
+            if (status == CDC_INCOMPLETE) {
+                break;
+            }
+            if (status != CDC_OK) {
+                fprintf(stderr, "library_server: nhật ký hỏng tại byte %lld, bỏ phần còn lại\n",
+                        (long long)(server->tail_offset - (off_t)(server->tail_len - off)));
+                off = server->tail_len;
+                break;
+            }
+            if (mgmt_apply_change(&server->library, &record) != MGMT_OK) {
+                server->apply_errors++;
+            }
+            server->applied_seq = record.seq;
+            server->applied++;
+            off += used;
+        }
+        memmove(server->tail_buf, &server->tail_buf[off], server->tail_len - off);
+        server->tail_len -= off;
+        if (off > 0) {
+            clock_gettime(CLOCK_REALTIME, &now);
+            lag = (int64_t)(now.tv_sec - st.st_mtim.tv_sec) * 1000
+                  + (now.tv_nsec - st.st_mtim.tv_nsec) / 1000000;
+            server->lag_ms = (lag > 0) ? (uint32_t)lag : 0;
+        }
+        off = 0;
+    }
+}
+
+/**
+ * \brief           Chuyển bản sao thành primary (failover)
+ *
+ * Áp dụng nốt phần nhật ký còn lại, ngừng đọc theo file rồi bật ghi nhật ký
+ * của chính mình. Nếu có \p -l, file nhật ký mới bắt đầu bằng snapshot để
+ * bản sao khác có thể đọc theo.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_promote(server_t* server) {
+    server_replica_poll(server);
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, server->notify_fd, NULL);
+    close(server->notify_fd);
+    close(server->tail_fd);
+    server->notify_fd = -1;
+    server->tail_fd = -1;
+    free(server->tail_buf);
+    server->tail_buf = NULL;
+    server->tail_len = 0;
+    server->tail_cap = 0;
+
+    if (!server_start_primary(server)) {
+        fprintf(stderr, "library_server: không mở được nhật ký, tiếp tục làm primary không gửi nhật ký\n");
+        server->ship_log = NULL;
+    }
+    /* Số thay đổi tính lại từ nhật ký mới: buộc công bố lại ở lượt kế tiếp */
+    server->shm_publishes = 0;
+    printf("library_server: đã trở thành primary tại seq %llu (%zu sách, %zu người dùng)\n",
+           (unsigned long long)server->applied_seq, book_count_total(server->library.books),
+           user_count_total(server->library.users));
+    fflush(stdout);
+}
+
+/**
+ * \brief           Công bố catalog vào vùng nhớ dùng chung nếu có thay đổi
+ *
+ * Gọi một lần sau mỗi lượt epoll nên nhiều thao tác ghi trong cùng lượt chỉ
+ * tốn một lần công bố. Số thay đổi lấy từ nhật ký CDC (primary) hoặc số bản
+ * ghi đã áp dụng (bản sao).
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_publish(server_t* server) {
+    uint64_t changes;
+
+    if (server->shm.base == NULL) {
+        return;
+    }
+    changes = (server->role == PROTO_ROLE_REPLICA) ? server->applied : cdc_head(server->library.cdc);
+    if (changes == server->shm_published && server->shm_publishes > 0) {
+        return;
+    }
+    if (shm_publish(&server->shm, server->library.books, server->library.users) == SHM_OK) {
+        server->shm_published = changes;
+        server->shm_publishes++;
+    }
+}
+
+/**
+ * \brief           Kiểm tra nhất quán mượn/trả theo chu kỳ
+ *
+ * Chạy trên luồng vòng lặp sự kiện (luồng sở hữu thư viện) nên snapshot luôn
+ * nhất quán; phần so khớp chia phân đoạn cho pool quét của server.
+ *
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_verify_tick(server_t* server) {
+    struct timespec now;
+
+    if (server->verify_interval == 0) {
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec < server->verify_due) {
+        return;
+    }
+    server->verify_due = now.tv_sec + (time_t)server->verify_interval;
+    if (verify_library(&server_verify, &server->library) == VERIFY_INCONSISTENT) {
+        fprintf(stderr, "library_server: phát hiện %llu lỗi nhất quán mượn/trả\n",
+                (unsigned long long)server_verify.issue_total);
+        verify_print_plan(&server_verify, stderr);
+    }
+}
+
+/**
+ * \brief           Vòng lặp sự kiện chính
+ * \param[in,out]   server: Con trỏ tới server
+ */
+static void
+server_run(server_t* server) {
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    server_conn_t* conn;
+    uint8_t alive;
+    uint8_t log_changed;
+    int n;
+    int i;
+
+    while (!server_stop) {
+        if (server_promote_requested) {
+            server_promote_requested = 0;
+            if (server->role == PROTO_ROLE_REPLICA) {
+                server_promote(server);
+            }
+        }
+        n = epoll_wait(server->epoll_fd, events, SERVER_MAX_EVENTS, 1000);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return;
+        }
+
+        /* Bản sao áp dụng nhật ký trước khi phục vụ các yêu cầu trong lượt này */
+        log_changed = (n == 0) ? 1 : 0;
+        for (i = 0; i < n; i++) {
+            if (events[i].data.ptr == &server_notify_tag) {
+                log_changed = 1;
+            }
+        }
+        if (log_changed && server->role == PROTO_ROLE_REPLICA) {
+            server_replica_poll(server);
+        }
+
+        for (i = 0; i < n; i++) {
+            conn = events[i].data.ptr;
+            if (conn == NULL) {
+                server_accept(server);
+                continue;
+            }
+            if (events[i].data.ptr == &server_notify_tag) {
+                continue;
+            }
+
+            alive = 1;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                alive = 0;
+            }
+            if (alive && (events[i].events & EPOLLOUT)) {
+                alive = server_flush(server, conn);
+            }
+            if (alive && (events[i].events & (EPOLLIN | EPOLLRDHUP))) {
+                alive = server_on_readable(server, conn);
+            }
+            if (!alive) {
+                server_close(server, conn);
+            }
+        }
+        server_publish(server);
+        server_verify_tick(server);
+    }
+}
+
+/**
+ * \brief           Sinh dữ liệu mẫu để thử tải
+ * \param[in,out]   library: Con trỏ tới thư viện
+ * \param[in]       books: Số đầu sách cần sinh
+ * \param[in]       users: Số người dùng cần sinh
+ */
+static void
+server_seed(library_t* library, uint32_t books, uint32_t users) {
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    uint32_t id;
+    uint32_t i;
+
+    for (i = 0; i < books; i++) {
+        snprintf(title, sizeof(title), "Sách mẫu %u - Lập trình C tập %u", i + 1, i % 17 + 1);
+        snprintf(author, sizeof(author), "Tác giả %u", i % 97 + 1);
+        if (book_add(library->books, title, author, &id) != BOOK_OK) {
+            break;
+        }
+        book_add_copies(library->books, id, (uint8_t)(i % 3));
+    }
+    for (i = 0; i < users; i++) {
+        snprintf(title, sizeof(title), "Bạn đọc %u", i + 1);
+        if (user_add(library->users, title, &id) != USER_OK) {
+            break;
+        }
+        user_set_tier(library->users, id, (user_tier_t)(i % USER_TIER_COUNT));
+    }
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+server_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-s socket] [-b số_sách_mẫu] [-u số_người_dùng_mẫu] [-w số_luồng_quét]\n"
+                    "          [-l file_nhật_ký_gửi_bản_sao] [-r file_nhật_ký_của_primary] [-m segment_catalog]\n"
+                    "          [-V chu_kỳ_kiểm_tra_giây]\n"
+                    "  -r: chạy như bản sao chỉ đọc; gửi SIGUSR1 để chuyển thành primary\n"
+                    "  -m: công bố catalog vào POSIX shared memory cho library_kiosk (ví dụ %s)\n"
+                    "  -V: kiểm tra nhất quán mượn/trả định kỳ, in kế hoạch sửa ra stderr khi có lỗi\n",
+            prog, SHM_DEFAULT_NAME);
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_server
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Mảng tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    server_t server;
+    history_rank_t popular;
+    const char* path;
+    const char* replica_of;
+    const char* shm_name;
+    uint32_t seed_books;
+    uint32_t seed_users;
+    uint32_t scan_workers;
+    int opt;
+
+    path = PROTO_DEFAULT_SOCKET;
+    replica_of = NULL;
+    shm_name = NULL;
+    memset(&server, 0, sizeof(server));
+    seed_books = 0;
+    seed_users = 0;
+    scan_workers = 0;
+    while ((opt = getopt(argc, argv, "s:b:u:w:l:r:m:V:h")) != -1) {
+        switch (opt) {
+            case 's':
+                path = optarg;
+                break;
+            case 'b':
+                seed_books = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'u':
+                seed_users = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                scan_workers = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                server.ship_path = optarg;
+                break;
+            case 'r':
+                replica_of = optarg;
+                break;
+            case 'm':
+                shm_name = optarg;
+                break;
+            case 'V':
+                server.verify_interval = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                server_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    /* Khởi tạo thư viện */
+    book_init(&server_books);
+    user_init(&server_users);
+    hold_pool_init(&server_holds);
+    query_cache_init(&server_cache);
+    scan_pool_init(&server_scan, scan_workers);
+    server_cache.scan = &server_scan;
+    server.library.books = &server_books;
+    server.library.users = &server_users;
+    server.library.holds = &server_holds;
+    server.library.cache = &server_cache;
+    server.library.scan = &server_scan;
+    server.library.cdc = NULL;
+    server.library.barcodes = NULL;
+    server.library.notify = NULL;
+    server.library.txn = NULL;
+    history_init(&server_history);
+    server.library.history = &server_history;
+    verify_init(&server_verify);
+    server.tail_fd = -1;
+    server.notify_fd = -1;
+
+    signal(SIGINT, server_on_signal);
+    signal(SIGTERM, server_on_signal);
+    signal(SIGUSR1, server_on_promote);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!server_listen(&server, path)) {
+        return 1;
+    }
+    if (replica_of != NULL) {
+        /* Bản sao lấy toàn bộ dữ liệu từ nhật ký, bỏ qua dữ liệu mẫu */
+        if (!server_start_replica(&server, replica_of)) {
+            return 1;
+        }
+        server_replica_poll(&server);
+    } else {
+        server_seed(&server.library, seed_books, seed_users);
+        if (!server_start_primary(&server)) {
+            return 1;
+        }
+    }
+    if (shm_name != NULL) {
+        if (shm_catalog_create(&server.shm, shm_name) != SHM_OK) {
+            perror(shm_name);
+            return 1;
+        }
+        server_publish(&server);
+    }
+    printf("library_server: %s, lắng nghe tại %s (%zu sách, %zu người dùng)\n",
+           (server.role == PROTO_ROLE_REPLICA) ? "bản sao chỉ đọc" : "primary",
+           path, book_count_total(&server_books), user_count_total(&server_users));
+    fflush(stdout);
+
+    server_run(&server);
+
+    printf("library_server: dừng, %llu yêu cầu / %llu lô phản hồi\n",
+           (unsigned long long)server.requests, (unsigned long long)server.batches);
+    printf("library_server: cache tìm kiếm %llu trúng / %llu trượt / %llu entry cũ bị bỏ\n",
+           (unsigned long long)server_cache.hits, (unsigned long long)server_cache.misses,
+           (unsigned long long)server_cache.stale);
+    if (history_popular(&server_history, &popular, 1) == 1) {
+        printf("library_server: lịch sử giữ %zu lượt mượn/trả, sách mượn nhiều nhất ID %u (~%u lượt)\n",
+               history_count(&server_history), popular.book_id, popular.count);
+    }
+    if (server.role == PROTO_ROLE_REPLICA) {
+        printf("library_server: bản sao đã áp dụng %llu bản ghi (seq %llu, %llu lỗi, trễ %u ms)\n",
+               (unsigned long long)server.applied, (unsigned long long)server.applied_seq,
+               (unsigned long long)server.apply_errors, server.lag_ms);
+        close(server.notify_fd);
+        close(server.tail_fd);
+        free(server.tail_buf);
+    } else if (server.ship_log != NULL) {
+        printf("library_server: đã ghi nhật ký tới seq %llu\n", (unsigned long long)server.shipped);
+        fclose(server.ship_log);
+    }
+    if (server.shm.base != NULL) {
+        printf("library_server: đã công bố catalog %llu lần vào %s\n",
+               (unsigned long long)server.shm_publishes, server.shm.name);
+        shm_catalog_unlink(&server.shm);
+    }
+    if (server_verify.stats.runs > 0) {
+        printf("library_server: kiểm tra nhất quán %llu lần, %llu lần có lỗi (lần cuối chụp %.3f ms, kiểm tra %.3f ms)\n",
+               (unsigned long long)server_verify.stats.runs, (unsigned long long)server_verify.stats.failed_runs,
+               (double)server_verify.stats.capture_ns / 1e6, (double)server_verify.stats.check_ns / 1e6);
+    }
+    scan_pool_destroy(&server_scan);
+    close(server.epoll_fd);
+    close(server.listen_fd);
+    unlink(path);
+    return 0;
+}
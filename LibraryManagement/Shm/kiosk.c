@@ -0,0 +1,359 @@
+/**
+ * \file            kiosk.c
+ * \brief           library_kiosk: tra cứu catalog trực tiếp trong vùng nhớ dùng chung
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "shm.h"
+
+#define KIOSK_MAX_RESULTS           20          /* Số kết quả tìm kiếm in ra tối đa */
+
+/**
+ * \brief           Bắt đầu một lần đọc, báo lỗi nếu writer ghi đè quá nhiều lần
+ * \param[in]       catalog: Segment đã gắn
+ * \param[out]      view: Khung nhìn
+ * \param[in,out]   attempts: Số lần đã thử
+ * \return          1 nếu được phép đọc, 0 nếu phải dừng
+ */
+static uint8_t
+kiosk_begin(const shm_catalog_t* catalog, shm_view_t* view, uint32_t* attempts) {
+    shm_status_t status;
+
+    if (++(*attempts) > SHM_MAX_RETRIES) {
+        fprintf(stderr, "Catalog đang được cập nhật liên tục, thử lại sau\n");
+        return 0;
+    }
+    status = shm_read_begin(catalog, view);
+    if (status == SHM_NOT_READY) {
+        fprintf(stderr, "Server chưa công bố catalog\n");
+        return 0;
+    }
+    return (status == SHM_OK) ? 1 : 0;
+}
+
+/**
+ * \brief           In thông tin một sách
+ * \param[in]       book: Bản sao bản ghi sách
+ */
+static void
+kiosk_print_book(const shm_book_t* book) {
+    printf("%-6u %-45.45s %-22.22s %u/%u bản có sẵn", book->book_id, book->title, book->author,
+           book->available_count, book->copy_count);
+    if (book->hold_length > 0) {
+        printf(", %u người đặt giữ", book->hold_length);
+    }
+    printf("\n");
+}
+
+/**
+ * \brief           Lệnh lookup: tra cứu sách theo ID
+ * \param[in]       catalog: Segment đã gắn
+ * \param[in]       book_id: ID sách
+ * \return          0 nếu tìm thấy
+ */
+static int
+kiosk_lookup(const shm_catalog_t* catalog, uint32_t book_id) {
+    shm_view_t view;
+    shm_book_t copy;
+    const shm_book_t* book;
+    uint32_t attempts;
+    uint8_t found;
+
+    attempts = 0;
+    do {
+        if (!kiosk_begin(catalog, &view, &attempts)) {
+            return 1;
+        }
+        book = shm_view_find_book(&view, book_id);
+        found = (book != NULL) ? 1 : 0;
+        if (found) {
+            memcpy(&copy, book, sizeof(copy));
+        }
+    } while (shm_read_retry(&view));
+
+    if (!found) {
+        printf("Không tìm thấy sách ID %u\n", book_id);
+        return 1;
+    }
+    copy.title[MAX_TITLE_LENGTH - 1] = '\0';
+    copy.author[MAX_AUTHOR_LENGTH - 1] = '\0';
+    kiosk_print_book(&copy);
+    return 0;
+}
+
+/**
+ * \brief           Lệnh user: thông tin người dùng và các bản sao đang mượn
+ * \param[in]       catalog: Segment đã gắn
+ * \param[in]       user_id: ID người dùng
+ * \return          0 nếu tìm thấy
+ */
+static int
+kiosk_user(const shm_catalog_t* catalog, uint32_t user_id) {
+    static uint32_t loans[MAX_BOOKS];
+    shm_view_t view;
+    shm_user_t copy;
+    const shm_user_t* user;
+    const uint32_t* items;
+    uint32_t attempts;
+    uint32_t count;
+    uint32_t i;
+    uint8_t found;
+
+    attempts = 0;
+    do {
+        if (!kiosk_begin(catalog, &view, &attempts)) {
+            return 1;
+        }
+        user = shm_view_find_user(&view, user_id);
+        items = shm_view_user_loans(&view, user);
+        found = (user != NULL && items != NULL) ? 1 : 0;
+        count = 0;
+        if (found) {
+            memcpy(&copy, user, sizeof(copy));
+            count = (copy.borrowed_count < MAX_BOOKS) ? copy.borrowed_count : MAX_BOOKS;
+            memcpy(loans, items, count * sizeof(uint32_t));
+        }
+    } while (shm_read_retry(&view));
+
+    if (!found) {
+        printf("Không tìm thấy người dùng ID %u\n", user_id);
+        return 1;
+    }
+    copy.name[MAX_NAME_LENGTH - 1] = '\0';
+    printf("%u %s (%s), đang mượn %u bản\n", copy.user_id, copy.name,
+           user_tier_name((user_tier_t)copy.tier), copy.borrowed_count);
+    for (i = 0; i < count; i++) {
+        printf("  sách %u, bản sao #%u\n", BOOK_ITEM_BOOK_ID(loans[i]), BOOK_ITEM_COPY(loans[i]) + 1);
+    }
+    return 0;
+}
+
+/**
+ * \brief           Lệnh search: tìm theo tiêu đề hoặc tác giả
+ * \param[in]       catalog: Segment đã gắn
+ * \param[in]       filter: \ref BOOK_FILTER_TITLE hoặc \ref BOOK_FILTER_AUTHOR
+ * \param[in]       text: Từ khóa
+ * \return          0 nếu thành công
+ */
+static int
+kiosk_search(const shm_catalog_t* catalog, book_filter_t filter, const char* text) {
+    shm_book_t results[KIOSK_MAX_RESULTS];
+    uint32_t ids[KIOSK_MAX_RESULTS];
+    shm_view_t view;
+    const shm_book_t* book;
+    uint32_t attempts;
+    size_t total;
+    size_t shown;
+    size_t i;
+
+    attempts = 0;
+    do {
+        if (!kiosk_begin(catalog, &view, &attempts)) {
+            return 1;
+        }
+        total = shm_view_search(&view, filter, text, ids, KIOSK_MAX_RESULTS);
+        shown = 0;
+        for (i = 0; i < total && i < KIOSK_MAX_RESULTS; i++) {
+            book = shm_view_find_book(&view, ids[i]);
+            if (book != NULL) {
+                memcpy(&results[shown++], book, sizeof(results[0]));
+            }
+        }
+    } while (shm_read_retry(&view));
+
+    printf("Tìm thấy %zu sách\n", total);
+    for (i = 0; i < shown; i++) {
+        results[i].title[MAX_TITLE_LENGTH - 1] = '\0';
+        results[i].author[MAX_AUTHOR_LENGTH - 1] = '\0';
+        kiosk_print_book(&results[i]);
+    }
+    if (total > shown) {
+        printf("... và %zu sách khác\n", total - shown);
+    }
+    return 0;
+}
+
+/**
+ * \brief           Lệnh stats: thống kê bản công bố hiện tại
+ * \param[in]       catalog: Segment đã gắn
+ * \return          0 nếu thành công
+ */
+static int
+kiosk_stats(const shm_catalog_t* catalog) {
+    shm_image_t info;
+    shm_view_t view;
+    uint32_t attempts;
+
+    attempts = 0;
+    do {
+        if (!kiosk_begin(catalog, &view, &attempts)) {
+            return 1;
+        }
+        memcpy(&info, shm_view_image(&view), sizeof(info));
+    } while (shm_read_retry(&view));
+
+    printf("Bản công bố %llu: %u đầu sách, %u người dùng, %u bản sao đang được mượn\n",
+           (unsigned long long)info.epoch, info.book_count, info.user_count, info.loan_count);
+    return 0;
+}
+
+/**
+ * \brief           Lệnh bench: tra cứu ngẫu nhiên liên tục để đo tốc độ đọc
+ * \param[in]       catalog: Segment đã gắn
+ * \param[in]       seconds: Thời gian chạy
+ * \return          0 nếu thành công
+ */
+static int
+kiosk_bench(const shm_catalog_t* catalog, uint32_t seconds) {
+    struct timespec start;
+    struct timespec now;
+    shm_view_t view;
+    const shm_book_t* book;
+    uint64_t lookups;
+    uint64_t retries;
+    uint64_t found;
+    uint32_t seed;
+    double elapsed;
+    uint32_t i;
+
+    lookups = 0;
+    retries = 0;
+    found = 0;
+    seed = 12345;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        for (i = 0; i < 4096; i++) {
+            seed = seed * 1103515245u + 12345u;
+            do {
+                if (shm_read_begin(catalog, &view) != SHM_OK) {
+                    fprintf(stderr, "Server chưa công bố catalog\n");
+                    return 1;
+                }
+                book = shm_view_find_book(&view, (seed >> 8) % MAX_BOOKS + 1);
+                if (!shm_read_retry(&view)) {
+                    break;
+                }
+                retries++;
+            } while (1);
+            found += (book != NULL) ? 1 : 0;
+            lookups++;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    } while (elapsed < (double)seconds);
+
+    printf("%llu lượt tra cứu trong %.2f s (%.0f lượt/s), %llu tìm thấy, %llu lần đọc lại\n",
+           (unsigned long long)lookups, elapsed, (double)lookups / elapsed,
+           (unsigned long long)found, (unsigned long long)retries);
+    return 0;
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+kiosk_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-m segment] lệnh\n"
+                    "  lookup <id_sách>            tra cứu sách\n"
+                    "  user <id_người_dùng>        người dùng và sách đang mượn\n"
+                    "  search title|author <từ>    tìm kiếm\n"
+                    "  stats                       thống kê\n"
+                    "  bench <số_giây>             đo tốc độ tra cứu\n", prog);
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_kiosk
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Mảng tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    shm_catalog_t catalog;
+    shm_status_t status;
+    const char* name;
+    const char* command;
+    int result;
+    int opt;
+
+    name = SHM_DEFAULT_NAME;
+    while ((opt = getopt(argc, argv, "m:h")) != -1) {
+        switch (opt) {
+            case 'm':
+                name = optarg;
+                break;
+            default:
+                kiosk_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        kiosk_usage(argv[0]);
+        return 1;
+    }
+    command = argv[optind];
+
+    status = shm_catalog_attach(&catalog, name);
+    if (status != SHM_OK) {
+        if (status == SHM_INCOMPATIBLE) {
+            fprintf(stderr, "Segment %s không tương thích với bản build này\n", name);
+        } else {
+            perror(name);
+        }
+        return 1;
+    }
+
+    if (strcmp(command, "lookup") == 0 && optind + 1 < argc) {
+        result = kiosk_lookup(&catalog, (uint32_t)strtoul(argv[optind + 1], NULL, 10));
+    } else if (strcmp(command, "user") == 0 && optind + 1 < argc) {
+        result = kiosk_user(&catalog, (uint32_t)strtoul(argv[optind + 1], NULL, 10));
+    } else if (strcmp(command, "search") == 0 && optind + 2 < argc) {
+        result = kiosk_search(&catalog, (strcmp(argv[optind + 1], "author") == 0) ? BOOK_FILTER_AUTHOR
+                                                                                   : BOOK_FILTER_TITLE,
+                              argv[optind + 2]);
+    } else if (strcmp(command, "stats") == 0) {
+        result = kiosk_stats(&catalog);
+    } else if (strcmp(command, "bench") == 0 && optind + 1 < argc) {
+        result = kiosk_bench(&catalog, (uint32_t)strtoul(argv[optind + 1], NULL, 10));
+    } else {
+        kiosk_usage(argv[0]);
+        result = 1;
+    }
+
+    shm_catalog_detach(&catalog);
+    return result;
+}
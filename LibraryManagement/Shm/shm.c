@@ -0,0 +1,575 @@
+/**
+ * \file            shm.c
+ * \brief           Vùng nhớ dùng chung: writer công bố catalog, nhiều tiến trình đọc không sao chép
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shm.h"
+#include "../Ultils/utils.h"
+
+/* Định nghĩa các hằng số */
+#define SHM_ALIGN                   64          /* Căn lề các mảng theo dòng cache */
+#define SHM_HASH_MULTIPLIER         2654435761u /* Hệ số băm Fibonacci cho ID */
+
+/**
+ * \brief           Làm tròn lên bội của \ref SHM_ALIGN
+ * \param[in]       value: Giá trị cần làm tròn
+ * \return          Giá trị đã làm tròn
+ */
+static uint64_t
+shm_align(uint64_t value) {
+    return (value + SHM_ALIGN - 1) & ~(uint64_t)(SHM_ALIGN - 1);
+}
+
+/**
+ * \brief           Lũy thừa của 2 nhỏ nhất không nhỏ hơn \p value
+ * \param[in]       value: Giá trị đầu vào
+ * \return          Lũy thừa của 2
+ */
+static uint32_t
+shm_pow2(uint32_t value) {
+    uint32_t result;
+
+    result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * \brief           Ô bắt đầu dò của một ID trong bảng băm
+ * \param[in]       id: ID cần băm
+ * \param[in]       capacity: Số ô (lũy thừa của 2)
+ * \return          Chỉ số ô
+ */
+static uint32_t
+shm_slot(uint32_t id, uint32_t capacity) {
+    return (id * SHM_HASH_MULTIPLIER) & (capacity - 1);
+}
+
+/**
+ * \brief           Tính bố cục segment và ghi vào phần đầu
+ *
+ * Mỗi image gồm phần đầu \ref shm_image_t, mảng sách, mảng người dùng, mảng
+ * lượt mượn và hai bảng băm ID (ô lưu chỉ số + 1, 0 = trống).
+ *
+ * \param[out]      header: Phần đầu segment
+ */
+static void
+shm_layout(shm_header_t* header) {
+    uint64_t offset;
+    uint64_t image_size;
+
+    header->book_capacity = MAX_BOOKS;
+    header->user_capacity = MAX_USERS;
+    header->loan_capacity = SHM_MAX_LOANS;
+    header->book_index_capacity = shm_pow2(MAX_BOOKS * 2);
+    header->user_index_capacity = shm_pow2(MAX_USERS * 2);
+
+    offset = shm_align(sizeof(shm_image_t));
+    header->books_offset = offset;
+    offset = shm_align(offset + (uint64_t)header->book_capacity * sizeof(shm_book_t));
+    header->users_offset = offset;
+    offset = shm_align(offset + (uint64_t)header->user_capacity * sizeof(shm_user_t));
+    header->loans_offset = offset;
+    offset = shm_align(offset + (uint64_t)header->loan_capacity * sizeof(uint32_t));
+    header->book_index_offset = offset;
+    offset = shm_align(offset + (uint64_t)header->book_index_capacity * sizeof(uint32_t));
+    header->user_index_offset = offset;
+    image_size = shm_align(offset + (uint64_t)header->user_index_capacity * sizeof(uint32_t));
+
+    header->image_offset[0] = shm_align(sizeof(shm_header_t));
+    header->image_offset[1] = header->image_offset[0] + image_size;
+    header->segment_size = header->image_offset[1] + image_size;
+}
+
+/**
+ * \brief           Tạo (hoặc tạo lại) segment và map để ghi
+ *
+ * Segment cũ cùng tên bị xóa trước để reader đang gắn vào bản cũ không thấy
+ * bố cục thay đổi dưới chân; reader phải gắn lại sau khi writer khởi động lại.
+ *
+ * \param[out]      catalog: Segment đã map
+ * \param[in]       name: Tên segment POSIX (bắt đầu bằng '/')
+ * \return          \ref SHM_OK nếu thành công, \ref shm_status_t nếu lỗi
+ */
+shm_status_t
+shm_catalog_create(shm_catalog_t* catalog, const char* name) {
+    shm_header_t layout;
+    shm_header_t* header;
+    void* base;
+    int fd;
+
+    if (catalog == NULL || name == NULL || name[0] != '/' || strlen(name) >= sizeof(catalog->name)) {
+        return SHM_INVALID_INPUT;
+    }
+
+    memset(&layout, 0, sizeof(layout));
+    shm_layout(&layout);
+
+    shm_unlink(name);
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return SHM_ERROR;
+    }
+    if (ftruncate(fd, (off_t)layout.segment_size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return SHM_ERROR;
+    }
+    base = mmap(NULL, layout.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        return SHM_ERROR;
+    }
+
+    /* ftruncate đã điền 0: seq = 0 nghĩa là chưa công bố bản nào */
+    header = base;
+    memcpy(header, &layout, sizeof(layout));
+    atomic_store_explicit(&header->seq, 0, memory_order_relaxed);
+    header->magic = SHM_MAGIC;
+    header->version = SHM_VERSION;
+
+    catalog->base = base;
+    catalog->size = layout.segment_size;
+    catalog->writable = 1;
+    strcpy(catalog->name, name);
+    return SHM_OK;
+}
+
+/**
+ * \brief           Ghi toàn bộ catalog vào một image
+ * \param[in]       header: Phần đầu segment
+ * \param[out]      image: Đầu image cần ghi
+ * \param[in]       books: Danh sách sách
+ * \param[in]       users: Danh sách người dùng
+ */
+static void
+shm_fill_image(const shm_header_t* header, uint8_t* image, const book_list_t* books,
+               const user_list_t* users) {
+    shm_image_t* info;
+    shm_book_t* dst_books;
+    shm_user_t* dst_users;
+    uint32_t* loans;
+    uint32_t* index;
+    const book_t* book;
+    const user_t* user;
+    uint32_t slot;
+    size_t i;
+
+    info = (shm_image_t*)image;
+    dst_books = (shm_book_t*)&image[header->books_offset];
+    dst_users = (shm_user_t*)&image[header->users_offset];
+    loans = (uint32_t*)&image[header->loans_offset];
+
+    index = (uint32_t*)&image[header->book_index_offset];
+    memset(index, 0, (size_t)header->book_index_capacity * sizeof(uint32_t));
+    for (i = 0; i < books->count; i++) {
+        book = &books->books[i];
+        dst_books[i].book_id = book->book_id;
+        memcpy(dst_books[i].title, book->title, sizeof(dst_books[i].title));
+        memcpy(dst_books[i].author, book->author, sizeof(dst_books[i].author));
+        dst_books[i].copy_count = book->copy_count;
+        dst_books[i].available_count = book->available_count;
+        dst_books[i].hold_length = book->holds.length;
+        dst_books[i].available_mask = book->available_mask;
+
+        slot = shm_slot(book->book_id, header->book_index_capacity);
+        while (index[slot] != 0) {
+            slot = (slot + 1) & (header->book_index_capacity - 1);
+        }
+        index[slot] = (uint32_t)i + 1;
+    }
+
+    info->loan_count = 0;
+    index = (uint32_t*)&image[header->user_index_offset];
+    memset(index, 0, (size_t)header->user_index_capacity * sizeof(uint32_t));
+    for (i = 0; i < users->count; i++) {
+        user = &users->users[i];
+        dst_users[i].user_id = user->user_id;
+        memcpy(dst_users[i].name, user->name, sizeof(dst_users[i].name));
+        dst_users[i].tier = (uint8_t)user->tier;
+        dst_users[i].borrowed_count = (uint32_t)user->borrowed_count;
+        dst_users[i].loan_first = info->loan_count;
+        memcpy(&loans[info->loan_count], user_borrowed_items(users, user),
+               user->borrowed_count * sizeof(uint32_t));
+        info->loan_count += (uint32_t)user->borrowed_count;
+
+        slot = shm_slot(user->user_id, header->user_index_capacity);
+        while (index[slot] != 0) {
+            slot = (slot + 1) & (header->user_index_capacity - 1);
+        }
+        index[slot] = (uint32_t)i + 1;
+    }
+
+    info->book_count = (uint32_t)books->count;
+    info->user_count = (uint32_t)users->count;
+    info->generation = books->generation;
+}
+
+/**
+ * \brief           Công bố trạng thái hiện tại của catalog cho mọi reader
+ *
+ * Bản mới được ghi vào image mà reader không dùng, rồi đổi seqlock sang số
+ * chẵn tiếp theo. Reader đang đọc bản trước chỉ phải đọc lại nếu writer công
+ * bố thêm một bản nữa trong lúc họ còn đọc. Chỉ một tiến trình được ghi.
+ *
+ * \param[in,out]   catalog: Segment đã tạo bằng \ref shm_catalog_create
+ * \param[in]       books: Danh sách sách
+ * \param[in]       users: Danh sách người dùng
+ * \return          \ref SHM_OK nếu thành công, \ref shm_status_t nếu lỗi
+ */
+shm_status_t
+shm_publish(shm_catalog_t* catalog, const book_list_t* books, const user_list_t* users) {
+    shm_header_t* header;
+    shm_image_t* info;
+    uint8_t* image;
+    uint64_t seq;
+    uint64_t epoch;
+
+    if (catalog == NULL || catalog->base == NULL || !catalog->writable || books == NULL || users == NULL) {
+        return SHM_INVALID_INPUT;
+    }
+
+    header = (shm_header_t*)catalog->base;
+    seq = atomic_load_explicit(&header->seq, memory_order_relaxed);
+    epoch = seq / 2 + 1;
+    image = &catalog->base[header->image_offset[epoch & 1]];
+
+    /* Số lẻ: đang ghi bản epoch; phải hiện ra trước mọi byte của image */
+    atomic_store_explicit(&header->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    shm_fill_image(header, image, books, users);
+    info = (shm_image_t*)image;
+    info->epoch = epoch;
+
+    atomic_store_explicit(&header->seq, seq + 2, memory_order_release);
+    return SHM_OK;
+}
+
+/**
+ * \brief           Gỡ map và xóa tên segment (writer dừng)
+ *
+ * Reader đang gắn vẫn đọc được bản cuối cùng cho tới khi tự gỡ map.
+ *
+ * \param[in,out]   catalog: Segment của writer
+ */
+void
+shm_catalog_unlink(shm_catalog_t* catalog) {
+    if (catalog == NULL || catalog->base == NULL) {
+        return;
+    }
+    shm_unlink(catalog->name);
+    shm_catalog_detach(catalog);
+}
+
+/**
+ * \brief           Gắn vào segment có sẵn ở chế độ chỉ đọc
+ * \param[out]      catalog: Segment đã map
+ * \param[in]       name: Tên segment POSIX
+ * \return          \ref SHM_OK nếu thành công, \ref shm_status_t nếu lỗi
+ */
+shm_status_t
+shm_catalog_attach(shm_catalog_t* catalog, const char* name) {
+    const shm_header_t* header;
+    shm_header_t layout;
+    struct stat st;
+    void* base;
+    int fd;
+
+    if (catalog == NULL || name == NULL || strlen(name) >= sizeof(catalog->name)) {
+        return SHM_INVALID_INPUT;
+    }
+
+    fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return SHM_ERROR;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_header_t)) {
+        close(fd);
+        return SHM_INCOMPATIBLE;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return SHM_ERROR;
+    }
+
+    /* Bố cục phải khớp với bản build này (MAX_BOOKS, MAX_USERS, ...) */
+    header = base;
+    memset(&layout, 0, sizeof(layout));
+    shm_layout(&layout);
+    if (header->magic != SHM_MAGIC || header->version != SHM_VERSION
+        || header->segment_size != (uint64_t)st.st_size || header->segment_size != layout.segment_size
+        || header->book_capacity != layout.book_capacity || header->user_capacity != layout.user_capacity) {
+        munmap(base, (size_t)st.st_size);
+        return SHM_INCOMPATIBLE;
+    }
+
+    catalog->base = base;
+    catalog->size = (size_t)st.st_size;
+    catalog->writable = 0;
+    strcpy(catalog->name, name);
+    return SHM_OK;
+}
+
+/**
+ * \brief           Gỡ map segment
+ * \param[in,out]   catalog: Segment đã map
+ */
+void
+shm_catalog_detach(shm_catalog_t* catalog) {
+    if (catalog == NULL || catalog->base == NULL) {
+        return;
+    }
+    munmap(catalog->base, catalog->size);
+    catalog->base = NULL;
+    catalog->size = 0;
+}
+
+/**
+ * \brief           Bắt đầu đọc bản công bố mới nhất
+ *
+ * Cách dùng: lặp { \ref shm_read_begin; đọc qua khung nhìn và chép ra phần
+ * cần giữ; } cho tới khi \ref shm_read_retry trả về 0. Không có khóa hay
+ * syscall nào trên đường đọc.
+ *
+ * \param[in]       catalog: Segment đã gắn
+ * \param[out]      view: Khung nhìn
+ * \return          \ref SHM_OK nếu thành công, \ref SHM_NOT_READY nếu chưa có bản nào
+ */
+shm_status_t
+shm_read_begin(const shm_catalog_t* catalog, shm_view_t* view) {
+    const shm_header_t* header;
+    uint64_t seq;
+
+    if (catalog == NULL || catalog->base == NULL || view == NULL) {
+        return SHM_INVALID_INPUT;
+    }
+
+    header = (const shm_header_t*)catalog->base;
+    seq = atomic_load_explicit(&header->seq, memory_order_acquire);
+    if (seq < 2) {
+        return SHM_NOT_READY;
+    }
+    view->catalog = catalog;
+    view->seq = seq;
+    view->image = &catalog->base[header->image_offset[(seq / 2) & 1]];
+    return SHM_OK;
+}
+
+/**
+ * \brief           Kiểm tra dữ liệu vừa đọc qua khung nhìn có còn nguyên vẹn
+ *
+ * Image của bản e chỉ bị ghi đè khi writer bắt đầu bản e + 2 (seq = 2e + 3).
+ *
+ * \param[in]       view: Khung nhìn từ \ref shm_read_begin
+ * \return          1 nếu phải đọc lại, 0 nếu dữ liệu đã đọc hợp lệ
+ */
+uint8_t
+shm_read_retry(const shm_view_t* view) {
+    const shm_header_t* header;
+    uint64_t seq;
+
+    header = (const shm_header_t*)view->catalog->base;
+    atomic_thread_fence(memory_order_acquire);
+    seq = atomic_load_explicit(&header->seq, memory_order_relaxed);
+    return (seq > (view->seq / 2) * 2 + 2) ? 1 : 0;
+}
+
+/**
+ * \brief           Phần đầu của bản công bố đang đọc
+ * \param[in]       view: Khung nhìn
+ * \return          Con trỏ tới phần đầu image
+ */
+const shm_image_t*
+shm_view_image(const shm_view_t* view) {
+    return (const shm_image_t*)view->image;
+}
+
+/**
+ * \brief           Tìm sách theo ID bằng bảng băm trong segment
+ *
+ * Số bước dò bị chặn bởi số ô nên dữ liệu đang bị ghi dở cũng không làm
+ * vòng lặp chạy mãi; kết quả khi đó bị \ref shm_read_retry loại bỏ.
+ *
+ * \param[in]       view: Khung nhìn
+ * \param[in]       book_id: ID sách
+ * \return          Con trỏ vào segment, NULL nếu không tìm thấy
+ */
+const shm_book_t*
+shm_view_find_book(const shm_view_t* view, uint32_t book_id) {
+    const shm_header_t* header;
+    const shm_book_t* books;
+    const uint32_t* index;
+    uint32_t slot;
+    uint32_t entry;
+    uint32_t step;
+
+    header = (const shm_header_t*)view->catalog->base;
+    books = (const shm_book_t*)&view->image[header->books_offset];
+    index = (const uint32_t*)&view->image[header->book_index_offset];
+    slot = shm_slot(book_id, header->book_index_capacity);
+    for (step = 0; step < header->book_index_capacity; step++) {
+        entry = index[slot];
+        if (entry == 0) {
+            return NULL;
+        }
+        if (entry <= header->book_capacity && books[entry - 1].book_id == book_id) {
+            return &books[entry - 1];
+        }
+        slot = (slot + 1) & (header->book_index_capacity - 1);
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Tìm người dùng theo ID bằng bảng băm trong segment
+ * \param[in]       view: Khung nhìn
+ * \param[in]       user_id: ID người dùng
+ * \return          Con trỏ vào segment, NULL nếu không tìm thấy
+ */
+const shm_user_t*
+shm_view_find_user(const shm_view_t* view, uint32_t user_id) {
+    const shm_header_t* header;
+    const shm_user_t* users;
+    const uint32_t* index;
+    uint32_t slot;
+    uint32_t entry;
+    uint32_t step;
+
+    header = (const shm_header_t*)view->catalog->base;
+    users = (const shm_user_t*)&view->image[header->users_offset];
+    index = (const uint32_t*)&view->image[header->user_index_offset];
+    slot = shm_slot(user_id, header->user_index_capacity);
+    for (step = 0; step < header->user_index_capacity; step++) {
+        entry = index[slot];
+        if (entry == 0) {
+            return NULL;
+        }
+        if (entry <= header->user_capacity && users[entry - 1].user_id == user_id) {
+            return &users[entry - 1];
+        }
+        slot = (slot + 1) & (header->user_index_capacity - 1);
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Danh sách khóa item người dùng đang mượn
+ * \param[in]       view: Khung nhìn
+ * \param[in]       user: Người dùng lấy từ cùng khung nhìn
+ * \return          Mảng \ref shm_user_t::borrowed_count khóa item, NULL nếu dữ liệu không hợp lệ
+ */
+const uint32_t*
+shm_view_user_loans(const shm_view_t* view, const shm_user_t* user) {
+    const shm_header_t* header;
+
+    header = (const shm_header_t*)view->catalog->base;
+    if (user == NULL || user->loan_first > header->loan_capacity
+        || user->borrowed_count > header->loan_capacity - user->loan_first) {
+        return NULL;
+    }
+    return &((const uint32_t*)&view->image[header->loans_offset])[user->loan_first];
+}
+
+/**
+ * \brief           Tìm sách khớp bộ lọc, ghi ID vào bộ đệm của người gọi
+ * \param[in]       view: Khung nhìn
+ * \param[in]       filter: Bộ lọc (như \ref book_query)
+ * \param[in]       text: Chuỗi truy vấn cho bộ lọc tiêu đề/tác giả
+ * \param[out]      ids: Bộ đệm ID (có thể NULL khi chỉ đếm)
+ * \param[in]       capacity: Số ID tối đa ghi vào \p ids
+ * \return          Tổng số sách khớp (có thể lớn hơn \p capacity)
+ */
+size_t
+shm_view_search(const shm_view_t* view, book_filter_t filter, const char* text,
+                uint32_t* ids, size_t capacity) {
+    char needle[MAX_STRING_LENGTH];
+    const shm_header_t* header;
+    const shm_book_t* books;
+    uint32_t count;
+    uint32_t i;
+    size_t matched;
+    uint8_t hit;
+
+    header = (const shm_header_t*)view->catalog->base;
+    books = (const shm_book_t*)&view->image[header->books_offset];
+    count = shm_view_image(view)->book_count;
+    if (count > header->book_capacity) {
+        count = header->book_capacity;
+    }
+    if (filter == BOOK_FILTER_TITLE || filter == BOOK_FILTER_AUTHOR) {
+        if (text == NULL) {
+            return 0;
+        }
+        strncpy(needle, text, MAX_STRING_LENGTH - 1);
+        needle[MAX_STRING_LENGTH - 1] = '\0';
+        to_lowercase(needle);
+    }
+
+    matched = 0;
+    for (i = 0; i < count; i++) {
+        switch (filter) {
+            case BOOK_FILTER_ALL:
+                hit = 1;
+                break;
+            case BOOK_FILTER_AVAILABLE:
+                hit = (books[i].available_count > 0) ? 1 : 0;
+                break;
+            case BOOK_FILTER_TITLE:
+                hit = (uint8_t)string_contains_lower(books[i].title, needle);
+                break;
+            case BOOK_FILTER_AUTHOR:
+                hit = (uint8_t)string_contains_lower(books[i].author, needle);
+                break;
+            default:
+                return matched;
+        }
+        if (!hit) {
+            continue;
+        }
+        if (ids != NULL && matched < capacity) {
+            ids[matched] = books[i].book_id;
+        }
+        matched++;
+    }
+    return matched;
+}
@@ -0,0 +1,174 @@
+/**
+ * \file            shm.h
+ * \brief           Vùng nhớ dùng chung chứa catalog cho nhiều tiến trình chỉ đọc
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef SHM_HDR_H
+#define SHM_HDR_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "../Book/book.h"
+#include "../User/user.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define SHM_DEFAULT_NAME            "/library_catalog"  /*!< Tên segment POSIX mặc định */
+#define SHM_MAGIC                   0x4C494243u /*!< "LIBC": đánh dấu segment hợp lệ */
+#define SHM_VERSION                 1u          /*!< Phiên bản bố cục segment */
+#define SHM_MAX_LOANS               ((uint32_t)MAX_BOOKS * MAX_COPIES_PER_BOOK) /*!< Số lượt mượn tối đa */
+#define SHM_MAX_RETRIES             1000        /*!< Số lần đọc lại tối đa khi writer liên tục ghi đè */
+
+/**
+ * \brief           Trạng thái trả về của các hàm vùng nhớ dùng chung
+ */
+typedef enum {
+    SHM_OK = 0,                                 /*!< Thành công */
+    SHM_ERROR,                                  /*!< Lỗi chung (errno cho biết chi tiết) */
+    SHM_INVALID_INPUT,                          /*!< Dữ liệu đầu vào không hợp lệ */
+    SHM_INCOMPATIBLE,                           /*!< Segment không đúng định dạng hoặc phiên bản */
+    SHM_NOT_READY,                              /*!< Writer chưa công bố bản nào */
+    SHM_BUSY,                                   /*!< Writer ghi đè liên tục, đọc lại quá nhiều lần */
+} shm_status_t;
+
+/**
+ * \brief           Bản ghi sách trong segment (không chứa con trỏ)
+ */
+typedef struct {
+    uint32_t book_id;                           /*!< ID sách */
+    char title[MAX_TITLE_LENGTH];               /*!< Tiêu đề */
+    char author[MAX_AUTHOR_LENGTH];             /*!< Tác giả */
+    uint8_t copy_count;                         /*!< Số bản sao */
+    uint8_t available_count;                    /*!< Số bản sao có sẵn */
+    uint32_t hold_length;                       /*!< Số người đang đặt giữ */
+    uint64_t available_mask;                    /*!< Bitmap bản sao có sẵn */
+} shm_book_t;
+
+/**
+ * \brief           Bản ghi người dùng trong segment
+ *
+ * Danh sách mượn nằm liền nhau trong mảng lượt mượn của bản công bố, bắt đầu
+ * tại \ref loan_first; không có con trỏ nên mọi tiến trình đọc được.
+ */
+typedef struct {
+    uint32_t user_id;                           /*!< ID người dùng */
+    char name[MAX_NAME_LENGTH];                 /*!< Tên */
+    uint8_t tier;                               /*!< \ref user_tier_t */
+    uint32_t borrowed_count;                    /*!< Số bản sao đang mượn */
+    uint32_t loan_first;                        /*!< Chỉ số lượt mượn đầu tiên trong mảng lượt mượn */
+} shm_user_t;
+
+/**
+ * \brief           Phần đầu của một bản công bố (image)
+ */
+typedef struct {
+    uint64_t epoch;                             /*!< Số thứ tự của lần công bố */
+    uint64_t generation;                        /*!< Generation của danh sách sách khi công bố */
+    uint32_t book_count;                        /*!< Số sách */
+    uint32_t user_count;                        /*!< Số người dùng */
+    uint32_t loan_count;                        /*!< Tổng số lượt mượn */
+} shm_image_t;
+
+/**
+ * \brief           Phần đầu của segment
+ *
+ * Segment giữ hai bản công bố; mọi tham chiếu là offset tính từ đầu segment
+ * (với image) hoặc từ đầu image (với các mảng) nên segment có thể được map
+ * ở địa chỉ bất kỳ. \ref seq là seqlock: giá trị chẵn 2e nghĩa là bản e đã
+ * công bố ở image[e mod 2]; giá trị lẻ 2e + 1 nghĩa là writer đang ghi bản
+ * e + 1 vào image còn lại, bản e vẫn đọc được.
+ */
+typedef struct {
+    uint32_t magic;                             /*!< \ref SHM_MAGIC */
+    uint32_t version;                           /*!< \ref SHM_VERSION */
+    uint64_t segment_size;                      /*!< Kích thước toàn segment */
+    _Atomic uint64_t seq;                       /*!< Bộ đếm seqlock */
+    uint32_t book_capacity;                     /*!< Số sách tối đa */
+    uint32_t user_capacity;                     /*!< Số người dùng tối đa */
+    uint32_t loan_capacity;                     /*!< Số lượt mượn tối đa */
+    uint32_t book_index_capacity;               /*!< Số ô bảng băm ID sách (lũy thừa của 2) */
+    uint32_t user_index_capacity;               /*!< Số ô bảng băm ID người dùng (lũy thừa của 2) */
+    uint64_t image_offset[2];                   /*!< Offset của hai image tính từ đầu segment */
+    uint64_t books_offset;                      /*!< Offset mảng \ref shm_book_t tính từ đầu image */
+    uint64_t users_offset;                      /*!< Offset mảng \ref shm_user_t tính từ đầu image */
+    uint64_t loans_offset;                      /*!< Offset mảng khóa item tính từ đầu image */
+    uint64_t book_index_offset;                 /*!< Offset bảng băm ID sách tính từ đầu image */
+    uint64_t user_index_offset;                 /*!< Offset bảng băm ID người dùng tính từ đầu image */
+} shm_header_t;
+
+/**
+ * \brief           Một segment đã map vào tiến trình hiện tại
+ */
+typedef struct {
+    uint8_t* base;                              /*!< Địa chỉ map trong tiến trình này */
+    size_t size;                                /*!< Kích thước map */
+    uint8_t writable;                           /*!< 1 nếu là writer */
+    char name[64];                              /*!< Tên segment */
+} shm_catalog_t;
+
+/**
+ * \brief           Khung nhìn đọc một bản công bố
+ *
+ * Con trỏ lấy từ khung nhìn trỏ thẳng vào segment (không sao chép) và chỉ
+ * đáng tin sau khi \ref shm_read_retry trả về 0.
+ */
+typedef struct {
+    const shm_catalog_t* catalog;               /*!< Segment đang đọc */
+    const uint8_t* image;                       /*!< Đầu image đang đọc */
+    uint64_t seq;                               /*!< Giá trị seqlock lúc bắt đầu đọc */
+} shm_view_t;
+
+/* Khai báo các hàm của writer */
+shm_status_t    shm_catalog_create(shm_catalog_t* catalog, const char* name);
+shm_status_t    shm_publish(shm_catalog_t* catalog, const book_list_t* books, const user_list_t* users);
+void            shm_catalog_unlink(shm_catalog_t* catalog);
+
+/* Khai báo các hàm của reader */
+shm_status_t    shm_catalog_attach(shm_catalog_t* catalog, const char* name);
+void            shm_catalog_detach(shm_catalog_t* catalog);
+shm_status_t    shm_read_begin(const shm_catalog_t* catalog, shm_view_t* view);
+uint8_t         shm_read_retry(const shm_view_t* view);
+const shm_image_t* shm_view_image(const shm_view_t* view);
+const shm_book_t* shm_view_find_book(const shm_view_t* view, uint32_t book_id);
+const shm_user_t* shm_view_find_user(const shm_view_t* view, uint32_t user_id);
+const uint32_t* shm_view_user_loans(const shm_view_t* view, const shm_user_t* user);
+size_t          shm_view_search(const shm_view_t* view, book_filter_t filter, const char* text,
+                                uint32_t* ids, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SHM_HDR_H */
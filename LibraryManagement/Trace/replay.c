@@ -0,0 +1,349 @@
+/**
+ * \file            replay.c
+ * \brief           Phát lại trace thao tác và đo thông lượng, độ trễ
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "trace.h"
+#include "../Book/book.h"
+#include "../User/user.h"
+#include "../Management/management.h"
+#include "../Column/column.h"
+
+#define REPLAY_MAX_REPORTED         5           /* Số lần lệch trạng thái được in chi tiết */
+
+/**
+ * \brief           Mẫu độ trễ của một loại thao tác
+ */
+typedef struct {
+    uint32_t* samples;                          /*!< Độ trễ khi phát lại (nano giây) */
+    size_t count;                               /*!< Số mẫu */
+    size_t capacity;                            /*!< Dung lượng mảng mẫu */
+    uint64_t original_ns;                       /*!< Tổng thời gian thực hiện lúc ghi */
+} replay_series_t;
+
+/* Dữ liệu thư viện nằm ở vùng tĩnh để không phụ thuộc kích thước stack khi MAX_BOOKS lớn */
+static book_list_t replay_books;
+static user_list_t replay_users;
+static hold_pool_t replay_holds;
+static query_cache_t replay_cache;
+static scan_pool_t replay_scan;
+static cdc_log_t replay_cdc;
+static history_t replay_history;
+static uint8_t replay_snapshot[COLUMN_MAX_SNAPSHOT];
+static replay_series_t replay_series[TRACE_OP_COUNT];
+
+/**
+ * \brief           Thời gian hiện tại (nano giây, đơn điệu)
+ * \return          Số nano giây
+ */
+static uint64_t
+replay_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief           Chờ tới thời điểm cho trước
+ * \param[in]       deadline: Thời điểm (nano giây, đồng hồ \ref replay_now_ns)
+ */
+static void
+replay_sleep_until(uint64_t deadline) {
+    struct timespec ts;
+    uint64_t now;
+
+    now = replay_now_ns();
+    if (deadline <= now) {
+        return;
+    }
+    ts.tv_sec = (time_t)((deadline - now) / 1000000000ULL);
+    ts.tv_nsec = (long)((deadline - now) % 1000000000ULL);
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * \brief           Thêm một mẫu độ trễ
+ * \param[in,out]   series: Chuỗi mẫu
+ * \param[in]       latency: Độ trễ (nano giây)
+ * \return          1 nếu thành công, 0 nếu hết bộ nhớ
+ */
+static uint8_t
+replay_add_sample(replay_series_t* series, uint64_t latency) {
+    uint32_t* grown;
+    size_t capacity;
+
+    if (series->count == series->capacity) {
+        capacity = (series->capacity > 0) ? series->capacity * 2 : 1024;
+        grown = realloc(series->samples, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return 0;
+        }
+        series->samples = grown;
+        series->capacity = capacity;
+    }
+    series->samples[series->count++] = (latency > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency;
+    return 1;
+}
+
+/**
+ * \brief           Hàm so sánh cho qsort
+ * \param[in]       a: Phần tử thứ nhất
+ * \param[in]       b: Phần tử thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+replay_compare_u32(const void* a, const void* b) {
+    uint32_t x;
+    uint32_t y;
+
+    x = *(const uint32_t*)a;
+    y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           Tìm kiếm như \ref mgmt_search_books nhưng không in kết quả
+ * \param[in,out]   library: Thư viện
+ * \param[in]       field: Trường tìm kiếm
+ * \param[in]       text: Chuỗi tìm kiếm
+ * \return          Số sách khớp
+ */
+static size_t
+replay_search(library_t* library, query_field_t field, const char* text) {
+    query_result_t result;
+    scan_result_t scanned;
+
+    if (query_cache_search(library->cache, library->books, field, text, &result) == QUERY_CACHE_OK
+        && result.count == result.total) {
+        return result.count;
+    }
+    if (scan_books_match(library->scan, library->books, field, text, &scanned) == SCAN_OK) {
+        return scanned.count;
+    }
+    return book_query(library->books, (field == QUERY_FIELD_TITLE) ? BOOK_FILTER_TITLE : BOOK_FILTER_AUTHOR,
+                      text, NULL, NULL);
+}
+
+/**
+ * \brief           Thực hiện một thao tác của trace
+ * \param[in,out]   library: Thư viện
+ * \param[in]       event: Thao tác
+ * \param[out]      assigned_id: ID được gán khi thêm sách hoặc người dùng (0 với thao tác khác)
+ * \return          Mã trạng thái của thao tác
+ */
+static uint8_t
+replay_execute(library_t* library, const trace_event_t* event, uint32_t* assigned_id) {
+    scan_counts_t counts;
+    history_rank_t popular;
+    uint32_t handed_to;
+
+    *assigned_id = 0;
+    switch (event->op) {
+        case TRACE_OP_ADD_BOOK:
+            return (uint8_t)book_add(library->books, event->text, event->author, assigned_id);
+        case TRACE_OP_ADD_USER:
+            return (uint8_t)user_add(library->users, event->text, assigned_id);
+        case TRACE_OP_ADD_COPIES:
+            return (uint8_t)mgmt_add_copies(library, event->book_id, (uint8_t)event->value, &handed_to);
+        case TRACE_OP_SEARCH_TITLE:
+            replay_search(library, QUERY_FIELD_TITLE, event->text);
+            return 0;
+        case TRACE_OP_SEARCH_AUTHOR:
+            replay_search(library, QUERY_FIELD_AUTHOR, event->text);
+            return 0;
+        case TRACE_OP_BORROW:
+            return (uint8_t)mgmt_borrow_book(library, event->user_id, event->book_id);
+        case TRACE_OP_RETURN:
+            return (uint8_t)mgmt_return_book_handoff(library, event->user_id, event->book_id, &handed_to);
+        default:
+            scan_books_count(library->scan, library->books, &counts);
+            user_count_total(library->users);
+            history_popular(library->history, &popular, 1);
+            return 0;
+    }
+}
+
+/**
+ * \brief           In hướng dẫn sử dụng
+ * \param[in]       prog: Tên chương trình
+ */
+static void
+replay_usage(const char* prog) {
+    fprintf(stderr, "Cách dùng: %s [-x tốc_độ] [-c snapshot_cột] trace\n", prog);
+    fprintf(stderr, "  -x  0 = nhanh nhất có thể (mặc định), 1 = đúng nhịp gốc, 2 = nhanh gấp đôi, ...\n");
+    fprintf(stderr, "  -c  nạp sách từ snapshot dạng cột trước khi phát lại (mặc định: thư viện rỗng)\n");
+}
+
+/**
+ * \brief           Điểm bắt đầu của library_replay
+ * \param[in]       argc: Số tham số
+ * \param[in]       argv: Mảng tham số
+ * \return          0 nếu thành công
+ */
+int
+main(int argc, char** argv) {
+    library_t library;
+    trace_reader_t reader;
+    trace_event_t event;
+    column_snapshot_t snapshot;
+    replay_series_t* series;
+    const char* snapshot_path;
+    double speed;
+    double elapsed;
+    uint64_t started;
+    uint64_t op_started;
+    uint64_t latency;
+    uint64_t operations;
+    uint64_t diverged;
+    uint32_t assigned_id;
+    uint8_t status;
+    trace_status_t trace_status;
+    int opt;
+    int op;
+
+    speed = 0.0;
+    snapshot_path = NULL;
+    while ((opt = getopt(argc, argv, "x:c:h")) != -1) {
+        switch (opt) {
+            case 'x':
+                speed = atof(optarg);
+                break;
+            case 'c':
+                snapshot_path = optarg;
+                break;
+            default:
+                replay_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind + 1 != argc || speed < 0.0) {
+        replay_usage(argv[0]);
+        return 1;
+    }
+
+    /* Khởi tạo thư viện giống ứng dụng chính */
+    book_init(&replay_books);
+    user_init(&replay_users);
+    hold_pool_init(&replay_holds);
+    query_cache_init(&replay_cache);
+    scan_pool_init(&replay_scan, 0);
+    cdc_init(&replay_cdc);
+    history_init(&replay_history);
+    replay_cache.scan = &replay_scan;
+    library.books = &replay_books;
+    library.users = &replay_users;
+    library.holds = &replay_holds;
+    library.cache = &replay_cache;
+    library.scan = &replay_scan;
+    library.cdc = &replay_cdc;
+    library.history = &replay_history;
+    library.barcodes = NULL;
+    library.notify = NULL;
+    library.txn = NULL;
+
+    if (snapshot_path != NULL
+        && (column_load_file(&snapshot, snapshot_path, replay_snapshot, sizeof(replay_snapshot)) != COLUMN_OK
+            || column_restore(&snapshot, &replay_books) != COLUMN_OK)) {
+        fprintf(stderr, "Không thể nạp snapshot %s\n", snapshot_path);
+        return 1;
+    }
+    cdc_attach(&replay_cdc, &replay_books, &replay_users);
+
+    if (trace_reader_open(&reader, argv[optind]) != TRACE_OK) {
+        fprintf(stderr, "Không thể mở trace %s\n", argv[optind]);
+        return 1;
+    }
+
+    operations = 0;
+    diverged = 0;
+    started = replay_now_ns();
+    while ((trace_status = trace_read(&reader, &event)) == TRACE_OK) {
+        if (speed > 0.0) {
+            replay_sleep_until(started + (uint64_t)((double)event.time_ns / speed));
+        }
+
+        op_started = replay_now_ns();
+        status = replay_execute(&library, &event, &assigned_id);
+        latency = replay_now_ns() - op_started;
+
+        series = &replay_series[event.op];
+        series->original_ns += event.duration_ns;
+        if (!replay_add_sample(series, latency)) {
+            fprintf(stderr, "Hết bộ nhớ cho mẫu độ trễ\n");
+            break;
+        }
+
+        /* Trạng thái hoặc ID được gán khác lúc ghi: thư viện ban đầu không khớp với trace */
+        if (status != event.status
+            || (event.op == TRACE_OP_ADD_BOOK && assigned_id != event.book_id)
+            || (event.op == TRACE_OP_ADD_USER && assigned_id != event.user_id)) {
+            if (diverged < REPLAY_MAX_REPORTED) {
+                fprintf(stderr, "Lệch ở thao tác #%llu (%s): trạng thái gốc %u, phát lại %u\n",
+                        (unsigned long long)operations + 1, trace_op_name(event.op), event.status, status);
+            }
+            diverged++;
+        }
+        operations++;
+    }
+    elapsed = (double)(replay_now_ns() - started) / 1e9;
+    trace_reader_close(&reader);
+    if (trace_status == TRACE_CORRUPT) {
+        fprintf(stderr, "Trace bị hỏng sau %llu thao tác\n", (unsigned long long)operations);
+    }
+
+    printf("Thao tác: %llu (%llu lệch trạng thái), thời gian: %.3f s, thông lượng: %.0f thao tác/s\n",
+           (unsigned long long)operations, (unsigned long long)diverged, elapsed,
+           elapsed > 0 ? (double)operations / elapsed : 0.0);
+    printf("%-14s %10s %10s %10s %10s %10s %12s\n",
+           "Thao tác", "Số lượng", "p50 (ns)", "p90 (ns)", "p99 (ns)", "max (ns)", "gốc TB (ns)");
+    for (op = 0; op < TRACE_OP_COUNT; op++) {
+        series = &replay_series[op];
+        if (series->count == 0) {
+            continue;
+        }
+        qsort(series->samples, series->count, sizeof(*series->samples), replay_compare_u32);
+        printf("%-14s %10zu %10u %10u %10u %10u %12llu\n", trace_op_name((trace_op_t)op), series->count,
+               series->samples[series->count * 50 / 100], series->samples[series->count * 90 / 100],
+               series->samples[series->count * 99 / 100], series->samples[series->count - 1],
+               (unsigned long long)(series->original_ns / series->count));
+        free(series->samples);
+    }
+
+    scan_pool_destroy(&replay_scan);
+    return (trace_status == TRACE_CORRUPT) ? 1 : 0;
+}
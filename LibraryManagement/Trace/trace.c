@@ -0,0 +1,409 @@
+/**
+ * \file            trace.c
+ * \brief           Triển khai bộ ghi và bộ đọc trace thao tác của thư viện
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <string.h>
+#include <time.h>
+#include "trace.h"
+
+/* Hằng số nội bộ */
+#define TRACE_HEADER_SIZE           16          /*!< magic, phiên bản, dự trữ, đồng hồ lúc mở */
+#define TRACE_MAX_RECORD            (1 + 3 * 10 + 1 + 3 * 5 + 2 * (5 + MAX_TITLE_LENGTH))
+
+static const char* const trace_op_names[TRACE_OP_COUNT] = {
+    "add_book", "add_user", "add_copies", "search_title", "search_author", "borrow", "return", "stats",
+};
+
+/**
+ * \brief           Bộ đệm mã hóa một bản ghi
+ */
+typedef struct {
+    uint8_t data[TRACE_MAX_RECORD];             /*!< Dữ liệu */
+    size_t length;                              /*!< Số byte đã ghi */
+} trace_buffer_t;
+
+/**
+ * \brief           Ghi số nguyên không dấu dạng varint (7 bit mỗi byte)
+ * \param[in,out]   buffer: Bộ đệm
+ * \param[in]       value: Giá trị
+ */
+static void
+trace_put_varint(trace_buffer_t* buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer->data[buffer->length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->length++] = (uint8_t)value;
+}
+
+/**
+ * \brief           Ghi chuỗi kèm tiền tố độ dài dạng varint
+ * \param[in,out]   buffer: Bộ đệm
+ * \param[in]       text: Chuỗi (đã giới hạn bởi kích thước trường của \ref trace_event_t)
+ * \param[in]       capacity: Kích thước trường chứa \p text
+ */
+static void
+trace_put_string(trace_buffer_t* buffer, const char* text, size_t capacity) {
+    size_t length;
+
+    length = 0;
+    while (length + 1 < capacity && text[length] != '\0') {
+        length++;
+    }
+    trace_put_varint(buffer, length);
+    memcpy(&buffer->data[buffer->length], text, length);
+    buffer->length += length;
+}
+
+/**
+ * \brief           Đọc một varint từ file
+ * \param[in]       in: File
+ * \param[out]      value: Giá trị
+ * \return          \ref TRACE_OK, \ref TRACE_END nếu hết file ngay từ byte đầu, \ref TRACE_CORRUPT nếu bị cắt cụt
+ */
+static trace_status_t
+trace_get_varint(FILE* in, uint64_t* value) {
+    uint64_t result;
+    uint32_t shift;
+    int byte;
+
+    result = 0;
+    for (shift = 0; shift < 64; shift += 7) {
+        byte = fgetc(in);
+        if (byte == EOF) {
+            return (shift == 0) ? TRACE_END : TRACE_CORRUPT;
+        }
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return TRACE_OK;
+        }
+    }
+    return TRACE_CORRUPT;
+}
+
+/**
+ * \brief           Đọc một số nguyên 32 bit dạng varint
+ * \param[in]       in: File
+ * \param[out]      value: Giá trị
+ * \return          1 nếu thành công, 0 nếu lỗi hoặc vượt 32 bit
+ */
+static uint8_t
+trace_get_u32(FILE* in, uint32_t* value) {
+    uint64_t raw;
+
+    if (trace_get_varint(in, &raw) != TRACE_OK || raw > UINT32_MAX) {
+        return 0;
+    }
+    *value = (uint32_t)raw;
+    return 1;
+}
+
+/**
+ * \brief           Đọc chuỗi có tiền tố độ dài
+ * \param[in]       in: File
+ * \param[out]      text: Bộ đệm nhận chuỗi (kết thúc bằng '\0')
+ * \param[in]       capacity: Dung lượng \p text
+ * \return          1 nếu thành công, 0 nếu lỗi
+ */
+static uint8_t
+trace_get_string(FILE* in, char* text, size_t capacity) {
+    uint64_t length;
+
+    if (trace_get_varint(in, &length) != TRACE_OK || length >= capacity
+        || fread(text, 1, (size_t)length, in) != length) {
+        text[0] = '\0';
+        return 0;
+    }
+    text[length] = '\0';
+    return 1;
+}
+
+/**
+ * \brief           Đọc đồng hồ thời gian thực
+ * \return          Số nano giây kể từ epoch
+ */
+uint64_t
+trace_clock_ns(void) {
+    struct timespec now;
+
+    if (timespec_get(&now, TIME_UTC) != TIME_UTC) {
+        return 0;
+    }
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief           Mở file trace để ghi (ghi đè file cũ)
+ * \param[out]      writer: Bộ ghi
+ * \param[in]       path: Đường dẫn file
+ * \return          \ref TRACE_OK nếu thành công, \ref trace_status_t nếu lỗi
+ */
+trace_status_t
+trace_open(trace_writer_t* writer, const char* path) {
+    uint8_t header[TRACE_HEADER_SIZE];
+    size_t i;
+
+    if (writer == NULL || path == NULL) {
+        return TRACE_INVALID_INPUT;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->out = fopen(path, "wb");
+    if (writer->out == NULL) {
+        return TRACE_IO_ERROR;
+    }
+    writer->origin_ns = trace_clock_ns();
+
+    memset(header, 0, sizeof(header));
+    for (i = 0; i < 4; i++) {
+        header[i] = (uint8_t)(TRACE_MAGIC >> (8 * i));
+    }
+    header[4] = TRACE_VERSION;
+    for (i = 0; i < 8; i++) {
+        header[8 + i] = (uint8_t)(writer->origin_ns >> (8 * i));
+    }
+    if (fwrite(header, 1, sizeof(header), writer->out) != sizeof(header)) {
+        fclose(writer->out);
+        writer->out = NULL;
+        return TRACE_IO_ERROR;
+    }
+    return TRACE_OK;
+}
+
+/**
+ * \brief           Ghi một thao tác vào trace
+ *
+ * Bản ghi được đẩy ra file ngay để trace vẫn dùng được nếu chương trình bị dừng đột ngột.
+ *
+ * \param[in,out]   writer: Bộ ghi (chưa mở = bỏ qua)
+ * \param[in]       event: Thao tác; \ref time_ns là đồng hồ tuyệt đối lúc bắt đầu (\ref trace_clock_ns)
+ * \return          \ref TRACE_OK nếu thành công, \ref trace_status_t nếu lỗi
+ */
+trace_status_t
+trace_write(trace_writer_t* writer, const trace_event_t* event) {
+    trace_buffer_t buffer;
+    uint64_t time_ns;
+
+    if (writer == NULL || writer->out == NULL) {
+        return TRACE_OK;
+    }
+    if (event == NULL || (unsigned)event->op >= TRACE_OP_COUNT) {
+        return TRACE_INVALID_INPUT;
+    }
+
+    /* Đồng hồ thời gian thực có thể lùi: giữ thời điểm không giảm */
+    time_ns = (event->time_ns > writer->origin_ns) ? event->time_ns - writer->origin_ns : 0;
+    if (time_ns < writer->last_ns) {
+        time_ns = writer->last_ns;
+    }
+
+    buffer.length = 0;
+    buffer.data[buffer.length++] = (uint8_t)event->op;
+    trace_put_varint(&buffer, time_ns - writer->last_ns);
+    trace_put_varint(&buffer, event->duration_ns);
+    buffer.data[buffer.length++] = event->status;
+    switch (event->op) {
+        case TRACE_OP_ADD_BOOK:
+            trace_put_varint(&buffer, event->book_id);
+            trace_put_string(&buffer, event->text, sizeof(event->text));
+            trace_put_string(&buffer, event->author, sizeof(event->author));
+            break;
+        case TRACE_OP_ADD_USER:
+            trace_put_varint(&buffer, event->user_id);
+            trace_put_string(&buffer, event->text, sizeof(event->text));
+            break;
+        case TRACE_OP_ADD_COPIES:
+            trace_put_varint(&buffer, event->book_id);
+            trace_put_varint(&buffer, event->value);
+            break;
+        case TRACE_OP_SEARCH_TITLE:
+        case TRACE_OP_SEARCH_AUTHOR:
+            trace_put_string(&buffer, event->text, sizeof(event->text));
+            break;
+        case TRACE_OP_BORROW:
+        case TRACE_OP_RETURN:
+            trace_put_varint(&buffer, event->user_id);
+            trace_put_varint(&buffer, event->book_id);
+            break;
+        default:
+            break;
+    }
+
+    if (fwrite(buffer.data, 1, buffer.length, writer->out) != buffer.length || fflush(writer->out) != 0) {
+        return TRACE_IO_ERROR;
+    }
+    writer->last_ns = time_ns;
+    writer->events++;
+    return TRACE_OK;
+}
+
+/**
+ * \brief           Đóng file trace
+ * \param[in,out]   writer: Bộ ghi
+ */
+void
+trace_close(trace_writer_t* writer) {
+    if (writer == NULL || writer->out == NULL) {
+        return;
+    }
+    fclose(writer->out);
+    writer->out = NULL;
+}
+
+/**
+ * \brief           Mở file trace để đọc và kiểm tra phần đầu
+ * \param[out]      reader: Bộ đọc
+ * \param[in]       path: Đường dẫn file
+ * \return          \ref TRACE_OK nếu thành công, \ref trace_status_t nếu lỗi
+ */
+trace_status_t
+trace_reader_open(trace_reader_t* reader, const char* path) {
+    uint8_t header[TRACE_HEADER_SIZE];
+    uint32_t magic;
+    size_t i;
+
+    if (reader == NULL || path == NULL) {
+        return TRACE_INVALID_INPUT;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    reader->in = fopen(path, "rb");
+    if (reader->in == NULL) {
+        return TRACE_IO_ERROR;
+    }
+    if (fread(header, 1, sizeof(header), reader->in) != sizeof(header)) {
+        trace_reader_close(reader);
+        return TRACE_CORRUPT;
+    }
+
+    magic = 0;
+    for (i = 0; i < 4; i++) {
+        magic |= (uint32_t)header[i] << (8 * i);
+    }
+    for (i = 0; i < 8; i++) {
+        reader->origin_ns |= (uint64_t)header[8 + i] << (8 * i);
+    }
+    if (magic != TRACE_MAGIC || header[4] != TRACE_VERSION) {
+        trace_reader_close(reader);
+        return TRACE_CORRUPT;
+    }
+    return TRACE_OK;
+}
+
+/**
+ * \brief           Đọc thao tác kế tiếp
+ * \param[in,out]   reader: Bộ đọc
+ * \param[out]      event: Thao tác; \ref time_ns tính từ lúc mở trace
+ * \return          \ref TRACE_OK, \ref TRACE_END khi hết trace, \ref TRACE_CORRUPT nếu sai định dạng
+ */
+trace_status_t
+trace_read(trace_reader_t* reader, trace_event_t* event) {
+    uint64_t delta;
+    uint8_t ok;
+    int op;
+    int status;
+
+    if (reader == NULL || reader->in == NULL || event == NULL) {
+        return TRACE_INVALID_INPUT;
+    }
+
+    op = fgetc(reader->in);
+    if (op == EOF) {
+        return TRACE_END;
+    }
+    if (op >= TRACE_OP_COUNT || trace_get_varint(reader->in, &delta) != TRACE_OK
+        || trace_get_varint(reader->in, &event->duration_ns) != TRACE_OK
+        || (status = fgetc(reader->in)) == EOF) {
+        return TRACE_CORRUPT;
+    }
+
+    event->op = (trace_op_t)op;
+    reader->last_ns += delta;
+    event->time_ns = reader->last_ns;
+    event->status = (uint8_t)status;
+    event->user_id = 0;
+    event->book_id = 0;
+    event->value = 0;
+    event->text[0] = '\0';
+    event->author[0] = '\0';
+
+    switch (event->op) {
+        case TRACE_OP_ADD_BOOK:
+            ok = trace_get_u32(reader->in, &event->book_id)
+                 && trace_get_string(reader->in, event->text, sizeof(event->text))
+                 && trace_get_string(reader->in, event->author, sizeof(event->author));
+            break;
+        case TRACE_OP_ADD_USER:
+            ok = trace_get_u32(reader->in, &event->user_id)
+                 && trace_get_string(reader->in, event->text, sizeof(event->text));
+            break;
+        case TRACE_OP_ADD_COPIES:
+            ok = trace_get_u32(reader->in, &event->book_id) && trace_get_u32(reader->in, &event->value);
+            break;
+        case TRACE_OP_SEARCH_TITLE:
+        case TRACE_OP_SEARCH_AUTHOR:
+            ok = trace_get_string(reader->in, event->text, sizeof(event->text));
+            break;
+        case TRACE_OP_BORROW:
+        case TRACE_OP_RETURN:
+            ok = trace_get_u32(reader->in, &event->user_id) && trace_get_u32(reader->in, &event->book_id);
+            break;
+        default:
+            ok = 1;
+            break;
+    }
+    return ok ? TRACE_OK : TRACE_CORRUPT;
+}
+
+/**
+ * \brief           Đóng file trace đang đọc
+ * \param[in,out]   reader: Bộ đọc
+ */
+void
+trace_reader_close(trace_reader_t* reader) {
+    if (reader == NULL || reader->in == NULL) {
+        return;
+    }
+    fclose(reader->in);
+    reader->in = NULL;
+}
+
+/**
+ * \brief           Tên ngắn của loại thao tác
+ * \param[in]       op: Loại thao tác
+ * \return          Chuỗi tên, "?" nếu không hợp lệ
+ */
+const char*
+trace_op_name(trace_op_t op) {
+    return ((unsigned)op < TRACE_OP_COUNT) ? trace_op_names[op] : "?";
+}
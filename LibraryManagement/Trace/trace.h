@@ -0,0 +1,131 @@
+/**
+ * \file            trace.h
+ * \brief           Khai báo bộ ghi và bộ đọc trace thao tác của thư viện
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef TRACE_HDR_H
+#define TRACE_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "../Book/book.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define TRACE_MAGIC                 0x4352544CU /*!< "LTRC" theo thứ tự little-endian */
+#define TRACE_VERSION               1
+#define TRACE_ENV                   "LIBRARY_TRACE" /*!< Biến môi trường chứa đường dẫn file trace */
+
+/**
+ * \brief           Trạng thái trả về của các hàm trace
+ */
+typedef enum {
+    TRACE_OK = 0,                               /*!< Thành công */
+    TRACE_ERROR,                                /*!< Lỗi chung */
+    TRACE_INVALID_INPUT,                        /*!< Dữ liệu đầu vào không hợp lệ */
+    TRACE_IO_ERROR,                             /*!< Lỗi đọc/ghi file */
+    TRACE_CORRUPT,                              /*!< File trace sai định dạng */
+    TRACE_END,                                  /*!< Đã đọc hết trace */
+} trace_status_t;
+
+/**
+ * \brief           Loại thao tác được ghi
+ */
+typedef enum {
+    TRACE_OP_ADD_BOOK = 0,                      /*!< Thêm sách: \ref book_id là ID được gán */
+    TRACE_OP_ADD_USER,                          /*!< Thêm người dùng: \ref user_id là ID được gán */
+    TRACE_OP_ADD_COPIES,                        /*!< Thêm \ref value bản sao cho sách */
+    TRACE_OP_SEARCH_TITLE,                      /*!< Tìm theo tiêu đề */
+    TRACE_OP_SEARCH_AUTHOR,                     /*!< Tìm theo tác giả */
+    TRACE_OP_BORROW,                            /*!< Mượn sách */
+    TRACE_OP_RETURN,                            /*!< Trả sách */
+    TRACE_OP_STATS,                             /*!< Xem thống kê */
+    TRACE_OP_COUNT,
+} trace_op_t;
+
+/**
+ * \brief           Một thao tác trong trace
+ */
+typedef struct {
+    trace_op_t op;                              /*!< Loại thao tác */
+    uint64_t time_ns;                           /*!< Thời điểm bắt đầu, tính từ lúc mở trace */
+    uint64_t duration_ns;                       /*!< Thời gian thực hiện lúc ghi */
+    uint8_t status;                             /*!< Mã trạng thái trả về lúc ghi */
+    uint32_t user_id;                           /*!< ID người dùng */
+    uint32_t book_id;                           /*!< ID sách */
+    uint32_t value;                             /*!< Số bản sao thêm */
+    char text[MAX_TITLE_LENGTH];                /*!< Tiêu đề, tên người dùng hoặc chuỗi tìm kiếm */
+    char author[MAX_AUTHOR_LENGTH];             /*!< Tác giả (chỉ với \ref TRACE_OP_ADD_BOOK) */
+} trace_event_t;
+
+/**
+ * \brief           Bộ ghi trace
+ *
+ * Mỗi bản ghi gồm loại thao tác, khoảng cách thời gian tới bản ghi trước và
+ * thời gian thực hiện dạng varint, mã trạng thái rồi các tham số của thao tác.
+ */
+typedef struct {
+    FILE* out;                                  /*!< File trace (NULL = chưa mở) */
+    uint64_t origin_ns;                         /*!< Đồng hồ lúc mở trace */
+    uint64_t last_ns;                           /*!< Thời điểm của bản ghi trước */
+    uint64_t events;                            /*!< Số bản ghi đã ghi */
+} trace_writer_t;
+
+/**
+ * \brief           Bộ đọc trace
+ */
+typedef struct {
+    FILE* in;                                   /*!< File trace */
+    uint64_t origin_ns;                         /*!< Đồng hồ lúc ghi trace (giây kể từ epoch x 1e9) */
+    uint64_t last_ns;                           /*!< Thời điểm của bản ghi trước */
+} trace_reader_t;
+
+/* Khai báo các hàm ghi trace */
+uint64_t        trace_clock_ns(void);
+trace_status_t  trace_open(trace_writer_t* writer, const char* path);
+trace_status_t  trace_write(trace_writer_t* writer, const trace_event_t* event);
+void            trace_close(trace_writer_t* writer);
+
+/* Khai báo các hàm đọc trace */
+trace_status_t  trace_reader_open(trace_reader_t* reader, const char* path);
+trace_status_t  trace_read(trace_reader_t* reader, trace_event_t* event);
+void            trace_reader_close(trace_reader_t* reader);
+const char*     trace_op_name(trace_op_t op);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* TRACE_HDR_H */
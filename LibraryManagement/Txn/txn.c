@@ -0,0 +1,1864 @@
+/**
+ * \file            txn.c
+ * \brief           Triển khai giao dịch MVCC trên sách và người dùng
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <string.h>
+#include "txn.h"
+
+/**
+ * \brief           Bảng băm tương ứng với loại bản ghi
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[out]      size: Số ô của bảng
+ * \return          Con trỏ tới bảng
+ */
+static txn_entry_t*
+txn_table(txn_store_t* store, txn_record_t kind, size_t* size) {
+    if (kind == TXN_RECORD_BOOK) {
+        *size = TXN_BOOK_TABLE_SIZE;
+        return store->books;
+    }
+    *size = TXN_USER_TABLE_SIZE;
+    return store->users;
+}
+
+/**
+ * \brief           Bộ đếm ô đã dùng của bảng băm tương ứng với loại bản ghi
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \return          Con trỏ tới bộ đếm
+ */
+static size_t*
+txn_table_slots(txn_store_t* store, txn_record_t kind) {
+    return (kind == TXN_RECORD_BOOK) ? &store->book_slots : &store->user_slots;
+}
+
+/**
+ * \brief           Tìm ô bảng băm của một bản ghi (không khóa)
+ *
+ * Ô bỏ không khớp ID nào nên dãy dò đi tiếp qua nó. ID được đọc seq_cst để
+ * khớp với thứ tự GC đổi ô thành ô bỏ rồi mới xem còn snapshot nào mở.
+ *
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          Con trỏ tới ô, NULL nếu bản ghi chưa từng tồn tại
+ */
+static txn_entry_t*
+txn_lookup(txn_store_t* store, txn_record_t kind, uint32_t id) {
+    txn_entry_t* table;
+    uint32_t current;
+    size_t size;
+    size_t index;
+    size_t n;
+
+    table = txn_table(store, kind, &size);
+    index = (size_t)(id * 2654435761u) % size;
+    for (n = 0; n < size; n++) {
+        current = atomic_load(&table[index].id);
+        if (current == id) {
+            return &table[index];
+        }
+        if (current == 0) {
+            return NULL;
+        }
+        index = (index + 1) % size;
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Tìm hoặc tạo ô bảng băm cho bản ghi, không thu hồi (gọi khi giữ commit_lock)
+ *
+ * ID mới ưu tiên dùng lại ô bỏ đầu tiên đã thu hồi xong trên dãy dò; chỉ lấy
+ * ô trống khi số ô đã dùng còn dưới \ref TXN_TABLE_LOAD_PERCENT để dãy dò của
+ * ID không tồn tại luôn ngắn.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          Con trỏ tới ô, NULL nếu bảng đã đầy
+ */
+static txn_entry_t*
+txn_probe_insert(txn_store_t* store, txn_record_t kind, uint32_t id) {
+    txn_entry_t* table;
+    txn_entry_t* reuse;
+    size_t* slots;
+    uint32_t current;
+    size_t size;
+    size_t index;
+    size_t n;
+
+    table = txn_table(store, kind, &size);
+    slots = txn_table_slots(store, kind);
+    reuse = NULL;
+    index = (size_t)(id * 2654435761u) % size;
+    for (n = 0; n < size; n++) {
+        current = atomic_load_explicit(&table[index].id, memory_order_relaxed);
+        if (current == id) {
+            return &table[index];
+        }
+        if (current == 0) {
+            break;
+        }
+        if (current == TXN_TOMBSTONE && reuse == NULL
+            && atomic_load_explicit(&table[index].head, memory_order_relaxed) == TXN_NIL) {
+            reuse = &table[index];
+        }
+        index = (index + 1) % size;
+    }
+
+    if (reuse == NULL) {
+        if (n == size || (*slots + 1) * 100 > size * TXN_TABLE_LOAD_PERCENT) {
+            return NULL;
+        }
+        reuse = &table[index];
+        (*slots)++;
+    }
+    atomic_store_explicit(&reuse->head, TXN_NIL, memory_order_relaxed);
+    atomic_store_explicit(&reuse->id, id, memory_order_release);
+    return reuse;
+}
+
+/**
+ * \brief           Phiên bản của bản ghi mà snapshot \p ts nhìn thấy
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \param[in]       ts: Thời điểm snapshot
+ * \return          Chỉ số phiên bản, \ref TXN_NIL nếu không tồn tại hoặc đã bị xóa
+ */
+static uint32_t
+txn_visible(txn_store_t* store, txn_record_t kind, uint32_t id, uint64_t ts) {
+    txn_entry_t* entry;
+    uint32_t version;
+
+    entry = txn_lookup(store, kind, id);
+    if (entry == NULL) {
+        return TXN_NIL;
+    }
+
+    version = atomic_load_explicit(&entry->head, memory_order_acquire);
+    while (version != TXN_NIL && store->versions[version].commit_ts > ts) {
+        version = atomic_load_explicit(&store->versions[version].older, memory_order_acquire);
+    }
+    if (version != TXN_NIL && store->versions[version].deleted) {
+        return TXN_NIL;
+    }
+    return version;
+}
+
+/**
+ * \brief           Lấy một phiên bản trống (gọi khi giữ commit_lock)
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \return          Chỉ số phiên bản, \ref TXN_NIL nếu hết
+ */
+static uint32_t
+txn_version_alloc(txn_store_t* store) {
+    uint32_t version;
+
+    version = store->free_head;
+    if (version != TXN_NIL) {
+        store->free_head = atomic_load_explicit(&store->versions[version].older, memory_order_relaxed);
+        store->free_count--;
+    }
+    return version;
+}
+
+/**
+ * \brief           Trả một phiên bản về danh sách trống (gọi khi giữ commit_lock)
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in]       version: Chỉ số phiên bản
+ */
+static void
+txn_version_free(txn_store_t* store, uint32_t version) {
+    atomic_store_explicit(&store->versions[version].older, store->free_head, memory_order_relaxed);
+    store->free_head = version;
+    store->free_count++;
+}
+
+/**
+ * \brief           Chép bản ghi người dùng (kể cả danh sách mượn) sang ảnh
+ * \param[out]      image: Ảnh nhận dữ liệu
+ * \param[in]       users: Danh sách chứa người dùng
+ * \param[in]       user: Người dùng
+ */
+static void
+txn_user_from_live(txn_user_t* image, const user_list_t* users, const user_t* user) {
+    image->user_id = user->user_id;
+    strncpy(image->name, user->name, MAX_NAME_LENGTH - 1);
+    image->name[MAX_NAME_LENGTH - 1] = '\0';
+    image->tier = user->tier;
+    image->loan_count = (uint16_t)user->borrowed_count;
+    memcpy(image->loans, user_borrowed_items(users, user), user->borrowed_count * sizeof(image->loans[0]));
+}
+
+/**
+ * \brief           Thời điểm snapshot cũ nhất còn mở
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \return          Thời điểm nhỏ nhất (bằng clock nếu không có snapshot nào)
+ */
+static uint64_t
+txn_oldest_snapshot(txn_store_t* store) {
+    uint64_t oldest;
+    uint64_t ts;
+    size_t i;
+
+    oldest = atomic_load(&store->clock);
+    for (i = 0; i < TXN_MAX_SNAPSHOTS; i++) {
+        ts = atomic_load(&store->snapshots[i]);
+        if (ts != 0 && ts < oldest) {
+            oldest = ts;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * \brief           Kiểm tra còn snapshot nào đang mở
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \return          1 nếu có ít nhất một snapshot, 0 nếu không
+ */
+static uint8_t
+txn_any_snapshot(txn_store_t* store) {
+    size_t i;
+
+    for (i = 0; i < TXN_MAX_SNAPSHOTS; i++) {
+        if (atomic_load(&store->snapshots[i]) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           Bỏ ô của bản ghi đã xóa mà không snapshot nào còn thấy (gọi khi giữ commit_lock)
+ *
+ * Người đọc đã lấy ô trước đó vẫn có thể đang giữ head nên phiên bản xóa chỉ
+ * được trả về pool ngay nếu không có snapshot nào mở (snapshot mở sau sẽ đọc
+ * thấy ô bỏ); nếu không, nó chờ tới khi snapshot cũ nhất không nhỏ hơn
+ * retired, là thời điểm commit kế tiếp.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in,out]   entry: Ô cần bỏ
+ * \return          Số phiên bản được thu hồi
+ */
+static size_t
+txn_retire_entry(txn_store_t* store, txn_entry_t* entry) {
+    uint32_t version;
+
+    atomic_store(&entry->id, TXN_TOMBSTONE);
+    if (!txn_any_snapshot(store)) {
+        version = atomic_exchange(&entry->head, TXN_NIL);
+        txn_version_free(store, version);
+        return 1;
+    }
+
+    if (store->pending_ts == 0) {
+        store->pending_ts = atomic_load_explicit(&store->clock, memory_order_relaxed) + 1;
+    }
+    entry->retired = store->pending_ts;
+    return 0;
+}
+
+/**
+ * \brief           Thu hồi các phiên bản không snapshot nào còn thấy (gọi khi giữ commit_lock)
+ *
+ * Với mỗi bản ghi, giữ lại phiên bản mới nhất có commit_ts không lớn hơn
+ * snapshot cũ nhất và cắt toàn bộ phần cũ hơn. Mọi người đọc đều dừng ở
+ * phiên bản được giữ lại hoặc sớm hơn nên không chạm tới phần bị cắt. Nếu
+ * phần còn lại chỉ là một phiên bản xóa thì ô của bản ghi bị bỏ
+ * (\ref txn_retire_entry); ô bỏ đã thu hồi xong đứng ngay trước ô trống thì trở
+ * về trống để dãy dò ngắn lại.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \return          Số phiên bản được thu hồi
+ */
+static size_t
+txn_gc_locked(txn_store_t* store) {
+    txn_entry_t* table;
+    uint64_t oldest;
+    uint32_t version;
+    uint32_t next;
+    uint32_t id;
+    size_t* slots;
+    size_t size;
+    size_t freed;
+    size_t index;
+    size_t i;
+    uint8_t quiet;
+    int kind;
+
+    oldest = txn_oldest_snapshot(store);
+    quiet = !txn_any_snapshot(store);
+    freed = 0;
+    for (kind = TXN_RECORD_BOOK; kind <= TXN_RECORD_USER; kind++) {
+        table = txn_table(store, (txn_record_t)kind, &size);
+        slots = txn_table_slots(store, (txn_record_t)kind);
+        for (i = 0; i < size; i++) {
+            id = atomic_load_explicit(&table[i].id, memory_order_relaxed);
+            if (id == 0) {
+                continue;
+            }
+
+            /* Ô bỏ: trả phiên bản xóa khi không còn snapshot nào có thể đang đọc nó (hoặc không snapshot nào mở) */
+            if (id == TXN_TOMBSTONE) {
+                version = atomic_load_explicit(&table[i].head, memory_order_relaxed);
+                if (version != TXN_NIL && (quiet || table[i].retired <= oldest)) {
+                    atomic_store(&table[i].head, TXN_NIL);
+                    txn_version_free(store, version);
+                    freed++;
+                }
+                continue;
+            }
+
+            version = atomic_load_explicit(&table[i].head, memory_order_relaxed);
+            while (version != TXN_NIL && store->versions[version].commit_ts > oldest) {
+                version = atomic_load_explicit(&store->versions[version].older, memory_order_relaxed);
+            }
+            if (version == TXN_NIL) {
+                continue;
+            }
+
+            next = atomic_exchange_explicit(&store->versions[version].older, TXN_NIL, memory_order_release);
+            while (next != TXN_NIL) {
+                version = next;
+                next = atomic_load_explicit(&store->versions[version].older, memory_order_relaxed);
+                txn_version_free(store, version);
+                freed++;
+            }
+
+            version = atomic_load_explicit(&table[i].head, memory_order_relaxed);
+            if (store->versions[version].deleted
+                && atomic_load_explicit(&store->versions[version].older, memory_order_relaxed) == TXN_NIL
+                && store->versions[version].commit_ts <= oldest) {
+                freed += txn_retire_entry(store, &table[i]);
+            }
+        }
+
+        /* Ô bỏ đã thu hồi xong ngay trước ô trống không nối dãy dò nào nữa */
+        for (i = 0; i < size; i++) {
+            index = i;
+            while (atomic_load_explicit(&table[(index + 1) % size].id, memory_order_relaxed) == 0
+                   && atomic_load_explicit(&table[index].id, memory_order_relaxed) == TXN_TOMBSTONE
+                   && atomic_load_explicit(&table[index].head, memory_order_relaxed) == TXN_NIL) {
+                atomic_store(&table[index].id, 0);
+                (*slots)--;
+                index = (index + size - 1) % size;
+            }
+        }
+    }
+    return freed;
+}
+
+/**
+ * \brief           Tìm hoặc tạo ô bảng băm cho bản ghi (gọi khi giữ commit_lock)
+ *
+ * Ô mới có head rỗng nên người đọc đồng thời coi như bản ghi chưa tồn tại.
+ * Khi bảng đã tới ngưỡng, chạy GC để thu hồi ô của các bản ghi đã xóa rồi thử
+ * lại; nếu snapshot đang mở còn giữ các ô đó thì nhường CPU cho người đọc
+ * (tối đa \ref TXN_RECLAIM_RETRIES lần) trước khi bỏ cuộc.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          Con trỏ tới ô, NULL nếu bảng đã đầy
+ */
+static txn_entry_t*
+txn_lookup_or_insert(txn_store_t* store, txn_record_t kind, uint32_t id) {
+    txn_entry_t* entry;
+    size_t n;
+
+    entry = txn_probe_insert(store, kind, id);
+    for (n = 0; entry == NULL && n < TXN_RECLAIM_RETRIES; n++) {
+        if (n > 0) {
+            sched_yield();
+        }
+        txn_gc_locked(store);
+        entry = txn_probe_insert(store, kind, id);
+    }
+    return entry;
+}
+
+/**
+ * \brief           Phiên bản mới nhất của bản ghi, kể cả phiên bản chưa công bố (gọi khi giữ commit_lock)
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          Chỉ số phiên bản, \ref TXN_NIL nếu bản ghi chưa từng có trong kho
+ */
+static uint32_t
+txn_head(txn_store_t* store, txn_record_t kind, uint32_t id) {
+    txn_entry_t* entry;
+
+    entry = txn_lookup(store, kind, id);
+    return (entry != NULL) ? atomic_load_explicit(&entry->head, memory_order_relaxed) : TXN_NIL;
+}
+
+/**
+ * \brief           So sánh phiên bản mới nhất của bản ghi với bản ghi sống (gọi khi giữ commit_lock)
+ *
+ * Sách so theo các trường thuộc phạm vi giao dịch (không so hàng đợi đặt
+ * giữ), người dùng so cả danh sách khóa item đang mượn.
+ *
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          1 nếu kho đã phản ánh đúng bản ghi sống, 0 nếu lệch
+ */
+static uint8_t
+txn_head_matches_live(txn_store_t* store, txn_record_t kind, uint32_t id) {
+    const book_t* image_book;
+    const txn_user_t* image_user;
+    const book_t* live_book;
+    const user_t* live_user;
+    uint32_t head;
+
+    head = txn_head(store, kind, id);
+    if (head != TXN_NIL && store->versions[head].deleted) {
+        head = TXN_NIL;
+    }
+
+    if (kind == TXN_RECORD_BOOK) {
+        live_book = book_find_by_id(store->library->books, id);
+        if (head == TXN_NIL || live_book == NULL) {
+            return (head == TXN_NIL && live_book == NULL) ? 1 : 0;
+        }
+        image_book = &store->versions[head].image.book;
+        return (image_book->copy_count == live_book->copy_count
+                && image_book->available_mask == live_book->available_mask
+                && image_book->isbn == live_book->isbn
+                && strcmp(image_book->title, live_book->title) == 0
+                && strcmp(image_book->author, live_book->author) == 0) ? 1 : 0;
+    }
+
+    live_user = user_find_by_id(store->library->users, id);
+    if (head == TXN_NIL || live_user == NULL) {
+        return (head == TXN_NIL && live_user == NULL) ? 1 : 0;
+    }
+    image_user = &store->versions[head].image.user;
+    return (image_user->tier == live_user->tier
+            && image_user->loan_count == live_user->borrowed_count
+            && strcmp(image_user->name, live_user->name) == 0
+            && memcmp(image_user->loans, user_borrowed_items(store->library->users, live_user),
+                      image_user->loan_count * sizeof(image_user->loans[0])) == 0) ? 1 : 0;
+}
+
+/**
+ * \brief           Cài một phiên bản mới lên đầu chuỗi tại thời điểm commit đang chờ (gọi khi giữ commit_lock)
+ *
+ * Mọi phiên bản cài trong cùng một lần giữ khóa dùng chung commit_ts = clock + 1
+ * và chỉ hiện ra khi \ref txn_unlock nhả khóa ngoài cùng. Nếu đầu chuỗi đã là
+ * phiên bản chờ đó thì ghi đè tại chỗ: chưa snapshot nào có thể đọc nó.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \param[in]       image: Ảnh mới, NULL = phiên bản xóa
+ * \return          1 nếu thành công, 0 nếu hết phiên bản hoặc bảng băm đầy
+ */
+static uint8_t
+txn_install_locked(txn_store_t* store, txn_record_t kind, uint32_t id, const txn_image_t* image) {
+    txn_version_t* node;
+    txn_entry_t* entry;
+    uint32_t head;
+    uint32_t version;
+    size_t n;
+
+    entry = txn_lookup_or_insert(store, kind, id);
+    if (entry == NULL) {
+        return 0;
+    }
+    if (store->pending_ts == 0) {
+        store->pending_ts = atomic_load_explicit(&store->clock, memory_order_relaxed) + 1;
+    }
+
+    head = atomic_load_explicit(&entry->head, memory_order_relaxed);
+    if (head != TXN_NIL && store->versions[head].commit_ts == store->pending_ts) {
+        node = &store->versions[head];
+        node->deleted = (image == NULL) ? 1 : 0;
+        if (image != NULL) {
+            node->image = *image;
+        }
+        return 1;
+    }
+
+    version = txn_version_alloc(store);
+    if (version == TXN_NIL) {
+        /* GC có thể bỏ ô của bản ghi đang được thêm lại nên tìm lại ô sau đó */
+        for (n = 0; version == TXN_NIL && n < TXN_RECLAIM_RETRIES; n++) {
+            if (n > 0) {
+                sched_yield();
+            }
+            txn_gc_locked(store);
+            version = txn_version_alloc(store);
+        }
+        if (version == TXN_NIL) {
+            return 0;
+        }
+        entry = txn_lookup_or_insert(store, kind, id);
+        if (entry == NULL) {
+            txn_version_free(store, version);
+            return 0;
+        }
+        head = atomic_load_explicit(&entry->head, memory_order_relaxed);
+    }
+    node = &store->versions[version];
+    node->commit_ts = store->pending_ts;
+    node->deleted = (image == NULL) ? 1 : 0;
+    if (image != NULL) {
+        node->image = *image;
+    }
+    atomic_store_explicit(&node->older, head, memory_order_relaxed);
+    atomic_store_explicit(&entry->head, version, memory_order_release);
+    return 1;
+}
+
+/**
+ * \brief           Công bố trạng thái sống của một bản ghi nếu kho đang lệch (gọi khi giữ commit_lock)
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ */
+static void
+txn_publish_locked(txn_store_t* store, txn_record_t kind, uint32_t id) {
+    txn_image_t image;
+    const book_t* book;
+    const user_t* user;
+    uint8_t installed;
+
+    if (txn_head_matches_live(store, kind, id)) {
+        return;
+    }
+
+    if (kind == TXN_RECORD_BOOK) {
+        book = book_find_by_id(store->library->books, id);
+        if (book != NULL) {
+            image.book = *book;
+            hold_queue_init(&image.book.holds);
+        }
+        installed = txn_install_locked(store, kind, id, (book != NULL) ? &image : NULL);
+    } else {
+        user = user_find_by_id(store->library->users, id);
+        if (user != NULL) {
+            txn_user_from_live(&image.user, store->library->users, user);
+        }
+        installed = txn_install_locked(store, kind, id, (user != NULL) ? &image : NULL);
+    }
+    if (!installed) {
+        store->lost++;
+        store->stale = 1;
+    }
+}
+
+/**
+ * \brief           Công bố lại mọi bản ghi lệch giữa kho và thư viện (gọi khi giữ commit_lock)
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ */
+static void
+txn_sync_locked(txn_store_t* store) {
+    uint32_t id;
+    size_t i;
+
+    store->stale = 0;
+    for (i = 0; i < store->library->books->count; i++) {
+        txn_publish_locked(store, TXN_RECORD_BOOK, store->library->books->books[i].book_id);
+    }
+    for (i = 0; i < store->library->users->count; i++) {
+        txn_publish_locked(store, TXN_RECORD_USER, store->library->users->users[i].user_id);
+    }
+    for (i = 0; i < TXN_BOOK_TABLE_SIZE; i++) {
+        id = atomic_load_explicit(&store->books[i].id, memory_order_relaxed);
+        if (id != 0 && id != TXN_TOMBSTONE) {
+            txn_publish_locked(store, TXN_RECORD_BOOK, id);
+        }
+    }
+    for (i = 0; i < TXN_USER_TABLE_SIZE; i++) {
+        id = atomic_load_explicit(&store->users[i].id, memory_order_relaxed);
+        if (id != 0 && id != TXN_TOMBSTONE) {
+            txn_publish_locked(store, TXN_RECORD_USER, id);
+        }
+    }
+}
+
+/**
+ * \brief           Nhả khóa ghi; lần nhả ngoài cùng công bố các phiên bản đang chờ
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[in]       resync: 1 để đồng bộ lại kho nếu có thay đổi chưa công bố được
+ */
+static void
+txn_release(txn_store_t* store, uint8_t resync) {
+    if (resync && store->lock_depth == 1 && store->stale) {
+        txn_sync_locked(store);
+    }
+    if (--store->lock_depth == 0 && store->pending_ts != 0) {
+        atomic_store(&store->clock, store->pending_ts);
+        store->pending_ts = 0;
+    }
+    pthread_mutex_unlock(&store->commit_lock);
+}
+
+/**
+ * \brief           Observer sách: công bố thay đổi rồi chuyển tiếp cho observer cũ
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       book: Sách vừa thay đổi (bản ghi ngay trước khi xóa với \ref BOOK_EVENT_DELETED)
+ * \param[in,out]   ctx: Kho phiên bản
+ */
+static void
+txn_book_observer(book_event_t event, const book_t* book, void* ctx) {
+    txn_store_t* store;
+
+    store = (txn_store_t*)ctx;
+    txn_lock(store);
+    if (!store->applying) {
+        if (event == BOOK_EVENT_DELETED) {
+            if (!txn_install_locked(store, TXN_RECORD_BOOK, book->book_id, NULL)) {
+                store->lost++;
+                store->stale = 1;
+            }
+        } else {
+            txn_publish_locked(store, TXN_RECORD_BOOK, book->book_id);
+        }
+    }
+    /* Bản ghi bị xóa còn trong danh sách tới khi observer trả về: chưa đồng bộ lại lúc này */
+    txn_release(store, event != BOOK_EVENT_DELETED);
+
+    if (store->book_next != NULL) {
+        store->book_next(event, book, store->book_next_ctx);
+    }
+}
+
+/**
+ * \brief           Observer người dùng: công bố thay đổi rồi chuyển tiếp cho observer cũ
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       user: Người dùng vừa thay đổi (bản ghi ngay trước khi xóa với \ref USER_EVENT_DELETED)
+ * \param[in,out]   ctx: Kho phiên bản
+ */
+static void
+txn_user_observer(user_event_t event, const user_t* user, void* ctx) {
+    txn_store_t* store;
+
+    store = (txn_store_t*)ctx;
+    txn_lock(store);
+    if (!store->applying) {
+        if (event == USER_EVENT_DELETED) {
+            if (!txn_install_locked(store, TXN_RECORD_USER, user->user_id, NULL)) {
+                store->lost++;
+                store->stale = 1;
+            }
+        } else {
+            txn_publish_locked(store, TXN_RECORD_USER, user->user_id);
+        }
+    }
+    /* Bản ghi bị xóa còn trong danh sách tới khi observer trả về: chưa đồng bộ lại lúc này */
+    txn_release(store, event != USER_EVENT_DELETED);
+
+    if (store->user_next != NULL) {
+        store->user_next(event, user, store->user_next_ctx);
+    }
+}
+
+/**
+ * \brief           Khởi tạo kho phiên bản từ trạng thái hiện tại của thư viện và gắn vào thư viện
+ *
+ * Kho đăng ký observer của danh sách sách và người dùng (observer đang có,
+ * ví dụ của \ref cdc_attach, vẫn được gọi tiếp) nên mọi thay đổi sau đó đều
+ * thành phiên bản mới. Kho sống cùng thư viện: chỉ khởi tạo một lần, gọi
+ * \ref txn_store_destroy trước khi bỏ thư viện.
+ *
+ * \param[out]      store: Con trỏ tới kho phiên bản
+ * \param[in,out]   library: Thư viện nhận thay đổi khi commit
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_store_init(txn_store_t* store, library_t* library) {
+    pthread_mutexattr_t attr;
+    txn_entry_t* entry;
+    uint32_t version;
+    size_t i;
+
+    if (store == NULL || library == NULL || library->books == NULL || library->users == NULL) {
+        return TXN_INVALID_INPUT;
+    }
+
+    store->library = library;
+    store->lock_depth = 0;
+    store->pending_ts = 0;
+    store->applying = 0;
+    store->stale = 0;
+    atomic_init(&store->clock, 1);
+    for (i = 0; i < TXN_MAX_SNAPSHOTS; i++) {
+        atomic_init(&store->snapshots[i], 0);
+    }
+    for (i = 0; i < TXN_BOOK_TABLE_SIZE; i++) {
+        atomic_init(&store->books[i].id, 0);
+        atomic_init(&store->books[i].head, TXN_NIL);
+        store->books[i].retired = 0;
+    }
+    for (i = 0; i < TXN_USER_TABLE_SIZE; i++) {
+        atomic_init(&store->users[i].id, 0);
+        atomic_init(&store->users[i].head, TXN_NIL);
+        store->users[i].retired = 0;
+    }
+    for (i = 0; i < TXN_MAX_VERSIONS; i++) {
+        atomic_init(&store->versions[i].older, (i + 1 < TXN_MAX_VERSIONS) ? (uint32_t)(i + 1) : TXN_NIL);
+    }
+    store->free_head = 0;
+    store->free_count = TXN_MAX_VERSIONS;
+    store->book_slots = 0;
+    store->user_slots = 0;
+    store->commits = 0;
+    store->conflicts = 0;
+    store->lost = 0;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&store->commit_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    /* Phiên bản đầu tiên của mọi bản ghi có commit_ts = 1 */
+    for (i = 0; i < library->books->count; i++) {
+        entry = txn_lookup_or_insert(store, TXN_RECORD_BOOK, library->books->books[i].book_id);
+        version = txn_version_alloc(store);
+        store->versions[version].commit_ts = 1;
+        store->versions[version].deleted = 0;
+        store->versions[version].image.book = library->books->books[i];
+        atomic_store_explicit(&store->versions[version].older, TXN_NIL, memory_order_relaxed);
+        atomic_store_explicit(&entry->head, version, memory_order_release);
+    }
+    for (i = 0; i < library->users->count; i++) {
+        entry = txn_lookup_or_insert(store, TXN_RECORD_USER, library->users->users[i].user_id);
+        version = txn_version_alloc(store);
+        store->versions[version].commit_ts = 1;
+        store->versions[version].deleted = 0;
+        txn_user_from_live(&store->versions[version].image.user, library->users, &library->users->users[i]);
+        atomic_store_explicit(&store->versions[version].older, TXN_NIL, memory_order_relaxed);
+        atomic_store_explicit(&entry->head, version, memory_order_release);
+    }
+
+    /* Nhận mọi thay đổi về sau */
+    store->book_next = library->books->observer;
+    store->book_next_ctx = library->books->observer_ctx;
+    store->user_next = library->users->observer;
+    store->user_next_ctx = library->users->observer_ctx;
+    book_set_observer(library->books, txn_book_observer, store);
+    user_set_observer(library->users, txn_user_observer, store);
+    library->txn = store;
+
+    return TXN_OK;
+}
+
+/**
+ * \brief           Tách kho khỏi thư viện và giải phóng tài nguyên đồng bộ (không còn giao dịch nào mở)
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ */
+void
+txn_store_destroy(txn_store_t* store) {
+    if (store == NULL) {
+        return;
+    }
+
+    book_set_observer(store->library->books, store->book_next, store->book_next_ctx);
+    user_set_observer(store->library->users, store->user_next, store->user_next_ctx);
+    if (store->library->txn == store) {
+        store->library->txn = NULL;
+    }
+    pthread_mutex_destroy(&store->commit_lock);
+}
+
+/**
+ * \brief           Thu hồi các phiên bản cũ không còn snapshot nào thấy
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \return          Số phiên bản được thu hồi
+ */
+size_t
+txn_gc(txn_store_t* store) {
+    size_t freed;
+
+    if (store == NULL) {
+        return 0;
+    }
+
+    txn_lock(store);
+    freed = txn_gc_locked(store);
+    txn_unlock(store);
+    return freed;
+}
+
+/**
+ * \brief           Đồng bộ lại toàn bộ kho với thư viện
+ *
+ * Dùng sau các thao tác thay thế cả danh sách mà không báo observer (ví dụ
+ * nạp snapshot): bản ghi sống lệch với kho được công bố lại, bản ghi không
+ * còn trong thư viện nhận phiên bản xóa.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản (NULL = bỏ qua)
+ */
+void
+txn_sync(txn_store_t* store) {
+    if (store == NULL) {
+        return;
+    }
+
+    txn_lock(store);
+    txn_sync_locked(store);
+    txn_unlock(store);
+}
+
+/**
+ * \brief           Giữ khóa ghi của kho (có thể lồng nhau trong cùng luồng)
+ *
+ * Các hàm mgmt_* giữ khóa trong suốt thao tác nên commit của giao dịch không
+ * thể chen vào giữa và mọi thay đổi của thao tác hiện ra cùng một thời điểm.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản (NULL = bỏ qua)
+ */
+void
+txn_lock(txn_store_t* store) {
+    if (store == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&store->commit_lock);
+    store->lock_depth++;
+}
+
+/**
+ * \brief           Nhả khóa ghi; lần nhả ngoài cùng công bố các phiên bản đang chờ
+ *
+ * Nếu trước đó có thay đổi không công bố được (hết phiên bản vì snapshot cũ
+ * còn mở), kho được đồng bộ lại với thư viện trước khi công bố để người đọc
+ * không thấy mãi một bản ghi cũ.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản (NULL = bỏ qua)
+ */
+void
+txn_unlock(txn_store_t* store) {
+    if (store != NULL) {
+        txn_release(store, 1);
+    }
+}
+
+/**
+ * \brief           Công bố trạng thái hiện tại của một người dùng
+ *
+ * Danh sách người dùng không báo observer khi danh sách mượn thay đổi nên nơi
+ * mượn/trả gọi hàm này ngay sau khi sửa thẻ.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản (NULL = bỏ qua)
+ * \param[in]       user_id: ID người dùng
+ */
+void
+txn_publish_user(txn_store_t* store, uint32_t user_id) {
+    if (store == NULL) {
+        return;
+    }
+
+    txn_lock(store);
+    txn_publish_locked(store, TXN_RECORD_USER, user_id);
+    txn_unlock(store);
+}
+
+/**
+ * \brief           Đăng ký snapshot tại thời điểm commit mới nhất
+ *
+ * Sau khi ghi vào ô, đọc lại clock và cập nhật tới khi hai giá trị trùng nhau,
+ * nhờ vậy GC (đọc clock trước rồi mới quét các ô) không bao giờ thu hồi phiên
+ * bản mà snapshot vừa đăng ký cần.
+ *
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[out]      slot: Ô đăng ký snapshot
+ * \param[out]      start_ts: Thời điểm snapshot
+ * \return          \ref TXN_OK nếu thành công, \ref TXN_FULL nếu hết ô
+ */
+static txn_status_t
+txn_snapshot_acquire(txn_store_t* store, uint32_t* slot, uint64_t* start_ts) {
+    uint64_t expected;
+    uint64_t ts;
+    uint64_t now;
+    uint32_t i;
+
+    for (i = 0; i < TXN_MAX_SNAPSHOTS; i++) {
+        expected = 0;
+        ts = atomic_load(&store->clock);
+        if (!atomic_compare_exchange_strong(&store->snapshots[i], &expected, ts)) {
+            continue;
+        }
+        while ((now = atomic_load(&store->clock)) != ts) {
+            ts = now;
+            atomic_store(&store->snapshots[i], ts);
+        }
+        *slot = i;
+        *start_ts = ts;
+        return TXN_OK;
+    }
+    return TXN_FULL;
+}
+
+/**
+ * \brief           Kết thúc giao dịch: bỏ đăng ký snapshot và xóa write set
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ */
+static void
+txn_finish(txn_t* txn) {
+    atomic_store(&txn->store->snapshots[txn->snapshot_slot], 0);
+    txn->active = 0;
+    txn->write_count = 0;
+}
+
+/**
+ * \brief           Bắt đầu giao dịch trên snapshot mới nhất
+ * \param[in,out]   store: Con trỏ tới kho phiên bản
+ * \param[out]      txn: Giao dịch được khởi tạo
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_begin(txn_store_t* store, txn_t* txn) {
+    txn_status_t status;
+
+    if (store == NULL || txn == NULL) {
+        return TXN_INVALID_INPUT;
+    }
+
+    txn->store = store;
+    txn->write_count = 0;
+    txn->active = 0;
+    status = txn_snapshot_acquire(store, &txn->snapshot_slot, &txn->start_ts);
+    if (status == TXN_OK) {
+        txn->active = 1;
+    }
+    return status;
+}
+
+/**
+ * \brief           Hủy giao dịch, bỏ mọi thay đổi trong write set
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ */
+void
+txn_abort(txn_t* txn) {
+    if (txn != NULL && txn->active) {
+        txn_finish(txn);
+    }
+}
+
+/**
+ * \brief           Tìm bản ghi trong write set
+ * \param[in]       txn: Con trỏ tới giao dịch
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          Con trỏ tới bản ghi trong write set, NULL nếu chưa ghi
+ */
+static const txn_write_t*
+txn_find_write(const txn_t* txn, txn_record_t kind, uint32_t id) {
+    size_t i;
+
+    for (i = 0; i < txn->write_count; i++) {
+        if (txn->writes[i].kind == kind && txn->writes[i].id == id) {
+            return &txn->writes[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief           Lấy bản ghi trong write set, thêm mới (rỗng) nếu chưa có
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \return          Con trỏ tới bản ghi, NULL nếu write set đã đầy
+ */
+static txn_write_t*
+txn_write_slot(txn_t* txn, txn_record_t kind, uint32_t id) {
+    txn_write_t* write;
+
+    write = (txn_write_t*)txn_find_write(txn, kind, id);
+    if (write != NULL) {
+        return write;
+    }
+    if (txn->write_count >= TXN_MAX_WRITES) {
+        return NULL;
+    }
+
+    write = &txn->writes[txn->write_count++];
+    write->kind = kind;
+    write->id = id;
+    write->deleted = 0;
+    return write;
+}
+
+/**
+ * \brief           Đưa bản ghi đang thấy vào write set để sửa
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       kind: Loại bản ghi
+ * \param[in]       id: ID bản ghi
+ * \param[out]      status: Lý do thất bại
+ * \return          Con trỏ tới bản ghi trong write set, NULL nếu lỗi
+ */
+static txn_write_t*
+txn_stage(txn_t* txn, txn_record_t kind, uint32_t id, txn_status_t* status) {
+    const txn_write_t* existing;
+    txn_write_t* write;
+    uint32_t version;
+
+    existing = txn_find_write(txn, kind, id);
+    if (existing != NULL) {
+        if (existing->deleted) {
+            *status = TXN_NOT_FOUND;
+            return NULL;
+        }
+        return (txn_write_t*)existing;
+    }
+
+    version = txn_visible(txn->store, kind, id, txn->start_ts);
+    if (version == TXN_NIL) {
+        *status = TXN_NOT_FOUND;
+        return NULL;
+    }
+
+    write = txn_write_slot(txn, kind, id);
+    if (write == NULL) {
+        *status = TXN_FULL;
+        return NULL;
+    }
+    if (kind == TXN_RECORD_BOOK) {
+        write->image.book = txn->store->versions[version].image.book;
+    } else {
+        write->image.user = txn->store->versions[version].image.user;
+    }
+    return write;
+}
+
+/**
+ * \brief           Đọc sách theo snapshot của giao dịch
+ * \param[in]       txn: Con trỏ tới giao dịch
+ * \param[in]       book_id: ID sách
+ * \return          Ảnh sách (hợp lệ tới khi giao dịch kết thúc), NULL nếu không tồn tại
+ */
+const book_t*
+txn_read_book(const txn_t* txn, uint32_t book_id) {
+    const txn_write_t* write;
+    uint32_t version;
+
+    if (txn == NULL || !txn->active) {
+        return NULL;
+    }
+
+    write = txn_find_write(txn, TXN_RECORD_BOOK, book_id);
+    if (write != NULL) {
+        return write->deleted ? NULL : &write->image.book;
+    }
+
+    version = txn_visible(txn->store, TXN_RECORD_BOOK, book_id, txn->start_ts);
+    return (version == TXN_NIL) ? NULL : &txn->store->versions[version].image.book;
+}
+
+/**
+ * \brief           Đọc người dùng theo snapshot của giao dịch
+ * \param[in]       txn: Con trỏ tới giao dịch
+ * \param[in]       user_id: ID người dùng
+ * \return          Ảnh người dùng (hợp lệ tới khi giao dịch kết thúc), NULL nếu không tồn tại
+ */
+const txn_user_t*
+txn_read_user(const txn_t* txn, uint32_t user_id) {
+    const txn_write_t* write;
+    uint32_t version;
+
+    if (txn == NULL || !txn->active) {
+        return NULL;
+    }
+
+    write = txn_find_write(txn, TXN_RECORD_USER, user_id);
+    if (write != NULL) {
+        return write->deleted ? NULL : &write->image.user;
+    }
+
+    version = txn_visible(txn->store, TXN_RECORD_USER, user_id, txn->start_ts);
+    return (version == TXN_NIL) ? NULL : &txn->store->versions[version].image.user;
+}
+
+/**
+ * \brief           Duyệt mọi sách mà giao dịch nhìn thấy (không theo thứ tự ID)
+ *
+ * Dùng cho báo cáo dài: không giữ khóa nào nên không chặn các giao dịch ghi,
+ * và mọi sách đều lấy từ cùng một snapshot.
+ *
+ * \param[in]       txn: Con trỏ tới giao dịch
+ * \param[in]       visit: Hàm nhận từng sách (NULL = chỉ đếm)
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p visit
+ * \return          Số sách đã duyệt
+ */
+size_t
+txn_foreach_book(const txn_t* txn, book_visit_fn visit, void* ctx) {
+    const book_t* book;
+    uint32_t id;
+    size_t count;
+    size_t i;
+
+    if (txn == NULL || !txn->active) {
+        return 0;
+    }
+
+    count = 0;
+    for (i = 0; i < TXN_BOOK_TABLE_SIZE; i++) {
+        id = atomic_load_explicit(&txn->store->books[i].id, memory_order_acquire);
+        if (id == 0 || id == TXN_TOMBSTONE
+            || txn_visible(txn->store, TXN_RECORD_BOOK, id, txn->start_ts) == TXN_NIL) {
+            continue;
+        }
+        book = txn_read_book(txn, id);
+        if (book == NULL) {
+            continue;
+        }
+        count++;
+        if (visit != NULL && !visit(book, ctx)) {
+            return count;
+        }
+    }
+
+    /* Sách do chính giao dịch thêm mới */
+    for (i = 0; i < txn->write_count; i++) {
+        if (txn->writes[i].kind != TXN_RECORD_BOOK || txn->writes[i].deleted
+            || txn_visible(txn->store, TXN_RECORD_BOOK, txn->writes[i].id, txn->start_ts) != TXN_NIL) {
+            continue;
+        }
+        count++;
+        if (visit != NULL && !visit(&txn->writes[i].image.book, ctx)) {
+            return count;
+        }
+    }
+    return count;
+}
+
+/**
+ * \brief           Đếm sách, bản sao và người dùng trên một snapshot
+ *
+ * Không giữ khóa ghi nên không chặn mượn/trả, và mọi con số đều lấy từ cùng
+ * một thời điểm: một lượt mượn không thể được tính vào bản đang mượn mà chưa
+ * bị trừ khỏi bản có sẵn.
+ *
+ * \param[in]       store: Con trỏ tới kho phiên bản
+ * \param[out]      counts: Kết quả đếm sách
+ * \param[out]      users: Số người dùng
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_read_counts(txn_store_t* store, scan_counts_t* counts, size_t* users) {
+    const book_t* book;
+    txn_status_t status;
+    uint64_t ts;
+    uint32_t slot;
+    uint32_t version;
+    uint32_t id;
+    size_t i;
+
+    if (store == NULL || counts == NULL || users == NULL) {
+        return TXN_INVALID_INPUT;
+    }
+
+    status = txn_snapshot_acquire(store, &slot, &ts);
+    if (status != TXN_OK) {
+        return status;
+    }
+
+    memset(counts, 0, sizeof(*counts));
+    for (i = 0; i < TXN_BOOK_TABLE_SIZE; i++) {
+        id = atomic_load_explicit(&store->books[i].id, memory_order_acquire);
+        version = (id != 0 && id != TXN_TOMBSTONE) ? txn_visible(store, TXN_RECORD_BOOK, id, ts) : TXN_NIL;
+        if (version == TXN_NIL) {
+            continue;
+        }
+        book = &store->versions[version].image.book;
+        counts->titles++;
+        counts->copies += book->copy_count;
+        counts->available += book->available_count;
+    }
+    counts->borrowed = counts->copies - counts->available;
+
+    *users = 0;
+    for (i = 0; i < TXN_USER_TABLE_SIZE; i++) {
+        id = atomic_load_explicit(&store->users[i].id, memory_order_acquire);
+        if (id != 0 && id != TXN_TOMBSTONE && txn_visible(store, TXN_RECORD_USER, id, ts) != TXN_NIL) {
+            (*users)++;
+        }
+    }
+
+    atomic_store(&store->snapshots[slot], 0);
+    return TXN_OK;
+}
+
+/**
+ * \brief           Cập nhật số bản có sẵn và cờ mượn từ bitmap của ảnh sách
+ * \param[in,out]   book: Ảnh sách
+ */
+static void
+txn_book_sync(book_t* book) {
+    book->available_count = (uint8_t)__builtin_popcountll(book->available_mask);
+    book->is_borrowed = (book->available_count == 0) ? 1 : 0;
+}
+
+/**
+ * \brief           Thêm mới hoặc ghi đè toàn bộ một sách
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       book: Ảnh sách mới (trường holds bị bỏ qua)
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_put_book(txn_t* txn, const book_t* book) {
+    txn_write_t* write;
+    uint64_t copies;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+    if (book == NULL || !is_valid_id(book->book_id) || is_string_empty(book->title)
+        || is_string_empty(book->author) || book->copy_count == 0 || book->copy_count > MAX_COPIES_PER_BOOK) {
+        return TXN_INVALID_INPUT;
+    }
+    copies = (book->copy_count >= 64) ? UINT64_MAX : (((uint64_t)1 << book->copy_count) - 1);
+    if (book->available_mask & ~copies) {
+        return TXN_INVALID_INPUT;
+    }
+
+    write = txn_write_slot(txn, TXN_RECORD_BOOK, book->book_id);
+    if (write == NULL) {
+        return TXN_FULL;
+    }
+    write->deleted = 0;
+    write->image.book = *book;
+    hold_queue_init(&write->image.book.holds);
+    txn_book_sync(&write->image.book);
+    return TXN_OK;
+}
+
+/**
+ * \brief           Đổi tiêu đề và tác giả của sách (biên mục lại)
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       book_id: ID sách
+ * \param[in]       title: Tiêu đề mới
+ * \param[in]       author: Tác giả mới
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_update_book(txn_t* txn, uint32_t book_id, const char* title, const char* author) {
+    txn_write_t* write;
+    txn_status_t status;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+    if (title == NULL || author == NULL || is_string_empty(title) || is_string_empty(author)) {
+        return TXN_INVALID_INPUT;
+    }
+
+    write = txn_stage(txn, TXN_RECORD_BOOK, book_id, &status);
+    if (write == NULL) {
+        return status;
+    }
+    strncpy(write->image.book.title, title, MAX_TITLE_LENGTH - 1);
+    write->image.book.title[MAX_TITLE_LENGTH - 1] = '\0';
+    strncpy(write->image.book.author, author, MAX_AUTHOR_LENGTH - 1);
+    write->image.book.author[MAX_AUTHOR_LENGTH - 1] = '\0';
+    return TXN_OK;
+}
+
+/**
+ * \brief           Xóa sách (mọi bản sao phải đang có sẵn)
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       book_id: ID sách
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_delete_book(txn_t* txn, uint32_t book_id) {
+    const book_t* book;
+    txn_write_t* write;
+    txn_status_t status;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+
+    book = txn_read_book(txn, book_id);
+    if (book == NULL) {
+        return TXN_NOT_FOUND;
+    }
+    if (book->available_count != book->copy_count) {
+        return TXN_IN_USE;
+    }
+
+    write = txn_stage(txn, TXN_RECORD_BOOK, book_id, &status);
+    if (write == NULL) {
+        return status;
+    }
+    write->deleted = 1;
+    return TXN_OK;
+}
+
+/**
+ * \brief           Thêm mới hoặc ghi đè toàn bộ một người dùng
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       user: Ảnh người dùng mới
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_put_user(txn_t* txn, const txn_user_t* user) {
+    txn_write_t* write;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+    if (user == NULL || !is_valid_id(user->user_id) || is_string_empty(user->name)
+        || (size_t)user->tier >= USER_TIER_COUNT || user->loan_count > USER_MAX_LOANS) {
+        return TXN_INVALID_INPUT;
+    }
+
+    write = txn_write_slot(txn, TXN_RECORD_USER, user->user_id);
+    if (write == NULL) {
+        return TXN_FULL;
+    }
+    write->deleted = 0;
+    write->image.user = *user;
+    return TXN_OK;
+}
+
+/**
+ * \brief           Xóa người dùng (không được đang mượn sách)
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       user_id: ID người dùng
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_delete_user(txn_t* txn, uint32_t user_id) {
+    const txn_user_t* user;
+    txn_write_t* write;
+    txn_status_t status;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+
+    user = txn_read_user(txn, user_id);
+    if (user == NULL) {
+        return TXN_NOT_FOUND;
+    }
+    if (user->loan_count > 0) {
+        return TXN_IN_USE;
+    }
+
+    write = txn_stage(txn, TXN_RECORD_USER, user_id, &status);
+    if (write == NULL) {
+        return status;
+    }
+    write->deleted = 1;
+    return TXN_OK;
+}
+
+/**
+ * \brief           Tìm khóa item của một đầu sách trong ảnh người dùng
+ * \param[in]       user: Ảnh người dùng
+ * \param[in]       book_id: ID sách
+ * \return          Vị trí trong loans, -1 nếu không mượn
+ */
+static int32_t
+txn_user_find_loan(const txn_user_t* user, uint32_t book_id) {
+    uint16_t i;
+
+    for (i = 0; i < user->loan_count; i++) {
+        if (BOOK_ITEM_BOOK_ID(user->loans[i]) == book_id) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief           Chèn khóa item vào ảnh người dùng, giữ thứ tự tăng dần
+ * \param[in,out]   user: Ảnh người dùng (còn chỗ)
+ * \param[in]       item_key: Khóa item
+ */
+static void
+txn_user_insert_loan(txn_user_t* user, uint32_t item_key) {
+    uint16_t pos;
+
+    pos = 0;
+    while (pos < user->loan_count && user->loans[pos] < item_key) {
+        pos++;
+    }
+    memmove(&user->loans[pos + 1], &user->loans[pos], (size_t)(user->loan_count - pos) * sizeof(user->loans[0]));
+    user->loans[pos] = item_key;
+    user->loan_count++;
+}
+
+/**
+ * \brief           Mượn một bản sao trong giao dịch
+ *
+ * Kiểm tra giống \ref mgmt_borrow_book; các lượt đặt giữ không thuộc phạm vi
+ * giao dịch.
+ *
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_borrow(txn_t* txn, uint32_t user_id, uint32_t book_id) {
+    const book_t* book;
+    const txn_user_t* user;
+    txn_write_t* book_write;
+    txn_write_t* user_write;
+    txn_status_t status;
+    uint8_t copy;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+
+    book = txn_read_book(txn, book_id);
+    user = txn_read_user(txn, user_id);
+    if (book == NULL || user == NULL) {
+        return TXN_NOT_FOUND;
+    }
+    if (book->available_mask == 0) {
+        return TXN_BOOK_UNAVAILABLE;
+    }
+    if (txn_user_find_loan(user, book_id) >= 0) {
+        return TXN_USER_ALREADY_HAS_BOOK;
+    }
+    if (user->loan_count >= user_tier_limit(user->tier)) {
+        return TXN_USER_LIMIT_REACHED;
+    }
+
+    book_write = txn_stage(txn, TXN_RECORD_BOOK, book_id, &status);
+    if (book_write == NULL) {
+        return status;
+    }
+    user_write = txn_stage(txn, TXN_RECORD_USER, user_id, &status);
+    if (user_write == NULL) {
+        return status;
+    }
+
+    copy = (uint8_t)__builtin_ctzll(book_write->image.book.available_mask);
+    book_write->image.book.available_mask &= book_write->image.book.available_mask - 1;
+    txn_book_sync(&book_write->image.book);
+    txn_user_insert_loan(&user_write->image.user, BOOK_ITEM_KEY(book_id, copy));
+    return TXN_OK;
+}
+
+/**
+ * \brief           Trả bản sao người dùng đang mượn trong giao dịch
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_return(txn_t* txn, uint32_t user_id, uint32_t book_id) {
+    const book_t* book;
+    const txn_user_t* user;
+    txn_write_t* book_write;
+    txn_write_t* user_write;
+    txn_status_t status;
+    txn_user_t* image;
+    uint32_t item_key;
+    int32_t pos;
+    uint8_t copy;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+
+    book = txn_read_book(txn, book_id);
+    user = txn_read_user(txn, user_id);
+    if (book == NULL || user == NULL) {
+        return TXN_NOT_FOUND;
+    }
+    pos = txn_user_find_loan(user, book_id);
+    if (pos < 0) {
+        return TXN_BOOK_NOT_BORROWED;
+    }
+    item_key = user->loans[pos];
+    copy = BOOK_ITEM_COPY(item_key);
+    if (copy >= book->copy_count || (book->available_mask & ((uint64_t)1 << copy))) {
+        return TXN_ERROR;
+    }
+
+    book_write = txn_stage(txn, TXN_RECORD_BOOK, book_id, &status);
+    if (book_write == NULL) {
+        return status;
+    }
+    user_write = txn_stage(txn, TXN_RECORD_USER, user_id, &status);
+    if (user_write == NULL) {
+        return status;
+    }
+
+    image = &user_write->image.user;
+    memmove(&image->loans[pos], &image->loans[pos + 1],
+            (size_t)(image->loan_count - pos - 1) * sizeof(image->loans[0]));
+    image->loan_count--;
+    book_write->image.book.available_mask |= (uint64_t)1 << copy;
+    txn_book_sync(&book_write->image.book);
+    return TXN_OK;
+}
+
+/**
+ * \brief           Chuyển toàn bộ sách đang mượn từ một thẻ sang thẻ khác (ví dụ khi mất thẻ)
+ *
+ * Bản sao vẫn giữ nguyên nên chỉ hai bản ghi người dùng thay đổi. Thẻ nhận
+ * phải còn đủ hạn mức và chưa mượn đầu sách nào trùng với thẻ cũ.
+ *
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \param[in]       from_user_id: ID thẻ cũ
+ * \param[in]       to_user_id: ID thẻ mới
+ * \return          \ref TXN_OK nếu thành công, \ref txn_status_t nếu lỗi
+ */
+txn_status_t
+txn_transfer_loans(txn_t* txn, uint32_t from_user_id, uint32_t to_user_id) {
+    const txn_user_t* from;
+    const txn_user_t* to;
+    txn_write_t* from_write;
+    txn_write_t* to_write;
+    txn_status_t status;
+    uint16_t i;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+    if (from_user_id == to_user_id) {
+        return TXN_INVALID_INPUT;
+    }
+
+    from = txn_read_user(txn, from_user_id);
+    to = txn_read_user(txn, to_user_id);
+    if (from == NULL || to == NULL) {
+        return TXN_NOT_FOUND;
+    }
+    if ((size_t)from->loan_count + to->loan_count > user_tier_limit(to->tier)) {
+        return TXN_USER_LIMIT_REACHED;
+    }
+    for (i = 0; i < from->loan_count; i++) {
+        if (txn_user_find_loan(to, BOOK_ITEM_BOOK_ID(from->loans[i])) >= 0) {
+            return TXN_USER_ALREADY_HAS_BOOK;
+        }
+    }
+
+    from_write = txn_stage(txn, TXN_RECORD_USER, from_user_id, &status);
+    if (from_write == NULL) {
+        return status;
+    }
+    to_write = txn_stage(txn, TXN_RECORD_USER, to_user_id, &status);
+    if (to_write == NULL) {
+        return status;
+    }
+
+    for (i = 0; i < from_write->image.user.loan_count; i++) {
+        txn_user_insert_loan(&to_write->image.user, from_write->image.user.loans[i]);
+    }
+    from_write->image.user.loan_count = 0;
+    return TXN_OK;
+}
+
+/**
+ * \brief           Tính trước phần việc của ảnh người dùng lên danh sách sống
+ *
+ * Áp dụng giữ lại các bản sao có trong ảnh và thêm các bản sao mới; các lần
+ * thêm phải nằm trong giới hạn của hạng mới và các khối tràn cần cấp được cộng
+ * vào \p demand để kiểm tra chung cho cả giao dịch.
+ *
+ * \param[in]       users: Danh sách người dùng sống
+ * \param[in]       image: Ảnh người dùng sẽ được áp dụng
+ * \param[in,out]   demand: Số khối tràn cần của từng lớp, được cộng dồn
+ * \return          \ref TXN_OK nếu áp dụng được, \ref TXN_USER_LIMIT_REACHED nếu vượt giới hạn
+ */
+static txn_status_t
+txn_plan_user(user_list_t* users, const txn_user_t* image, size_t* demand) {
+    const user_t* live;
+    const uint32_t* items;
+    int32_t pos;
+    size_t kept;
+    size_t i;
+
+    live = user_find_by_id(users, image->user_id);
+    kept = 0;
+    if (live != NULL) {
+        items = user_borrowed_items(users, live);
+        for (i = 0; i < live->borrowed_count; i++) {
+            pos = txn_user_find_loan(image, BOOK_ITEM_BOOK_ID(items[i]));
+            if (pos >= 0 && image->loans[pos] == items[i]) {
+                kept++;
+            }
+        }
+    }
+
+    if (image->loan_count > kept && image->loan_count > user_tier_limit(image->tier)) {
+        return TXN_USER_LIMIT_REACHED;
+    }
+    if (user_loan_demand(live, kept, image->loan_count, demand) != USER_OK) {
+        return TXN_USER_LIMIT_REACHED;
+    }
+    return TXN_OK;
+}
+
+/**
+ * \brief           Kiểm tra giao dịch có thể commit (gọi khi giữ commit_lock)
+ *
+ * First-committer-wins: nếu bản ghi nào trong write set đã có phiên bản mới
+ * hơn snapshot thì giao dịch xung đột. Ngoài ra mỗi bản ghi còn được so với
+ * bản ghi sống trong thư viện: nếu kho chưa phản ánh một thay đổi (không công
+ * bố được lúc xảy ra) thì trạng thái sống được công bố ngay và giao dịch cũng
+ * xung đột, lần thử lại sẽ thấy ảnh mới. Đồng thời đảm bảo đủ phiên bản trống,
+ * đủ chỗ trong thư viện, bảng băm và pool khối tràn của danh sách người dùng để
+ * bước cài đặt và áp dụng không thể thất bại giữa chừng.
+ *
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \return          \ref TXN_OK nếu có thể commit, \ref txn_status_t nếu không
+ */
+static txn_status_t
+txn_validate_locked(txn_t* txn) {
+    txn_store_t* store;
+    library_t* library;
+    const txn_write_t* write;
+    const book_t* live_book;
+    txn_status_t status;
+    uint32_t head;
+    size_t demand[USER_LOAN_POOL_CLASSES];
+    size_t new_books;
+    size_t new_users;
+    size_t i;
+
+    store = txn->store;
+    library = store->library;
+    new_books = 0;
+    new_users = 0;
+    memset(demand, 0, sizeof(demand));
+    for (i = 0; i < txn->write_count; i++) {
+        write = &txn->writes[i];
+        head = txn_head(store, write->kind, write->id);
+        if (head != TXN_NIL && store->versions[head].commit_ts > txn->start_ts) {
+            return TXN_CONFLICT;
+        }
+        if (!txn_head_matches_live(store, write->kind, write->id)) {
+            txn_publish_locked(store, write->kind, write->id);
+            return TXN_CONFLICT;
+        }
+
+        if (write->kind == TXN_RECORD_BOOK) {
+            live_book = book_find_by_id(library->books, write->id);
+            if (write->deleted && live_book != NULL && hold_queue_length(&live_book->holds) > 0) {
+                return TXN_IN_USE;
+            }
+            if (!write->deleted && live_book == NULL) {
+                new_books++;
+            }
+        } else if (!write->deleted) {
+            status = txn_plan_user(library->users, &write->image.user, demand);
+            if (status != TXN_OK) {
+                return status;
+            }
+            if (user_find_by_id(library->users, write->id) == NULL) {
+                new_users++;
+            }
+        }
+    }
+
+    if (library->books->count + new_books > MAX_BOOKS || library->users->count + new_users > MAX_USERS) {
+        return TXN_FULL;
+    }
+    if (!user_loan_pool_fits(library->users, demand)) {
+        return TXN_FULL;
+    }
+    if (store->free_count < txn->write_count) {
+        txn_gc_locked(store);
+        if (store->free_count < txn->write_count) {
+            return TXN_FULL;
+        }
+    }
+    for (i = 0; i < txn->write_count; i++) {
+        if (txn_lookup_or_insert(store, txn->writes[i].kind, txn->writes[i].id) == NULL) {
+            return TXN_FULL;
+        }
+    }
+    return TXN_OK;
+}
+
+/**
+ * \brief           Áp dụng một bản ghi sách đã commit vào thư viện
+ * \param[in,out]   books: Danh sách sách
+ * \param[in]       write: Bản ghi trong write set
+ */
+static void
+txn_apply_book(book_list_t* books, const txn_write_t* write) {
+    book_t* live;
+    hold_queue_t holds;
+
+    if (write->deleted) {
+        book_delete(books, write->id);
+        return;
+    }
+
+    live = book_find_by_id(books, write->id);
+    if (live == NULL) {
+        if (book_add_with_id(books, write->id, write->image.book.title, write->image.book.author) != BOOK_OK) {
+            return;
+        }
+        live = book_find_by_id(books, write->id);
+    }
+
+    /* Hàng đợi đặt giữ nằm ngoài giao dịch nên giữ nguyên của bản ghi sống */
+    holds = live->holds;
+    *live = write->image.book;
+    live->holds = holds;
+    book_notify(books, BOOK_EVENT_UPDATED, live);
+}
+
+/**
+ * \brief           Áp dụng một bản ghi người dùng đã commit vào thư viện
+ *
+ * Danh sách mượn được cập nhật theo phần chênh lệch với ảnh, mỗi bản sao
+ * thêm/bớt được ghi vào nhật ký thay đổi như một lượt mượn/trả.
+ *
+ * \param[in,out]   library: Thư viện nhận thay đổi
+ * \param[in]       write: Bản ghi trong write set
+ */
+static void
+txn_apply_user(library_t* library, const txn_write_t* write) {
+    const txn_user_t* image;
+    user_list_t* users;
+    user_t* live;
+    uint32_t item_key;
+    int32_t pos;
+    size_t i;
+
+    users = library->users;
+    if (write->deleted) {
+        user_delete(users, write->id);
+        return;
+    }
+
+    image = &write->image.user;
+    live = user_find_by_id(users, write->id);
+    if (live == NULL) {
+        if (user_add_with_id(users, write->id, image->name) != USER_OK) {
+            return;
+        }
+        live = user_find_by_id(users, write->id);
+    } else if (strcmp(live->name, image->name) != 0) {
+        user_update(users, write->id, image->name);
+    }
+    if (live->tier != image->tier) {
+        user_set_tier(users, write->id, image->tier);
+    }
+
+    /* Bỏ các bản sao không còn trong ảnh */
+    i = 0;
+    while (i < live->borrowed_count) {
+        item_key = user_borrowed_items(users, live)[i];
+        pos = txn_user_find_loan(image, BOOK_ITEM_BOOK_ID(item_key));
+        if (pos >= 0 && image->loans[pos] == item_key) {
+            i++;
+            continue;
+        }
+        user_remove_borrowed_book(users, live, item_key);
+        cdc_record_loan(library->cdc, CDC_OP_RETURN, write->id, item_key);
+        history_record(library->history, HISTORY_RETURN, write->id, item_key);
+    }
+
+    /* Thêm các bản sao mới */
+    for (i = 0; i < image->loan_count; i++) {
+        if (user_find_borrowed_item(users, live, BOOK_ITEM_BOOK_ID(image->loans[i]), &item_key) == USER_OK) {
+            continue;
+        }
+        if (user_add_borrowed_book(users, live, image->loans[i]) == USER_OK) {
+            cdc_record_loan(library->cdc, CDC_OP_LOAN, write->id, image->loans[i]);
+            history_record(library->history, HISTORY_LOAN, write->id, image->loans[i]);
+        }
+    }
+}
+
+/**
+ * \brief           Commit giao dịch
+ *
+ * Giao dịch luôn kết thúc sau lời gọi này; nếu trả về lỗi thì mọi thay đổi bị
+ * bỏ và có thể bắt đầu lại giao dịch mới trên snapshot mới hơn.
+ *
+ * \param[in,out]   txn: Con trỏ tới giao dịch
+ * \return          \ref TXN_OK nếu thành công, \ref TXN_CONFLICT nếu giao dịch khác
+ *                  đã commit trước, \ref txn_status_t nếu lỗi khác
+ */
+txn_status_t
+txn_commit(txn_t* txn) {
+    txn_store_t* store;
+    txn_status_t status;
+    size_t i;
+
+    if (txn == NULL || !txn->active) {
+        return TXN_NOT_ACTIVE;
+    }
+    if (txn->write_count == 0) {
+        txn_finish(txn);
+        return TXN_OK;
+    }
+
+    store = txn->store;
+    txn_lock(store);
+
+    status = txn_validate_locked(txn);
+    if (status != TXN_OK) {
+        if (status == TXN_CONFLICT) {
+            store->conflicts++;
+        }
+        txn_unlock(store);
+        txn_finish(txn);
+        return status;
+    }
+
+    /* Cài phiên bản mới lên đầu chuỗi; thời điểm commit được công bố khi nhả khóa */
+    for (i = 0; i < txn->write_count; i++) {
+        txn_install_locked(store, txn->writes[i].kind, txn->writes[i].id,
+                           txn->writes[i].deleted ? NULL : &txn->writes[i].image);
+    }
+
+    /* Đưa thay đổi vào thư viện; observer của kho bỏ qua vì phiên bản đã cài */
+    store->applying = 1;
+    for (i = 0; i < txn->write_count; i++) {
+        if (txn->writes[i].kind == TXN_RECORD_BOOK) {
+            txn_apply_book(store->library->books, &txn->writes[i]);
+        } else {
+            txn_apply_user(store->library, &txn->writes[i]);
+        }
+    }
+    store->applying = 0;
+    store->commits++;
+
+    txn_unlock(store);
+    txn_finish(txn);
+    return TXN_OK;
+}
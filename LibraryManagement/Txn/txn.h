@@ -0,0 +1,225 @@
+/**
+ * \file            txn.h
+ * \brief           Giao dịch nhiều thao tác với snapshot isolation (MVCC)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef TXN_HDR_H
+#define TXN_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../Management/management.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define TXN_MAX_WRITES              64          /*!< Số bản ghi tối đa một giao dịch được ghi */
+#define TXN_MAX_SNAPSHOTS           64          /*!< Số snapshot (giao dịch đang mở) đồng thời */
+#define TXN_VERSION_HEADROOM        4096        /*!< Số phiên bản dư ra ngoài một bản cho mỗi bản ghi */
+#define TXN_MAX_VERSIONS            (MAX_BOOKS + MAX_USERS + TXN_VERSION_HEADROOM)
+#define TXN_BOOK_TABLE_SIZE         (2 * MAX_BOOKS) /*!< Số ô bảng băm ID sách */
+#define TXN_USER_TABLE_SIZE         (2 * MAX_USERS) /*!< Số ô bảng băm ID người dùng */
+#define TXN_NIL                     UINT32_MAX  /*!< Chỉ số phiên bản rỗng */
+#define TXN_TOMBSTONE               UINT32_MAX  /*!< ID của ô bảng băm đã bỏ (bản ghi bị xóa và được thu hồi) */
+#define TXN_TABLE_LOAD_PERCENT      75          /*!< Tỷ lệ ô đã dùng (kể cả ô bỏ) tối đa trước khi phải thu hồi */
+#define TXN_RECLAIM_RETRIES         64          /*!< Số lần chạy lại GC (nhường CPU cho người đọc) khi hết phiên bản hoặc ô */
+
+/**
+ * \brief           Trạng thái trả về của các hàm giao dịch
+ */
+typedef enum {
+    TXN_OK = 0,                                 /*!< Thành công */
+    TXN_ERROR,                                  /*!< Lỗi chung */
+    TXN_INVALID_INPUT,                          /*!< Dữ liệu đầu vào không hợp lệ */
+    TXN_NOT_ACTIVE,                             /*!< Giao dịch đã kết thúc */
+    TXN_NOT_FOUND,                              /*!< Bản ghi không tồn tại trong snapshot */
+    TXN_ALREADY_EXISTS,                         /*!< Bản ghi đã tồn tại */
+    TXN_CONFLICT,                               /*!< Giao dịch khác đã commit bản ghi này sau snapshot */
+    TXN_FULL,                                   /*!< Hết chỗ (write set, phiên bản, snapshot, bảng băm hoặc pool khối tràn) */
+    TXN_IN_USE,                                 /*!< Bản ghi đang được dùng (sách đang mượn/đặt giữ, người dùng đang mượn) */
+    TXN_BOOK_UNAVAILABLE,                       /*!< Sách không còn bản có sẵn */
+    TXN_BOOK_NOT_BORROWED,                      /*!< Người dùng không mượn sách này */
+    TXN_USER_LIMIT_REACHED,                     /*!< Vượt giới hạn mượn theo hạng */
+    TXN_USER_ALREADY_HAS_BOOK,                  /*!< Người dùng đã mượn một bản của sách này */
+} txn_status_t;
+
+/**
+ * \brief           Loại bản ghi
+ */
+typedef enum {
+    TXN_RECORD_BOOK = 0,                        /*!< Sách */
+    TXN_RECORD_USER,                            /*!< Người dùng */
+} txn_record_t;
+
+/**
+ * \brief           Ảnh bản ghi người dùng; danh sách mượn được chép sâu vào ảnh
+ */
+typedef struct {
+    uint32_t user_id;                           /*!< ID người dùng */
+    char name[MAX_NAME_LENGTH];                 /*!< Tên */
+    user_tier_t tier;                           /*!< Hạng */
+    uint16_t loan_count;                        /*!< Số khóa item đang mượn */
+    uint32_t loans[USER_MAX_LOANS];             /*!< Khóa item, tăng dần */
+} txn_user_t;
+
+/**
+ * \brief           Ảnh của một bản ghi
+ */
+typedef union {
+    book_t book;                                /*!< Ảnh sách (trường holds không thuộc phạm vi giao dịch) */
+    txn_user_t user;                            /*!< Ảnh người dùng */
+} txn_image_t;
+
+/**
+ * \brief           Một phiên bản đã commit; bất biến sau khi công bố trừ liên kết older
+ */
+typedef struct {
+    uint64_t commit_ts;                         /*!< Thời điểm commit tạo ra phiên bản */
+    _Atomic uint32_t older;                     /*!< Phiên bản cũ hơn kế tiếp */
+    uint8_t deleted;                            /*!< 1 nếu là phiên bản xóa */
+    txn_image_t image;                          /*!< Nội dung bản ghi */
+} txn_version_t;
+
+/**
+ * \brief           Ô bảng băm ID -> đầu chuỗi phiên bản (mới nhất trước)
+ *
+ * Ô của bản ghi đã xóa mà không snapshot nào còn thấy được GC đổi thành
+ * \ref TXN_TOMBSTONE để dãy dò tuyến tính không bị cắt. Phiên bản xóa còn treo
+ * ở head tới khi mọi snapshot mở trước thời điểm retired đóng lại; sau đó ô
+ * được dùng lại cho ID mới hoặc trở về trống.
+ */
+typedef struct {
+    _Atomic uint32_t id;                        /*!< ID bản ghi, 0 = ô trống, \ref TXN_TOMBSTONE = ô bỏ */
+    _Atomic uint32_t head;                      /*!< Phiên bản mới nhất */
+    uint64_t retired;                           /*!< Ô bỏ: thời điểm từ đó snapshot không còn thấy ID cũ */
+} txn_entry_t;
+
+/**
+ * \brief           Kho phiên bản của một thư viện
+ *
+ * Người đọc không khóa: lấy thời điểm snapshot rồi đi theo chuỗi phiên bản tới
+ * phiên bản đầu tiên có commit_ts không lớn hơn snapshot. Người ghi giữ
+ * commit_lock (đệ quy): commit của giao dịch cũng như các hàm mgmt_* sửa thư
+ * viện qua \ref txn_lock. Mọi thay đổi của danh sách sách/người dùng đều được
+ * công bố thành phiên bản mới (qua observer và \ref txn_publish_user), và
+ * clock chỉ tăng khi nhả khóa ngoài cùng nên snapshot không bao giờ thấy một
+ * thao tác làm dở.
+ */
+typedef struct txn_store {
+    library_t* library;                         /*!< Thư viện nhận thay đổi khi commit */
+    pthread_mutex_t commit_lock;                /*!< Tuần tự hóa mọi thao tác ghi (đệ quy) */
+    uint32_t lock_depth;                        /*!< Số lần commit_lock đang được giữ lồng nhau */
+    uint64_t pending_ts;                        /*!< commit_ts của phiên bản chưa công bố, 0 = không có */
+    uint8_t applying;                           /*!< 1 khi commit đang áp dụng write set vào thư viện */
+    uint8_t stale;                              /*!< 1 khi có thay đổi chưa công bố được, đồng bộ lại khi nhả khóa */
+    book_observer_fn book_next;                 /*!< Observer sách được gọi tiếp sau kho */
+    void* book_next_ctx;                        /*!< Ngữ cảnh của book_next */
+    user_observer_fn user_next;                 /*!< Observer người dùng được gọi tiếp sau kho */
+    void* user_next_ctx;                        /*!< Ngữ cảnh của user_next */
+    _Atomic uint64_t clock;                     /*!< Thời điểm commit gần nhất */
+    _Atomic uint64_t snapshots[TXN_MAX_SNAPSHOTS]; /*!< Thời điểm snapshot đang mở, 0 = ô trống */
+    txn_entry_t books[TXN_BOOK_TABLE_SIZE];     /*!< Bảng băm sách */
+    txn_entry_t users[TXN_USER_TABLE_SIZE];     /*!< Bảng băm người dùng */
+    txn_version_t versions[TXN_MAX_VERSIONS];   /*!< Pool phiên bản */
+    uint32_t free_head;                         /*!< Danh sách phiên bản trống (nối qua older) */
+    size_t free_count;                          /*!< Số phiên bản trống */
+    size_t book_slots;                          /*!< Số ô bảng sách khác trống (kể cả ô bỏ) */
+    size_t user_slots;                          /*!< Số ô bảng người dùng khác trống (kể cả ô bỏ) */
+    uint64_t commits;                           /*!< Số giao dịch commit thành công */
+    uint64_t conflicts;                         /*!< Số giao dịch bị hủy do xung đột */
+    uint64_t lost;                              /*!< Số lần không công bố được thay đổi vì kho đầy */
+} txn_store_t;
+
+/**
+ * \brief           Một bản ghi trong write set
+ */
+typedef struct {
+    txn_record_t kind;                          /*!< Loại bản ghi */
+    uint32_t id;                                /*!< ID bản ghi */
+    uint8_t deleted;                            /*!< 1 nếu giao dịch xóa bản ghi */
+    txn_image_t image;                          /*!< Ảnh mới */
+} txn_write_t;
+
+/**
+ * \brief           Một giao dịch
+ */
+typedef struct {
+    txn_store_t* store;                         /*!< Kho phiên bản */
+    uint64_t start_ts;                          /*!< Thời điểm snapshot */
+    uint32_t snapshot_slot;                     /*!< Ô đăng ký snapshot */
+    uint8_t active;                             /*!< 1 khi giao dịch đang mở */
+    size_t write_count;                         /*!< Số bản ghi trong write set */
+    txn_write_t writes[TXN_MAX_WRITES];         /*!< Write set */
+} txn_t;
+
+/* Khai báo các hàm quản lý kho phiên bản */
+txn_status_t    txn_store_init(txn_store_t* store, library_t* library);
+void            txn_store_destroy(txn_store_t* store);
+size_t          txn_gc(txn_store_t* store);
+void            txn_sync(txn_store_t* store);
+
+/* Khai báo các hàm khóa ghi (NULL = bỏ qua) */
+void            txn_lock(txn_store_t* store);
+void            txn_unlock(txn_store_t* store);
+void            txn_publish_user(txn_store_t* store, uint32_t user_id);
+
+/* Khai báo các hàm giao dịch */
+txn_status_t    txn_begin(txn_store_t* store, txn_t* txn);
+txn_status_t    txn_commit(txn_t* txn);
+void            txn_abort(txn_t* txn);
+
+/* Đọc theo snapshot (thấy cả thay đổi của chính giao dịch) */
+const book_t*   txn_read_book(const txn_t* txn, uint32_t book_id);
+const txn_user_t* txn_read_user(const txn_t* txn, uint32_t user_id);
+size_t          txn_foreach_book(const txn_t* txn, book_visit_fn visit, void* ctx);
+txn_status_t    txn_read_counts(txn_store_t* store, scan_counts_t* counts, size_t* users);
+
+/* Ghi vào write set */
+txn_status_t    txn_put_book(txn_t* txn, const book_t* book);
+txn_status_t    txn_update_book(txn_t* txn, uint32_t book_id, const char* title, const char* author);
+txn_status_t    txn_delete_book(txn_t* txn, uint32_t book_id);
+txn_status_t    txn_put_user(txn_t* txn, const txn_user_t* user);
+txn_status_t    txn_delete_user(txn_t* txn, uint32_t user_id);
+
+/* Nghiệp vụ mượn/trả trong giao dịch */
+txn_status_t    txn_borrow(txn_t* txn, uint32_t user_id, uint32_t book_id);
+txn_status_t    txn_return(txn_t* txn, uint32_t user_id, uint32_t book_id);
+txn_status_t    txn_transfer_loans(txn_t* txn, uint32_t from_user_id, uint32_t to_user_id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* TXN_HDR_H */
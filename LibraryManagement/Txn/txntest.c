@@ -0,0 +1,267 @@
+/**
+ * \file            txntest.c
+ * \brief           library_txntest: kiểm tra kho phiên bản MVCC (thu hồi ô bảng băm khi thêm/xóa liên tục)
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "txn.h"
+
+#define TXNTEST_CHURN_ROUNDS        3           /* Số lần quay vòng toàn bộ bảng băm khi thêm/xóa */
+#define TXNTEST_PINNED_CYCLES       200         /* Số vòng thêm/xóa khi một snapshot đang mở */
+#define TXNTEST_CARD_LOANS          4           /* Số lượt mượn trên mỗi thẻ khi chuyển (vừa đủ mảng tại chỗ) */
+
+/* Dữ liệu nằm ở vùng tĩnh để không phụ thuộc kích thước stack */
+static book_list_t txntest_books;
+static user_list_t txntest_users;
+static hold_pool_t txntest_holds;
+static library_t txntest_library;
+static txn_store_t txntest_store;
+static txn_t txntest_reader;
+static size_t txntest_failures;
+
+/**
+ * \brief           Ghi nhận kết quả một phép kiểm tra
+ * \param[in]       ok: Khác 0 nếu đạt
+ * \param[in]       what: Mô tả phép kiểm tra
+ */
+static void
+txntest_check(int ok, const char* what) {
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok) {
+        txntest_failures++;
+    }
+}
+
+/**
+ * \brief           Dựng thư viện rỗng và gắn kho phiên bản mới
+ */
+static void
+txntest_setup(void) {
+    book_init(&txntest_books);
+    user_init(&txntest_users);
+    hold_pool_init(&txntest_holds);
+    txntest_library.books = &txntest_books;
+    txntest_library.users = &txntest_users;
+    txntest_library.holds = &txntest_holds;
+    txntest_library.cache = NULL;
+    txntest_library.scan = NULL;
+    txntest_library.cdc = NULL;
+    txntest_library.history = NULL;
+    txntest_library.barcodes = NULL;
+    txntest_library.notify = NULL;
+    txntest_library.txn = NULL;
+    txn_store_init(&txntest_store, &txntest_library);
+}
+
+/**
+ * \brief           Thêm rồi xóa một sách và một người dùng
+ * \return          1 nếu cả bốn thao tác thành công
+ */
+static int
+txntest_churn_once(void) {
+    uint32_t book_id;
+    uint32_t user_id;
+
+    if (book_add(&txntest_books, "Sach tam", "Tac gia", &book_id) != BOOK_OK
+        || user_add(&txntest_users, "Ban doc tam", &user_id) != USER_OK) {
+        return 0;
+    }
+    return book_delete(&txntest_books, book_id) == BOOK_OK && user_delete(&txntest_users, user_id) == USER_OK;
+}
+
+/**
+ * \brief           Thêm/xóa nhiều hơn số ô của bảng băm rồi kiểm tra bản ghi mới vẫn được công bố
+ */
+static void
+txntest_run_churn(void) {
+    scan_counts_t counts;
+    size_t users;
+    uint32_t book_id;
+    uint32_t user_id;
+    size_t cycles;
+    size_t i;
+    int ok;
+
+    txntest_setup();
+    cycles = TXNTEST_CHURN_ROUNDS * (TXN_BOOK_TABLE_SIZE > TXN_USER_TABLE_SIZE ? TXN_BOOK_TABLE_SIZE
+                                                                               : TXN_USER_TABLE_SIZE);
+    ok = 1;
+    for (i = 0; i < cycles && ok; i++) {
+        ok = txntest_churn_once();
+    }
+    txntest_check(ok, "thêm/xóa liên tục vượt số ô bảng băm");
+
+    book_add(&txntest_books, "Sach moi", "Tac gia", &book_id);
+    user_add(&txntest_users, "Ban doc moi", &user_id);
+    txn_read_counts(&txntest_store, &counts, &users);
+    txntest_check(counts.titles == 1 && users == 1, "thống kê trên snapshot thấy bản ghi mới");
+    txntest_check(txntest_store.lost == 0 && !txntest_store.stale, "không thay đổi nào bị mất");
+    txntest_check(txntest_store.book_slots * 100 <= TXN_BOOK_TABLE_SIZE * TXN_TABLE_LOAD_PERCENT
+                  && txntest_store.user_slots * 100 <= TXN_USER_TABLE_SIZE * TXN_TABLE_LOAD_PERCENT,
+                  "số ô đã dùng không vượt ngưỡng tải");
+
+    txn_begin(&txntest_store, &txntest_reader);
+    txntest_check(txn_read_book(&txntest_reader, book_id) != NULL
+                  && txn_read_user(&txntest_reader, user_id) != NULL, "giao dịch đọc được bản ghi mới");
+    txn_abort(&txntest_reader);
+    txn_store_destroy(&txntest_store);
+}
+
+/**
+ * \brief           Thêm/xóa khi một snapshot cũ đang mở: snapshot vẫn thấy trạng thái cũ, ô được thu hồi sau khi đóng
+ */
+static void
+txntest_run_pinned(void) {
+    scan_counts_t counts;
+    size_t users;
+    uint32_t book_id;
+    size_t i;
+    int ok;
+
+    txntest_setup();
+    book_add(&txntest_books, "Sach goc", "Tac gia", &book_id);
+    txn_begin(&txntest_store, &txntest_reader);
+
+    ok = 1;
+    for (i = 0; i < TXNTEST_PINNED_CYCLES && ok; i++) {
+        ok = txntest_churn_once();
+        txn_gc(&txntest_store);
+    }
+    txntest_check(ok && txntest_store.lost == 0, "thêm/xóa khi snapshot cũ đang mở");
+    txntest_check(txn_read_book(&txntest_reader, book_id) != NULL
+                  && txn_foreach_book(&txntest_reader, NULL, NULL) == 1, "snapshot cũ chỉ thấy sách gốc");
+    txn_abort(&txntest_reader);
+
+    /* Sau khi snapshot đóng, các ô bỏ được thu hồi và vòng thêm/xóa dài không còn làm đầy bảng */
+    txn_gc(&txntest_store);
+    for (i = 0; i < TXNTEST_CHURN_ROUNDS * TXN_BOOK_TABLE_SIZE && ok; i++) {
+        ok = txntest_churn_once();
+    }
+    txn_read_counts(&txntest_store, &counts, &users);
+    txntest_check(ok && counts.titles == 1 && users == 0 && txntest_store.lost == 0,
+                  "ô bỏ được thu hồi sau khi snapshot đóng");
+    txn_store_destroy(&txntest_store);
+}
+
+/**
+ * \brief           Thêm người dùng với hạng và \p loans lượt mượn giả định bắt đầu từ sách \p first_book
+ * \param[in]       tier: Hạng người dùng
+ * \param[in]       first_book: ID sách của lượt mượn đầu tiên
+ * \param[in]       loans: Số lượt mượn
+ * \param[out]      user_id: ID được gán
+ * \return          \ref USER_OK nếu thành công, \ref user_status_t của thao tác hỏng đầu tiên
+ */
+static user_status_t
+txntest_add_borrower(user_tier_t tier, uint32_t first_book, size_t loans, uint32_t* user_id) {
+    user_status_t status;
+    user_t* user;
+    size_t i;
+
+    status = user_add(&txntest_users, "Ban doc", user_id);
+    if (status != USER_OK) {
+        return status;
+    }
+    user_set_tier(&txntest_users, *user_id, tier);
+    user = user_find_by_id(&txntest_users, *user_id);
+    for (i = 0; i < loans; i++) {
+        status = user_add_borrowed_book(&txntest_users, user, BOOK_ITEM_KEY(first_book + i, 0));
+        if (status != USER_OK) {
+            return status;
+        }
+    }
+    return USER_OK;
+}
+
+/**
+ * \brief           Chuyển lượt mượn khi mọi người dùng khác đều mượn tới giới hạn: pool khối tràn không được cạn
+ */
+static void
+txntest_run_loan_pool(void) {
+    const user_t* from;
+    const user_t* to;
+    user_status_t status;
+    txn_status_t result;
+    size_t demand[USER_LOAN_POOL_CLASSES];
+    uint32_t from_id;
+    uint32_t to_id;
+    uint32_t filler_id;
+
+    txntest_setup();
+    txntest_add_borrower(USER_TIER_STAFF, 1, TXNTEST_CARD_LOANS, &from_id);
+    txntest_add_borrower(USER_TIER_STAFF, 1 + TXNTEST_CARD_LOANS, TXNTEST_CARD_LOANS, &to_id);
+
+    /* Mỗi giảng viên đi qua mọi lớp khối rồi giữ khối lớn nhất, cho tới khi danh sách đầy */
+    do {
+        status = txntest_add_borrower(USER_TIER_FACULTY, 1, USER_LIMIT_FACULTY, &filler_id);
+    } while (status == USER_OK);
+    txntest_check(status == USER_FULL, "pool khối tràn đủ cho mọi người dùng mượn tới giới hạn");
+    txn_sync(&txntest_store);
+
+    txn_begin(&txntest_store, &txntest_reader);
+    result = txn_transfer_loans(&txntest_reader, from_id, to_id);
+    if (result == TXN_OK) {
+        result = txn_commit(&txntest_reader);
+    } else {
+        txn_abort(&txntest_reader);
+    }
+    from = user_find_by_id(&txntest_users, from_id);
+    to = user_find_by_id(&txntest_users, to_id);
+    txntest_check(result == TXN_OK && from->borrowed_count == 0 && to->borrowed_count == 2 * TXNTEST_CARD_LOANS,
+                  "chuyển lượt mượn cần khối tràn mới khi danh sách đã đầy");
+
+    /* Nhu cầu vượt vùng nhớ còn lại thì bước kiểm tra trước commit phải từ chối */
+    memset(demand, 0, sizeof(demand));
+    demand[USER_LOAN_POOL_CLASSES - 1] = MAX_USERS + 1;
+    txntest_check(!user_loan_pool_fits(&txntest_users, demand), "kiểm tra dung lượng từ chối nhu cầu vượt pool");
+    txn_store_destroy(&txntest_store);
+}
+
+/**
+ * \brief           Hàm chính
+ * \return          0 nếu mọi kiểm tra đạt, 1 nếu có lỗi
+ */
+int
+main(void) {
+    printf("library_txntest: %u ô sách, %u ô người dùng, %u phiên bản\n",
+           (unsigned)TXN_BOOK_TABLE_SIZE, (unsigned)TXN_USER_TABLE_SIZE, (unsigned)TXN_MAX_VERSIONS);
+
+    txntest_run_churn();
+    txntest_run_pinned();
+    txntest_run_loan_pool();
+
+    if (txntest_failures > 0) {
+        printf("library_txntest: %zu kiểm tra không đạt\n", txntest_failures);
+        return 1;
+    }
+    printf("library_txntest: mọi kiểm tra đạt\n");
+    return 0;
+}
@@ -42,13 +42,9 @@
  */
 void
 clear_screen(void) {
-    int32_t result;
-#ifdef _WIN32
-    result = system("cls");
-#else
-    result = system("clear");
-#endif
-    (void)result; /* Bỏ qua cảnh báo unused result */
+    /* Đưa con trỏ về đầu rồi xóa bằng mã ANSI: không tạo tiến trình con, và
+       được ghi chung với nội dung màn hình trong cùng một lần flush */
+    fputs("\x1b[H\x1b[2J", stdout);
 }
 
 /**
@@ -57,6 +53,7 @@ clear_screen(void) {
 void
 pause_screen(void) {
     printf("\nNhấn Enter để tiếp tục...");
+    fflush(stdout);
     clear_input_buffer();
     getchar();
 }
@@ -103,6 +100,7 @@ read_string(char* buffer, size_t max_len, const char* prompt) {
     }
 
     printf("%s", prompt);
+    fflush(stdout);
     
     if (fgets(buffer, max_len, stdin) == NULL) {
         return UTILS_ERROR;
@@ -144,6 +142,7 @@ read_int(int32_t* value, const char* prompt) {
     }
 
     printf("%s", prompt);
+    fflush(stdout);
     
     if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
         return UTILS_ERROR;
@@ -177,6 +176,7 @@ read_uint(uint32_t* value, const char* prompt) {
     }
 
     printf("%s", prompt);
+    fflush(stdout);
     
     if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
         return UTILS_ERROR;
@@ -313,3 +313,113 @@ string_contains(const char* haystack, const char* needle) {
     return (strstr(haystack_lower, needle_lower) != NULL) ? 1 : 0;
 }
 
+
+/**
+ * \brief           Kiểm tra chuỗi con khi chuỗi con đã ở dạng chữ thường
+ *
+ * Dùng trong các vòng quét: chuỗi cần tìm chỉ chuyển sang chữ thường một lần
+ * thay vì ở mỗi lần so sánh như \ref string_contains.
+ *
+ * \param[in]       haystack: Chuỗi cha
+ * \param[in]       needle_lower: Chuỗi con cần tìm, đã chuyển sang chữ thường
+ * \return          1 nếu tìm thấy, 0 nếu không tìm thấy
+ */
+int32_t
+string_contains_lower(const char* haystack, const char* needle_lower) {
+    char haystack_lower[MAX_STRING_LENGTH];
+    size_t i;
+
+    if (haystack == NULL || needle_lower == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < MAX_STRING_LENGTH - 1 && haystack[i] != '\0'; i++) {
+        haystack_lower[i] = (char)tolower((unsigned char)haystack[i]);
+    }
+    haystack_lower[i] = '\0';
+
+    return (strstr(haystack_lower, needle_lower) != NULL) ? 1 : 0;
+}
+
+/**
+ * \brief           Trộn bit của một khóa 64 bit (bước cuối của splitmix64)
+ * \param[in]       key: Khóa
+ * \return          Giá trị hash, các bit phân bố đều kể cả khi khóa liên tiếp nhau
+ */
+uint64_t
+hash_u64(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * \brief           Tính word và mặt nạ bit của một khóa trong bộ lọc Bloom
+ *
+ * Bộ lọc chia theo khối: bốn bit của một khóa nằm cùng một word 64 bit nên mỗi
+ * lần thêm hoặc kiểm tra chỉ chạm một cache line.
+ *
+ * \param[in]       word_count: Số word của bộ lọc
+ * \param[in]       key: Khóa
+ * \param[out]      mask: Mặt nạ bốn bit của khóa
+ * \return          Chỉ số word chứa khóa
+ */
+static size_t
+key_filter_locate(size_t word_count, uint64_t key, uint64_t* mask) {
+    uint64_t hash;
+
+    hash = hash_u64(key);
+    *mask = ((uint64_t)1 << (hash & 63))
+            | ((uint64_t)1 << ((hash >> 6) & 63))
+            | ((uint64_t)1 << ((hash >> 12) & 63))
+            | ((uint64_t)1 << ((hash >> 18) & 63));
+
+    /* Nhân rồi dịch thay cho phép chia lấy dư: word_count không cần là lũy thừa của 2 */
+    return (size_t)(((hash >> 32) * (uint64_t)word_count) >> 32);
+}
+
+/**
+ * \brief           Thêm khóa vào bộ lọc Bloom
+ * \param[in,out]   words: Mảng bit của bộ lọc (\ref KEY_FILTER_WORDS word)
+ * \param[in]       word_count: Số word của bộ lọc
+ * \param[in]       key: Khóa cần thêm
+ */
+void
+key_filter_add(uint64_t* words, size_t word_count, uint64_t key) {
+    uint64_t mask;
+    size_t word;
+
+    if (words == NULL || word_count == 0) {
+        return;
+    }
+
+    word = key_filter_locate(word_count, key, &mask);
+    words[word] |= mask;
+}
+
+/**
+ * \brief           Kiểm tra khóa có thể nằm trong bộ lọc Bloom
+ *
+ * Kết quả 0 là chắc chắn: khóa chưa từng được thêm, người gọi bỏ qua được lần
+ * dò trong cấu trúc chính. Kết quả 1 có thể sai (khoảng 0,5% với 16 bit mỗi khóa).
+ *
+ * \param[in]       words: Mảng bit của bộ lọc
+ * \param[in]       word_count: Số word của bộ lọc
+ * \param[in]       key: Khóa cần kiểm tra
+ * \return          0 nếu chắc chắn không có, 1 nếu có thể có
+ */
+uint8_t
+key_filter_may_contain(const uint64_t* words, size_t word_count, uint64_t key) {
+    uint64_t mask;
+    size_t word;
+
+    if (words == NULL || word_count == 0) {
+        return 1;
+    }
+
+    word = key_filter_locate(word_count, key, &mask);
+    return ((words[word] & mask) == mask) ? 1 : 0;
+}
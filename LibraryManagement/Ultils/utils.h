@@ -46,6 +46,8 @@ extern "C" {
 #define MAX_INPUT_LENGTH            512
 #define MIN_ID_VALUE                1
 #define MAX_ID_VALUE                999999
+#define KEY_FILTER_BITS_PER_KEY     16          /*!< Kích thước bộ lọc Bloom tính theo số khóa dự kiến */
+#define KEY_FILTER_WORDS(keys)      ((((size_t)(keys)) * KEY_FILTER_BITS_PER_KEY + 63) / 64)
 
 /**
  * \brief           Trạng thái trả về của các hàm
@@ -74,6 +76,11 @@ uint8_t         is_valid_id(uint32_t id);
 void            trim_string(char* str);
 void            to_lowercase(char* str);
 int32_t         string_contains(const char* haystack, const char* needle);
+int32_t         string_contains_lower(const char* haystack, const char* needle_lower);
+
+uint64_t        hash_u64(uint64_t key);
+void            key_filter_add(uint64_t* words, size_t word_count, uint64_t key);
+uint8_t         key_filter_may_contain(const uint64_t* words, size_t word_count, uint64_t key);
 
 #ifdef __cplusplus
 }
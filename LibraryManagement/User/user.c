@@ -32,9 +32,145 @@
  */
 
 #include "user.h"
+#include "../Book/book.h"
 #include <stdio.h>
 #include <string.h>
 
+_Static_assert(((size_t)USER_LOAN_POOL_MIN_BLOCK << (USER_LOAN_POOL_CLASSES - 1)) >= USER_MAX_LOANS,
+               "Lớp khối tràn lớn nhất phải chứa được giới hạn mượn cao nhất");
+_Static_assert(USER_LOAN_POOL_WORDS < UINT32_MAX, "Offset khối tràn phải vừa uint32_t");
+
+/* Giới hạn mượn theo hạng, đánh chỉ số bằng \ref user_tier_t */
+static const size_t user_tier_limits[USER_TIER_COUNT] = {
+    USER_LIMIT_STUDENT,
+    USER_LIMIT_STAFF,
+    USER_LIMIT_FACULTY,
+};
+
+/**
+ * \brief           Tìm lớp kích thước nhỏ nhất chứa được \p capacity khóa
+ * \param[in]       capacity: Số khóa cần chứa
+ * \return          Chỉ số lớp, \ref USER_LOAN_POOL_CLASSES nếu quá lớn
+ */
+static size_t
+user_pool_class(size_t capacity) {
+    size_t cls;
+
+    for (cls = 0; cls < USER_LOAN_POOL_CLASSES; cls++) {
+        if (((size_t)USER_LOAN_POOL_MIN_BLOCK << cls) >= capacity) {
+            break;
+        }
+    }
+    return cls;
+}
+
+/**
+ * \brief           Cấp phát một khối từ pool của danh sách
+ * \param[in,out]   list: Con trỏ tới danh sách người dùng sở hữu pool
+ * \param[in]       cls: Lớp kích thước
+ * \return          Offset + 1 của khối, 0 nếu pool đã hết
+ */
+static uint32_t
+user_pool_alloc(user_list_t* list, size_t cls) {
+    size_t words;
+    uint32_t ref;
+
+    /* Ưu tiên tái sử dụng khối trống */
+    if (list->loan_free[cls] != 0) {
+        ref = list->loan_free[cls];
+        list->loan_free[cls] = list->loan_arena[ref - 1];
+        return ref;
+    }
+
+    words = (size_t)USER_LOAN_POOL_MIN_BLOCK << cls;
+    if (list->loan_top + words > USER_LOAN_POOL_WORDS) {
+        return 0;
+    }
+    ref = (uint32_t)list->loan_top + 1;
+    list->loan_top += words;
+    return ref;
+}
+
+/**
+ * \brief           Trả khối về danh sách trống của lớp tương ứng
+ * \param[in,out]   list: Con trỏ tới danh sách người dùng sở hữu pool
+ * \param[in]       ref: Offset + 1 của khối
+ * \param[in]       cls: Lớp kích thước của khối
+ */
+static void
+user_pool_free(user_list_t* list, uint32_t ref, size_t cls) {
+    list->loan_arena[ref - 1] = list->loan_free[cls];
+    list->loan_free[cls] = ref;
+}
+
+/**
+ * \brief           Vị trí đầu tiên có khóa >= \p key trong mảng đã sắp xếp
+ * \param[in]       items: Mảng khóa item tăng dần
+ * \param[in]       count: Số phần tử
+ * \param[in]       key: Khóa cần tìm
+ * \return          Chỉ số trong khoảng [0, count]
+ */
+static size_t
+user_lower_bound(const uint32_t* items, size_t count, uint32_t key) {
+    size_t lo;
+    size_t hi;
+    size_t mid;
+
+    /* Danh sách ngắn: duyệt tuyến tính nhanh hơn */
+    if (count <= USER_LINEAR_SCAN_MAX) {
+        for (lo = 0; lo < count && items[lo] < key; lo++) {}
+        return lo;
+    }
+
+    lo = 0;
+    hi = count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (items[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * \brief           Con trỏ ghi được tới danh sách mượn hiện tại
+ * \param[in,out]   list: Con trỏ tới danh sách chứa người dùng
+ * \param[in]       user: Con trỏ tới người dùng
+ * \return          Mảng tại chỗ hoặc khối tràn
+ */
+static uint32_t*
+user_items_mut(user_list_t* list, user_t* user) {
+    return (user->borrowed_spill != 0) ? &list->loan_arena[user->borrowed_spill - 1] : user->borrowed_inline;
+}
+
+/**
+ * \brief           Đặt danh sách mượn về trạng thái rỗng, dùng mảng tại chỗ
+ * \param[out]      user: Con trỏ tới người dùng
+ */
+static void
+user_reset_loans(user_t* user) {
+    user->borrowed_count = 0;
+    user->borrowed_spill = 0;
+    user->borrowed_capacity = USER_INLINE_LOANS;
+    memset(user->borrowed_inline, 0, sizeof(user->borrowed_inline));
+}
+
+/**
+ * \brief           Báo thay đổi cho observer của danh sách (nếu có)
+ * \param[in]       list: Con trỏ tới danh sách người dùng
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       user: Người dùng bị thay đổi
+ */
+static void
+user_notify(const user_list_t* list, user_event_t event, const user_t* user) {
+    if (list->observer != NULL) {
+        list->observer(event, user, list->observer_ctx);
+    }
+}
+
 /**
  * \brief           Khởi tạo danh sách người dùng
  * \param[in,out]   list: Con trỏ tới danh sách người dùng
@@ -44,7 +180,11 @@ user_init(user_list_t* list) {
     if (list != NULL) {
         list->count = 0;
         list->next_id = 1;
+        list->observer = NULL;
+        list->observer_ctx = NULL;
+        list->loan_top = 0;
         memset(list->users, 0, sizeof(list->users));
+        memset(list->loan_free, 0, sizeof(list->loan_free));
     }
 }
 
@@ -81,11 +221,12 @@ user_add(user_list_t* list, const char* name, uint32_t* assigned_id) {
     new_user->user_id = new_id;
     strncpy(new_user->name, name, MAX_NAME_LENGTH - 1);
     new_user->name[MAX_NAME_LENGTH - 1] = '\0';
-    new_user->borrowed_count = 0;
-    memset(new_user->borrowed_books, 0, sizeof(new_user->borrowed_books));
+    new_user->tier = USER_TIER_STUDENT;
+    user_reset_loans(new_user);
 
     list->count++;
     list->next_id++;
+    user_notify(list, USER_EVENT_ADDED, new_user);
 
     /* Trả về ID đã được gán nếu có yêu cầu */
     if (assigned_id != NULL) {
@@ -133,10 +274,11 @@ user_add_with_id(user_list_t* list, uint32_t user_id, const char* name) {
     new_user->user_id = user_id;
     strncpy(new_user->name, name, MAX_NAME_LENGTH - 1);
     new_user->name[MAX_NAME_LENGTH - 1] = '\0';
-    new_user->borrowed_count = 0;
-    memset(new_user->borrowed_books, 0, sizeof(new_user->borrowed_books));
+    new_user->tier = USER_TIER_STUDENT;
+    user_reset_loans(new_user);
 
     list->count++;
+    user_notify(list, USER_EVENT_ADDED, new_user);
 
     /* Cập nhật next_id nếu cần */
     if (user_id >= list->next_id) {
@@ -175,6 +317,7 @@ user_update(user_list_t* list, uint32_t user_id, const char* name) {
     /* Cập nhật thông tin */
     strncpy(user->name, name, MAX_NAME_LENGTH - 1);
     user->name[MAX_NAME_LENGTH - 1] = '\0';
+    user_notify(list, USER_EVENT_UPDATED, user);
 
     return USER_OK;
 }
@@ -201,6 +344,14 @@ user_delete(user_list_t* list, uint32_t user_id) {
                 return USER_HAS_BORROWED_BOOKS;
             }
 
+            user_notify(list, USER_EVENT_DELETED, &list->users[i]);
+
+            /* Trả khối tràn (nếu còn) về pool */
+            if (list->users[i].borrowed_spill != 0) {
+                user_pool_free(list, list->users[i].borrowed_spill,
+                               user_pool_class(list->users[i].borrowed_capacity));
+            }
+
             /* Dịch chuyển các phần tử phía sau lên */
             if (i < list->count - 1) {
                 memmove(&list->users[i], &list->users[i + 1],
@@ -239,81 +390,310 @@ user_find_by_id(user_list_t* list, uint32_t user_id) {
 }
 
 /**
- * \brief           Thêm sách vào danh sách mượn của người dùng
- * \param[in,out]   user: Con trỏ tới người dùng
- * \param[in]       book_id: ID của sách cần thêm
+ * \brief           Đổi hạng người dùng
+ *
+ * Hạ hạng không thu hồi sách đang mượn, chỉ chặn các lượt mượn mới cho tới
+ * khi số sách về dưới giới hạn mới.
+ *
+ * \param[in,out]   list: Con trỏ tới danh sách người dùng
+ * \param[in]       user_id: ID của người dùng
+ * \param[in]       tier: Hạng mới
  * \return          \ref USER_OK nếu thành công, \ref user_status_t nếu lỗi
  */
 user_status_t
-user_add_borrowed_book(user_t* user, uint32_t book_id) {
+user_set_tier(user_list_t* list, uint32_t user_id, user_tier_t tier) {
+    user_t* user;
+
+    if (list == NULL || (size_t)tier >= USER_TIER_COUNT) {
+        return USER_INVALID_INPUT;
+    }
+
+    user = user_find_by_id(list, user_id);
     if (user == NULL) {
+        return USER_NOT_FOUND;
+    }
+
+    user->tier = tier;
+    user_notify(list, USER_EVENT_TIER_CHANGED, user);
+    return USER_OK;
+}
+
+/**
+ * \brief           Đăng ký observer nhận thông báo sau mỗi thay đổi danh sách
+ * \param[in,out]   list: Con trỏ tới danh sách người dùng
+ * \param[in]       observer: Hàm nhận thông báo (NULL = hủy đăng ký)
+ * \param[in]       ctx: Ngữ cảnh truyền cho observer
+ */
+void
+user_set_observer(user_list_t* list, user_observer_fn observer, void* ctx) {
+    if (list != NULL) {
+        list->observer = observer;
+        list->observer_ctx = ctx;
+    }
+}
+
+/**
+ * \brief           Số sách tối đa người dùng được mượn đồng thời
+ * \param[in]       user: Con trỏ tới người dùng
+ * \return          Giới hạn theo hạng, 0 nếu không hợp lệ
+ */
+size_t
+user_borrow_limit(const user_t* user) {
+    if (user == NULL) {
+        return 0;
+    }
+    return user_tier_limit(user->tier);
+}
+
+/**
+ * \brief           Số sách tối đa được mượn đồng thời của một hạng
+ * \param[in]       tier: Hạng người dùng
+ * \return          Giới hạn của hạng, 0 nếu không hợp lệ
+ */
+size_t
+user_tier_limit(user_tier_t tier) {
+    if ((size_t)tier >= USER_TIER_COUNT) {
+        return 0;
+    }
+    return user_tier_limits[tier];
+}
+
+/**
+ * \brief           Tên hiển thị của hạng người dùng
+ * \param[in]       tier: Hạng người dùng
+ * \return          Chuỗi tên hạng
+ */
+const char*
+user_tier_name(user_tier_t tier) {
+    switch (tier) {
+        case USER_TIER_STUDENT:
+            return "Sinh viên";
+        case USER_TIER_STAFF:
+            return "Cán bộ";
+        case USER_TIER_FACULTY:
+            return "Giảng viên";
+        default:
+            return "Không rõ";
+    }
+}
+
+/**
+ * \brief           Danh sách khóa item đang mượn (tăng dần), dài \ref user_t::borrowed_count
+ * \param[in]       list: Con trỏ tới danh sách chứa người dùng
+ * \param[in]       user: Con trỏ tới người dùng
+ * \return          Con trỏ tới mảng khóa, NULL nếu list hoặc user NULL
+ */
+const uint32_t*
+user_borrowed_items(const user_list_t* list, const user_t* user) {
+    if (list == NULL || user == NULL) {
+        return NULL;
+    }
+    return (user->borrowed_spill != 0) ? &list->loan_arena[user->borrowed_spill - 1] : user->borrowed_inline;
+}
+
+/**
+ * \brief           Thêm bản sao sách vào danh sách mượn của người dùng
+ *
+ * Khi mảng tại chỗ đầy, danh sách được chuyển sang khối pool có sức chứa gấp
+ * đôi. Khóa được chèn đúng vị trí để danh sách luôn tăng dần.
+ *
+ * \param[in,out]   list: Con trỏ tới danh sách chứa người dùng (sở hữu pool)
+ * \param[in,out]   user: Con trỏ tới người dùng
+ * \param[in]       item_key: Khóa item của bản sao, xem \ref BOOK_ITEM_KEY
+ * \return          \ref USER_OK nếu thành công, \ref user_status_t nếu lỗi
+ */
+user_status_t
+user_add_borrowed_book(user_list_t* list, user_t* user, uint32_t item_key) {
+    uint32_t* items;
+    uint32_t block;
+    size_t pos;
+    size_t new_capacity;
+
+    if (list == NULL || user == NULL) {
         return USER_INVALID_INPUT;
     }
 
-    /* Kiểm tra đã đạt giới hạn */
-    if (user->borrowed_count >= MAX_BORROWED_BOOKS) {
+    /* Kiểm tra đã đạt giới hạn theo hạng */
+    if (user->borrowed_count >= user_borrow_limit(user)) {
         return USER_BORROW_LIMIT_REACHED;
     }
 
-    /* Thêm sách vào danh sách */
-    user->borrowed_books[user->borrowed_count] = book_id;
+    /* Tăng sức chứa khi đầy */
+    if (user->borrowed_count >= user->borrowed_capacity) {
+        new_capacity = (user->borrowed_capacity < USER_LOAN_POOL_MIN_BLOCK)
+                       ? USER_LOAN_POOL_MIN_BLOCK : (size_t)user->borrowed_capacity * 2;
+        block = user_pool_alloc(list, user_pool_class(new_capacity));
+        if (block == 0) {
+            return USER_POOL_FULL;
+        }
+        memcpy(&list->loan_arena[block - 1], user_items_mut(list, user), user->borrowed_count * sizeof(uint32_t));
+        if (user->borrowed_spill != 0) {
+            user_pool_free(list, user->borrowed_spill, user_pool_class(user->borrowed_capacity));
+        }
+        user->borrowed_spill = block;
+        user->borrowed_capacity = (uint16_t)new_capacity;
+    }
+
+    /* Chèn giữ thứ tự tăng dần */
+    items = user_items_mut(list, user);
+    pos = user_lower_bound(items, user->borrowed_count, item_key);
+    if (pos < user->borrowed_count && items[pos] == item_key) {
+        return USER_ALREADY_EXISTS;
+    }
+    memmove(&items[pos + 1], &items[pos], (user->borrowed_count - pos) * sizeof(uint32_t));
+    items[pos] = item_key;
     user->borrowed_count++;
 
     return USER_OK;
 }
 
 /**
- * \brief           Xóa sách khỏi danh sách mượn của người dùng
+ * \brief           Xóa bản sao sách khỏi danh sách mượn của người dùng
+ * \param[in,out]   list: Con trỏ tới danh sách chứa người dùng (sở hữu pool)
  * \param[in,out]   user: Con trỏ tới người dùng
- * \param[in]       book_id: ID của sách cần xóa
+ * \param[in]       item_key: Khóa item của bản sao cần xóa
  * \return          \ref USER_OK nếu thành công, \ref user_status_t nếu lỗi
  */
 user_status_t
-user_remove_borrowed_book(user_t* user, uint32_t book_id) {
-    size_t i;
+user_remove_borrowed_book(user_list_t* list, user_t* user, uint32_t item_key) {
+    uint32_t* items;
+    uint32_t block;
+    size_t pos;
 
-    if (user == NULL) {
+    if (list == NULL || user == NULL) {
         return USER_INVALID_INPUT;
     }
 
-    /* Tìm và xóa sách */
-    for (i = 0; i < user->borrowed_count; i++) {
-        if (user->borrowed_books[i] == book_id) {
-            /* Dịch chuyển các phần tử phía sau lên */
-            if (i < user->borrowed_count - 1) {
-                memmove(&user->borrowed_books[i], &user->borrowed_books[i + 1],
-                        (user->borrowed_count - i - 1) * sizeof(uint32_t));
-            }
+    items = user_items_mut(list, user);
+    pos = user_lower_bound(items, user->borrowed_count, item_key);
+    if (pos >= user->borrowed_count || items[pos] != item_key) {
+        return USER_BOOK_NOT_BORROWED;
+    }
 
-            user->borrowed_count--;
-            return USER_OK;
-        }
+    /* Dịch chuyển các phần tử phía sau lên */
+    memmove(&items[pos], &items[pos + 1], (user->borrowed_count - pos - 1) * sizeof(uint32_t));
+    user->borrowed_count--;
+
+    /* Đủ nhỏ thì quay lại mảng tại chỗ và trả khối về pool */
+    if (user->borrowed_spill != 0 && user->borrowed_count <= USER_INLINE_LOANS) {
+        block = user->borrowed_spill;
+        memcpy(user->borrowed_inline, items, user->borrowed_count * sizeof(uint32_t));
+        user_pool_free(list, block, user_pool_class(user->borrowed_capacity));
+        user->borrowed_spill = 0;
+        user->borrowed_capacity = USER_INLINE_LOANS;
     }
 
-    return USER_BOOK_NOT_BORROWED;
+    return USER_OK;
 }
 
 /**
- * \brief           Kiểm tra người dùng có đang mượn sách hay không
- * \param[in]       user: Con trỏ tới người dùng
- * \param[in]       book_id: ID của sách cần kiểm tra
- * \return          1 nếu đang mượn, 0 nếu không mượn
+ * \brief           Cộng số khối pool cần cấp phát để đưa danh sách mượn về \p target khóa
+ *
+ * Mô phỏng đúng trình tự áp dụng một ảnh: bỏ trước các khóa không giữ lại
+ * (có thể trả khối và quay về mảng tại chỗ), sau đó thêm dần, mỗi lần đầy thì
+ * cấp khối lớp kế tiếp. Khối được trả trong quá trình này không được tính, nên
+ * kết quả là cận trên an toàn.
+ *
+ * \param[in]       user: Người dùng hiện tại, NULL nếu sẽ được tạo mới
+ * \param[in]       kept: Số khóa hiện có được giữ lại
+ * \param[in]       target: Số khóa sau khi áp dụng
+ * \param[in,out]   demand: Số khối cần của từng lớp (\ref USER_LOAN_POOL_CLASSES phần tử), được cộng dồn
+ * \return          \ref USER_OK nếu thành công, \ref USER_BORROW_LIMIT_REACHED nếu vượt lớp lớn nhất
+ */
+user_status_t
+user_loan_demand(const user_t* user, size_t kept, size_t target, size_t* demand) {
+    size_t capacity;
+    size_t cls;
+
+    if (demand == NULL) {
+        return USER_INVALID_INPUT;
+    }
+
+    capacity = USER_INLINE_LOANS;
+    if (user != NULL && user->borrowed_spill != 0
+        && !(kept < user->borrowed_count && kept <= USER_INLINE_LOANS)) {
+        capacity = user->borrowed_capacity;
+    }
+    while (capacity < target) {
+        capacity = (capacity < USER_LOAN_POOL_MIN_BLOCK) ? USER_LOAN_POOL_MIN_BLOCK : capacity * 2;
+        cls = user_pool_class(capacity);
+        if (cls >= USER_LOAN_POOL_CLASSES) {
+            return USER_BORROW_LIMIT_REACHED;
+        }
+        demand[cls]++;
+    }
+    return USER_OK;
+}
+
+/**
+ * \brief           Kiểm tra pool còn đủ khối cho nhu cầu đã tính bằng \ref user_loan_demand
+ * \param[in]       list: Con trỏ tới danh sách người dùng sở hữu pool
+ * \param[in]       demand: Số khối cần của từng lớp (\ref USER_LOAN_POOL_CLASSES phần tử)
+ * \return          1 nếu mọi khối đều cấp phát được, 0 nếu không
  */
 uint8_t
-user_has_borrowed_book(const user_t* user, uint32_t book_id) {
-    size_t i;
+user_loan_pool_fits(const user_list_t* list, const size_t* demand) {
+    size_t words;
+    size_t spare;
+    size_t cls;
+    uint32_t ref;
 
-    if (user == NULL) {
+    if (list == NULL || demand == NULL) {
         return 0;
     }
 
-    for (i = 0; i < user->borrowed_count; i++) {
-        if (user->borrowed_books[i] == book_id) {
-            return 1;
+    /* Khối trống cùng lớp dùng trước, phần còn lại lấy từ vùng chưa cấp */
+    words = 0;
+    for (cls = 0; cls < USER_LOAN_POOL_CLASSES; cls++) {
+        spare = 0;
+        for (ref = list->loan_free[cls]; ref != 0 && spare < demand[cls]; ref = list->loan_arena[ref - 1]) {
+            spare++;
+        }
+        words += (demand[cls] - spare) * ((size_t)USER_LOAN_POOL_MIN_BLOCK << cls);
+    }
+    return (list->loan_top + words <= USER_LOAN_POOL_WORDS) ? 1 : 0;
+}
+
+/**
+ * \brief           Tìm bản sao của một đầu sách trong danh sách mượn của người dùng
+ * \param[in]       list: Con trỏ tới danh sách chứa người dùng
+ * \param[in]       user: Con trỏ tới người dùng
+ * \param[in]       book_id: ID của sách
+ * \param[out]      item_key: Khóa item của bản sao đang mượn (có thể NULL)
+ * \return          \ref USER_OK nếu tìm thấy, \ref USER_BOOK_NOT_BORROWED nếu không
+ */
+user_status_t
+user_find_borrowed_item(const user_list_t* list, const user_t* user, uint32_t book_id, uint32_t* item_key) {
+    const uint32_t* items;
+    size_t pos;
+
+    if (list == NULL || user == NULL) {
+        return USER_INVALID_INPUT;
+    }
+
+    /* Khóa item sắp theo ID sách nên bản sao đầu tiên nằm tại lower_bound(copy 0) */
+    items = user_borrowed_items(list, user);
+    pos = user_lower_bound(items, user->borrowed_count, BOOK_ITEM_KEY(book_id, 0));
+    if (pos < user->borrowed_count && BOOK_ITEM_BOOK_ID(items[pos]) == book_id) {
+        if (item_key != NULL) {
+            *item_key = items[pos];
         }
+        return USER_OK;
     }
 
-    return 0;
+    return USER_BOOK_NOT_BORROWED;
+}
+
+/**
+ * \brief           Kiểm tra người dùng có đang mượn một bản của sách hay không
+ * \param[in]       list: Con trỏ tới danh sách chứa người dùng
+ * \param[in]       user: Con trỏ tới người dùng
+ * \param[in]       book_id: ID của sách cần kiểm tra
+ * \return          1 nếu đang mượn, 0 nếu không mượn
+ */
+uint8_t
+user_has_borrowed_book(const user_list_t* list, const user_t* user, uint32_t book_id) {
+    return (user_find_borrowed_item(list, user, book_id, NULL) == USER_OK) ? 1 : 0;
 }
 
 /**
@@ -334,51 +714,194 @@ user_display_one(const user_t* user) {
 
 /**
  * \brief           Hiển thị thông tin người dùng kèm danh sách sách đang mượn
+ * \param[in]       list: Con trỏ tới danh sách chứa người dùng
  * \param[in]       user: Con trỏ tới người dùng cần hiển thị
  */
 void
-user_display_with_books(const user_t* user) {
+user_display_with_books(const user_list_t* list, const user_t* user) {
+    const uint32_t* items;
     size_t i;
 
-    if (user == NULL) {
+    if (list == NULL || user == NULL) {
         return;
     }
 
     printf("\n  ID người dùng: %u\n", user->user_id);
     printf("  Tên: %s\n", user->name);
-    printf("  Số sách đang mượn: %zu/%d\n", user->borrowed_count, MAX_BORROWED_BOOKS);
+    printf("  Hạng: %s\n", user_tier_name(user->tier));
+    printf("  Số sách đang mượn: %zu/%zu\n", user->borrowed_count, user_borrow_limit(user));
 
     if (user->borrowed_count > 0) {
         printf("\n  Danh sách sách đang mượn:\n");
+        items = user_borrowed_items(list, user);
         for (i = 0; i < user->borrowed_count; i++) {
-            printf("    - ID sách: %u\n", user->borrowed_books[i]);
+            printf("    - ID sách: %u (bản sao #%u)\n",
+                   BOOK_ITEM_BOOK_ID(items[i]),
+                   (unsigned)BOOK_ITEM_COPY(items[i]) + 1);
         }
     } else {
         printf("\n  Chưa mượn sách nào.\n");
     }
 }
 
+/**
+ * \brief           Ngữ cảnh thu thập ID người dùng vào bộ đệm của người gọi
+ */
+typedef struct {
+    uint32_t* ids;                              /*!< Bộ đệm ID */
+    size_t capacity;                            /*!< Dung lượng bộ đệm */
+    size_t written;                             /*!< Số ID đã ghi */
+} user_collect_ctx_t;
+
+/**
+ * \brief           Hàm duyệt ghi ID vào bộ đệm, bỏ qua phần vượt dung lượng
+ * \param[in]       user: Người dùng khớp
+ * \param[in,out]   ctx: Con trỏ tới \ref user_collect_ctx_t
+ * \return          Luôn 1 để tiếp tục đếm tổng số kết quả
+ */
+static uint8_t
+user_collect_visit(const user_t* user, void* ctx) {
+    user_collect_ctx_t* collect;
+
+    collect = ctx;
+    if (collect->written < collect->capacity) {
+        collect->ids[collect->written++] = user->user_id;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Hàm duyệt in một dòng người dùng
+ * \param[in]       user: Người dùng khớp
+ * \param[in]       ctx: Không dùng
+ * \return          Luôn 1
+ */
+static uint8_t
+user_print_visit(const user_t* user, void* ctx) {
+    (void)ctx;
+    user_display_one(user);
+    return 1;
+}
+
+/**
+ * \brief           Duyệt người dùng theo thứ tự trong danh sách
+ * \param[in]       list: Con trỏ tới danh sách người dùng
+ * \param[in]       name: Chỉ lấy người dùng có tên chứa chuỗi này (NULL = mọi người dùng)
+ * \param[in]       visit: Hàm nhận từng người dùng khớp (NULL = chỉ đếm)
+ * \param[in,out]   ctx: Ngữ cảnh truyền cho \p visit
+ * \return          Số người dùng khớp đã duyệt (kể cả người dùng mà \p visit yêu cầu dừng)
+ */
+size_t
+user_query(const user_list_t* list, const char* name, user_visit_fn visit, void* ctx) {
+    char needle[MAX_STRING_LENGTH];
+    size_t matched;
+    size_t i;
+
+    if (list == NULL) {
+        return 0;
+    }
+    if (name != NULL) {
+        strncpy(needle, name, MAX_STRING_LENGTH - 1);
+        needle[MAX_STRING_LENGTH - 1] = '\0';
+        to_lowercase(needle);
+    }
+
+    matched = 0;
+    for (i = 0; i < list->count; i++) {
+        if (name != NULL && !string_contains_lower(list->users[i].name, needle)) {
+            continue;
+        }
+
+        matched++;
+        if (visit != NULL && !visit(&list->users[i], ctx)) {
+            break;
+        }
+    }
+
+    return matched;
+}
+
+/**
+ * \brief           Lấy ID người dùng vào bộ đệm của người gọi
+ * \param[in]       list: Con trỏ tới danh sách người dùng
+ * \param[in]       name: Lọc theo tên (NULL = mọi người dùng)
+ * \param[out]      ids: Bộ đệm nhận ID
+ * \param[in]       capacity: Số phần tử tối đa của \p ids
+ * \param[out]      total: Tổng số người dùng khớp (có thể NULL)
+ * \return          Số ID đã ghi
+ */
+size_t
+user_query_ids(const user_list_t* list, const char* name, uint32_t* ids,
+               size_t capacity, size_t* total) {
+    user_collect_ctx_t collect;
+    size_t matched;
+
+    collect.ids = ids;
+    collect.capacity = (ids != NULL) ? capacity : 0;
+    collect.written = 0;
+    matched = user_query(list, name, user_collect_visit, &collect);
+    if (total != NULL) {
+        *total = matched;
+    }
+    return collect.written;
+}
+
+/**
+ * \brief           Lấy một trang người dùng theo thứ tự trong danh sách
+ * \param[in]       list: Con trỏ tới danh sách người dùng
+ * \param[in]       offset: Số người dùng bỏ qua
+ * \param[out]      users: Bộ đệm nhận con trỏ (hợp lệ khi danh sách chưa bị sửa)
+ * \param[in]       capacity: Số phần tử tối đa của \p users
+ * \param[out]      more: 1 nếu còn người dùng sau trang (có thể NULL)
+ * \return          Số con trỏ đã ghi
+ */
+size_t
+user_query_page(const user_list_t* list, size_t offset, const user_t** users, size_t capacity,
+                uint8_t* more) {
+    size_t i;
+
+    if (more != NULL) {
+        *more = 0;
+    }
+    if (list == NULL || users == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < capacity && offset + i < list->count; i++) {
+        users[i] = &list->users[offset + i];
+    }
+    if (more != NULL) {
+        *more = (offset < list->count && list->count - offset > capacity);
+    }
+    return i;
+}
+
+/**
+ * \brief           In tiêu đề bảng danh sách người dùng (cột khớp với \ref user_display_one)
+ */
+void
+user_display_header(void) {
+    printf("\n  %-10s | %-40s | %-15s\n", "ID", "Tên", "Số sách mượn");
+    print_separator();
+}
+
 /**
  * \brief           Hiển thị tất cả người dùng trong danh sách
  * \param[in]       list: Con trỏ tới danh sách người dùng
  */
 void
 user_display_all(const user_list_t* list) {
-    size_t i;
+    size_t count;
 
     if (list == NULL || list->count == 0) {
         printf("\n  Danh sách người dùng trống!\n");
         return;
     }
 
-    printf("\n  %-10s | %-40s | %-15s\n", "ID", "Tên", "Số sách mượn");
-    print_separator();
-
-    for (i = 0; i < list->count; i++) {
-        user_display_one(&list->users[i]);
-    }
+    user_display_header();
+    count = user_query(list, NULL, user_print_visit, NULL);
 
-    printf("\n  Tổng số người dùng: %zu\n", list->count);
+    printf("\n  Tổng số người dùng: %zu\n", count);
 }
 
 /**
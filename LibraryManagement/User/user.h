@@ -45,7 +45,34 @@ extern "C" {
 /* Định nghĩa các hằng số */
 #define MAX_NAME_LENGTH             256
 #define MAX_USERS                   500
-#define MAX_BORROWED_BOOKS          5
+#define USER_INLINE_LOANS           4           /*!< Số khóa item lưu tại chỗ trong \ref user_t */
+#define USER_LINEAR_SCAN_MAX        8           /*!< Trên ngưỡng này tìm kiếm nhị phân thay vì duyệt tuyến tính */
+#define USER_LOAN_POOL_MIN_BLOCK    8           /*!< Khối tràn nhỏ nhất: 8 khóa item */
+#define USER_LOAN_POOL_CLASSES      6           /*!< Số lớp kích thước khối tràn: 8, 16, ..., 256 */
+
+/*
+ * Dung lượng pool khối tràn (số phần tử uint32_t). Mỗi người dùng giữ nhiều
+ * nhất một khối và khối mới chỉ được cắt từ vùng chưa cấp khi danh sách trống
+ * của lớp đó rỗng, nên mỗi lớp không bao giờ cần quá MAX_USERS khối: đủ chỗ
+ * cho MAX_USERS khối ở mọi lớp thì pool không thể cạn với người dùng hợp lệ.
+ */
+#define USER_LOAN_POOL_WORDS        ((size_t)MAX_USERS * USER_LOAN_POOL_MIN_BLOCK * ((1u << USER_LOAN_POOL_CLASSES) - 1))
+
+/* Giới hạn số sách mượn theo hạng người dùng */
+#define USER_LIMIT_STUDENT          5
+#define USER_LIMIT_STAFF            20
+#define USER_LIMIT_FACULTY          200
+#define USER_MAX_LOANS              USER_LIMIT_FACULTY
+
+/**
+ * \brief           Hạng người dùng, quyết định số sách được mượn đồng thời
+ */
+typedef enum {
+    USER_TIER_STUDENT = 0,                      /*!< Sinh viên */
+    USER_TIER_STAFF,                            /*!< Cán bộ */
+    USER_TIER_FACULTY,                          /*!< Giảng viên */
+    USER_TIER_COUNT,
+} user_tier_t;
 
 /**
  * \brief           Trạng thái trả về của các hàm quản lý người dùng
@@ -60,27 +87,75 @@ typedef enum {
     USER_HAS_BORROWED_BOOKS,                    /*!< Người dùng đang mượn sách */
     USER_BORROW_LIMIT_REACHED,                  /*!< Đã đạt giới hạn số sách mượn */
     USER_BOOK_NOT_BORROWED,                     /*!< Sách không có trong danh sách mượn */
+    USER_POOL_FULL,                             /*!< Pool khối tràn đã hết */
 } user_status_t;
 
 /**
  * \brief           Cấu trúc dữ liệu của một người dùng
+ *
+ * Danh sách mượn là một small-vector luôn được sắp xếp tăng dần theo khóa
+ * item: tối đa \ref USER_INLINE_LOANS khóa nằm ngay trong bản ghi, vượt quá
+ * thì chuyển sang một khối lấy từ pool của \ref user_list_t chứa người dùng.
+ * Khối được tham chiếu bằng offset nên chỉ có nghĩa trong danh sách đó; dùng
+ * \ref user_borrowed_items để đọc.
  */
 typedef struct {
     uint32_t user_id;                           /*!< ID duy nhất của người dùng */
     char name[MAX_NAME_LENGTH];                 /*!< Tên người dùng */
-    uint32_t borrowed_books[MAX_BORROWED_BOOKS];/*!< Danh sách ID sách đã mượn */
+    user_tier_t tier;                           /*!< Hạng người dùng */
     size_t borrowed_count;                      /*!< Số lượng sách đang mượn */
+    uint32_t borrowed_inline[USER_INLINE_LOANS];/*!< Khóa item lưu tại chỗ khi còn ít */
+    uint32_t borrowed_spill;                    /*!< Offset + 1 của khối tràn trong pool, 0 khi dùng mảng tại chỗ */
+    uint16_t borrowed_capacity;                 /*!< Sức chứa hiện tại của danh sách mượn */
 } user_t;
 
+/**
+ * \brief           Loại thay đổi được báo cho observer của danh sách người dùng
+ *
+ * Thay đổi danh sách mượn không được báo ở đây vì các hàm mượn/trả làm việc
+ * trên \ref user_t; tầng quản lý mượn/trả tự ghi nhận.
+ */
+typedef enum {
+    USER_EVENT_ADDED = 0,                       /*!< Thêm người dùng mới */
+    USER_EVENT_UPDATED,                         /*!< Đổi tên người dùng */
+    USER_EVENT_DELETED,                         /*!< Xóa người dùng (bản ghi ngay trước khi xóa) */
+    USER_EVENT_TIER_CHANGED,                    /*!< Đổi hạng người dùng */
+} user_event_t;
+
+/**
+ * \brief           Hàm nhận thông báo sau mỗi thay đổi danh sách người dùng
+ * \param[in]       event: Loại thay đổi
+ * \param[in]       user: Người dùng bị thay đổi
+ * \param[in,out]   ctx: Ngữ cảnh đăng ký cùng observer
+ */
+typedef void (*user_observer_fn)(user_event_t event, const user_t* user, void* ctx);
+
 /**
  * \brief           Cấu trúc quản lý danh sách người dùng
+ *
+ * Mỗi danh sách có pool khối tràn riêng: vùng nhớ cấp phát kiểu bump pointer
+ * cộng danh sách khối trống cho từng lớp kích thước, nên các danh sách khác
+ * nhau (shard, bản sao, công cụ) không dùng chung trạng thái cấp phát.
  */
 typedef struct {
     user_t users[MAX_USERS];                    /*!< Mảng chứa các người dùng */
     size_t count;                               /*!< Số lượng người dùng hiện tại */
     uint32_t next_id;                           /*!< ID tiếp theo sẽ được gán */
+    user_observer_fn observer;                  /*!< Nhận thông báo thay đổi (NULL = không có) */
+    void* observer_ctx;                         /*!< Ngữ cảnh truyền cho observer */
+    uint32_t loan_arena[USER_LOAN_POOL_WORDS];  /*!< Vùng nhớ của pool khối tràn */
+    size_t loan_top;                            /*!< Số phần tử đã cấp phát từ đầu vùng nhớ */
+    uint32_t loan_free[USER_LOAN_POOL_CLASSES]; /*!< Đầu danh sách khối trống (offset + 1, 0 = rỗng) */
 } user_list_t;
 
+/**
+ * \brief           Hàm nhận từng người dùng khớp bộ lọc
+ * \param[in]       user: Người dùng khớp (chỉ hợp lệ khi danh sách chưa bị sửa)
+ * \param[in,out]   ctx: Ngữ cảnh do người gọi truyền vào
+ * \return          1 để tiếp tục duyệt, 0 để dừng
+ */
+typedef uint8_t (*user_visit_fn)(const user_t* user, void* ctx);
+
 /* Khai báo các hàm quản lý người dùng */
 void            user_init(user_list_t* list);
 user_status_t   user_add(user_list_t* list, const char* name, uint32_t* assigned_id);
@@ -88,14 +163,31 @@ user_status_t   user_add_with_id(user_list_t* list, uint32_t user_id, const char
 user_status_t   user_update(user_list_t* list, uint32_t user_id, const char* name);
 user_status_t   user_delete(user_list_t* list, uint32_t user_id);
 user_t*         user_find_by_id(user_list_t* list, uint32_t user_id);
+user_status_t   user_set_tier(user_list_t* list, uint32_t user_id, user_tier_t tier);
+void            user_set_observer(user_list_t* list, user_observer_fn observer, void* ctx);
+size_t          user_borrow_limit(const user_t* user);
+size_t          user_tier_limit(user_tier_t tier);
+const char*     user_tier_name(user_tier_t tier);
+
+user_status_t   user_add_borrowed_book(user_list_t* list, user_t* user, uint32_t item_key);
+user_status_t   user_remove_borrowed_book(user_list_t* list, user_t* user, uint32_t item_key);
+uint8_t         user_has_borrowed_book(const user_list_t* list, const user_t* user, uint32_t book_id);
+user_status_t   user_find_borrowed_item(const user_list_t* list, const user_t* user, uint32_t book_id,
+                                        uint32_t* item_key);
+const uint32_t* user_borrowed_items(const user_list_t* list, const user_t* user);
+user_status_t   user_loan_demand(const user_t* user, size_t kept, size_t target, size_t* demand);
+uint8_t         user_loan_pool_fits(const user_list_t* list, const size_t* demand);
 
-user_status_t   user_add_borrowed_book(user_t* user, uint32_t book_id);
-user_status_t   user_remove_borrowed_book(user_t* user, uint32_t book_id);
-uint8_t         user_has_borrowed_book(const user_t* user, uint32_t book_id);
+size_t          user_query(const user_list_t* list, const char* name, user_visit_fn visit, void* ctx);
+size_t          user_query_ids(const user_list_t* list, const char* name, uint32_t* ids,
+                               size_t capacity, size_t* total);
+size_t          user_query_page(const user_list_t* list, size_t offset, const user_t** users, size_t capacity,
+                                uint8_t* more);
 
+void            user_display_header(void);
 void            user_display_all(const user_list_t* list);
 void            user_display_one(const user_t* user);
-void            user_display_with_books(const user_t* user);
+void            user_display_with_books(const user_list_t* list, const user_t* user);
 
 size_t          user_count_total(const user_list_t* list);
 
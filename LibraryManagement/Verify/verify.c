@@ -0,0 +1,763 @@
+/**
+ * \file            verify.c
+ * \brief           Kiểm tra nhất quán mượn/trả: chụp snapshot, merge-join song song, kế hoạch sửa
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#include <string.h>
+#include <time.h>
+#include "verify.h"
+
+#define VERIFY_ORDER_ID(entry)      ((uint32_t)((entry) >> 32))
+#define VERIFY_ORDER_POS(entry)     ((uint32_t)(entry))
+
+/**
+ * \brief           Đồng hồ tính thời gian kiểm tra
+ * \return          Số nano giây
+ */
+static uint64_t
+verify_clock_ns(void) {
+    struct timespec now;
+
+    if (timespec_get(&now, TIME_UTC) != TIME_UTC) {
+        return 0;
+    }
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief           Sắp xếp cơ số ổn định theo 32 bit cao (4 lượt 8 bit, bỏ qua nếu đã có thứ tự)
+ * \param[in,out]   keys: Các phần tử (ID hoặc khóa << 32 | vị trí)
+ * \param[in]       buffer: Vùng đệm cùng kích thước
+ * \param[in]       count: Số phần tử
+ */
+static void
+verify_sort(uint64_t* keys, uint64_t* buffer, size_t count) {
+    size_t counts[256];
+    uint64_t* from;
+    uint64_t* to;
+    uint64_t* swap;
+    uint32_t shift;
+    size_t digit;
+    size_t sum;
+    size_t i;
+
+    /* ID thường được cấp tăng dần nên danh sách hay đã có thứ tự sẵn */
+    for (i = 1; i < count && (keys[i - 1] >> 32) <= (keys[i] >> 32); i++) {
+    }
+    if (i >= count) {
+        return;
+    }
+
+    from = keys;
+    to = buffer;
+    for (shift = 32; shift < 64; shift += 8) {
+        memset(counts, 0, sizeof(counts));
+        for (i = 0; i < count; i++) {
+            counts[(from[i] >> shift) & 0xFF]++;
+        }
+        sum = 0;
+        for (i = 0; i < 256; i++) {
+            digit = counts[i];
+            counts[i] = sum;
+            sum += digit;
+        }
+        for (i = 0; i < count; i++) {
+            to[counts[(from[i] >> shift) & 0xFF]++] = from[i];
+        }
+        swap = from;
+        from = to;
+        to = swap;
+    }
+    /* Số lượt chẵn nên kết quả đã nằm lại trong keys */
+}
+
+/**
+ * \brief           Ghi nhận một lỗi vào vùng của luồng
+ * \param[in,out]   verify: Bộ kiểm tra
+ * \param[in]       worker: Chỉ số luồng
+ * \param[in]       kind: Loại lỗi
+ * \param[in]       action: Bước sửa đề xuất
+ * \param[in]       book_id: ID sách (0 = không có)
+ * \param[in]       user_id: ID người dùng (0 = không có)
+ * \param[in]       item_key: Khóa item (0 = không có)
+ * \param[in]       expected: Giá trị đúng
+ * \param[in]       actual: Giá trị đang có
+ */
+static void
+verify_report(verify_t* verify, uint32_t worker, verify_issue_kind_t kind, verify_action_t action,
+              uint32_t book_id, uint32_t user_id, uint32_t item_key, uint32_t expected, uint32_t actual) {
+    verify_issue_t* issue;
+
+    verify->worker_issue_total[worker]++;
+    if (verify->worker_issue_count[worker] >= VERIFY_WORKER_ISSUES) {
+        return;
+    }
+    issue = &verify->worker_issues[worker][verify->worker_issue_count[worker]++];
+    issue->kind = (uint8_t)kind;
+    issue->action = (uint8_t)action;
+    issue->book_id = book_id;
+    issue->user_id = user_id;
+    issue->item_key = item_key;
+    issue->expected = expected;
+    issue->actual = actual;
+}
+
+/**
+ * \brief           Vị trí bắt đầu của một phân đoạn sách
+ *
+ * Các bản ghi trùng ID luôn nằm trọn trong một phân đoạn để lượt mượn của ID đó
+ * chỉ được so khớp một lần.
+ *
+ * \param[in]       verify: Bộ kiểm tra
+ * \param[in]       chunk: Chỉ số phân đoạn
+ * \return          Vị trí đầu tiên trong \ref verify_t::book_order
+ */
+static size_t
+verify_chunk_start(const verify_t* verify, uint32_t chunk) {
+    size_t start;
+
+    start = (size_t)chunk * VERIFY_CHUNK_BOOKS;
+    if (start >= verify->book_count) {
+        return verify->book_count;
+    }
+    while (start > 0 && start < verify->book_count
+           && VERIFY_ORDER_ID(verify->book_order[start]) == VERIFY_ORDER_ID(verify->book_order[start - 1])) {
+        start++;
+    }
+    return start;
+}
+
+/**
+ * \brief           Tìm lượt mượn đầu tiên có khóa item không nhỏ hơn \p key
+ * \param[in]       verify: Bộ kiểm tra
+ * \param[in]       key: Khóa item
+ * \return          Vị trí trong \ref verify_t::loan_order
+ */
+static size_t
+verify_loan_lower_bound(const verify_t* verify, uint64_t key) {
+    size_t low;
+    size_t high;
+    size_t mid;
+
+    low = 0;
+    high = verify->loan_count;
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (VERIFY_ORDER_ID(verify->loan_order[mid]) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * \brief           ID người dùng sở hữu một lượt mượn trong snapshot
+ * \param[in]       verify: Bộ kiểm tra
+ * \param[in]       loan: Vị trí trong \ref verify_t::loan_order
+ * \return          ID người dùng
+ */
+static uint32_t
+verify_loan_user(const verify_t* verify, size_t loan) {
+    return verify->users[VERIFY_ORDER_POS(verify->loan_order[loan])].user_id;
+}
+
+/**
+ * \brief           Kiểm tra một phân đoạn sách và các lượt mượn thuộc dải ID của nó
+ *
+ * Phân đoạn sở hữu mọi khóa item từ sách đầu tiên của nó tới trước sách đầu
+ * tiên của phân đoạn kế tiếp (phân đoạn đầu và cuối mở rộng tới hai biên),
+ * nên lượt mượn trỏ tới sách không tồn tại cũng được đúng một phân đoạn xử lý.
+ *
+ * \param[in,out]   verify: Bộ kiểm tra
+ * \param[in]       worker: Chỉ số luồng
+ * \param[in]       chunk: Chỉ số phân đoạn
+ */
+static void
+verify_book_chunk(verify_t* verify, uint32_t worker, uint32_t chunk) {
+    const verify_book_t* book;
+    uint64_t limit;
+    uint64_t valid;
+    uint64_t unowned;
+    uint64_t bit;
+    uint32_t book_id;
+    uint32_t item_key;
+    uint32_t available;
+    uint32_t copy;
+    size_t begin;
+    size_t end;
+    size_t loan;
+    size_t group;
+    size_t owner;
+    size_t i;
+
+    begin = verify_chunk_start(verify, chunk);
+    end = verify_chunk_start(verify, chunk + 1);
+    if (begin >= end && verify->book_count > 0) {
+        return;
+    }
+    limit = (end < verify->book_count)
+            ? BOOK_ITEM_KEY(VERIFY_ORDER_ID(verify->book_order[end]), 0)
+            : (uint64_t)UINT32_MAX + 1;
+    loan = (chunk == 0)
+           ? 0
+           : verify_loan_lower_bound(verify, BOOK_ITEM_KEY(VERIFY_ORDER_ID(verify->book_order[begin]), 0));
+
+    for (i = begin; i < end; i++) {
+        book = &verify->books[VERIFY_ORDER_POS(verify->book_order[i])];
+        book_id = book->book_id;
+
+        /* Bất biến của bản ghi sách */
+        if (i > 0 && VERIFY_ORDER_ID(verify->book_order[i - 1]) == book_id) {
+            verify_report(verify, worker, VERIFY_ISSUE_DUPLICATE_BOOK_ID, VERIFY_ACTION_MANUAL, book_id, 0, 0, 1, 2);
+            continue;
+        }
+        if (book_id == 0 || book_id >= verify->book_next_id) {
+            verify_report(verify, worker, VERIFY_ISSUE_BOOK_ID_RANGE,
+                          (book_id == 0) ? VERIFY_ACTION_MANUAL : VERIFY_ACTION_RAISE_NEXT_ID, book_id, 0, 0,
+                          book_id + 1, verify->book_next_id);
+        }
+        if (book->copy_count == 0 || book->copy_count > MAX_COPIES_PER_BOOK) {
+            verify_report(verify, worker, VERIFY_ISSUE_COPY_COUNT, VERIFY_ACTION_MANUAL, book_id, 0, 0,
+                          MAX_COPIES_PER_BOOK, book->copy_count);
+        }
+        valid = (book->copy_count >= MAX_COPIES_PER_BOOK) ? UINT64_MAX : (((uint64_t)1 << book->copy_count) - 1);
+        if ((book->available_mask & ~valid) != 0) {
+            verify_report(verify, worker, VERIFY_ISSUE_MASK_RANGE, VERIFY_ACTION_RECOUNT_BOOK, book_id, 0, 0,
+                          book->copy_count, 64u - (uint32_t)__builtin_clzll(book->available_mask));
+        }
+        available = (uint32_t)__builtin_popcountll(book->available_mask & valid);
+        if (available != book->available_count) {
+            verify_report(verify, worker, VERIFY_ISSUE_AVAILABLE_COUNT, VERIFY_ACTION_RECOUNT_BOOK, book_id, 0, 0,
+                          available, book->available_count);
+        }
+        if (book->is_borrowed != (available == 0)) {
+            verify_report(verify, worker, VERIFY_ISSUE_BORROWED_FLAG, VERIFY_ACTION_RECOUNT_BOOK, book_id, 0, 0,
+                          (available == 0), book->is_borrowed);
+        }
+
+        /* Lượt mượn có khóa nhỏ hơn sách này trỏ tới sách không tồn tại */
+        while (loan < verify->loan_count && VERIFY_ORDER_ID(verify->loan_order[loan]) < BOOK_ITEM_KEY(book_id, 0)) {
+            item_key = VERIFY_ORDER_ID(verify->loan_order[loan]);
+            verify_report(verify, worker, VERIFY_ISSUE_LOAN_UNKNOWN_COPY, VERIFY_ACTION_DROP_LOAN,
+                          BOOK_ITEM_BOOK_ID(item_key), verify_loan_user(verify, loan), item_key, 0, 0);
+            loan++;
+        }
+
+        /* Merge-join bản sao đang mượn với nhóm lượt mượn cùng khóa item */
+        unowned = valid & ~book->available_mask;
+        while (loan < verify->loan_count
+               && VERIFY_ORDER_ID(verify->loan_order[loan]) < (uint64_t)BOOK_ITEM_KEY(book_id, 0) + MAX_COPIES_PER_BOOK) {
+            item_key = VERIFY_ORDER_ID(verify->loan_order[loan]);
+            copy = BOOK_ITEM_COPY(item_key);
+            for (group = loan; group < verify->loan_count && VERIFY_ORDER_ID(verify->loan_order[group]) == item_key;
+                 group++) {
+            }
+            if (copy >= book->copy_count) {
+                for (owner = loan; owner < group; owner++) {
+                    verify_report(verify, worker, VERIFY_ISSUE_LOAN_UNKNOWN_COPY, VERIFY_ACTION_DROP_LOAN, book_id,
+                                  verify_loan_user(verify, owner), item_key, book->copy_count, copy);
+                }
+            } else {
+                bit = (uint64_t)1 << copy;
+                if (book->available_mask & bit) {
+                    verify_report(verify, worker, VERIFY_ISSUE_LOAN_COPY_AVAILABLE, VERIFY_ACTION_MARK_BORROWED,
+                                  book_id, verify_loan_user(verify, loan), item_key, 0, 1);
+                }
+                unowned &= ~bit;
+                /* Giữ lượt mượn đầu tiên (người dùng đứng trước trong danh sách), bỏ các lượt còn lại */
+                for (owner = loan + 1; owner < group; owner++) {
+                    verify_report(verify, worker, VERIFY_ISSUE_COPY_MANY_OWNERS, VERIFY_ACTION_DROP_LOAN, book_id,
+                                  verify_loan_user(verify, owner), item_key, 1, (uint32_t)(group - loan));
+                }
+            }
+            loan = group;
+        }
+        while (unowned != 0) {
+            copy = (uint32_t)__builtin_ctzll(unowned);
+            unowned &= unowned - 1;
+            verify_report(verify, worker, VERIFY_ISSUE_COPY_NO_OWNER, VERIFY_ACTION_RELEASE_COPY, book_id, 0,
+                          BOOK_ITEM_KEY(book_id, copy), 1, 0);
+        }
+    }
+
+    /* Khóa item giữa sách cuối của phân đoạn và sách đầu của phân đoạn kế tiếp */
+    while (loan < verify->loan_count && VERIFY_ORDER_ID(verify->loan_order[loan]) < limit) {
+        item_key = VERIFY_ORDER_ID(verify->loan_order[loan]);
+        verify_report(verify, worker, VERIFY_ISSUE_LOAN_UNKNOWN_COPY, VERIFY_ACTION_DROP_LOAN,
+                      BOOK_ITEM_BOOK_ID(item_key), verify_loan_user(verify, loan), item_key, 0, 0);
+        loan++;
+    }
+}
+
+/**
+ * \brief           Kiểm tra một phân đoạn người dùng
+ * \param[in,out]   verify: Bộ kiểm tra
+ * \param[in]       worker: Chỉ số luồng
+ * \param[in]       chunk: Chỉ số phân đoạn (tính từ phân đoạn người dùng đầu tiên)
+ */
+static void
+verify_user_chunk(verify_t* verify, uint32_t worker, uint32_t chunk) {
+    const verify_user_t* user;
+    const uint32_t* loans;
+    uint32_t user_id;
+    uint8_t sorted;
+    size_t begin;
+    size_t end;
+    size_t i;
+    size_t j;
+
+    begin = (size_t)chunk * VERIFY_CHUNK_USERS;
+    end = begin + VERIFY_CHUNK_USERS;
+    if (end > verify->user_count) {
+        end = verify->user_count;
+    }
+    for (i = begin; i < end; i++) {
+        user = &verify->users[VERIFY_ORDER_POS(verify->user_order[i])];
+        user_id = user->user_id;
+        if (i > 0 && VERIFY_ORDER_ID(verify->user_order[i - 1]) == user_id) {
+            verify_report(verify, worker, VERIFY_ISSUE_DUPLICATE_USER_ID, VERIFY_ACTION_MANUAL, 0, user_id, 0, 1, 2);
+        }
+        if (user_id == 0 || user_id >= verify->user_next_id) {
+            verify_report(verify, worker, VERIFY_ISSUE_USER_ID_RANGE,
+                          (user_id == 0) ? VERIFY_ACTION_MANUAL : VERIFY_ACTION_RAISE_NEXT_ID, 0, user_id, 0,
+                          user_id + 1, verify->user_next_id);
+        }
+        if (user->borrowed_count > user->capacity) {
+            verify_report(verify, worker, VERIFY_ISSUE_LOAN_COUNT, VERIFY_ACTION_MANUAL, 0, user_id, 0,
+                          user->capacity, user->borrowed_count);
+        }
+
+        loans = &verify->loans[user->first_loan];
+        sorted = 1;
+        for (j = 1; j < user->loan_count; j++) {
+            if (loans[j] <= loans[j - 1]) {
+                verify_report(verify, worker, VERIFY_ISSUE_LOANS_UNSORTED, VERIFY_ACTION_REBUILD_LOANS,
+                              BOOK_ITEM_BOOK_ID(loans[j]), user_id, loans[j], loans[j - 1], loans[j]);
+                sorted = 0;
+                break;
+            }
+        }
+        /* Danh sách tăng dần nên hai bản sao cùng đầu sách nằm cạnh nhau */
+        for (j = 1; sorted && j < user->loan_count; j++) {
+            if (BOOK_ITEM_BOOK_ID(loans[j]) == BOOK_ITEM_BOOK_ID(loans[j - 1])) {
+                verify_report(verify, worker, VERIFY_ISSUE_SAME_TITLE, VERIFY_ACTION_MANUAL,
+                              BOOK_ITEM_BOOK_ID(loans[j]), user_id, loans[j], 1, 2);
+            }
+        }
+    }
+}
+
+/**
+ * \brief           Hàm xử lý một phân đoạn cho pool quét
+ * \param[in,out]   ctx: Con trỏ tới \ref verify_t
+ * \param[in]       worker: Chỉ số luồng
+ * \param[in]       chunk: Chỉ số phân đoạn (sách trước, người dùng sau)
+ */
+static void
+verify_chunk(void* ctx, uint32_t worker, uint32_t chunk) {
+    verify_t* verify;
+
+    verify = ctx;
+    if (chunk < verify->book_chunks) {
+        verify_book_chunk(verify, worker, chunk);
+    } else {
+        verify_user_chunk(verify, worker, chunk - verify->book_chunks);
+    }
+}
+
+/**
+ * \brief           So sánh hai lỗi theo sách, người dùng, khóa item rồi loại lỗi
+ * \param[in]       a: Lỗi thứ nhất
+ * \param[in]       b: Lỗi thứ hai
+ * \return          Âm, 0 hoặc dương
+ */
+static int
+verify_issue_compare(const verify_issue_t* a, const verify_issue_t* b) {
+    if (a->book_id != b->book_id) {
+        return (a->book_id < b->book_id) ? -1 : 1;
+    }
+    if (a->user_id != b->user_id) {
+        return (a->user_id < b->user_id) ? -1 : 1;
+    }
+    if (a->item_key != b->item_key) {
+        return (a->item_key < b->item_key) ? -1 : 1;
+    }
+    return (int)a->kind - (int)b->kind;
+}
+
+/**
+ * \brief           Khởi tạo bộ kiểm tra
+ * \param[out]      verify: Bộ kiểm tra
+ */
+void
+verify_init(verify_t* verify) {
+    if (verify == NULL) {
+        return;
+    }
+    verify->book_count = 0;
+    verify->user_count = 0;
+    verify->loan_count = 0;
+    verify->issue_count = 0;
+    verify->issue_total = 0;
+    memset(&verify->stats, 0, sizeof(verify->stats));
+}
+
+/**
+ * \brief           Chụp snapshot phần trạng thái mượn của thư viện
+ *
+ * Phải chạy trên luồng sở hữu thư viện (hoặc khi đang giữ khóa của nó); chỉ
+ * đọc vài trường mỗi bản ghi nên rẻ hơn nhiều so với chép cả danh sách.
+ *
+ * \param[in,out]   verify: Bộ kiểm tra
+ * \param[in]       library: Thư viện
+ * \return          \ref VERIFY_OK nếu thành công
+ */
+verify_status_t
+verify_capture(verify_t* verify, const library_t* library) {
+    const book_t* book;
+    const user_t* user;
+    const uint32_t* items;
+    verify_book_t* out_book;
+    verify_user_t* out_user;
+    uint64_t started;
+    size_t count;
+    size_t i;
+    size_t j;
+
+    if (verify == NULL || library == NULL || library->books == NULL || library->users == NULL) {
+        return VERIFY_INVALID_INPUT;
+    }
+    started = verify_clock_ns();
+
+    verify->book_count = library->books->count;
+    verify->book_next_id = library->books->next_id;
+    for (i = 0; i < verify->book_count; i++) {
+        book = &library->books->books[i];
+        out_book = &verify->books[i];
+        out_book->available_mask = book->available_mask;
+        out_book->book_id = book->book_id;
+        out_book->copy_count = book->copy_count;
+        out_book->available_count = book->available_count;
+        out_book->is_borrowed = book->is_borrowed;
+        verify->book_order[i] = ((uint64_t)book->book_id << 32) | (uint32_t)i;
+    }
+
+    verify->user_count = library->users->count;
+    verify->user_next_id = library->users->next_id;
+    verify->loan_count = 0;
+    for (i = 0; i < verify->user_count; i++) {
+        user = &library->users->users[i];
+        out_user = &verify->users[i];
+        out_user->user_id = user->user_id;
+        out_user->borrowed_count = (uint32_t)user->borrowed_count;
+        out_user->capacity = user->borrowed_capacity;
+        out_user->first_loan = (uint32_t)verify->loan_count;
+
+        /* Không đọc quá sức chứa dù borrowed_count hỏng */
+        count = user->borrowed_count;
+        if (count > user->borrowed_capacity) {
+            count = user->borrowed_capacity;
+        }
+        if (count > VERIFY_MAX_LOANS - verify->loan_count) {
+            count = VERIFY_MAX_LOANS - verify->loan_count;
+        }
+        items = user_borrowed_items(library->users, user);
+        for (j = 0; j < count; j++) {
+            verify->loans[verify->loan_count] = items[j];
+            verify->loan_order[verify->loan_count] = ((uint64_t)items[j] << 32) | (uint32_t)i;
+            verify->loan_count++;
+        }
+        out_user->loan_count = (uint32_t)count;
+        verify->user_order[i] = ((uint64_t)user->user_id << 32) | (uint32_t)i;
+    }
+
+    verify->stats.capture_ns = verify_clock_ns() - started;
+    return VERIFY_OK;
+}
+
+/**
+ * \brief           Kiểm tra snapshot đã chụp, song song theo phân đoạn
+ * \param[in,out]   verify: Bộ kiểm tra (đã gọi \ref verify_capture)
+ * \param[in]       pool: Pool quét (NULL = chạy trên luồng gọi)
+ * \return          \ref VERIFY_OK nếu nhất quán, \ref VERIFY_INCONSISTENT nếu có lỗi
+ */
+verify_status_t
+verify_check(verify_t* verify, scan_pool_t* pool) {
+    verify_issue_t swap;
+    uint64_t started;
+    uint32_t user_chunks;
+    uint32_t workers;
+    uint32_t chunk;
+    size_t count;
+    size_t i;
+    size_t j;
+    uint32_t w;
+
+    if (verify == NULL) {
+        return VERIFY_INVALID_INPUT;
+    }
+    started = verify_clock_ns();
+
+    /* Sắp xếp tuần tự: chi phí tuyến tính, nhỏ so với phần so khớp */
+    verify_sort(verify->book_order, verify->sort_buffer, verify->book_count);
+    verify_sort(verify->user_order, verify->sort_buffer, verify->user_count);
+    verify_sort(verify->loan_order, verify->sort_buffer, verify->loan_count);
+
+    workers = (pool != NULL) ? pool->worker_count : 1;
+    for (w = 0; w < workers; w++) {
+        verify->worker_issue_count[w] = 0;
+        verify->worker_issue_total[w] = 0;
+    }
+    verify->book_chunks = (uint32_t)((verify->book_count + VERIFY_CHUNK_BOOKS - 1) / VERIFY_CHUNK_BOOKS);
+    if (verify->book_chunks == 0) {
+        /* Không có sách: vẫn cần một phân đoạn để báo các lượt mượn mồ côi */
+        verify->book_chunks = 1;
+    }
+    user_chunks = (uint32_t)((verify->user_count + VERIFY_CHUNK_USERS - 1) / VERIFY_CHUNK_USERS);
+    if (pool != NULL) {
+        scan_pool_run(pool, verify->book_chunks + user_chunks, verify_chunk, verify);
+    } else {
+        for (chunk = 0; chunk < verify->book_chunks + user_chunks; chunk++) {
+            verify_chunk(verify, 0, chunk);
+        }
+    }
+
+    /* Gộp lỗi của các luồng rồi sắp xếp (sắp xếp chèn: số lỗi giữ lại nhỏ) */
+    verify->issue_count = 0;
+    verify->issue_total = 0;
+    for (w = 0; w < workers; w++) {
+        verify->issue_total += verify->worker_issue_total[w];
+        for (i = 0; i < verify->worker_issue_count[w] && verify->issue_count < VERIFY_MAX_ISSUES; i++) {
+            verify->issues[verify->issue_count++] = verify->worker_issues[w][i];
+        }
+    }
+    count = verify->issue_count;
+    for (i = 1; i < count; i++) {
+        swap = verify->issues[i];
+        for (j = i; j > 0 && verify_issue_compare(&verify->issues[j - 1], &swap) > 0; j--) {
+            verify->issues[j] = verify->issues[j - 1];
+        }
+        verify->issues[j] = swap;
+    }
+
+    verify->stats.check_ns = verify_clock_ns() - started;
+    verify->stats.runs++;
+    verify->stats.books = verify->book_count;
+    verify->stats.users = verify->user_count;
+    verify->stats.loans = verify->loan_count;
+    if (verify->issue_total > 0) {
+        verify->stats.failed_runs++;
+        return VERIFY_INCONSISTENT;
+    }
+    return VERIFY_OK;
+}
+
+/**
+ * \brief           Chụp snapshot rồi kiểm tra bằng pool quét của thư viện
+ * \param[in,out]   verify: Bộ kiểm tra
+ * \param[in]       library: Thư viện
+ * \return          \ref VERIFY_OK nếu nhất quán, \ref VERIFY_INCONSISTENT nếu có lỗi
+ */
+verify_status_t
+verify_library(verify_t* verify, const library_t* library) {
+    verify_status_t status;
+
+    status = verify_capture(verify, library);
+    if (status != VERIFY_OK) {
+        return status;
+    }
+    return verify_check(verify, library->scan);
+}
+
+/**
+ * \brief           Tên của một loại lỗi
+ * \param[in]       kind: Loại lỗi
+ * \return          Chuỗi mô tả
+ */
+const char*
+verify_issue_name(verify_issue_kind_t kind) {
+    static const char* const names[VERIFY_ISSUE_COUNT] = {
+        "Trùng ID sách",
+        "ID sách ngoài khoảng cấp phát",
+        "Số bản sao không hợp lệ",
+        "Bitmap có bit ngoài số bản sao",
+        "Sai số bản có sẵn",
+        "Sai cờ hết sách",
+        "Bản sao đang mượn không có người giữ",
+        "Bản sao nằm trong danh sách của nhiều người",
+        "Người dùng giữ bản sao đang có sẵn",
+        "Lượt mượn trỏ tới sách/bản sao không tồn tại",
+        "Trùng ID người dùng",
+        "ID người dùng ngoài khoảng cấp phát",
+        "Số sách mượn vượt sức chứa danh sách",
+        "Danh sách mượn không tăng dần",
+        "Giữ hai bản sao của cùng đầu sách",
+    };
+
+    return ((size_t)kind < VERIFY_ISSUE_COUNT) ? names[kind] : "Không rõ";
+}
+
+/**
+ * \brief           Tên của một bước sửa
+ * \param[in]       action: Bước sửa
+ * \return          Chuỗi mô tả
+ */
+const char*
+verify_action_name(verify_action_t action) {
+    switch (action) {
+        case VERIFY_ACTION_MANUAL:
+            return "kiểm tra thủ công";
+        case VERIFY_ACTION_RECOUNT_BOOK:
+            return "tính lại bitmap/số bản có sẵn/cờ hết sách";
+        case VERIFY_ACTION_RELEASE_COPY:
+            return "đánh dấu bản sao có sẵn";
+        case VERIFY_ACTION_MARK_BORROWED:
+            return "đánh dấu bản sao đang mượn";
+        case VERIFY_ACTION_DROP_LOAN:
+            return "xóa khỏi danh sách mượn";
+        case VERIFY_ACTION_REBUILD_LOANS:
+            return "sắp xếp lại danh sách mượn";
+        case VERIFY_ACTION_RAISE_NEXT_ID:
+            return "tăng next_id";
+        default:
+            return "không rõ";
+    }
+}
+
+/**
+ * \brief           In các lỗi và kế hoạch sửa
+ *
+ * Mỗi bước sửa chỉ in một lần dù nhiều lỗi cùng dẫn tới nó (ví dụ sai cả số
+ * bản có sẵn lẫn cờ hết sách chỉ cần tính lại sách một lần).
+ *
+ * \param[in]       verify: Bộ kiểm tra đã chạy \ref verify_check
+ * \param[in]       out: File nhận kết quả
+ */
+void
+verify_print_plan(const verify_t* verify, FILE* out) {
+    const verify_issue_t* issue;
+    const verify_issue_t* previous;
+    size_t step;
+    size_t i;
+
+    if (verify == NULL || out == NULL) {
+        return;
+    }
+    fprintf(out, "  Kiểm tra %llu sách, %llu người dùng, %llu lượt mượn: chụp %.3f ms, kiểm tra %.3f ms\n",
+            (unsigned long long)verify->stats.books, (unsigned long long)verify->stats.users,
+            (unsigned long long)verify->stats.loans, (double)verify->stats.capture_ns / 1e6,
+            (double)verify->stats.check_ns / 1e6);
+    if (verify->issue_total == 0) {
+        fprintf(out, "  Không tìm thấy lỗi nhất quán.\n");
+        return;
+    }
+
+    fprintf(out, "  Tìm thấy %llu lỗi:\n", (unsigned long long)verify->issue_total);
+    for (i = 0; i < verify->issue_count; i++) {
+        issue = &verify->issues[i];
+        fprintf(out, "  - %s:", verify_issue_name((verify_issue_kind_t)issue->kind));
+        if (issue->book_id != 0) {
+            fprintf(out, " sách %u", issue->book_id);
+        }
+        if (issue->item_key != 0) {
+            fprintf(out, " bản sao %u", (unsigned)BOOK_ITEM_COPY(issue->item_key));
+        }
+        if (issue->user_id != 0) {
+            fprintf(out, " người dùng %u", issue->user_id);
+        }
+        if (issue->expected != issue->actual) {
+            fprintf(out, " (đúng %u, đang có %u)", issue->expected, issue->actual);
+        }
+        fprintf(out, "\n");
+    }
+    if (verify->issue_total > verify->issue_count) {
+        fprintf(out, "  ... và %llu lỗi khác (chạy lại sau khi sửa)\n",
+                (unsigned long long)(verify->issue_total - verify->issue_count));
+    }
+
+    fprintf(out, "\n  Kế hoạch sửa:\n");
+    step = 0;
+    previous = NULL;
+    for (i = 0; i < verify->issue_count; i++) {
+        issue = &verify->issues[i];
+        if (previous != NULL && previous->action == issue->action && previous->book_id == issue->book_id
+            && previous->user_id == issue->user_id && previous->item_key == issue->item_key) {
+            continue;
+        }
+        previous = issue;
+        if (issue->action == VERIFY_ACTION_RAISE_NEXT_ID) {
+            /* Gộp thành một bước cho mỗi danh sách, in ở cuối */
+            continue;
+        }
+        step++;
+        switch ((verify_action_t)issue->action) {
+            case VERIFY_ACTION_RECOUNT_BOOK:
+                fprintf(out, "  %zu. Sách %u: %s\n", step, issue->book_id,
+                        verify_action_name(VERIFY_ACTION_RECOUNT_BOOK));
+                break;
+            case VERIFY_ACTION_RELEASE_COPY:
+            case VERIFY_ACTION_MARK_BORROWED:
+                fprintf(out, "  %zu. Sách %u bản sao %u: %s\n", step, issue->book_id,
+                        (unsigned)BOOK_ITEM_COPY(issue->item_key), verify_action_name((verify_action_t)issue->action));
+                break;
+            case VERIFY_ACTION_DROP_LOAN:
+                fprintf(out, "  %zu. Người dùng %u: xóa sách %u bản sao %u khỏi danh sách mượn\n", step,
+                        issue->user_id, (unsigned)BOOK_ITEM_BOOK_ID(issue->item_key),
+                        (unsigned)BOOK_ITEM_COPY(issue->item_key));
+                break;
+            case VERIFY_ACTION_REBUILD_LOANS:
+                fprintf(out, "  %zu. Người dùng %u: %s\n", step, issue->user_id,
+                        verify_action_name(VERIFY_ACTION_REBUILD_LOANS));
+                break;
+            default:
+                if (issue->user_id == 0) {
+                    fprintf(out, "  %zu. Sách %u: %s, %s\n", step, issue->book_id,
+                            verify_issue_name((verify_issue_kind_t)issue->kind), verify_action_name(VERIFY_ACTION_MANUAL));
+                } else {
+                    fprintf(out, "  %zu. Người dùng %u: %s, %s\n", step, issue->user_id,
+                            verify_issue_name((verify_issue_kind_t)issue->kind), verify_action_name(VERIFY_ACTION_MANUAL));
+                }
+                break;
+        }
+    }
+
+    /* Thứ tự ID đã được sắp xếp nên ID lớn nhất nằm ở cuối */
+    if (verify->book_count > 0 && VERIFY_ORDER_ID(verify->book_order[verify->book_count - 1]) >= verify->book_next_id) {
+        fprintf(out, "  %zu. Tăng next_id của danh sách sách từ %u lên %u\n", ++step, verify->book_next_id,
+                VERIFY_ORDER_ID(verify->book_order[verify->book_count - 1]) + 1);
+    }
+    if (verify->user_count > 0 && VERIFY_ORDER_ID(verify->user_order[verify->user_count - 1]) >= verify->user_next_id) {
+        fprintf(out, "  %zu. Tăng next_id của danh sách người dùng từ %u lên %u\n", ++step, verify->user_next_id,
+                VERIFY_ORDER_ID(verify->user_order[verify->user_count - 1]) + 1);
+    }
+}
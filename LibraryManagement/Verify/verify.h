@@ -0,0 +1,193 @@
+/**
+ * \file            verify.h
+ * \brief           Kiểm tra song song tính nhất quán giữa sách và danh sách mượn của người dùng
+ */
+
+/*
+ * Copyright (c) 2025 Phạm Văn Long
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of Library Management System.
+ *
+ * Author:          Phạm Văn Long
+ */
+
+#ifndef VERIFY_HDR_H
+#define VERIFY_HDR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "../Management/management.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Định nghĩa các hằng số */
+#define VERIFY_MAX_LOANS            ((size_t)MAX_USERS * USER_MAX_LOANS) /*!< Số lượt mượn tối đa trong snapshot */
+#define VERIFY_CHUNK_BOOKS          1024        /*!< Số sách mỗi phân đoạn kiểm tra */
+#define VERIFY_CHUNK_USERS          64          /*!< Số người dùng mỗi phân đoạn kiểm tra */
+#define VERIFY_WORKER_ISSUES        128         /*!< Số lỗi mỗi luồng giữ lại */
+#define VERIFY_MAX_ISSUES           256         /*!< Số lỗi giữ lại sau khi gộp (vẫn đếm toàn bộ) */
+#define VERIFY_SORT_SIZE            ((size_t)MAX_BOOKS > VERIFY_MAX_LOANS ? (size_t)MAX_BOOKS : VERIFY_MAX_LOANS)
+
+/**
+ * \brief           Trạng thái trả về của các hàm kiểm tra
+ */
+typedef enum {
+    VERIFY_OK = 0,                              /*!< Dữ liệu nhất quán */
+    VERIFY_ERROR,                               /*!< Lỗi chung */
+    VERIFY_INVALID_INPUT,                       /*!< Dữ liệu đầu vào không hợp lệ */
+    VERIFY_INCONSISTENT,                        /*!< Tìm thấy ít nhất một lỗi, xem kế hoạch sửa */
+} verify_status_t;
+
+/**
+ * \brief           Loại lỗi nhất quán
+ */
+typedef enum {
+    VERIFY_ISSUE_DUPLICATE_BOOK_ID = 0,         /*!< Hai bản ghi sách cùng ID */
+    VERIFY_ISSUE_BOOK_ID_RANGE,                 /*!< ID sách bằng 0 hoặc không nhỏ hơn next_id */
+    VERIFY_ISSUE_COPY_COUNT,                    /*!< Số bản sao ngoài khoảng 1..64 */
+    VERIFY_ISSUE_MASK_RANGE,                    /*!< Bitmap có bit ngoài số bản sao */
+    VERIFY_ISSUE_AVAILABLE_COUNT,               /*!< available_count khác popcount(available_mask) */
+    VERIFY_ISSUE_BORROWED_FLAG,                 /*!< is_borrowed khác (không còn bản có sẵn) */
+    VERIFY_ISSUE_COPY_NO_OWNER,                 /*!< Bản sao đang mượn nhưng không người dùng nào giữ */
+    VERIFY_ISSUE_COPY_MANY_OWNERS,              /*!< Một bản sao nằm trong danh sách mượn của nhiều người */
+    VERIFY_ISSUE_LOAN_COPY_AVAILABLE,           /*!< Người dùng giữ bản sao đang được đánh dấu có sẵn */
+    VERIFY_ISSUE_LOAN_UNKNOWN_COPY,             /*!< Khóa item trỏ tới sách hoặc bản sao không tồn tại */
+    VERIFY_ISSUE_DUPLICATE_USER_ID,             /*!< Hai người dùng cùng ID */
+    VERIFY_ISSUE_USER_ID_RANGE,                 /*!< ID người dùng bằng 0 hoặc không nhỏ hơn next_id */
+    VERIFY_ISSUE_LOAN_COUNT,                    /*!< borrowed_count vượt sức chứa danh sách mượn */
+    VERIFY_ISSUE_LOANS_UNSORTED,                /*!< Danh sách mượn không tăng dần nghiêm ngặt */
+    VERIFY_ISSUE_SAME_TITLE,                    /*!< Người dùng giữ hai bản sao của cùng một đầu sách */
+    VERIFY_ISSUE_COUNT,
+} verify_issue_kind_t;
+
+/**
+ * \brief           Bước sửa đề xuất cho một lỗi
+ */
+typedef enum {
+    VERIFY_ACTION_MANUAL = 0,                   /*!< Cần người kiểm tra, không sửa tự động được */
+    VERIFY_ACTION_RECOUNT_BOOK,                 /*!< Bỏ bit thừa, tính lại available_count và is_borrowed */
+    VERIFY_ACTION_RELEASE_COPY,                 /*!< Đánh dấu bản sao là có sẵn */
+    VERIFY_ACTION_MARK_BORROWED,                /*!< Đánh dấu bản sao là đang mượn (giữ lượt mượn của người dùng) */
+    VERIFY_ACTION_DROP_LOAN,                    /*!< Xóa khóa item khỏi danh sách mượn của người dùng */
+    VERIFY_ACTION_REBUILD_LOANS,                /*!< Sắp xếp lại danh sách mượn của người dùng */
+    VERIFY_ACTION_RAISE_NEXT_ID,                /*!< Tăng next_id lên \ref verify_issue_t::expected */
+} verify_action_t;
+
+/**
+ * \brief           Một lỗi cùng bước sửa đề xuất
+ */
+typedef struct {
+    uint8_t kind;                               /*!< \ref verify_issue_kind_t */
+    uint8_t action;                             /*!< \ref verify_action_t */
+    uint32_t book_id;                           /*!< ID sách liên quan (0 = không có) */
+    uint32_t user_id;                           /*!< ID người dùng liên quan (0 = không có) */
+    uint32_t item_key;                          /*!< Khóa item liên quan (0 = không có) */
+    uint32_t expected;                          /*!< Giá trị đúng (tùy loại lỗi) */
+    uint32_t actual;                            /*!< Giá trị đang có (tùy loại lỗi) */
+} verify_issue_t;
+
+/**
+ * \brief           Phần trạng thái mượn của một đầu sách trong snapshot
+ */
+typedef struct {
+    uint64_t available_mask;                    /*!< Bitmap bản sao có sẵn */
+    uint32_t book_id;                           /*!< ID sách */
+    uint8_t copy_count;                         /*!< Số bản sao */
+    uint8_t available_count;                    /*!< Số bản có sẵn đã lưu */
+    uint8_t is_borrowed;                        /*!< Cờ hết bản có sẵn đã lưu */
+} verify_book_t;
+
+/**
+ * \brief           Phần trạng thái mượn của một người dùng trong snapshot
+ */
+typedef struct {
+    uint32_t user_id;                           /*!< ID người dùng */
+    uint32_t first_loan;                        /*!< Vị trí khóa item đầu tiên trong \ref verify_t::loans */
+    uint32_t loan_count;                        /*!< Số khóa item đã chép */
+    uint32_t borrowed_count;                    /*!< borrowed_count đã lưu */
+    uint16_t capacity;                          /*!< Sức chứa danh sách mượn */
+} verify_user_t;
+
+/**
+ * \brief           Số liệu kiểm tra
+ */
+typedef struct {
+    uint64_t runs;                              /*!< Số lần kiểm tra */
+    uint64_t failed_runs;                       /*!< Số lần tìm thấy lỗi */
+    uint64_t capture_ns;                        /*!< Thời gian chụp snapshot của lần gần nhất */
+    uint64_t check_ns;                          /*!< Thời gian kiểm tra của lần gần nhất */
+    uint64_t books;                             /*!< Số sách của lần gần nhất */
+    uint64_t users;                             /*!< Số người dùng của lần gần nhất */
+    uint64_t loans;                             /*!< Số lượt mượn của lần gần nhất */
+} verify_stats_t;
+
+/**
+ * \brief           Bộ kiểm tra nhất quán
+ *
+ * \ref verify_capture chép phần trạng thái mượn (vài chục byte mỗi sách) trong
+ * một lượt duyệt trên luồng sở hữu thư viện, nên snapshot nhất quán mà không
+ * cần khóa. Phần kiểm tra chạy trên bản chép theo từng phân đoạn song song:
+ * sách và lượt mượn đều được sắp theo khóa item rồi so khớp kiểu merge-join,
+ * mỗi phân đoạn sách xử lý đúng dải lượt mượn thuộc dải ID của mình.
+ * Cấu trúc lớn nên được khai báo tĩnh.
+ */
+typedef struct {
+    verify_book_t books[MAX_BOOKS];             /*!< Sách theo thứ tự trong danh sách */
+    uint64_t book_order[MAX_BOOKS];             /*!< (ID << 32) | vị trí, tăng dần theo ID */
+    verify_user_t users[MAX_USERS];             /*!< Người dùng theo thứ tự trong danh sách */
+    uint64_t user_order[MAX_USERS];             /*!< (ID << 32) | vị trí, tăng dần theo ID */
+    uint32_t loans[VERIFY_MAX_LOANS];           /*!< Khóa item, liền nhau theo từng người dùng */
+    uint64_t loan_order[VERIFY_MAX_LOANS];      /*!< (khóa item << 32) | vị trí người dùng, tăng dần theo khóa */
+    uint64_t sort_buffer[VERIFY_SORT_SIZE];     /*!< Vùng đệm sắp xếp cơ số */
+    size_t book_count;                          /*!< Số sách */
+    size_t user_count;                          /*!< Số người dùng */
+    size_t loan_count;                          /*!< Số lượt mượn */
+    uint32_t book_next_id;                      /*!< next_id của danh sách sách */
+    uint32_t user_next_id;                      /*!< next_id của danh sách người dùng */
+    uint32_t book_chunks;                       /*!< Số phân đoạn sách (phân đoạn người dùng đứng sau) */
+    verify_issue_t worker_issues[SCAN_MAX_WORKERS][VERIFY_WORKER_ISSUES]; /*!< Lỗi riêng của từng luồng */
+    size_t worker_issue_count[SCAN_MAX_WORKERS]; /*!< Số lỗi đã giữ của từng luồng */
+    uint64_t worker_issue_total[SCAN_MAX_WORKERS]; /*!< Số lỗi đã tìm thấy của từng luồng */
+    verify_issue_t issues[VERIFY_MAX_ISSUES];   /*!< Lỗi đã gộp, sắp theo sách, người dùng, khóa item */
+    size_t issue_count;                         /*!< Số lỗi trong \ref issues */
+    uint64_t issue_total;                       /*!< Tổng số lỗi tìm thấy (có thể lớn hơn \ref issue_count) */
+    verify_stats_t stats;                       /*!< Số liệu */
+} verify_t;
+
+/* Khai báo các hàm kiểm tra */
+void            verify_init(verify_t* verify);
+verify_status_t verify_capture(verify_t* verify, const library_t* library);
+verify_status_t verify_check(verify_t* verify, scan_pool_t* pool);
+verify_status_t verify_library(verify_t* verify, const library_t* library);
+void            verify_print_plan(const verify_t* verify, FILE* out);
+const char*     verify_issue_name(verify_issue_kind_t kind);
+const char*     verify_action_name(verify_action_t action);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* VERIFY_HDR_H */
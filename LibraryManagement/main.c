@@ -33,9 +33,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "Book/book.h"
 #include "User/user.h"
 #include "Management/management.h"
+#include "Txn/txn.h"
+#include "Column/column.h"
+#include "Trace/trace.h"
+#include "Barcode/barcode.h"
+#include "Filter/filter.h"
+#include "Screen/screen.h"
+#include "Verify/verify.h"
 #include "Ultils/utils.h"
 
 /* Khai báo các hàm menu */
@@ -45,24 +54,71 @@ static void     handle_user_menu(library_t* library);
 static void     handle_borrow_return_menu(library_t* library);
 static void     handle_search_menu(library_t* library);
 static void     handle_statistics_menu(library_t* library);
+static void     export_changes_interactive(library_t* library);
+static void     archive_columns_interactive(library_t* library);
+static void     circulation_history_interactive(library_t* library);
+static void     verify_library_interactive(const library_t* library);
+static void     trace_operation(trace_op_t op, uint64_t started, uint8_t status, uint32_t user_id,
+                                uint32_t book_id, uint32_t value, const char* text, const char* author);
+
+/* Khai báo các hàm thông báo */
+static uint8_t  start_notifications(const char* target);
+static void     stop_notifications(void);
+
+/* Khai báo các hàm in một trang cho pager */
+static size_t   print_book_page(const book_list_t* books, book_filter_t filter, size_t offset, size_t rows,
+                                uint8_t* more);
+static size_t   all_books_page(void* ctx, size_t offset, size_t rows, uint8_t* more);
+static size_t   available_books_page(void* ctx, size_t offset, size_t rows, uint8_t* more);
+static size_t   users_page(void* ctx, size_t offset, size_t rows, uint8_t* more);
 
 /* Khai báo các hàm xử lý sách */
 static void     add_book_interactive(book_list_t* books);
 static void     update_book_interactive(book_list_t* books);
-static void     delete_book_interactive(book_list_t* books);
+static void     delete_book_interactive(library_t* library);
+static void     add_copies_interactive(library_t* library);
+static void     assign_codes_interactive(library_t* library);
 
 /* Khai báo các hàm xử lý người dùng */
 static void     add_user_interactive(user_list_t* users);
 static void     update_user_interactive(user_list_t* users);
 static void     delete_user_interactive(user_list_t* users);
+static void     set_user_tier_interactive(user_list_t* users);
+static void     transfer_loans_interactive(library_t* library);
 
 /* Khai báo các hàm xử lý mượn/trả */
 static void     borrow_book_interactive(library_t* library);
 static void     return_book_interactive(library_t* library);
+static void     place_hold_interactive(library_t* library);
+static void     cancel_hold_interactive(library_t* library);
+static void     borrow_by_barcode_interactive(library_t* library);
+static void     return_by_barcode_interactive(library_t* library);
+static uint8_t  read_barcode(uint64_t* key, const char* prompt);
 
 /* Khai báo các hàm tìm kiếm */
-static void     search_by_title_interactive(book_list_t* books);
-static void     search_by_author_interactive(book_list_t* books);
+static void     search_by_title_interactive(library_t* library);
+static void     search_by_author_interactive(library_t* library);
+static void     filter_search_interactive(library_t* library);
+
+/* Dữ liệu thư viện nằm ở vùng tĩnh để không phụ thuộc kích thước stack khi MAX_BOOKS lớn */
+static book_list_t app_books;
+static user_list_t app_users;
+static hold_pool_t app_holds;
+static query_cache_t app_cache;
+static scan_pool_t app_scan;
+static cdc_log_t app_cdc;
+static history_t app_history;
+static barcode_index_t app_barcodes;
+static filter_index_t app_filter;
+static trace_writer_t app_trace;
+static txn_store_t app_txn_store;
+static txn_t app_txn;
+static uint8_t app_column_buffer[COLUMN_MAX_SNAPSHOT];
+static uint32_t app_author_counts[MAX_BOOKS];
+static notify_queue_t app_notify;
+static notify_socket_t app_notify_socket;
+static FILE* app_notify_file;
+static verify_t app_verify;
 
 /**
  * \brief           Hàm main - điểm bắt đầu của chương trình
@@ -70,17 +126,57 @@ static void     search_by_author_interactive(book_list_t* books);
  */
 int
 main(void) {
-    book_list_t books;
-    user_list_t users;
     library_t library;
+    const char* trace_path;
+    const char* notify_target;
     int32_t choice;
     utils_status_t status;
 
     /* Khởi tạo hệ thống */
-    book_init(&books);
-    user_init(&users);
-    library.books = &books;
-    library.users = &users;
+    screen_init();
+    book_init(&app_books);
+    user_init(&app_users);
+    hold_pool_init(&app_holds);
+    query_cache_init(&app_cache);
+    scan_pool_init(&app_scan, 0);
+    verify_init(&app_verify);
+    cdc_init(&app_cdc);
+    cdc_attach(&app_cdc, &app_books, &app_users);
+    history_init(&app_history);
+    barcode_index_init(&app_barcodes);
+    filter_index_init(&app_filter, &app_scan);
+    app_cache.scan = &app_scan;
+    library.books = &app_books;
+    library.users = &app_users;
+    library.holds = &app_holds;
+    library.cache = &app_cache;
+    library.scan = &app_scan;
+    library.cdc = &app_cdc;
+    library.history = &app_history;
+    library.barcodes = &app_barcodes;
+    library.notify = NULL;
+    library.txn = NULL;
+
+    /* Kho phiên bản sống cùng thư viện; đăng ký sau cdc_attach để observer của nhật ký vẫn được gọi */
+    txn_store_init(&app_txn_store, &library);
+
+    /* Ghi trace thao tác khi đặt biến môi trường LIBRARY_TRACE */
+    trace_path = getenv(TRACE_ENV);
+    if (trace_path != NULL && trace_open(&app_trace, trace_path) != TRACE_OK) {
+        printf("\n  Cảnh báo: Không thể mở file trace %s!\n", trace_path);
+        pause_screen();
+    }
+
+    /* Gửi thông báo hạn trả/sách đặt giữ khi đặt biến môi trường LIBRARY_NOTIFY */
+    notify_target = getenv(NOTIFY_ENV);
+    if (notify_target != NULL) {
+        if (start_notifications(notify_target)) {
+            library.notify = &app_notify;
+        } else {
+            printf("\n  Cảnh báo: Không thể mở nơi nhận thông báo %s!\n", notify_target);
+            pause_screen();
+        }
+    }
 
     /* Vòng lặp menu chính */
     while (1) {
@@ -110,8 +206,27 @@ main(void) {
             case 5:
                 handle_statistics_menu(&library);
                 break;
+            case 6:
+                export_changes_interactive(&library);
+                break;
+            case 7:
+                archive_columns_interactive(&library);
+                break;
+            case 8:
+                circulation_history_interactive(&library);
+                break;
+            case 9:
+                verify_library_interactive(&library);
+                break;
             case 0:
                 printf("\n  Cảm ơn bạn đã sử dụng hệ thống quản lý thư viện!\n");
+                if (library.notify != NULL) {
+                    stop_notifications();
+                }
+                txn_store_destroy(&app_txn_store);
+                filter_index_destroy(&app_filter);
+                scan_pool_destroy(&app_scan);
+                trace_close(&app_trace);
                 return 0;
             default:
                 printf("\n  Lỗi: Lựa chọn không hợp lệ!\n");
@@ -135,6 +250,10 @@ display_main_menu(void) {
     printf("  3. Mượn/Trả sách\n");
     printf("  4. Tìm kiếm\n");
     printf("  5. Thống kê\n");
+    printf("  6. Xuất nhật ký thay đổi\n");
+    printf("  7. Lưu trữ snapshot dạng cột\n");
+    printf("  8. Lịch sử mượn/trả\n");
+    printf("  9. Kiểm tra nhất quán mượn/trả\n");
     printf("  0. Thoát\n");
     printf("\n");
     print_separator();
@@ -158,6 +277,8 @@ handle_book_menu(library_t* library) {
         printf("  3. Xóa sách\n");
         printf("  4. Hiển thị tất cả sách\n");
         printf("  5. Hiển thị sách có sẵn\n");
+        printf("  6. Thêm bản sao cho sách\n");
+        printf("  7. Gán ISBN/mã vạch bản sao\n");
         printf("  0. Quay lại menu chính\n");
         printf("\n");
         print_separator();
@@ -177,19 +298,21 @@ handle_book_menu(library_t* library) {
                 update_book_interactive(library->books);
                 break;
             case 3:
-                delete_book_interactive(library->books);
+                delete_book_interactive(library);
                 break;
             case 4:
-                clear_screen();
-                print_header("DANH SÁCH TẤT CẢ SÁCH");
-                book_display_all(library->books);
-                pause_screen();
+                screen_pager("DANH SÁCH TẤT CẢ SÁCH", book_display_header, all_books_page,
+                             library->books, library->books->count, "Danh sách sách trống!");
                 break;
             case 5:
-                clear_screen();
-                print_header("DANH SÁCH SÁCH CÓ SẴN");
-                book_display_available(library->books);
-                pause_screen();
+                screen_pager("DANH SÁCH SÁCH CÓ SẴN", book_display_header, available_books_page,
+                             library->books, SCREEN_TOTAL_UNKNOWN, "Không có sách nào có sẵn!");
+                break;
+            case 6:
+                add_copies_interactive(library);
+                break;
+            case 7:
+                assign_codes_interactive(library);
                 break;
             case 0:
                 return;
@@ -219,6 +342,8 @@ handle_user_menu(library_t* library) {
         printf("  3. Xóa người dùng\n");
         printf("  4. Hiển thị tất cả người dùng\n");
         printf("  5. Xem thông tin chi tiết người dùng\n");
+        printf("  6. Đổi hạng người dùng\n");
+        printf("  7. Chuyển sách mượn sang thẻ mới\n");
         printf("  0. Quay lại menu chính\n");
         printf("\n");
         print_separator();
@@ -241,10 +366,8 @@ handle_user_menu(library_t* library) {
                 delete_user_interactive(library->users);
                 break;
             case 4:
-                clear_screen();
-                print_header("DANH SÁCH TẤT CẢ NGƯỜI DÙNG");
-                user_display_all(library->users);
-                pause_screen();
+                screen_pager("DANH SÁCH TẤT CẢ NGƯỜI DÙNG", user_display_header, users_page,
+                             library->users, library->users->count, "Danh sách người dùng trống!");
                 break;
             case 5: {
                 uint32_t user_id;
@@ -259,6 +382,12 @@ handle_user_menu(library_t* library) {
                 pause_screen();
                 break;
             }
+            case 6:
+                set_user_tier_interactive(library->users);
+                break;
+            case 7:
+                transfer_loans_interactive(library);
+                break;
             case 0:
                 return;
             default:
@@ -284,6 +413,10 @@ handle_borrow_return_menu(library_t* library) {
         printf("\n");
         printf("  1. Mượn sách\n");
         printf("  2. Trả sách\n");
+        printf("  3. Đặt giữ sách\n");
+        printf("  4. Hủy đặt giữ sách\n");
+        printf("  5. Mượn sách bằng mã vạch/ISBN\n");
+        printf("  6. Trả sách bằng mã vạch/ISBN\n");
         printf("  0. Quay lại menu chính\n");
         printf("\n");
         print_separator();
@@ -302,6 +435,18 @@ handle_borrow_return_menu(library_t* library) {
             case 2:
                 return_book_interactive(library);
                 break;
+            case 3:
+                place_hold_interactive(library);
+                break;
+            case 4:
+                cancel_hold_interactive(library);
+                break;
+            case 5:
+                borrow_by_barcode_interactive(library);
+                break;
+            case 6:
+                return_by_barcode_interactive(library);
+                break;
             case 0:
                 return;
             default:
@@ -327,6 +472,7 @@ handle_search_menu(library_t* library) {
         printf("\n");
         printf("  1. Tìm kiếm theo tiêu đề\n");
         printf("  2. Tìm kiếm theo tác giả\n");
+        printf("  3. Tìm kiếm nâng cao (biểu thức lọc, EXPLAIN)\n");
         printf("  0. Quay lại menu chính\n");
         printf("\n");
         print_separator();
@@ -340,10 +486,13 @@ handle_search_menu(library_t* library) {
 
         switch (choice) {
             case 1:
-                search_by_title_interactive(library->books);
+                search_by_title_interactive(library);
                 break;
             case 2:
-                search_by_author_interactive(library->books);
+                search_by_author_interactive(library);
+                break;
+            case 3:
+                filter_search_interactive(library);
                 break;
             case 0:
                 return;
@@ -361,8 +510,216 @@ handle_search_menu(library_t* library) {
  */
 static void
 handle_statistics_menu(library_t* library) {
+    uint64_t started;
+
     clear_screen();
+    started = trace_clock_ns();
     mgmt_display_statistics(library);
+    trace_operation(TRACE_OP_STATS, started, 0, 0, 0, 0, NULL, NULL);
+    pause_screen();
+}
+
+/**
+ * \brief           Ghi một thao tác vào trace (bỏ qua khi chưa bật LIBRARY_TRACE)
+ *
+ * Thời gian thực hiện tính từ \p started tới lúc gọi hàm này, gồm cả phần in
+ * kết quả ra màn hình của thao tác.
+ *
+ * \param[in]       op: Loại thao tác
+ * \param[in]       started: Đồng hồ lúc bắt đầu (\ref trace_clock_ns)
+ * \param[in]       status: Mã trạng thái trả về của thao tác
+ * \param[in]       user_id: ID người dùng
+ * \param[in]       book_id: ID sách
+ * \param[in]       value: Số bản sao thêm
+ * \param[in]       text: Tiêu đề, tên hoặc chuỗi tìm kiếm (có thể NULL)
+ * \param[in]       author: Tác giả (có thể NULL)
+ */
+static void
+trace_operation(trace_op_t op, uint64_t started, uint8_t status, uint32_t user_id,
+                uint32_t book_id, uint32_t value, const char* text, const char* author) {
+    trace_event_t event;
+
+    if (app_trace.out == NULL) {
+        return;
+    }
+
+    event.op = op;
+    event.time_ns = started;
+    event.duration_ns = trace_clock_ns() - started;
+    event.status = status;
+    event.user_id = user_id;
+    event.book_id = book_id;
+    event.value = value;
+    snprintf(event.text, sizeof(event.text), "%s", (text != NULL) ? text : "");
+    snprintf(event.author, sizeof(event.author), "%s", (author != NULL) ? author : "");
+    trace_write(&app_trace, &event);
+}
+
+/**
+ * \brief           Xuất các thay đổi kể từ một con trỏ dưới dạng JSON Lines
+ *
+ * Nếu con trỏ đã rơi khỏi vòng đệm thì xuất snapshot toàn bộ thư viện.
+ *
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+export_changes_interactive(library_t* library) {
+    uint32_t value;
+    uint64_t cursor;
+    utils_status_t status;
+    cdc_status_t cdc_status;
+
+    clear_screen();
+    print_header("XUẤT NHẬT KÝ THAY ĐỔI");
+    printf("\n  Số thứ tự mới nhất: %llu, cũ nhất còn giữ: %llu\n",
+           (unsigned long long)cdc_head(library->cdc), (unsigned long long)cdc_oldest(library->cdc));
+
+    /* Nhập con trỏ */
+    status = read_uint(&value, "  Nhập số thứ tự cuối cùng đã nhận (0 = từ đầu): ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: Số thứ tự không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    printf("\n");
+    cursor = value;
+    cdc_status = cdc_sync(library->cdc, library->books, library->users, CDC_FORMAT_JSON, stdout, &cursor);
+    switch (cdc_status) {
+        case CDC_OK:
+            printf("\n  Thành công: Con trỏ mới là %llu\n", (unsigned long long)cursor);
+            break;
+        case CDC_SNAPSHOT:
+            printf("\n  Con trỏ đã quá cũ, đã xuất snapshot. Con trỏ mới là %llu\n", (unsigned long long)cursor);
+            break;
+        case CDC_INVALID_INPUT:
+            printf("\n  Lỗi: Số thứ tự lớn hơn số thứ tự mới nhất!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể xuất nhật ký thay đổi!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Lưu danh sách sách thành snapshot dạng cột rồi thống kê trên file vừa ghi
+ *
+ * Các số liệu được tính lại từ snapshot (không đọc danh sách sách) để kiểm tra
+ * file và minh họa phân tích theo cột.
+ *
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+archive_columns_interactive(library_t* library) {
+    char path[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    column_snapshot_t snap;
+    column_status_t status;
+    uint64_t total_copies;
+    uint64_t available_copies;
+    size_t written;
+    uint32_t best;
+    uint32_t code;
+    uint32_t rank;
+
+    clear_screen();
+    print_header("LƯU TRỮ SNAPSHOT DẠNG CỘT");
+
+    /* Nhập đường dẫn file */
+    if (read_string(path, sizeof(path), "\n  Nhập đường dẫn file snapshot: ") != UTILS_OK || is_string_empty(path)) {
+        printf("\n  Lỗi: Đường dẫn không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    status = column_save(library->books, path, &written);
+    if (status == COLUMN_OK) {
+        status = column_load_file(&snap, path, app_column_buffer, sizeof(app_column_buffer));
+    }
+    if (status == COLUMN_OK) {
+        status = column_count_copies(&snap, &total_copies, &available_copies);
+    }
+    if (status == COLUMN_OK) {
+        status = column_count_by_author(&snap, 0, app_author_counts, MAX_BOOKS);
+    }
+    if (status != COLUMN_OK) {
+        printf("\n  Lỗi: Không thể ghi hoặc đọc lại snapshot!\n");
+        pause_screen();
+        return;
+    }
+
+    printf("\n  Thành công: Đã ghi %zu byte (bản ghi gốc chiếm %zu byte)\n",
+           written, (size_t)snap.book_count * sizeof(book_t));
+    printf("  Số đầu sách: %u, số tác giả: %u\n", snap.book_count, snap.author_count);
+    printf("  Đầu sách đã hết bản có sẵn: %zu\n", column_count_borrowed(&snap));
+    printf("  Bản sao có sẵn: %llu / %llu\n",
+           (unsigned long long)available_copies, (unsigned long long)total_copies);
+
+    /* Năm tác giả có nhiều đầu sách nhất */
+    printf("\n  Tác giả có nhiều đầu sách nhất:\n");
+    for (rank = 0; rank < 5 && rank < snap.author_count; rank++) {
+        best = 0;
+        for (code = 1; code < snap.author_count; code++) {
+            if (app_author_counts[code] > app_author_counts[best]) {
+                best = code;
+            }
+        }
+        if (column_author(&snap, best, author, sizeof(author)) == COLUMN_OK) {
+            printf("  %u. %s: %u\n", rank + 1, author, app_author_counts[best]);
+        }
+        app_author_counts[best] = 0;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Thống kê lượt mượn/trả trong một số ngày gần nhất
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+circulation_history_interactive(library_t* library) {
+    uint32_t days;
+    uint32_t now;
+    uint32_t from;
+
+    clear_screen();
+    print_header("LỊCH SỬ MƯỢN/TRẢ");
+
+    /* Nhập số ngày */
+    if (read_uint(&days, "\n  Nhập số ngày gần nhất (0 = toàn bộ lịch sử): ") != UTILS_OK) {
+        printf("\n  Lỗi: Số ngày không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    now = (uint32_t)time(NULL);
+    from = (days == 0 || days > now / 86400U) ? 0 : now - days * 86400U;
+    clear_screen();
+    mgmt_display_circulation(library, from, now);
+    pause_screen();
+}
+
+/**
+ * \brief           Kiểm tra bất biến mượn/trả và in kế hoạch sửa
+ * \param[in]       library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+verify_library_interactive(const library_t* library) {
+    verify_status_t status;
+
+    clear_screen();
+    print_header("KIỂM TRA NHẤT QUÁN MƯỢN/TRẢ");
+    printf("\n");
+
+    status = verify_library(&app_verify, library);
+    if (status == VERIFY_OK || status == VERIFY_INCONSISTENT) {
+        verify_print_plan(&app_verify, stdout);
+    } else {
+        printf("  Lỗi: Không thể kiểm tra thư viện!\n");
+    }
     pause_screen();
 }
 
@@ -375,6 +732,7 @@ add_book_interactive(book_list_t* books) {
     uint32_t assigned_id;
     char title[MAX_TITLE_LENGTH];
     char author[MAX_AUTHOR_LENGTH];
+    uint64_t started;
     utils_status_t status;
     book_status_t book_status;
 
@@ -398,7 +756,10 @@ add_book_interactive(book_list_t* books) {
     }
 
     /* Thêm sách với ID tự động */
+    assigned_id = 0;
+    started = trace_clock_ns();
     book_status = book_add(books, title, author, &assigned_id);
+    trace_operation(TRACE_OP_ADD_BOOK, started, (uint8_t)book_status, 0, assigned_id, 0, title, author);
     switch (book_status) {
         case BOOK_OK:
             printf("\n  Thành công: Đã thêm sách mới với ID: %u\n", assigned_id);
@@ -472,10 +833,10 @@ update_book_interactive(book_list_t* books) {
 
 /**
  * \brief           Xóa sách (tương tác với người dùng)
- * \param[in,out]   books: Con trỏ tới danh sách sách
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
  */
 static void
-delete_book_interactive(book_list_t* books) {
+delete_book_interactive(library_t* library) {
     uint32_t book_id;
     utils_status_t status;
     book_status_t book_status;
@@ -492,16 +853,20 @@ delete_book_interactive(book_list_t* books) {
     }
 
     /* Xóa sách */
-    book_status = book_delete(books, book_id);
+    book_status = book_delete(library->books, book_id);
     switch (book_status) {
         case BOOK_OK:
+            barcode_index_remove_book(library->barcodes, book_id);
             printf("\n  Thành công: Đã xóa sách!\n");
             break;
         case BOOK_NOT_FOUND:
             printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
             break;
         case BOOK_IS_BORROWED:
-            printf("\n  Lỗi: Không thể xóa sách đang được mượn!\n");
+            printf("\n  Lỗi: Không thể xóa sách đang có bản sao được mượn!\n");
+            break;
+        case BOOK_HAS_HOLDS:
+            printf("\n  Lỗi: Không thể xóa sách đang có người đặt giữ!\n");
             break;
         default:
             printf("\n  Lỗi: Không thể xóa sách!\n");
@@ -511,6 +876,129 @@ delete_book_interactive(book_list_t* books) {
     pause_screen();
 }
 
+/**
+ * \brief           Thêm bản sao vật lý cho sách (tương tác với người dùng)
+ * \param[in,out]   books: Con trỏ tới danh sách sách
+ */
+static void
+add_copies_interactive(library_t* library) {
+    uint32_t book_id;
+    uint32_t count;
+    uint32_t handed;
+    uint64_t started;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("THÊM BẢN SAO CHO SÁCH");
+
+    /* Nhập ID sách */
+    status = read_uint(&book_id, "\n  Nhập ID sách: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Nhập số bản sao */
+    status = read_uint(&count, "  Nhập số bản sao cần thêm: ");
+    if (status != UTILS_OK || count == 0 || count > MAX_COPIES_PER_BOOK) {
+        printf("\n  Lỗi: Số bản sao không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Thêm bản sao */
+    started = trace_clock_ns();
+    mgmt_status = mgmt_add_copies(library, book_id, (uint8_t)count, &handed);
+    trace_operation(TRACE_OP_ADD_COPIES, started, (uint8_t)mgmt_status, 0, book_id, count, NULL, NULL);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã thêm %u bản sao!\n", count);
+            if (handed > 0) {
+                printf("  %u bản sao đã được giao cho người đặt giữ.\n", handed);
+            }
+            break;
+        case MGMT_BOOK_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
+            break;
+        case MGMT_COPY_LIMIT_REACHED:
+            printf("\n  Lỗi: Mỗi đầu sách có tối đa %d bản sao!\n", MAX_COPIES_PER_BOOK);
+            break;
+        default:
+            printf("\n  Lỗi: Không thể thêm bản sao!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Gán ISBN cho sách hoặc mã vạch cho một bản sao (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+assign_codes_interactive(library_t* library) {
+    uint32_t book_id;
+    uint32_t copy;
+    uint64_t key;
+    char text[BARCODE_TEXT_LENGTH];
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("GÁN ISBN/MÃ VẠCH");
+
+    /* Nhập ID sách */
+    status = read_uint(&book_id, "\n  Nhập ID sách: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Quét hoặc nhập mã: ISBN gán cho đầu sách, mã khác gán cho một bản sao */
+    if (!read_barcode(&key, "  Quét ISBN hoặc mã vạch bản sao: ")) {
+        return;
+    }
+
+    if (BARCODE_KEY_KIND(key) == BARCODE_KIND_ISBN) {
+        mgmt_status = mgmt_assign_isbn(library, book_id, key);
+    } else {
+        status = read_uint(&copy, "  Nhập số thứ tự bản sao (1, 2, ...): ");
+        if (status != UTILS_OK || copy == 0 || copy > MAX_COPIES_PER_BOOK) {
+            printf("\n  Lỗi: Số thứ tự bản sao không hợp lệ!\n");
+            pause_screen();
+            return;
+        }
+        mgmt_status = mgmt_assign_barcode(library, book_id, (uint8_t)(copy - 1), key);
+    }
+
+    barcode_format(key, text, sizeof(text));
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã gán mã %s cho sách %u!\n", text, book_id);
+            break;
+        case MGMT_BOOK_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
+            break;
+        case MGMT_BARCODE_EXISTS:
+            printf("\n  Lỗi: Mã %s đã được gán trước đó!\n", text);
+            break;
+        case MGMT_BARCODE_FULL:
+            printf("\n  Lỗi: Chỉ mục mã vạch đã đầy!\n");
+            break;
+        case MGMT_INVALID_INPUT:
+            printf("\n  Lỗi: Sách không có bản sao này!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể gán mã!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
 /**
  * \brief           Thêm người dùng mới (tương tác với người dùng)
  * \param[in,out]   users: Con trỏ tới danh sách người dùng
@@ -519,6 +1007,7 @@ static void
 add_user_interactive(user_list_t* users) {
     uint32_t assigned_id;
     char name[MAX_NAME_LENGTH];
+    uint64_t started;
     utils_status_t status;
     user_status_t user_status;
 
@@ -534,7 +1023,10 @@ add_user_interactive(user_list_t* users) {
     }
 
     /* Thêm người dùng với ID tự động */
+    assigned_id = 0;
+    started = trace_clock_ns();
     user_status = user_add(users, name, &assigned_id);
+    trace_operation(TRACE_OP_ADD_USER, started, (uint8_t)user_status, assigned_id, 0, 0, name, NULL);
     switch (user_status) {
         case USER_OK:
             printf("\n  Thành công: Đã thêm người dùng mới với ID: %u\n", assigned_id);
@@ -639,55 +1131,50 @@ delete_user_interactive(user_list_t* users) {
 }
 
 /**
- * \brief           Mượn sách (tương tác với người dùng)
- * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ * \brief           Đổi hạng người dùng (tương tác với người dùng)
+ * \param[in,out]   users: Con trỏ tới danh sách người dùng
  */
 static void
-borrow_book_interactive(library_t* library) {
+set_user_tier_interactive(user_list_t* users) {
     uint32_t user_id;
-    uint32_t book_id;
+    uint32_t tier;
     utils_status_t status;
-    mgmt_status_t mgmt_status;
+    user_status_t user_status;
 
     clear_screen();
-    print_header("MƯỢN SÁCH");
+    print_header("ĐỔI HẠNG NGƯỜI DÙNG");
 
     /* Nhập ID người dùng */
     status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
     if (status != UTILS_OK) {
-        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        printf("\n  Lỗi: ID không hợp lệ!\n");
         pause_screen();
         return;
     }
 
-    /* Nhập ID sách */
-    status = read_uint(&book_id, "  Nhập ID sách cần mượn: ");
-    if (status != UTILS_OK) {
-        printf("\n  Lỗi: ID sách không hợp lệ!\n");
+    /* Nhập hạng mới */
+    printf("  Hạng: 0 = %s (%d cuốn), 1 = %s (%d cuốn), 2 = %s (%d cuốn)\n",
+           user_tier_name(USER_TIER_STUDENT), USER_LIMIT_STUDENT,
+           user_tier_name(USER_TIER_STAFF), USER_LIMIT_STAFF,
+           user_tier_name(USER_TIER_FACULTY), USER_LIMIT_FACULTY);
+    status = read_uint(&tier, "  Nhập hạng mới: ");
+    if (status != UTILS_OK || tier >= USER_TIER_COUNT) {
+        printf("\n  Lỗi: Hạng không hợp lệ!\n");
         pause_screen();
         return;
     }
 
-    /* Thực hiện mượn sách */
-    mgmt_status = mgmt_borrow_book(library, user_id, book_id);
-    switch (mgmt_status) {
-        case MGMT_OK:
-            printf("\n  Thành công: Đã mượn sách!\n");
+    /* Cập nhật hạng */
+    user_status = user_set_tier(users, user_id, (user_tier_t)tier);
+    switch (user_status) {
+        case USER_OK:
+            printf("\n  Thành công: Đã đổi hạng người dùng!\n");
             break;
-        case MGMT_USER_NOT_FOUND:
+        case USER_NOT_FOUND:
             printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
             break;
-        case MGMT_BOOK_NOT_FOUND:
-            printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
-            break;
-        case MGMT_BOOK_ALREADY_BORROWED:
-            printf("\n  Lỗi: Sách đã được mượn!\n");
-            break;
-        case MGMT_USER_LIMIT_REACHED:
-            printf("\n  Lỗi: Người dùng đã mượn đủ %d sách!\n", MAX_BORROWED_BOOKS);
-            break;
         default:
-            printf("\n  Lỗi: Không thể mượn sách!\n");
+            printf("\n  Lỗi: Không thể đổi hạng người dùng!\n");
             break;
     }
 
@@ -695,43 +1182,188 @@ borrow_book_interactive(library_t* library) {
 }
 
 /**
- * \brief           Trả sách (tương tác với người dùng)
+ * \brief           Chuyển toàn bộ sách đang mượn sang thẻ mới (tương tác với người dùng)
+ *
+ * Thực hiện trong một giao dịch trên kho phiên bản của thư viện: cả hai thẻ
+ * cùng được cập nhật hoặc không thẻ nào thay đổi.
+ *
  * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
  */
 static void
-return_book_interactive(library_t* library) {
-    uint32_t user_id;
-    uint32_t book_id;
+transfer_loans_interactive(library_t* library) {
+    uint32_t from_user_id;
+    uint32_t to_user_id;
     utils_status_t status;
-    mgmt_status_t mgmt_status;
+    txn_status_t txn_status;
 
     clear_screen();
-    print_header("TRẢ SÁCH");
+    print_header("CHUYỂN SÁCH MƯỢN SANG THẺ MỚI");
 
-    /* Nhập ID người dùng */
-    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    /* Nhập ID hai thẻ */
+    status = read_uint(&from_user_id, "\n  Nhập ID thẻ cũ: ");
     if (status != UTILS_OK) {
-        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        printf("\n  Lỗi: ID không hợp lệ!\n");
         pause_screen();
         return;
     }
-
-    /* Nhập ID sách */
-    status = read_uint(&book_id, "  Nhập ID sách cần trả: ");
+    status = read_uint(&to_user_id, "  Nhập ID thẻ mới: ");
     if (status != UTILS_OK) {
-        printf("\n  Lỗi: ID sách không hợp lệ!\n");
+        printf("\n  Lỗi: ID không hợp lệ!\n");
         pause_screen();
         return;
     }
 
-    /* Thực hiện trả sách */
-    mgmt_status = mgmt_return_book(library, user_id, book_id);
-    switch (mgmt_status) {
-        case MGMT_OK:
-            printf("\n  Thành công: Đã trả sách!\n");
+    /* Chuyển trong một giao dịch */
+    txn_status = txn_begin(library->txn, &app_txn);
+    if (txn_status == TXN_OK) {
+        txn_status = txn_transfer_loans(&app_txn, from_user_id, to_user_id);
+        if (txn_status == TXN_OK) {
+            txn_status = txn_commit(&app_txn);
+        } else {
+            txn_abort(&app_txn);
+        }
+    }
+
+    switch (txn_status) {
+        case TXN_OK:
+            printf("\n  Thành công: Đã chuyển sách mượn từ thẻ %u sang thẻ %u!\n", from_user_id, to_user_id);
             break;
-        case MGMT_USER_NOT_FOUND:
-            printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
+        case TXN_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy người dùng!\n");
+            break;
+        case TXN_INVALID_INPUT:
+            printf("\n  Lỗi: Hai thẻ phải khác nhau!\n");
+            break;
+        case TXN_USER_LIMIT_REACHED:
+            printf("\n  Lỗi: Thẻ mới không đủ hạn mức mượn!\n");
+            break;
+        case TXN_USER_ALREADY_HAS_BOOK:
+            printf("\n  Lỗi: Thẻ mới đang mượn một đầu sách trùng với thẻ cũ!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể chuyển sách mượn!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Mượn sách (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+borrow_book_interactive(library_t* library) {
+    uint32_t user_id;
+    uint32_t book_id;
+    uint64_t started;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("MƯỢN SÁCH");
+
+    /* Nhập ID người dùng */
+    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Nhập ID sách */
+    status = read_uint(&book_id, "  Nhập ID sách cần mượn: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID sách không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Thực hiện mượn sách */
+    started = trace_clock_ns();
+    mgmt_status = mgmt_borrow_book(library, user_id, book_id);
+    trace_operation(TRACE_OP_BORROW, started, (uint8_t)mgmt_status, user_id, book_id, 0, NULL, NULL);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã mượn sách!\n");
+            break;
+        case MGMT_USER_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
+            break;
+        case MGMT_BOOK_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
+            break;
+        case MGMT_BOOK_ALREADY_BORROWED:
+            printf("\n  Lỗi: Tất cả bản sao của sách đã được mượn!\n");
+            printf("  Có %zu người đang đặt giữ, hãy chọn 'Đặt giữ sách' để xếp hàng.\n",
+                   mgmt_hold_count(library, book_id));
+            break;
+        case MGMT_BOOK_RESERVED:
+            printf("\n  Lỗi: Bản sao có sẵn đang dành cho %zu người đặt giữ trước!\n",
+                   mgmt_hold_count(library, book_id));
+            break;
+        case MGMT_USER_ALREADY_HAS_BOOK:
+            printf("\n  Lỗi: Người dùng đang mượn một bản của sách này!\n");
+            break;
+        case MGMT_USER_LIMIT_REACHED:
+            printf("\n  Lỗi: Người dùng đã mượn đủ số sách cho phép theo hạng!\n");
+            break;
+        case MGMT_LOAN_POOL_FULL:
+            printf("\n  Lỗi: Hết bộ nhớ lưu danh sách mượn, không thể ghi thêm lượt mượn!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể mượn sách!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Trả sách (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+return_book_interactive(library_t* library) {
+    uint32_t user_id;
+    uint32_t book_id;
+    uint32_t handed_to;
+    uint64_t started;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("TRẢ SÁCH");
+
+    /* Nhập ID người dùng */
+    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Nhập ID sách */
+    status = read_uint(&book_id, "  Nhập ID sách cần trả: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID sách không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Thực hiện trả sách */
+    started = trace_clock_ns();
+    mgmt_status = mgmt_return_book_handoff(library, user_id, book_id, &handed_to);
+    trace_operation(TRACE_OP_RETURN, started, (uint8_t)mgmt_status, user_id, book_id, 0, NULL, NULL);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã trả sách!\n");
+            if (handed_to != 0) {
+                printf("  Bản sao đã được chuyển cho người đặt giữ ID %u.\n", handed_to);
+            }
+            break;
+        case MGMT_USER_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
             break;
         case MGMT_BOOK_NOT_FOUND:
             printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
@@ -747,13 +1379,276 @@ return_book_interactive(library_t* library) {
     pause_screen();
 }
 
+/**
+ * \brief           Đặt giữ sách (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+place_hold_interactive(library_t* library) {
+    uint32_t user_id;
+    uint32_t book_id;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("ĐẶT GIỮ SÁCH");
+
+    /* Nhập ID người dùng */
+    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Nhập ID sách */
+    status = read_uint(&book_id, "  Nhập ID sách cần đặt giữ: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID sách không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Thực hiện đặt giữ */
+    mgmt_status = mgmt_place_hold(library, user_id, book_id);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã đặt giữ, vị trí trong hàng đợi: %zu\n",
+                   mgmt_hold_count(library, book_id));
+            break;
+        case MGMT_USER_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
+            break;
+        case MGMT_BOOK_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
+            break;
+        case MGMT_BOOK_AVAILABLE:
+            printf("\n  Lỗi: Sách còn bản có sẵn, hãy mượn trực tiếp!\n");
+            break;
+        case MGMT_USER_ALREADY_HAS_BOOK:
+            printf("\n  Lỗi: Người dùng đang mượn một bản của sách này!\n");
+            break;
+        case MGMT_HOLD_EXISTS:
+            printf("\n  Lỗi: Người dùng đã đặt giữ sách này!\n");
+            break;
+        case MGMT_HOLD_FULL:
+            printf("\n  Lỗi: Danh sách đặt giữ đã đầy!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể đặt giữ sách!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Hủy đặt giữ sách (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+cancel_hold_interactive(library_t* library) {
+    uint32_t user_id;
+    uint32_t book_id;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("HỦY ĐẶT GIỮ SÁCH");
+
+    /* Nhập ID người dùng */
+    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Nhập ID sách */
+    status = read_uint(&book_id, "  Nhập ID sách: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID sách không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Thực hiện hủy đặt giữ */
+    mgmt_status = mgmt_cancel_hold(library, user_id, book_id);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã hủy đặt giữ!\n");
+            break;
+        case MGMT_BOOK_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy sách với ID %u!\n", book_id);
+            break;
+        case MGMT_HOLD_NOT_FOUND:
+            printf("\n  Lỗi: Người dùng chưa đặt giữ sách này!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể hủy đặt giữ!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Đọc một lượt quét và báo lỗi nếu mã không đọc được
+ * \param[out]      key: Khóa mã
+ * \param[in]       prompt: Lời nhắc
+ * \return          1 nếu đọc được mã, 0 nếu không (đã báo lỗi)
+ */
+static uint8_t
+read_barcode(uint64_t* key, const char* prompt) {
+    char text[MAX_INPUT_LENGTH];
+    barcode_status_t status;
+
+    if (read_string(text, sizeof(text), prompt) != UTILS_OK) {
+        printf("\n  Lỗi: Mã không hợp lệ!\n");
+        pause_screen();
+        return 0;
+    }
+
+    status = barcode_parse(text, key);
+    if (status == BARCODE_BAD_CHECKSUM) {
+        printf("\n  Lỗi: Sai chữ số kiểm tra ISBN, hãy quét lại!\n");
+    } else if (status != BARCODE_OK) {
+        printf("\n  Lỗi: Mã không hợp lệ!\n");
+    }
+    if (status != BARCODE_OK) {
+        pause_screen();
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief           Mượn sách bằng cách quét mã vạch bản sao hoặc ISBN (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+borrow_by_barcode_interactive(library_t* library) {
+    uint32_t user_id;
+    uint32_t book_id;
+    uint64_t key;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("MƯỢN SÁCH BẰNG MÃ VẠCH");
+
+    /* Nhập ID người dùng */
+    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Quét mã */
+    if (!read_barcode(&key, "  Quét mã vạch/ISBN: ")) {
+        return;
+    }
+
+    /* Thực hiện mượn sách */
+    book_id = 0;
+    mgmt_status = mgmt_borrow_by_barcode(library, user_id, key, &book_id);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã mượn sách ID %u!\n", book_id);
+            break;
+        case MGMT_USER_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
+            break;
+        case MGMT_BARCODE_NOT_FOUND:
+            printf("\n  Lỗi: Mã chưa được gán cho sách nào!\n");
+            break;
+        case MGMT_BOOK_ALREADY_BORROWED:
+            printf("\n  Lỗi: Bản sao này (hoặc mọi bản sao của sách) đang được mượn!\n");
+            break;
+        case MGMT_BOOK_RESERVED:
+            printf("\n  Lỗi: Sách đang được dành cho người đặt giữ trước!\n");
+            break;
+        case MGMT_USER_ALREADY_HAS_BOOK:
+            printf("\n  Lỗi: Người dùng đang mượn một bản của sách này!\n");
+            break;
+        case MGMT_USER_LIMIT_REACHED:
+            printf("\n  Lỗi: Người dùng đã mượn đủ số sách cho phép theo hạng!\n");
+            break;
+        case MGMT_LOAN_POOL_FULL:
+            printf("\n  Lỗi: Hết bộ nhớ lưu danh sách mượn, không thể ghi thêm lượt mượn!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể mượn sách!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
+/**
+ * \brief           Trả sách bằng cách quét mã vạch bản sao hoặc ISBN (tương tác với người dùng)
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+return_by_barcode_interactive(library_t* library) {
+    uint32_t user_id;
+    uint32_t handed_to;
+    uint64_t key;
+    utils_status_t status;
+    mgmt_status_t mgmt_status;
+
+    clear_screen();
+    print_header("TRẢ SÁCH BẰNG MÃ VẠCH");
+
+    /* Nhập ID người dùng */
+    status = read_uint(&user_id, "\n  Nhập ID người dùng: ");
+    if (status != UTILS_OK) {
+        printf("\n  Lỗi: ID người dùng không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    /* Quét mã */
+    if (!read_barcode(&key, "  Quét mã vạch/ISBN: ")) {
+        return;
+    }
+
+    /* Thực hiện trả sách */
+    mgmt_status = mgmt_return_by_barcode(library, user_id, key, &handed_to);
+    switch (mgmt_status) {
+        case MGMT_OK:
+            printf("\n  Thành công: Đã trả sách!\n");
+            if (handed_to != 0) {
+                printf("  Bản sao đã được chuyển cho người đặt giữ ID %u.\n", handed_to);
+            }
+            break;
+        case MGMT_USER_NOT_FOUND:
+            printf("\n  Lỗi: Không tìm thấy người dùng với ID %u!\n", user_id);
+            break;
+        case MGMT_BARCODE_NOT_FOUND:
+            printf("\n  Lỗi: Mã chưa được gán cho sách nào!\n");
+            break;
+        case MGMT_BOOK_NOT_BORROWED:
+            printf("\n  Lỗi: Người dùng này không mượn bản sao được quét!\n");
+            break;
+        default:
+            printf("\n  Lỗi: Không thể trả sách!\n");
+            break;
+    }
+
+    pause_screen();
+}
+
 /**
  * \brief           Tìm kiếm sách theo tiêu đề (tương tác với người dùng)
- * \param[in]       books: Con trỏ tới danh sách sách
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
  */
 static void
-search_by_title_interactive(book_list_t* books) {
+search_by_title_interactive(library_t* library) {
     char title[MAX_TITLE_LENGTH];
+    uint64_t started;
     utils_status_t status;
 
     clear_screen();
@@ -768,17 +1663,20 @@ search_by_title_interactive(book_list_t* books) {
     }
 
     /* Tìm kiếm */
-    book_search_by_title(books, title);
+    started = trace_clock_ns();
+    mgmt_search_books(library, QUERY_FIELD_TITLE, title);
+    trace_operation(TRACE_OP_SEARCH_TITLE, started, 0, 0, 0, 0, title, NULL);
     pause_screen();
 }
 
 /**
  * \brief           Tìm kiếm sách theo tác giả (tương tác với người dùng)
- * \param[in]       books: Con trỏ tới danh sách sách
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
  */
 static void
-search_by_author_interactive(book_list_t* books) {
+search_by_author_interactive(library_t* library) {
     char author[MAX_AUTHOR_LENGTH];
+    uint64_t started;
     utils_status_t status;
 
     clear_screen();
@@ -793,6 +1691,190 @@ search_by_author_interactive(book_list_t* books) {
     }
 
     /* Tìm kiếm */
-    book_search_by_author(books, author);
+    started = trace_clock_ns();
+    mgmt_search_books(library, QUERY_FIELD_AUTHOR, author);
+    trace_operation(TRACE_OP_SEARCH_AUTHOR, started, 0, 0, 0, 0, author, NULL);
+    pause_screen();
+}
+
+/**
+ * \brief           Tìm kiếm bằng biểu thức lọc (tương tác với người dùng)
+ *
+ * Biểu thức bắt đầu bằng EXPLAIN in thêm kế hoạch được chọn, các phương án bị
+ * loại và số sách thực tế đã kiểm tra.
+ *
+ * \param[in,out]   library: Con trỏ tới cấu trúc thư viện
+ */
+static void
+filter_search_interactive(library_t* library) {
+    char input[MAX_INPUT_LENGTH];
+    char plan[FILTER_EXPLAIN_LENGTH];
+    filter_query_t query;
+    filter_result_t result;
+    filter_status_t status;
+    size_t error_offset;
+    size_t i;
+
+    clear_screen();
+    print_header("TÌM KIẾM NÂNG CAO");
+    printf("\n  Ví dụ: title CONTAINS 'lập trình' AND available ORDER BY title LIMIT 10\n");
+    printf("         EXPLAIN author = 'Tác giả A' OR id BETWEEN 100 AND 200\n");
+
+    /* Nhập biểu thức */
+    if (read_string(input, sizeof(input), "\n  Nhập biểu thức lọc: ") != UTILS_OK) {
+        printf("\n  Lỗi: Biểu thức không hợp lệ!\n");
+        pause_screen();
+        return;
+    }
+
+    status = filter_parse(input, &query, &error_offset);
+    if (status != FILTER_OK) {
+        printf("\n  Lỗi: %s tại vị trí %zu: %s\n",
+               (status == FILTER_TOO_COMPLEX) ? "Biểu thức quá dài" : "Sai cú pháp", error_offset + 1,
+               (input[error_offset] != '\0') ? &input[error_offset] : "(cuối biểu thức)");
+        pause_screen();
+        return;
+    }
+
+    /* Lập kế hoạch và chạy */
+    status = filter_plan(&query, &app_filter, library->books);
+    if (status == FILTER_OK) {
+        status = filter_execute(&query, &app_filter, library->books, &result);
+    }
+    if (status != FILTER_OK) {
+        printf("\n  Lỗi: Không đủ bộ nhớ để dựng chỉ mục!\n");
+        pause_screen();
+        return;
+    }
+
+    if (query.explain) {
+        filter_explain(&query, plan, sizeof(plan));
+        printf("\n%s", plan);
+    }
+
+    book_display_header();
+    for (i = 0; i < result.count; i++) {
+        book_display_one(&library->books->books[result.positions[i]]);
+    }
+
+    if (result.total == 0) {
+        printf("\n  Không tìm thấy sách nào khớp biểu thức\n");
+    } else if (result.count < result.total) {
+        printf("\n  Tìm thấy %zu sách (hiển thị %zu)\n", result.total, result.count);
+    } else {
+        printf("\n  Tìm thấy %zu sách\n", result.total);
+    }
     pause_screen();
 }
+
+/**
+ * \brief           Mở nơi nhận thông báo và chạy dispatcher
+ *
+ * Mượn/trả chỉ đưa sự kiện vào hàng đợi; khi hàng đợi đầy sự kiện bị bỏ và
+ * được đếm chứ không làm chậm quầy mượn.
+ *
+ * \param[in]       target: Đường dẫn file, hoặc unix:<đường dẫn socket>
+ * \return          1 nếu thành công, 0 nếu lỗi
+ */
+static uint8_t
+start_notifications(const char* target) {
+    size_t prefix;
+
+    prefix = strlen(NOTIFY_SOCKET_PREFIX);
+    if (strncmp(target, NOTIFY_SOCKET_PREFIX, prefix) == 0) {
+        if (notify_socket_open(&app_notify_socket, target + prefix) != NOTIFY_OK) {
+            notify_socket_close(&app_notify_socket);
+            return 0;
+        }
+        if (notify_init(&app_notify, NOTIFY_POLICY_DROP, notify_socket_sink, &app_notify_socket) != NOTIFY_OK) {
+            notify_socket_close(&app_notify_socket);
+            return 0;
+        }
+        return 1;
+    }
+
+    app_notify_file = fopen(target, "a");
+    if (app_notify_file == NULL) {
+        return 0;
+    }
+    if (notify_init(&app_notify, NOTIFY_POLICY_DROP, notify_file_sink, app_notify_file) != NOTIFY_OK) {
+        fclose(app_notify_file);
+        app_notify_file = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief           Gửi nốt các thông báo còn lại rồi đóng nơi nhận
+ */
+static void
+stop_notifications(void) {
+    notify_destroy(&app_notify);
+    if (app_notify_file != NULL) {
+        fclose(app_notify_file);
+        app_notify_file = NULL;
+    } else {
+        notify_socket_close(&app_notify_socket);
+    }
+}
+
+/**
+ * \brief           In một trang sách khớp bộ lọc
+ * \param[in]       books: Danh sách sách
+ * \param[in]       filter: Bộ lọc
+ * \param[in]       offset: Số sách khớp bỏ qua
+ * \param[in]       rows: Số dòng tối đa
+ * \param[out]      more: 1 nếu còn sách sau trang
+ * \return          Số dòng đã in
+ */
+static size_t
+print_book_page(const book_list_t* books, book_filter_t filter, size_t offset, size_t rows, uint8_t* more) {
+    const book_t* page[SCREEN_MAX_PAGE_ROWS];
+    size_t count;
+    size_t i;
+
+    if (rows > SCREEN_MAX_PAGE_ROWS) {
+        rows = SCREEN_MAX_PAGE_ROWS;
+    }
+    count = book_query_page(books, filter, NULL, offset, page, rows, more);
+    for (i = 0; i < count; i++) {
+        book_display_one(page[i]);
+    }
+    return count;
+}
+
+/**
+ * \brief           In một trang của danh sách tất cả sách (\ref screen_page_fn)
+ */
+static size_t
+all_books_page(void* ctx, size_t offset, size_t rows, uint8_t* more) {
+    return print_book_page(ctx, BOOK_FILTER_ALL, offset, rows, more);
+}
+
+/**
+ * \brief           In một trang của danh sách sách có sẵn (\ref screen_page_fn)
+ */
+static size_t
+available_books_page(void* ctx, size_t offset, size_t rows, uint8_t* more) {
+    return print_book_page(ctx, BOOK_FILTER_AVAILABLE, offset, rows, more);
+}
+
+/**
+ * \brief           In một trang của danh sách người dùng (\ref screen_page_fn)
+ */
+static size_t
+users_page(void* ctx, size_t offset, size_t rows, uint8_t* more) {
+    const user_t* page[SCREEN_MAX_PAGE_ROWS];
+    size_t count;
+    size_t i;
+
+    if (rows > SCREEN_MAX_PAGE_ROWS) {
+        rows = SCREEN_MAX_PAGE_ROWS;
+    }
+    count = user_query_page(ctx, offset, page, rows, more);
+    for (i = 0; i < count; i++) {
+        user_display_one(page[i]);
+    }
+    return count;
+}
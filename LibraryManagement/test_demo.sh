@@ -28,6 +28,34 @@ files=(
     "User/user.c"
     "Management/management.h"
     "Management/management.c"
+    "Hold/hold.h"
+    "Hold/hold.c"
+    "Cache/cache.h"
+    "Cache/cache.c"
+    "Scan/scan.h"
+    "Scan/scan.c"
+    "Scan/scantest.c"
+    "Txn/txn.h"
+    "Txn/txn.c"
+    "Txn/txntest.c"
+    "Cdc/cdc.h"
+    "Cdc/cdc.c"
+    "Column/column.h"
+    "Column/column.c"
+    "History/history.h"
+    "History/history.c"
+    "Trace/trace.h"
+    "Trace/trace.c"
+    "Barcode/barcode.h"
+    "Barcode/barcode.c"
+    "Filter/filter.h"
+    "Filter/filter.c"
+    "Screen/screen.h"
+    "Screen/screen.c"
+    "Notify/notify.h"
+    "Notify/notify.c"
+    "Verify/verify.h"
+    "Verify/verify.c"
     "Ultils/utils.h"
     "Ultils/utils.c"
     "Makefile"
@@ -50,7 +78,7 @@ echo ""
 
 # Đếm số dòng code
 total_lines=0
-for file in main.c Book/*.c User/*.c Management/*.c Ultils/*.c; do
+for file in main.c Book/*.c User/*.c Management/*.c Hold/*.c Cache/*.c Scan/*.c Txn/*.c Cdc/*.c Column/*.c History/*.c Trace/*.c Barcode/*.c Filter/*.c Screen/*.c Notify/*.c Verify/*.c Ultils/*.c; do
     if [ -f "$file" ]; then
         lines=$(wc -l < "$file")
         total_lines=$((total_lines + lines))
@@ -62,6 +90,38 @@ echo ""
 echo "  Tổng số dòng code: $total_lines"
 echo ""
 
+echo "=========================================="
+echo "KIỂM TRA QUÉT SONG SONG"
+echo "=========================================="
+echo ""
+
+# Pool quét: chia phân đoạn, lấy trộm việc, kết quả khớp quét tuần tự
+if [ -f "bin/library_scantest" ]; then
+    if ! ./bin/library_scantest; then
+        echo "Lỗi: library_scantest không đạt!"
+        exit 1
+    fi
+else
+    echo "  Bỏ qua: chưa build bin/library_scantest"
+fi
+echo ""
+
+echo "=========================================="
+echo "KIỂM TRA KHO PHIÊN BẢN"
+echo "=========================================="
+echo ""
+
+# Kho MVCC: thêm/xóa liên tục không làm đầy bảng băm, snapshot cũ vẫn nhất quán
+if [ -f "bin/library_txntest" ]; then
+    if ! ./bin/library_txntest; then
+        echo "Lỗi: library_txntest không đạt!"
+        exit 1
+    fi
+else
+    echo "  Bỏ qua: chưa build bin/library_txntest"
+fi
+echo ""
+
 echo "=========================================="
 echo "HƯỚNG DẪN SỬ DỤNG"
 echo "=========================================="
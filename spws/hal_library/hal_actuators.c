@@ -2,11 +2,34 @@
  * Mô phỏng bộ chấp hành: bơm và LED trạng thái
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include "hal_actuators.h"
 
 static PumpState_t s_pumpState = PUMP_OFF;
 static LedState_t s_ledState = LED_OFF;
 
+static const char *led_label(LedState_t state)
+{
+    const char *label = "OFF";
+    switch (state)
+    {
+        case LED_GREEN:
+            label = "XANH (BINH THUONG)";
+            break;
+        case LED_YELLOW:
+            label = "VANG (DANG TUOI)";
+            break;
+        case LED_RED:
+            label = "DO (CANH BAO)";
+            break;
+        case LED_OFF:
+        default:
+            label = "TAT";
+            break;
+    }
+    return label;
+}
+
 void HAL_Actuators_Init(void)
 {
     s_pumpState = PUMP_OFF;
@@ -43,23 +66,59 @@ void HAL_SetLedState(LedState_t state)
     }
 
     s_ledState = state;
-    const char *label = "OFF";
-    switch (state)
+    printf("[ACTUATOR] LED -> %s\n", led_label(state));
+}
+
+bool HAL_ActuatorBank_Init(HAL_ActuatorBank_t *bank, uint32_t zoneCount, bool verbose)
+{
+    bank->zoneCount = zoneCount;
+    bank->verbose = verbose;
+    bank->writes = 0;
+    bank->pumpState = calloc(zoneCount, sizeof(bank->pumpState[0]));
+    bank->ledState = calloc(zoneCount, sizeof(bank->ledState[0]));
+    if (bank->pumpState == NULL || bank->ledState == NULL)
     {
-        case LED_GREEN:
-            label = "XANH (BINH THUONG)";
-            break;
-        case LED_YELLOW:
-            label = "VANG (DANG TUOI)";
-            break;
-        case LED_RED:
-            label = "DO (CANH BAO)";
-            break;
-        case LED_OFF:
-        default:
-            label = "TAT";
-            break;
+        HAL_ActuatorBank_Free(bank);
+        return false;
     }
+    return true;
+}
 
-    printf("[ACTUATOR] LED -> %s\n", label);
+void HAL_ActuatorBank_Free(HAL_ActuatorBank_t *bank)
+{
+    free(bank->pumpState);
+    free(bank->ledState);
+    bank->pumpState = NULL;
+    bank->ledState = NULL;
+    bank->zoneCount = 0;
+}
+
+void HAL_Zone_SetPump(HAL_ActuatorBank_t *bank, uint32_t zone, PumpState_t state)
+{
+    if (bank->pumpState[zone] == (uint8_t)state)
+    {
+        return;
+    }
+
+    bank->pumpState[zone] = (uint8_t)state;
+    bank->writes++;
+    if (bank->verbose)
+    {
+        printf("[ACTUATOR] ZONE %u BOM %s\n", zone, (state == PUMP_ON) ? "BAT" : "TAT");
+    }
+}
+
+void HAL_Zone_SetLed(HAL_ActuatorBank_t *bank, uint32_t zone, LedState_t state)
+{
+    if (bank->ledState[zone] == (uint8_t)state)
+    {
+        return;
+    }
+
+    bank->ledState[zone] = (uint8_t)state;
+    bank->writes++;
+    if (bank->verbose)
+    {
+        printf("[ACTUATOR] ZONE %u LED -> %s\n", zone, led_label(state));
+    }
 }
@@ -8,6 +8,8 @@
 #ifndef HAL_ACTUATORS_H
 #define HAL_ACTUATORS_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "../config.h"
 
 /* Khởi tạo tài nguyên bơm/LED, gọi một lần ở System_Init */
@@ -22,4 +24,30 @@ void HAL_TurnPumpOff(void);
 /* Đặt trạng thái LED theo LedState_t (GREEN/YELLOW/RED/OFF) */
 void HAL_SetLedState(LedState_t state);
 
+/*
+ * Bank bơm/LED cho nhiều vùng tưới: handle của mỗi vùng là chỉ số zone trong bank.
+ * Trạng thái lưu dạng mảng (1 byte mỗi vùng) để bộ điều khiển đa vùng duyệt liên tục trong cache.
+ * Log mặc định tắt vì hàng nghìn vùng in mỗi lần đổi trạng thái sẽ lấn át thời gian điều khiển.
+ */
+typedef struct
+{
+    uint32_t zoneCount;
+    uint8_t *pumpState;     /* PumpState_t của từng vùng */
+    uint8_t *ledState;      /* LedState_t của từng vùng */
+    bool verbose;           /* true: in log như bản một vùng */
+    uint64_t writes;        /* Số lần thực sự đổi trạng thái phần cứng */
+} HAL_ActuatorBank_t;
+
+/* Cấp phát bank cho zoneCount vùng, mọi bơm/LED ở trạng thái OFF; false nếu hết bộ nhớ */
+bool HAL_ActuatorBank_Init(HAL_ActuatorBank_t *bank, uint32_t zoneCount, bool verbose);
+
+/* Giải phóng bank */
+void HAL_ActuatorBank_Free(HAL_ActuatorBank_t *bank);
+
+/* Bật/tắt bơm của một vùng, idempotent */
+void HAL_Zone_SetPump(HAL_ActuatorBank_t *bank, uint32_t zone, PumpState_t state);
+
+/* Đặt LED của một vùng, bỏ qua nếu không đổi */
+void HAL_Zone_SetLed(HAL_ActuatorBank_t *bank, uint32_t zone, LedState_t state);
+
 #endif
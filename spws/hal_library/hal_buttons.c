@@ -5,36 +5,49 @@
  * Lịch mô phỏng:
  *    - Nút 1 nhấn tại giây 15 và 40.
  *    - Nút 2 nhấn tại giây 18 và 22 (chỉ có tác dụng khi đang MANUAL).
+ *    - Bank nhiều vùng: vùng z dùng cùng lịch, dời muộn (z % 60) giây.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include "hal_buttons.h"
 
-static uint32_t s_lastModeToggleTime = 0;
-static uint32_t s_lastManualPressTime = 0;
+#define BUTTON_SCHEDULE_LEN   2U
+#define ZONE_SHIFT_PERIOD_S   60U
+
+static const uint32_t s_modeSchedule[BUTTON_SCHEDULE_LEN] = {15U, 40U};
+static const uint32_t s_manualSchedule[BUTTON_SCHEDULE_LEN] = {18U, 22U};
+
+static uint32_t s_lastModePoll_s = 0;
+static uint32_t s_lastManualPoll_s = 0;
 
 void HAL_Buttons_Init(void)
 {
-    s_lastModeToggleTime = 0;
-    s_lastManualPressTime = 0;
+    s_lastModePoll_s = 0;
+    s_lastManualPoll_s = 0;
 }
 
-static bool is_time_in_list(uint32_t now_s, const uint32_t *timeList, uint32_t len, uint32_t *lastTime)
+/*
+ * Nút được coi là nhấn nếu có mốc (dời shift_s giây) trong (lần poll trước, now_s]: không phụ thuộc
+ * vòng lặp có ghé đúng từng giây hay không (sleep trễ, đồng hồ ảo), và mỗi mốc chỉ báo một lần.
+ */
+static bool is_time_in_list(uint32_t now_s, uint32_t shift_s, const uint32_t *timeList, uint32_t *lastPoll_s)
 {
-    for (uint32_t i = 0; i < len; ++i)
+    bool pressed = false;
+    for (uint32_t i = 0; i < BUTTON_SCHEDULE_LEN; ++i)
     {
-        if (now_s == timeList[i] && *lastTime != now_s)
+        uint32_t at_s = timeList[i] + shift_s;
+        if (at_s > *lastPoll_s && at_s <= now_s)
         {
-            *lastTime = now_s;
-            return true;
+            pressed = true;
         }
     }
-    return false;
+    *lastPoll_s = now_s;
+    return pressed;
 }
 
 bool HAL_Button_ModeTogglePressed(uint32_t now_s)
 {
-    const uint32_t schedule[] = {15U, 40U};
-    bool pressed = is_time_in_list(now_s, schedule, sizeof(schedule) / sizeof(schedule[0]), &s_lastModeToggleTime);
+    bool pressed = is_time_in_list(now_s, 0U, s_modeSchedule, &s_lastModePoll_s);
     if (pressed)
     {
         printf("[BUTTON] NUT CHUYEN CHE DO DUOC NHAN (t=%us)\n", now_s);
@@ -44,11 +57,70 @@ bool HAL_Button_ModeTogglePressed(uint32_t now_s)
 
 bool HAL_Button_ManualWaterPressed(uint32_t now_s)
 {
-    const uint32_t schedule[] = {18U, 22U};
-    bool pressed = is_time_in_list(now_s, schedule, sizeof(schedule) / sizeof(schedule[0]), &s_lastManualPressTime);
+    bool pressed = is_time_in_list(now_s, 0U, s_manualSchedule, &s_lastManualPoll_s);
     if (pressed)
     {
         printf("[BUTTON] NUT TUOI THU CONG DUOC NHAN (t=%us)\n", now_s);
     }
     return pressed;
 }
+
+bool HAL_ButtonBank_Init(HAL_ButtonBank_t *bank, uint32_t zoneCount)
+{
+    bank->zoneCount = zoneCount;
+    bank->lastModePoll_s = calloc(zoneCount, sizeof(bank->lastModePoll_s[0]));
+    bank->lastManualPoll_s = calloc(zoneCount, sizeof(bank->lastManualPoll_s[0]));
+    bank->polledThrough_s = 0;
+    bank->lastPress_s = 0;
+    uint32_t maxShift_s = (zoneCount < ZONE_SHIFT_PERIOD_S) ? zoneCount : ZONE_SHIFT_PERIOD_S;
+    maxShift_s = (maxShift_s > 0U) ? maxShift_s - 1U : 0U;
+    for (uint32_t i = 0; i < BUTTON_SCHEDULE_LEN; ++i)
+    {
+        if (s_modeSchedule[i] + maxShift_s > bank->lastPress_s)
+        {
+            bank->lastPress_s = s_modeSchedule[i] + maxShift_s;
+        }
+        if (s_manualSchedule[i] + maxShift_s > bank->lastPress_s)
+        {
+            bank->lastPress_s = s_manualSchedule[i] + maxShift_s;
+        }
+    }
+    if (bank->lastModePoll_s == NULL || bank->lastManualPoll_s == NULL)
+    {
+        HAL_ButtonBank_Free(bank);
+        return false;
+    }
+    return true;
+}
+
+void HAL_ButtonBank_Free(HAL_ButtonBank_t *bank)
+{
+    free(bank->lastModePoll_s);
+    free(bank->lastManualPoll_s);
+    bank->lastModePoll_s = NULL;
+    bank->lastManualPoll_s = NULL;
+    bank->zoneCount = 0;
+}
+
+bool HAL_ButtonBank_Pending(HAL_ButtonBank_t *bank, uint32_t now_s)
+{
+    /* Lịch tăng dần nên mốc sớm nhất là phần tử đầu (vùng 0); sau mốc muộn nhất thì không còn lần nhấn nào */
+    uint32_t firstPress_s = (s_modeSchedule[0] < s_manualSchedule[0]) ? s_modeSchedule[0] : s_manualSchedule[0];
+    if (now_s < firstPress_s || bank->polledThrough_s >= bank->lastPress_s)
+    {
+        return false;
+    }
+
+    bank->polledThrough_s = now_s;
+    return true;
+}
+
+bool HAL_Zone_ModeTogglePressed(HAL_ButtonBank_t *bank, uint32_t zone, uint32_t now_s)
+{
+    return is_time_in_list(now_s, zone % ZONE_SHIFT_PERIOD_S, s_modeSchedule, &bank->lastModePoll_s[zone]);
+}
+
+bool HAL_Zone_ManualWaterPressed(HAL_ButtonBank_t *bank, uint32_t zone, uint32_t now_s)
+{
+    return is_time_in_list(now_s, zone % ZONE_SHIFT_PERIOD_S, s_manualSchedule, &bank->lastManualPoll_s[zone]);
+}
@@ -1,7 +1,7 @@
 /*
  * HAL - Nút nhấn giả lập.
  * Mục tiêu: giữ giao diện giống phần cứng (polling, trả về bool), phần triển khai có thể thay thế.
- * Phiên bản mô phỏng: trả về true tại các mốc thời gian cố định, tránh cần input người dùng.
+ * Phiên bản mô phỏng: trả về true khi đồng hồ hệ thống vượt qua các mốc cố định, tránh cần input người dùng.
  */
 #ifndef HAL_BUTTONS_H
 #define HAL_BUTTONS_H
@@ -10,7 +10,7 @@
 #include <stdint.h>
 #include "../config.h"
 
-/* Khởi tạo state mô phỏng nút, reset anti-dup chống lặp lại cùng timestamp */
+/* Khởi tạo state mô phỏng nút, reset mốc poll gần nhất (chống báo lặp cùng một lần nhấn) */
 void HAL_Buttons_Init(void);
 
 /* Kiểm tra nút chuyển chế độ (AUTO <-> MANUAL), true nếu vừa được nhấn tại thời điểm now_s */
@@ -19,4 +19,36 @@ bool HAL_Button_ModeTogglePressed(uint32_t now_s);
 /* Kiểm tra nút tưới thủ công, true nếu vừa được nhấn tại thời điểm now_s */
 bool HAL_Button_ManualWaterPressed(uint32_t now_s);
 
+/*
+ * Bank nút nhấn cho nhiều vùng tưới: handle là chỉ số zone.
+ * Lịch của vùng z là lịch một vùng dời muộn (z % 60) giây; vùng 0 trùng bản một vùng.
+ */
+typedef struct
+{
+    uint32_t zoneCount;
+    uint32_t *lastModePoll_s;     /* Mốc poll gần nhất của nút chuyển chế độ từng vùng */
+    uint32_t *lastManualPoll_s;   /* Mốc poll gần nhất của nút tưới tay từng vùng */
+    uint32_t polledThrough_s;     /* Mọi vùng đã được poll tới mốc này */
+    uint32_t lastPress_s;         /* Mốc nhấn muộn nhất trong lịch của mọi vùng */
+} HAL_ButtonBank_t;
+
+/* Cấp phát bank; false nếu hết bộ nhớ */
+bool HAL_ButtonBank_Init(HAL_ButtonBank_t *bank, uint32_t zoneCount);
+
+/* Giải phóng bank */
+void HAL_ButtonBank_Free(HAL_ButtonBank_t *bank);
+
+/*
+ * Gọi một lần mỗi tick, giống đọc thanh ghi cờ ngắt của cả bank: false nghĩa là không vùng nào
+ * có lần nhấn mới trong (lần poll trước, now_s] nên có thể bỏ qua poll từng vùng ở tick này.
+ * true thì người gọi phải poll mọi vùng tại now_s.
+ */
+bool HAL_ButtonBank_Pending(HAL_ButtonBank_t *bank, uint32_t now_s);
+
+/* Nút chuyển chế độ của một vùng, true nếu được nhấn trong (lần poll trước, now_s] */
+bool HAL_Zone_ModeTogglePressed(HAL_ButtonBank_t *bank, uint32_t zone, uint32_t now_s);
+
+/* Nút tưới thủ công của một vùng, true nếu được nhấn trong (lần poll trước, now_s] */
+bool HAL_Zone_ManualWaterPressed(HAL_ButtonBank_t *bank, uint32_t zone, uint32_t now_s);
+
 #endif
@@ -0,0 +1,65 @@
+/*
+ * Đồng hồ hệ thống: thật hoặc ảo.
+ * Đồng hồ ảo chỉ là bộ đếm giây tăng ở mỗi WaitTick, nên logic điều khiển thấy đúng
+ * chuỗi thời điểm như khi chạy thật, không bỏ sót giây nào.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "hal_clock.h"
+
+static ClockMode_t s_mode = CLOCK_MODE_REALTIME;
+static uint32_t s_speed = 1U;
+static time_t s_startTime = 0;
+static uint32_t s_virtualSeconds = 0;
+
+void HAL_Clock_Init(ClockMode_t mode, uint32_t speed)
+{
+    s_mode = mode;
+    s_speed = (speed == 0U) ? 1U : speed;
+    s_startTime = time(NULL);
+    s_virtualSeconds = 0;
+}
+
+uint32_t HAL_Clock_NowSeconds(void)
+{
+    if (s_mode != CLOCK_MODE_REALTIME)
+    {
+        return s_virtualSeconds;
+    }
+
+    time_t now = time(NULL);
+    if (s_startTime == 0)
+    {
+        s_startTime = now;
+    }
+    return (uint32_t)(now - s_startTime);
+}
+
+void HAL_Clock_WaitTick(void)
+{
+    struct timespec delay;
+
+    switch (s_mode)
+    {
+        case CLOCK_MODE_ACCELERATED:
+            delay.tv_sec = (time_t)(1U / s_speed);
+            delay.tv_nsec = (long)((1000000000UL / s_speed) % 1000000000UL);
+            nanosleep(&delay, NULL);
+            s_virtualSeconds++;
+            break;
+        case CLOCK_MODE_FREERUN:
+            s_virtualSeconds++;
+            break;
+        case CLOCK_MODE_REALTIME:
+        default:
+            delay.tv_sec = 1;
+            delay.tv_nsec = 0;
+            nanosleep(&delay, NULL);
+            break;
+    }
+}
+
+ClockMode_t HAL_Clock_GetMode(void)
+{
+    return s_mode;
+}
@@ -0,0 +1,33 @@
+/*
+ * HAL - Đồng hồ hệ thống.
+ * Mọi module lấy thời gian và chờ tick qua đây, nhờ đó có thể thay đồng hồ thật bằng đồng hồ ảo:
+ * - REALTIME: thời gian thực (time()), mỗi tick ngủ 1 giây như phần cứng.
+ * - ACCELERATED: đồng hồ ảo, mỗi tick tăng 1 giây nhưng chỉ ngủ 1/speed giây.
+ * - FREERUN: đồng hồ ảo, không ngủ; chạy nhanh nhất CPU cho phép để kiểm thử dài ngày.
+ */
+#ifndef HAL_CLOCK_H
+#define HAL_CLOCK_H
+
+#include <stdint.h>
+#include "../config.h"
+
+typedef enum
+{
+    CLOCK_MODE_REALTIME = 0,
+    CLOCK_MODE_ACCELERATED,
+    CLOCK_MODE_FREERUN
+} ClockMode_t;
+
+/* Chọn chế độ đồng hồ và đặt mốc 0; speed chỉ dùng cho ACCELERATED (số giây ảo mỗi giây thật) */
+void HAL_Clock_Init(ClockMode_t mode, uint32_t speed);
+
+/* Số giây kể từ khi Init (thật hoặc ảo tùy chế độ) */
+uint32_t HAL_Clock_NowSeconds(void);
+
+/* Chờ tới tick kế tiếp (1 giây của hệ thống) */
+void HAL_Clock_WaitTick(void);
+
+/* Chế độ đang dùng */
+ClockMode_t HAL_Clock_GetMode(void);
+
+#endif
@@ -4,42 +4,82 @@
  *  - Nhiệt độ dao động nhẹ quanh 27-28 độ C.
  */
 #include <stddef.h>
-#include <time.h>
+#include <stdlib.h>
 #include "hal_sensors.h"
+#include "hal_clock.h"
 
-static time_t s_startTime = 0;
+static const float s_moistureSamples[] = {42.0f, 40.0f, 38.5f, 36.0f, 33.0f, 30.0f, 27.5f, 25.0f, 23.0f, 35.0f, 48.0f, 58.0f, 66.0f, 71.0f};
+static const float s_temperatureSamples[] = {27.0f, 27.3f, 27.5f, 27.8f, 28.0f};
+
+#define MOISTURE_SAMPLE_COUNT    (sizeof(s_moistureSamples) / sizeof(s_moistureSamples[0]))
+#define TEMPERATURE_SAMPLE_COUNT (sizeof(s_temperatureSamples) / sizeof(s_temperatureSamples[0]))
+
+static size_t s_moistureIndex = 0;
+static size_t s_temperatureIndex = 0;
 
 void HAL_Sensors_Init(void)
 {
-    s_startTime = time(NULL);
+    s_moistureIndex = 0;
+    s_temperatureIndex = 0;
 }
 
 float HAL_ReadSoilMoisture(void)
 {
-    static const float samples[] = {42.0f, 40.0f, 38.5f, 36.0f, 33.0f, 30.0f, 27.5f, 25.0f, 23.0f, 35.0f, 48.0f, 58.0f, 66.0f, 71.0f};
-    static size_t index = 0;
-
-    float value = samples[index];
-    index = (index + 1) % (sizeof(samples) / sizeof(samples[0]));
+    float value = s_moistureSamples[s_moistureIndex];
+    s_moistureIndex = (s_moistureIndex + 1) % MOISTURE_SAMPLE_COUNT;
     return value;
 }
 
 float HAL_ReadAmbientTemperature(void)
 {
-    static const float temps[] = {27.0f, 27.3f, 27.5f, 27.8f, 28.0f};
-    static size_t index = 0;
-
-    float value = temps[index];
-    index = (index + 1) % (sizeof(temps) / sizeof(temps[0]));
+    float value = s_temperatureSamples[s_temperatureIndex];
+    s_temperatureIndex = (s_temperatureIndex + 1) % TEMPERATURE_SAMPLE_COUNT;
     return value;
 }
 
-uint32_t HAL_GetSystemTimeSeconds(void)
+bool HAL_SensorBank_Init(HAL_SensorBank_t *bank, uint32_t zoneCount)
 {
-    time_t now = time(NULL);
-    if (s_startTime == 0)
+    bank->zoneCount = zoneCount;
+    bank->moistureIndex = malloc(zoneCount * sizeof(bank->moistureIndex[0]));
+    bank->temperatureIndex = malloc(zoneCount * sizeof(bank->temperatureIndex[0]));
+    if (bank->moistureIndex == NULL || bank->temperatureIndex == NULL)
     {
-        s_startTime = now;
+        HAL_SensorBank_Free(bank);
+        return false;
     }
-    return (uint32_t)(now - s_startTime);
+
+    for (uint32_t zone = 0; zone < zoneCount; ++zone)
+    {
+        bank->moistureIndex[zone] = (uint8_t)(zone % MOISTURE_SAMPLE_COUNT);
+        bank->temperatureIndex[zone] = (uint8_t)(zone % TEMPERATURE_SAMPLE_COUNT);
+    }
+    return true;
+}
+
+void HAL_SensorBank_Free(HAL_SensorBank_t *bank)
+{
+    free(bank->moistureIndex);
+    free(bank->temperatureIndex);
+    bank->moistureIndex = NULL;
+    bank->temperatureIndex = NULL;
+    bank->zoneCount = 0;
+}
+
+float HAL_Zone_ReadSoilMoisture(HAL_SensorBank_t *bank, uint32_t zone)
+{
+    uint8_t index = bank->moistureIndex[zone];
+    bank->moistureIndex[zone] = (uint8_t)((index + 1U < MOISTURE_SAMPLE_COUNT) ? index + 1U : 0U);
+    return s_moistureSamples[index];
+}
+
+float HAL_Zone_ReadAmbientTemperature(HAL_SensorBank_t *bank, uint32_t zone)
+{
+    uint8_t index = bank->temperatureIndex[zone];
+    bank->temperatureIndex[zone] = (uint8_t)((index + 1U < TEMPERATURE_SAMPLE_COUNT) ? index + 1U : 0U);
+    return s_temperatureSamples[index];
+}
+
+uint32_t HAL_GetSystemTimeSeconds(void)
+{
+    return HAL_Clock_NowSeconds();
 }
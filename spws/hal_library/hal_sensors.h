@@ -6,10 +6,11 @@
 #ifndef HAL_SENSORS_H
 #define HAL_SENSORS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "../config.h"
 
-/* Khởi tạo thời điểm bắt đầu (làm mốc cho đồng hồ ảo) */
+/* Đưa chuỗi mẫu về đầu để mỗi lần chạy mô phỏng cho cùng kết quả */
 void HAL_Sensors_Init(void);
 
 /* Đọc độ ẩm đất (0-100%), mô phỏng từ chuỗi mẫu */
@@ -18,7 +19,30 @@ float HAL_ReadSoilMoisture(void);
 /* Đọc nhiệt độ môi trường, dao động nhẹ quanh 27-28C */
 float HAL_ReadAmbientTemperature(void);
 
-/* Đồng hồ ảo, trả về số giây kể từ khi Init */
+/*
+ * Bank cảm biến cho nhiều vùng tưới: handle là chỉ số zone.
+ * Mỗi vùng có con trỏ mẫu riêng, lệch pha theo zone để các luống không khô cùng lúc.
+ */
+typedef struct
+{
+    uint32_t zoneCount;
+    uint8_t *moistureIndex;     /* Vị trí trong chuỗi mẫu độ ẩm của từng vùng */
+    uint8_t *temperatureIndex;  /* Vị trí trong chuỗi mẫu nhiệt độ của từng vùng */
+} HAL_SensorBank_t;
+
+/* Cấp phát bank; vùng 0 đọc cùng chuỗi với bản một vùng; false nếu hết bộ nhớ */
+bool HAL_SensorBank_Init(HAL_SensorBank_t *bank, uint32_t zoneCount);
+
+/* Giải phóng bank */
+void HAL_SensorBank_Free(HAL_SensorBank_t *bank);
+
+/* Đọc độ ẩm đất của một vùng */
+float HAL_Zone_ReadSoilMoisture(HAL_SensorBank_t *bank, uint32_t zone);
+
+/* Đọc nhiệt độ môi trường tại một vùng */
+float HAL_Zone_ReadAmbientTemperature(HAL_SensorBank_t *bank, uint32_t zone);
+
+/* Số giây kể từ khi khởi động, lấy từ hal_clock (thật hoặc ảo tùy chế độ) */
 uint32_t HAL_GetSystemTimeSeconds(void);
 
 #endif
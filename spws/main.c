@@ -1,18 +1,104 @@
 /*
  * Vòng lặp chính điều khiển hệ thống tưới cây thông minh
  */
+#include <errno.h>
 #include <stdio.h>
-#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "config.h"
 #include "spws_controller/spws_controller.h"
+#include "spws_controller/spws_zones.h"
 #include "hal_library/hal_sensors.h"
 #include "hal_library/hal_actuators.h"
 #include "hal_library/hal_buttons.h"
+#include "hal_library/hal_clock.h"
+
+/* Giới hạn tham số dòng lệnh: HAL ngủ 1e9/N ns mỗi tick, mỗi vùng cấp phát vài chục byte ở mọi bank */
+#define ARG_MAX_SPEED       1000000000U
+#define ARG_MAX_ZONES       1000000U
 
 static SystemState_t g_systemState;
 static SystemSettings_t g_systemSettings;
 static SensorData_t g_sensorData;
 
+/* Thống kê cho chế độ mô phỏng có giới hạn thời gian */
+static uint32_t g_pumpStarts;
+static uint32_t g_pumpOnSeconds;
+
+static void Print_Usage(const char *prog)
+{
+    printf("Cach dung: %s [-x toc_do | -f] [-t so_giay_mo_phong] [-z so_vung]\n", prog);
+    printf("  -x N: dong ho ao, moi giay that chay N giay mo phong (1..%u)\n", ARG_MAX_SPEED);
+    printf("  -f  : dong ho ao chay nhanh nhat CPU cho phep (free-running)\n");
+    printf("  -t N: dung sau N giay mo phong va in thong ke (0 = chay mai)\n");
+    printf("  -z N: dieu khien N vung tuoi cung luc, in tong hop moi gio mo phong (1..%u)\n", ARG_MAX_ZONES);
+}
+
+/* strtoul nhận dấu '-' rồi quay vòng và bỏ qua phần đuôi, nên tự kiểm tra chữ số, tràn và khoảng */
+static bool Parse_Uint(const char *text, uint32_t min, uint32_t max, uint32_t *value)
+{
+    char *end;
+    unsigned long parsed;
+
+    if (text[0] < '0' || text[0] > '9')
+    {
+        return false;
+    }
+    errno = 0;
+    parsed = strtoul(text, &end, 10);
+    if (errno != 0 || *end != '\0' || parsed < min || parsed > max)
+    {
+        return false;
+    }
+    *value = (uint32_t)parsed;
+    return true;
+}
+
+static bool Parse_Args(int argc, char **argv, ClockMode_t *mode, uint32_t *speed, uint32_t *duration_s,
+                       uint32_t *zoneCount)
+{
+    *mode = CLOCK_MODE_REALTIME;
+    *speed = 1U;
+    *duration_s = 0U;
+    *zoneCount = 0U;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-f") == 0)
+        {
+            *mode = CLOCK_MODE_FREERUN;
+        }
+        else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+        {
+            *mode = CLOCK_MODE_ACCELERATED;
+            if (!Parse_Uint(argv[++i], 1U, ARG_MAX_SPEED, speed))
+            {
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            if (!Parse_Uint(argv[++i], 0U, UINT32_MAX, duration_s))
+            {
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "-z") == 0 && i + 1 < argc)
+        {
+            if (!Parse_Uint(argv[++i], 1U, ARG_MAX_ZONES, zoneCount))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 static void System_Init(void)
 {
     HAL_Actuators_Init();
@@ -31,13 +117,89 @@ static void System_Init(void)
            g_systemSettings.manualWateringDuration_s);
 }
 
-int main(void)
+/* Vòng lặp nhiều vùng: mỗi tick một lượt SPWS_Zones_Step, log gộp theo giờ thay vì theo vùng */
+static int Run_Zones(uint32_t zoneCount, uint32_t duration_s)
 {
+    HAL_ActuatorBank_t actuators;
+    HAL_SensorBank_t sensors;
+    HAL_ButtonBank_t buttons;
+    SPWS_ZoneArray_t zones;
+    clock_t stepClocks = 0;
+    uint32_t ticks = 0;
+
+    if (!HAL_ActuatorBank_Init(&actuators, zoneCount, false) || !HAL_SensorBank_Init(&sensors, zoneCount)
+        || !HAL_ButtonBank_Init(&buttons, zoneCount)
+        || !SPWS_Zones_Init(&zones, zoneCount, &actuators, &sensors, &buttons))
+    {
+        printf("[SYSTEM] Khong du bo nho cho %u vung\n", zoneCount);
+        return 1;
+    }
+    printf("[SYSTEM] Khoi dong SPWS - %u vung, AUTO, bom OFF\n", zoneCount);
+
+    while (1)
+    {
+        uint32_t now_s = HAL_GetSystemTimeSeconds();
+        if (duration_s != 0U && now_s >= duration_s)
+        {
+            break;
+        }
+
+        clock_t stepStart = clock();
+        SPWS_Zones_Step(&zones, now_s);
+        stepClocks += clock() - stepStart;
+        ticks++;
+
+        if (now_s % 3600U == 0U)
+        {
+            printf("[ZONES] t=%us | dang bom %u/%u vung | bat bom %llu lan | %.1f us/tick\n",
+                   now_s, zones.pumpsOn, zoneCount, (unsigned long long)zones.pumpStarts,
+                   (double)stepClocks * 1e6 / CLOCKS_PER_SEC / ticks);
+        }
+        HAL_Clock_WaitTick();
+    }
+
+    printf("[SYSTEM] Ket thuc mo phong %us, %u vung: bom bat %llu lan, tong %llu giay-vung, %llu lan ghi HAL, "
+           "%.1f us/tick (%.1f ns/vung)\n",
+           duration_s, zoneCount, (unsigned long long)zones.pumpStarts, (unsigned long long)zones.pumpOnZoneSeconds,
+           (unsigned long long)actuators.writes, (ticks != 0U) ? (double)stepClocks * 1e6 / CLOCKS_PER_SEC / ticks : 0.0,
+           (ticks != 0U) ? (double)stepClocks * 1e9 / CLOCKS_PER_SEC / ticks / zoneCount : 0.0);
+
+    SPWS_Zones_Free(&zones);
+    HAL_ButtonBank_Free(&buttons);
+    HAL_SensorBank_Free(&sensors);
+    HAL_ActuatorBank_Free(&actuators);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    ClockMode_t clockMode;
+    uint32_t speed;
+    uint32_t duration_s;
+    uint32_t zoneCount;
+
+    if (!Parse_Args(argc, argv, &clockMode, &speed, &duration_s, &zoneCount))
+    {
+        Print_Usage(argv[0]);
+        return 1;
+    }
+
+    HAL_Clock_Init(clockMode, speed);
+    if (zoneCount > 0U)
+    {
+        return Run_Zones(zoneCount, duration_s);
+    }
     System_Init();
+    clock_t cpuStart = clock();
 
     while (1)
     {
         uint32_t now_s = HAL_GetSystemTimeSeconds();
+        if (duration_s != 0U && now_s >= duration_s)
+        {
+            break;
+        }
+        PumpState_t pumpBefore = g_systemState.pumpState;
 
         if (HAL_Button_ModeTogglePressed(now_s))
         {
@@ -54,11 +216,8 @@ int main(void)
             }
         }
 
-        bool manualPressed = false;
-        if (g_systemState.mode == MODE_MANUAL)
-        {
-            manualPressed = HAL_Button_ManualWaterPressed(now_s);
-        }
+        /* Luôn poll để lần nhấn lúc AUTO không bị tính lại khi vừa chuyển sang MANUAL */
+        bool manualPressed = HAL_Button_ManualWaterPressed(now_s) && g_systemState.mode == MODE_MANUAL;
 
         if ((now_s - g_sensorData.lastReadTime_s) >= g_systemSettings.sensorReadInterval_s)
         {
@@ -82,8 +241,20 @@ int main(void)
         }
 
         SPWS_ApplyOutputs(&g_systemState);
-        sleep(1);
+
+        if (pumpBefore == PUMP_OFF && g_systemState.pumpState == PUMP_ON)
+        {
+            g_pumpStarts++;
+        }
+        if (g_systemState.pumpState == PUMP_ON)
+        {
+            g_pumpOnSeconds++;
+        }
+        HAL_Clock_WaitTick();
     }
 
+    double cpu_ms = (double)(clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC;
+    printf("[SYSTEM] Ket thuc mo phong %us (%.2f ngay): bom bat %u lan, tong %us, CPU %.1f ms\n",
+           duration_s, (double)duration_s / 86400.0, g_pumpStarts, g_pumpOnSeconds, cpu_ms);
     return 0;
 }
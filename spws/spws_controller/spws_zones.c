@@ -0,0 +1,203 @@
+/*
+ * Bộ điều khiển nhiều vùng tưới dạng struct-of-arrays
+ */
+#include <stdlib.h>
+#include "spws_zones.h"
+#include "spws_controller.h"
+
+/* Cấp phát một mảng, ghi nhận lỗi vào *ok */
+static void *zone_array(uint32_t zoneCount, size_t elementSize, bool *ok)
+{
+    void *array = calloc(zoneCount, elementSize);
+    if (array == NULL)
+    {
+        *ok = false;
+    }
+    return array;
+}
+
+static void start_pump(SPWS_ZoneArray_t *zones, uint32_t zone, uint32_t now_s)
+{
+    HAL_Zone_SetPump(zones->actuators, zone, PUMP_ON);
+    zones->pumpState[zone] = PUMP_ON;
+    zones->pumpStartedAt_s[zone] = now_s;
+    zones->pumpStarts++;
+}
+
+static void stop_pump(SPWS_ZoneArray_t *zones, uint32_t zone)
+{
+    if (zones->pumpState[zone] == PUMP_OFF)
+    {
+        return;
+    }
+
+    HAL_Zone_SetPump(zones->actuators, zone, PUMP_OFF);
+    zones->pumpState[zone] = PUMP_OFF;
+    zones->autoWateringActive[zone] = false;
+    zones->manualWateringActive[zone] = false;
+}
+
+bool SPWS_Zones_Init(SPWS_ZoneArray_t *zones, uint32_t zoneCount, HAL_ActuatorBank_t *actuators,
+                     HAL_SensorBank_t *sensors, HAL_ButtonBank_t *buttons)
+{
+    SystemSettings_t defaults;
+    SystemState_t state;
+    SensorData_t sensorData;
+    bool ok = true;
+
+    zones->zoneCount = zoneCount;
+    zones->minMoistureThreshold = zone_array(zoneCount, sizeof(float), &ok);
+    zones->maxMoistureThreshold = zone_array(zoneCount, sizeof(float), &ok);
+    zones->sensorReadInterval_s = zone_array(zoneCount, sizeof(uint32_t), &ok);
+    zones->maxWateringDuration_s = zone_array(zoneCount, sizeof(uint32_t), &ok);
+    zones->manualWateringDuration_s = zone_array(zoneCount, sizeof(uint32_t), &ok);
+    zones->soilMoisturePercent = zone_array(zoneCount, sizeof(float), &ok);
+    zones->ambientTemperatureC = zone_array(zoneCount, sizeof(float), &ok);
+    zones->lastReadTime_s = zone_array(zoneCount, sizeof(uint32_t), &ok);
+    zones->mode = zone_array(zoneCount, sizeof(uint8_t), &ok);
+    zones->pumpState = zone_array(zoneCount, sizeof(uint8_t), &ok);
+    zones->ledState = zone_array(zoneCount, sizeof(uint8_t), &ok);
+    zones->autoWateringActive = zone_array(zoneCount, sizeof(uint8_t), &ok);
+    zones->manualWateringActive = zone_array(zoneCount, sizeof(uint8_t), &ok);
+    zones->pumpStartedAt_s = zone_array(zoneCount, sizeof(uint32_t), &ok);
+    zones->manualWaterStartedAt_s = zone_array(zoneCount, sizeof(uint32_t), &ok);
+    zones->actuators = actuators;
+    zones->sensors = sensors;
+    zones->buttons = buttons;
+    zones->pumpsOn = 0;
+    zones->pumpStarts = 0;
+    zones->pumpOnZoneSeconds = 0;
+    if (!ok)
+    {
+        SPWS_Zones_Free(zones);
+        return false;
+    }
+
+    /* Cùng giá trị mặc định với bản một vùng; calloc đã cho state/sensor bằng 0 */
+    SPWS_InitDefaults(&state, &defaults, &sensorData);
+    for (uint32_t zone = 0; zone < zoneCount; ++zone)
+    {
+        SPWS_Zones_SetSettings(zones, zone, &defaults);
+        zones->mode[zone] = (uint8_t)state.mode;
+        zones->pumpState[zone] = (uint8_t)state.pumpState;
+        zones->ledState[zone] = (uint8_t)state.ledState;
+    }
+    return true;
+}
+
+void SPWS_Zones_Free(SPWS_ZoneArray_t *zones)
+{
+    free(zones->minMoistureThreshold);
+    free(zones->maxMoistureThreshold);
+    free(zones->sensorReadInterval_s);
+    free(zones->maxWateringDuration_s);
+    free(zones->manualWateringDuration_s);
+    free(zones->soilMoisturePercent);
+    free(zones->ambientTemperatureC);
+    free(zones->lastReadTime_s);
+    free(zones->mode);
+    free(zones->pumpState);
+    free(zones->ledState);
+    free(zones->autoWateringActive);
+    free(zones->manualWateringActive);
+    free(zones->pumpStartedAt_s);
+    free(zones->manualWaterStartedAt_s);
+    zones->zoneCount = 0;
+}
+
+void SPWS_Zones_SetSettings(SPWS_ZoneArray_t *zones, uint32_t zone, const SystemSettings_t *settings)
+{
+    zones->minMoistureThreshold[zone] = settings->minMoistureThreshold;
+    zones->maxMoistureThreshold[zone] = settings->maxMoistureThreshold;
+    zones->sensorReadInterval_s[zone] = settings->sensorReadInterval_s;
+    zones->maxWateringDuration_s[zone] = settings->maxWateringDuration_s;
+    zones->manualWateringDuration_s[zone] = settings->manualWateringDuration_s;
+}
+
+void SPWS_Zones_Step(SPWS_ZoneArray_t *zones, uint32_t now_s)
+{
+    uint32_t pumpsOn = 0;
+    bool buttonsPending = HAL_ButtonBank_Pending(zones->buttons, now_s);
+
+    for (uint32_t zone = 0; zone < zones->zoneCount; ++zone)
+    {
+        /* Nút chuyển chế độ: sang MANUAL thì tắt bơm nếu đang chạy */
+        if (buttonsPending && HAL_Zone_ModeTogglePressed(zones->buttons, zone, now_s))
+        {
+            if (zones->mode[zone] == MODE_AUTO)
+            {
+                zones->mode[zone] = MODE_MANUAL;
+                stop_pump(zones, zone);
+            }
+            else
+            {
+                zones->mode[zone] = MODE_AUTO;
+            }
+        }
+
+        bool manualPressed = buttonsPending && HAL_Zone_ManualWaterPressed(zones->buttons, zone, now_s)
+                             && zones->mode[zone] == MODE_MANUAL;
+
+        if ((now_s - zones->lastReadTime_s[zone]) >= zones->sensorReadInterval_s[zone])
+        {
+            zones->soilMoisturePercent[zone] = HAL_Zone_ReadSoilMoisture(zones->sensors, zone);
+            zones->ambientTemperatureC[zone] = HAL_Zone_ReadAmbientTemperature(zones->sensors, zone);
+            zones->lastReadTime_s[zone] = now_s;
+        }
+
+        if (zones->mode[zone] == MODE_AUTO)
+        {
+            /* Giống SPWS_RunAutoMode */
+            if (zones->pumpState[zone] == PUMP_OFF)
+            {
+                if (zones->soilMoisturePercent[zone] < zones->minMoistureThreshold[zone])
+                {
+                    zones->autoWateringActive[zone] = true;
+                    zones->manualWateringActive[zone] = false;
+                    start_pump(zones, zone, now_s);
+                }
+            }
+            else if (zones->soilMoisturePercent[zone] > zones->maxMoistureThreshold[zone]
+                     || (now_s - zones->pumpStartedAt_s[zone]) >= zones->maxWateringDuration_s[zone])
+            {
+                stop_pump(zones, zone);
+            }
+        }
+        else
+        {
+            /* Giống SPWS_RunManualMode */
+            if (manualPressed)
+            {
+                zones->manualWateringActive[zone] = true;
+                zones->autoWateringActive[zone] = false;
+                zones->manualWaterStartedAt_s[zone] = now_s;
+                if (zones->pumpState[zone] == PUMP_OFF)
+                {
+                    start_pump(zones, zone, now_s);
+                }
+                else
+                {
+                    zones->pumpStartedAt_s[zone] = now_s;
+                }
+            }
+
+            if (zones->manualWateringActive[zone] && zones->pumpState[zone] == PUMP_ON
+                && (now_s - zones->manualWaterStartedAt_s[zone]) >= zones->manualWateringDuration_s[zone])
+            {
+                stop_pump(zones, zone);
+            }
+        }
+
+        /* Giống SPWS_ApplyOutputs; chỉ gọi HAL khi LED đổi màu (phần lớn tick không đổi) */
+        LedState_t targetLed = (zones->pumpState[zone] == PUMP_ON) ? LED_YELLOW : LED_GREEN;
+        if (zones->ledState[zone] != (uint8_t)targetLed)
+        {
+            zones->ledState[zone] = (uint8_t)targetLed;
+            HAL_Zone_SetLed(zones->actuators, zone, targetLed);
+        }
+        pumpsOn += (zones->pumpState[zone] == PUMP_ON) ? 1U : 0U;
+    }
+
+    zones->pumpsOn = pumpsOn;
+    zones->pumpOnZoneSeconds += pumpsOn;
+}
@@ -0,0 +1,66 @@
+/*
+ * Bộ điều khiển nhiều vùng tưới (mỗi luống một vùng) trong một tiến trình.
+ * Trạng thái lưu dạng struct-of-arrays: mỗi trường là một mảng theo zone, nên một tick
+ * duyệt tuần tự các mảng liền nhau thay vì nhảy qua từng SystemState_t lớn.
+ * Logic AUTO/MANUAL giống hệt spws_controller; bơm/LED/cảm biến/nút đi qua HAL bank theo zone.
+ */
+#ifndef SPWS_ZONES_H
+#define SPWS_ZONES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../config.h"
+#include "../hal_library/hal_actuators.h"
+#include "../hal_library/hal_sensors.h"
+#include "../hal_library/hal_buttons.h"
+
+typedef struct
+{
+    uint32_t zoneCount;
+
+    /* Cấu hình từng vùng */
+    float *minMoistureThreshold;
+    float *maxMoistureThreshold;
+    uint32_t *sensorReadInterval_s;
+    uint32_t *maxWateringDuration_s;
+    uint32_t *manualWateringDuration_s;
+
+    /* Dữ liệu cảm biến gần nhất */
+    float *soilMoisturePercent;
+    float *ambientTemperatureC;
+    uint32_t *lastReadTime_s;
+
+    /* Trạng thái (enum lưu 1 byte để mảng gọn) */
+    uint8_t *mode;
+    uint8_t *pumpState;
+    uint8_t *ledState;
+    uint8_t *autoWateringActive;
+    uint8_t *manualWateringActive;
+    uint32_t *pumpStartedAt_s;
+    uint32_t *manualWaterStartedAt_s;
+
+    /* HAL theo vùng, do người gọi sở hữu */
+    HAL_ActuatorBank_t *actuators;
+    HAL_SensorBank_t *sensors;
+    HAL_ButtonBank_t *buttons;
+
+    /* Thống kê */
+    uint32_t pumpsOn;             /* Số vùng đang bơm sau tick gần nhất */
+    uint64_t pumpStarts;          /* Tổng số lần bật bơm */
+    uint64_t pumpOnZoneSeconds;   /* Tổng số giây-vùng bơm chạy */
+} SPWS_ZoneArray_t;
+
+/* Cấp phát zoneCount vùng với cấu hình mặc định như SPWS_InitDefaults; false nếu hết bộ nhớ */
+bool SPWS_Zones_Init(SPWS_ZoneArray_t *zones, uint32_t zoneCount, HAL_ActuatorBank_t *actuators,
+                     HAL_SensorBank_t *sensors, HAL_ButtonBank_t *buttons);
+
+/* Giải phóng các mảng (không giải phóng HAL bank) */
+void SPWS_Zones_Free(SPWS_ZoneArray_t *zones);
+
+/* Đặt cấu hình riêng cho một vùng */
+void SPWS_Zones_SetSettings(SPWS_ZoneArray_t *zones, uint32_t zone, const SystemSettings_t *settings);
+
+/* Một tick cho mọi vùng: nút, cảm biến, logic AUTO/MANUAL và output trong một lượt duyệt */
+void SPWS_Zones_Step(SPWS_ZoneArray_t *zones, uint32_t now_s);
+
+#endif